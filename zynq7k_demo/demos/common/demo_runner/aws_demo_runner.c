@@ -46,6 +46,7 @@ extern void vStartMQTTEchoDemo( void );
 /* extern void vStartTCPEchoClientTasks_SeparateTasks( void ); */
 /* extern void vStartTCPEchoClientTasks_SingleTasks( void ); */
 extern void vStartMQTTUZedIotDemo(void);
+/* extern void vStartHrTimerJitterDemo( void ); */
 
 /*-----------------------------------------------------------*/
 
@@ -64,4 +65,5 @@ void DEMO_RUNNER_RunDemos( void )
     /* vStartTCPEchoClientTasks_SeparateTasks(); */
     /* vStartTCPEchoClientTasks_SingleTasks(); */
     vStartMQTTUZedIotDemo();
+    /* vStartHrTimerJitterDemo(); */
 }
@@ -0,0 +1,277 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * Runs a periodic timer of timers.c and a periodic high resolution timer of
+ * aws_hrtimer.c side by side, and prints how far the interval between two
+ * consecutive callbacks of each strayed from the nominal period. The timers
+ * of timers.c expire on a tick, so their jitter is bounded below by the tick
+ * granularity and the timer task latency. The high resolution timers expire
+ * on the hardware comparator and their jitter is the interrupt and task
+ * switch latency only.
+ *
+ * HRTIMER_Init() must have been called, on the MicroZed by xUZedHrTimerInit().
+ */
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+/* High resolution timer includes. */
+#include "aws_hrtimer.h"
+
+/* Demo specific includes. */
+#include "aws_hrtimer_jitter_demo.h"
+#include "aws_demo_config.h"
+
+/* Period of both timers. */
+#define hrtimerdemoPERIOD_MS            ( 5UL )
+
+/* Time between two reports. */
+#define hrtimerdemoREPORT_PERIOD_MS     ( 10000UL )
+
+/* Jitter is histogrammed in microsecond buckets, the last bucket collecting
+ * everything larger. */
+#define hrtimerdemoHISTOGRAM_BUCKETS    ( 256UL )
+
+/*-----------------------------------------------------------*/
+
+/* Jitter statistics of one timer, updated by its callback. */
+typedef struct JitterStats
+{
+    const char * pcName;
+    uint64_t ullLastCallback;
+    uint64_t ullSumNs;
+    uint32_t ulMinNs;
+    uint32_t ulMaxNs;
+    uint32_t ulSamples;
+    uint32_t ulOverruns;
+    uint16_t usHistogram[ hrtimerdemoHISTOGRAM_BUCKETS ];
+} JitterStats_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Records the interval since the previous callback of a timer.
+ */
+static void prvRecordCallback( JitterStats_t * pxStats,
+                               uint32_t ulMissedPeriods );
+
+/*
+ * Callback of the timer of timers.c, run in the timer daemon task.
+ */
+static void prvTickTimerCallback( TimerHandle_t xTimer );
+
+/*
+ * Callback of the high resolution timer, run in the high resolution timer
+ * task.
+ */
+static void prvHrTimerCallback( HrTimer_t * pxTimer,
+                                void * pvContext );
+
+/*
+ * Prints the statistics of one timer and resets them.
+ */
+static void prvReport( JitterStats_t * pxStats );
+
+/*
+ * Starts both timers and reports periodically.
+ */
+static void prvJitterDemoTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static JitterStats_t xTickStats = { .pcName = "tick timer" };
+static JitterStats_t xHrStats = { .pcName = "hr timer" };
+static HrTimer_t xHrTimer;
+
+/*-----------------------------------------------------------*/
+
+static void prvRecordCallback( JitterStats_t * pxStats,
+                               uint32_t ulMissedPeriods )
+{
+    uint64_t ullNow = HRTIMER_GetTime();
+    uint64_t ullExpected = 0;
+    uint64_t ullInterval = 0;
+    uint32_t ulJitterNs = 0;
+    uint32_t ulBucket = 0;
+
+    taskENTER_CRITICAL();
+    {
+        if( pxStats->ullLastCallback != 0 )
+        {
+            ullExpected = hrtimerUS_TO_COUNTS( hrtimerdemoPERIOD_MS * 1000UL * ( ulMissedPeriods + 1UL ) );
+            ullInterval = ullNow - pxStats->ullLastCallback;
+            ullInterval = ( ullInterval > ullExpected ) ? ( ullInterval - ullExpected ) : ( ullExpected - ullInterval );
+            ulJitterNs = ( uint32_t ) hrtimerCOUNTS_TO_NS( ullInterval );
+
+            ulBucket = ulJitterNs / 1000UL;
+
+            if( ulBucket >= hrtimerdemoHISTOGRAM_BUCKETS )
+            {
+                ulBucket = hrtimerdemoHISTOGRAM_BUCKETS - 1UL;
+            }
+
+            if( pxStats->usHistogram[ ulBucket ] < UINT16_MAX )
+            {
+                pxStats->usHistogram[ ulBucket ]++;
+            }
+
+            if( ( pxStats->ulSamples == 0 ) || ( ulJitterNs < pxStats->ulMinNs ) )
+            {
+                pxStats->ulMinNs = ulJitterNs;
+            }
+
+            if( ulJitterNs > pxStats->ulMaxNs )
+            {
+                pxStats->ulMaxNs = ulJitterNs;
+            }
+
+            pxStats->ullSumNs += ulJitterNs;
+            pxStats->ulSamples++;
+            pxStats->ulOverruns += ulMissedPeriods;
+        }
+
+        pxStats->ullLastCallback = ullNow;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTickTimerCallback( TimerHandle_t xTimer )
+{
+    ( void ) xTimer;
+
+    prvRecordCallback( &xTickStats, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHrTimerCallback( HrTimer_t * pxTimer,
+                                void * pvContext )
+{
+    ( void ) pvContext;
+
+    prvRecordCallback( &xHrStats, HRTIMER_GetOverruns( pxTimer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReport( JitterStats_t * pxStats )
+{
+    JitterStats_t xSnapshot;
+    uint32_t ulBucket = 0;
+    uint32_t ulCount = 0;
+
+    /* Copy and reset under the critical section so the callbacks never see
+     * half reset statistics. */
+    taskENTER_CRITICAL();
+    {
+        xSnapshot = *pxStats;
+        memset( &pxStats->ullSumNs, 0, sizeof( JitterStats_t ) - offsetof( JitterStats_t, ullSumNs ) );
+    }
+    taskEXIT_CRITICAL();
+
+    if( xSnapshot.ulSamples == 0 )
+    {
+        configPRINTF( ( "%s: no samples\r\n", xSnapshot.pcName ) );
+    }
+    else
+    {
+        /* The 99th percentile is the first bucket at which 99% of the samples
+         * have been seen. */
+        for( ulBucket = 0; ulBucket < hrtimerdemoHISTOGRAM_BUCKETS - 1UL; ulBucket++ )
+        {
+            ulCount += xSnapshot.usHistogram[ ulBucket ];
+
+            if( ( ( uint64_t ) ulCount * 100ULL ) >= ( ( uint64_t ) xSnapshot.ulSamples * 99ULL ) )
+            {
+                break;
+            }
+        }
+
+        configPRINTF( ( "%s: %u samples, jitter min %u ns, mean %u ns, max %u ns, p99 %s%u us, %u overruns\r\n",
+                        xSnapshot.pcName,
+                        ( unsigned ) xSnapshot.ulSamples,
+                        ( unsigned ) xSnapshot.ulMinNs,
+                        ( unsigned ) ( xSnapshot.ullSumNs / xSnapshot.ulSamples ),
+                        ( unsigned ) xSnapshot.ulMaxNs,
+                        ( ulBucket == hrtimerdemoHISTOGRAM_BUCKETS - 1UL ) ? ">=" : "<",
+                        ( unsigned ) ( ( ulBucket == hrtimerdemoHISTOGRAM_BUCKETS - 1UL ) ? ulBucket : ulBucket + 1UL ),
+                        ( unsigned ) xSnapshot.ulOverruns ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvJitterDemoTask( void * pvParameters )
+{
+    TimerHandle_t xTickTimer = NULL;
+    BaseType_t xStarted = pdFAIL;
+
+    ( void ) pvParameters;
+
+    xTickTimer = xTimerCreate( "Jitter",
+                               pdMS_TO_TICKS( hrtimerdemoPERIOD_MS ),
+                               pdTRUE,
+                               NULL,
+                               prvTickTimerCallback );
+    configASSERT( xTickTimer );
+    ( void ) xTimerStart( xTickTimer, portMAX_DELAY );
+
+    HRTIMER_Create( &xHrTimer, prvHrTimerCallback, NULL );
+    xStarted = HRTIMER_Start( &xHrTimer,
+                              hrtimerUS_TO_COUNTS( hrtimerdemoPERIOD_MS * 1000UL ),
+                              hrtimerUS_TO_COUNTS( hrtimerdemoPERIOD_MS * 1000UL ) );
+    configASSERT( xStarted == pdPASS );
+    ( void ) xStarted;
+
+    for( ; ; )
+    {
+        vTaskDelay( pdMS_TO_TICKS( hrtimerdemoREPORT_PERIOD_MS ) );
+
+        prvReport( &xTickStats );
+        prvReport( &xHrStats );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void vStartHrTimerJitterDemo( void )
+{
+    ( void ) xTaskCreate( prvJitterDemoTask,
+                          "HrJitter",
+                          democonfigHRTIMER_JITTER_DEMO_TASK_STACK_SIZE,
+                          NULL,
+                          democonfigHRTIMER_JITTER_DEMO_TASK_PRIORITY,
+                          NULL );
+}
@@ -0,0 +1,1017 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * Logging implementation that defers formatting to the logging task.
+ *
+ * vLoggingPrintf() does not format the message.  It copies the format string
+ * pointer, the tick count and the raw arguments into a ring buffer owned by the
+ * calling task, and the logging task formats and outputs the message later.
+ * Each task writes to its own ring, so writing a message takes no lock and
+ * allocates no memory.  When a ring is full the message is dropped and counted,
+ * and the logging task reports the count once there is room again.
+ *
+ * The format string must remain valid until the message is output, which holds
+ * for string literals.  %s arguments are copied, truncated to
+ * configLOGGING_MAX_STRING_ARGUMENT characters.
+ *
+ * Tasks claim a ring the first time they log and keep it for their lifetime.
+ * Define traceTASK_DELETE() to call vLoggingTaskDeleted() so that the rings of
+ * deleted tasks are returned; a returned ring is claimed again once the logging
+ * task has emptied it.  Once all configLOGGING_RING_COUNT rings are claimed,
+ * and before the scheduler starts, messages go to a shared ring written inside
+ * a critical section.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Logging includes. */
+#include "aws_logging_task.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Sanity check all the definitions required by this file are set. */
+#ifndef configPRINT_STRING
+    #error configPRINT_STRING( x ) must be defined in FreeRTOSConfig.h to use this logging file.  Set configPRINT_STRING( x ) to a function that outputs a string, where X is the string.  For example, #define configPRINT_STRING( x ) MyUARTWriteString( X )
+#endif
+
+#ifndef configLOGGING_MAX_MESSAGE_LENGTH
+    #error configLOGGING_MAX_MESSAGE_LENGTH must be defined in FreeRTOSConfig.h to use this logging file.  configLOGGING_MAX_MESSAGE_LENGTH sets the size of the buffer into which formatted text is written, so also sets the maximum log message length.
+#endif
+
+#ifndef configLOGGING_INCLUDE_TIME_AND_TASK_NAME
+    #error configLOGGING_INCLUDE_TIME_AND_TASK_NAME must be defined in FreeRTOSConfig.h to use this logging file.  Set configLOGGING_INCLUDE_TIME_AND_TASK_NAME to 1 to prepend a time stamp, message number and the name of the calling task to each logged message.  Otherwise set to 0.
+#endif
+
+#if ( configNUM_THREAD_LOCAL_STORAGE_POINTERS < 1 )
+    #error configNUM_THREAD_LOCAL_STORAGE_POINTERS must be at least 1 to use this logging file.  Each task keeps a pointer to its log ring in a thread local storage pointer.
+#endif
+
+/* Number of rings that tasks can claim for themselves. */
+#ifndef configLOGGING_RING_COUNT
+    #define configLOGGING_RING_COUNT                    ( 8 )
+#endif
+
+/* Size of each ring in 32-bit words.  Must be a power of two. */
+#ifndef configLOGGING_RING_SIZE_WORDS
+    #define configLOGGING_RING_SIZE_WORDS               ( 256 )
+#endif
+
+/* Largest message record in 32-bit words.  Arguments that do not fit are not
+ * recorded, and the message is output up to the first missing argument. */
+#ifndef configLOGGING_MAX_RECORD_WORDS
+    #define configLOGGING_MAX_RECORD_WORDS              ( 40 )
+#endif
+
+/* Number of characters of each %s argument that are copied. */
+#ifndef configLOGGING_MAX_STRING_ARGUMENT
+    #define configLOGGING_MAX_STRING_ARGUMENT           ( 32 )
+#endif
+
+/* Thread local storage pointer holding the ring of each task. */
+#ifndef configLOGGING_THREAD_LOCAL_STORAGE_INDEX
+    #define configLOGGING_THREAD_LOCAL_STORAGE_INDEX    ( configNUM_THREAD_LOCAL_STORAGE_POINTERS - 1 )
+#endif
+
+#if ( ( configLOGGING_RING_SIZE_WORDS & ( configLOGGING_RING_SIZE_WORDS - 1 ) ) != 0 )
+    #error configLOGGING_RING_SIZE_WORDS must be a power of two.
+#endif
+
+#if ( configLOGGING_MAX_RECORD_WORDS > configLOGGING_RING_SIZE_WORDS )
+    #error configLOGGING_MAX_RECORD_WORDS must not be larger than configLOGGING_RING_SIZE_WORDS.
+#endif
+
+#define loggingRING_MASK               ( configLOGGING_RING_SIZE_WORDS - 1UL )
+
+/* The producer and the logging task run on the same core, so it is enough to
+ * stop the compiler reordering the ring writes around the index update. */
+#define loggingMEMORY_BARRIER()        __asm volatile ( "" ::: "memory" )
+
+/* Record header word: length in words, record type and flags. */
+#define loggingRECORD_LENGTH_MASK      ( 0xFFUL )
+#define loggingRECORD_PRINTF           ( 0x100UL )
+#define loggingRECORD_STRING           ( 0x200UL )
+#define loggingRECORD_HAS_NAME         ( 0x1000UL )
+
+#define loggingBYTES_TO_WORDS( x )     ( ( ( x ) + sizeof( uint32_t ) - 1 ) / sizeof( uint32_t ) )
+
+/* Word offsets in a record.  The name of the task, if present, is followed by
+ * the arguments of a printf record or the text of a string record. */
+#define loggingRECORD_HEADER           ( 0 )
+#define loggingRECORD_TICK             ( 1 )
+#define loggingRECORD_FORMAT           ( 2 ) /* Byte count for string records. */
+#define loggingRECORD_FIXED_WORDS      ( loggingRECORD_FORMAT + loggingBYTES_TO_WORDS( sizeof( const char * ) ) )
+#define loggingNAME_WORDS              loggingBYTES_TO_WORDS( configMAX_TASK_NAME_LEN )
+
+/* Longest conversion specification, with '*' replaced by its value. */
+#define loggingMAX_SPEC_LENGTH         ( 32 )
+
+/*-----------------------------------------------------------*/
+
+/* Type of the argument consumed by a conversion specification. */
+typedef enum
+{
+    eLoggingArgNone,    /* %% */
+    eLoggingArgInt,
+    eLoggingArgLong,
+    eLoggingArgLongLong,
+    eLoggingArgSize,
+    eLoggingArgPointer,
+    eLoggingArgDouble,
+    eLoggingArgString,
+    eLoggingArgIgnored, /* %n, the pointer is consumed but never written. */
+    eLoggingArgInvalid
+} LoggingArg_t;
+
+/* A conversion specification found in a format string. */
+typedef struct LoggingSpec
+{
+    const char * pcStart; /* The '%'. */
+    const char * pcEnd;   /* One past the conversion character. */
+    BaseType_t xWidthFromArgument;
+    BaseType_t xPrecisionFromArgument;
+    LoggingArg_t eArgument;
+} LoggingSpec_t;
+
+/* A single producer, single consumer ring of message records. */
+typedef struct LoggingRing
+{
+    volatile uint32_t ulHead;    /* Words written, only updated by the producer. */
+    volatile uint32_t ulTail;    /* Words consumed, only updated by the logging task. */
+    volatile uint32_t ulDropped; /* Messages dropped, only updated by the producer. */
+    uint32_t ulDroppedReported;  /* Only used by the logging task. */
+    volatile BaseType_t xClaimed; /* Set while a task owns the ring. */
+    char cTaskName[ configMAX_TASK_NAME_LEN ];
+    uint32_t ulWords[ configLOGGING_RING_SIZE_WORDS ];
+} LoggingRing_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The task that formats and outputs the log messages.  It blocks until a
+ * producer signals that a ring went from empty to not empty, then outputs the
+ * records of all rings, oldest first, until they are all empty.
+ */
+static void prvLoggingTask( void * pvParameters );
+
+/*
+ * Finds the next conversion specification in pcFormat.  Returns NULL if there
+ * are none left.
+ */
+static const char * prvNextSpec( const char * pcFormat,
+                                 LoggingSpec_t * pxSpec );
+
+/*
+ * Returns the ring of the calling task, claiming one if necessary.
+ */
+static LoggingRing_t * prvGetRing( void );
+
+/*
+ * Returns the ring of a deleted task, called from traceTASK_DELETE() inside
+ * a critical section.
+ */
+void vLoggingTaskDeleted( void * pvTask );
+
+/*
+ * Copies a record into a ring.  Returns pdFALSE if the ring is full.
+ */
+static BaseType_t prvRingWrite( LoggingRing_t * pxRing,
+                                const uint32_t * pulRecord,
+                                uint32_t ulLength );
+
+/*
+ * Writes a complete record to the ring of the calling task.
+ */
+static void prvLogRecord( LoggingRing_t * pxRing,
+                          uint32_t * pulRecord,
+                          uint32_t ulLength );
+
+/*
+ * Formats a printf record into pcOutput.
+ */
+static size_t prvFormatRecord( const uint32_t * pulRecord,
+                               const char * pcTaskName,
+                               char * pcOutput );
+
+/*-----------------------------------------------------------*/
+
+/* Rings claimed by tasks, and the shared ring used by everyone else. */
+static LoggingRing_t xRings[ configLOGGING_RING_COUNT ];
+static LoggingRing_t xSharedRing;
+
+static TaskHandle_t xLoggingTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
+                                   UBaseType_t uxPriority,
+                                   UBaseType_t uxQueueLength )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    /* Messages are buffered in the rings rather than in a queue. */
+    ( void ) uxQueueLength;
+
+    /* Ensure the logging task has not been created already. */
+    if( xLoggingTask == NULL )
+    {
+        xReturn = xTaskCreate( prvLoggingTask, "Logging", usStackSize, NULL, uxPriority, &xLoggingTask );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvNextSpec( const char * pcFormat,
+                                 LoggingSpec_t * pxSpec )
+{
+    const char * pc = strchr( pcFormat, '%' );
+    BaseType_t xLongs = 0;
+    BaseType_t xSize = pdFALSE;
+
+    if( pc == NULL )
+    {
+        return NULL;
+    }
+
+    pxSpec->pcStart = pc++;
+    pxSpec->xWidthFromArgument = pdFALSE;
+    pxSpec->xPrecisionFromArgument = pdFALSE;
+    pxSpec->eArgument = eLoggingArgInvalid;
+
+    /* Flags and width. */
+    while( ( *pc != '\0' ) && ( strchr( "-+ #0", *pc ) != NULL ) )
+    {
+        pc++;
+    }
+
+    if( *pc == '*' )
+    {
+        pxSpec->xWidthFromArgument = pdTRUE;
+        pc++;
+    }
+
+    while( ( *pc >= '0' ) && ( *pc <= '9' ) )
+    {
+        pc++;
+    }
+
+    /* Precision. */
+    if( *pc == '.' )
+    {
+        pc++;
+
+        if( *pc == '*' )
+        {
+            pxSpec->xPrecisionFromArgument = pdTRUE;
+            pc++;
+        }
+
+        while( ( *pc >= '0' ) && ( *pc <= '9' ) )
+        {
+            pc++;
+        }
+    }
+
+    /* Length modifiers.  'h' and "hh" arguments are promoted to int. */
+    while( ( *pc != '\0' ) && ( strchr( "hlzjt", *pc ) != NULL ) )
+    {
+        if( *pc == 'l' )
+        {
+            xLongs++;
+        }
+        else if( *pc != 'h' )
+        {
+            /* size_t, intmax_t and ptrdiff_t.  intmax_t is long long. */
+            xSize = ( *pc == 'j' ) ? pdFALSE : pdTRUE;
+            xLongs = ( *pc == 'j' ) ? 2 : xLongs;
+        }
+
+        pc++;
+    }
+
+    switch( *pc )
+    {
+        case '%':
+            pxSpec->eArgument = eLoggingArgNone;
+            break;
+
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+
+            if( xSize == pdTRUE )
+            {
+                pxSpec->eArgument = eLoggingArgSize;
+            }
+            else if( xLongs >= 2 )
+            {
+                pxSpec->eArgument = eLoggingArgLongLong;
+            }
+            else if( xLongs == 1 )
+            {
+                pxSpec->eArgument = eLoggingArgLong;
+            }
+            else
+            {
+                pxSpec->eArgument = eLoggingArgInt;
+            }
+
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            pxSpec->eArgument = eLoggingArgDouble;
+            break;
+
+        case 'p':
+            pxSpec->eArgument = eLoggingArgPointer;
+            break;
+
+        case 's':
+            pxSpec->eArgument = ( xLongs == 0 ) ? eLoggingArgString : eLoggingArgInvalid;
+            break;
+
+        case 'n':
+            pxSpec->eArgument = eLoggingArgIgnored;
+            break;
+
+        default:
+            /* Includes long double, which is not supported. */
+            break;
+    }
+
+    if( *pc != '\0' )
+    {
+        pc++;
+    }
+
+    pxSpec->pcEnd = pc;
+
+    return pxSpec->pcStart;
+}
+/*-----------------------------------------------------------*/
+
+static LoggingRing_t * prvGetRing( void )
+{
+    LoggingRing_t * pxRing = &xSharedRing;
+    UBaseType_t uxRing;
+
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        pxRing = pvTaskGetThreadLocalStoragePointer( NULL, configLOGGING_THREAD_LOCAL_STORAGE_INDEX );
+
+        if( pxRing == NULL )
+        {
+            pxRing = &xSharedRing;
+
+            /* A ring returned by a deleted task can only be claimed once the
+             * logging task has output its remaining records. */
+            taskENTER_CRITICAL();
+            {
+                for( uxRing = 0; uxRing < configLOGGING_RING_COUNT; uxRing++ )
+                {
+                    if( ( xRings[ uxRing ].xClaimed == pdFALSE ) &&
+                        ( xRings[ uxRing ].ulHead == xRings[ uxRing ].ulTail ) )
+                    {
+                        xRings[ uxRing ].xClaimed = pdTRUE;
+                        pxRing = &xRings[ uxRing ];
+                        break;
+                    }
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pxRing != &xSharedRing )
+            {
+                strncpy( pxRing->cTaskName, pcTaskGetName( NULL ), configMAX_TASK_NAME_LEN );
+                pxRing->cTaskName[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+            }
+
+            vTaskSetThreadLocalStoragePointer( NULL, configLOGGING_THREAD_LOCAL_STORAGE_INDEX, pxRing );
+        }
+    }
+
+    return pxRing;
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingTaskDeleted( void * pvTask )
+{
+    LoggingRing_t * pxRing;
+
+    pxRing = pvTaskGetThreadLocalStoragePointer( ( TaskHandle_t ) pvTask, configLOGGING_THREAD_LOCAL_STORAGE_INDEX );
+
+    if( ( pxRing != NULL ) && ( pxRing != &xSharedRing ) )
+    {
+        pxRing->xClaimed = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRingWrite( LoggingRing_t * pxRing,
+                                const uint32_t * pulRecord,
+                                uint32_t ulLength )
+{
+    uint32_t ulHead = pxRing->ulHead;
+    uint32_t ulIndex;
+
+    if( ulLength > configLOGGING_RING_SIZE_WORDS - ( ulHead - pxRing->ulTail ) )
+    {
+        pxRing->ulDropped++;
+
+        return pdFALSE;
+    }
+
+    for( ulIndex = 0; ulIndex < ulLength; ulIndex++ )
+    {
+        pxRing->ulWords[ ( ulHead + ulIndex ) & loggingRING_MASK ] = pulRecord[ ulIndex ];
+    }
+
+    loggingMEMORY_BARRIER();
+    pxRing->ulHead = ulHead + ulLength;
+    loggingMEMORY_BARRIER();
+
+    /* Only wake the logging task if it had consumed everything before this
+     * record.  Otherwise it is still draining and will see the new head, as it
+     * reads the head again after updating the tail. */
+    return ( pxRing->ulTail == ulHead ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLogRecord( LoggingRing_t * pxRing,
+                          uint32_t * pulRecord,
+                          uint32_t ulLength )
+{
+    BaseType_t xWake;
+
+    /* The logging task is created by xLoggingTaskInitialize().  Check
+     * xLoggingTaskInitialize() has been called. */
+    configASSERT( xLoggingTask );
+
+    pulRecord[ loggingRECORD_HEADER ] |= ulLength;
+    pulRecord[ loggingRECORD_TICK ] = ( uint32_t ) xTaskGetTickCount();
+
+    if( pxRing == &xSharedRing )
+    {
+        /* Several tasks write to the shared ring. */
+        taskENTER_CRITICAL();
+        {
+            xWake = prvRingWrite( pxRing, pulRecord, ulLength );
+        }
+        taskEXIT_CRITICAL();
+    }
+    else
+    {
+        xWake = prvRingWrite( pxRing, pulRecord, ulLength );
+    }
+
+    if( ( xWake == pdTRUE ) && ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) )
+    {
+        xTaskNotifyGive( xLoggingTask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/* Appends a value to a record being built, if there is room for it. */
+static BaseType_t prvRecordPut( uint32_t * pulRecord,
+                                uint32_t * pulLength,
+                                const void * pvValue,
+                                size_t xBytes )
+{
+    uint32_t ulWords = loggingBYTES_TO_WORDS( xBytes );
+
+    if( *pulLength + ulWords > configLOGGING_MAX_RECORD_WORDS )
+    {
+        return pdFALSE;
+    }
+
+    memcpy( &pulRecord[ *pulLength ], pvValue, xBytes );
+    *pulLength += ulWords;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Reads a value from a record, returning pdFALSE past its end. */
+static BaseType_t prvRecordGet( const uint32_t * pulRecord,
+                                uint32_t * pulIndex,
+                                void * pvValue,
+                                size_t xBytes )
+{
+    uint32_t ulWords = loggingBYTES_TO_WORDS( xBytes );
+    uint32_t ulLength = pulRecord[ loggingRECORD_HEADER ] & loggingRECORD_LENGTH_MASK;
+
+    if( *pulIndex + ulWords > ulLength )
+    {
+        return pdFALSE;
+    }
+
+    memcpy( pvValue, &pulRecord[ *pulIndex ], xBytes );
+    *pulIndex += ulWords;
+
+    return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/* Copies the name of the calling task into a record of the shared ring. */
+static void prvRecordPutName( uint32_t * pulRecord,
+                              uint32_t * pulLength )
+{
+    char cName[ loggingNAME_WORDS * sizeof( uint32_t ) ] = { 0 };
+
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        strncpy( cName, pcTaskGetName( NULL ), configMAX_TASK_NAME_LEN - 1 );
+    }
+    else
+    {
+        strncpy( cName, "None", configMAX_TASK_NAME_LEN - 1 );
+    }
+
+    pulRecord[ loggingRECORD_HEADER ] |= loggingRECORD_HAS_NAME;
+    ( void ) prvRecordPut( pulRecord, pulLength, cName, sizeof( cName ) );
+}
+/*-----------------------------------------------------------*/
+
+/*!
+ * \brief Records a message to be formatted and printed by the
+ * logging task.
+ *
+ * The message number, time (in ticks), and task that called
+ * vLoggingPrintf are added to the beginning of each print
+ * statement when it is formatted.
+ *
+ */
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    LoggingRing_t * pxRing = prvGetRing();
+    uint32_t ulRecord[ configLOGGING_MAX_RECORD_WORDS ];
+    uint32_t ulLength = loggingRECORD_FIXED_WORDS;
+    BaseType_t xFits = pdTRUE;
+    LoggingSpec_t xSpec;
+    const char * pc;
+    va_list args;
+
+    ulRecord[ loggingRECORD_HEADER ] = loggingRECORD_PRINTF;
+    memcpy( &ulRecord[ loggingRECORD_FORMAT ], &pcFormat, sizeof( pcFormat ) );
+
+    if( pxRing == &xSharedRing )
+    {
+        prvRecordPutName( ulRecord, &ulLength );
+    }
+
+    /* There are a variable number of parameters, described by the format. */
+    va_start( args, pcFormat );
+
+    for( pc = prvNextSpec( pcFormat, &xSpec );
+         ( pc != NULL ) && ( xFits == pdTRUE ) && ( xSpec.eArgument != eLoggingArgInvalid );
+         pc = prvNextSpec( xSpec.pcEnd, &xSpec ) )
+    {
+        if( xSpec.xWidthFromArgument == pdTRUE )
+        {
+            int iWidth = va_arg( args, int );
+            xFits = prvRecordPut( ulRecord, &ulLength, &iWidth, sizeof( iWidth ) );
+        }
+
+        if( xSpec.xPrecisionFromArgument == pdTRUE )
+        {
+            int iPrecision = va_arg( args, int );
+            xFits &= prvRecordPut( ulRecord, &ulLength, &iPrecision, sizeof( iPrecision ) );
+        }
+
+        switch( xSpec.eArgument )
+        {
+            case eLoggingArgInt:
+            {
+                int iValue = va_arg( args, int );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &iValue, sizeof( iValue ) );
+                break;
+            }
+
+            case eLoggingArgLong:
+            {
+                long lValue = va_arg( args, long );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &lValue, sizeof( lValue ) );
+                break;
+            }
+
+            case eLoggingArgLongLong:
+            {
+                long long llValue = va_arg( args, long long );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &llValue, sizeof( llValue ) );
+                break;
+            }
+
+            case eLoggingArgSize:
+            {
+                size_t xValue = va_arg( args, size_t );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &xValue, sizeof( xValue ) );
+                break;
+            }
+
+            case eLoggingArgPointer:
+            {
+                void * pvValue = va_arg( args, void * );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &pvValue, sizeof( pvValue ) );
+                break;
+            }
+
+            case eLoggingArgDouble:
+            {
+                double dValue = va_arg( args, double );
+                xFits &= prvRecordPut( ulRecord, &ulLength, &dValue, sizeof( dValue ) );
+                break;
+            }
+
+            case eLoggingArgString:
+            {
+                const char * pcValue = va_arg( args, const char * );
+                char cValue[ configLOGGING_MAX_STRING_ARGUMENT + 1 ] = { 0 };
+
+                /* The string may not outlive this call, so it is copied. */
+                strncpy( cValue, ( pcValue != NULL ) ? pcValue : "(null)", configLOGGING_MAX_STRING_ARGUMENT );
+                xFits &= prvRecordPut( ulRecord, &ulLength, cValue, strlen( cValue ) + 1 );
+                break;
+            }
+
+            case eLoggingArgIgnored:
+                ( void ) va_arg( args, void * );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    va_end( args );
+
+    prvLogRecord( pxRing, ulRecord, ulLength );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrint( const char * pcMessage )
+{
+    LoggingRing_t * pxRing = prvGetRing();
+    uint32_t ulRecord[ configLOGGING_MAX_RECORD_WORDS ];
+    uint32_t ulLength = loggingRECORD_FIXED_WORDS;
+    size_t xBytes = strlen( pcMessage );
+
+    ulRecord[ loggingRECORD_HEADER ] = loggingRECORD_STRING;
+
+    if( pxRing == &xSharedRing )
+    {
+        prvRecordPutName( ulRecord, &ulLength );
+    }
+
+    /* Long messages are truncated to the space left in the record. */
+    if( xBytes > ( configLOGGING_MAX_RECORD_WORDS - ulLength ) * sizeof( uint32_t ) )
+    {
+        xBytes = ( configLOGGING_MAX_RECORD_WORDS - ulLength ) * sizeof( uint32_t );
+    }
+
+    ulRecord[ loggingRECORD_FORMAT ] = ( uint32_t ) xBytes;
+    ( void ) prvRecordPut( ulRecord, &ulLength, pcMessage, xBytes );
+
+    prvLogRecord( pxRing, ulRecord, ulLength );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvFormatRecord( const uint32_t * pulRecord,
+                               const char * pcTaskName,
+                               char * pcOutput )
+{
+    const char * pcFormat;
+    uint32_t ulIndex = loggingRECORD_FIXED_WORDS;
+    size_t xLength = 0;
+    BaseType_t xAvailable = pdTRUE;
+    LoggingSpec_t xSpec;
+    const char * pcLiteral;
+    const char * pc;
+    static uint32_t ulMessageNumber = 0;
+
+    memcpy( &pcFormat, &pulRecord[ loggingRECORD_FORMAT ], sizeof( pcFormat ) );
+    pcLiteral = pcFormat;
+
+    if( ( pulRecord[ loggingRECORD_HEADER ] & loggingRECORD_HAS_NAME ) != 0 )
+    {
+        ulIndex += loggingNAME_WORDS;
+    }
+
+    if( strcmp( pcFormat, "\n" ) != 0 )
+    {
+        #if( configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1 )
+        {
+            xLength = snprintf( pcOutput, configLOGGING_MAX_MESSAGE_LENGTH, "%lu %lu [%s] ",
+                ( unsigned long ) ulMessageNumber++,
+                ( unsigned long ) pulRecord[ loggingRECORD_TICK ],
+                pcTaskName );
+        }
+        #else
+        {
+            ( void ) pcTaskName;
+        }
+        #endif
+    }
+
+    for( pc = prvNextSpec( pcFormat, &xSpec );
+         ( pc != NULL ) && ( xAvailable == pdTRUE ) && ( xLength < configLOGGING_MAX_MESSAGE_LENGTH - 1 );
+         pc = prvNextSpec( xSpec.pcEnd, &xSpec ) )
+    {
+        char cSpec[ loggingMAX_SPEC_LENGTH ];
+        size_t xSpecLength = 0;
+        const char * pcSpec;
+        size_t xRemaining;
+        int iWritten = 0;
+
+        /* Copy the text before the specification. */
+        xRemaining = configLOGGING_MAX_MESSAGE_LENGTH - 1 - xLength;
+
+        if( ( size_t ) ( pc - pcLiteral ) < xRemaining )
+        {
+            xRemaining = pc - pcLiteral;
+        }
+
+        memcpy( &pcOutput[ xLength ], pcLiteral, xRemaining );
+        xLength += xRemaining;
+        pcLiteral = pc;
+
+        if( xSpec.eArgument == eLoggingArgInvalid )
+        {
+            break;
+        }
+
+        /* Copy the specification, replacing '*' by the recorded value. */
+        for( pcSpec = xSpec.pcStart; ( pcSpec < xSpec.pcEnd ) && ( xAvailable == pdTRUE ); pcSpec++ )
+        {
+            if( *pcSpec == '*' )
+            {
+                int iValue = 0;
+                xAvailable = prvRecordGet( pulRecord, &ulIndex, &iValue, sizeof( iValue ) );
+                iWritten = snprintf( &cSpec[ xSpecLength ], sizeof( cSpec ) - xSpecLength, "%d", iValue );
+                xSpecLength += ( iWritten > 0 ) ? iWritten : 0;
+            }
+            else if( xSpecLength < sizeof( cSpec ) - 1 )
+            {
+                cSpec[ xSpecLength++ ] = *pcSpec;
+            }
+
+            xSpecLength = ( xSpecLength < sizeof( cSpec ) - 1 ) ? xSpecLength : sizeof( cSpec ) - 1;
+        }
+
+        cSpec[ xSpecLength ] = '\0';
+        xRemaining = configLOGGING_MAX_MESSAGE_LENGTH - xLength;
+        iWritten = 0;
+
+        switch( xSpec.eArgument )
+        {
+            case eLoggingArgNone:
+                iWritten = snprintf( &pcOutput[ xLength ], xRemaining, "%%" );
+                break;
+
+            case eLoggingArgInt:
+            {
+                int iValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &iValue, sizeof( iValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, iValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgLong:
+            {
+                long lValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &lValue, sizeof( lValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, lValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgLongLong:
+            {
+                long long llValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &llValue, sizeof( llValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, llValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgSize:
+            {
+                size_t xValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &xValue, sizeof( xValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, xValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgPointer:
+            {
+                void * pvValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &pvValue, sizeof( pvValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, pvValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgDouble:
+            {
+                double dValue;
+                xAvailable &= prvRecordGet( pulRecord, &ulIndex, &dValue, sizeof( dValue ) );
+                iWritten = ( xAvailable == pdTRUE ) ? snprintf( &pcOutput[ xLength ], xRemaining, cSpec, dValue ) : 0;
+                break;
+            }
+
+            case eLoggingArgString:
+            {
+                uint32_t ulLength = pulRecord[ loggingRECORD_HEADER ] & loggingRECORD_LENGTH_MASK;
+                const char * pcValue = ( const char * ) &pulRecord[ ulIndex ];
+                size_t xBytes;
+
+                /* The string was recorded with its terminator. */
+                xAvailable &= ( ulIndex < ulLength ) ? pdTRUE : pdFALSE;
+
+                if( xAvailable == pdTRUE )
+                {
+                    xBytes = strlen( pcValue ) + 1;
+                    ulIndex += loggingBYTES_TO_WORDS( xBytes );
+                    iWritten = snprintf( &pcOutput[ xLength ], xRemaining, cSpec, pcValue );
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if( xAvailable == pdTRUE )
+        {
+            pcLiteral = xSpec.pcEnd;
+        }
+
+        if( iWritten > 0 )
+        {
+            xLength += ( ( size_t ) iWritten < xRemaining ) ? ( size_t ) iWritten : xRemaining - 1;
+        }
+    }
+
+    /* Copy the text after the last specification, unless an argument was
+     * missing. */
+    if( ( xAvailable == pdTRUE ) && ( ( pc == NULL ) || ( xSpec.eArgument != eLoggingArgInvalid ) ) )
+    {
+        pc = pcLiteral + strlen( pcLiteral );
+    }
+
+    if( ( pc != NULL ) && ( xLength < configLOGGING_MAX_MESSAGE_LENGTH - 1 ) )
+    {
+        size_t xRemaining = configLOGGING_MAX_MESSAGE_LENGTH - 1 - xLength;
+
+        if( ( size_t ) ( pc - pcLiteral ) < xRemaining )
+        {
+            xRemaining = pc - pcLiteral;
+        }
+
+        memcpy( &pcOutput[ xLength ], pcLiteral, xRemaining );
+        xLength += xRemaining;
+    }
+
+    pcOutput[ xLength ] = '\0';
+
+    return xLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingTask( void * pvParameters )
+{
+    /* One extra word so that string records can be terminated in place. */
+    static uint32_t ulRecord[ configLOGGING_MAX_RECORD_WORDS + 1 ];
+    static char cOutput[ configLOGGING_MAX_MESSAGE_LENGTH ];
+    static char cTaskName[ configMAX_TASK_NAME_LEN ];
+    LoggingRing_t * pxRing;
+    LoggingRing_t * pxOldest;
+    UBaseType_t uxRing;
+    uint32_t ulLength;
+    uint32_t ulIndex;
+    uint32_t ulDropped;
+    const char * pcTaskName;
+
+    ( void ) pvParameters;
+
+    for( ;; )
+    {
+        /* Block to wait for the next message to print. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        for( ;; )
+        {
+            /* Pick the ring holding the oldest message. */
+            pxOldest = NULL;
+
+            for( uxRing = 0; uxRing <= configLOGGING_RING_COUNT; uxRing++ )
+            {
+                pxRing = ( uxRing < configLOGGING_RING_COUNT ) ? &xRings[ uxRing ] : &xSharedRing;
+
+                if( pxRing->ulHead != pxRing->ulTail )
+                {
+                    if( ( pxOldest == NULL ) ||
+                        ( ( int32_t ) ( pxRing->ulWords[ ( pxRing->ulTail + loggingRECORD_TICK ) & loggingRING_MASK ] -
+                                        pxOldest->ulWords[ ( pxOldest->ulTail + loggingRECORD_TICK ) & loggingRING_MASK ] ) < 0 ) )
+                    {
+                        pxOldest = pxRing;
+                    }
+                }
+            }
+
+            if( pxOldest == NULL )
+            {
+                break;
+            }
+
+            loggingMEMORY_BARRIER();
+
+            /* Take a copy of the record, so that the ring space can be
+             * released before the slow output. */
+            ulLength = pxOldest->ulWords[ pxOldest->ulTail & loggingRING_MASK ] & loggingRECORD_LENGTH_MASK;
+
+            for( ulIndex = 0; ulIndex < ulLength; ulIndex++ )
+            {
+                ulRecord[ ulIndex ] = pxOldest->ulWords[ ( pxOldest->ulTail + ulIndex ) & loggingRING_MASK ];
+            }
+
+            /* Copy the name too, as an emptied ring can be claimed by
+             * another task once its tail is released. */
+            memcpy( cTaskName, pxOldest->cTaskName, sizeof( cTaskName ) );
+            pcTaskName = cTaskName;
+
+            if( ( ulRecord[ loggingRECORD_HEADER ] & loggingRECORD_HAS_NAME ) != 0 )
+            {
+                /* The record buffer has room for the terminator. */
+                pcTaskName = ( const char * ) &ulRecord[ loggingRECORD_FIXED_WORDS ];
+                ( ( char * ) &ulRecord[ loggingRECORD_FIXED_WORDS ] )[ configMAX_TASK_NAME_LEN - 1 ] = '\0';
+            }
+
+            loggingMEMORY_BARRIER();
+            pxOldest->ulTail += ulLength;
+            loggingMEMORY_BARRIER();
+
+            if( ( ulRecord[ loggingRECORD_HEADER ] & loggingRECORD_STRING ) != 0 )
+            {
+                ulIndex = ( ( ulRecord[ loggingRECORD_HEADER ] & loggingRECORD_HAS_NAME ) != 0 ) ?
+                          loggingRECORD_FIXED_WORDS + loggingNAME_WORDS : loggingRECORD_FIXED_WORDS;
+                ( ( char * ) &ulRecord[ ulIndex ] )[ ulRecord[ loggingRECORD_FORMAT ] ] = '\0';
+                configPRINT_STRING( ( const char * ) &ulRecord[ ulIndex ] );
+            }
+            else if( prvFormatRecord( ulRecord, pcTaskName, cOutput ) > 0 )
+            {
+                configPRINT_STRING( cOutput );
+            }
+
+            /* Report messages dropped while the ring was full. */
+            ulDropped = pxOldest->ulDropped;
+
+            if( ulDropped != pxOldest->ulDroppedReported )
+            {
+                snprintf( cOutput, sizeof( cOutput ), "[%s] %lu log messages dropped\r\n",
+                          ( pxOldest == &xSharedRing ) ? "Shared" : cTaskName,
+                          ( unsigned long ) ( ulDropped - pxOldest->ulDroppedReported ) );
+                pxOldest->ulDroppedReported = ulDropped;
+                configPRINT_STRING( cOutput );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
@@ -52,33 +52,23 @@
 
 /* Required for shadow APIs. */
 #include "aws_shadow.h"
+#include "aws_shadow_state.h"
 
 /* Required for shadow demo. */
 #include "aws_shadow_lightbulb_on_off.h"
-#include "jsmn.h"
 
 /* Task names. */
 #define shadowDemoCHAR_TASK_NAME           "Shd-IOT-%d"
 #define shadowDemoUPDATE_TASK_NAME         "ShDemoUpdt"
 
-/* Format string and length of the initial reported state, "red". */
-#define shadowDemoINITIAL_REPORT_FORMAT    "{\"%s\": \"red\"}"
-#define shadowDemoINITIAL_REPORT_BUFFER_LENGTH \
-    ( sizeof( shadowDemoCHAR_TASK_NAME ) + sizeof( shadowDemoINITIAL_REPORT_FORMAT ) )
+/* The initial reported state, "red", as JSON text. */
+#define shadowDemoINITIAL_REPORT    "\"red\""
 
-/* JSON formats used in the Shadow tasks. Note the inclusion of the "clientToken"
+/* JSON format used in the Shadow tasks. Note the inclusion of the "clientToken"
  * key, which is REQUIRED by the Shadow API. The "clientToken" may be anything, as
  * long as it's unique. This demo uses "token-" suffixed with the RTOS tick count
- * at the time the JSON document is generated. */
-#define shadowDemoREPORT_JSON       \
-    "{"                             \
-    "\"state\":{"                   \
-    "\"reported\":"                 \
-    "%.*s"                          \
-    "},"                            \
-    "\"clientToken\": \"token-%d\"" \
-    "}"
-
+ * at the time the JSON document is generated. The reported state is published
+ * by the Shadow state, which generates its own client tokens. */
 #define shadowDemoDESIRED_JSON      \
     "{"                             \
     "\"state\":{"                   \
@@ -107,8 +97,9 @@
 /* Stack size for task that handles shadow delta and updates. */
 #define shadowDemoUPDATE_TASK_STACK_SIZE     ( ( uint16_t ) configMINIMAL_STACK_SIZE * ( uint16_t ) 5 )
 
-/* Maximum number of jsmn tokens. */
-#define shadowDemoMAX_TOKENS                 40
+/* Reported changes made within this time of each other are published in
+ * one update. */
+#define shadowDemoREPORT_COALESCE_TICKS      pdMS_TO_TICKS( 250UL )
 
 /* Queue configuration parameters. */
 #define shadowDemoSEND_QUEUE_WAIT_TICKS      3000
@@ -149,16 +140,16 @@ static BaseType_t prvDeltaCallback( void * pvUserData,
                                     uint32_t ulDocumentLength,
                                     MQTTBufferHandle_t xBuffer );
 
+/* Called by the Shadow state when the desired state of a bulb changes. */
+static void prvDesiredCallback( void * pvUserData,
+                                const char * pcKey,
+                                const char * pcValue,
+                                uint8_t ucValueLength );
+
 /* JSON functions. */
 static uint32_t prvGenerateDesiredJSON( ShadowQueueData_t * const pxShadowQueueData,
                                         const char * const pcTaskName,
                                         uint8_t ucBulbState );
-static uint32_t prvGenerateReportedJSON( ShadowQueueData_t * const pxShadowQueueData,
-                                         const char * const pcReportedData,
-                                         uint32_t ulReportedDataLength );
-static BaseType_t prvIsStringEqual( const char * const pcJson,     /*lint !e971 can use char without signed/unsigned. */
-                                    const jsmntok_t * const pxTok,
-                                    const char * const pcString ); /*lint !e971 can use char without signed/unsigned. */
 
 /* The update queue's handle, data structure, and memory. */
 static QueueHandle_t xUpdateQueue = NULL;
@@ -170,6 +161,10 @@ static ShadowClientHandle_t xClientHandle;
 /* Memory allocated to store the Shadow task params. */
 static ShadowTaskParam_t xShadowTaskParamBuffer[ democonfigSHADOW_DEMO_NUM_TASKS ];
 
+/* Local copy of the Shadow. Each bulb is a key named after its task. */
+static ShadowState_t xShadowState;
+static const char * pcShadowStateKeys[ democonfigSHADOW_DEMO_NUM_TASKS ];
+
 /*-----------------------------------------------------------*/
 
 static uint32_t prvGenerateDesiredJSON( ShadowQueueData_t * const pxShadowQueueData,
@@ -188,37 +183,18 @@ static uint32_t prvGenerateDesiredJSON( ShadowQueueData_t * const pxShadowQueueD
 }
 /*-----------------------------------------------------------*/
 
-static uint32_t prvGenerateReportedJSON( ShadowQueueData_t * const pxShadowQueueData,
-                                         const char * const pcReportedData,
-                                         uint32_t ulReportedDataLength )
+static void prvDesiredCallback( void * pvUserData,
+                                const char * pcKey,
+                                const char * pcValue,
+                                uint8_t ucValueLength )
 {
-    return ( uint32_t ) snprintf( ( char * ) ( pxShadowQueueData->pcUpdateBuffer ),
-                                  shadowDemoBUFFER_LENGTH,
-                                  shadowDemoREPORT_JSON,
-                                  ( int ) ulReportedDataLength,
-                                  pcReportedData,
-                                  ( int ) xTaskGetTickCount() );
-}
-
-/*-----------------------------------------------------------*/
-
-static BaseType_t prvIsStringEqual( const char * const pcJson,    /*lint !e971 can use char without signed/unsigned. */
-                                    const jsmntok_t * const pxTok,
-                                    const char * const pcString ) /*lint !e971 can use char without signed/unsigned. */
-{
-    uint32_t ulStringSize = ( uint32_t ) pxTok->end - ( uint32_t ) pxTok->start;
-    BaseType_t xStatus = pdFALSE;
+    ( void ) pvUserData;
 
-    if( pxTok->type == JSMN_STRING )
-    {
-        if( ( pcString[ ulStringSize ] == 0 ) &&
-            ( strncmp( pcJson + pxTok->start, pcString, ulStringSize ) == 0 ) )
-        {
-            xStatus = pdTRUE;
-        }
-    }
+    configPRINTF( ( "%s desired state changed to %.*s.\r\n", pcKey, ( int ) ucValueLength, pcValue ) );
 
-    return xStatus;
+    /* The bulb takes the desired state at once. The Shadow state coalesces the
+     * new reported states of all bulbs into one update. */
+    ( void ) SHADOW_StateSetReported( &xShadowState, pcKey, pcValue, ucValueLength );
 }
 
 /*-----------------------------------------------------------*/
@@ -229,56 +205,20 @@ static BaseType_t prvDeltaCallback( void * pvUserData,
                                     uint32_t ulDocumentLength,
                                     MQTTBufferHandle_t xBuffer )
 {
-    int32_t lNbTokens;
-    uint16_t usTokenIndex;
-    uint32_t ulStringSize;
-    jsmn_parser xJSMNParser;
-    ShadowQueueData_t xShadowQueueData;
-    jsmntok_t pxJSMNTokens[ shadowDemoMAX_TOKENS ];
+    ShadowReturnCode_t xReturn;
 
     /* Silence compiler warnings about unused variables. */
     ( void ) pvUserData;
     ( void ) xBuffer;
     ( void ) pcThingName;
 
-    jsmn_init( &xJSMNParser );
-    memset( &xShadowQueueData, 0x00, sizeof( ShadowQueueData_t ) );
-
-    lNbTokens = ( int32_t ) jsmn_parse( &xJSMNParser,
-                                        pcDeltaDocument,
-                                        ( size_t ) ulDocumentLength,
-                                        pxJSMNTokens,
-                                        ( unsigned int ) shadowDemoMAX_TOKENS );
+    /* Only the bulbs in the delta are updated, prvDesiredCallback() is called
+     * for those whose desired state changed. */
+    xReturn = SHADOW_StateApplyDelta( &xShadowState, pcDeltaDocument, ulDocumentLength );
 
-    if( lNbTokens > 0 )
+    if( xReturn != eShadowSuccess )
     {
-        /* Find the new reported state. */
-        for( usTokenIndex = 0; usTokenIndex < ( uint16_t ) lNbTokens; usTokenIndex++ )
-        {
-            if( prvIsStringEqual( pcDeltaDocument, &pxJSMNTokens[ usTokenIndex ], "state" ) == pdTRUE )
-            {
-                ulStringSize = pxJSMNTokens[ usTokenIndex + ( uint16_t ) 1 ].end
-                               - pxJSMNTokens[ usTokenIndex + ( uint16_t ) 1 ].start;
-                configASSERT( ulStringSize < shadowDemoBUFFER_LENGTH );
-
-                /* Generate a new JSON document with new reported state. */
-                xShadowQueueData.ulDataLength = prvGenerateReportedJSON( &xShadowQueueData,
-                                                                         &pcDeltaDocument[ pxJSMNTokens[ usTokenIndex + ( uint16_t ) 1 ].start ],
-                                                                         ulStringSize );
-
-                /* Add new reported state to update queue. */
-                if( xQueueSendToBack( xUpdateQueue, &xShadowQueueData, shadowDemoSEND_QUEUE_WAIT_TICKS ) == pdTRUE )
-                {
-                    configPRINTF( ( "Successfully added new reported state to update queue.\r\n" ) );
-                }
-                else
-                {
-                    configPRINTF( ( "Update queue full, deferring reported state update.\r\n" ) );
-                }
-
-                break;
-            }
-        }
+        configPRINTF( ( "Failed to apply delta, returned %d.\r\n", xReturn ) );
     }
 
     return pdFALSE;
@@ -291,6 +231,7 @@ static void prvUpdateQueueTask( void * pvParameters )
     ShadowReturnCode_t xReturn;
     ShadowOperationParams_t xUpdateParams;
     ShadowQueueData_t xShadowQueueData;
+    TickType_t xWaitTicks;
 
     ( void ) pvParameters;
 
@@ -302,7 +243,15 @@ static void prvUpdateQueueTask( void * pvParameters )
 
     for( ; ; )
     {
-        if( xQueueReceive( xUpdateQueue, &xShadowQueueData, shadowDemoRECV_QUEUE_WAIT_TICKS ) == pdTRUE )
+        /* Publish the reported states once they have been coalesced. */
+        xWaitTicks = SHADOW_StateProcess( &xShadowState, shadowDemoTIMEOUT );
+
+        if( xWaitTicks > shadowDemoRECV_QUEUE_WAIT_TICKS )
+        {
+            xWaitTicks = shadowDemoRECV_QUEUE_WAIT_TICKS;
+        }
+
+        if( xQueueReceive( xUpdateQueue, &xShadowQueueData, xWaitTicks ) == pdTRUE )
         {
             configPRINTF( ( "Performing Thing Shadow update.\r\n" ) );
             xUpdateParams.ulDataLength = xShadowQueueData.ulDataLength;
@@ -372,28 +321,21 @@ static ShadowReturnCode_t prvShadowClientCreateConnect( void )
 static void prvChangeDesiredTask( void * pvParameters )
 {
     uint8_t ucBulbState = 0;
-    uint32_t ulInitialReportLength;
     TickType_t xLastWakeTime;
     ShadowTaskParam_t * pxShadowTaskParam;
     ShadowQueueData_t xShadowQueueData;
-    char pcInitialReportBuffer[ shadowDemoINITIAL_REPORT_BUFFER_LENGTH ];
 
     /* Initialize parameters. */
     pxShadowTaskParam = ( ShadowTaskParam_t * ) pvParameters; /*lint !e9087 Safe cast from context. */
     memset( &xShadowQueueData, 0x00, sizeof( ShadowQueueData_t ) );
     xShadowQueueData.xTaskToNotify = pxShadowTaskParam->xTaskHandle;
 
-    /* Add the initial state to the update queue, wait for the update to complete. */
-    ulInitialReportLength = snprintf( pcInitialReportBuffer,
-                                      shadowDemoINITIAL_REPORT_BUFFER_LENGTH,
-                                      shadowDemoINITIAL_REPORT_FORMAT,
-                                      pxShadowTaskParam->cTaskName );
-    xShadowQueueData.ulDataLength = prvGenerateReportedJSON( &xShadowQueueData,
-                                                             pcInitialReportBuffer,
-                                                             ulInitialReportLength );
-    /* The calls below should never fail because the queue should be empty currently. */
-    configASSERT( xQueueSendToBack( xUpdateQueue, &xShadowQueueData, shadowDemoSEND_QUEUE_WAIT_TICKS ) == pdTRUE );
-    configASSERT( ulTaskNotifyTake( pdTRUE, shadowDemoNOTIFY_WAIT_MS ) == 1 );
+    /* Report the initial state. The initial states of all tasks are published
+     * together by the update task. */
+    configASSERT( SHADOW_StateSetReported( &xShadowState,
+                                           pxShadowTaskParam->cTaskName,
+                                           shadowDemoINITIAL_REPORT,
+                                           ( uint8_t ) ( sizeof( shadowDemoINITIAL_REPORT ) - 1 ) ) == pdPASS );
 
     xLastWakeTime = xTaskGetTickCount();
 
@@ -431,6 +373,7 @@ static void prvShadowInitTask( void * pvParameters )
     ShadowReturnCode_t xReturn;
     ShadowOperationParams_t xOperationParams;
     ShadowCallbackParams_t xCallbackParams;
+    ShadowStateParams_t xStateParams;
 
     ( void ) pvParameters;
 
@@ -474,6 +417,32 @@ static void prvShadowInitTask( void * pvParameters )
         }
     }
 
+    if( xReturn == eShadowSuccess )
+    {
+        /* Name the Shadow tasks, the names are the keys of the Shadow state. */
+        for( ucTask = 0; ucTask < ( uint8_t ) democonfigSHADOW_DEMO_NUM_TASKS; ucTask++ )
+        {
+            ( void ) snprintf( ( char * ) ( &( xShadowTaskParamBuffer[ ucTask ] ) )->cTaskName,
+                               shadowDemoCHAR_TASK_NAME_MAX_SIZE,
+                               shadowDemoCHAR_TASK_NAME,
+                               ucTask );
+            pcShadowStateKeys[ ucTask ] = ( &( xShadowTaskParamBuffer[ ucTask ] ) )->cTaskName;
+        }
+
+        xStateParams.xShadowClientHandle = xClientHandle;
+        xStateParams.pcThingName = shadowDemoTHING_NAME;
+        xStateParams.ppcKeys = pcShadowStateKeys;
+        xStateParams.uxKeyCount = ( UBaseType_t ) democonfigSHADOW_DEMO_NUM_TASKS;
+        xStateParams.xCoalesceTicks = shadowDemoREPORT_COALESCE_TICKS;
+        xStateParams.xDesiredCallback = prvDesiredCallback;
+        xStateParams.pvUserData = NULL;
+
+        if( SHADOW_StateInit( &xShadowState, &xStateParams ) != pdPASS )
+        {
+            xReturn = eShadowFailure;
+        }
+    }
+
     if( xReturn == eShadowSuccess )
     {
         configPRINTF( ( "Shadow client initialized.\r\n" ) );
@@ -489,10 +458,6 @@ static void prvShadowInitTask( void * pvParameters )
         /* Create the Shadow demo tasks which update the "desired" states. */
         for( ucTask = 0; ucTask < ( uint8_t ) democonfigSHADOW_DEMO_NUM_TASKS; ucTask++ )
         {
-            ( void ) snprintf( ( char * ) ( &( xShadowTaskParamBuffer[ ucTask ] ) )->cTaskName,
-                               shadowDemoCHAR_TASK_NAME_MAX_SIZE,
-                               shadowDemoCHAR_TASK_NAME,
-                               ucTask );
             ( void ) xTaskCreate( prvChangeDesiredTask,
                                   ( const char * ) ( &( xShadowTaskParamBuffer[ ucTask ] ) )->cTaskName,
                                   democonfigSHADOW_DEMO_TASK_STACK_SIZE,
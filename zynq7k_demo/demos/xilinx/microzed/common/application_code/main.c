@@ -49,6 +49,12 @@
 #include "aws_clientcredential.h"
 #include "platform_config.h"
 #include "aws_dev_mode_key_provisioning.h"
+#include "aws_trace_drain.h"
+#include "aws_telemetry.h"
+#include "aws_platform_fs.h"
+
+/* Board includes. */
+#include "uzed_hrtimer.h"
 
 /* Logging Task Defines. */
 #define mainLOGGING_MESSAGE_QUEUE_LENGTH    ( 15 )
@@ -140,6 +146,11 @@ static void prvSRand( UBaseType_t ulSeed );
  */
 static void prvMiscInitialization( void );
 
+/**
+ * @brief Prints where the libraries' static memory is placed and the heap usage.
+ */
+static void prvPrintMemoryMap( void );
+
 /* Use by the pseudo random number generator. */
 static UBaseType_t ulNextRand;
 
@@ -194,7 +205,6 @@ static void prvSRand( UBaseType_t ulSeed )
 	ulNextRand = ulSeed;
 }
 
-extern int platform_init_fs();
 static void prvMiscInitialization( void )
 {
 	time_t xTimeNow;
@@ -215,7 +225,71 @@ static void prvMiscInitialization( void )
 void vApplicationDaemonTaskStartupHook( void )
 {
     /* Perform any hardware initialization, that require the RTOS to be
-     * running, here. NOTHING to be done here for now */
+     * running, here. */
+    if( xUZedHrTimerInit() != pdPASS )
+    {
+        configPRINTF( ( "Failed to start the high resolution timers.\r\n" ) );
+    }
+
+    prvPrintMemoryMap();
+}
+/*-----------------------------------------------------------*/
+
+/* Bounds of the libraries' static memory, defined in lscript.ld. */
+extern uint8_t __afr_static_mqtt_start[], __afr_static_mqtt_end[];
+extern uint8_t __afr_static_bufferpool_start[], __afr_static_bufferpool_end[];
+extern uint8_t __afr_static_shadow_start[], __afr_static_shadow_end[];
+extern uint8_t __afr_static_ota_start[], __afr_static_ota_end[];
+extern uint8_t __afr_static_defender_start[], __afr_static_defender_end[];
+extern uint8_t __afr_static_telemetry_start[], __afr_static_telemetry_end[];
+extern uint8_t __afr_static_taskstats_start[], __afr_static_taskstats_end[];
+extern uint8_t __afr_static_hrtimer_start[], __afr_static_hrtimer_end[];
+extern uint8_t __afr_static_sockets_start[], __afr_static_sockets_end[];
+
+static void prvPrintMemoryMap( void )
+{
+    const struct
+    {
+        const char * pcName;
+        const uint8_t * pucStart;
+        const uint8_t * pucEnd;
+    } xRegions[] =
+    {
+        { "MQTT agent", __afr_static_mqtt_start,       __afr_static_mqtt_end       },
+        { "Bufferpool", __afr_static_bufferpool_start, __afr_static_bufferpool_end },
+        { "Shadow",     __afr_static_shadow_start,     __afr_static_shadow_end     },
+        { "OTA agent",  __afr_static_ota_start,        __afr_static_ota_end        },
+        { "Defender",   __afr_static_defender_start,   __afr_static_defender_end   },
+        { "Telemetry",  __afr_static_telemetry_start,  __afr_static_telemetry_end  },
+        { "Task stats", __afr_static_taskstats_start,  __afr_static_taskstats_end  },
+        { "HR timers",  __afr_static_hrtimer_start,    __afr_static_hrtimer_end    },
+        { "Sockets",    __afr_static_sockets_start,    __afr_static_sockets_end    },
+    };
+    HeapStats_t xHeapStats;
+    uint32_t ulTotal = 0;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ( sizeof( xRegions ) / sizeof( xRegions[ 0 ] ) ); ulIndex++ )
+    {
+        uint32_t ulSize = ( uint32_t ) ( xRegions[ ulIndex ].pucEnd - xRegions[ ulIndex ].pucStart );
+
+        configPRINTF( ( "%-10s 0x%08lx %6lu bytes\r\n",
+                        xRegions[ ulIndex ].pcName,
+                        ( unsigned long ) xRegions[ ulIndex ].pucStart,
+                        ( unsigned long ) ulSize ) );
+        ulTotal += ulSize;
+    }
+
+    /* The allocation and free counts stay constant once the libraries have
+     * started if they are built with configSUPPORT_STATIC_ALLOCATION. */
+    vPortGetHeapStats( &xHeapStats );
+    configPRINTF( ( "Static library memory %lu bytes, heap %lu of %lu bytes free (minimum %lu), %lu allocations, %lu frees\r\n",
+                    ( unsigned long ) ulTotal,
+                    ( unsigned long ) xHeapStats.xAvailableHeapSpaceInBytes,
+                    ( unsigned long ) configTOTAL_HEAP_SIZE,
+                    ( unsigned long ) xHeapStats.xMinimumEverFreeBytesRemaining,
+                    ( unsigned long ) xHeapStats.xNumberOfSuccessfulAllocations,
+                    ( unsigned long ) xHeapStats.xNumberOfSuccessfulFrees ) );
 }
 /*-----------------------------------------------------------*/
 
@@ -231,6 +305,10 @@ void vApplicationIPNetworkEventHook( eIPCallbackEvent_t eNetworkEvent )
         {
             /* This is not needed for the workshop as key are already provisioned. */
         	//vDevModeKeyProvisioning( );
+            #if ( configUSE_AWS_TRACE == 1 )
+                ( void ) TRACE_StartSocketDrain();
+            #endif
+            ( void ) TELEMETRY_Start();
             DEMO_RUNNER_RunDemos();
             xTasksAlreadyCreated = pdTRUE;
         }
@@ -2,6 +2,8 @@
 
 #define HR_GETTIME_H
 
+#include <stdint.h>
+
 void init_timer( int xTimer );
 
 /* Start-up the high-resolution timer. */
@@ -10,5 +12,8 @@ void vStartHighResolutionTimer( void );
 /* Get the current time measured in uS. */
 unsigned long long ullGetHighResolutionTime( void );
 
+/* Get the run time stats counter, derived from the same global timer. */
+uint32_t ulGetRunTimeCounterValue( void );
+
 #endif
 
@@ -0,0 +1,196 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file uzed_amp.c
+ * @brief Second Cortex-A9 core as a network coprocessor.
+ *
+ * The rings live in a DDR section mapped shareable and non-cacheable on both
+ * cores, so no cache maintenance is needed around ring accesses and the
+ * barriers in aws_amp_ring.c are enough to order them. Each ring index has a
+ * single writer, so no exclusive accesses are made to the shared section.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Xilinx includes. */
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xil_io.h"
+#include "xil_mmu.h"
+#include "xpseudo_asm.h"
+
+/* AMP includes. */
+#include "aws_amp_sockets.h"
+
+#include "uzed_amp.h"
+
+#define ampINTC_BASE_ADDR         XPAR_SCUGIC_CPU_BASEADDR
+#define ampINTC_DIST_BASE_ADDR    XPAR_SCUGIC_DIST_BASEADDR
+
+/* Register polled by CPU1 while it waits in the boot ROM. */
+#define ampCPU1_START_ADDRESS     ( 0xFFFFFFF0UL )
+
+/* Ring carrying requests to CPU1, then ring carrying replies to CPU0. */
+#define ampTO_CPU1_RING           ( ( void * ) uzedampSHARED_MEMORY_BASE )
+#define ampTO_CPU0_RING           ( ( void * ) ( uzedampSHARED_MEMORY_BASE + uzedampRING_SIZE ) )
+
+/* SGI target list holding only the other core. */
+#define ampOTHER_CPU_MASK         ( 1UL << ( 1UL - XPAR_CPU_ID ) )
+
+/**
+ * @brief Channel to the other core.
+ */
+static AmpChannel_t xChannel;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Raise the doorbell SGI on the other core.
+ */
+static void prvRingDoorbell( void * pvContext );
+
+/**
+ * @brief Doorbell SGI handler.
+ */
+static void prvDoorbellHandler( void * pvContext );
+
+/**
+ * @brief Map the shared section and install the doorbell handler.
+ */
+static void prvInitializeSharedResources( void );
+
+/*-----------------------------------------------------------*/
+
+static void prvRingDoorbell( void * pvContext )
+{
+    ( void ) pvContext;
+
+    /* The ring writes must complete before the other core takes the SGI. */
+    dsb();
+
+    XScuGic_WriteReg( ampINTC_DIST_BASE_ADDR,
+                      XSCUGIC_SFI_TRIG_OFFSET,
+                      ( ampOTHER_CPU_MASK << 16 ) | uzedampDOORBELL_SGI );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDoorbellHandler( void * pvContext )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ( void ) pvContext;
+
+    AMP_ChannelDoorbellFromISR( &xChannel, &xHigherPriorityTaskWoken );
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInitializeSharedResources( void )
+{
+    const uint8_t ucRisingEdge = 3;
+
+    Xil_SetTlbAttributes( uzedampSHARED_MEMORY_BASE, NORM_NONCACHE );
+
+    /* SGI priorities are banked, each core sets its own. The handler uses the
+     * FreeRTOS API, so it must not be above the API call priority. */
+    XScuGic_RegisterHandler( ampINTC_BASE_ADDR,
+                             uzedampDOORBELL_SGI,
+                             ( Xil_InterruptHandler ) prvDoorbellHandler,
+                             NULL );
+    XScuGic_SetPriTrigTypeByDistAddr( ampINTC_DIST_BASE_ADDR,
+                                      uzedampDOORBELL_SGI,
+                                      portLOWEST_USABLE_INTERRUPT_PRIORITY << portPRIORITY_SHIFT,
+                                      ucRisingEdge );
+    XScuGic_EnableIntr( ampINTC_DIST_BASE_ADDR, uzedampDOORBELL_SGI );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xAmpStartNetworkCore( void )
+{
+    BaseType_t xStatus = pdFAIL;
+    AmpRing_t * pxToCpu1 = NULL;
+    AmpRing_t * pxToCpu0 = NULL;
+
+    prvInitializeSharedResources();
+
+    pxToCpu1 = AMP_RingInit( ampTO_CPU1_RING, uzedampRING_SIZE );
+    pxToCpu0 = AMP_RingInit( ampTO_CPU0_RING, uzedampRING_SIZE );
+
+    if( ( pxToCpu1 != NULL ) && ( pxToCpu0 != NULL ) )
+    {
+        xStatus = AMP_ChannelInit( &xChannel,
+                                   pxToCpu1,
+                                   pxToCpu0,
+                                   prvRingDoorbell,
+                                   NULL,
+                                   NULL,
+                                   NULL );
+    }
+
+    if( xStatus == pdPASS )
+    {
+        AMP_SOCKETS_ClientInit( &xChannel );
+
+        /* Release CPU1 from the boot ROM wait loop. */
+        Xil_Out32( ampCPU1_START_ADDRESS, uzedampCPU1_ENTRY_ADDRESS );
+        dsb();
+        __asm__ __volatile__ ( "sev" );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xAmpServeApplicationCore( void )
+{
+    BaseType_t xStatus = pdFAIL;
+
+    prvInitializeSharedResources();
+
+    /* The rings were initialized by CPU0 before it released this core. */
+    xStatus = AMP_SOCKETS_ServerInit();
+
+    if( xStatus == pdPASS )
+    {
+        xStatus = AMP_ChannelInit( &xChannel,
+                                   ( AmpRing_t * ) ampTO_CPU0_RING,
+                                   ( AmpRing_t * ) ampTO_CPU1_RING,
+                                   prvRingDoorbell,
+                                   NULL,
+                                   AMP_SOCKETS_ServerHandleRequest,
+                                   NULL );
+    }
+
+    return xStatus;
+}
@@ -0,0 +1,99 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file uzed_amp.h
+ * @brief Second Cortex-A9 core as a network coprocessor.
+ *
+ * In the AMP configuration CPU0 runs the application (demos, MQTT agent,
+ * shadow) and CPU1 runs a second FreeRTOS instance with FreeRTOS+TCP, the
+ * secure sockets port and TLS. The application core links
+ * aws_amp_secure_sockets.c in place of a secure sockets port, so every
+ * SOCKETS_* call is carried to CPU1 over a pair of lock-free rings in a
+ * shared DDR section, with a software generated interrupt (SGI) as doorbell.
+ *
+ * CPU1 is built as a separate image with the BSP USE_AMP option, which keeps
+ * it from reinitializing the shared interrupt distributor, and a linker script
+ * that places it at uzedampCPU1_ENTRY_ADDRESS. Neither image may place
+ * anything in the uzedampSHARED_MEMORY_BASE section.
+ */
+
+#ifndef _UZED_AMP_H_
+#define _UZED_AMP_H_
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Start of the 1 MB section holding the two rings. Mapped shareable
+ * and non-cacheable on both cores.
+ */
+#ifndef uzedampSHARED_MEMORY_BASE
+    #define uzedampSHARED_MEMORY_BASE    ( 0x3FF00000UL )
+#endif
+
+/**
+ * @brief Bytes of shared memory given to each ring, control block included.
+ */
+#ifndef uzedampRING_SIZE
+    #define uzedampRING_SIZE             ( 64UL * 1024UL )
+#endif
+
+/**
+ * @brief SGI used as doorbell in both directions. 0 to 15.
+ */
+#ifndef uzedampDOORBELL_SGI
+    #define uzedampDOORBELL_SGI          ( 15UL )
+#endif
+
+/**
+ * @brief Address CPU1 jumps to when started, the start of its image.
+ */
+#ifndef uzedampCPU1_ENTRY_ADDRESS
+    #define uzedampCPU1_ENTRY_ADDRESS    ( 0x20000000UL )
+#endif
+
+/**
+ * @brief Set up the rings, route the SOCKETS_* API over them and release CPU1.
+ *
+ * Called on CPU0 from a task, after the scheduler has initialized the
+ * interrupt controller and before SOCKETS_Init().
+ *
+ * @return pdPASS if the channel was created, pdFAIL otherwise.
+ */
+BaseType_t xAmpStartNetworkCore( void );
+
+/**
+ * @brief Serve socket calls from CPU0.
+ *
+ * Called on CPU1 from a task, after FreeRTOS_IPInit(). The rings must have
+ * been set up by xAmpStartNetworkCore(), which is always the case since CPU1
+ * is only released by it.
+ *
+ * @return pdPASS if the channel and workers were created, pdFAIL otherwise.
+ */
+BaseType_t xAmpServeApplicationCore( void );
+
+#endif /* _UZED_AMP_H_ */
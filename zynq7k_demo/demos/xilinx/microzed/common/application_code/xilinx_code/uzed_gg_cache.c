@@ -0,0 +1,245 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file uzed_gg_cache.c
+ * @brief Last good Greengrass core, kept on the SD card.
+ *
+ * Saves the core address, port and group CA certificate of the last
+ * successful Greengrass connection so the next boot can connect straight
+ * away instead of running the discovery round trip to the cloud first.
+ * The certificate is stored with its SHA-256 hash, a cache whose certificate
+ * does not match the hash is ignored.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Xilinx includes. */
+#include "ff.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/sha256.h"
+
+#include "uzed_gg_cache.h"
+#include "aws_platform_fs.h"
+
+#define ggcacheFILE_NAME    "FreeRTOS_GG_CoreCache.dat"
+#define ggcacheMAGIC        ( 0x47474331UL ) /* "GGC1" */
+#define ggcacheHASH_SIZE    ( 32 )
+
+/**
+ * @brief Layout of the beginning of the cache file, the certificate follows.
+ */
+typedef struct
+{
+    uint32_t ulMagic;
+    uint16_t usPort;
+    uint16_t usUseCount;
+    uint32_t ulCertificateSize; /* Including the '\0'. */
+    uint8_t ucCertificateHash[ ggcacheHASH_SIZE ];
+    char cHostAddress[ ggdconfigHOST_ADDRESS_MAX_LENGTH + 1 ];
+} GGCacheHeader_t;
+
+/**
+ * @brief Write the header at the beginning of the cache file.
+ */
+static BaseType_t prvWriteHeader( const GGCacheHeader_t * pxHeader,
+                                  const char * pcCertificate );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteHeader( const GGCacheHeader_t * pxHeader,
+                                  const char * pcCertificate )
+{
+    static FIL xFile;
+    UINT uxWritten = 0;
+    BaseType_t xStatus = pdFAIL;
+    BYTE ucMode = FA_WRITE;
+
+    /* A NULL certificate only updates the header of an existing file. */
+    if( pcCertificate != NULL )
+    {
+        ucMode |= FA_CREATE_ALWAYS;
+    }
+
+    /* FatFs is not re-entrant, access it the same way as the PKCS#11 PAL. */
+    platform_fs_lock();
+
+    if( f_open( &xFile, ggcacheFILE_NAME, ucMode ) == FR_OK )
+    {
+        if( ( f_write( &xFile, pxHeader, sizeof( GGCacheHeader_t ), &uxWritten ) == FR_OK ) &&
+            ( uxWritten == sizeof( GGCacheHeader_t ) ) )
+        {
+            xStatus = pdPASS;
+        }
+
+        if( ( xStatus == pdPASS ) && ( pcCertificate != NULL ) )
+        {
+            if( ( f_write( &xFile, pcCertificate, pxHeader->ulCertificateSize, &uxWritten ) != FR_OK ) ||
+                ( uxWritten != pxHeader->ulCertificateSize ) )
+            {
+                xStatus = pdFAIL;
+            }
+        }
+
+        ( void ) f_close( &xFile );
+    }
+
+    platform_fs_unlock();
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGGCacheLoad( char * pcBuffer,
+                         uint32_t ulBufferSize,
+                         GGD_HostAddressData_t * pxHostAddressData,
+                         BaseType_t * pxIsStale )
+{
+    static FIL xFile;
+    GGCacheHeader_t xHeader;
+    uint8_t ucHash[ ggcacheHASH_SIZE ];
+    UINT uxRead = 0;
+    uint32_t ulHostAddressSize = 0;
+    BaseType_t xStatus = pdFAIL;
+
+    configASSERT( pcBuffer != NULL );
+    configASSERT( pxHostAddressData != NULL );
+    configASSERT( pxIsStale != NULL );
+
+    platform_fs_lock();
+
+    if( f_open( &xFile, ggcacheFILE_NAME, FA_READ ) == FR_OK )
+    {
+        if( ( f_read( &xFile, &xHeader, sizeof( xHeader ), &uxRead ) == FR_OK ) &&
+            ( uxRead == sizeof( xHeader ) ) &&
+            ( xHeader.ulMagic == ggcacheMAGIC ) )
+        {
+            xHeader.cHostAddress[ ggdconfigHOST_ADDRESS_MAX_LENGTH ] = '\0';
+            ulHostAddressSize = ( uint32_t ) strlen( xHeader.cHostAddress ) + 1UL;
+
+            /* The certificate and the host address must both fit. */
+            if( ( xHeader.ulCertificateSize > 0UL ) &&
+                ( xHeader.ulCertificateSize <= ulBufferSize ) &&
+                ( ( ulBufferSize - xHeader.ulCertificateSize ) >= ulHostAddressSize ) )
+            {
+                if( ( f_read( &xFile, pcBuffer, xHeader.ulCertificateSize, &uxRead ) == FR_OK ) &&
+                    ( uxRead == xHeader.ulCertificateSize ) )
+                {
+                    xStatus = pdPASS;
+                }
+            }
+        }
+
+        ( void ) f_close( &xFile );
+    }
+
+    platform_fs_unlock();
+
+    if( xStatus == pdPASS )
+    {
+        ( void ) mbedtls_sha256_ret( ( const unsigned char * ) pcBuffer,
+                                     ( size_t ) xHeader.ulCertificateSize,
+                                     ucHash,
+                                     0 );
+
+        if( memcmp( ucHash, xHeader.ucCertificateHash, sizeof( ucHash ) ) != 0 )
+        {
+            configPRINTF( ( "GG cache: certificate does not match its hash, ignored\r\n" ) );
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        memcpy( &pcBuffer[ xHeader.ulCertificateSize ], xHeader.cHostAddress, ulHostAddressSize );
+
+        pxHostAddressData->pcHostAddress = &pcBuffer[ xHeader.ulCertificateSize ];
+        pxHostAddressData->pcCertificate = pcBuffer;
+        pxHostAddressData->ulCertificateSize = xHeader.ulCertificateSize;
+        pxHostAddressData->usPort = xHeader.usPort;
+
+        if( xHeader.usUseCount < UINT16_MAX )
+        {
+            xHeader.usUseCount++;
+        }
+
+        *pxIsStale = ( xHeader.usUseCount > ( uint16_t ) uzedggCACHE_MAX_USES ) ? pdTRUE : pdFALSE;
+
+        /* Count this use, a failure only delays staleness. */
+        ( void ) prvWriteHeader( &xHeader, NULL );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGGCacheStore( const GGD_HostAddressData_t * pxHostAddressData )
+{
+    GGCacheHeader_t xHeader;
+    BaseType_t xStatus = pdFAIL;
+
+    configASSERT( pxHostAddressData != NULL );
+
+    if( ( pxHostAddressData->pcCertificate != NULL ) &&
+        ( pxHostAddressData->ulCertificateSize > 0UL ) &&
+        ( strlen( pxHostAddressData->pcHostAddress ) <= ( size_t ) ggdconfigHOST_ADDRESS_MAX_LENGTH ) )
+    {
+        memset( &xHeader, 0, sizeof( xHeader ) );
+        xHeader.ulMagic = ggcacheMAGIC;
+        xHeader.usPort = pxHostAddressData->usPort;
+        xHeader.usUseCount = 0;
+        xHeader.ulCertificateSize = pxHostAddressData->ulCertificateSize;
+        strcpy( xHeader.cHostAddress, pxHostAddressData->pcHostAddress );
+
+        ( void ) mbedtls_sha256_ret( ( const unsigned char * ) pxHostAddressData->pcCertificate,
+                                     ( size_t ) pxHostAddressData->ulCertificateSize,
+                                     xHeader.ucCertificateHash,
+                                     0 );
+
+        xStatus = prvWriteHeader( &xHeader, pxHostAddressData->pcCertificate );
+    }
+
+    if( xStatus != pdPASS )
+    {
+        configPRINTF( ( "GG cache: could not save the core\r\n" ) );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+void vGGCacheInvalidate( void )
+{
+    platform_fs_lock();
+    ( void ) f_unlink( ggcacheFILE_NAME );
+    platform_fs_unlock();
+}
@@ -0,0 +1,85 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file uzed_gg_cache.h
+ * @brief Last good Greengrass core, kept on the SD card.
+ */
+
+#ifndef _UZED_GG_CACHE_H_
+#define _UZED_GG_CACHE_H_
+
+#include "FreeRTOS.h"
+#include "aws_greengrass_discovery.h"
+
+/**
+ * @brief Number of times the cached core is used before it is considered
+ * stale and discovery is run again in the background.
+ *
+ * The board has no real time clock, so the age of the cache is counted in
+ * uses rather than in time.
+ */
+#ifndef uzedggCACHE_MAX_USES
+    #define uzedggCACHE_MAX_USES    ( 16 )
+#endif
+
+/**
+ * @brief Load the last good Greengrass core.
+ *
+ * The certificate is copied at the beginning of pcBuffer, followed by the
+ * host address, and checked against the SHA-256 hash stored with it.
+ * Each successful load counts as one use of the cache.
+ *
+ * @param[in] pcBuffer              Buffer receiving certificate and host address.
+ * @param[in] ulBufferSize          Size of pcBuffer.
+ * @param[out] pxHostAddressData    Core address, port and certificate.
+ * @param[out] pxIsStale            pdTRUE when the cache was used more than
+ *                                  uzedggCACHE_MAX_USES times.
+ *
+ * @return pdPASS if a valid entry was loaded, pdFAIL otherwise.
+ */
+BaseType_t xGGCacheLoad( char * pcBuffer,
+                         uint32_t ulBufferSize,
+                         GGD_HostAddressData_t * pxHostAddressData,
+                         BaseType_t * pxIsStale );
+
+/**
+ * @brief Save a Greengrass core that was successfully connected to.
+ *
+ * The use count of the cache is reset.
+ *
+ * @param[in] pxHostAddressData     Core address, port and certificate.
+ *
+ * @return pdPASS if the entry was written, pdFAIL otherwise.
+ */
+BaseType_t xGGCacheStore( const GGD_HostAddressData_t * pxHostAddressData );
+
+/**
+ * @brief Drop the cached core, for instance after it refused the connection.
+ */
+void vGGCacheInvalidate( void );
+
+#endif /* _UZED_GG_CACHE_H_ */
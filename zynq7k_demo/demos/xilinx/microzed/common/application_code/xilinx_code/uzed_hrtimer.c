@@ -0,0 +1,145 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_hrtimer.c
+ * @brief High resolution timers on the Cortex-A9 global timer comparator.
+ *
+ * The comparator only raises its event when the counter reaches the
+ * comparator value, so aws_hrtimer.c checks the counter after every write
+ * and dispatches expiries that were already due itself.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Xilinx includes. */
+#include "xparameters.h"
+#include "xscugic.h"
+#include "xil_io.h"
+#include "xtime_l.h"
+
+/* High resolution timer includes. */
+#include "aws_hrtimer.h"
+
+#include "uzed_hrtimer.h"
+
+#define hrtimerINTC_BASE_ADDR           XPAR_SCUGIC_CPU_BASEADDR
+#define hrtimerINTC_DIST_BASE_ADDR      XPAR_SCUGIC_DIST_BASEADDR
+
+/* Global timer registers, see the Cortex-A9 MPCore TRM. The counter and the
+ * control register's enable bit are shared, the rest is banked per core. */
+#define hrtimerGT_CONTROL               ( GLOBAL_TMR_BASEADDR + 0x08UL )
+#define hrtimerGT_STATUS                ( GLOBAL_TMR_BASEADDR + 0x0CUL )
+#define hrtimerGT_COMPARE_LOWER         ( GLOBAL_TMR_BASEADDR + 0x10UL )
+#define hrtimerGT_COMPARE_UPPER         ( GLOBAL_TMR_BASEADDR + 0x14UL )
+
+#define hrtimerGT_CONTROL_COMP_ENABLE   ( 1UL << 1 )
+#define hrtimerGT_CONTROL_IRQ_ENABLE    ( 1UL << 2 )
+#define hrtimerGT_CONTROL_AUTO_INC      ( 1UL << 3 )
+#define hrtimerGT_STATUS_EVENT          ( 1UL << 0 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Comparator interrupt handler.
+ */
+static void prvCompareHandler( void * pvContext );
+
+/*-----------------------------------------------------------*/
+
+uint64_t ullUZedHrTimerGetTime( void )
+{
+    XTime xTime;
+
+    XTime_GetTime( &xTime );
+
+    return ( uint64_t ) xTime;
+}
+
+/*-----------------------------------------------------------*/
+
+void vUZedHrTimerSetCompare( uint64_t ullCompare )
+{
+    uint32_t ulControl = Xil_In32( hrtimerGT_CONTROL ) & ~hrtimerGT_CONTROL_AUTO_INC;
+
+    /* The comparator must be disabled while its two halves are written, or
+     * it could match the half-written value. */
+    Xil_Out32( hrtimerGT_CONTROL, ulControl & ~( hrtimerGT_CONTROL_COMP_ENABLE | hrtimerGT_CONTROL_IRQ_ENABLE ) );
+    Xil_Out32( hrtimerGT_COMPARE_LOWER, ( uint32_t ) ullCompare );
+    Xil_Out32( hrtimerGT_COMPARE_UPPER, ( uint32_t ) ( ullCompare >> 32 ) );
+    Xil_Out32( hrtimerGT_STATUS, hrtimerGT_STATUS_EVENT );
+    Xil_Out32( hrtimerGT_CONTROL, ulControl | hrtimerGT_CONTROL_COMP_ENABLE | hrtimerGT_CONTROL_IRQ_ENABLE );
+}
+
+/*-----------------------------------------------------------*/
+
+void vUZedHrTimerDisableCompare( void )
+{
+    uint32_t ulControl = Xil_In32( hrtimerGT_CONTROL );
+
+    Xil_Out32( hrtimerGT_CONTROL, ulControl & ~( hrtimerGT_CONTROL_COMP_ENABLE | hrtimerGT_CONTROL_IRQ_ENABLE ) );
+    Xil_Out32( hrtimerGT_STATUS, hrtimerGT_STATUS_EVENT );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCompareHandler( void * pvContext )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ( void ) pvContext;
+
+    Xil_Out32( hrtimerGT_STATUS, hrtimerGT_STATUS_EVENT );
+    HRTIMER_CompareFromISR( &xHigherPriorityTaskWoken );
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xUZedHrTimerInit( void )
+{
+    const uint8_t ucRisingEdge = 3;
+    BaseType_t xStatus = HRTIMER_Init();
+
+    if( xStatus == pdPASS )
+    {
+        /* The highest priority allowed to use the FreeRTOS API, so that the
+         * expiries are not delayed by the tick or the network interrupts. */
+        XScuGic_RegisterHandler( hrtimerINTC_BASE_ADDR,
+                                 XPS_GLOBAL_TMR_INT_ID,
+                                 ( Xil_InterruptHandler ) prvCompareHandler,
+                                 NULL );
+        XScuGic_SetPriTrigTypeByDistAddr( hrtimerINTC_DIST_BASE_ADDR,
+                                          XPS_GLOBAL_TMR_INT_ID,
+                                          configMAX_API_CALL_INTERRUPT_PRIORITY << portPRIORITY_SHIFT,
+                                          ucRisingEdge );
+        XScuGic_EnableIntr( hrtimerINTC_DIST_BASE_ADDR, XPS_GLOBAL_TMR_INT_ID );
+    }
+
+    return xStatus;
+}
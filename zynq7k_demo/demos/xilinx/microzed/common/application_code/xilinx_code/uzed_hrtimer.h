@@ -0,0 +1,70 @@
+/*
+ * Amazon FreeRTOS MQTT UZed Demo V1.0
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file uzed_hrtimer.h
+ * @brief High resolution timers on the Cortex-A9 global timer comparator.
+ *
+ * The private timer of each core generates the FreeRTOS tick, so the high
+ * resolution timers use the comparator of the global timer. The counter is
+ * shared by the two cores and is the time base of hr_gettime.c and of the
+ * trace timestamps; the comparator, its control bits and its interrupt (PPI
+ * 27) are banked, so each core of an AMP build has its own.
+ */
+
+#ifndef _UZED_HRTIMER_H_
+#define _UZED_HRTIMER_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Current value of the global timer counter.
+ */
+uint64_t ullUZedHrTimerGetTime( void );
+
+/**
+ * @brief Interrupt when the global timer counter reaches ullCompare.
+ */
+void vUZedHrTimerSetCompare( uint64_t ullCompare );
+
+/**
+ * @brief Stop the comparator interrupt.
+ */
+void vUZedHrTimerDisableCompare( void );
+
+/**
+ * @brief Install the comparator interrupt handler and start the high
+ * resolution timer task.
+ *
+ * Called from a task, after the scheduler has initialized the interrupt
+ * controller.
+ *
+ * @return pdPASS if the timer task was created, pdFAIL otherwise.
+ */
+BaseType_t xUZedHrTimerInit( void );
+
+#endif /* _UZED_HRTIMER_H_ */
@@ -92,6 +92,7 @@
 
 /* MQTT includes. */
 #include "aws_mqtt_agent.h"
+#include "aws_telemetry.h"
 
 /* Credentials includes. */
 #include "aws_clientcredential.h"
@@ -112,13 +113,16 @@
 #include "aws_ggd_config.h"
 #include "aws_ggd_config_defaults.h"
 #include "aws_greengrass_discovery.h"
+#include "uzed_gg_cache.h"
 #endif
 
 /*-----------------------------------------------------------*/
 // System parameters for the MicroZed IOT kit
 
 #if UZED_USE_GG
-#define GG_DISCOVERY_FILE_SIZE    4096
+/* Holds the group CA certificate and the core address only, the discovery
+ * document is parsed as it is received. */
+#define GG_DISCOVERY_FILE_SIZE    2048
 #endif
 
 /**
@@ -362,6 +366,47 @@ static void prvPublishSensors(System* pSystem);
  */
 static void prvCreateClientAndConnectToBroker( System* pSystem );
 
+/**
+ * @brief Connects the MQTT client, already created.
+ *
+ * @param[in] pSystem				System handle
+ * @param[in] pxConnectParameters	MQTT connection parameters
+ *
+ * @return pdPASS if connected
+ */
+static BaseType_t prvConnectClient( System* pSystem, const MQTTAgentConnectParams_t* pxConnectParameters );
+
+#if UZED_USE_GG
+/**
+ * @brief Connects the MQTT client to a Greengrass core.
+ *
+ * The core cached on the SD card is tried first. Discovery through the cloud
+ * only runs in the foreground when there is no usable cache or the cached
+ * core does not answer, and in the background when the cache is stale.
+ *
+ * @param[in] pSystem	System handle
+ *
+ * @return pdPASS if connected
+ */
+static BaseType_t prvConnectToGreengrassCore( System* pSystem );
+
+/**
+ * @brief Connects the MQTT client to the core in pSystem->xHostAddressData.
+ *
+ * @param[in] pSystem	System handle
+ *
+ * @return pdPASS if connected
+ */
+static BaseType_t prvConnectToGreengrassHost( System* pSystem );
+
+/**
+ * @brief Runs discovery once and saves the result in the core cache.
+ *
+ * @param[in] pvParameters	Unused
+ */
+static void prvGGCacheRefreshTask( void * pvParameters );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -685,41 +730,124 @@ static void prvPublishSensors(System* pSystem)
 
 /*--------------------------------------------------------------------------------*/
 
-static void prvCreateClientAndConnectToBroker( System* pSystem )
+static BaseType_t prvConnectClient( System* pSystem, const MQTTAgentConnectParams_t* pxConnectParameters )
+{
+    configPRINTF( ( "INFO: %s: Attempting to connect to '%s'\r\n",
+    		UZED_USE_GG? "GreenGrass":"MQTT",
+    		pxConnectParameters->pcURL ) );
+
+    return ( eMQTTAgentSuccess == MQTT_AGENT_Connect(
+            pSystem->xMQTTHandle,
+            pxConnectParameters,
+            democonfigMQTT_UZED_TLS_NEGOTIATION_TIMEOUT
+            ) ) ? pdPASS : pdFAIL;
+}
+
+#if UZED_USE_GG
+static BaseType_t prvConnectToGreengrassHost( System* pSystem )
 {
     MQTTAgentConnectParams_t xConnectParameters;
+
+    xConnectParameters.pcURL = pSystem->xHostAddressData.pcHostAddress;
+    xConnectParameters.xFlags = mqttagentREQUIRE_TLS | mqttagentURL_IS_IP_ADDRESS;
+    xConnectParameters.xURLIsIPAddress = pdTRUE; /* Deprecated. */
+    xConnectParameters.usPort = pSystem->xHostAddressData.usPort;
+    xConnectParameters.pucClientId = (const uint8_t*)clientcredentialIOT_THING_NAME;
+    xConnectParameters.usClientIdLength = (uint16_t)strlen(clientcredentialIOT_THING_NAME);
+    xConnectParameters.xSecuredConnection = pdTRUE; /* Deprecated. */
+    xConnectParameters.pvUserData = NULL;
+    xConnectParameters.pxCallback = NULL;
+    xConnectParameters.pcCertificate = pSystem->xHostAddressData.pcCertificate;
+    xConnectParameters.ulCertificateSize = pSystem->xHostAddressData.ulCertificateSize;
+
+    return prvConnectClient(pSystem, &xConnectParameters);
+}
+
+static BaseType_t prvConnectToGreengrassCore( System* pSystem )
+{
     BaseType_t xStatus;
+    BaseType_t xCacheIsStale = pdFALSE;
+
+    memset( &pSystem->xHostAddressData, 0, sizeof( GGD_HostAddressData_t ) );
+    xStatus = xGGCacheLoad(pSystem->pcJSONFile,GG_DISCOVERY_FILE_SIZE,&pSystem->xHostAddressData,&xCacheIsStale);
+
+    if(pdPASS == xStatus) {
+        configPRINTF( ("Using cached GGC %s\r\n", pSystem->xHostAddressData.pcHostAddress ) );
+        xStatus = prvConnectToGreengrassHost(pSystem);
+
+        if(pdPASS != xStatus) {
+            configPRINTF( ("Cached GGC did not answer, running discovery\r\n" ) );
+            vGGCacheInvalidate();
+        } else if(pdTRUE == xCacheIsStale) {
+            /* Already connected, so refresh the cache without holding up the sensors. */
+            ( void ) xTaskCreate( prvGGCacheRefreshTask,
+                                  "GGRefresh",
+                                  democonfigGG_CACHE_REFRESH_TASK_STACK_SIZE,
+                                  NULL,
+                                  democonfigGG_CACHE_REFRESH_TASK_PRIORITY,
+                                  NULL );
+        }
+    }
 
-    configPRINTF( ( "Broker ID: '%s'\r\n", clientcredentialMQTT_BROKER_ENDPOINT ) );
-    /* The MQTT client object must be created before it can be used.  The
-     * maximum number of MQTT client objects that can exist simultaneously
-     * is set by mqttconfigMAX_BROKERS. */
-    if( eMQTTAgentSuccess == MQTT_AGENT_Create( &pSystem->xMQTTHandle ) ) {
-#if UZED_USE_GG
+    if(pdPASS != xStatus) {
         configPRINTF( ( "Attempting automated selection of Greengrass device\r\n" ) );
         memset( &pSystem->xHostAddressData, 0, sizeof( GGD_HostAddressData_t ) );
         xStatus = GGD_GetGGCIPandCertificate(pSystem->pcJSONFile,GG_DISCOVERY_FILE_SIZE,&pSystem->xHostAddressData);
 
         if(pdPASS == xStatus) {
             configPRINTF( ("Success: GGC is %s\r\n", pSystem->xHostAddressData.pcHostAddress ) );
-        	xConnectParameters.pcURL = pSystem->xHostAddressData.pcHostAddress;
-            xConnectParameters.xFlags = mqttagentREQUIRE_TLS | mqttagentURL_IS_IP_ADDRESS;
-            xConnectParameters.xURLIsIPAddress = pdTRUE; /* Deprecated. */
-            xConnectParameters.usPort = clientcredentialMQTT_BROKER_PORT;
-            xConnectParameters.pucClientId = (const uint8_t*)clientcredentialIOT_THING_NAME;
-            xConnectParameters.usClientIdLength = (uint16_t)strlen(clientcredentialIOT_THING_NAME);
-            xConnectParameters.xSecuredConnection = pdTRUE; /* Deprecated. */
-            xConnectParameters.pvUserData = NULL;
-            xConnectParameters.pxCallback = NULL;
-            xConnectParameters.pcCertificate = pSystem->xHostAddressData.pcCertificate;
-            xConnectParameters.ulCertificateSize = pSystem->xHostAddressData.ulCertificateSize;
+            xStatus = prvConnectToGreengrassHost(pSystem);
+
+            if(pdPASS == xStatus) {
+                ( void ) xGGCacheStore(&pSystem->xHostAddressData);
+            }
         } else {
             configPRINTF( ("Failed: GGD_GetGGCIPandCertificate()\n" ) );
-            xConnectParameters.pcURL = 0;
-            pSystem->rc = XST_FAILURE;
-            pSystem->pcErr = "Auto-connect: Failed to retrieve Greengrass address and certificate\r\n";
-            pSystem->xMQTTHandle = NULL;
         }
+    }
+
+    return xStatus;
+}
+
+static void prvGGCacheRefreshTask( void * pvParameters )
+{
+    GGD_HostAddressData_t xHostAddressData;
+    char* pcBuffer;
+
+    ( void ) pvParameters;
+
+    /* pSystem->pcJSONFile still holds the certificate of the live connection. */
+    pcBuffer = pvPortMalloc(GG_DISCOVERY_FILE_SIZE);
+
+    if(NULL != pcBuffer) {
+        memset( &xHostAddressData, 0, sizeof( GGD_HostAddressData_t ) );
+
+        if(pdPASS == GGD_GetGGCIPandCertificate(pcBuffer,GG_DISCOVERY_FILE_SIZE,&xHostAddressData)) {
+            configPRINTF( ("GG cache refreshed: GGC is %s\r\n", xHostAddressData.pcHostAddress ) );
+            ( void ) xGGCacheStore(&xHostAddressData);
+        }
+
+        vPortFree(pcBuffer);
+    }
+
+    vTaskDelete( NULL );
+}
+#endif
+
+static void prvCreateClientAndConnectToBroker( System* pSystem )
+{
+    BaseType_t xStatus;
+#if !UZED_USE_GG
+    MQTTAgentConnectParams_t xConnectParameters;
+#endif
+
+    configPRINTF( ( "Broker ID: '%s'\r\n", clientcredentialMQTT_BROKER_ENDPOINT ) );
+    /* The MQTT client object must be created before it can be used.  The
+     * maximum number of MQTT client objects that can exist simultaneously
+     * is set by mqttconfigMAX_BROKERS. */
+    if( eMQTTAgentSuccess == MQTT_AGENT_Create( &pSystem->xMQTTHandle ) ) {
+#if UZED_USE_GG
+        xStatus = prvConnectToGreengrassCore(pSystem);
 #else
         /* Connect directly to the broker. */
         xConnectParameters.pcURL = clientcredentialMQTT_BROKER_ENDPOINT; /* The URL of the MQTT broker to connect to. */
@@ -733,28 +861,22 @@ static void prvCreateClientAndConnectToBroker( System* pSystem )
         xConnectParameters.pxCallback = NULL;                                 /* Callback used to report various events. Can be NULL. */
         xConnectParameters.pcCertificate = NULL;                                 /* Certificate used for secure connection. Can be NULL. */
         xConnectParameters.ulCertificateSize = 0;                                     /* Size of certificate used for secure connection. */
+
+        xStatus = prvConnectClient(pSystem, &xConnectParameters);
 #endif
 
-        if(xConnectParameters.pcURL) {
-            configPRINTF( ( "INFO: %s: Attempting to connect to '%s'\r\n",
-            		UZED_USE_GG? "GreenGrass":"MQTT",
-            		xConnectParameters.pcURL ) );
-            if(eMQTTAgentSuccess == MQTT_AGENT_Connect(
-                    pSystem->xMQTTHandle,
-                    &xConnectParameters,
-                    democonfigMQTT_UZED_TLS_NEGOTIATION_TIMEOUT
-                    )
-                ) {
-                configPRINTF( ( "SUCCESS: connected\r\n" ) );
-                pSystem->rc = XST_SUCCESS;
-            } else {
-                /* Could not connect, so delete the MQTT client. */
-                ( void ) MQTT_AGENT_Delete( pSystem->xMQTTHandle );
-                pSystem->rc = XST_FAILURE;
-                pSystem->pcErr = "ERROR: Could not connect\r\n";
-                pSystem->xMQTTHandle = NULL;
-                configPRINTF( ( "%s\r\n", pSystem->pcErr ) );
-            }
+        if(pdPASS == xStatus) {
+            configPRINTF( ( "SUCCESS: connected\r\n" ) );
+            pSystem->rc = XST_SUCCESS;
+            /* Publish the run time statistics over the same connection. */
+            TELEMETRY_MqttAgentSet( pSystem->xMQTTHandle );
+        } else {
+            /* Could not connect, so delete the MQTT client. */
+            ( void ) MQTT_AGENT_Delete( pSystem->xMQTTHandle );
+            pSystem->rc = XST_FAILURE;
+            pSystem->pcErr = "ERROR: Could not connect\r\n";
+            pSystem->xMQTTHandle = NULL;
+            configPRINTF( ( "%s\r\n", pSystem->pcErr ) );
         }
     } else {
         pSystem->rc = XST_FAILURE;
@@ -1680,6 +1802,7 @@ L_DIE:
 static void StopSystem(System* pSystem)
 {
 	if(NULL != pSystem->xMQTTHandle) {
+        TELEMETRY_MqttAgentSet( NULL );
         prvPublishShadow(pSystem);
 		/* Disconnect the client. */
 		( void ) MQTT_AGENT_Disconnect( pSystem->xMQTTHandle, democonfigMQTT_TIMEOUT );
@@ -32,6 +32,10 @@
 #define democonfigMQTT_UZED_IOT_TASK_STACK_SIZE                ( configMINIMAL_STACK_SIZE * 16 )
 #define democonfigMQTT_UZED_IOT_TASK_PRIORITY                  ( tskIDLE_PRIORITY )
 
+/* Greengrass core cache refresh task parameters, the task runs discovery. */
+#define democonfigGG_CACHE_REFRESH_TASK_STACK_SIZE             ( configMINIMAL_STACK_SIZE * 16 )
+#define democonfigGG_CACHE_REFRESH_TASK_PRIORITY               ( tskIDLE_PRIORITY )
+
 demoDECLARE_DEMO( vStartMQTTUZedIotDemo );
 
 #endif
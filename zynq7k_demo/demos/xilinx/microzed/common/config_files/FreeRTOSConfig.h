@@ -59,6 +59,8 @@
 //#define configPERIPHERAL_CLOCK_HZ  				( 33333000UL )
 #define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 200 )
 #define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 4 * 1024 * 1024 ) )
+#define configHEAP_SMALL_OBJECT_SLABS              1 /* heap_tlsf.c only. */
+#define configHEAP_TRACK_CALL_SITES                0 /* heap_tlsf.c only. */
 #define configMAX_TASK_NAME_LEN                    ( 15 )
 #define configUSE_TRACE_FACILITY                   1
 #define configUSE_16_BIT_TICKS                     0
@@ -89,15 +91,13 @@
 /* Event group related definitions. */
 #define configUSE_EVENT_GROUPS                     1
 
-/* Run time stats gathering definitions. */
-/* FIX ME: Uncomment if you plan to use Tracealyzer.
-*/
+/* Run time stats gathering definitions.  The counter is derived from the
+Cortex-A9 global timer, which is already running, so it needs no setup. */
 #define configUSE_STATS_FORMATTING_FUNCTIONS	1
-/*
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS			1
+extern uint32_t ulGetRunTimeCounterValue( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
-#define portGET_RUN_TIME_COUNTER_VALUE()
-*/
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulGetRunTimeCounterValue()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -174,6 +174,16 @@ extern void vLoggingPrint( const char * pcMessage );
  * and a time stamp. */
 #define configLOGGING_INCLUDE_TIME_AND_TASK_NAME    1
 
+/* Log messages are recorded unformatted into a ring per task, so logging does
+ * not block or allocate.  Messages are dropped and counted when a ring is full. */
+#define configLOGGING_RING_COUNT                    8
+#define configLOGGING_RING_SIZE_WORDS               256
+
+/* Return the log ring of a deleted task so short lived tasks do not use up the
+ * rings. */
+extern void vLoggingTaskDeleted( void * pvTask );
+#define traceTASK_DELETE( pxTCB )    vLoggingTaskDeleted( ( void * ) ( pxTCB ) )
+
 /* The priority at which the tick interrupt runs.  This should probably be kept at 1. */
 #define configKERNEL_INTERRUPT_PRIORITY             1
 
@@ -285,4 +295,22 @@ extern uint32_t uxRand();
 /* The platform FreeRTOS is running on. */
 #define configPLATFORM_NAME    "XilinxZynq7000"
 
+/* Set to 1 to record task switches and queue, semaphore and mutex operations
+ * with the event tracer of aws_trace.h.  The collector the ring is streamed to
+ * must then be set in aws_trace_config.h. */
+#define configUSE_AWS_TRACE    0
+
+#if ( configUSE_AWS_TRACE == 1 )
+    #include "aws_trace.h"
+
+    #define traceTASK_CREATE( pxNewTCB )                   TRACE_RecordTaskName( ( uint16_t ) ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+    #define traceTASK_SWITCHED_IN()                        TRACE_RecordTask( eTraceTaskSwitchedIn, ( uint16_t ) pxCurrentTCB->uxTCBNumber, 0 )
+    #define traceQUEUE_SEND( pxQueue )                     TRACE_EVENT( eTraceQueueSend, ( uintptr_t ) ( pxQueue ) )
+    #define traceQUEUE_SEND_FROM_ISR( pxQueue )            TRACE_EVENT( eTraceQueueSendFromISR, ( uintptr_t ) ( pxQueue ) )
+    #define traceQUEUE_RECEIVE( pxQueue )                  TRACE_EVENT( eTraceQueueReceive, ( uintptr_t ) ( pxQueue ) )
+    #define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )         TRACE_EVENT( eTraceQueueReceiveFromISR, ( uintptr_t ) ( pxQueue ) )
+    #define traceBLOCKING_ON_QUEUE_SEND( pxQueue )         TRACE_EVENT( eTraceQueueBlockOnSend, ( uintptr_t ) ( pxQueue ) )
+    #define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )      TRACE_EVENT( eTraceQueueBlockOnReceive, ( uintptr_t ) ( pxQueue ) )
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
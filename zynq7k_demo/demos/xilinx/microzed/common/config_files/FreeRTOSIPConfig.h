@@ -339,6 +339,15 @@ extern uint32_t uxRand();
 
 #define portINLINE                               __inline
 
+/* Record frames and IP task events with the event tracer when it is enabled in
+ * FreeRTOSConfig.h. */
+#if ( configUSE_AWS_TRACE == 1 )
+    #include "aws_trace.h"
+    #define iptraceNETWORK_INTERFACE_TRANSMIT()        TRACE_EVENT( eTraceNetworkTransmit, 0 )
+    #define iptraceNETWORK_INTERFACE_RECEIVE()         TRACE_EVENT( eTraceNetworkReceive, 0 )
+    #define iptraceNETWORK_EVENT_RECEIVED( eEvent )    TRACE_EVENT( eTraceNetworkEvent, eEvent )
+#endif
+
 void vApplicationMQTTGetKeys( const char ** ppcRootCA,
                               const char ** ppcClientCert,
                               const char ** ppcClientPrivateKey );
@@ -0,0 +1,50 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_amp_config.h
+ * @brief AMP channel config options.
+ */
+
+#ifndef _AWS_AMP_CONFIG_H_
+#define _AWS_AMP_CONFIG_H_
+
+/**
+ * @brief Largest payload carried by a single channel message.
+ *
+ * Matches the TLS record size, so that one proxied SOCKETS_Recv() can return
+ * a whole decrypted record.
+ */
+#define ampconfigMAX_PAYLOAD               ( 2048 )
+
+/**
+ * @brief Number of network core tasks serving proxied socket calls.
+ *
+ * One per socket the application core keeps open is enough; blocking calls on
+ * one socket do not hold up the others.
+ */
+#define ampconfigSOCKETS_SERVER_WORKERS    ( 4 )
+
+#endif /* _AWS_AMP_CONFIG_H_ */
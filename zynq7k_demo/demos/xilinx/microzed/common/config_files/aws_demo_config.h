@@ -75,6 +75,10 @@ to perform a TLS negotiation. */
 #define democonfigTCP_ECHO_TASKS_SEPARATE_TASK_STACK_SIZE  ( configMINIMAL_STACK_SIZE * 4 )
 #define democonfigTCP_ECHO_TASKS_SEPARATE_TASK_PRIORITY    ( tskIDLE_PRIORITY )
 
+/* High resolution timer jitter demo task parameters. */
+#define democonfigHRTIMER_JITTER_DEMO_TASK_STACK_SIZE      ( configMINIMAL_STACK_SIZE * 2 )
+#define democonfigHRTIMER_JITTER_DEMO_TASK_PRIORITY        ( tskIDLE_PRIORITY + 1 )
+
 /* Send AWS IoT MQTT traffic encrypted to destination port 443. */
 #define democonfigMQTT_AGENT_CONNECT_FLAGS          	   ( mqttagentREQUIRE_TLS )
 
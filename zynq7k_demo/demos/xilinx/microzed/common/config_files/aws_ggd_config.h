@@ -43,4 +43,15 @@
  */
 #define ggdconfigJSON_MAX_TOKENS            ( 128 )
 
+/**
+ * @brief Probe the connectivity entries of the core concurrently.
+ */
+#define ggdconfigPARALLEL_PROBE             ( 1 )
+
+/**
+ * @brief No standby connection to the discovery endpoint. The demo runs
+ * discovery once, so a standby would never be used, only kept open.
+ */
+#define ggdconfigKEEP_STANDBY_CONNECTION    ( 0 )
+
 #endif /* _AWS_GGD_CONFIG_H_ */
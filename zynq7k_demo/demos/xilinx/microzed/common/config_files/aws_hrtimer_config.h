@@ -0,0 +1,57 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_hrtimer_config.h
+ * @brief High resolution timer config options.
+ */
+
+#ifndef _AWS_HRTIMER_CONFIG_H_
+#define _AWS_HRTIMER_CONFIG_H_
+
+#include "xtime_l.h"
+#include "uzed_hrtimer.h"
+
+/**
+ * @brief The Cortex-A9 global timer runs at half the CPU clock, 3 ns per
+ * count on the MicroZed.
+ */
+#define hrtimerconfigCOUNTS_PER_SECOND           ( COUNTS_PER_SECOND )
+#define hrtimerconfigGET_TIME()                  ullUZedHrTimerGetTime()
+#define hrtimerconfigSET_COMPARE( ullCompare )   vUZedHrTimerSetCompare( ullCompare )
+#define hrtimerconfigDISABLE_COMPARE()           vUZedHrTimerDisableCompare()
+
+/**
+ * @brief Expiries closer than 1 us are dispatched without taking the
+ * comparator interrupt.
+ */
+#define hrtimerconfigMIN_COMPARE_DELTA           ( COUNTS_PER_SECOND / 1000000UL )
+
+/**
+ * @brief Sensor sampling and GEM interrupt moderation, plus the POSIX timers.
+ */
+#define hrtimerconfigMAX_ACTIVE_TIMERS           ( 16 )
+
+#endif /* _AWS_HRTIMER_CONFIG_H_ */
@@ -92,4 +92,15 @@
  */
 #define mqttconfigMQTT_TASK_MAX_BLOCK_TICKS    ( ~( ( uint32_t ) 0 ) )
 
+/**
+ * @brief Coalesce the packets sent in one pass of the MQTT task into one TLS
+ * record, see tlsconfigCOALESCE_BUFFER_SIZE.
+ */
+#define mqttconfigCOALESCE_TLS_WRITES          ( 1 )
+
+/**
+ * @brief Keep a standby connection to the broker for reconnects.
+ */
+#define mqttconfigKEEP_STANDBY_CONNECTION      ( 1 )
+
 #endif /* _AWS_MQTT_AGENT_CONFIG_H_ */
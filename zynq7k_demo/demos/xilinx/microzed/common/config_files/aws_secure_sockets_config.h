@@ -48,4 +48,10 @@
  */
 #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 20000 )
 
+/**
+ * @brief Number of endpoints, the MQTT broker, for which a connected TLS
+ * socket is kept ready for the next SOCKETS_Connect().
+ */
+#define socketsconfigSTANDBY_MAX_ENDPOINTS   ( 1 )
+
 #endif /* _AWS_SECURE_SOCKETS_CONFIG_H_ */
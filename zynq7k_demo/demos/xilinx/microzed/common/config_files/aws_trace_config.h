@@ -0,0 +1,66 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace_config.h
+ * @brief Event tracing config options.
+ */
+
+#ifndef _AWS_TRACE_CONFIG_H_
+#define _AWS_TRACE_CONFIG_H_
+
+#include "xparameters.h"
+
+/**
+ * @brief 64 KB of events, a few seconds of a busy MQTT connection.
+ */
+#define traceconfigEVENT_COUNT          ( 4096 )
+
+/**
+ * @brief Each core of an AMP build traces into its own ring. The global timer
+ * is shared by both cores, so their timestamps can be compared.
+ */
+#define traceconfigCPU_ID               ( XPAR_CPU_ID )
+
+/**
+ * @brief Microseconds from the Cortex-A9 global timer.
+ */
+extern unsigned long long ullGetHighResolutionTime( void );
+#define traceconfigGET_TIMESTAMP()      ( ( uint32_t ) ullGetHighResolutionTime() )
+
+/**
+ * @brief Address of the host collecting the trace, for example
+ * "python aws_trace_to_chrome.py --listen 9010 -o trace.json".
+ *
+ * Required when configUSE_AWS_TRACE is 1, for example:
+ *
+ * #define traceconfigDRAIN_HOST_ADDR0     192
+ * #define traceconfigDRAIN_HOST_ADDR1     168
+ * #define traceconfigDRAIN_HOST_ADDR2     0
+ * #define traceconfigDRAIN_HOST_ADDR3     2
+ * #define traceconfigDRAIN_HOST_PORT      ( 9010 )
+ */
+
+#endif /* _AWS_TRACE_CONFIG_H_ */
@@ -45,6 +45,14 @@
     #define posixconfigTIMER_NAME    "timer"
 #endif
 
+/**
+ * @brief Run POSIX timers on the high resolution timers of aws_hrtimer.h
+ * rather than on FreeRTOS software timers, which expire on a tick.
+ */
+#ifndef posixconfigENABLE_HRTIMER
+    #define posixconfigENABLE_HRTIMER    0
+#endif
+
 /**
  * @defgroup Defaults for POSIX message queue implementation.
  */
@@ -56,6 +64,10 @@
 #ifndef posixconfigMQ_MAX_SIZE
     #define posixconfigMQ_MAX_SIZE    128 /**< Maximum size (in bytes) of each message. */
 #endif
+
+#ifndef posixconfigMQ_HASH_BUCKETS
+    #define posixconfigMQ_HASH_BUCKETS    16 /**< Number of hash buckets used to look up message queues by name and by descriptor. */
+#endif
 /**@} */
 
 /**
@@ -0,0 +1,306 @@
+/*
+ * Amazon FreeRTOS+POSIX V1.0.1
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file FreeRTOS_POSIX_hrtimer.c
+ * @brief Implementation of timer functions in time.h on high resolution timers
+ *
+ * Used in place of FreeRTOS_POSIX_timer.c when posixconfigENABLE_HRTIMER is 1.
+ * Timers expire with the resolution of the hardware comparator rather than on
+ * a tick, and notifications are started from the high resolution timer task.
+ */
+
+/* C standard library includes. */
+#include <limits.h>
+#include <stddef.h>
+
+/* FreeRTOS+POSIX includes. */
+#include "FreeRTOS_POSIX.h"
+#include "FreeRTOS_POSIX/errno.h"
+#include "FreeRTOS_POSIX/pthread.h"
+#include "FreeRTOS_POSIX/signal.h"
+#include "FreeRTOS_POSIX/time.h"
+#include "FreeRTOS_POSIX/utils.h"
+
+#if ( posixconfigENABLE_HRTIMER == 1 )
+
+/* High resolution timer include. */
+#include "aws_hrtimer.h"
+
+/**
+ * @defgroup Timespec zero check macros.
+ */
+/**@{ */
+#define TIMESPEC_IS_ZERO( xTimespec )        ( xTimespec.tv_sec == 0 && xTimespec.tv_nsec == 0 ) /**< Check for 0. */
+#define TIMESPEC_IS_NOT_ZERO( xTimespec )    ( !( TIMESPEC_IS_ZERO( xTimespec ) ) )              /**< Check for not 0. */
+/**@} */
+
+/**
+ * @brief Internal timer structure.
+ */
+typedef struct timer_internal
+{
+    HrTimer_t xTimer;            /**< The high resolution timer. */
+    struct sigevent xTimerEvent; /**< What to do when this timer expires. */
+} timer_internal_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Converts a valid timespec to counts of the high resolution timer.
+ */
+static uint64_t prvTimespecToCounts( const struct timespec * const pxTimespec )
+{
+    return ( ( uint64_t ) pxTimespec->tv_sec * ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND ) +
+           hrtimerNS_TO_COUNTS( pxTimespec->tv_nsec );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Converts counts of the high resolution timer to a timespec.
+ */
+static void prvCountsToTimespec( uint64_t ullCounts,
+                                 struct timespec * const pxTimespec )
+{
+    UTILS_NanosecondsToTimespec( ( int64_t ) hrtimerCOUNTS_TO_NS( ullCounts ), pxTimespec );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTimerCallback( HrTimer_t * pxHrTimer,
+                              void * pvContext )
+{
+    timer_internal_t * pxTimer = ( timer_internal_t * ) pvContext;
+    pthread_t xTimerNotificationThread;
+    pthread_attr_t xThreadAttributes;
+
+    ( void ) pxHrTimer;
+
+    /* A value of SIGEV_SIGNAL isn't supported and should not have been successfully
+     * set. */
+    configASSERT( pxTimer->xTimerEvent.sigev_notify != SIGEV_SIGNAL );
+
+    /* Create the timer notification thread if requested. */
+    if( pxTimer->xTimerEvent.sigev_notify == SIGEV_THREAD )
+    {
+        /* By default, create a detached thread. But if the user has provided
+         * thread attributes, use the provided attributes. */
+        if( pxTimer->xTimerEvent.sigev_notify_attributes == NULL )
+        {
+            if( pthread_attr_init( &xThreadAttributes ) == 0 )
+            {
+                if( pthread_attr_setdetachstate( &xThreadAttributes,
+                                                 PTHREAD_CREATE_DETACHED ) == 0 )
+                {
+                    ( void ) pthread_create( &xTimerNotificationThread,
+                                             &xThreadAttributes,
+                                             ( void * ( * )( void * ) )pxTimer->xTimerEvent.sigev_notify_function,
+                                             pxTimer->xTimerEvent.sigev_value.sival_ptr );
+                }
+
+                ( void ) pthread_attr_destroy( &xThreadAttributes );
+            }
+        }
+        else
+        {
+            ( void ) pthread_create( &xTimerNotificationThread,
+                                     pxTimer->xTimerEvent.sigev_notify_attributes,
+                                     ( void * ( * )( void * ) )pxTimer->xTimerEvent.sigev_notify_function,
+                                     pxTimer->xTimerEvent.sigev_value.sival_ptr );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int timer_create( clockid_t clockid,
+                  struct sigevent * evp,
+                  timer_t * timerid )
+{
+    int iStatus = 0;
+    timer_internal_t * pxTimer = NULL;
+
+    /* Silence warnings about unused parameters. */
+    ( void ) clockid;
+
+    /* POSIX specifies that when evp is NULL, the behavior shall be as is
+     * sigev_notify is SIGEV_SIGNAL. SIGEV_SIGNAL is currently not supported. */
+    if( ( evp == NULL ) || ( evp->sigev_notify == SIGEV_SIGNAL ) )
+    {
+        errno = ENOTSUP;
+        iStatus = -1;
+    }
+
+    /* Allocate memory for a new timer object. */
+    if( iStatus == 0 )
+    {
+        pxTimer = pvPortMalloc( sizeof( timer_internal_t ) );
+
+        if( pxTimer == NULL )
+        {
+            errno = EAGAIN;
+            iStatus = -1;
+        }
+    }
+
+    if( iStatus == 0 )
+    {
+        /* Copy the event notification structure. Timers are created disarmed. */
+        pxTimer->xTimerEvent = *evp;
+        HRTIMER_Create( &pxTimer->xTimer, prvTimerCallback, pxTimer );
+        *timerid = ( timer_t ) pxTimer;
+    }
+
+    return iStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+int timer_delete( timer_t timerid )
+{
+    timer_internal_t * pxTimer = ( timer_internal_t * ) timerid;
+
+    /* Waits for a notification the timer task has already started, which
+     * reads the timer. */
+    HRTIMER_Stop( &pxTimer->xTimer );
+
+    /* Free the memory in use by the timer. */
+    vPortFree( pxTimer );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+int timer_getoverrun( timer_t timerid )
+{
+    timer_internal_t * pxTimer = ( timer_internal_t * ) timerid;
+    uint32_t ulOverruns = HRTIMER_GetOverruns( &pxTimer->xTimer );
+
+    return ( ulOverruns > ( uint32_t ) INT_MAX ) ? INT_MAX : ( int ) ulOverruns;
+}
+
+/*-----------------------------------------------------------*/
+
+int timer_settime( timer_t timerid,
+                   int flags,
+                   const struct itimerspec * value,
+                   struct itimerspec * ovalue )
+{
+    int iStatus = 0;
+    timer_internal_t * pxTimer = ( timer_internal_t * ) timerid;
+    struct timespec xDelay = { 0 }, xNow = { 0 };
+    uint64_t ullPeriod = 0;
+
+    /* Validate the value argument, but only if the timer isn't being disarmed. */
+    if( TIMESPEC_IS_NOT_ZERO( value->it_value ) )
+    {
+        if( ( UTILS_ValidateTimespec( &value->it_interval ) == false ) ||
+            ( UTILS_ValidateTimespec( &value->it_value ) == false ) )
+        {
+            errno = EINVAL;
+            iStatus = -1;
+        }
+    }
+
+    /* Set ovalue, if given. */
+    if( ovalue != NULL )
+    {
+        ( void ) timer_gettime( timerid, ovalue );
+    }
+
+    if( iStatus == 0 )
+    {
+        if( TIMESPEC_IS_ZERO( value->it_value ) )
+        {
+            /* Disarm the timer. */
+            HRTIMER_Stop( &pxTimer->xTimer );
+        }
+        else
+        {
+            /* A timer with a zero it_interval is not periodic. */
+            if( TIMESPEC_IS_NOT_ZERO( value->it_interval ) )
+            {
+                ullPeriod = prvTimespecToCounts( &value->it_interval );
+            }
+
+            xDelay = value->it_value;
+
+            /* Absolute timeouts are relative to CLOCK_REALTIME. Per POSIX spec,
+             * an absolute timeout in the past triggers a notification
+             * immediately, which a zero delay does. */
+            if( ( flags & TIMER_ABSTIME ) == TIMER_ABSTIME )
+            {
+                ( void ) clock_gettime( CLOCK_REALTIME, &xNow );
+
+                if( UTILS_TimespecSubtract( &xDelay, &value->it_value, &xNow ) != 0 )
+                {
+                    xDelay.tv_sec = 0;
+                    xDelay.tv_nsec = 0;
+                }
+            }
+
+            /* Starting an armed timer rearms it. */
+            if( HRTIMER_Start( &pxTimer->xTimer, prvTimespecToCounts( &xDelay ), ullPeriod ) != pdPASS )
+            {
+                errno = EAGAIN;
+                iStatus = -1;
+            }
+        }
+    }
+
+    return iStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+int timer_gettime( timer_t timerid,
+                   struct itimerspec * value )
+{
+    timer_internal_t * pxTimer = ( timer_internal_t * ) timerid;
+    uint64_t ullNow = HRTIMER_GetTime();
+    uint64_t ullExpiry = HRTIMER_GetExpiry( &pxTimer->xTimer );
+
+    /* Set it_value only if the timer is armed. Otherwise, set it to 0. */
+    if( ( HRTIMER_IsActive( &pxTimer->xTimer ) != pdFALSE ) && ( ullExpiry > ullNow ) )
+    {
+        prvCountsToTimespec( ullExpiry - ullNow, &value->it_value );
+    }
+    else
+    {
+        value->it_value.tv_sec = 0;
+        value->it_value.tv_nsec = 0;
+    }
+
+    /* Set it_interval only if the timer is periodic. Otherwise, set it to 0. */
+    prvCountsToTimespec( pxTimer->xTimer.ullPeriod, &value->it_interval );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* posixconfigENABLE_HRTIMER == 1 */
@@ -29,6 +29,7 @@
  */
 
 /* C standard library includes. */
+#include <stdint.h>
 #include <string.h>
 
 /* FreeRTOS+POSIX includes. */
@@ -39,28 +40,48 @@
 #include "FreeRTOS_POSIX/utils.h"
 
 /**
- * @brief Element of the FreeRTOS queues that store mq data.
+ * @brief Round a message slot size up so that every slot header is aligned.
  */
-typedef struct QueueElement
+#define mqueueSLOT_ALIGN( xSize )    ( ( ( xSize ) + sizeof( size_t ) - 1 ) & ~( sizeof( size_t ) - 1 ) )
+
+/**
+ * @brief Header stored at the start of every message slot.
+ *
+ * The message bytes follow the header directly.
+ */
+typedef struct MessageSlot
 {
-    char * pcData;    /**< Data in queue. Type char* to match msg_ptr. */
-    size_t xDataSize; /**< Size of data pointed by pcData. */
-} QueueElement_t;
+    size_t xDataSize; /**< Number of valid bytes in the slot. */
+} MessageSlot_t;
 
 /**
  * @brief Data structure of an mq.
  *
  * FreeRTOS isn't guaranteed to have a file-like abstraction, so message
- * queues in this implementation are stored as a linked list (in RAM).
+ * queues in this implementation are stored in a hash table (in RAM).
+ *
+ * Each queue is a single heap block holding this structure, the storage of two
+ * statically allocated FreeRTOS queues, mq_maxmsg message slots of mq_msgsize
+ * bytes and the queue name. The FreeRTOS queues only carry slot indexes:
+ * xFreeSlots holds the slots available to senders and xFullSlots the slots
+ * waiting to be received, in send order. Sending and receiving therefore copy
+ * each message exactly once and never allocate.
  */
 typedef struct QueueListElement
 {
-    Link_t xLink;              /**< Pointer to the next element in the list. */
-    QueueHandle_t xQueue;      /**< FreeRTOS queue handle. */
-    size_t xOpenDescriptors;   /**< Number of threads that have opened this queue. */
-    char * pcName;             /**< Null-terminated queue name. */
-    struct mq_attr xAttr;      /**< Queue attibutes. */
-    BaseType_t xPendingUnlink; /**< If pdTRUE, this queue will be unlinked once all descriptors close. */
+    Link_t xNameLink;              /**< Link in the name hash bucket. */
+    Link_t xDescriptorLink;        /**< Link in the descriptor hash bucket. */
+    QueueHandle_t xFreeSlots;      /**< FreeRTOS queue of empty slot indexes. */
+    QueueHandle_t xFullSlots;      /**< FreeRTOS queue of slot indexes holding messages. */
+    StaticQueue_t xFreeSlotsQueue; /**< Storage for the xFreeSlots queue structure. */
+    StaticQueue_t xFullSlotsQueue; /**< Storage for the xFullSlots queue structure. */
+    uint8_t * pucSlots;            /**< First message slot. */
+    size_t xSlotStride;            /**< Distance in bytes between two message slots. */
+    size_t xOpenDescriptors;       /**< Number of threads that have opened this queue. */
+    uint32_t ulNameHash;           /**< Hash of pcName. */
+    char * pcName;                 /**< Null-terminated queue name. */
+    struct mq_attr xAttr;          /**< Queue attibutes. */
+    BaseType_t xPendingUnlink;     /**< If pdTRUE, this queue will be unlinked once all descriptors close. */
 } QueueListElement_t;
 
 /*-----------------------------------------------------------*/
@@ -118,10 +139,19 @@ static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListEl
                                       const char * const pcName,
                                       mqd_t xMessageQueueDescriptor );
 
+/**
+ * @brief Compute the FNV-1a hash of a queue name.
+ *
+ * @param[in] pcName Null-terminated queue name.
+ *
+ * @return 32-bit hash of pcName.
+ */
+static uint32_t prvHashQueueName( const char * const pcName );
+
 /**
  * @brief Initialize the queue list.
  *
- * Performs initialization of the queue list mutex and queue list head.
+ * Performs initialization of the queue list mutex and hash bucket heads.
  *
  * @return nothing
  */
@@ -145,9 +175,27 @@ static BaseType_t prvValidateQueueName( const char * const pcName,
 static StaticSemaphore_t xQueueListMutex = { { 0 }, .u = { 0 } };
 
 /**
- * @brief Head of the linked list of queues.
+ * @brief Hash buckets of queues, indexed by name hash.
  */
-static Link_t xQueueListHead = { 0 };
+static Link_t xQueueNameBuckets[ posixconfigMQ_HASH_BUCKETS ] = { { 0 } };
+
+/**
+ * @brief Hash buckets of queues, indexed by descriptor.
+ */
+static Link_t xQueueDescriptorBuckets[ posixconfigMQ_HASH_BUCKETS ] = { { 0 } };
+
+/**
+ * @brief Select the name bucket of a hash.
+ */
+#define mqueueNAME_BUCKET( ulHash ) \
+    ( &xQueueNameBuckets[ ( ulHash ) % posixconfigMQ_HASH_BUCKETS ] )
+
+/**
+ * @brief Select the descriptor bucket of a descriptor. The low bits of a heap
+ * address are always zero, so they are discarded first.
+ */
+#define mqueueDESCRIPTOR_BUCKET( xDescriptor ) \
+    ( &xQueueDescriptorBuckets[ ( ( ( size_t ) ( xDescriptor ) ) / portBYTE_ALIGNMENT ) % posixconfigMQ_HASH_BUCKETS ] )
 
 /*-----------------------------------------------------------*/
 
@@ -198,63 +246,84 @@ static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueu
                                             size_t xNameLength )
 {
     BaseType_t xStatus = pdTRUE;
-
-    /* Allocate space for a new queue element. */
-    *ppxMessageQueue = pvPortMalloc( sizeof( QueueListElement_t ) );
-
-    /* Check that memory allocation succeeded. */
-    if( *ppxMessageQueue == NULL )
+    QueueListElement_t * pxMessageQueue = NULL;
+    UBaseType_t uxMaxMessages = ( UBaseType_t ) pxAttr->mq_maxmsg;
+    UBaseType_t uxSlot = 0;
+    size_t xSlotStride = mqueueSLOT_ALIGN( sizeof( MessageSlot_t ) + ( size_t ) pxAttr->mq_msgsize );
+    size_t xIndexStorageSize = mqueueSLOT_ALIGN( ( size_t ) uxMaxMessages * sizeof( UBaseType_t ) );
+    size_t xAllocationSize = 0;
+    uint8_t * pucFreeSlotsStorage = NULL, * pucFullSlotsStorage = NULL;
+
+    /* A queue must be able to hold at least one message, and its storage must
+     * be addressable. */
+    if( ( uxMaxMessages == 0 ) ||
+        ( ( size_t ) pxAttr->mq_maxmsg > ( SIZE_MAX - sizeof( QueueListElement_t ) - xNameLength - 1 ) /
+          ( xSlotStride + 2 * sizeof( UBaseType_t ) + 2 ) ) )
     {
         xStatus = pdFALSE;
     }
 
-    /* Create the FreeRTOS queue. */
+    /* Allocate the queue element, both index queues, the message slots and the
+     * name as one block. */
     if( xStatus == pdTRUE )
     {
-        ( *ppxMessageQueue )->xQueue =
-            xQueueCreate( pxAttr->mq_maxmsg, sizeof( QueueElement_t ) );
+        xAllocationSize = sizeof( QueueListElement_t ) +
+                          2 * xIndexStorageSize +
+                          ( size_t ) uxMaxMessages * xSlotStride +
+                          xNameLength + 1;
+        pxMessageQueue = pvPortMalloc( xAllocationSize );
 
-        /* Check that queue creation succeeded. */
-        if( ( *ppxMessageQueue )->xQueue == NULL )
+        /* Check that memory allocation succeeded. */
+        if( pxMessageQueue == NULL )
         {
-            vPortFree( *ppxMessageQueue );
             xStatus = pdFALSE;
         }
     }
 
     if( xStatus == pdTRUE )
     {
-        /* Allocate space for the queue name plus null-terminator. */
-        ( *ppxMessageQueue )->pcName = pvPortMalloc( xNameLength + 1 );
-
-        /* Check that memory was successfully allocated for queue name. */
-        if( ( *ppxMessageQueue )->pcName == NULL )
-        {
-            vQueueDelete( ( *ppxMessageQueue )->xQueue );
-            vPortFree( *ppxMessageQueue );
-            xStatus = pdFALSE;
-        }
-        else
+        pucFreeSlotsStorage = ( uint8_t * ) ( pxMessageQueue + 1 );
+        pucFullSlotsStorage = pucFreeSlotsStorage + xIndexStorageSize;
+        pxMessageQueue->pucSlots = pucFullSlotsStorage + xIndexStorageSize;
+        pxMessageQueue->xSlotStride = xSlotStride;
+        pxMessageQueue->pcName = ( char * ) ( pxMessageQueue->pucSlots + ( size_t ) uxMaxMessages * xSlotStride );
+
+        /* Create the FreeRTOS queues. These cannot fail because their storage
+         * is provided. */
+        pxMessageQueue->xFreeSlots = xQueueCreateStatic( uxMaxMessages,
+                                                         sizeof( UBaseType_t ),
+                                                         pucFreeSlotsStorage,
+                                                         &pxMessageQueue->xFreeSlotsQueue );
+        pxMessageQueue->xFullSlots = xQueueCreateStatic( uxMaxMessages,
+                                                         sizeof( UBaseType_t ),
+                                                         pucFullSlotsStorage,
+                                                         &pxMessageQueue->xFullSlotsQueue );
+
+        /* Every slot starts out empty. */
+        for( uxSlot = 0; uxSlot < uxMaxMessages; uxSlot++ )
         {
-            /* Copy queue name. Copying xNameLength+1 will cause strncpy to add
-             * the null-terminator. */
-            ( void ) strncpy( ( *ppxMessageQueue )->pcName, pcName, xNameLength + 1 );
+            ( void ) xQueueSend( pxMessageQueue->xFreeSlots, &uxSlot, 0 );
         }
-    }
 
-    if( xStatus == pdTRUE )
-    {
+        /* Copy queue name and null-terminator. */
+        ( void ) memcpy( pxMessageQueue->pcName, pcName, xNameLength );
+        pxMessageQueue->pcName[ xNameLength ] = '\0';
+        pxMessageQueue->ulNameHash = prvHashQueueName( pcName );
+
         /* Copy attributes. */
-        ( *ppxMessageQueue )->xAttr = *pxAttr;
+        pxMessageQueue->xAttr = *pxAttr;
 
         /* A newly-created queue will have 1 open descriptor for it. */
-        ( *ppxMessageQueue )->xOpenDescriptors = 1;
+        pxMessageQueue->xOpenDescriptors = 1;
 
         /* A newly-created queue will not be pending unlink. */
-        ( *ppxMessageQueue )->xPendingUnlink = pdFALSE;
+        pxMessageQueue->xPendingUnlink = pdFALSE;
+
+        /* Add the new queue to both hash tables. */
+        listADD( mqueueNAME_BUCKET( pxMessageQueue->ulNameHash ), &pxMessageQueue->xNameLink );
+        listADD( mqueueDESCRIPTOR_BUCKET( pxMessageQueue ), &pxMessageQueue->xDescriptorLink );
 
-        /* Add the new queue to the list. */
-        listADD( &xQueueListHead, &( *ppxMessageQueue )->xLink );
+        *ppxMessageQueue = pxMessageQueue;
     }
 
     return xStatus;
@@ -264,20 +333,9 @@ static BaseType_t prvCreateNewMessageQueue( QueueListElement_t ** ppxMessageQueu
 
 static void prvDeleteMessageQueue( const QueueListElement_t * const pxMessageQueue )
 {
-    QueueElement_t xQueueElement = { 0 };
-
-    /* Free all data in the queue. It's assumed that no more data will be added
-     * to the queue, so xQueueReceive does not block. */
-    while( xQueueReceive( pxMessageQueue->xQueue,
-                          ( void * ) &xQueueElement,
-                          0 ) == pdTRUE )
-    {
-        vPortFree( xQueueElement.pcData );
-    }
-
-    /* Free memory used by this message queue. */
-    vQueueDelete( pxMessageQueue->xQueue );
-    vPortFree( ( void * ) pxMessageQueue->pcName );
+    /* Messages live in the queue's own slots, so nothing else needs freeing. */
+    vQueueDelete( pxMessageQueue->xFreeSlots );
+    vQueueDelete( pxMessageQueue->xFullSlots );
     vPortFree( ( void * ) pxMessageQueue );
 }
 
@@ -290,21 +348,32 @@ static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListEl
     Link_t * pxQueueListLink = NULL;
     QueueListElement_t * pxMessageQueue = NULL;
     BaseType_t xQueueFound = pdFALSE;
+    uint32_t ulNameHash = 0;
 
-    /* Iterate through the list of queues. */
-    listFOR_EACH( pxQueueListLink, &xQueueListHead )
+    /* Match by name if provided. */
+    if( pcName != NULL )
     {
-        pxMessageQueue = listCONTAINER( pxQueueListLink, QueueListElement_t, xLink );
+        ulNameHash = prvHashQueueName( pcName );
 
-        /* Match by name first if provided. */
-        if( ( pcName != NULL ) && ( strcmp( pxMessageQueue->pcName, pcName ) == 0 ) )
+        listFOR_EACH( pxQueueListLink, mqueueNAME_BUCKET( ulNameHash ) )
         {
-            xQueueFound = pdTRUE;
-            break;
+            pxMessageQueue = listCONTAINER( pxQueueListLink, QueueListElement_t, xNameLink );
+
+            if( ( pxMessageQueue->ulNameHash == ulNameHash ) &&
+                ( strcmp( pxMessageQueue->pcName, pcName ) == 0 ) )
+            {
+                xQueueFound = pdTRUE;
+                break;
+            }
         }
-        /* If name doesn't match, match by descriptor. */
-        else
+    }
+    /* Otherwise, match by descriptor. */
+    else
+    {
+        listFOR_EACH( pxQueueListLink, mqueueDESCRIPTOR_BUCKET( xMessageQueueDescriptor ) )
         {
+            pxMessageQueue = listCONTAINER( pxQueueListLink, QueueListElement_t, xDescriptorLink );
+
             if( ( mqd_t ) pxMessageQueue == xMessageQueueDescriptor )
             {
                 xQueueFound = pdTRUE;
@@ -324,10 +393,28 @@ static BaseType_t prvFindQueueInList( QueueListElement_t ** const ppxQueueListEl
 
 /*-----------------------------------------------------------*/
 
+static uint32_t prvHashQueueName( const char * const pcName )
+{
+    uint32_t ulHash = 2166136261UL;
+    const char * pcCharacter = pcName;
+
+    while( *pcCharacter != '\0' )
+    {
+        ulHash ^= ( uint8_t ) *pcCharacter;
+        ulHash *= 16777619UL;
+        pcCharacter++;
+    }
+
+    return ulHash;
+}
+
+/*-----------------------------------------------------------*/
+
 static void prvInitializeQueueList( void )
 {
     /* Keep track of whether the queue list has been initialized. */
     static BaseType_t xQueueListInitialized = pdFALSE;
+    size_t xBucket = 0;
 
     /* Check if queue list needs to be initialized. */
     if( xQueueListInitialized == pdFALSE )
@@ -341,9 +428,15 @@ static void prvInitializeQueueList( void )
          * section. */
         if( xQueueListInitialized == pdFALSE )
         {
-            /* Initialize the queue list mutex and list head. */
+            /* Initialize the queue list mutex and hash buckets. */
             ( void ) xSemaphoreCreateMutexStatic( &xQueueListMutex );
-            listINIT_HEAD( &xQueueListHead );
+
+            for( xBucket = 0; xBucket < posixconfigMQ_HASH_BUCKETS; xBucket++ )
+            {
+                listINIT_HEAD( &xQueueNameBuckets[ xBucket ] );
+                listINIT_HEAD( &xQueueDescriptorBuckets[ xBucket ] );
+            }
+
             xQueueListInitialized = pdTRUE;
         }
 
@@ -416,7 +509,8 @@ int mq_close( mqd_t mqdes )
              * remove the queue. */
             if( pxMessageQueue->xPendingUnlink == pdTRUE )
             {
-                listREMOVE( &pxMessageQueue->xLink );
+                listREMOVE( &pxMessageQueue->xNameLink );
+                listREMOVE( &pxMessageQueue->xDescriptorLink );
 
                 /* Set the flag to delete the queue. Deleting the queue is deferred
                  * until xQueueListMutex is released. */
@@ -465,7 +559,7 @@ int mq_getattr( mqd_t mqdes,
     {
         /* Update the number of messages in the queue and copy the attributes
          * into mqstat. */
-        pxMessageQueue->xAttr.mq_curmsgs = ( long ) uxQueueMessagesWaiting( pxMessageQueue->xQueue );
+        pxMessageQueue->xAttr.mq_curmsgs = ( long ) uxQueueMessagesWaiting( pxMessageQueue->xFullSlots );
         *mqstat = pxMessageQueue->xAttr;
     }
     else
@@ -630,7 +724,8 @@ ssize_t mq_timedreceive( mqd_t mqdes,
     int iCalculateTimeoutReturn = 0;
     TickType_t xTimeoutTicks = 0;
     QueueListElement_t * pxMessageQueue = ( QueueListElement_t * ) mqdes;
-    QueueElement_t xReceiveData = { 0 };
+    UBaseType_t uxSlot = 0;
+    MessageSlot_t * pxSlot = NULL;
 
     /* Silence warnings about unused parameters. */
     ( void ) msg_prio;
@@ -677,9 +772,9 @@ ssize_t mq_timedreceive( mqd_t mqdes,
 
     if( xStatus == 0 )
     {
-        /* Receive data from the FreeRTOS queue. */
-        if( xQueueReceive( pxMessageQueue->xQueue,
-                           &xReceiveData,
+        /* Take the oldest full slot. */
+        if( xQueueReceive( pxMessageQueue->xFullSlots,
+                           &uxSlot,
                            xTimeoutTicks ) == pdFALSE )
         {
             /* If queue receive fails, set the appropriate errno. */
@@ -700,12 +795,16 @@ ssize_t mq_timedreceive( mqd_t mqdes,
 
     if( xStatus == 0 )
     {
+        pxSlot = ( MessageSlot_t * ) ( pxMessageQueue->pucSlots + uxSlot * pxMessageQueue->xSlotStride );
+
         /* Get the length of data for return value. */
-        xStatus = ( ssize_t ) xReceiveData.xDataSize;
+        xStatus = ( ssize_t ) pxSlot->xDataSize;
 
-        /* Copy received data into given buffer, then free it. */
-        ( void ) memcpy( msg_ptr, xReceiveData.pcData, xReceiveData.xDataSize );
-        vPortFree( xReceiveData.pcData );
+        /* Copy received data into given buffer, then hand the slot back to
+         * senders. The free queue has room for every slot, so this cannot
+         * block. */
+        ( void ) memcpy( msg_ptr, pxSlot + 1, pxSlot->xDataSize );
+        ( void ) xQueueSend( pxMessageQueue->xFreeSlots, &uxSlot, 0 );
     }
 
     return xStatus;
@@ -722,7 +821,8 @@ int mq_timedsend( mqd_t mqdes,
     int iStatus = 0, iCalculateTimeoutReturn = 0;
     TickType_t xTimeoutTicks = 0;
     QueueListElement_t * pxMessageQueue = ( QueueListElement_t * ) mqdes;
-    QueueElement_t xSendData = { 0 };
+    UBaseType_t uxSlot = 0;
+    MessageSlot_t * pxSlot = NULL;
 
     /* Silence warnings about unused parameters. */
     ( void ) msg_prio;
@@ -767,34 +867,14 @@ int mq_timedsend( mqd_t mqdes,
     /* Release the mutex protecting the queue list. */
     ( void ) xSemaphoreGive( ( SemaphoreHandle_t ) &xQueueListMutex );
 
-    /* Allocate memory for the message. */
     if( iStatus == 0 )
     {
-        xSendData.xDataSize = msg_len;
-        xSendData.pcData = pvPortMalloc( msg_len );
-
-        /* Check that memory allocation succeeded. */
-        if( xSendData.pcData == NULL )
-        {
-            /* msg_len too large. */
-            errno = EMSGSIZE;
-            iStatus = -1;
-        }
-        else
-        {
-            /* Copy the data to send. */
-            ( void ) memcpy( xSendData.pcData, msg_ptr, msg_len );
-        }
-    }
-
-    if( iStatus == 0 )
-    {
-        /* Send data to the FreeRTOS queue. */
-        if( xQueueSend( pxMessageQueue->xQueue,
-                        &xSendData,
-                        xTimeoutTicks ) == pdFALSE )
+        /* Take an empty slot. The queue is full when none are left. */
+        if( xQueueReceive( pxMessageQueue->xFreeSlots,
+                           &uxSlot,
+                           xTimeoutTicks ) == pdFALSE )
         {
-            /* If queue send fails, set the appropriate errno. */
+            /* If no slot became free, set the appropriate errno. */
             if( pxMessageQueue->xAttr.mq_flags & O_NONBLOCK )
             {
                 /* Set errno to EAGAIN for nonblocking mq. */
@@ -806,13 +886,20 @@ int mq_timedsend( mqd_t mqdes,
                 errno = ETIMEDOUT;
             }
 
-            /* Free the allocated queue data. */
-            vPortFree( xSendData.pcData );
-
             iStatus = -1;
         }
     }
 
+    if( iStatus == 0 )
+    {
+        /* Copy the data into the slot and queue it for receivers. The full
+         * queue has room for every slot, so this cannot block. */
+        pxSlot = ( MessageSlot_t * ) ( pxMessageQueue->pucSlots + uxSlot * pxMessageQueue->xSlotStride );
+        pxSlot->xDataSize = msg_len;
+        ( void ) memcpy( pxSlot + 1, msg_ptr, msg_len );
+        ( void ) xQueueSend( pxMessageQueue->xFullSlots, &uxSlot, 0 );
+    }
+
     return iStatus;
 }
 
@@ -849,7 +936,8 @@ int mq_unlink( const char * name )
              * remove it from the list. */
             if( pxMessageQueue->xOpenDescriptors == 0 )
             {
-                listREMOVE( &pxMessageQueue->xLink );
+                listREMOVE( &pxMessageQueue->xNameLink );
+                listREMOVE( &pxMessageQueue->xDescriptorLink );
 
                 /* Set the flag to delete the queue. Deleting the queue is deferred
                  * until xQueueListMutex is released. */
@@ -42,6 +42,9 @@
 /* FreeRTOS timer include. */
 #include "timers.h"
 
+/* FreeRTOS_POSIX_hrtimer.c implements the timers when posixconfigENABLE_HRTIMER is 1. */
+#if ( posixconfigENABLE_HRTIMER == 0 )
+
 /**
  * @defgroup Timespec zero check macros.
  */
@@ -323,3 +326,5 @@ int timer_gettime( timer_t timerid,
 }
 
 /*-----------------------------------------------------------*/
+
+#endif /* posixconfigENABLE_HRTIMER == 0 */
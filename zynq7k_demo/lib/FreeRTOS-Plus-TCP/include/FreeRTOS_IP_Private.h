@@ -249,7 +249,7 @@ typedef enum
 	eDHCPEvent,				/* 4: Process the DHCP state machine. */
 	eTCPTimerEvent,			/* 5: See if any TCP socket needs attention. */
 	eTCPAcceptEvent,		/* 6: Client API FreeRTOS_accept() waiting for client connections. */
-	eTCPNetStat,			/* 7: IP-task is asked to produce a netstat listing. */
+	eTCPNetStat,			/* 7: IP-task is asked to produce a netstat listing, or a count when pvData is set. */
 	eSocketBindEvent,		/* 8: Send a message to the IP-task to bind a socket to a port. */
 	eSocketCloseEvent,		/* 9: Send a message to the IP-task to close a socket. */
 	eSocketSelectEvent,		/*10: Send a message to the IP-task for select(). */
@@ -468,6 +468,12 @@ BaseType_t xIPIsNetworkTaskReady( void );
 	 */
 	void vTCPNetStat( void );
 
+	/*
+	 * Count the TCP sockets by state for FreeRTOS_netstat_count(), called
+	 * from the IP-task
+	 */
+	void vTCPNetStatCount( TCPNetStatCount_t *pxCount );
+
 	/*
 	 * At least one socket needs to check for timeouts
 	 */
@@ -43,6 +43,9 @@ extern "C" {
 /* Event bit definitions are required by the select functions. */
 #include "event_groups.h"
 
+/* The semaphore type is required by FreeRTOS_netstat_count(). */
+#include "semphr.h"
+
 #ifndef INC_FREERTOS_H
 	#error FreeRTOS.h must be included before FreeRTOS_Sockets.h.
 #endif
@@ -349,6 +352,28 @@ const struct xSTREAM_BUFFER *FreeRTOS_get_rx_buf( Socket_t xSocket );
 
 void FreeRTOS_netstat( void );
 
+#if( ipconfigUSE_TCP == 1 )
+
+	/* Summary of the TCP sockets, as counted by the IP-task. */
+	typedef struct xTCP_NET_STAT_COUNT
+	{
+		SemaphoreHandle_t xDone;		/* Given by the IP-task once the counts are valid. */
+		UBaseType_t uxBound;			/* Number of sockets in xBoundTCPSocketsList. */
+		UBaseType_t uxListening;		/* Of which in the eTCP_LISTEN state. */
+		UBaseType_t uxEstablished;		/* Of which in the eESTABLISHED state. */
+	} TCPNetStatCount_t;
+
+	/*
+	 * Ask the IP-task to count the TCP sockets by state, and wait up to
+	 * xTimeout for the result.  pxCount must remain valid until the IP-task has
+	 * handled the request, also when this function times out.  xDone must be
+	 * NULL before the first call; the semaphore is then created and kept in
+	 * pxCount for later requests, so a late answer cannot reach another wait.
+	 */
+	BaseType_t FreeRTOS_netstat_count( TCPNetStatCount_t *pxCount, TickType_t xTimeout );
+
+#endif /* ipconfigUSE_TCP */
+
 #if ipconfigSUPPORT_SELECT_FUNCTION == 1
 
 	/* For FD_SET and FD_CLR, a combination of the following bits can be used: */
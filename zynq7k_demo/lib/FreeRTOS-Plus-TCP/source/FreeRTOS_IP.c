@@ -492,10 +492,20 @@ struct freertos_sockaddr xAddress;
 
 			case eTCPNetStat:
 				/* FreeRTOS_netstat() was called to have the IP-task print an
-				overview of all sockets and their connections */
-				#if( ( ipconfigUSE_TCP == 1 ) && ( ipconfigHAS_PRINTF == 1 ) )
+				overview of all sockets and their connections, or
+				FreeRTOS_netstat_count() was called to have them counted. */
+				#if( ipconfigUSE_TCP == 1 )
 				{
-					vTCPNetStat();
+					if( xReceivedEvent.pvData != NULL )
+					{
+						vTCPNetStatCount( ( TCPNetStatCount_t * ) xReceivedEvent.pvData );
+					}
+					#if( ipconfigHAS_PRINTF == 1 )
+					else
+					{
+						vTCPNetStat();
+					}
+					#endif /* ipconfigHAS_PRINTF */
 				}
 				#endif /* ipconfigUSE_TCP */
 				break;
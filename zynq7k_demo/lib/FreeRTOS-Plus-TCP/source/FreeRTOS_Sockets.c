@@ -3325,6 +3325,82 @@ void vSocketWakeUpUser( FreeRTOS_Socket_t *pxSocket )
 #endif /* ipconfigUSE_TCP */
 /*-----------------------------------------------------------*/
 
+#if( ipconfigUSE_TCP == 1 )
+
+	BaseType_t FreeRTOS_netstat_count( TCPNetStatCount_t *pxCount, TickType_t xTimeout )
+	{
+	IPStackEvent_t xAskEvent;
+	TimeOut_t xTimeOut;
+	BaseType_t xReturn = pdFAIL;
+
+		configASSERT( pxCount != NULL );
+
+		if( pxCount->xDone == NULL )
+		{
+			pxCount->xDone = xSemaphoreCreateBinary();
+
+			if( pxCount->xDone == NULL )
+			{
+				return pdFAIL;
+			}
+		}
+
+		/* Discard the answer to an earlier request that timed out. */
+		( void ) xSemaphoreTake( pxCount->xDone, 0u );
+
+		/* Ask the IP-task to walk xBoundTCPSocketsList, which may only be
+		accessed from the IP-task. */
+		xAskEvent.eEventType = eTCPNetStat;
+		xAskEvent.pvData = ( void * ) pxCount;
+
+		vTaskSetTimeOutState( &xTimeOut );
+
+		if( xSendEventStructToIPTask( &xAskEvent, xTimeout ) == pdPASS )
+		{
+			( void ) xTaskCheckForTimeOut( &xTimeOut, &xTimeout );
+
+			if( xSemaphoreTake( pxCount->xDone, xTimeout ) == pdPASS )
+			{
+				xReturn = pdPASS;
+			}
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTCPNetStatCount( TCPNetStatCount_t *pxCount )
+	{
+	const ListItem_t *pxIterator;
+	const MiniListItem_t *pxEnd = ( const MiniListItem_t* )listGET_END_MARKER( &xBoundTCPSocketsList );
+	UBaseType_t uxListening = 0u, uxEstablished = 0u;
+
+		for( pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxEnd );
+			 pxIterator != ( const ListItem_t * ) pxEnd;
+			 pxIterator  = ( const ListItem_t * ) listGET_NEXT( pxIterator ) )
+		{
+		const FreeRTOS_Socket_t *pxSocket = ( const FreeRTOS_Socket_t * ) listGET_LIST_ITEM_OWNER( pxIterator );
+
+			if( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eTCP_LISTEN )
+			{
+				uxListening++;
+			}
+			else if( pxSocket->u.xTCP.ucTCPState == ( uint8_t ) eESTABLISHED )
+			{
+				uxEstablished++;
+			}
+		}
+
+		pxCount->uxBound = listCURRENT_LIST_LENGTH( &xBoundTCPSocketsList );
+		pxCount->uxListening = uxListening;
+		pxCount->uxEstablished = uxEstablished;
+
+		( void ) xSemaphoreGive( pxCount->xDone );
+	}
+
+#endif /* ipconfigUSE_TCP */
+/*-----------------------------------------------------------*/
+
 #if( ( ipconfigHAS_PRINTF != 0 ) && ( ipconfigUSE_TCP == 1 ) )
 
 	void vTCPNetStat( void )
@@ -0,0 +1,1140 @@
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() that uses a two level
+ * segregated fit (TLSF) allocator, so both run in constant time whatever the
+ * number of free blocks.  Like heap_4.c, adjacent free blocks are combined
+ * when a block is freed.
+ *
+ * Free blocks are kept in lists of blocks of similar size.  The first level
+ * index selects a power of two size range, the second level index splits that
+ * range linearly into heapSL_INDEX_COUNT lists.  A bitmap per level records
+ * which lists are not empty, so a list holding blocks large enough for a
+ * request is found with two bit scans instead of a walk of the free blocks.
+ *
+ * When configHEAP_SMALL_OBJECT_SLABS is 1, requests of up to 256 bytes are
+ * served from slab pages, each holding objects of a single size class.  This
+ * keeps short lived small allocations from fragmenting the space used by
+ * large buffers.
+ *
+ * When configHEAP_TRACK_CALL_SITES is 1, the heap space held by the blocks
+ * allocated from each caller of pvPortMalloc() is counted and can be read with
+ * uxPortGetHeapCallSiteStats().  This adds a pointer to each block.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ */
+#include <stdlib.h>
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configHEAP_SMALL_OBJECT_SLABS
+	#define configHEAP_SMALL_OBJECT_SLABS	0
+#endif
+
+/* The size of the blocks that slab pages are carved from. */
+#ifndef configHEAP_SLAB_PAGE_SIZE
+	#define configHEAP_SLAB_PAGE_SIZE		2048
+#endif
+
+#ifndef configHEAP_TRACK_CALL_SITES
+	#define configHEAP_TRACK_CALL_SITES		0
+#endif
+
+/* The number of different call sites that are counted separately.  Call sites
+beyond this number are counted together. */
+#ifndef configHEAP_CALL_SITE_COUNT
+	#define configHEAP_CALL_SITE_COUNT		32
+#endif
+
+/* Returns the address pvPortMalloc() was called from. */
+#ifndef heapGET_CALL_SITE
+	#define heapGET_CALL_SITE()				__builtin_return_address( 0 )
+#endif
+
+/* Find last set and find first set.  The GCC builtins compile to the CLZ
+instruction on ARMv7. */
+#ifndef heapFIND_LAST_SET
+	#define heapFIND_LAST_SET( x )			( ( UBaseType_t ) ( ( sizeof( unsigned long ) * heapBITS_PER_BYTE ) - 1 - __builtin_clzl( ( unsigned long ) ( x ) ) ) )
+#endif
+
+#ifndef heapFIND_FIRST_SET
+	#define heapFIND_FIRST_SET( x )			( ( UBaseType_t ) __builtin_ctzl( ( unsigned long ) ( x ) ) )
+#endif
+
+/* Assumes 8bit bytes! */
+#define heapBITS_PER_BYTE		( ( size_t ) 8 )
+
+#if portBYTE_ALIGNMENT == 32
+	#define heapALIGNMENT_LOG2	( 5 )
+#elif portBYTE_ALIGNMENT == 16
+	#define heapALIGNMENT_LOG2	( 4 )
+#elif portBYTE_ALIGNMENT == 8
+	#define heapALIGNMENT_LOG2	( 3 )
+#else
+	#error heap_tlsf.c requires portBYTE_ALIGNMENT to be 8, 16 or 32
+#endif
+
+#define heapALIGN_UP( x )		( ( ( size_t ) ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Each first level range is split into 16 second level lists.  Blocks smaller
+than heapSMALL_BLOCK_SIZE all go in the first first level range, which is split
+linearly in steps of portBYTE_ALIGNMENT. */
+#define heapSL_INDEX_COUNT_LOG2	( 4 )
+#define heapSL_INDEX_COUNT		( 1 << heapSL_INDEX_COUNT_LOG2 )
+#define heapFL_INDEX_SHIFT		( heapSL_INDEX_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* Blocks can be up to 2^heapFL_INDEX_MAX bytes. */
+#define heapFL_INDEX_MAX		( 28 )
+#define heapFL_INDEX_COUNT		( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+
+/* The low bits of xBlockSize are free as sizes are multiples of
+portBYTE_ALIGNMENT.  Bit 0 marks free blocks.  Bit 1 is never set in the size of
+a block but is set in the word in front of slab objects, see vPortFree(). */
+#define heapBLOCK_FREE_BIT		( ( size_t ) 1 )
+#define heapSLAB_OBJECT_BIT		( ( size_t ) 2 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xBlockSize & heapBLOCK_FREE_BIT ) != 0 )
+#define heapNEXT_PHYSICAL_BLOCK( pxBlock )	( ( BlockLink_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* The header at the start of every block.  xBlockSize includes the header and
+must be the last member before the free list links, so that it is the word
+immediately in front of the memory returned to the application.  The free list
+links overlay the application's memory, so are only valid while the block is
+free. */
+typedef struct A_BLOCK_LINK
+{
+	struct A_BLOCK_LINK *pxPrevPhysicalBlock;	/*<< The block immediately before this one in memory. */
+	#if( configHEAP_TRACK_CALL_SITES == 1 )
+		HeapCallSiteStats_t *pxCallSite;		/*<< The call site the block was allocated from. */
+		void *pvPadding;						/*<< Keeps the header a multiple of portBYTE_ALIGNMENT. */
+	#endif
+	size_t xBlockSize;							/*<< The size of the block, including this header. */
+	struct A_BLOCK_LINK *pxNextFreeBlock;		/*<< The next block in the same free list. */
+	struct A_BLOCK_LINK *pxPrevFreeBlock;		/*<< The previous block in the same free list. */
+} BlockLink_t;
+
+#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+
+	/* The number of slab size classes, holding objects of 16, 32, 64, 128 and
+	256 bytes. */
+	#define heapSLAB_CLASS_COUNT		( 5 )
+	#define heapSLAB_SMALLEST_LOG2		( 4 )
+	#define heapSLAB_LARGEST_OBJECT		( ( size_t ) 1 << ( heapSLAB_SMALLEST_LOG2 + heapSLAB_CLASS_COUNT - 1 ) )
+
+	/* The header in front of each slab object.  As with BlockLink_t, the last
+	member is the word immediately in front of the memory returned to the
+	application.  It holds the address of the page with heapSLAB_OBJECT_BIT set.
+	The next free object pointer overlays the application's memory. */
+	typedef struct A_SLAB_OBJECT
+	{
+		#if( configHEAP_TRACK_CALL_SITES == 1 )
+			HeapCallSiteStats_t *pxCallSite;	/*<< The call site the object was allocated from. */
+		#else
+			void *pvPadding;					/*<< Keeps the header a multiple of portBYTE_ALIGNMENT. */
+		#endif
+		size_t xSlabPage;						/*<< The page holding the object, with heapSLAB_OBJECT_BIT set. */
+		struct A_SLAB_OBJECT *pxNextFreeObject;	/*<< Only valid while the object is free. */
+	} SlabObject_t;
+
+	/* A page of objects of one size class, placed at the start of the memory of
+	a block allocated from the TLSF heap. */
+	typedef struct A_SLAB_PAGE
+	{
+		struct A_SLAB_PAGE *pxNextPage;			/*<< Pages of the class that have free objects. */
+		struct A_SLAB_PAGE *pxPrevPage;
+		SlabObject_t *pxFreeObjects;			/*<< The free objects in this page. */
+		uint16_t usFreeObjects;
+		uint16_t usObjects;
+		uint8_t ucClass;
+	} SlabPage_t;
+
+#endif /* configHEAP_SMALL_OBJECT_SLABS */
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void );
+
+/*
+ * Calculate the first and second level indexes of the free list that holds
+ * blocks of size xBlockSize.
+ */
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFL, UBaseType_t *puxSL );
+
+/*
+ * Calculate the first and second level indexes of the first free list in
+ * which every block is at least xBlockSize bytes.
+ */
+static void prvMappingSearch( size_t xBlockSize, UBaseType_t *puxFL, UBaseType_t *puxSL );
+
+/*
+ * Add a free block to, or remove a free block from, the free list matching its
+ * size.
+ */
+static void prvInsertFreeBlock( BlockLink_t *pxBlock );
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock );
+
+/*
+ * Allocate a block of xBlockSize bytes, including the header, or return NULL.
+ * xBlockSize must be a multiple of portBYTE_ALIGNMENT.
+ */
+static BlockLink_t *prvAllocateBlock( size_t xBlockSize );
+
+/*
+ * Return a block to the free lists, combining it with the blocks either side of
+ * it if they are free.
+ */
+static void prvFreeBlock( BlockLink_t *pxBlock );
+
+#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+
+	/*
+	 * Allocate an object from the slab class for xWantedSize bytes.  Returns NULL
+	 * if there is no free object and a new page cannot be allocated.
+	 */
+	static void *prvAllocateObject( size_t xWantedSize, HeapCallSiteStats_t *pxCallSite );
+
+	/*
+	 * Return an object to its page, releasing the page if it becomes empty.
+	 */
+	static void prvFreeObject( SlabObject_t *pxObject );
+
+#endif
+
+#if( configHEAP_TRACK_CALL_SITES == 1 )
+
+	/*
+	 * Find, or create, the record for the call site pvCallSite.
+	 */
+	static HeapCallSiteStats_t *prvGetCallSite( void *pvCallSite );
+
+	/*
+	 * Update the record of a call site for an allocation of xBytes, or for a free
+	 * of xBytes.
+	 */
+	static void prvCallSiteAllocated( HeapCallSiteStats_t *pxCallSite, size_t xBytes );
+	static void prvCallSiteFreed( HeapCallSiteStats_t *pxCallSite, size_t xBytes );
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* The size of the structure placed at the beginning of each allocated block.
+offsetof() gives a multiple of portBYTE_ALIGNMENT for the supported alignments,
+which is checked by prvHeapInit(). */
+static const size_t xHeapStructSize = offsetof( BlockLink_t, pxNextFreeBlock );
+
+/* Free blocks must be large enough to hold the free list links. */
+static const size_t xMinimumBlockSize = heapALIGN_UP( sizeof( BlockLink_t ) );
+
+/* The free lists, and the bitmaps recording which of them are not empty. */
+static BlockLink_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFLBitmap = 0;
+static uint32_t ulSLBitmap[ heapFL_INDEX_COUNT ];
+
+/* Marks the end of the heap.  It is never free, so is never combined with the
+block in front of it. */
+static BlockLink_t *pxEnd = NULL;
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation.  Unused space in slab pages is counted as free. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+
+	/* The size of the structures placed at the start of each slab page and in
+	front of each slab object. */
+	static const size_t xSlabPageStructSize = heapALIGN_UP( sizeof( SlabPage_t ) );
+	static const size_t xSlabObjectStructSize = offsetof( SlabObject_t, pxNextFreeObject );
+
+	/* The pages of each class that have free objects. */
+	static SlabPage_t *pxSlabPages[ heapSLAB_CLASS_COUNT ];
+
+#endif
+
+#if( configHEAP_TRACK_CALL_SITES == 1 )
+
+	/* Open addressed table of call sites, and the record for call sites that do
+	not fit in the table. */
+	static HeapCallSiteStats_t xCallSites[ configHEAP_CALL_SITE_COUNT ];
+	static HeapCallSiteStats_t xOtherCallSites;
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockLink_t *pxBlock;
+void *pvReturn = NULL;
+size_t xBlockSize;
+HeapCallSiteStats_t *pxCallSite = NULL;
+
+	#if( configHEAP_TRACK_CALL_SITES == 1 )
+		void *pvCallSite = heapGET_CALL_SITE();
+	#endif
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the free lists. */
+		if( pxEnd == NULL )
+		{
+			prvHeapInit();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		#if( configHEAP_TRACK_CALL_SITES == 1 )
+		{
+			pxCallSite = prvGetCallSite( pvCallSite );
+		}
+		#endif
+
+		#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+		{
+			if( ( xWantedSize > 0 ) && ( xWantedSize <= heapSLAB_LARGEST_OBJECT ) )
+			{
+				pvReturn = prvAllocateObject( xWantedSize, pxCallSite );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+
+		/* The wanted size is increased so it can contain a BlockLink_t
+		structure in addition to the requested amount of bytes, and rounded up
+		to keep blocks aligned.  Sizes so large that this overflows, or that are
+		beyond the largest free list, cannot be allocated. */
+		if( ( pvReturn == NULL ) && ( xWantedSize > 0 ) && ( xWantedSize < ( ( size_t ) 1 << heapFL_INDEX_MAX ) ) )
+		{
+			xBlockSize = heapALIGN_UP( xWantedSize + xHeapStructSize );
+
+			if( xBlockSize < xMinimumBlockSize )
+			{
+				xBlockSize = xMinimumBlockSize;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxBlock = prvAllocateBlock( xBlockSize );
+
+			if( pxBlock != NULL )
+			{
+				#if( configHEAP_TRACK_CALL_SITES == 1 )
+				{
+					pxBlock->pxCallSite = pxCallSite;
+					prvCallSiteAllocated( pxCallSite, heapBLOCK_SIZE( pxBlock ) );
+				}
+				#endif
+
+				/* Return the memory space pointed to - jumping over the
+				BlockLink_t structure at its start. */
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( pvReturn != NULL )
+		{
+			xNumberOfSuccessfulAllocations++;
+
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		( void ) pxCallSite;
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint8_t *puc = ( uint8_t * ) pv;
+BlockLink_t *pxLink;
+size_t xTag;
+
+	if( pv != NULL )
+	{
+		/* The word in front of the memory is either the size of a block, or
+		the page of a slab object. */
+		xTag = *( ( size_t * ) ( puc - sizeof( size_t ) ) );
+
+		vTaskSuspendAll();
+		{
+			#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+			if( ( xTag & heapSLAB_OBJECT_BIT ) != 0 )
+			{
+				traceFREE( pv, 0 );
+				prvFreeObject( ( SlabObject_t * ) ( puc - xSlabObjectStructSize ) );
+				xNumberOfSuccessfulFrees++;
+			}
+			else
+			#endif
+			{
+				/* The memory being freed will have an BlockLink_t structure
+				immediately before it. */
+				pxLink = ( BlockLink_t * ) ( puc - xHeapStructSize );
+
+				/* Check the block is actually allocated. */
+				configASSERT( ( xTag & ( heapBLOCK_FREE_BIT | heapSLAB_OBJECT_BIT ) ) == 0 );
+
+				if( ( xTag & ( heapBLOCK_FREE_BIT | heapSLAB_OBJECT_BIT ) ) == 0 )
+				{
+					#if( configHEAP_TRACK_CALL_SITES == 1 )
+					{
+						prvCallSiteFreed( pxLink->pxCallSite, heapBLOCK_SIZE( pxLink ) );
+					}
+					#endif
+
+					traceFREE( pv, heapBLOCK_SIZE( pxLink ) );
+					prvFreeBlock( pxLink );
+					xNumberOfSuccessfulFrees++;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+UBaseType_t uxFL, uxSL;
+size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+
+	/* Unlike allocating and freeing, this walks every free block. */
+	vTaskSuspendAll();
+	{
+		for( uxFL = 0; uxFL < heapFL_INDEX_COUNT; uxFL++ )
+		{
+			for( uxSL = 0; uxSL < heapSL_INDEX_COUNT; uxSL++ )
+			{
+				for( pxBlock = pxFreeLists[ uxFL ][ uxSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+				{
+					xBlocks++;
+
+					if( heapBLOCK_SIZE( pxBlock ) > xMaxSize )
+					{
+						xMaxSize = heapBLOCK_SIZE( pxBlock );
+					}
+
+					if( heapBLOCK_SIZE( pxBlock ) < xMinSize )
+					{
+						xMinSize = heapBLOCK_SIZE( pxBlock );
+					}
+				}
+			}
+		}
+
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+		pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( xBlocks > 0 ) ? xMinSize : 0;
+		pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortGetHeapCallSiteStats( HeapCallSiteStats_t *pxCallSiteStats, UBaseType_t uxMaxEntries )
+{
+UBaseType_t uxEntries = 0;
+
+	#if( configHEAP_TRACK_CALL_SITES == 1 )
+	{
+	UBaseType_t uxIndex;
+
+		vTaskSuspendAll();
+		{
+			for( uxIndex = 0; ( uxIndex < configHEAP_CALL_SITE_COUNT ) && ( uxEntries < uxMaxEntries ); uxIndex++ )
+			{
+				if( xCallSites[ uxIndex ].pvCallSite != NULL )
+				{
+					pxCallSiteStats[ uxEntries++ ] = xCallSites[ uxIndex ];
+				}
+			}
+
+			if( ( xOtherCallSites.xNumberOfAllocations > 0 ) && ( uxEntries < uxMaxEntries ) )
+			{
+				pxCallSiteStats[ uxEntries++ ] = xOtherCallSites;
+			}
+		}
+		( void ) xTaskResumeAll();
+	}
+	#else
+	{
+		( void ) pxCallSiteStats;
+		( void ) uxMaxEntries;
+	}
+	#endif
+
+	return uxEntries;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+BlockLink_t *pxFirstFreeBlock;
+uint8_t *pucAlignedHeap;
+size_t uxAddress;
+size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+
+	/* The header must keep the memory returned to the application aligned,
+	and the heap must fit in the free lists. */
+	configASSERT( ( xHeapStructSize & portBYTE_ALIGNMENT_MASK ) == 0 );
+	configASSERT( xTotalHeapSize < ( ( size_t ) 1 << heapFL_INDEX_MAX ) );
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	uxAddress = ( size_t ) ucHeap;
+
+	if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		uxAddress += ( portBYTE_ALIGNMENT - 1 );
+		uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+		xTotalHeapSize -= uxAddress - ( size_t ) ucHeap;
+	}
+
+	pucAlignedHeap = ( uint8_t * ) uxAddress;
+
+	/* pxEnd is used to mark the end of the heap.  It is a block header that
+	is never free. */
+	uxAddress = ( ( size_t ) pucAlignedHeap ) + xTotalHeapSize;
+	uxAddress -= xHeapStructSize;
+	uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+	pxEnd = ( void * ) uxAddress;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, minus the space taken by pxEnd. */
+	pxFirstFreeBlock = ( void * ) pucAlignedHeap;
+	pxFirstFreeBlock->pxPrevPhysicalBlock = NULL;
+	pxFirstFreeBlock->xBlockSize = ( uxAddress - ( size_t ) pxFirstFreeBlock ) | heapBLOCK_FREE_BIT;
+
+	pxEnd->pxPrevPhysicalBlock = pxFirstFreeBlock;
+	pxEnd->xBlockSize = 0;
+
+	prvInsertFreeBlock( pxFirstFreeBlock );
+
+	/* Only one block exists - and it covers the entire usable heap space. */
+	xMinimumEverFreeBytesRemaining = heapBLOCK_SIZE( pxFirstFreeBlock );
+	xFreeBytesRemaining = heapBLOCK_SIZE( pxFirstFreeBlock );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xBlockSize, UBaseType_t *puxFL, UBaseType_t *puxSL )
+{
+UBaseType_t uxFL, uxSL;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are split linearly. */
+		uxFL = 0;
+		uxSL = ( UBaseType_t ) ( xBlockSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		uxFL = heapFIND_LAST_SET( xBlockSize );
+		uxSL = ( UBaseType_t ) ( xBlockSize >> ( uxFL - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		uxFL -= ( heapFL_INDEX_SHIFT - 1 );
+	}
+
+	*puxFL = uxFL;
+	*puxSL = uxSL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xBlockSize, UBaseType_t *puxFL, UBaseType_t *puxSL )
+{
+	/* Round the size up to the start of the next list, so every block in the
+	list found is large enough. */
+	if( xBlockSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xBlockSize += ( ( size_t ) 1 << ( heapFIND_LAST_SET( xBlockSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	prvMappingInsert( xBlockSize, puxFL, puxSL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFL, uxSL;
+BlockLink_t *pxHead;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+
+	pxHead = pxFreeLists[ uxFL ][ uxSL ];
+	pxBlock->pxNextFreeBlock = pxHead;
+	pxBlock->pxPrevFreeBlock = NULL;
+
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFreeBlock = pxBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxFreeLists[ uxFL ][ uxSL ] = pxBlock;
+	ulFLBitmap |= ( 1UL << uxFL );
+	ulSLBitmap[ uxFL ] |= ( 1UL << uxSL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockLink_t *pxBlock )
+{
+UBaseType_t uxFL, uxSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &uxFL, &uxSL );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was the head of its list. */
+		pxFreeLists[ uxFL ][ uxSL ] = pxBlock->pxNextFreeBlock;
+
+		if( pxFreeLists[ uxFL ][ uxSL ] == NULL )
+		{
+			ulSLBitmap[ uxFL ] &= ~( 1UL << uxSL );
+
+			if( ulSLBitmap[ uxFL ] == 0 )
+			{
+				ulFLBitmap &= ~( 1UL << uxFL );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BlockLink_t *prvAllocateBlock( size_t xBlockSize )
+{
+BlockLink_t *pxBlock = NULL, *pxNewBlockLink;
+UBaseType_t uxFL, uxSL;
+uint32_t ulMap;
+
+	prvMappingSearch( xBlockSize, &uxFL, &uxSL );
+
+	if( uxFL < heapFL_INDEX_COUNT )
+	{
+		/* Look for a non-empty list at or above uxSL in the same range, and
+		failing that the first non-empty list of a larger range. */
+		ulMap = ulSLBitmap[ uxFL ] & ( ~0UL << uxSL );
+
+		if( ulMap == 0 )
+		{
+			ulMap = ulFLBitmap & ( ~0UL << ( uxFL + 1 ) );
+
+			if( ulMap != 0 )
+			{
+				uxFL = heapFIND_FIRST_SET( ulMap );
+				ulMap = ulSLBitmap[ uxFL ];
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( ulMap != 0 )
+		{
+			uxSL = heapFIND_FIRST_SET( ulMap );
+			pxBlock = pxFreeLists[ uxFL ][ uxSL ];
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlock != NULL )
+	{
+		/* This block is being returned for use so must be taken out of the
+		free lists. */
+		prvRemoveFreeBlock( pxBlock );
+		configASSERT( heapBLOCK_SIZE( pxBlock ) >= xBlockSize );
+
+		/* If the block is larger than required it can be split into two. */
+		if( ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) >= xMinimumBlockSize )
+		{
+			pxNewBlockLink = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xBlockSize );
+			configASSERT( ( ( ( size_t ) pxNewBlockLink ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+
+			pxNewBlockLink->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xBlockSize ) | heapBLOCK_FREE_BIT;
+			pxNewBlockLink->pxPrevPhysicalBlock = pxBlock;
+			heapNEXT_PHYSICAL_BLOCK( pxNewBlockLink )->pxPrevPhysicalBlock = pxNewBlockLink;
+			pxBlock->xBlockSize = xBlockSize;
+
+			prvInsertFreeBlock( pxNewBlockLink );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* The block is being returned - it is allocated and owned by the
+		application. */
+		pxBlock->xBlockSize &= ~heapBLOCK_FREE_BIT;
+		xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFreeBlock( BlockLink_t *pxBlock )
+{
+BlockLink_t *pxNeighbour;
+
+	xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+
+	/* Combine with the block behind, if it is free. */
+	pxNeighbour = heapNEXT_PHYSICAL_BLOCK( pxBlock );
+
+	if( heapBLOCK_IS_FREE( pxNeighbour ) )
+	{
+		prvRemoveFreeBlock( pxNeighbour );
+		pxBlock->xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* Combine with the block in front, if it is free. */
+	pxNeighbour = pxBlock->pxPrevPhysicalBlock;
+
+	if( ( pxNeighbour != NULL ) && heapBLOCK_IS_FREE( pxNeighbour ) )
+	{
+		prvRemoveFreeBlock( pxNeighbour );
+		pxNeighbour->xBlockSize = heapBLOCK_SIZE( pxNeighbour ) + heapBLOCK_SIZE( pxBlock );
+		pxBlock = pxNeighbour;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxBlock->xBlockSize |= heapBLOCK_FREE_BIT;
+	heapNEXT_PHYSICAL_BLOCK( pxBlock )->pxPrevPhysicalBlock = pxBlock;
+	prvInsertFreeBlock( pxBlock );
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+
+	static void *prvAllocateObject( size_t xWantedSize, HeapCallSiteStats_t *pxCallSite )
+	{
+	UBaseType_t uxClass = 0;
+	size_t xObjectSize, xStride;
+	SlabPage_t *pxPage;
+	SlabObject_t *pxObject;
+	BlockLink_t *pxBlock;
+	uint8_t *pucObject;
+	uint16_t usObject;
+
+		while( ( ( size_t ) 1 << ( heapSLAB_SMALLEST_LOG2 + uxClass ) ) < xWantedSize )
+		{
+			uxClass++;
+		}
+
+		xObjectSize = ( size_t ) 1 << ( heapSLAB_SMALLEST_LOG2 + uxClass );
+		xStride = xSlabObjectStructSize + heapALIGN_UP( xObjectSize );
+		pxPage = pxSlabPages[ uxClass ];
+
+		if( pxPage == NULL )
+		{
+			/* Carve a new page into objects.  The space of the page is
+			counted as free until objects are allocated from it. */
+			pxBlock = prvAllocateBlock( heapALIGN_UP( configHEAP_SLAB_PAGE_SIZE + xHeapStructSize ) );
+
+			if( pxBlock == NULL )
+			{
+				/* Fall back to allocating a block of its own. */
+				return NULL;
+			}
+
+			xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+
+			pxPage = ( SlabPage_t * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+			pxPage->pxNextPage = NULL;
+			pxPage->pxPrevPage = NULL;
+			pxPage->pxFreeObjects = NULL;
+			pxPage->usObjects = ( uint16_t ) ( ( heapBLOCK_SIZE( pxBlock ) - xHeapStructSize - xSlabPageStructSize ) / xStride );
+			pxPage->usFreeObjects = pxPage->usObjects;
+			pxPage->ucClass = ( uint8_t ) uxClass;
+
+			pucObject = ( ( uint8_t * ) pxPage ) + xSlabPageStructSize + ( ( size_t ) pxPage->usObjects * xStride );
+
+			for( usObject = 0; usObject < pxPage->usObjects; usObject++ )
+			{
+				pucObject -= xStride;
+				pxObject = ( SlabObject_t * ) pucObject;
+				pxObject->xSlabPage = ( ( size_t ) pxPage ) | heapSLAB_OBJECT_BIT;
+				pxObject->pxNextFreeObject = pxPage->pxFreeObjects;
+				pxPage->pxFreeObjects = pxObject;
+			}
+
+			#if( configHEAP_TRACK_CALL_SITES == 1 )
+			{
+				/* The page itself is not counted against any call site. */
+				pxBlock->pxCallSite = NULL;
+			}
+			#endif
+
+			pxSlabPages[ uxClass ] = pxPage;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxObject = pxPage->pxFreeObjects;
+		pxPage->pxFreeObjects = pxObject->pxNextFreeObject;
+		pxPage->usFreeObjects--;
+
+		/* A full page is removed from the list of pages with free objects. */
+		if( pxPage->usFreeObjects == 0 )
+		{
+			pxSlabPages[ uxClass ] = pxPage->pxNextPage;
+
+			if( pxPage->pxNextPage != NULL )
+			{
+				pxPage->pxNextPage->pxPrevPage = NULL;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxPage->pxNextPage = NULL;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xFreeBytesRemaining -= xStride;
+
+		#if( configHEAP_TRACK_CALL_SITES == 1 )
+		{
+			pxObject->pxCallSite = pxCallSite;
+			prvCallSiteAllocated( pxCallSite, xStride );
+		}
+		#else
+		{
+			( void ) pxCallSite;
+		}
+		#endif
+
+		return ( void * ) ( ( ( uint8_t * ) pxObject ) + xSlabObjectStructSize );
+	}
+
+#endif /* configHEAP_SMALL_OBJECT_SLABS */
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_SMALL_OBJECT_SLABS == 1 )
+
+	static void prvFreeObject( SlabObject_t *pxObject )
+	{
+	SlabPage_t *pxPage = ( SlabPage_t * ) ( pxObject->xSlabPage & ~heapSLAB_OBJECT_BIT );
+	UBaseType_t uxClass = pxPage->ucClass;
+	size_t xStride = xSlabObjectStructSize + heapALIGN_UP( ( size_t ) 1 << ( heapSLAB_SMALLEST_LOG2 + uxClass ) );
+	BlockLink_t *pxBlock;
+
+		#if( configHEAP_TRACK_CALL_SITES == 1 )
+		{
+			prvCallSiteFreed( pxObject->pxCallSite, xStride );
+		}
+		#endif
+
+		xFreeBytesRemaining += xStride;
+
+		/* A full page goes back on the list of pages with free objects. */
+		if( pxPage->usFreeObjects == 0 )
+		{
+			pxPage->pxPrevPage = NULL;
+			pxPage->pxNextPage = pxSlabPages[ uxClass ];
+
+			if( pxSlabPages[ uxClass ] != NULL )
+			{
+				pxSlabPages[ uxClass ]->pxPrevPage = pxPage;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxSlabPages[ uxClass ] = pxPage;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxObject->pxNextFreeObject = pxPage->pxFreeObjects;
+		pxPage->pxFreeObjects = pxObject;
+		pxPage->usFreeObjects++;
+
+		/* Release the page once it is empty.  Keeping empty pages would save
+		carving them again, but would leave them scattered through the heap. */
+		if( pxPage->usFreeObjects == pxPage->usObjects )
+		{
+			if( pxPage->pxPrevPage != NULL )
+			{
+				pxPage->pxPrevPage->pxNextPage = pxPage->pxNextPage;
+			}
+			else
+			{
+				pxSlabPages[ uxClass ] = pxPage->pxNextPage;
+			}
+
+			if( pxPage->pxNextPage != NULL )
+			{
+				pxPage->pxNextPage->pxPrevPage = pxPage->pxPrevPage;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxBlock = ( BlockLink_t * ) ( ( ( uint8_t * ) pxPage ) - xHeapStructSize );
+			xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+			prvFreeBlock( pxBlock );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configHEAP_SMALL_OBJECT_SLABS */
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_CALL_SITES == 1 )
+
+	static HeapCallSiteStats_t *prvGetCallSite( void *pvCallSite )
+	{
+	UBaseType_t uxIndex, uxProbe;
+	HeapCallSiteStats_t *pxCallSite = &xOtherCallSites;
+
+		uxIndex = ( UBaseType_t ) ( ( ( size_t ) pvCallSite ) >> 2 ) % configHEAP_CALL_SITE_COUNT;
+
+		for( uxProbe = 0; uxProbe < configHEAP_CALL_SITE_COUNT; uxProbe++ )
+		{
+			if( xCallSites[ uxIndex ].pvCallSite == pvCallSite )
+			{
+				pxCallSite = &xCallSites[ uxIndex ];
+				break;
+			}
+			else if( xCallSites[ uxIndex ].pvCallSite == NULL )
+			{
+				/* Entries are never removed, so the call site is not in the
+				table. */
+				xCallSites[ uxIndex ].pvCallSite = pvCallSite;
+				pxCallSite = &xCallSites[ uxIndex ];
+				break;
+			}
+			else
+			{
+				uxIndex = ( uxIndex + 1 ) % configHEAP_CALL_SITE_COUNT;
+			}
+		}
+
+		return pxCallSite;
+	}
+
+#endif /* configHEAP_TRACK_CALL_SITES */
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_CALL_SITES == 1 )
+
+	static void prvCallSiteAllocated( HeapCallSiteStats_t *pxCallSite, size_t xBytes )
+	{
+		pxCallSite->xNumberOfAllocations++;
+		pxCallSite->xCurrentBytes += xBytes;
+
+		if( pxCallSite->xCurrentBytes > pxCallSite->xPeakBytes )
+		{
+			pxCallSite->xPeakBytes = pxCallSite->xCurrentBytes;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configHEAP_TRACK_CALL_SITES */
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_TRACK_CALL_SITES == 1 )
+
+	static void prvCallSiteFreed( HeapCallSiteStats_t *pxCallSite, size_t xBytes )
+	{
+		configASSERT( pxCallSite != NULL );
+		configASSERT( pxCallSite->xCurrentBytes >= xBytes );
+
+		pxCallSite->xNumberOfFrees++;
+		pxCallSite->xCurrentBytes -= xBytes;
+	}
+
+#endif /* configHEAP_TRACK_CALL_SITES */
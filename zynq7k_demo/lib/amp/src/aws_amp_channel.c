@@ -0,0 +1,358 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Request/reply channel between two FreeRTOS instances
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* AMP includes. */
+#include "aws_amp_channel.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy a message into the transmit ring and ring the doorbell if the
+ * other core is waiting for it.
+ *
+ * Blocks, polling, while the ring is full.
+ */
+static BaseType_t prvSendMessage( AmpChannel_t * pxChannel,
+                                  const AmpMessageHeader_t * pxHeader,
+                                  const void * pvPayload,
+                                  uint32_t ulPayloadLength );
+
+/**
+ * @brief Complete the pending call matching a reply.
+ */
+static void prvCompleteCall( AmpChannel_t * pxChannel,
+                             const AmpMessageHeader_t * pxReply,
+                             const uint8_t * pucPayload,
+                             uint32_t ulPayloadLength );
+
+/**
+ * @brief Drains the receive ring of a channel.
+ */
+static void prvReceiveTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvSendMessage( AmpChannel_t * pxChannel,
+                                  const AmpMessageHeader_t * pxHeader,
+                                  const void * pvPayload,
+                                  uint32_t ulPayloadLength )
+{
+    BaseType_t xStatus = pdPASS;
+    bool bRingDoorbell = false;
+    uint32_t ulMessageLength = sizeof( AmpMessageHeader_t ) + ulPayloadLength;
+    uint8_t * pucMessage = NULL;
+
+    if( ( ulPayloadLength > ampconfigMAX_PAYLOAD ) ||
+        ( ulMessageLength > AMP_RingMaxRecordLength( pxChannel->pxTxRing ) ) )
+    {
+        xStatus = pdFAIL;
+    }
+
+    if( xStatus == pdPASS )
+    {
+        ( void ) xSemaphoreTake( pxChannel->xTxMutex, portMAX_DELAY );
+
+        while( ( pucMessage = AMP_RingReserve( pxChannel->pxTxRing, ulMessageLength ) ) == NULL )
+        {
+            vTaskDelay( ampconfigRING_FULL_RETRY_TICKS );
+        }
+
+        memcpy( pucMessage, pxHeader, sizeof( AmpMessageHeader_t ) );
+
+        if( ulPayloadLength > 0 )
+        {
+            memcpy( pucMessage + sizeof( AmpMessageHeader_t ), pvPayload, ulPayloadLength );
+        }
+
+        bRingDoorbell = AMP_RingCommit( pxChannel->pxTxRing );
+
+        ( void ) xSemaphoreGive( pxChannel->xTxMutex );
+
+        if( bRingDoorbell == true )
+        {
+            pxChannel->xRingDoorbell( pxChannel->pvDoorbellContext );
+        }
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvCompleteCall( AmpChannel_t * pxChannel,
+                             const AmpMessageHeader_t * pxReply,
+                             const uint8_t * pucPayload,
+                             uint32_t ulPayloadLength )
+{
+    AmpPendingCall_t * pxCall = NULL;
+    UBaseType_t uxIndex = 0;
+
+    ( void ) xSemaphoreTake( pxChannel->xPendingMutex, portMAX_DELAY );
+
+    for( uxIndex = 0; uxIndex < ampconfigMAX_PENDING_CALLS; uxIndex++ )
+    {
+        if( ( pxChannel->xPendingCalls[ uxIndex ].xInUse == pdTRUE ) &&
+            ( pxChannel->xPendingCalls[ uxIndex ].ulSequence == pxReply->ulSequence ) )
+        {
+            pxCall = &pxChannel->xPendingCalls[ uxIndex ];
+            break;
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxChannel->xPendingMutex );
+
+    /* A reply that matches no call is dropped. */
+    if( pxCall != NULL )
+    {
+        if( ulPayloadLength > pxCall->ulReplyCapacity )
+        {
+            ulPayloadLength = pxCall->ulReplyCapacity;
+        }
+
+        if( ulPayloadLength > 0 )
+        {
+            memcpy( pxCall->pvReplyPayload, pucPayload, ulPayloadLength );
+        }
+
+        pxCall->ulReplyLength = ulPayloadLength;
+        pxCall->lResult = pxReply->lResult;
+
+        ( void ) xSemaphoreGive( pxCall->xDone );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReceiveTask( void * pvParameters )
+{
+    AmpChannel_t * pxChannel = ( AmpChannel_t * ) pvParameters;
+    AmpMessageHeader_t xHeader;
+    const uint8_t * pucMessage = NULL;
+    uint32_t ulMessageLength = 0;
+
+    for( ; ; )
+    {
+        pucMessage = AMP_RingPeek( pxChannel->pxRxRing, &ulMessageLength );
+
+        if( pucMessage == NULL )
+        {
+            /* Sleep until the doorbell, unless a message slipped in while the
+             * wake request was being made. */
+            if( AMP_RingArmDoorbell( pxChannel->pxRxRing ) == true )
+            {
+                ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+            }
+
+            continue;
+        }
+
+        /* Messages shorter than a header are malformed and skipped. */
+        if( ulMessageLength >= sizeof( AmpMessageHeader_t ) )
+        {
+            /* The header is copied out since records are only 4 byte aligned. */
+            memcpy( &xHeader, pucMessage, sizeof( AmpMessageHeader_t ) );
+
+            if( xHeader.usKind == ampMESSAGE_REPLY )
+            {
+                prvCompleteCall( pxChannel,
+                                 &xHeader,
+                                 pucMessage + sizeof( AmpMessageHeader_t ),
+                                 ulMessageLength - sizeof( AmpMessageHeader_t ) );
+            }
+            else if( ( xHeader.usKind == ampMESSAGE_REQUEST ) &&
+                     ( pxChannel->xRequestHandler != NULL ) )
+            {
+                pxChannel->xRequestHandler( pxChannel,
+                                            &xHeader,
+                                            pucMessage + sizeof( AmpMessageHeader_t ),
+                                            ulMessageLength - sizeof( AmpMessageHeader_t ),
+                                            pxChannel->pvRequestHandlerContext );
+            }
+        }
+
+        AMP_RingRelease( pxChannel->pxRxRing );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_ChannelInit( AmpChannel_t * pxChannel,
+                            AmpRing_t * pxTxRing,
+                            AmpRing_t * pxRxRing,
+                            AmpDoorbellFunction_t xRingDoorbell,
+                            void * pvDoorbellContext,
+                            AmpRequestHandler_t xRequestHandler,
+                            void * pvRequestHandlerContext )
+{
+    BaseType_t xStatus = pdPASS;
+    UBaseType_t uxIndex = 0;
+
+    configASSERT( ( pxTxRing != NULL ) && ( pxRxRing != NULL ) && ( xRingDoorbell != NULL ) );
+
+    memset( pxChannel, 0, sizeof( AmpChannel_t ) );
+    pxChannel->pxTxRing = pxTxRing;
+    pxChannel->pxRxRing = pxRxRing;
+    pxChannel->xRingDoorbell = xRingDoorbell;
+    pxChannel->pvDoorbellContext = pvDoorbellContext;
+    pxChannel->xRequestHandler = xRequestHandler;
+    pxChannel->pvRequestHandlerContext = pvRequestHandlerContext;
+
+    /* The synchronization objects are static and cannot fail. */
+    pxChannel->xTxMutex = xSemaphoreCreateMutexStatic( &pxChannel->xTxMutexBuffer );
+    pxChannel->xPendingMutex = xSemaphoreCreateMutexStatic( &pxChannel->xPendingMutexBuffer );
+    pxChannel->xFreePendingCalls = xSemaphoreCreateCountingStatic( ampconfigMAX_PENDING_CALLS,
+                                                                   ampconfigMAX_PENDING_CALLS,
+                                                                   &pxChannel->xFreePendingCallsBuffer );
+
+    for( uxIndex = 0; uxIndex < ampconfigMAX_PENDING_CALLS; uxIndex++ )
+    {
+        pxChannel->xPendingCalls[ uxIndex ].xDone =
+            xSemaphoreCreateBinaryStatic( &pxChannel->xPendingCalls[ uxIndex ].xDoneBuffer );
+    }
+
+    if( xTaskCreate( prvReceiveTask,
+                     "AmpRx",
+                     ampconfigRECEIVE_TASK_STACK_SIZE,
+                     pxChannel,
+                     ampconfigRECEIVE_TASK_PRIORITY,
+                     &pxChannel->xReceiveTask ) != pdPASS )
+    {
+        xStatus = pdFAIL;
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void AMP_ChannelDoorbellFromISR( AmpChannel_t * pxChannel,
+                                 BaseType_t * pxHigherPriorityTaskWoken )
+{
+    /* The other core may ring before this core has created its task. Records
+     * are not lost: the task checks the ring before it first sleeps. */
+    if( pxChannel->xReceiveTask != NULL )
+    {
+        vTaskNotifyGiveFromISR( pxChannel->xReceiveTask, pxHigherPriorityTaskWoken );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_ChannelCall( AmpChannel_t * pxChannel,
+                            uint16_t usOperation,
+                            const uint32_t * pulArguments,
+                            const void * pvPayload,
+                            uint32_t ulPayloadLength,
+                            void * pvReplyPayload,
+                            uint32_t * pulReplyLength,
+                            int32_t * plResult )
+{
+    BaseType_t xStatus = pdPASS;
+    AmpMessageHeader_t xRequest;
+    AmpPendingCall_t * pxCall = NULL;
+    UBaseType_t uxIndex = 0;
+
+    memset( &xRequest, 0, sizeof( xRequest ) );
+    xRequest.usKind = ampMESSAGE_REQUEST;
+    xRequest.usOperation = usOperation;
+
+    if( pulArguments != NULL )
+    {
+        memcpy( xRequest.ulArguments, pulArguments, sizeof( xRequest.ulArguments ) );
+    }
+
+    /* Claim a pending call entry. The counting semaphore guarantees one is
+     * free once it has been taken. */
+    ( void ) xSemaphoreTake( pxChannel->xFreePendingCalls, portMAX_DELAY );
+    ( void ) xSemaphoreTake( pxChannel->xPendingMutex, portMAX_DELAY );
+
+    for( uxIndex = 0; uxIndex < ampconfigMAX_PENDING_CALLS; uxIndex++ )
+    {
+        if( pxChannel->xPendingCalls[ uxIndex ].xInUse == pdFALSE )
+        {
+            pxCall = &pxChannel->xPendingCalls[ uxIndex ];
+            break;
+        }
+    }
+
+    configASSERT( pxCall != NULL );
+
+    pxCall->xInUse = pdTRUE;
+    pxCall->ulSequence = pxChannel->ulNextSequence++;
+    pxCall->pvReplyPayload = pvReplyPayload;
+    pxCall->ulReplyCapacity = ( pulReplyLength != NULL ) ? *pulReplyLength : 0;
+    pxCall->ulReplyLength = 0;
+    xRequest.ulSequence = pxCall->ulSequence;
+
+    ( void ) xSemaphoreGive( pxChannel->xPendingMutex );
+
+    xStatus = prvSendMessage( pxChannel, &xRequest, pvPayload, ulPayloadLength );
+
+    if( xStatus == pdPASS )
+    {
+        ( void ) xSemaphoreTake( pxCall->xDone, portMAX_DELAY );
+
+        *plResult = pxCall->lResult;
+
+        if( pulReplyLength != NULL )
+        {
+            *pulReplyLength = pxCall->ulReplyLength;
+        }
+    }
+
+    ( void ) xSemaphoreTake( pxChannel->xPendingMutex, portMAX_DELAY );
+    pxCall->xInUse = pdFALSE;
+    ( void ) xSemaphoreGive( pxChannel->xPendingMutex );
+    ( void ) xSemaphoreGive( pxChannel->xFreePendingCalls );
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_ChannelReply( AmpChannel_t * pxChannel,
+                             const AmpMessageHeader_t * pxRequest,
+                             int32_t lResult,
+                             const void * pvPayload,
+                             uint32_t ulPayloadLength )
+{
+    AmpMessageHeader_t xReply;
+
+    memset( &xReply, 0, sizeof( xReply ) );
+    xReply.usKind = ampMESSAGE_REPLY;
+    xReply.usOperation = pxRequest->usOperation;
+    xReply.ulSequence = pxRequest->ulSequence;
+    xReply.lResult = lResult;
+
+    return prvSendMessage( pxChannel, &xReply, pvPayload, ulPayloadLength );
+}
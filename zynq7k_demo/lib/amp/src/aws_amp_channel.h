@@ -0,0 +1,206 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef AWS_AMP_CHANNEL_H /* Guards against multiple inclusion */
+#define AWS_AMP_CHANNEL_H
+
+/**
+ * @file
+ * @brief Request/reply channel between two FreeRTOS instances.
+ *
+ * A channel joins a transmit ring that this core produces into and a receive
+ * ring that the other core produces into. Each core runs one task that drains
+ * its receive ring: replies complete the matching AMP_ChannelCall(), requests
+ * are passed to the channel's request handler. The task sleeps on its task
+ * notification while the ring is empty and is woken by
+ * AMP_ChannelDoorbellFromISR() from the doorbell interrupt.
+ */
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "aws_amp_config.h"
+#include "aws_amp_config_defaults.h"
+#include "aws_amp_ring.h"
+
+/**
+ * @brief Number of scalar arguments carried by every message.
+ */
+#define ampMESSAGE_ARGUMENTS    ( 4 )
+
+/**
+ * @brief Message kinds.
+ */
+#define ampMESSAGE_REQUEST      ( 1 )
+#define ampMESSAGE_REPLY        ( 2 )
+
+/**
+ * @brief Header of every channel message. The payload follows it directly.
+ */
+typedef struct AmpMessageHeader
+{
+    uint16_t usKind;                            /**< ampMESSAGE_REQUEST or ampMESSAGE_REPLY. */
+    uint16_t usOperation;                       /**< Operation requested, copied into the reply. */
+    uint32_t ulSequence;                        /**< Matches a reply to its request. */
+    int32_t lResult;                            /**< Result of the operation, replies only. */
+    uint32_t ulArguments[ ampMESSAGE_ARGUMENTS ]; /**< Operation specific arguments. */
+} AmpMessageHeader_t;
+
+struct AmpChannel;
+
+/**
+ * @brief Rings the doorbell of the other core.
+ */
+typedef void ( * AmpDoorbellFunction_t )( void * pvContext );
+
+/**
+ * @brief Handles a request received on a channel.
+ *
+ * Called from the channel receive task. The request and payload are only
+ * valid until the handler returns; the reply is sent with AMP_ChannelReply(),
+ * from the handler or later.
+ */
+typedef void ( * AmpRequestHandler_t )( struct AmpChannel * pxChannel,
+                                        const AmpMessageHeader_t * pxRequest,
+                                        const uint8_t * pucPayload,
+                                        uint32_t ulPayloadLength,
+                                        void * pvContext );
+
+/**
+ * @brief A call waiting for its reply.
+ */
+typedef struct AmpPendingCall
+{
+    BaseType_t xInUse;               /**< pdTRUE while the call waits for its reply. */
+    uint32_t ulSequence;             /**< Sequence number of the request. */
+    int32_t lResult;                 /**< Result copied from the reply. */
+    void * pvReplyPayload;           /**< Buffer for the reply payload. */
+    uint32_t ulReplyCapacity;        /**< Size of pvReplyPayload. */
+    uint32_t ulReplyLength;          /**< Bytes copied into pvReplyPayload. */
+    SemaphoreHandle_t xDone;         /**< Given by the receive task when the reply arrives. */
+    StaticSemaphore_t xDoneBuffer;   /**< Storage for xDone. */
+} AmpPendingCall_t;
+
+/**
+ * @brief Channel state, owned by one core.
+ */
+typedef struct AmpChannel
+{
+    AmpRing_t * pxTxRing;                                    /**< Ring this core produces into. */
+    AmpRing_t * pxRxRing;                                    /**< Ring this core consumes from. */
+    AmpDoorbellFunction_t xRingDoorbell;                     /**< Wakes the other core. */
+    void * pvDoorbellContext;                                /**< Passed to xRingDoorbell. */
+    AmpRequestHandler_t xRequestHandler;                     /**< Handles requests, may be NULL. */
+    void * pvRequestHandlerContext;                          /**< Passed to xRequestHandler. */
+    TaskHandle_t xReceiveTask;                               /**< Task draining pxRxRing. */
+    SemaphoreHandle_t xTxMutex;                              /**< Serializes producers of pxTxRing. */
+    StaticSemaphore_t xTxMutexBuffer;                        /**< Storage for xTxMutex. */
+    SemaphoreHandle_t xPendingMutex;                         /**< Guards xPendingCalls. */
+    StaticSemaphore_t xPendingMutexBuffer;                   /**< Storage for xPendingMutex. */
+    SemaphoreHandle_t xFreePendingCalls;                     /**< Counts unused xPendingCalls entries. */
+    StaticSemaphore_t xFreePendingCallsBuffer;               /**< Storage for xFreePendingCalls. */
+    uint32_t ulNextSequence;                                 /**< Sequence number of the next request. */
+    AmpPendingCall_t xPendingCalls[ ampconfigMAX_PENDING_CALLS ]; /**< Calls waiting for replies. */
+} AmpChannel_t;
+
+/**
+ * @brief Initialize a channel and start its receive task.
+ *
+ * The rings must already have been initialized with AMP_RingInit(), once, by
+ * one of the cores.
+ *
+ * @param[in] pxChannel Channel to initialize.
+ * @param[in] pxTxRing Ring this core produces into.
+ * @param[in] pxRxRing Ring this core consumes from.
+ * @param[in] xRingDoorbell Function that interrupts the other core.
+ * @param[in] pvDoorbellContext Passed to xRingDoorbell.
+ * @param[in] xRequestHandler Handler for requests from the other core, or NULL
+ * if this core only makes calls.
+ * @param[in] pvRequestHandlerContext Passed to xRequestHandler.
+ *
+ * @return pdPASS if the channel is ready, pdFAIL otherwise.
+ */
+BaseType_t AMP_ChannelInit( AmpChannel_t * pxChannel,
+                            AmpRing_t * pxTxRing,
+                            AmpRing_t * pxRxRing,
+                            AmpDoorbellFunction_t xRingDoorbell,
+                            void * pvDoorbellContext,
+                            AmpRequestHandler_t xRequestHandler,
+                            void * pvRequestHandlerContext );
+
+/**
+ * @brief Wake the receive task. Call from the doorbell interrupt.
+ *
+ * @param[in] pxChannel The channel.
+ * @param[out] pxHigherPriorityTaskWoken Set to pdTRUE if a context switch
+ * should be requested before the interrupt exits.
+ */
+void AMP_ChannelDoorbellFromISR( AmpChannel_t * pxChannel,
+                                 BaseType_t * pxHigherPriorityTaskWoken );
+
+/**
+ * @brief Send a request and block until the other core replies.
+ *
+ * @param[in] pxChannel The channel.
+ * @param[in] usOperation Operation to request.
+ * @param[in] pulArguments ampMESSAGE_ARGUMENTS scalar arguments, or NULL.
+ * @param[in] pvPayload Request payload, or NULL.
+ * @param[in] ulPayloadLength Length of pvPayload.
+ * @param[out] pvReplyPayload Buffer for the reply payload, or NULL.
+ * @param[in,out] pulReplyLength In: size of pvReplyPayload. Out: bytes
+ * copied. May be NULL if pvReplyPayload is NULL.
+ * @param[out] plResult Result of the operation.
+ *
+ * @return pdPASS if a reply was received, pdFAIL if the request is larger than
+ * ampconfigMAX_PAYLOAD or the ring.
+ */
+BaseType_t AMP_ChannelCall( AmpChannel_t * pxChannel,
+                            uint16_t usOperation,
+                            const uint32_t * pulArguments,
+                            const void * pvPayload,
+                            uint32_t ulPayloadLength,
+                            void * pvReplyPayload,
+                            uint32_t * pulReplyLength,
+                            int32_t * plResult );
+
+/**
+ * @brief Reply to a request received by the request handler.
+ *
+ * @param[in] pxChannel The channel.
+ * @param[in] pxRequest Header of the request being answered.
+ * @param[in] lResult Result of the operation.
+ * @param[in] pvPayload Reply payload, or NULL.
+ * @param[in] ulPayloadLength Length of pvPayload.
+ *
+ * @return pdPASS if the reply was queued, pdFAIL if it is too large.
+ */
+BaseType_t AMP_ChannelReply( AmpChannel_t * pxChannel,
+                             const AmpMessageHeader_t * pxRequest,
+                             int32_t lResult,
+                             const void * pvPayload,
+                             uint32_t ulPayloadLength );
+
+#endif /* ifndef AWS_AMP_CHANNEL_H */
@@ -0,0 +1,238 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Lock-free single producer, single consumer record ring
+ */
+
+#include "aws_amp_ring.h"
+#include <string.h>
+
+/*
+ * Ordering primitives. The GCC builtins emit DMB on the Cortex-A9, which is
+ * sufficient between the two cores of the inner shareable domain, and the
+ * matching fences on a host.
+ */
+#ifndef ampRING_LOAD_ACQUIRE
+    #define ampRING_LOAD_ACQUIRE( x )          __atomic_load_n( &( x ), __ATOMIC_ACQUIRE )
+#endif
+
+#ifndef ampRING_STORE_RELEASE
+    #define ampRING_STORE_RELEASE( x, v )      __atomic_store_n( &( x ), ( v ), __ATOMIC_RELEASE )
+#endif
+
+#ifndef ampRING_FULL_BARRIER
+    #define ampRING_FULL_BARRIER()             __atomic_thread_fence( __ATOMIC_SEQ_CST )
+#endif
+
+/** Header value marking the unused space at the end of the data area. */
+#define ampRING_PAD_RECORD                     ( 0xFFFFFFFFUL )
+
+/** Smallest data area accepted by AMP_RingInit(). */
+#define ampRING_MIN_SIZE                       ( 64UL )
+
+/** Bytes used by a record of ulLength payload bytes, header included. */
+#define ampRING_RECORD_SIZE( ulLength ) \
+    ( ( ( uint32_t ) ampRING_RECORD_HEADER_SIZE + ( ulLength ) + 3UL ) & ~3UL )
+
+/*-----------------------------------------------------------*/
+
+AmpRing_t * AMP_RingInit( void * pvMemory,
+                          size_t xMemorySize )
+{
+    AmpRing_t * pxRing = NULL;
+    size_t xDataSize = 0;
+    uint32_t ulSize = ampRING_MIN_SIZE;
+
+    if( ( pvMemory != NULL ) &&
+        ( ( ( uintptr_t ) pvMemory % ampRING_CACHE_LINE_SIZE ) == 0 ) &&
+        ( xMemorySize >= sizeof( AmpRing_t ) + ampRING_MIN_SIZE ) )
+    {
+        xDataSize = xMemorySize - sizeof( AmpRing_t );
+
+        /* Find the largest power of two that fits. */
+        while( ( ( size_t ) ulSize * 2 <= xDataSize ) && ( ulSize < 0x80000000UL ) )
+        {
+            ulSize *= 2;
+        }
+
+        pxRing = ( AmpRing_t * ) pvMemory;
+        memset( pxRing, 0, sizeof( AmpRing_t ) );
+        pxRing->ulSize = ulSize;
+    }
+
+    return pxRing;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t AMP_RingMaxRecordLength( const AmpRing_t * pxRing )
+{
+    /* A record of up to half the ring always fits either before the end of
+     * the data area or at its start, once the consumer has caught up. */
+    return ( pxRing->ulSize / 2 ) - ( uint32_t ) ampRING_RECORD_HEADER_SIZE;
+}
+
+/*-----------------------------------------------------------*/
+
+void * AMP_RingReserve( AmpRing_t * pxRing,
+                        uint32_t ulLength )
+{
+    void * pvRecord = NULL;
+    uint32_t ulHead = pxRing->ulProducerHead;
+    uint32_t ulTail = ampRING_LOAD_ACQUIRE( pxRing->ulConsumerTail );
+    uint32_t ulRecordSize = ampRING_RECORD_SIZE( ulLength );
+    uint32_t ulOffset = ulHead & ( pxRing->ulSize - 1 );
+    uint32_t ulToEnd = pxRing->ulSize - ulOffset;
+    uint32_t ulFree = pxRing->ulSize - ( ulHead - ulTail );
+    uint32_t ulNeeded = ulRecordSize;
+    uint32_t ulStart = ulOffset;
+
+    if( ulLength <= AMP_RingMaxRecordLength( pxRing ) )
+    {
+        /* Records never wrap. Skip the rest of the data area if the record
+         * does not fit before its end. */
+        if( ulRecordSize > ulToEnd )
+        {
+            ulNeeded = ulToEnd + ulRecordSize;
+            ulStart = 0;
+        }
+
+        if( ulNeeded <= ulFree )
+        {
+            if( ulStart != ulOffset )
+            {
+                *( uint32_t * ) &pxRing->ucData[ ulOffset ] = ampRING_PAD_RECORD;
+            }
+
+            *( uint32_t * ) &pxRing->ucData[ ulStart ] = ulLength;
+            pxRing->ulProducerReserved = ulHead + ulNeeded;
+            pvRecord = &pxRing->ucData[ ulStart + ampRING_RECORD_HEADER_SIZE ];
+        }
+    }
+
+    return pvRecord;
+}
+
+/*-----------------------------------------------------------*/
+
+bool AMP_RingCommit( AmpRing_t * pxRing )
+{
+    bool bRingDoorbell = false;
+    uint32_t ulWakeRequest = 0;
+
+    /* Publish the record, then check whether the consumer went to sleep. The
+     * full barrier pairs with the one in AMP_RingArmDoorbell() so that either
+     * the producer sees the wake request or the consumer sees the record. */
+    ampRING_STORE_RELEASE( pxRing->ulProducerHead, pxRing->ulProducerReserved );
+    ampRING_FULL_BARRIER();
+    ulWakeRequest = ampRING_LOAD_ACQUIRE( pxRing->ulConsumerWakeRequest );
+
+    if( ulWakeRequest != pxRing->ulProducerWakeAck )
+    {
+        pxRing->ulProducerWakeAck = ulWakeRequest;
+        bRingDoorbell = true;
+    }
+
+    return bRingDoorbell;
+}
+
+/*-----------------------------------------------------------*/
+
+bool AMP_RingSend( AmpRing_t * pxRing,
+                   const void * pvData,
+                   uint32_t ulLength,
+                   bool * pbRingDoorbell )
+{
+    bool bSent = false;
+    void * pvRecord = AMP_RingReserve( pxRing, ulLength );
+
+    *pbRingDoorbell = false;
+
+    if( pvRecord != NULL )
+    {
+        memcpy( pvRecord, pvData, ulLength );
+        *pbRingDoorbell = AMP_RingCommit( pxRing );
+        bSent = true;
+    }
+
+    return bSent;
+}
+
+/*-----------------------------------------------------------*/
+
+const void * AMP_RingPeek( AmpRing_t * pxRing,
+                           uint32_t * pulLength )
+{
+    const void * pvRecord = NULL;
+    uint32_t ulTail = pxRing->ulConsumerTail;
+    uint32_t ulHead = ampRING_LOAD_ACQUIRE( pxRing->ulProducerHead );
+    uint32_t ulOffset = 0;
+    uint32_t ulHeader = 0;
+
+    while( ( pvRecord == NULL ) && ( ulTail != ulHead ) )
+    {
+        ulOffset = ulTail & ( pxRing->ulSize - 1 );
+        ulHeader = *( const uint32_t * ) &pxRing->ucData[ ulOffset ];
+
+        if( ulHeader == ampRING_PAD_RECORD )
+        {
+            /* Skip to the start of the data area. */
+            ulTail += pxRing->ulSize - ulOffset;
+            ampRING_STORE_RELEASE( pxRing->ulConsumerTail, ulTail );
+        }
+        else
+        {
+            *pulLength = ulHeader;
+            pxRing->ulConsumerPeeked = ulTail + ampRING_RECORD_SIZE( ulHeader );
+            pvRecord = &pxRing->ucData[ ulOffset + ampRING_RECORD_HEADER_SIZE ];
+        }
+    }
+
+    return pvRecord;
+}
+
+/*-----------------------------------------------------------*/
+
+void AMP_RingRelease( AmpRing_t * pxRing )
+{
+    /* The release orders the consumer's reads of the record before the
+     * producer can reuse its space. */
+    ampRING_STORE_RELEASE( pxRing->ulConsumerTail, pxRing->ulConsumerPeeked );
+}
+
+/*-----------------------------------------------------------*/
+
+bool AMP_RingArmDoorbell( AmpRing_t * pxRing )
+{
+    uint32_t ulHead = 0;
+
+    ampRING_STORE_RELEASE( pxRing->ulConsumerWakeRequest, pxRing->ulConsumerWakeRequest + 1 );
+    ampRING_FULL_BARRIER();
+    ulHead = ampRING_LOAD_ACQUIRE( pxRing->ulProducerHead );
+
+    return ulHead == pxRing->ulConsumerTail;
+}
@@ -0,0 +1,185 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef AWS_AMP_RING_H /* Guards against multiple inclusion */
+#define AWS_AMP_RING_H
+
+/**
+ * @file
+ * @brief Lock-free single producer, single consumer record ring shared
+ * between two cores.
+ *
+ * The ring lives in memory visible to both cores. One core only ever
+ * produces into it and the other only ever consumes from it, so every shared
+ * index has exactly one writer and no read-modify-write instructions are
+ * needed. Records are variable length and always contiguous, so both sides
+ * can work on them in place.
+ *
+ * The ring does not know how the other core is woken. Instead,
+ * AMP_RingCommit() tells the producer when the consumer has asked to be woken
+ * and a doorbell (an SGI on the Zynq, a condition variable in the host tests)
+ * must be rung.
+ *
+ * This file has no FreeRTOS dependencies so that it can be tested on a host.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Size of a cache line. The producer and consumer indexes are kept on
+ * separate lines so that the two cores never write to the same line.
+ */
+#ifndef ampRING_CACHE_LINE_SIZE
+    #define ampRING_CACHE_LINE_SIZE    ( 32 )
+#endif
+
+/**
+ * @brief Size of the header in front of every record.
+ */
+#define ampRING_RECORD_HEADER_SIZE    ( sizeof( uint32_t ) )
+
+/**
+ * @brief Shared ring control block, followed by the ring data.
+ *
+ * Fields prefixed with ulProducer are only written by the producer and fields
+ * prefixed with ulConsumer only by the consumer.
+ */
+typedef struct AmpRing
+{
+    /* Producer cache line. */
+    volatile uint32_t ulProducerHead;   /**< Free-running offset of the end of the last committed record. */
+    volatile uint32_t ulProducerWakeAck; /**< Last ulConsumerWakeRequest value answered with a doorbell. */
+    uint32_t ulProducerReserved;         /**< Free-running offset the head moves to on commit. */
+    uint32_t ulSize;                     /**< Size of the data area in bytes, a power of two. Written once at init. */
+    uint8_t ucProducerPad[ ampRING_CACHE_LINE_SIZE - 4 * sizeof( uint32_t ) ];
+
+    /* Consumer cache line. */
+    volatile uint32_t ulConsumerTail;        /**< Free-running offset of the oldest unreleased record. */
+    volatile uint32_t ulConsumerWakeRequest; /**< Incremented each time the consumer is about to sleep. */
+    uint32_t ulConsumerPeeked;               /**< Free-running offset the tail moves to on release. */
+    uint8_t ucConsumerPad[ ampRING_CACHE_LINE_SIZE - 3 * sizeof( uint32_t ) ];
+
+    uint8_t ucData[]; /**< Record storage. */
+} AmpRing_t;
+
+/**
+ * @brief Initialize a ring in xMemorySize bytes of shared memory.
+ *
+ * Must be called once, before either core uses the ring. The data area is the
+ * largest power of two that fits after the control block.
+ *
+ * @param[in] pvMemory Shared memory, aligned to ampRING_CACHE_LINE_SIZE.
+ * @param[in] xMemorySize Bytes available at pvMemory.
+ *
+ * @return The ring, or NULL if xMemorySize is too small.
+ */
+AmpRing_t * AMP_RingInit( void * pvMemory,
+                          size_t xMemorySize );
+
+/**
+ * @brief Largest record payload the ring will always be able to accept.
+ *
+ * @param[in] pxRing The ring.
+ *
+ * @return Maximum length that can be passed to AMP_RingReserve().
+ */
+uint32_t AMP_RingMaxRecordLength( const AmpRing_t * pxRing );
+
+/**
+ * @brief Reserve space for a record of ulLength bytes. Producer only.
+ *
+ * The record is not visible to the consumer until AMP_RingCommit() is called.
+ * Reserving again before committing discards the previous reservation.
+ *
+ * @param[in] pxRing The ring.
+ * @param[in] ulLength Payload length in bytes.
+ *
+ * @return Pointer to ulLength writable bytes, or NULL if the ring is full or
+ * ulLength is larger than AMP_RingMaxRecordLength().
+ */
+void * AMP_RingReserve( AmpRing_t * pxRing,
+                        uint32_t ulLength );
+
+/**
+ * @brief Publish the reserved record. Producer only.
+ *
+ * @param[in] pxRing The ring.
+ *
+ * @return true if the consumer asked to be woken and the doorbell must be
+ * rung; false otherwise.
+ */
+bool AMP_RingCommit( AmpRing_t * pxRing );
+
+/**
+ * @brief Copy a record into the ring. Producer only.
+ *
+ * @param[in] pxRing The ring.
+ * @param[in] pvData Record payload.
+ * @param[in] ulLength Payload length in bytes.
+ * @param[out] pbRingDoorbell Set to the AMP_RingCommit() result.
+ *
+ * @return true if the record was queued; false if the ring is full.
+ */
+bool AMP_RingSend( AmpRing_t * pxRing,
+                   const void * pvData,
+                   uint32_t ulLength,
+                   bool * pbRingDoorbell );
+
+/**
+ * @brief Return the oldest record without removing it. Consumer only.
+ *
+ * @param[in] pxRing The ring.
+ * @param[out] pulLength Payload length of the record.
+ *
+ * @return Pointer to the record payload, or NULL if the ring is empty.
+ */
+const void * AMP_RingPeek( AmpRing_t * pxRing,
+                           uint32_t * pulLength );
+
+/**
+ * @brief Remove the record returned by the last AMP_RingPeek(). Consumer only.
+ *
+ * @param[in] pxRing The ring.
+ */
+void AMP_RingRelease( AmpRing_t * pxRing );
+
+/**
+ * @brief Ask the producer to ring the doorbell on its next commit. Consumer
+ * only.
+ *
+ * Call this when AMP_RingPeek() returned NULL and before sleeping. If it
+ * returns false a record arrived in the meantime and the consumer must not
+ * sleep, since the producer may have seen the request too late.
+ *
+ * @param[in] pxRing The ring.
+ *
+ * @return true if the ring is still empty and the consumer may sleep until the
+ * doorbell; false if records are waiting.
+ */
+bool AMP_RingArmDoorbell( AmpRing_t * pxRing );
+
+#endif /* ifndef AWS_AMP_RING_H */
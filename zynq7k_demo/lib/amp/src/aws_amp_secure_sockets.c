@@ -0,0 +1,359 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Secure sockets port that forwards every call to the network core
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+
+/* AMP includes. */
+#include "aws_amp_sockets.h"
+
+/* Secure sockets includes. */
+#include "aws_secure_sockets.h"
+
+/**
+ * @brief Room for the flattened ALPN protocol list.
+ */
+#define ampSOCKETS_ALPN_BUFFER_SIZE    ( 64 )
+
+/**
+ * @brief Channel to the network core.
+ */
+static AmpChannel_t * pxSocketsChannel = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Forward one call and map a channel failure to a sockets error.
+ */
+static int32_t prvCall( uint16_t usOperation,
+                        uint32_t ulArgument0,
+                        uint32_t ulArgument1,
+                        uint32_t ulArgument2,
+                        uint32_t ulArgument3,
+                        const void * pvPayload,
+                        uint32_t ulPayloadLength,
+                        void * pvReplyPayload,
+                        uint32_t * pulReplyLength );
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvCall( uint16_t usOperation,
+                        uint32_t ulArgument0,
+                        uint32_t ulArgument1,
+                        uint32_t ulArgument2,
+                        uint32_t ulArgument3,
+                        const void * pvPayload,
+                        uint32_t ulPayloadLength,
+                        void * pvReplyPayload,
+                        uint32_t * pulReplyLength )
+{
+    int32_t lResult = SOCKETS_SOCKET_ERROR;
+    uint32_t ulArguments[ ampMESSAGE_ARGUMENTS ];
+
+    configASSERT( pxSocketsChannel != NULL );
+
+    ulArguments[ 0 ] = ulArgument0;
+    ulArguments[ 1 ] = ulArgument1;
+    ulArguments[ 2 ] = ulArgument2;
+    ulArguments[ 3 ] = ulArgument3;
+
+    if( AMP_ChannelCall( pxSocketsChannel,
+                         usOperation,
+                         ulArguments,
+                         pvPayload,
+                         ulPayloadLength,
+                         pvReplyPayload,
+                         pulReplyLength,
+                         &lResult ) != pdPASS )
+    {
+        lResult = SOCKETS_SOCKET_ERROR;
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void AMP_SOCKETS_ClientInit( AmpChannel_t * pxChannel )
+{
+    pxSocketsChannel = pxChannel;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t SOCKETS_Init( void )
+{
+    /* The network core initializes its own secure sockets. */
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+Socket_t SOCKETS_Socket( int32_t lDomain,
+                         int32_t lType,
+                         int32_t lProtocol )
+{
+    int32_t lResult = prvCall( eAmpSocketsSocket,
+                               ( uint32_t ) lDomain,
+                               ( uint32_t ) lType,
+                               ( uint32_t ) lProtocol,
+                               0,
+                               NULL, 0, NULL, NULL );
+
+    /* A transport failure is reported as an invalid socket. */
+    if( lResult == SOCKETS_SOCKET_ERROR )
+    {
+        lResult = ( int32_t ) ( uintptr_t ) SOCKETS_INVALID_SOCKET;
+    }
+
+    return ( Socket_t ) ( uintptr_t ) lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Connect( Socket_t xSocket,
+                         SocketsSockaddr_t * pxAddress,
+                         Socklen_t xAddressLength )
+{
+    int32_t lResult = SOCKETS_EINVAL;
+
+    if( pxAddress != NULL )
+    {
+        lResult = prvCall( eAmpSocketsConnect,
+                           ( uint32_t ) ( uintptr_t ) xSocket,
+                           ( uint32_t ) xAddressLength,
+                           0,
+                           0,
+                           pxAddress, sizeof( SocketsSockaddr_t ), NULL, NULL );
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Recv( Socket_t xSocket,
+                      void * pvBuffer,
+                      size_t xBufferLength,
+                      uint32_t ulFlags )
+{
+    uint32_t ulReplyLength = ( uint32_t ) xBufferLength;
+
+    /* A single call returns at most one message worth of data, which
+     * SOCKETS_Recv() callers already handle as a short read. */
+    if( ulReplyLength > ampconfigMAX_PAYLOAD )
+    {
+        ulReplyLength = ampconfigMAX_PAYLOAD;
+    }
+
+    return prvCall( eAmpSocketsRecv,
+                    ( uint32_t ) ( uintptr_t ) xSocket,
+                    ulReplyLength,
+                    ulFlags,
+                    0,
+                    NULL, 0, pvBuffer, &ulReplyLength );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Send( Socket_t xSocket,
+                      const void * pvBuffer,
+                      size_t xDataLength,
+                      uint32_t ulFlags )
+{
+    const uint8_t * pucData = ( const uint8_t * ) pvBuffer;
+    size_t xSent = 0;
+    uint32_t ulChunk = 0;
+    int32_t lResult = 0;
+
+    /* Send in message sized chunks, stopping at the first short send. */
+    do
+    {
+        ulChunk = ( uint32_t ) ( xDataLength - xSent );
+
+        if( ulChunk > ampconfigMAX_PAYLOAD )
+        {
+            ulChunk = ampconfigMAX_PAYLOAD;
+        }
+
+        lResult = prvCall( eAmpSocketsSend,
+                           ( uint32_t ) ( uintptr_t ) xSocket,
+                           ulFlags,
+                           0,
+                           0,
+                           &pucData[ xSent ], ulChunk, NULL, NULL );
+
+        if( lResult > 0 )
+        {
+            xSent += ( size_t ) lResult;
+        }
+    } while( ( lResult == ( int32_t ) ulChunk ) && ( xSent < xDataLength ) );
+
+    if( xSent > 0 )
+    {
+        lResult = ( int32_t ) xSent;
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Shutdown( Socket_t xSocket,
+                          uint32_t ulHow )
+{
+    return prvCall( eAmpSocketsShutdown,
+                    ( uint32_t ) ( uintptr_t ) xSocket,
+                    ulHow,
+                    0,
+                    0,
+                    NULL, 0, NULL, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Close( Socket_t xSocket )
+{
+    return prvCall( eAmpSocketsClose,
+                    ( uint32_t ) ( uintptr_t ) xSocket,
+                    0,
+                    0,
+                    0,
+                    NULL, 0, NULL, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
+                            int32_t lLevel,
+                            int32_t lOptionName,
+                            const void * pvOptionValue,
+                            size_t xOptionLength )
+{
+    char cProtocols[ ampSOCKETS_ALPN_BUFFER_SIZE ];
+    const char ** ppcProtocols = NULL;
+    const void * pvPayload = pvOptionValue;
+    uint32_t ulPayloadLength = ( uint32_t ) xOptionLength;
+    uint32_t ulProtocolLength = 0;
+    size_t xProtocol = 0;
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+
+    switch( lOptionName )
+    {
+        case SOCKETS_SO_RCVTIMEO:
+        case SOCKETS_SO_SNDTIMEO:
+
+            /* The value is a TickType_t regardless of xOptionLength. */
+            ulPayloadLength = sizeof( TickType_t );
+            break;
+
+        case SOCKETS_SO_ALPN_PROTOCOLS:
+
+            /* Flatten the array into consecutive null-terminated strings. */
+            ppcProtocols = ( const char ** ) pvOptionValue;
+            ulPayloadLength = 0;
+
+            for( xProtocol = 0; ( xProtocol < xOptionLength ) && ( lStatus == SOCKETS_ERROR_NONE ); xProtocol++ )
+            {
+                ulProtocolLength = ( uint32_t ) strlen( ppcProtocols[ xProtocol ] ) + 1;
+
+                if( ulPayloadLength + ulProtocolLength > sizeof( cProtocols ) )
+                {
+                    lStatus = SOCKETS_EINVAL;
+                }
+                else
+                {
+                    memcpy( &cProtocols[ ulPayloadLength ], ppcProtocols[ xProtocol ], ulProtocolLength );
+                    ulPayloadLength += ulProtocolLength;
+                }
+            }
+
+            pvPayload = cProtocols;
+            break;
+
+        case SOCKETS_SO_WAKEUP_CALLBACK:
+
+            /* The callback would have to run on the network core. */
+            lStatus = SOCKETS_ENOPROTOOPT;
+            break;
+
+        default:
+
+            /* Options such as SOCKETS_SO_NONBLOCK carry no value. */
+            if( pvOptionValue == NULL )
+            {
+                ulPayloadLength = 0;
+            }
+
+            break;
+    }
+
+    if( lStatus == SOCKETS_ERROR_NONE )
+    {
+        if( ulPayloadLength > ampconfigMAX_PAYLOAD )
+        {
+            lStatus = SOCKETS_EINVAL;
+        }
+        else
+        {
+            lStatus = prvCall( eAmpSocketsSetSockOpt,
+                               ( uint32_t ) ( uintptr_t ) xSocket,
+                               ( uint32_t ) lLevel,
+                               ( uint32_t ) lOptionName,
+                               ( uint32_t ) xOptionLength,
+                               pvPayload, ulPayloadLength, NULL, NULL );
+        }
+    }
+
+    return lStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t SOCKETS_GetHostByName( const char * pcHostName )
+{
+    int32_t lResult = prvCall( eAmpSocketsGetHostByName,
+                               0,
+                               0,
+                               0,
+                               0,
+                               pcHostName, ( uint32_t ) strlen( pcHostName ) + 1, NULL, NULL );
+
+    /* Zero is the documented failure value. */
+    if( lResult == SOCKETS_SOCKET_ERROR )
+    {
+        lResult = 0;
+    }
+
+    return ( uint32_t ) lResult;
+}
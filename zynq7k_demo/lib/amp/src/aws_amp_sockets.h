@@ -0,0 +1,92 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef AWS_AMP_SOCKETS_H /* Guards against multiple inclusion */
+#define AWS_AMP_SOCKETS_H
+
+/**
+ * @file
+ * @brief Secure sockets proxied to the other core.
+ *
+ * The network core runs FreeRTOS+TCP, the secure sockets port and TLS, and
+ * serves socket calls from an AMP channel with AMP_SOCKETS_ServerInit(). The
+ * application core links aws_amp_secure_sockets.c instead of a secure sockets
+ * port: it implements the SOCKETS_* API of aws_secure_sockets.h by forwarding
+ * each call over the channel given to AMP_SOCKETS_ClientInit(), so libraries
+ * such as the MQTT agent run unchanged.
+ *
+ * Socket_t values are the network core's handles and are only meaningful
+ * there. Both cores must use the same tick rate, since socket timeouts are
+ * forwarded in ticks.
+ */
+
+#include "aws_amp_channel.h"
+
+/**
+ * @brief Channel operations used by the sockets proxy.
+ */
+typedef enum AmpSocketsOperation
+{
+    eAmpSocketsSocket = 1,  /**< args: domain, type, protocol. */
+    eAmpSocketsConnect,     /**< args: socket, address length. payload: SocketsSockaddr_t. */
+    eAmpSocketsSend,        /**< args: socket, flags. payload: data. */
+    eAmpSocketsRecv,        /**< args: socket, length, flags. reply payload: data. */
+    eAmpSocketsShutdown,    /**< args: socket, how. */
+    eAmpSocketsClose,       /**< args: socket. */
+    eAmpSocketsSetSockOpt,  /**< args: socket, level, option, option length. payload: option value. */
+    eAmpSocketsGetHostByName /**< payload: null-terminated host name. */
+} AmpSocketsOperation_t;
+
+/**
+ * @brief Route the SOCKETS_* API of this core over pxChannel.
+ *
+ * Must be called before SOCKETS_Init().
+ *
+ * @param[in] pxChannel Channel to the network core.
+ */
+void AMP_SOCKETS_ClientInit( AmpChannel_t * pxChannel );
+
+/**
+ * @brief Start the workers that serve proxied socket calls.
+ *
+ * AMP_SOCKETS_ServerHandleRequest() must be installed as the request handler
+ * of the channel to the application core.
+ *
+ * @return pdPASS if the workers were created, pdFAIL otherwise.
+ */
+BaseType_t AMP_SOCKETS_ServerInit( void );
+
+/**
+ * @brief AmpRequestHandler_t that queues a socket call for a worker.
+ *
+ * Blocks while every worker is busy.
+ */
+void AMP_SOCKETS_ServerHandleRequest( AmpChannel_t * pxChannel,
+                                      const AmpMessageHeader_t * pxRequest,
+                                      const uint8_t * pucPayload,
+                                      uint32_t ulPayloadLength,
+                                      void * pvContext );
+
+#endif /* ifndef AWS_AMP_SOCKETS_H */
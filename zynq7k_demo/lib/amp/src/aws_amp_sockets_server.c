@@ -0,0 +1,354 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Serves socket calls proxied from the application core
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+/* AMP includes. */
+#include "aws_amp_sockets.h"
+
+/* Secure sockets includes. */
+#include "aws_secure_sockets.h"
+
+/**
+ * @brief A socket call waiting for or being served by a worker.
+ */
+typedef struct AmpSocketsJob
+{
+    AmpChannel_t * pxChannel;                        /**< Channel the reply is sent on. */
+    AmpMessageHeader_t xRequest;                     /**< Copy of the request header. */
+    uint32_t ulPayloadLength;                        /**< Bytes of request payload in ucPayload. */
+    uint8_t ucPayload[ ampconfigMAX_PAYLOAD + 1 ];   /**< Request payload, then reply payload. The extra byte terminates strings. */
+} AmpSocketsJob_t;
+
+/**
+ * @brief Jobs, one per worker.
+ */
+static AmpSocketsJob_t xJobs[ ampconfigSOCKETS_SERVER_WORKERS ];
+
+/**
+ * @brief Queues of pointers to unused jobs and to jobs waiting for a worker.
+ */
+static QueueHandle_t xFreeJobs = NULL;
+static QueueHandle_t xReadyJobs = NULL;
+static StaticQueue_t xFreeJobsBuffer;
+static StaticQueue_t xReadyJobsBuffer;
+static uint8_t ucFreeJobsStorage[ ampconfigSOCKETS_SERVER_WORKERS * sizeof( AmpSocketsJob_t * ) ];
+static uint8_t ucReadyJobsStorage[ ampconfigSOCKETS_SERVER_WORKERS * sizeof( AmpSocketsJob_t * ) ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run the SOCKETS_SetSockOpt() call described by a job.
+ */
+static int32_t prvSetSockOpt( AmpSocketsJob_t * pxJob );
+
+/**
+ * @brief Run the socket call described by a job.
+ *
+ * @param[in] pxJob The job.
+ * @param[out] pulReplyLength Bytes of reply payload left in pxJob->ucPayload.
+ *
+ * @return The result to send back.
+ */
+static int32_t prvRunJob( AmpSocketsJob_t * pxJob,
+                          uint32_t * pulReplyLength );
+
+/**
+ * @brief Serves jobs until the end of time.
+ */
+static void prvWorkerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvSetSockOpt( AmpSocketsJob_t * pxJob )
+{
+    Socket_t xSocket = ( Socket_t ) ( uintptr_t ) pxJob->xRequest.ulArguments[ 0 ];
+    int32_t lLevel = ( int32_t ) pxJob->xRequest.ulArguments[ 1 ];
+    int32_t lOptionName = ( int32_t ) pxJob->xRequest.ulArguments[ 2 ];
+    size_t xOptionLength = ( size_t ) pxJob->xRequest.ulArguments[ 3 ];
+    const void * pvOptionValue = NULL;
+    char * pcProtocols[ ampconfigSOCKETS_MAX_ALPN_PROTOCOLS ];
+    char * pcNext = ( char * ) pxJob->ucPayload;
+    TickType_t xTimeout = 0;
+    size_t xProtocol = 0;
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+
+    if( pxJob->ulPayloadLength > 0 )
+    {
+        pvOptionValue = pxJob->ucPayload;
+    }
+
+    switch( lOptionName )
+    {
+        case SOCKETS_SO_RCVTIMEO:
+        case SOCKETS_SO_SNDTIMEO:
+        {
+            /* The payload is not aligned for a TickType_t. */
+            if( pxJob->ulPayloadLength == sizeof( TickType_t ) )
+            {
+                memcpy( &xTimeout, pxJob->ucPayload, sizeof( TickType_t ) );
+                pvOptionValue = &xTimeout;
+            }
+            else
+            {
+                lStatus = SOCKETS_EINVAL;
+            }
+
+            break;
+        }
+
+        case SOCKETS_SO_ALPN_PROTOCOLS:
+        {
+            /* The protocols arrive as consecutive null-terminated strings. */
+            if( xOptionLength > ampconfigSOCKETS_MAX_ALPN_PROTOCOLS )
+            {
+                lStatus = SOCKETS_EINVAL;
+            }
+
+            for( xProtocol = 0; ( xProtocol < xOptionLength ) && ( lStatus == SOCKETS_ERROR_NONE ); xProtocol++ )
+            {
+                if( pcNext >= ( char * ) &pxJob->ucPayload[ pxJob->ulPayloadLength ] )
+                {
+                    lStatus = SOCKETS_EINVAL;
+                }
+                else
+                {
+                    pcProtocols[ xProtocol ] = pcNext;
+                    pcNext += strlen( pcNext ) + 1;
+                }
+            }
+
+            pvOptionValue = pcProtocols;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if( lStatus == SOCKETS_ERROR_NONE )
+    {
+        lStatus = SOCKETS_SetSockOpt( xSocket, lLevel, lOptionName, pvOptionValue, xOptionLength );
+    }
+
+    return lStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+static int32_t prvRunJob( AmpSocketsJob_t * pxJob,
+                          uint32_t * pulReplyLength )
+{
+    const uint32_t * pulArguments = pxJob->xRequest.ulArguments;
+    Socket_t xSocket = ( Socket_t ) ( uintptr_t ) pulArguments[ 0 ];
+    SocketsSockaddr_t xAddress;
+    uint32_t ulLength = 0;
+    int32_t lResult = SOCKETS_EINVAL;
+
+    *pulReplyLength = 0;
+
+    /* Strings in the payload are always terminated. */
+    pxJob->ucPayload[ pxJob->ulPayloadLength ] = '\0';
+
+    switch( pxJob->xRequest.usOperation )
+    {
+        case eAmpSocketsSocket:
+        {
+            lResult = ( int32_t ) ( uintptr_t ) SOCKETS_Socket( ( int32_t ) pulArguments[ 0 ],
+                                                                ( int32_t ) pulArguments[ 1 ],
+                                                                ( int32_t ) pulArguments[ 2 ] );
+            break;
+        }
+
+        case eAmpSocketsConnect:
+        {
+            if( pxJob->ulPayloadLength == sizeof( SocketsSockaddr_t ) )
+            {
+                memcpy( &xAddress, pxJob->ucPayload, sizeof( xAddress ) );
+                lResult = SOCKETS_Connect( xSocket, &xAddress, ( Socklen_t ) pulArguments[ 1 ] );
+            }
+
+            break;
+        }
+
+        case eAmpSocketsSend:
+        {
+            lResult = SOCKETS_Send( xSocket,
+                                    pxJob->ucPayload,
+                                    pxJob->ulPayloadLength,
+                                    pulArguments[ 1 ] );
+            break;
+        }
+
+        case eAmpSocketsRecv:
+        {
+            ulLength = pulArguments[ 1 ];
+
+            if( ulLength > ampconfigMAX_PAYLOAD )
+            {
+                ulLength = ampconfigMAX_PAYLOAD;
+            }
+
+            lResult = SOCKETS_Recv( xSocket, pxJob->ucPayload, ulLength, pulArguments[ 2 ] );
+
+            if( lResult > 0 )
+            {
+                *pulReplyLength = ( uint32_t ) lResult;
+            }
+
+            break;
+        }
+
+        case eAmpSocketsShutdown:
+        {
+            lResult = SOCKETS_Shutdown( xSocket, pulArguments[ 1 ] );
+            break;
+        }
+
+        case eAmpSocketsClose:
+        {
+            lResult = SOCKETS_Close( xSocket );
+            break;
+        }
+
+        case eAmpSocketsSetSockOpt:
+        {
+            lResult = prvSetSockOpt( pxJob );
+            break;
+        }
+
+        case eAmpSocketsGetHostByName:
+        {
+            lResult = ( int32_t ) SOCKETS_GetHostByName( ( const char * ) pxJob->ucPayload );
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return lResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvWorkerTask( void * pvParameters )
+{
+    AmpSocketsJob_t * pxJob = NULL;
+    uint32_t ulReplyLength = 0;
+    int32_t lResult = 0;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) xQueueReceive( xReadyJobs, &pxJob, portMAX_DELAY );
+
+        lResult = prvRunJob( pxJob, &ulReplyLength );
+
+        ( void ) AMP_ChannelReply( pxJob->pxChannel,
+                                   &pxJob->xRequest,
+                                   lResult,
+                                   pxJob->ucPayload,
+                                   ulReplyLength );
+
+        ( void ) xQueueSend( xFreeJobs, &pxJob, portMAX_DELAY );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t AMP_SOCKETS_ServerInit( void )
+{
+    BaseType_t xStatus = pdPASS;
+    AmpSocketsJob_t * pxJob = NULL;
+    UBaseType_t uxWorker = 0;
+
+    xFreeJobs = xQueueCreateStatic( ampconfigSOCKETS_SERVER_WORKERS,
+                                    sizeof( AmpSocketsJob_t * ),
+                                    ucFreeJobsStorage,
+                                    &xFreeJobsBuffer );
+    xReadyJobs = xQueueCreateStatic( ampconfigSOCKETS_SERVER_WORKERS,
+                                     sizeof( AmpSocketsJob_t * ),
+                                     ucReadyJobsStorage,
+                                     &xReadyJobsBuffer );
+
+    for( uxWorker = 0; ( uxWorker < ampconfigSOCKETS_SERVER_WORKERS ) && ( xStatus == pdPASS ); uxWorker++ )
+    {
+        pxJob = &xJobs[ uxWorker ];
+        ( void ) xQueueSend( xFreeJobs, &pxJob, 0 );
+
+        xStatus = xTaskCreate( prvWorkerTask,
+                               "AmpSock",
+                               ampconfigSOCKETS_WORKER_STACK_SIZE,
+                               NULL,
+                               ampconfigSOCKETS_WORKER_PRIORITY,
+                               NULL );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+void AMP_SOCKETS_ServerHandleRequest( AmpChannel_t * pxChannel,
+                                      const AmpMessageHeader_t * pxRequest,
+                                      const uint8_t * pucPayload,
+                                      uint32_t ulPayloadLength,
+                                      void * pvContext )
+{
+    AmpSocketsJob_t * pxJob = NULL;
+
+    ( void ) pvContext;
+
+    if( ulPayloadLength > ampconfigMAX_PAYLOAD )
+    {
+        ( void ) AMP_ChannelReply( pxChannel, pxRequest, SOCKETS_EINVAL, NULL, 0 );
+    }
+    else
+    {
+        /* Copy the request out of the ring so that the ring space is freed
+         * while the call runs. */
+        ( void ) xQueueReceive( xFreeJobs, &pxJob, portMAX_DELAY );
+
+        pxJob->pxChannel = pxChannel;
+        pxJob->xRequest = *pxRequest;
+        pxJob->ulPayloadLength = ulPayloadLength;
+        memcpy( pxJob->ucPayload, pucPayload, ulPayloadLength );
+
+        ( void ) xQueueSend( xReadyJobs, &pxJob, portMAX_DELAY );
+    }
+}
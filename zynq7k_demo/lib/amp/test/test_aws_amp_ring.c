@@ -0,0 +1,240 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+#include "aws_amp_ring.h"
+#include "unity_fixture.h"
+#include <string.h>
+
+#define TEST_RING_MEMORY_SIZE    ( sizeof( AmpRing_t ) + 256 )
+
+static uint64_t ullRingMemory[ ( TEST_RING_MEMORY_SIZE + 128 ) / sizeof( uint64_t ) ]
+__attribute__( ( aligned( ampRING_CACHE_LINE_SIZE ) ) );
+static AmpRing_t * pxRing;
+
+/** Sends ulLength bytes of ucFill and checks whether it was accepted */
+static bool bSendFilled( uint32_t ulLength,
+                         uint8_t ucFill )
+{
+    uint8_t ucRecord[ 256 ];
+    bool bDoorbell = false;
+
+    memset( ucRecord, ucFill, ulLength );
+
+    return AMP_RingSend( pxRing, ucRecord, ulLength, &bDoorbell );
+}
+
+/** Peeks the next record and checks its length and contents */
+static void vReceiveFilled( uint32_t ulLength,
+                            uint8_t ucFill )
+{
+    uint32_t ulReceived = 0;
+    const uint8_t * pucRecord = AMP_RingPeek( pxRing, &ulReceived );
+
+    TEST_ASSERT_NOT_NULL( pucRecord );
+    TEST_ASSERT_EQUAL( ulLength, ulReceived );
+
+    for( uint32_t ulI = 0; ulI < ulLength; ulI++ )
+    {
+        TEST_ASSERT_EQUAL_HEX8( ucFill, pucRecord[ ulI ] );
+    }
+
+    AMP_RingRelease( pxRing );
+}
+
+TEST_GROUP( aws_amp_ring );
+
+TEST_SETUP( aws_amp_ring )
+{
+    memset( ullRingMemory, 0xA5, sizeof( ullRingMemory ) );
+    pxRing = AMP_RingInit( ullRingMemory, TEST_RING_MEMORY_SIZE );
+}
+
+TEST_TEAR_DOWN( aws_amp_ring )
+{
+}
+
+TEST_GROUP_RUNNER( aws_amp_ring )
+{
+    RUN_TEST_CASE( aws_amp_ring, Init_uses_largest_power_of_two );
+    RUN_TEST_CASE( aws_amp_ring, Init_rejects_small_or_misaligned_memory );
+    RUN_TEST_CASE( aws_amp_ring, Peek_returns_null_when_empty );
+    RUN_TEST_CASE( aws_amp_ring, Send_then_Peek_returns_record );
+    RUN_TEST_CASE( aws_amp_ring, Records_are_received_in_order );
+    RUN_TEST_CASE( aws_amp_ring, Send_fails_when_full );
+    RUN_TEST_CASE( aws_amp_ring, Send_rejects_records_over_max_length );
+    RUN_TEST_CASE( aws_amp_ring, Records_never_wrap );
+    RUN_TEST_CASE( aws_amp_ring, Zero_length_records );
+    RUN_TEST_CASE( aws_amp_ring, Peek_without_release_returns_same_record );
+    RUN_TEST_CASE( aws_amp_ring, Reserve_is_invisible_until_commit );
+    RUN_TEST_CASE( aws_amp_ring, Commit_requests_doorbell_only_when_armed );
+    RUN_TEST_CASE( aws_amp_ring, ArmDoorbell_refuses_sleep_when_not_empty );
+}
+
+TEST( aws_amp_ring, Init_uses_largest_power_of_two )
+{
+    TEST_ASSERT_EQUAL_PTR( ullRingMemory, pxRing );
+    TEST_ASSERT_EQUAL( 256, pxRing->ulSize );
+    TEST_ASSERT_EQUAL( 124, AMP_RingMaxRecordLength( pxRing ) );
+
+    pxRing = AMP_RingInit( ullRingMemory, sizeof( AmpRing_t ) + 255 );
+    TEST_ASSERT_EQUAL( 128, pxRing->ulSize );
+}
+
+TEST( aws_amp_ring, Init_rejects_small_or_misaligned_memory )
+{
+    TEST_ASSERT_NULL( AMP_RingInit( ullRingMemory, sizeof( AmpRing_t ) + 63 ) );
+    TEST_ASSERT_NULL( AMP_RingInit( ( uint8_t * ) ullRingMemory + 4, TEST_RING_MEMORY_SIZE ) );
+    TEST_ASSERT_NULL( AMP_RingInit( NULL, TEST_RING_MEMORY_SIZE ) );
+}
+
+TEST( aws_amp_ring, Peek_returns_null_when_empty )
+{
+    uint32_t ulLength = 0;
+
+    TEST_ASSERT_NULL( AMP_RingPeek( pxRing, &ulLength ) );
+}
+
+TEST( aws_amp_ring, Send_then_Peek_returns_record )
+{
+    TEST_ASSERT_TRUE( bSendFilled( 5, 0x11 ) );
+    vReceiveFilled( 5, 0x11 );
+
+    uint32_t ulLength = 0;
+    TEST_ASSERT_NULL( AMP_RingPeek( pxRing, &ulLength ) );
+}
+
+TEST( aws_amp_ring, Records_are_received_in_order )
+{
+    TEST_ASSERT_TRUE( bSendFilled( 1, 0x01 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 2, 0x02 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 3, 0x03 ) );
+    vReceiveFilled( 1, 0x01 );
+    vReceiveFilled( 2, 0x02 );
+    vReceiveFilled( 3, 0x03 );
+}
+
+TEST( aws_amp_ring, Send_fails_when_full )
+{
+    /* Each 60 byte record takes 64 bytes with its header. */
+    TEST_ASSERT_TRUE( bSendFilled( 60, 0x01 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 60, 0x02 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 60, 0x03 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 60, 0x04 ) );
+    TEST_ASSERT_FALSE( bSendFilled( 0, 0x05 ) );
+
+    vReceiveFilled( 60, 0x01 );
+    TEST_ASSERT_TRUE( bSendFilled( 60, 0x05 ) );
+    vReceiveFilled( 60, 0x02 );
+    vReceiveFilled( 60, 0x03 );
+    vReceiveFilled( 60, 0x04 );
+    vReceiveFilled( 60, 0x05 );
+}
+
+TEST( aws_amp_ring, Send_rejects_records_over_max_length )
+{
+    TEST_ASSERT_FALSE( bSendFilled( AMP_RingMaxRecordLength( pxRing ) + 1, 0x01 ) );
+    TEST_ASSERT_TRUE( bSendFilled( AMP_RingMaxRecordLength( pxRing ), 0x02 ) );
+    vReceiveFilled( AMP_RingMaxRecordLength( pxRing ), 0x02 );
+}
+
+TEST( aws_amp_ring, Records_never_wrap )
+{
+    /* Move the head to offset 192, leaving 64 bytes before the end. */
+    TEST_ASSERT_TRUE( bSendFilled( 92, 0x01 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 92, 0x02 ) );
+    vReceiveFilled( 92, 0x01 );
+    vReceiveFilled( 92, 0x02 );
+
+    /* Fill to 240, then send a record that cannot fit in the last 16 bytes. */
+    TEST_ASSERT_TRUE( bSendFilled( 44, 0x03 ) );
+    TEST_ASSERT_TRUE( bSendFilled( 20, 0x04 ) );
+
+    uint32_t ulLength = 0;
+    const uint8_t * pucRecord = AMP_RingPeek( pxRing, &ulLength );
+    TEST_ASSERT_EQUAL_PTR( &pxRing->ucData[ 196 ], pucRecord );
+    AMP_RingRelease( pxRing );
+
+    pucRecord = AMP_RingPeek( pxRing, &ulLength );
+    TEST_ASSERT_EQUAL_PTR( &pxRing->ucData[ ampRING_RECORD_HEADER_SIZE ], pucRecord );
+    TEST_ASSERT_EQUAL( 20, ulLength );
+    TEST_ASSERT_EQUAL_HEX8( 0x04, pucRecord[ 19 ] );
+    AMP_RingRelease( pxRing );
+
+    TEST_ASSERT_NULL( AMP_RingPeek( pxRing, &ulLength ) );
+}
+
+TEST( aws_amp_ring, Zero_length_records )
+{
+    TEST_ASSERT_TRUE( bSendFilled( 0, 0 ) );
+    vReceiveFilled( 0, 0 );
+}
+
+TEST( aws_amp_ring, Peek_without_release_returns_same_record )
+{
+    uint32_t ulLength = 0;
+
+    TEST_ASSERT_TRUE( bSendFilled( 8, 0x08 ) );
+    const void * pvFirst = AMP_RingPeek( pxRing, &ulLength );
+    const void * pvSecond = AMP_RingPeek( pxRing, &ulLength );
+    TEST_ASSERT_EQUAL_PTR( pvFirst, pvSecond );
+    vReceiveFilled( 8, 0x08 );
+}
+
+TEST( aws_amp_ring, Reserve_is_invisible_until_commit )
+{
+    uint32_t ulLength = 0;
+    uint8_t * pucRecord = AMP_RingReserve( pxRing, 4 );
+
+    TEST_ASSERT_NOT_NULL( pucRecord );
+    memset( pucRecord, 0x44, 4 );
+    TEST_ASSERT_NULL( AMP_RingPeek( pxRing, &ulLength ) );
+
+    ( void ) AMP_RingCommit( pxRing );
+    vReceiveFilled( 4, 0x44 );
+}
+
+TEST( aws_amp_ring, Commit_requests_doorbell_only_when_armed )
+{
+    bool bDoorbell = true;
+
+    TEST_ASSERT_TRUE( AMP_RingSend( pxRing, "a", 1, &bDoorbell ) );
+    TEST_ASSERT_FALSE( bDoorbell );
+    vReceiveFilled( 1, 'a' );
+
+    TEST_ASSERT_TRUE( AMP_RingArmDoorbell( pxRing ) );
+    TEST_ASSERT_TRUE( AMP_RingSend( pxRing, "b", 1, &bDoorbell ) );
+    TEST_ASSERT_TRUE( bDoorbell );
+
+    /* The request is answered once. */
+    TEST_ASSERT_TRUE( AMP_RingSend( pxRing, "c", 1, &bDoorbell ) );
+    TEST_ASSERT_FALSE( bDoorbell );
+}
+
+TEST( aws_amp_ring, ArmDoorbell_refuses_sleep_when_not_empty )
+{
+    bool bDoorbell = false;
+
+    TEST_ASSERT_TRUE( AMP_RingSend( pxRing, "a", 1, &bDoorbell ) );
+    TEST_ASSERT_FALSE( AMP_RingArmDoorbell( pxRing ) );
+}
@@ -0,0 +1,195 @@
+/*
+ * Amazon FreeRTOS AMP Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+/*
+ * Host benchmark of the ring with two pthreads standing in for the two cores.
+ * The doorbell is a counting condition variable, the consumer sleeps on it
+ * whenever AMP_RingArmDoorbell() allows. Every record carries a sequence
+ * number and a pattern that the consumer checks.
+ */
+
+#include "aws_amp_ring.h"
+#include "unity_fixture.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCHMARK_RECORDS        ( 2000000UL )
+#define BENCHMARK_RING_SIZE      ( 16384 )
+#define BENCHMARK_MAX_PAYLOAD    ( 200 )
+
+typedef struct Doorbell
+{
+    pthread_mutex_t xMutex;
+    pthread_cond_t xCondition;
+    uint32_t ulPending;
+    uint32_t ulRung;
+} Doorbell_t;
+
+static uint64_t ullRingMemory[ ( sizeof( AmpRing_t ) + BENCHMARK_RING_SIZE ) / sizeof( uint64_t ) ]
+__attribute__( ( aligned( ampRING_CACHE_LINE_SIZE ) ) );
+static AmpRing_t * pxRing;
+static Doorbell_t xDoorbell;
+static uint32_t ulProducerFullSpins;
+static uint32_t ulConsumerErrors;
+
+static void vDoorbellRing( Doorbell_t * pxDoorbell )
+{
+    pthread_mutex_lock( &pxDoorbell->xMutex );
+    pxDoorbell->ulPending++;
+    pxDoorbell->ulRung++;
+    pthread_cond_signal( &pxDoorbell->xCondition );
+    pthread_mutex_unlock( &pxDoorbell->xMutex );
+}
+
+static void vDoorbellWait( Doorbell_t * pxDoorbell )
+{
+    pthread_mutex_lock( &pxDoorbell->xMutex );
+
+    while( pxDoorbell->ulPending == 0 )
+    {
+        pthread_cond_wait( &pxDoorbell->xCondition, &pxDoorbell->xMutex );
+    }
+
+    pxDoorbell->ulPending--;
+    pthread_mutex_unlock( &pxDoorbell->xMutex );
+}
+
+/** Payload length of record ulSequence, between 5 and BENCHMARK_MAX_PAYLOAD */
+static uint32_t ulRecordLength( uint32_t ulSequence )
+{
+    return 5 + ( ( ulSequence * 37 ) % ( BENCHMARK_MAX_PAYLOAD - 4 ) );
+}
+
+static void * pvProducer( void * pvArg )
+{
+    ( void ) pvArg;
+
+    for( uint32_t ulSequence = 0; ulSequence < BENCHMARK_RECORDS; ulSequence++ )
+    {
+        uint32_t ulLength = ulRecordLength( ulSequence );
+        uint8_t * pucRecord;
+
+        while( ( pucRecord = AMP_RingReserve( pxRing, ulLength ) ) == NULL )
+        {
+            ulProducerFullSpins++;
+            sched_yield();
+        }
+
+        memcpy( pucRecord, &ulSequence, sizeof( ulSequence ) );
+        memset( pucRecord + 4, ( uint8_t ) ulSequence, ulLength - 4 );
+
+        if( AMP_RingCommit( pxRing ) )
+        {
+            vDoorbellRing( &xDoorbell );
+        }
+    }
+
+    return NULL;
+}
+
+static void * pvConsumer( void * pvArg )
+{
+    uint32_t ulExpected = 0;
+
+    ( void ) pvArg;
+
+    while( ulExpected < BENCHMARK_RECORDS )
+    {
+        uint32_t ulLength = 0, ulSequence = 0;
+        const uint8_t * pucRecord = AMP_RingPeek( pxRing, &ulLength );
+
+        if( pucRecord == NULL )
+        {
+            if( AMP_RingArmDoorbell( pxRing ) )
+            {
+                vDoorbellWait( &xDoorbell );
+            }
+
+            continue;
+        }
+
+        memcpy( &ulSequence, pucRecord, sizeof( ulSequence ) );
+
+        if( ( ulSequence != ulExpected ) ||
+            ( ulLength != ulRecordLength( ulExpected ) ) ||
+            ( pucRecord[ ulLength - 1 ] != ( uint8_t ) ulExpected ) )
+        {
+            ulConsumerErrors++;
+        }
+
+        AMP_RingRelease( pxRing );
+        ulExpected++;
+    }
+
+    return NULL;
+}
+
+TEST_GROUP( aws_amp_ring_benchmark );
+
+TEST_SETUP( aws_amp_ring_benchmark )
+{
+    pxRing = AMP_RingInit( ullRingMemory, sizeof( ullRingMemory ) );
+    memset( &xDoorbell, 0, sizeof( xDoorbell ) );
+    pthread_mutex_init( &xDoorbell.xMutex, NULL );
+    pthread_cond_init( &xDoorbell.xCondition, NULL );
+    ulProducerFullSpins = 0;
+    ulConsumerErrors = 0;
+}
+
+TEST_TEAR_DOWN( aws_amp_ring_benchmark )
+{
+    pthread_mutex_destroy( &xDoorbell.xMutex );
+    pthread_cond_destroy( &xDoorbell.xCondition );
+}
+
+TEST_GROUP_RUNNER( aws_amp_ring_benchmark )
+{
+    RUN_TEST_CASE( aws_amp_ring_benchmark, two_threads );
+}
+
+TEST( aws_amp_ring_benchmark, two_threads )
+{
+    pthread_t xProducer, xConsumer;
+    struct timespec xStart, xEnd;
+
+    TEST_ASSERT_NOT_NULL( pxRing );
+
+    clock_gettime( CLOCK_MONOTONIC, &xStart );
+    TEST_ASSERT_EQUAL( 0, pthread_create( &xConsumer, NULL, pvConsumer, NULL ) );
+    TEST_ASSERT_EQUAL( 0, pthread_create( &xProducer, NULL, pvProducer, NULL ) );
+    pthread_join( xProducer, NULL );
+    pthread_join( xConsumer, NULL );
+    clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+    double xSeconds = ( double ) ( xEnd.tv_sec - xStart.tv_sec ) +
+                      ( double ) ( xEnd.tv_nsec - xStart.tv_nsec ) / 1e9;
+
+    printf( "\n  ring: %lu records in %.3f s, %.0f records/s, %u doorbells, %u full spins\n",
+            BENCHMARK_RECORDS, xSeconds, BENCHMARK_RECORDS / xSeconds,
+            xDoorbell.ulRung, ulProducerFullSpins );
+
+    TEST_ASSERT_EQUAL( 0, ulConsumerErrors );
+}
@@ -32,6 +32,12 @@
  * of buffers in the pool and the size of each buffer is controlled
  * via macros bufferpoolconfigNUM_BUFFERS and bufferpoolconfigBUFFER_SIZE
  * which must be defined in BufferPoolConfig.h.
+ *
+ * Each buffer carries a reference count so that one buffer can be handed to
+ * several consumers without copying it. BUFFERPOOL_GetFreeBuffer() returns a
+ * buffer with one reference, BUFFERPOOL_ShareBuffer() adds one and
+ * BUFFERPOOL_ReturnBuffer() drops one. The buffer goes back to the pool when
+ * the last reference is dropped.
  */
 
 /* FreeRTOS includes. */
@@ -41,6 +47,7 @@
 /* BufferPool includes. */
 #include "aws_bufferpool.h"
 #include "aws_bufferpool_config.h"
+#include "aws_static_memory.h"
 
 /* Make sure that proper config options are defined. */
 #ifndef bufferpoolconfigNUM_BUFFERS
@@ -76,20 +83,26 @@
 #define bufferpoolstaticDATA_LOCATION_IN_BUFFER( pucBuffer )                   ( ( uint8_t * ) ( bufferpoolstaticALIGN_POINTER( bufferpoolstaticRESERVE_METADATA_SPACE( pucBuffer ) ) ) )
 
 /**
- * @brief Given the data location in a buffer, extracts the buffer "in-use"
- * information from the metadata portion of the buffer.
+ * @brief Given the data location in a buffer, extracts the reference count
+ * from the metadata portion of the buffer. A buffer is free when its
+ * reference count is zero.
  *
  * @param[in] pucDataLocation The given data location in the buffer.
  */
-#define bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucDataLocation )    ( ( ( BufferMetadata_t * ) ( ( pucDataLocation ) - sizeof( BufferMetadata_t ) ) )->ucBufferInUse )
+#define bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucDataLocation )    ( ( ( BufferMetadata_t * ) ( ( pucDataLocation ) - sizeof( BufferMetadata_t ) ) )->ucReferenceCount )
 
 /**
- * @brief Extracts the buffer "in-use" information from the metadata portion
- * of the given buffer.
+ * @brief Extracts the reference count from the metadata portion of the
+ * given buffer.
  *
  * @param[in] pucBuffer The given buffer.
  */
 #define bufferpoolstaticBUFFER_IN_USE( pucBuffer )                             bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( bufferpoolstaticDATA_LOCATION_IN_BUFFER( pucBuffer ) )
+
+/**
+ * @brief The largest number of references a buffer can have.
+ */
+#define bufferpoolstaticMAX_REFERENCES                                         ( ( uint8_t ) 0xFF )
 /*-----------------------------------------------------------*/
 
 /**
@@ -97,7 +110,7 @@
  */
 typedef struct BufferMetadata
 {
-    uint8_t ucBufferInUse; /**< Whether or not the buffer is in use. */
+    uint8_t ucReferenceCount; /**< Number of owners of the buffer, 0 if it is free. */
 } BufferMetadata_t;
 /*-----------------------------------------------------------*/
 
@@ -111,7 +124,7 @@ typedef struct BufferMetadata
  * @note Each buffer in the buffer pool allocates additional the space required
  * to store the metadata and to ensure alignment.
  */
-static uint8_t ucBufferPool[ bufferpoolconfigNUM_BUFFERS ][ sizeof( BufferMetadata_t ) + bufferpoolconfigBUFFER_SIZE + ( portBYTE_ALIGNMENT - 1 ) ];
+static uint8_t ucBufferPool[ bufferpoolconfigNUM_BUFFERS ][ sizeof( BufferMetadata_t ) + bufferpoolconfigBUFFER_SIZE + ( portBYTE_ALIGNMENT - 1 ) ] staticmemSECTION( bufferpool );
 /*-----------------------------------------------------------*/
 
 BaseType_t BUFFERPOOL_Init( void )
@@ -130,6 +143,68 @@ BaseType_t BUFFERPOOL_Init( void )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Claims buffer x of the pool if it is free.
+ *
+ * Must be called with interrupts masked.
+ *
+ * @param[in] x The index of the buffer in the pool.
+ *
+ * @return The data location of the buffer if it was free, NULL otherwise.
+ */
+static uint8_t * prvClaimBuffer( BaseType_t x );
+
+/**
+ * @brief Adds or drops one reference to a buffer.
+ *
+ * Must be called with interrupts masked.
+ *
+ * @param[in] pucBuffer The data location of the buffer.
+ * @param[in] xShare pdTRUE to add a reference, pdFALSE to drop one.
+ */
+static void prvUpdateReferenceCount( uint8_t * const pucBuffer,
+                                     BaseType_t xShare );
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvClaimBuffer( BaseType_t x )
+{
+    uint8_t * pucFreeBuffer = NULL;
+
+    /* Check if the buffer is free. */
+    if( bufferpoolstaticBUFFER_IN_USE( ucBufferPool[ x ] ) == 0 )
+    {
+        /* The caller holds the only reference. */
+        bufferpoolstaticBUFFER_IN_USE( ucBufferPool[ x ] ) = 1;
+
+        /* Return the data location to the user. */
+        pucFreeBuffer = bufferpoolstaticDATA_LOCATION_IN_BUFFER( ucBufferPool[ x ] );
+    }
+
+    return pucFreeBuffer;
+}
+/*-----------------------------------------------------------*/
+
+static void prvUpdateReferenceCount( uint8_t * const pucBuffer,
+                                     BaseType_t xShare )
+{
+    /* The buffer must have at least one owner, the caller. The returned
+     * buffer is the data location in the actual buffer (because we gave
+     * the data location to the user). */
+    configASSERT( bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer ) != 0 );
+
+    if( xShare == pdTRUE )
+    {
+        configASSERT( bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer ) < bufferpoolstaticMAX_REFERENCES );
+        bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer )++;
+    }
+    else
+    {
+        /* The buffer is free once the last reference is dropped. */
+        bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer )--;
+    }
+}
+/*-----------------------------------------------------------*/
+
 uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
 {
     BaseType_t x = 0;
@@ -139,38 +214,21 @@ uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
      * so we cannot provide any buffer larger than that. */
     if( *pulBufferLength <= bufferpoolconfigBUFFER_SIZE )
     {
-        /* Iterate over all the buffers to find a free buffer. */
-        for( x = 0; x < bufferpoolconfigNUM_BUFFERS; x++ )
+        /* Iterate over all the buffers to find a free buffer. The critical
+         * section is held for one buffer at a time to keep the interrupt
+         * latency independent of the size of the pool. */
+        for( x = 0; ( x < bufferpoolconfigNUM_BUFFERS ) && ( pucFreeBuffer == NULL ); x++ )
         {
-            /* Start critical section. */
             taskENTER_CRITICAL();
+            pucFreeBuffer = prvClaimBuffer( x );
+            taskEXIT_CRITICAL();
+        }
 
-            /* Check if the buffer is free. */
-            if( bufferpoolstaticBUFFER_IN_USE( ucBufferPool[ x ] ) == 0 )
-            {
-                /* Mark the buffer as "in-use". */
-                bufferpoolstaticBUFFER_IN_USE( ucBufferPool[ x ] ) = 1;
-
-                /* End critical section. The further operations in this
-                 * if branch do not modify the buffer and hence the critical
-                 * section is not needed hereafter. */
-                taskEXIT_CRITICAL();
-
-                /* Return the actual buffer size (as configured by the
-                 * bufferpoolconfigBUFFER_SIZE macro) to the user. */
-                *pulBufferLength = bufferpoolconfigBUFFER_SIZE;
-
-                /* Return the data location to the user. */
-                pucFreeBuffer = bufferpoolstaticDATA_LOCATION_IN_BUFFER( ucBufferPool[ x ] );
-
-                /* Stop as we have found a buffer. */
-                break;
-            }
-            else
-            {
-                /* End critical section. */
-                taskEXIT_CRITICAL();
-            }
+        if( pucFreeBuffer != NULL )
+        {
+            /* Return the actual buffer size (as configured by the
+             * bufferpoolconfigBUFFER_SIZE macro) to the user. */
+            *pulBufferLength = bufferpoolconfigBUFFER_SIZE;
         }
     }
 
@@ -178,17 +236,61 @@ uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength )
 }
 /*-----------------------------------------------------------*/
 
-void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer )
+uint8_t * BUFFERPOOL_GetFreeBufferFromISR( uint32_t * pulBufferLength )
+{
+    BaseType_t x = 0;
+    uint8_t * pucFreeBuffer = NULL;
+    UBaseType_t uxSavedInterruptStatus = 0;
+
+    if( *pulBufferLength <= bufferpoolconfigBUFFER_SIZE )
+    {
+        for( x = 0; ( x < bufferpoolconfigNUM_BUFFERS ) && ( pucFreeBuffer == NULL ); x++ )
+        {
+            uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+            pucFreeBuffer = prvClaimBuffer( x );
+            taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+        }
+
+        if( pucFreeBuffer != NULL )
+        {
+            *pulBufferLength = bufferpoolconfigBUFFER_SIZE;
+        }
+    }
+
+    return pucFreeBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void BUFFERPOOL_ShareBuffer( uint8_t * const pucBuffer )
 {
-    /* Start critical section. */
     taskENTER_CRITICAL();
+    prvUpdateReferenceCount( pucBuffer, pdTRUE );
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
 
-    /* Mark the buffer as free. The returned buffer is the data
-     * location in the actual buffer (because we gave the data location
-     * to the user). */
-    bufferpoolstaticBUFFER_IN_USE_FROM_DATA_LOCATION( pucBuffer ) = 0;
+void BUFFERPOOL_ShareBufferFromISR( uint8_t * const pucBuffer )
+{
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    prvUpdateReferenceCount( pucBuffer, pdTRUE );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
 
-    /* End critical section. */
+void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer )
+{
+    taskENTER_CRITICAL();
+    prvUpdateReferenceCount( pucBuffer, pdFALSE );
     taskEXIT_CRITICAL();
 }
 /*-----------------------------------------------------------*/
+
+void BUFFERPOOL_ReturnBufferFromISR( uint8_t * const pucBuffer )
+{
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    prvUpdateReferenceCount( pucBuffer, pdFALSE );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+}
+/*-----------------------------------------------------------*/
@@ -326,7 +326,8 @@ void CBOR_AppendMap( CBORHandle_t xDest,
                      CBORHandle_t xSrc )
 {
     xSrc->pxCursor = xSrc->pxBufferStart + 1;
-    cbor_ssize_t xLength = xSrc->pxBufferEnd - xSrc->pxCursor;
+    /* Copy the source pairs and its break, but not the unused space after it */
+    cbor_ssize_t xLength = xSrc->pxMapEnd - xSrc->pxCursor + 1;
     xDest->pxCursor = xDest->pxMapEnd;
     CBOR_MemCopy( xDest, xSrc->pxCursor, xLength );
     xDest->pxMapEnd = xDest->pxCursor - 1;
@@ -267,4 +267,129 @@ CBORHandle_t CBOR_FromKeyReadMap(
  */
 void CBOR_AppendMap( CBORHandle_t /*dest*/, CBORHandle_t /*src*/ );
 
+/**
+ * @brief Forward-only CBOR encoder
+ *
+ * Writes definite-length maps and arrays straight into a caller-supplied
+ * buffer.  Unlike the CBORHandle_t functions, the encoder never allocates,
+ * reallocates or moves data already written.  Items must therefore be written
+ * in document order, and the number of entries in a map or array must be known
+ * when it is opened.
+ *
+ * Initializing the encoder with a NULL buffer runs a sizing pass: nothing is
+ * written and CBOR_EncoderSize returns the number of bytes the document needs.
+ * When the buffer runs out, the encoder stops writing, sets
+ * eCborErrInsufficentSpace and keeps counting, so the size is also valid after
+ * a failed pass.
+ *
+ * @code
+ * CBOREncoder_t xEncoder;
+ * CBOR_EncoderInit( &xEncoder, pucBuffer, sizeof( pucBuffer ) );
+ * CBOR_EncodeMap( &xEncoder, 2 );
+ * CBOR_EncodeKeyWithInt( &xEncoder, "answer", 42 );
+ * CBOR_EncodeKeyWithMap( &xEncoder, "map", 1 );
+ * CBOR_EncodeKeyWithString( &xEncoder, "direction", "north" );
+ * @endcode
+ *
+ * @note The fields are private.  The struct is declared here so that the
+ * encoder can be allocated by the caller, e.g. on the stack.
+ * @note The read functions only support buffers created by CBOR_New.
+ */
+typedef struct CborEncoder_s
+{
+    /** Start of the caller's buffer, NULL for a sizing pass */
+    cbor_byte_t * pxBufferStart;
+    /** One past the end of the caller's buffer */
+    cbor_byte_t * pxBufferEnd;
+    /** Size (in bytes) of the document written so far */
+    cbor_ssize_t xSize;
+    /** Current error code status */
+    cborError_t xError;
+} CBOREncoder_t;
+
+/**
+ * @brief Initializes an encoder writing to the given buffer.
+ * @param "CBOREncoder_t *" Encoder to initialize
+ * @param "cbor_byte_t *"   Destination buffer, NULL for a sizing pass
+ * @param cbor_ssize_t      Size (in bytes) of the destination buffer
+ */
+void CBOR_EncoderInit( CBOREncoder_t * /*pxEncoder*/,
+                       cbor_byte_t * /*buffer*/, cbor_ssize_t /*size*/ );
+
+/**
+ * @brief Gets the size of the encoded document.
+ * @param  "const CBOREncoder_t *" Encoder
+ * @return cbor_ssize_t Size (in bytes) of the document written so far
+ */
+cbor_ssize_t CBOR_EncoderSize( const CBOREncoder_t * /*pxEncoder*/ );
+
+/**
+ * @brief Checks the error state of the encoder.
+ * @param  "const CBOREncoder_t *" Encoder
+ * @return cborError_t The current error state of the encoder
+ */
+cborError_t CBOR_EncoderCheckError( const CBOREncoder_t * /*pxEncoder*/ );
+
+/**
+ * @brief Opens a definite-length map.
+ *
+ * The map is closed once the given number of @glos{key} @glos{value} pairs
+ * has been written.
+ *
+ * @param "CBOREncoder_t *" Encoder
+ * @param cbor_ssize_t      Number of @glos{key} @glos{value} pairs in the map
+ */
+void CBOR_EncodeMap( CBOREncoder_t * /*pxEncoder*/, cbor_ssize_t /*count*/ );
+
+/**
+ * @brief Opens a definite-length array.
+ * @param "CBOREncoder_t *" Encoder
+ * @param cbor_ssize_t      Number of items in the array
+ */
+void CBOR_EncodeArray( CBOREncoder_t * /*pxEncoder*/, cbor_ssize_t /*count*/ );
+
+/**
+ * @brief Writes an integer.
+ * @param "CBOREncoder_t *" Encoder
+ * @param cbor_int_t        Integer to write
+ */
+void CBOR_EncodeInt( CBOREncoder_t * /*pxEncoder*/, cbor_int_t /*value*/ );
+
+/**
+ * @brief Writes a string.
+ * @param "CBOREncoder_t *"   Encoder
+ * @param cbor_const_string_t zero terminated string
+ */
+void CBOR_EncodeString( CBOREncoder_t * /*pxEncoder*/,
+                        cbor_const_string_t /*value*/ );
+
+/**
+ * @brief Writes a @glos{key} with an integer @glos{value}
+ * @param "CBOREncoder_t *" Encoder
+ * @param cbor_const_key_t  @glos{key}   - zero terminated string
+ * @param cbor_int_t        @glos{value} - integer
+ */
+void CBOR_EncodeKeyWithInt( CBOREncoder_t * /*pxEncoder*/,
+                            cbor_const_key_t /*key*/, cbor_int_t /*value*/ );
+
+/**
+ * @brief Writes a @glos{key} with a string @glos{value}
+ * @param "CBOREncoder_t *"   Encoder
+ * @param cbor_const_key_t    @glos{key}   - zero terminated string
+ * @param cbor_const_string_t @glos{value} - zero terminated string
+ */
+void CBOR_EncodeKeyWithString( CBOREncoder_t * /*pxEncoder*/,
+                               cbor_const_key_t /*key*/,
+                               cbor_const_string_t /*value*/ );
+
+/**
+ * @brief Writes a @glos{key} and opens a definite-length map as its
+ * @glos{value}.
+ * @param "CBOREncoder_t *" Encoder
+ * @param cbor_const_key_t  @glos{key}   - zero terminated string
+ * @param cbor_ssize_t      Number of @glos{key} @glos{value} pairs in the map
+ */
+void CBOR_EncodeKeyWithMap( CBOREncoder_t * /*pxEncoder*/,
+                            cbor_const_key_t /*key*/, cbor_ssize_t /*count*/ );
+
 #endif /* ifndef AWS_CBOR_H */
@@ -0,0 +1,290 @@
+/*
+ * Amazon FreeRTOS CBOR Library V1.0.1
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+#include "aws_cbor_internals.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Copies data to the end of the encoded document.
+ *
+ * Nothing is copied during a sizing pass or once the buffer has run out, but
+ * the document size is always updated.
+ */
+static void CBOR_EncoderWrite( CBOREncoder_t * pxEncoder,
+                               const void * pvInput,
+                               cbor_ssize_t xLength )
+{
+    assert( NULL != pxEncoder );
+    assert( NULL != pvInput );
+    assert( 0 <= xLength );
+
+    if( ( NULL != pxEncoder->pxBufferStart ) &&
+        ( eCborErrNoError == pxEncoder->xError ) )
+    {
+        cbor_byte_t * pxCursor = pxEncoder->pxBufferStart + pxEncoder->xSize;
+
+        if( xLength <= pxEncoder->pxBufferEnd - pxCursor )
+        {
+            memcpy( pxCursor, pvInput, xLength );
+        }
+        else
+        {
+            pxEncoder->xError = eCborErrInsufficentSpace;
+        }
+    }
+
+    pxEncoder->xSize += xLength;
+}
+
+/**
+ * @brief Writes the head of a data item, in its shortest form.
+ *
+ * @param pxEncoder  Encoder
+ * @param xMajorType Major type of the data item
+ * @param ulValue    Integer value, string length or number of entries
+ */
+static void CBOR_EncodeHead( CBOREncoder_t * pxEncoder,
+                             cbor_byte_t xMajorType,
+                             uint32_t ulValue )
+{
+    assert( NULL != pxEncoder );
+
+    cbor_byte_t xHead[ CBOR_INT32_SIZE ];
+    cbor_ssize_t xLength = 0;
+
+    if( CBOR_IsSmallInt( ulValue ) )
+    {
+        xHead[ xLength++ ] = xMajorType | ( cbor_byte_t ) ulValue;
+    }
+    else if( CBOR_Is8BitInt( ulValue ) )
+    {
+        xHead[ xLength++ ] = xMajorType | CBOR_INT8_FOLLOWS;
+        xHead[ xLength++ ] = ( cbor_byte_t ) ulValue;
+    }
+    else if( CBOR_Is16BitInt( ulValue ) )
+    {
+        xHead[ xLength++ ] = xMajorType | CBOR_INT16_FOLLOWS;
+        xHead[ xLength++ ] = ( cbor_byte_t ) ( ulValue >> CBOR_BYTE_WIDTH );
+        xHead[ xLength++ ] = ( cbor_byte_t ) ulValue;
+    }
+    else
+    {
+        xHead[ xLength++ ] = xMajorType | CBOR_INT32_FOLLOWS;
+        xHead[ xLength++ ] = ( cbor_byte_t ) ( ulValue >> ( 3 * CBOR_BYTE_WIDTH ) );
+        xHead[ xLength++ ] = ( cbor_byte_t ) ( ulValue >> ( 2 * CBOR_BYTE_WIDTH ) );
+        xHead[ xLength++ ] = ( cbor_byte_t ) ( ulValue >> CBOR_BYTE_WIDTH );
+        xHead[ xLength++ ] = ( cbor_byte_t ) ulValue;
+    }
+
+    CBOR_EncoderWrite( pxEncoder, xHead, xLength );
+}
+
+void CBOR_EncoderInit( CBOREncoder_t * pxEncoder,
+                       cbor_byte_t * pxBuffer,
+                       cbor_ssize_t xBufferSize )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    pxEncoder->pxBufferStart = pxBuffer;
+    pxEncoder->pxBufferEnd = NULL;
+    pxEncoder->xSize = 0;
+    pxEncoder->xError = eCborErrNoError;
+
+    if( NULL != pxBuffer )
+    {
+        pxEncoder->pxBufferEnd = pxBuffer + ( 0 < xBufferSize ? xBufferSize : 0 );
+    }
+}
+
+cbor_ssize_t CBOR_EncoderSize( const CBOREncoder_t * pxEncoder )
+{
+    if( NULL == pxEncoder )
+    {
+        return 0;
+    }
+
+    return pxEncoder->xSize;
+}
+
+cborError_t CBOR_EncoderCheckError( const CBOREncoder_t * pxEncoder )
+{
+    if( NULL == pxEncoder )
+    {
+        return eCborErrNullHandle;
+    }
+
+    return pxEncoder->xError;
+}
+
+void CBOR_EncodeMap( CBOREncoder_t * pxEncoder,
+                     cbor_ssize_t xPairCount )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( 0 > xPairCount )
+    {
+        pxEncoder->xError = eCborErrUnsupportedWriteOperation;
+
+        return;
+    }
+
+    CBOR_EncodeHead( pxEncoder, CBOR_MAP, ( uint32_t ) xPairCount );
+}
+
+void CBOR_EncodeArray( CBOREncoder_t * pxEncoder,
+                       cbor_ssize_t xItemCount )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( 0 > xItemCount )
+    {
+        pxEncoder->xError = eCborErrUnsupportedWriteOperation;
+
+        return;
+    }
+
+    CBOR_EncodeHead( pxEncoder, CBOR_ARRAY, ( uint32_t ) xItemCount );
+}
+
+void CBOR_EncodeInt( CBOREncoder_t * pxEncoder,
+                     cbor_int_t xValue )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( 0 > xValue )
+    {
+        /* Negative integers are encoded as -1 - n */
+        CBOR_EncodeHead( pxEncoder, CBOR_NEG_INT, ( uint32_t ) ( -1 - xValue ) );
+    }
+    else
+    {
+        CBOR_EncodeHead( pxEncoder, CBOR_POS_INT, ( uint32_t ) xValue );
+    }
+}
+
+void CBOR_EncodeString( CBOREncoder_t * pxEncoder,
+                        const char * pcValue )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( NULL == pcValue )
+    {
+        pxEncoder->xError = eCborErrNullValue;
+
+        return;
+    }
+
+    size_t xLength = strlen( pcValue );
+
+    CBOR_EncodeHead( pxEncoder, CBOR_STRING, ( uint32_t ) xLength );
+    CBOR_EncoderWrite( pxEncoder, pcValue, ( cbor_ssize_t ) xLength );
+}
+
+void CBOR_EncodeKeyWithInt( CBOREncoder_t * pxEncoder,
+                            const char * pcKey,
+                            cbor_int_t xValue )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( NULL == pcKey )
+    {
+        pxEncoder->xError = eCborErrNullKey;
+
+        return;
+    }
+
+    CBOR_EncodeString( pxEncoder, pcKey );
+    CBOR_EncodeInt( pxEncoder, xValue );
+}
+
+void CBOR_EncodeKeyWithString( CBOREncoder_t * pxEncoder,
+                               const char * pcKey,
+                               const char * pcValue )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( NULL == pcKey )
+    {
+        pxEncoder->xError = eCborErrNullKey;
+
+        return;
+    }
+
+    if( NULL == pcValue )
+    {
+        pxEncoder->xError = eCborErrNullValue;
+
+        return;
+    }
+
+    CBOR_EncodeString( pxEncoder, pcKey );
+    CBOR_EncodeString( pxEncoder, pcValue );
+}
+
+void CBOR_EncodeKeyWithMap( CBOREncoder_t * pxEncoder,
+                            const char * pcKey,
+                            cbor_ssize_t xPairCount )
+{
+    if( NULL == pxEncoder )
+    {
+        return;
+    }
+
+    if( NULL == pcKey )
+    {
+        pxEncoder->xError = eCborErrNullKey;
+
+        return;
+    }
+
+    CBOR_EncodeString( pxEncoder, pcKey );
+    CBOR_EncodeMap( pxEncoder, xPairCount );
+}
+
+/*
+ * End of File
+ */
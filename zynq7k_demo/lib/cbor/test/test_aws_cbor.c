@@ -54,6 +54,7 @@ TEST_GROUP_RUNNER( aws_cbor )
     RUN_TEST_CASE( aws_cbor, GetBuffer_returns_size_of_map_in_bytes );
     RUN_TEST_CASE( aws_cbor, ClearError_sets_err_to_CBOR_ERR_NO_ERROR );
     RUN_TEST_CASE( aws_cbor, AppendMap );
+    RUN_TEST_CASE( aws_cbor, AppendMap_keeps_pairs_of_every_source );
 }
 
 TEST( aws_cbor, New_returns_not_null )
@@ -164,3 +165,22 @@ TEST( aws_cbor, AppendMap )
     TEST_ASSERT_TRUE( xAnswerFound );
     TEST_ASSERT_TRUE( xQuestionFound );
 }
+
+TEST( aws_cbor, AppendMap_keeps_pairs_of_every_source )
+{
+    CBORHandle_t xSrcData = CBOR_New( 0 );
+
+    CBOR_AppendKeyWithInt( xSrcData, "answer", 42 );
+    CBOR_AppendMap( xCborData, xSrcData );
+    CBOR_Delete( &xSrcData );
+
+    xSrcData = CBOR_New( 0 );
+    CBOR_AppendKeyWithString( xSrcData, "question", "unknown" );
+    CBOR_AppendMap( xCborData, xSrcData );
+    CBOR_Delete( &xSrcData );
+
+    TEST_ASSERT_EQUAL( 42, CBOR_FromKeyReadInt( xCborData, "answer" ) );
+    TEST_ASSERT_TRUE( CBOR_FindKey( xCborData, "question" ) );
+    /* Both pairs and the map open and break bytes, no trailing space */
+    TEST_ASSERT_EQUAL( 1 + 7 + 2 + 9 + 8 + 1, CBOR_GetBufferSize( xCborData ) );
+}
@@ -0,0 +1,226 @@
+/*
+ * Amazon FreeRTOS CBOR Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/*
+ * Host benchmark of the CBORHandle_t functions against the forward-only
+ * encoder, building a report shaped like the Device Defender metrics report.
+ * The timings include the Unity malloc overrides, so only the ratio between
+ * the two builders is meaningful.
+ */
+
+#include "aws_cbor_internals.h"
+#include "unity_fixture.h"
+#include <stdio.h>
+#include <time.h>
+
+#define BENCHMARK_ITERATIONS     ( 20000 )
+#define BENCHMARK_BUFFER_SIZE    ( 256 )
+
+static void *( *pxSavedMalloc )( size_t );
+static void *( *pxSavedRealloc )( void *, size_t );
+static int32_t lMallocCount;
+static int32_t lReallocCount;
+
+static void * pxCountingMalloc( size_t xSize )
+{
+    lMallocCount++;
+
+    return pxSavedMalloc( xSize );
+}
+
+static void * pxCountingRealloc( void * pvPtr,
+                                 size_t xSize )
+{
+    lReallocCount++;
+
+    return pxSavedRealloc( pvPtr, xSize );
+}
+
+/** Builds the report with CBOR_New and the Assign/Append functions */
+static CBORHandle_t xBuildReportWithHandles( cbor_int_t xReportId )
+{
+    CBORHandle_t xReport = CBOR_New( BENCHMARK_BUFFER_SIZE );
+
+    CBORHandle_t xHeader = CBOR_New( 0 );
+    CBOR_AssignKeyWithInt( xHeader, "report_id", xReportId );
+    CBOR_AssignKeyWithString( xHeader, "version", "1.0" );
+    CBOR_AppendKeyWithMap( xReport, "header", xHeader );
+    CBOR_Delete( &xHeader );
+
+    CBORHandle_t xMetrics = CBOR_New( 0 );
+
+    CBORHandle_t xMetric = CBOR_New( 0 );
+    CBOR_AssignKeyWithInt( xMetric, "cpu", 42 );
+    CBOR_AppendMap( xMetrics, xMetric );
+    CBOR_Delete( &xMetric );
+
+    xMetric = CBOR_New( 0 );
+    CBOR_AppendKeyWithInt( xMetric, "ut", 86400 );
+    CBOR_AppendMap( xMetrics, xMetric );
+    CBOR_Delete( &xMetric );
+
+    CBORHandle_t xEstConn = CBOR_New( 0 );
+    CBOR_AssignKeyWithInt( xEstConn, "total", 3 );
+    CBORHandle_t xTcpConnMetrics = CBOR_New( 0 );
+    CBOR_AssignKeyWithMap( xTcpConnMetrics, "established_connections", xEstConn );
+    CBOR_Delete( &xEstConn );
+    xMetric = CBOR_New( 0 );
+    CBOR_AssignKeyWithMap( xMetric, "tcp_connections", xTcpConnMetrics );
+    CBOR_Delete( &xTcpConnMetrics );
+    CBOR_AppendMap( xMetrics, xMetric );
+    CBOR_Delete( &xMetric );
+
+    CBOR_AppendKeyWithMap( xReport, "metrics", xMetrics );
+    CBOR_Delete( &xMetrics );
+
+    return xReport;
+}
+
+/** Builds the same report with the forward-only encoder */
+static cbor_ssize_t xBuildReportWithEncoder( cbor_byte_t * pxBuffer,
+                                             cbor_ssize_t xBufferSize,
+                                             cbor_int_t xReportId )
+{
+    CBOREncoder_t xEncoder;
+
+    CBOR_EncoderInit( &xEncoder, pxBuffer, xBufferSize );
+    CBOR_EncodeMap( &xEncoder, 2 );
+    CBOR_EncodeKeyWithMap( &xEncoder, "header", 2 );
+    CBOR_EncodeKeyWithInt( &xEncoder, "report_id", xReportId );
+    CBOR_EncodeKeyWithString( &xEncoder, "version", "1.0" );
+    CBOR_EncodeKeyWithMap( &xEncoder, "metrics", 3 );
+    CBOR_EncodeKeyWithInt( &xEncoder, "cpu", 42 );
+    CBOR_EncodeKeyWithInt( &xEncoder, "ut", 86400 );
+    CBOR_EncodeKeyWithMap( &xEncoder, "tcp_connections", 1 );
+    CBOR_EncodeKeyWithMap( &xEncoder, "established_connections", 1 );
+    CBOR_EncodeKeyWithInt( &xEncoder, "total", 3 );
+
+    if( eCborErrNoError != CBOR_EncoderCheckError( &xEncoder ) )
+    {
+        return 0;
+    }
+
+    return CBOR_EncoderSize( &xEncoder );
+}
+
+static double xElapsedNanoseconds( clock_t xStart )
+{
+    return ( double ) ( clock() - xStart ) * 1e9 / CLOCKS_PER_SEC /
+           BENCHMARK_ITERATIONS;
+}
+
+TEST_GROUP( aws_cbor_benchmark );
+
+TEST_SETUP( aws_cbor_benchmark )
+{
+    pxSavedMalloc = pxCBOR_malloc;
+    pxSavedRealloc = pxCBOR_realloc;
+    pxCBOR_malloc = pxCountingMalloc;
+    pxCBOR_realloc = pxCountingRealloc;
+    lMallocCount = 0;
+    lReallocCount = 0;
+}
+
+TEST_TEAR_DOWN( aws_cbor_benchmark )
+{
+    pxCBOR_malloc = pxSavedMalloc;
+    pxCBOR_realloc = pxSavedRealloc;
+}
+
+TEST_GROUP_RUNNER( aws_cbor_benchmark )
+{
+    RUN_TEST_CASE( aws_cbor_benchmark, defender_report_with_handles );
+    RUN_TEST_CASE( aws_cbor_benchmark, defender_report_with_encoder );
+    RUN_TEST_CASE( aws_cbor_benchmark, defender_report_with_sizing_pass );
+}
+
+TEST( aws_cbor_benchmark, defender_report_with_handles )
+{
+    cbor_ssize_t xSize = 0;
+    clock_t xStart = clock();
+
+    for( cbor_int_t xI = 0; xI < BENCHMARK_ITERATIONS; xI++ )
+    {
+        CBORHandle_t xReport = xBuildReportWithHandles( xI );
+        TEST_ASSERT_EQUAL( eCborErrNoError, CBOR_CheckError( xReport ) );
+        xSize = CBOR_GetBufferSize( xReport );
+        CBOR_Delete( &xReport );
+    }
+
+    double xNanoseconds = xElapsedNanoseconds( xStart );
+
+    printf( "\n  handles: %6.0f ns/report, %d bytes, %d mallocs, %d reallocs per report\n",
+            xNanoseconds, xSize,
+            lMallocCount / BENCHMARK_ITERATIONS,
+            lReallocCount / BENCHMARK_ITERATIONS );
+}
+
+TEST( aws_cbor_benchmark, defender_report_with_encoder )
+{
+    cbor_byte_t xBuffer[ BENCHMARK_BUFFER_SIZE ];
+    cbor_ssize_t xSize = 0;
+    clock_t xStart = clock();
+
+    for( cbor_int_t xI = 0; xI < BENCHMARK_ITERATIONS; xI++ )
+    {
+        xSize = xBuildReportWithEncoder( xBuffer, sizeof( xBuffer ), xI );
+        TEST_ASSERT_NOT_EQUAL( 0, xSize );
+    }
+
+    double xNanoseconds = xElapsedNanoseconds( xStart );
+
+    printf( "\n  encoder: %6.0f ns/report, %d bytes, %d mallocs, %d reallocs per report\n",
+            xNanoseconds, xSize,
+            lMallocCount / BENCHMARK_ITERATIONS,
+            lReallocCount / BENCHMARK_ITERATIONS );
+
+    TEST_ASSERT_EQUAL( 0, lMallocCount );
+    TEST_ASSERT_EQUAL( 0, lReallocCount );
+}
+
+TEST( aws_cbor_benchmark, defender_report_with_sizing_pass )
+{
+    cbor_ssize_t xSize = 0;
+    clock_t xStart = clock();
+
+    for( cbor_int_t xI = 0; xI < BENCHMARK_ITERATIONS; xI++ )
+    {
+        cbor_ssize_t xRequired = xBuildReportWithEncoder( NULL, 0, xI );
+        cbor_byte_t * pxBuffer = pxCBOR_malloc( xRequired );
+        TEST_ASSERT_NOT_NULL( pxBuffer );
+        xSize = xBuildReportWithEncoder( pxBuffer, xRequired, xI );
+        TEST_ASSERT_EQUAL( xRequired, xSize );
+        pxCBOR_free( pxBuffer );
+    }
+
+    double xNanoseconds = xElapsedNanoseconds( xStart );
+
+    printf( "\n  two-pass: %6.0f ns/report, %d bytes, %d mallocs, %d reallocs per report\n",
+            xNanoseconds, xSize,
+            lMallocCount / BENCHMARK_ITERATIONS,
+            lReallocCount / BENCHMARK_ITERATIONS );
+
+    TEST_ASSERT_EQUAL( 0, lReallocCount );
+}
@@ -0,0 +1,247 @@
+/*
+ * Amazon FreeRTOS CBOR Library V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+#include "aws_cbor_internals.h"
+#include "unity_fixture.h"
+#include <limits.h>
+#include <string.h>
+
+#define ENCODER_TEST_BUFFER_SIZE    ( 64 )
+
+static CBOREncoder_t xEncoder;
+static cbor_byte_t xBuffer[ ENCODER_TEST_BUFFER_SIZE ];
+
+TEST_GROUP( aws_cbor_encoder );
+
+TEST_SETUP( aws_cbor_encoder )
+{
+    memset( xBuffer, 0, sizeof( xBuffer ) );
+    CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+}
+
+TEST_TEAR_DOWN( aws_cbor_encoder )
+{
+}
+
+TEST_GROUP_RUNNER( aws_cbor_encoder )
+{
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeInt_writes_shortest_form );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeInt_writes_negative_integers );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeString_writes_length_and_text );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeArray_writes_definite_length );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeKey_writes_nested_definite_maps );
+    RUN_TEST_CASE( aws_cbor_encoder, sizing_pass_matches_written_size );
+    RUN_TEST_CASE(
+        aws_cbor_encoder, insufficient_space_stops_writing_and_keeps_counting );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeKey_sets_err_when_given_null_key );
+    RUN_TEST_CASE(
+        aws_cbor_encoder, EncodeKeyWithString_sets_err_when_given_null_value );
+    RUN_TEST_CASE( aws_cbor_encoder, EncodeMap_sets_err_when_count_is_negative );
+    RUN_TEST_CASE( aws_cbor_encoder, functions_ignore_null_encoder );
+}
+
+TEST( aws_cbor_encoder, EncodeInt_writes_shortest_form )
+{
+    cbor_byte_t xExpected[] =
+    {
+        0x00,
+        0x17,
+        0x18, 0x18,
+        0x18, 0xFF,
+        0x19, 0x01, 0x00,
+        0x19, 0xFF, 0xFF,
+        0x1A, 0x00, 0x01, 0x00, 0x00,
+        0x1A, 0x7F, 0xFF, 0xFF, 0xFF,
+    };
+
+    CBOR_EncodeInt( &xEncoder, 0 );
+    CBOR_EncodeInt( &xEncoder, 23 );
+    CBOR_EncodeInt( &xEncoder, 24 );
+    CBOR_EncodeInt( &xEncoder, 255 );
+    CBOR_EncodeInt( &xEncoder, 256 );
+    CBOR_EncodeInt( &xEncoder, 65535 );
+    CBOR_EncodeInt( &xEncoder, 65536 );
+    CBOR_EncodeInt( &xEncoder, INT_MAX );
+
+    TEST_ASSERT_EQUAL( eCborErrNoError, CBOR_EncoderCheckError( &xEncoder ) );
+    TEST_ASSERT_EQUAL( sizeof( xExpected ), CBOR_EncoderSize( &xEncoder ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( xExpected, xBuffer, sizeof( xExpected ) );
+}
+
+TEST( aws_cbor_encoder, EncodeInt_writes_negative_integers )
+{
+    cbor_byte_t xExpected[] =
+    {
+        0x20,
+        0x37,
+        0x38, 0x18,
+        0x39, 0x01, 0x00,
+        0x3A, 0x7F, 0xFF, 0xFF, 0xFF,
+    };
+
+    CBOR_EncodeInt( &xEncoder, -1 );
+    CBOR_EncodeInt( &xEncoder, -24 );
+    CBOR_EncodeInt( &xEncoder, -25 );
+    CBOR_EncodeInt( &xEncoder, -257 );
+    CBOR_EncodeInt( &xEncoder, INT_MIN );
+
+    TEST_ASSERT_EQUAL( sizeof( xExpected ), CBOR_EncoderSize( &xEncoder ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( xExpected, xBuffer, sizeof( xExpected ) );
+}
+
+TEST( aws_cbor_encoder, EncodeString_writes_length_and_text )
+{
+    char * pcLong = "abcdefghijklmnopqrstuvwxyz";
+    cbor_byte_t xExpected[ 2 + 1 + 2 + 26 ] = { 0x61, 'a', 0x60, 0x78, 26 };
+
+    memcpy( &xExpected[ 5 ], pcLong, 26 );
+
+    CBOR_EncodeString( &xEncoder, "a" );
+    CBOR_EncodeString( &xEncoder, "" );
+    CBOR_EncodeString( &xEncoder, pcLong );
+
+    TEST_ASSERT_EQUAL( sizeof( xExpected ), CBOR_EncoderSize( &xEncoder ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( xExpected, xBuffer, sizeof( xExpected ) );
+}
+
+TEST( aws_cbor_encoder, EncodeArray_writes_definite_length )
+{
+    cbor_byte_t xExpected[] = { 0x83, 0x01, 0x02, 0x03 };
+
+    CBOR_EncodeArray( &xEncoder, 3 );
+    CBOR_EncodeInt( &xEncoder, 1 );
+    CBOR_EncodeInt( &xEncoder, 2 );
+    CBOR_EncodeInt( &xEncoder, 3 );
+
+    TEST_ASSERT_EQUAL( sizeof( xExpected ), CBOR_EncoderSize( &xEncoder ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( xExpected, xBuffer, sizeof( xExpected ) );
+}
+
+TEST( aws_cbor_encoder, EncodeKey_writes_nested_definite_maps )
+{
+    /* {"answer":42,"map":{"direction":"north"}} */
+    cbor_byte_t xExpected[] =
+    {
+        0xA2,
+        0x66, 'a', 'n', 's', 'w', 'e', 'r',
+        0x18, 0x2A,
+        0x63, 'm', 'a', 'p',
+        0xA1,
+        0x69, 'd', 'i', 'r', 'e', 'c', 't', 'i', 'o', 'n',
+        0x65, 'n', 'o', 'r', 't', 'h',
+    };
+
+    CBOR_EncodeMap( &xEncoder, 2 );
+    CBOR_EncodeKeyWithInt( &xEncoder, "answer", 42 );
+    CBOR_EncodeKeyWithMap( &xEncoder, "map", 1 );
+    CBOR_EncodeKeyWithString( &xEncoder, "direction", "north" );
+
+    TEST_ASSERT_EQUAL( eCborErrNoError, CBOR_EncoderCheckError( &xEncoder ) );
+    TEST_ASSERT_EQUAL( sizeof( xExpected ), CBOR_EncoderSize( &xEncoder ) );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( xExpected, xBuffer, sizeof( xExpected ) );
+}
+
+TEST( aws_cbor_encoder, sizing_pass_matches_written_size )
+{
+    CBOREncoder_t xSizer;
+
+    CBOR_EncoderInit( &xSizer, NULL, 0 );
+    CBOR_EncodeMap( &xSizer, 2 );
+    CBOR_EncodeKeyWithString( &xSizer, "model", "of the modern major general" );
+    CBOR_EncodeKeyWithInt( &xSizer, "prime", 1033 );
+
+    CBOR_EncodeMap( &xEncoder, 2 );
+    CBOR_EncodeKeyWithString( &xEncoder, "model", "of the modern major general" );
+    CBOR_EncodeKeyWithInt( &xEncoder, "prime", 1033 );
+
+    TEST_ASSERT_EQUAL( eCborErrNoError, CBOR_EncoderCheckError( &xSizer ) );
+    TEST_ASSERT_EQUAL( CBOR_EncoderSize( &xEncoder ), CBOR_EncoderSize( &xSizer ) );
+}
+
+TEST( aws_cbor_encoder, insufficient_space_stops_writing_and_keeps_counting )
+{
+    cbor_byte_t xSmall[ 5 ] = { 0 };
+
+    CBOR_EncoderInit( &xEncoder, xSmall, 4 );
+    CBOR_EncodeMap( &xEncoder, 1 );
+    CBOR_EncodeKeyWithString( &xEncoder, "hello", "world" );
+
+    TEST_ASSERT_EQUAL( eCborErrInsufficentSpace, CBOR_EncoderCheckError( &xEncoder ) );
+    TEST_ASSERT_EQUAL( 13, CBOR_EncoderSize( &xEncoder ) );
+    /* Nothing is written past the end of the buffer */
+    TEST_ASSERT_EQUAL_HEX8( 0xA1, xSmall[ 0 ] );
+    TEST_ASSERT_EQUAL_HEX8( 0x00, xSmall[ 4 ] );
+}
+
+TEST( aws_cbor_encoder, EncodeKey_sets_err_when_given_null_key )
+{
+    CBOR_EncodeKeyWithInt( &xEncoder, NULL, 1 );
+    TEST_ASSERT_EQUAL( eCborErrNullKey, CBOR_EncoderCheckError( &xEncoder ) );
+
+    CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+    CBOR_EncodeKeyWithString( &xEncoder, NULL, "value" );
+    TEST_ASSERT_EQUAL( eCborErrNullKey, CBOR_EncoderCheckError( &xEncoder ) );
+
+    CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+    CBOR_EncodeKeyWithMap( &xEncoder, NULL, 1 );
+    TEST_ASSERT_EQUAL( eCborErrNullKey, CBOR_EncoderCheckError( &xEncoder ) );
+    TEST_ASSERT_EQUAL( 0, CBOR_EncoderSize( &xEncoder ) );
+}
+
+TEST( aws_cbor_encoder, EncodeKeyWithString_sets_err_when_given_null_value )
+{
+    CBOR_EncodeKeyWithString( &xEncoder, "key", NULL );
+    TEST_ASSERT_EQUAL( eCborErrNullValue, CBOR_EncoderCheckError( &xEncoder ) );
+
+    CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+    CBOR_EncodeString( &xEncoder, NULL );
+    TEST_ASSERT_EQUAL( eCborErrNullValue, CBOR_EncoderCheckError( &xEncoder ) );
+}
+
+TEST( aws_cbor_encoder, EncodeMap_sets_err_when_count_is_negative )
+{
+    CBOR_EncodeMap( &xEncoder, -1 );
+    TEST_ASSERT_EQUAL(
+        eCborErrUnsupportedWriteOperation, CBOR_EncoderCheckError( &xEncoder ) );
+
+    CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+    CBOR_EncodeArray( &xEncoder, -1 );
+    TEST_ASSERT_EQUAL(
+        eCborErrUnsupportedWriteOperation, CBOR_EncoderCheckError( &xEncoder ) );
+}
+
+TEST( aws_cbor_encoder, functions_ignore_null_encoder )
+{
+    CBOR_EncoderInit( NULL, xBuffer, sizeof( xBuffer ) );
+    CBOR_EncodeMap( NULL, 1 );
+    CBOR_EncodeArray( NULL, 1 );
+    CBOR_EncodeInt( NULL, 1 );
+    CBOR_EncodeString( NULL, "value" );
+    CBOR_EncodeKeyWithInt( NULL, "key", 1 );
+    CBOR_EncodeKeyWithString( NULL, "key", "value" );
+    CBOR_EncodeKeyWithMap( NULL, "key", 1 );
+
+    TEST_ASSERT_EQUAL( eCborErrNullHandle, CBOR_EncoderCheckError( NULL ) );
+    TEST_ASSERT_EQUAL( 0, CBOR_EncoderSize( NULL ) );
+}
@@ -29,6 +29,8 @@ static void runAllTests()
     RUN_TEST_GROUP(aws_cbor);
     RUN_TEST_GROUP(aws_cbor_acceptance);
     RUN_TEST_GROUP(aws_cbor_alloc);
+    RUN_TEST_GROUP(aws_cbor_benchmark);
+    RUN_TEST_GROUP(aws_cbor_encoder);
     RUN_TEST_GROUP(aws_cbor_int);
     RUN_TEST_GROUP(aws_cbor_iter);
     RUN_TEST_GROUP(aws_cbor_map);
@@ -27,7 +27,10 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "FreeRTOSIPConfig.h"
+#include "task.h"
 #include "aws_crypto.h"
+#include "aws_crypto_config.h"
+#include "aws_crypto_config_defaults.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/config.h"
@@ -35,6 +38,7 @@
 #include "mbedtls/sha256.h"
 #include "mbedtls/sha1.h"
 #include "mbedtls/pk.h"
+#include "mbedtls/ecp.h"
 #include "mbedtls/x509_crt.h"
 
 /* C runtime includes. */
@@ -51,6 +55,28 @@ typedef struct SignatureVerificationState
     mbedtls_sha256_context xSHA256Context;
 } SignatureVerificationState_t, * SignatureVerificationStatePtr_t;
 
+#if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 )
+
+/**
+ * @brief A parsed signer public key.
+ */
+    typedef struct SignerKey
+    {
+        char * pcName;            /**< Cache key, NULL if the entry is free. */
+        mbedtls_pk_context xKey;  /**< Public key of the signer certificate. */
+        UBaseType_t uxUsers;      /**< Verifications using xKey. */
+        BaseType_t xStale;        /**< Flushed while in use, freed by the last user. */
+        uint32_t ulLastUse;       /**< Value of ulSignerKeyClock at the last lookup. */
+    } SignerKey_t;
+
+/**
+ * @brief The signer key cache. Entries are only changed with the scheduler
+ * suspended, and keys are parsed and freed outside of it.
+ */
+    static SignerKey_t xSignerKeys[ cryptoconfigSIGNER_KEY_CACHE_SIZE ];
+    static uint32_t ulSignerKeyClock;
+#endif
+
 /*
  * Helper routines
  */
@@ -134,6 +160,238 @@ static BaseType_t prvVerifySignature( char * pcSignerCertificate,
     return xResult;
 }
 
+/**
+ * @brief Finishes the hash of a signature verification context.
+ */
+static size_t prvFinishHash( SignatureVerificationStatePtr_t pxCtx,
+                             uint8_t * pucHash )
+{
+    size_t xHashLength;
+
+    if( cryptoHASH_ALGORITHM_SHA1 == pxCtx->xHashAlgorithm )
+    {
+        ( void ) mbedtls_sha1_finish_ret( &pxCtx->xSHA1Context, pucHash );
+        xHashLength = cryptoSHA1_DIGEST_BYTES;
+    }
+    else
+    {
+        ( void ) mbedtls_sha256_finish_ret( &pxCtx->xSHA256Context, pucHash );
+        xHashLength = cryptoSHA256_DIGEST_BYTES;
+    }
+
+    return xHashLength;
+}
+
+#if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 )
+
+/**
+ * @brief Frees the name and key of a signer key moved out of the cache.
+ */
+    static void prvSignerKeyFree( SignerKey_t * pxSignerKey )
+    {
+        if( NULL != pxSignerKey->pcName )
+        {
+            vPortFree( pxSignerKey->pcName );
+            mbedtls_pk_free( &pxSignerKey->xKey );
+            pxSignerKey->pcName = NULL;
+        }
+    }
+
+/**
+ * @brief Prepares a key for concurrent verifications.
+ *
+ * mbedTLS computes the table of multiples of the base point of a curve on its
+ * first use and stores it in the key. Do it now, before the key is shared.
+ */
+    static void prvSignerKeyPrepare( mbedtls_pk_context * pxKey )
+    {
+        mbedtls_ecp_keypair * pxKeyPair;
+        mbedtls_ecp_point xPoint;
+        mbedtls_mpi xOne;
+
+        if( 0 != mbedtls_pk_can_do( pxKey, MBEDTLS_PK_ECKEY ) )
+        {
+            pxKeyPair = mbedtls_pk_ec( *pxKey );
+            mbedtls_ecp_point_init( &xPoint );
+            mbedtls_mpi_init( &xOne );
+
+            if( 0 == mbedtls_mpi_lset( &xOne, 1 ) )
+            {
+                ( void ) mbedtls_ecp_mul( &pxKeyPair->grp, &xPoint, &xOne, &pxKeyPair->grp.G, NULL, NULL );
+            }
+
+            mbedtls_mpi_free( &xOne );
+            mbedtls_ecp_point_free( &xPoint );
+        }
+    }
+
+/**
+ * @brief Finds a signer key and marks it in use. Called with the scheduler
+ * suspended.
+ */
+    static SignerKey_t * prvSignerKeyFind( const char * pcName )
+    {
+        SignerKey_t * pxFound = NULL;
+        UBaseType_t uxIndex;
+
+        for( uxIndex = 0; uxIndex < ( UBaseType_t ) cryptoconfigSIGNER_KEY_CACHE_SIZE; uxIndex++ )
+        {
+            if( ( NULL != xSignerKeys[ uxIndex ].pcName ) &&
+                ( pdFALSE == xSignerKeys[ uxIndex ].xStale ) &&
+                ( 0 == strcmp( xSignerKeys[ uxIndex ].pcName, pcName ) ) )
+            {
+                pxFound = &xSignerKeys[ uxIndex ];
+                pxFound->uxUsers++;
+                pxFound->ulLastUse = ++ulSignerKeyClock;
+                break;
+            }
+        }
+
+        return pxFound;
+    }
+
+/**
+ * @brief Reads and parses a signer certificate, then caches its key.
+ *
+ * @param[out] pxLocal Holds the key if it cannot be cached.
+ *
+ * @return The key marked in use, pxLocal, or NULL on failure.
+ */
+    static SignerKey_t * prvSignerKeyLoad( const uint8_t * pucSignerName,
+                                           CRYPTO_ReadSignerCertificate_t xReadCertificate,
+                                           SignerKey_t * pxLocal )
+    {
+        SignerKey_t * pxSignerKey = NULL;
+        SignerKey_t * pxVictim = NULL;
+        SignerKey_t xEvicted = { 0 };
+        mbedtls_x509_crt xCertCtx;
+        uint8_t * pucCertificate = NULL;
+        uint32_t ulCertificateSize = 0;
+        size_t xNameLength = strlen( ( const char * ) pucSignerName );
+        UBaseType_t uxIndex;
+
+        memset( pxLocal, 0, sizeof( SignerKey_t ) );
+
+        if( NULL != xReadCertificate )
+        {
+            pucCertificate = xReadCertificate( pucSignerName, &ulCertificateSize );
+        }
+
+        if( NULL != pucCertificate )
+        {
+            mbedtls_x509_crt_init( &xCertCtx );
+
+            if( 0 == mbedtls_x509_crt_parse( &xCertCtx, pucCertificate, ulCertificateSize ) )
+            {
+                pxLocal->pcName = pvPortMalloc( xNameLength + 1U );
+
+                if( NULL != pxLocal->pcName )
+                {
+                    memcpy( pxLocal->pcName, pucSignerName, xNameLength + 1U );
+
+                    /* Keep the key, free the rest of the certificate. */
+                    pxLocal->xKey = xCertCtx.pk;
+                    mbedtls_pk_init( &xCertCtx.pk );
+                    prvSignerKeyPrepare( &pxLocal->xKey );
+                    pxSignerKey = pxLocal;
+                }
+            }
+
+            mbedtls_x509_crt_free( &xCertCtx );
+            vPortFree( pucCertificate );
+        }
+
+        if( NULL != pxSignerKey )
+        {
+            vTaskSuspendAll();
+            {
+                /* Another task may have loaded the same signer meanwhile. */
+                pxSignerKey = prvSignerKeyFind( pxLocal->pcName );
+
+                if( NULL == pxSignerKey )
+                {
+                    /* Use a free entry, or else replace the least recently
+                     * used key which is not in use. */
+                    for( uxIndex = 0; uxIndex < ( UBaseType_t ) cryptoconfigSIGNER_KEY_CACHE_SIZE; uxIndex++ )
+                    {
+                        if( NULL == xSignerKeys[ uxIndex ].pcName )
+                        {
+                            pxVictim = &xSignerKeys[ uxIndex ];
+                            break;
+                        }
+                        else if( ( 0U == xSignerKeys[ uxIndex ].uxUsers ) &&
+                                 ( ( NULL == pxVictim ) || ( xSignerKeys[ uxIndex ].ulLastUse < pxVictim->ulLastUse ) ) )
+                        {
+                            pxVictim = &xSignerKeys[ uxIndex ];
+                        }
+                        else
+                        {
+                            /* In use. */
+                        }
+                    }
+
+                    if( NULL != pxVictim )
+                    {
+                        xEvicted = *pxVictim;
+                        *pxVictim = *pxLocal;
+                        pxVictim->uxUsers = 1;
+                        pxVictim->ulLastUse = ++ulSignerKeyClock;
+                        pxLocal->pcName = NULL;
+                        pxSignerKey = pxVictim;
+                    }
+                    else
+                    {
+                        /* Every key is in use, verify with the local one. */
+                        pxSignerKey = pxLocal;
+                    }
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            prvSignerKeyFree( &xEvicted );
+
+            if( pxSignerKey != pxLocal )
+            {
+                prvSignerKeyFree( pxLocal );
+            }
+        }
+
+        return pxSignerKey;
+    }
+
+/**
+ * @brief Ends the use of a key returned by prvSignerKeyFind() or
+ * prvSignerKeyLoad().
+ */
+    static void prvSignerKeyRelease( SignerKey_t * pxSignerKey,
+                                     SignerKey_t * pxLocal )
+    {
+        SignerKey_t xStale = { 0 };
+
+        if( pxSignerKey == pxLocal )
+        {
+            prvSignerKeyFree( pxLocal );
+        }
+        else
+        {
+            vTaskSuspendAll();
+            {
+                pxSignerKey->uxUsers--;
+
+                if( ( 0U == pxSignerKey->uxUsers ) && ( pdTRUE == pxSignerKey->xStale ) )
+                {
+                    xStale = *pxSignerKey;
+                    memset( pxSignerKey, 0, sizeof( SignerKey_t ) );
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            prvSignerKeyFree( &xStale );
+        }
+    }
+
+#endif /* if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 ) */
+
 /*
  * Interface routines
  */
@@ -280,3 +538,121 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
 	}
     return xResult;
 }
+
+/**
+ * @brief Performs signature verification on a cryptographic hash with the
+ * cached key of a named signer.
+ */
+BaseType_t CRYPTO_SignatureVerificationFinalCached( void * pvContext,
+                                                    const uint8_t * pucSignerName,
+                                                    CRYPTO_ReadSignerCertificate_t xReadCertificate,
+                                                    uint8_t * pucSignature,
+                                                    size_t xSignatureLength )
+{
+    BaseType_t xResult = pdFALSE;
+    SignatureVerificationStatePtr_t pxCtx = ( SignatureVerificationStatePtr_t ) pvContext; /*lint !e9087 Allow casting void* to other types. */
+    uint8_t ucSHA1or256[ cryptoSHA256_DIGEST_BYTES ];                                     /* Reserve enough space for the larger of SHA1 or SHA256 results. */
+    size_t xHashLength;
+
+    #if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 )
+        SignerKey_t xLocal;
+        SignerKey_t * pxSignerKey = NULL;
+    #else
+        uint8_t * pucCertificate = NULL;
+        uint32_t ulCertificateSize = 0;
+    #endif
+
+    if( NULL != pxCtx )
+    {
+        if( ( NULL != pucSignerName ) &&
+            ( NULL != pucSignature ) &&
+            ( xSignatureLength > 0UL ) )
+        {
+            xHashLength = prvFinishHash( pxCtx, ucSHA1or256 );
+
+            #if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 )
+                vTaskSuspendAll();
+                {
+                    pxSignerKey = prvSignerKeyFind( ( const char * ) pucSignerName );
+                }
+                ( void ) xTaskResumeAll();
+
+                if( NULL == pxSignerKey )
+                {
+                    pxSignerKey = prvSignerKeyLoad( pucSignerName, xReadCertificate, &xLocal );
+                }
+
+                if( NULL != pxSignerKey )
+                {
+                    if( 0 == mbedtls_pk_verify( &pxSignerKey->xKey,
+                                                ( cryptoHASH_ALGORITHM_SHA1 == pxCtx->xHashAlgorithm ) ? MBEDTLS_MD_SHA1 : MBEDTLS_MD_SHA256,
+                                                ucSHA1or256,
+                                                xHashLength,
+                                                pucSignature,
+                                                xSignatureLength ) )
+                    {
+                        xResult = pdTRUE;
+                    }
+
+                    prvSignerKeyRelease( pxSignerKey, &xLocal );
+                }
+            #else /* if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 ) */
+                if( NULL != xReadCertificate )
+                {
+                    pucCertificate = xReadCertificate( pucSignerName, &ulCertificateSize );
+                }
+
+                if( NULL != pucCertificate )
+                {
+                    xResult = prvVerifySignature( ( char * ) pucCertificate,
+                                                  ulCertificateSize,
+                                                  pxCtx->xHashAlgorithm,
+                                                  ucSHA1or256,
+                                                  xHashLength,
+                                                  pucSignature,
+                                                  xSignatureLength );
+                    vPortFree( pucCertificate );
+                }
+            #endif /* if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 ) */
+        }
+
+        vPortFree( pxCtx );
+    }
+
+    return xResult;
+}
+
+/**
+ * @brief Forgets the cached signer public keys.
+ */
+void CRYPTO_SignerKeyCacheFlush( void )
+{
+    #if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 )
+        SignerKey_t xFlushed;
+        UBaseType_t uxIndex;
+
+        for( uxIndex = 0; uxIndex < ( UBaseType_t ) cryptoconfigSIGNER_KEY_CACHE_SIZE; uxIndex++ )
+        {
+            memset( &xFlushed, 0, sizeof( xFlushed ) );
+
+            vTaskSuspendAll();
+            {
+                if( NULL != xSignerKeys[ uxIndex ].pcName )
+                {
+                    if( 0U == xSignerKeys[ uxIndex ].uxUsers )
+                    {
+                        xFlushed = xSignerKeys[ uxIndex ];
+                        memset( &xSignerKeys[ uxIndex ], 0, sizeof( SignerKey_t ) );
+                    }
+                    else
+                    {
+                        xSignerKeys[ uxIndex ].xStale = pdTRUE;
+                    }
+                }
+            }
+            ( void ) xTaskResumeAll();
+
+            prvSignerKeyFree( &xFlushed );
+        }
+    #endif /* if ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 ) */
+}
@@ -0,0 +1,672 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_ecp_p256_alt.c
+ * @brief P-256 point doubling and addition for MBEDTLS_ECP_INTERNAL_ALT.
+ *
+ * mbedTLS computes every field operation with its general bignum code,
+ * which allocates the result of each multiplication on the heap and reduces
+ * it in a second pass. Point doubling and mixed addition on P-256 are most
+ * of the time of an ECDSA signature or verification and of an ECDH
+ * exchange, so they are done here on fixed size field elements of eight
+ * 32-bit words, on the stack, with the NIST fast reduction. The formulas and
+ * the special cases are those of ecp_double_jac() and ecp_add_mixed() in
+ * library/ecp.c, so the results are the same numbers. The rest of the point
+ * multiplication, and every other curve, stay with mbedTLS.
+ *
+ * The field operations have no branches on their operands. The special
+ * cases of the point formulas branch as in mbedTLS, where they cannot
+ * happen on secret dependent inputs.
+ */
+
+#if !defined( MBEDTLS_CONFIG_FILE )
+    #include "mbedtls/config.h"
+#else
+    #include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined( MBEDTLS_ECP_C ) && defined( MBEDTLS_ECP_INTERNAL_ALT )
+
+#include <string.h>
+
+#include "mbedtls/ecp.h"
+
+/* ecp_internal.h only declares the Weierstrass hooks when ecp.c's curve type
+ * macro is set. */
+#define ECP_SHORTWEIERSTRASS
+#include "mbedtls/ecp_internal.h"
+
+/**
+ * @brief Number of 32-bit words of a field element, least significant
+ * first.
+ */
+#define p256WORDS    ( 8 )
+
+/**
+ * @brief Bytes and bits in an mbedTLS integer limb, as in bignum.c.
+ */
+#define ciL          ( sizeof( mbedtls_mpi_uint ) )
+#define biL          ( ciL << 3 )
+
+/**
+ * @brief p = 2^256 - 2^224 + 2^192 + 2^96 - 1.
+ */
+static const uint32_t ulP256[ p256WORDS ] =
+{
+    0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0x00000000U,
+    0x00000000U, 0x00000000U, 0x00000001U, 0xFFFFFFFFU
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA if ulMask is all ones, pulB if it is zero.
+ */
+static void prvSelect( uint32_t * pulR,
+                       const uint32_t * pulA,
+                       const uint32_t * pulB,
+                       uint32_t ulMask )
+{
+    uint32_t i;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        pulR[ i ] = ( pulA[ i ] & ulMask ) | ( pulB[ i ] & ~ulMask );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reduce a value below 2^256 + p, given as its low 256 bits and the
+ * carry out of them.
+ */
+static void prvReduceOnce( uint32_t * pulR,
+                           const uint32_t * pulA,
+                           uint32_t ulCarry )
+{
+    uint32_t ulDifference[ p256WORDS ];
+    int64_t llAcc = 0;
+    uint32_t ulBorrow;
+    uint32_t i;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        llAcc += ( int64_t ) pulA[ i ] - ulP256[ i ];
+        ulDifference[ i ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+    }
+
+    /* Subtract p if the value carried out or did not borrow. */
+    ulBorrow = ( uint32_t ) llAcc & 1U;
+    prvSelect( pulR, ulDifference, pulA, 0U - ( ulCarry | ( ulBorrow ^ 1U ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA + pulB mod p.
+ */
+static void prvAdd( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB )
+{
+    uint32_t ulSum[ p256WORDS ];
+    uint64_t ullAcc = 0;
+    uint32_t i;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        ullAcc += ( uint64_t ) pulA[ i ] + pulB[ i ];
+        ulSum[ i ] = ( uint32_t ) ullAcc;
+        ullAcc >>= 32;
+    }
+
+    prvReduceOnce( pulR, ulSum, ( uint32_t ) ullAcc );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA - pulB mod p.
+ */
+static void prvSub( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB )
+{
+    uint32_t ulDifference[ p256WORDS ];
+    int64_t llAcc = 0;
+    uint64_t ullAcc = 0;
+    uint32_t ulMask;
+    uint32_t i;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        llAcc += ( int64_t ) pulA[ i ] - pulB[ i ];
+        ulDifference[ i ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+    }
+
+    /* Add p back if the subtraction borrowed. */
+    ulMask = 0U - ( ( uint32_t ) llAcc & 1U );
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        ullAcc += ( uint64_t ) ulDifference[ i ] + ( ulP256[ i ] & ulMask );
+        pulR[ i ] = ( uint32_t ) ullAcc;
+        ullAcc >>= 32;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reduce a 512-bit product mod p.
+ *
+ * FIPS 186-4 D.2.3: with c the product in 32-bit words,
+ * c = s1 + 2 s2 + 2 s3 + s4 + s5 - s6 - s7 - s8 - s9 mod p. The sum is
+ * accumulated a word at a time with a signed carry, then the carry out of
+ * 256 bits is folded back twice using 2^256 = 2^224 - 2^192 - 2^96 + 1
+ * mod p. The first fold leaves a carry of at most one, the second none.
+ */
+static void prvReduce( uint32_t * pulR,
+                       const uint32_t * c )
+{
+    uint32_t ulT[ p256WORDS ];
+    int64_t llAcc;
+    int64_t llTop;
+    uint32_t ulPass;
+
+    llAcc = ( int64_t ) c[ 0 ] + c[ 8 ] + c[ 9 ] - c[ 11 ] - c[ 12 ] - c[ 13 ] - c[ 14 ];
+    ulT[ 0 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 1 ] + c[ 9 ] + c[ 10 ] - c[ 12 ] - c[ 13 ] - c[ 14 ] - c[ 15 ];
+    ulT[ 1 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 2 ] + c[ 10 ] + c[ 11 ] - c[ 13 ] - c[ 14 ] - c[ 15 ];
+    ulT[ 2 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 3 ] + 2 * ( int64_t ) c[ 11 ] + 2 * ( int64_t ) c[ 12 ] + c[ 13 ] - c[ 15 ] - c[ 8 ] - c[ 9 ];
+    ulT[ 3 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 4 ] + 2 * ( int64_t ) c[ 12 ] + 2 * ( int64_t ) c[ 13 ] + c[ 14 ] - c[ 9 ] - c[ 10 ];
+    ulT[ 4 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 5 ] + 2 * ( int64_t ) c[ 13 ] + 2 * ( int64_t ) c[ 14 ] + c[ 15 ] - c[ 10 ] - c[ 11 ];
+    ulT[ 5 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 6 ] + 3 * ( int64_t ) c[ 14 ] + 2 * ( int64_t ) c[ 15 ] + c[ 13 ] - c[ 8 ] - c[ 9 ];
+    ulT[ 6 ] = ( uint32_t ) llAcc;
+    llAcc >>= 32;
+    llAcc += ( int64_t ) c[ 7 ] + 3 * ( int64_t ) c[ 15 ] + c[ 8 ] - c[ 10 ] - c[ 11 ] - c[ 12 ] - c[ 13 ];
+    ulT[ 7 ] = ( uint32_t ) llAcc;
+    llTop = llAcc >> 32;
+
+    for( ulPass = 0; ulPass < 2; ulPass++ )
+    {
+        llAcc = ( int64_t ) ulT[ 0 ] + llTop;
+        ulT[ 0 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ulT[ 1 ];
+        ulT[ 1 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ulT[ 2 ];
+        ulT[ 2 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ( int64_t ) ulT[ 3 ] - llTop;
+        ulT[ 3 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ulT[ 4 ];
+        ulT[ 4 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ulT[ 5 ];
+        ulT[ 5 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ( int64_t ) ulT[ 6 ] - llTop;
+        ulT[ 6 ] = ( uint32_t ) llAcc;
+        llAcc >>= 32;
+        llAcc += ( int64_t ) ulT[ 7 ] + llTop;
+        ulT[ 7 ] = ( uint32_t ) llAcc;
+        llTop = llAcc >> 32;
+    }
+
+    /* Below 2^256, so below 2p. */
+    prvReduceOnce( pulR, ulT, 0 );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA * pulB mod p.
+ *
+ * Each step is a 32x32 multiplication plus two 32-bit words, which fits in
+ * 64 bits and is a single UMAAL on ARMv6 and later.
+ */
+static void prvMul( uint32_t * pulR,
+                    const uint32_t * pulA,
+                    const uint32_t * pulB )
+{
+    uint32_t ulProduct[ 2 * p256WORDS ] = { 0 };
+    uint64_t ullAcc;
+    uint32_t ulCarry;
+    uint32_t i;
+    uint32_t j;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        ulCarry = 0;
+
+        for( j = 0; j < p256WORDS; j++ )
+        {
+            ullAcc = ( uint64_t ) pulA[ i ] * pulB[ j ] + ulProduct[ i + j ] + ulCarry;
+            ulProduct[ i + j ] = ( uint32_t ) ullAcc;
+            ulCarry = ( uint32_t ) ( ullAcc >> 32 );
+        }
+
+        ulProduct[ i + p256WORDS ] = ulCarry;
+    }
+
+    prvReduce( pulR, ulProduct );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulR = pulA^2 mod p.
+ *
+ * The products of different words are computed once and doubled, 36
+ * multiplications instead of 64.
+ */
+static void prvSqr( uint32_t * pulR,
+                    const uint32_t * pulA )
+{
+    uint32_t ulProduct[ 2 * p256WORDS ] = { 0 };
+    uint64_t ullAcc;
+    uint64_t ullSquare;
+    uint32_t ulCarry;
+    uint32_t i;
+    uint32_t j;
+
+    for( i = 0; i < p256WORDS - 1; i++ )
+    {
+        ulCarry = 0;
+
+        for( j = i + 1; j < p256WORDS; j++ )
+        {
+            ullAcc = ( uint64_t ) pulA[ i ] * pulA[ j ] + ulProduct[ i + j ] + ulCarry;
+            ulProduct[ i + j ] = ( uint32_t ) ullAcc;
+            ulCarry = ( uint32_t ) ( ullAcc >> 32 );
+        }
+
+        ulProduct[ i + p256WORDS ] = ulCarry;
+    }
+
+    for( i = 2 * p256WORDS - 1; i > 0; i-- )
+    {
+        ulProduct[ i ] = ( ulProduct[ i ] << 1 ) | ( ulProduct[ i - 1 ] >> 31 );
+    }
+
+    ulProduct[ 0 ] <<= 1;
+
+    ullAcc = 0;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        ullSquare = ( uint64_t ) pulA[ i ] * pulA[ i ];
+        ullAcc += ( uint64_t ) ulProduct[ 2 * i ] + ( uint32_t ) ullSquare;
+        ulProduct[ 2 * i ] = ( uint32_t ) ullAcc;
+        ullAcc >>= 32;
+        ullAcc += ( uint64_t ) ulProduct[ 2 * i + 1 ] + ( uint32_t ) ( ullSquare >> 32 );
+        ulProduct[ 2 * i + 1 ] = ( uint32_t ) ullAcc;
+        ullAcc >>= 32;
+    }
+
+    prvReduce( pulR, ulProduct );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief pulA is zero.
+ */
+static int prvIsZero( const uint32_t * pulA )
+{
+    uint32_t ulBits = 0;
+    uint32_t i;
+
+    for( i = 0; i < p256WORDS; i++ )
+    {
+        ulBits |= pulA[ i ];
+    }
+
+    return ulBits == 0U;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read an mbedTLS integer as a field element, reducing it if it is
+ * not already in [0, p).
+ */
+static int prvReadElement( const mbedtls_ecp_group * pxGroup,
+                           uint32_t * pulR,
+                           const mbedtls_mpi * pxA )
+{
+    int lResult = 0;
+    mbedtls_mpi xReduced;
+    const mbedtls_mpi * pxSource = pxA;
+    size_t xBit;
+    size_t i;
+
+    mbedtls_mpi_init( &xReduced );
+
+    if( ( pxA->s < 0 ) || ( mbedtls_mpi_cmp_mpi( pxA, &pxGroup->P ) >= 0 ) )
+    {
+        lResult = mbedtls_mpi_mod_mpi( &xReduced, pxA, &pxGroup->P );
+        pxSource = &xReduced;
+    }
+
+    if( lResult == 0 )
+    {
+        for( i = 0; i < p256WORDS; i++ )
+        {
+            xBit = 32 * i;
+
+            if( xBit / biL < pxSource->n )
+            {
+                pulR[ i ] = ( uint32_t ) ( pxSource->p[ xBit / biL ] >> ( xBit % biL ) );
+            }
+            else
+            {
+                pulR[ i ] = 0;
+            }
+        }
+    }
+
+    mbedtls_mpi_free( &xReduced );
+
+    return lResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write a field element to an mbedTLS integer.
+ */
+static int prvWriteElement( mbedtls_mpi * pxR,
+                            const uint32_t * pulA )
+{
+    int lResult;
+    size_t xBit;
+    size_t i;
+
+    lResult = mbedtls_mpi_grow( pxR, ( 32 * p256WORDS ) / biL );
+
+    if( lResult == 0 )
+    {
+        memset( pxR->p, 0, pxR->n * ciL );
+
+        for( i = 0; i < p256WORDS; i++ )
+        {
+            xBit = 32 * i;
+            pxR->p[ xBit / biL ] |= ( mbedtls_mpi_uint ) pulA[ i ] << ( xBit % biL );
+        }
+
+        pxR->s = 1;
+    }
+
+    return lResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write a point in Jacobian coordinates.
+ */
+static int prvWritePoint( mbedtls_ecp_point * pxR,
+                          const uint32_t * pulX,
+                          const uint32_t * pulY,
+                          const uint32_t * pulZ )
+{
+    int lResult;
+
+    lResult = prvWriteElement( &pxR->X, pulX );
+
+    if( lResult == 0 )
+    {
+        lResult = prvWriteElement( &pxR->Y, pulY );
+    }
+
+    if( lResult == 0 )
+    {
+        lResult = prvWriteElement( &pxR->Z, pulZ );
+    }
+
+    return lResult;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief 2 (X, Y, Z), as ecp_double_jac() with A = -3.
+ */
+static void prvDouble( uint32_t * pulX,
+                       uint32_t * pulY,
+                       uint32_t * pulZ )
+{
+    uint32_t ulM[ p256WORDS ];
+    uint32_t ulS[ p256WORDS ];
+    uint32_t ulT[ p256WORDS ];
+    uint32_t ulU[ p256WORDS ];
+
+    /* M = 3(X + Z^2)(X - Z^2) */
+    prvSqr( ulS, pulZ );
+    prvAdd( ulT, pulX, ulS );
+    prvSub( ulU, pulX, ulS );
+    prvMul( ulS, ulT, ulU );
+    prvAdd( ulM, ulS, ulS );
+    prvAdd( ulM, ulM, ulS );
+
+    /* S = 4.X.Y^2 */
+    prvSqr( ulT, pulY );
+    prvAdd( ulT, ulT, ulT );
+    prvMul( ulS, pulX, ulT );
+    prvAdd( ulS, ulS, ulS );
+
+    /* U = 8.Y^4 */
+    prvSqr( ulU, ulT );
+    prvAdd( ulU, ulU, ulU );
+
+    /* Z = 2.Y.Z, before Y is overwritten. */
+    prvMul( pulZ, pulY, pulZ );
+    prvAdd( pulZ, pulZ, pulZ );
+
+    /* X = M^2 - 2.S */
+    prvSqr( ulT, ulM );
+    prvSub( ulT, ulT, ulS );
+    prvSub( pulX, ulT, ulS );
+
+    /* Y = M(S - X) - U */
+    prvSub( ulS, ulS, pulX );
+    prvMul( ulS, ulS, ulM );
+    prvSub( pulY, ulS, ulU );
+}
+/*-----------------------------------------------------------*/
+
+unsigned char mbedtls_internal_ecp_grp_capable( const mbedtls_ecp_group * grp )
+{
+    /* The formulas above are for A = -3, which is the case of P-256. */
+    return ( grp->id == MBEDTLS_ECP_DP_SECP256R1 ) ? 1 : 0;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_internal_ecp_init( const mbedtls_ecp_group * grp )
+{
+    ( void ) grp;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+void mbedtls_internal_ecp_free( const mbedtls_ecp_group * grp )
+{
+    ( void ) grp;
+}
+/*-----------------------------------------------------------*/
+
+#if defined( MBEDTLS_ECP_DOUBLE_JAC_ALT )
+
+    int mbedtls_internal_ecp_double_jac( const mbedtls_ecp_group * grp,
+                                         mbedtls_ecp_point * R,
+                                         const mbedtls_ecp_point * P )
+    {
+        int lResult;
+        uint32_t ulX[ p256WORDS ];
+        uint32_t ulY[ p256WORDS ];
+        uint32_t ulZ[ p256WORDS ];
+
+        lResult = prvReadElement( grp, ulX, &P->X );
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulY, &P->Y );
+        }
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulZ, &P->Z );
+        }
+
+        if( lResult == 0 )
+        {
+            prvDouble( ulX, ulY, ulZ );
+            lResult = prvWritePoint( R, ulX, ulY, ulZ );
+        }
+
+        return lResult;
+    }
+
+#endif /* MBEDTLS_ECP_DOUBLE_JAC_ALT */
+/*-----------------------------------------------------------*/
+
+#if defined( MBEDTLS_ECP_ADD_MIXED_ALT )
+
+    int mbedtls_internal_ecp_add_mixed( const mbedtls_ecp_group * grp,
+                                        mbedtls_ecp_point * R,
+                                        const mbedtls_ecp_point * P,
+                                        const mbedtls_ecp_point * Q )
+    {
+        int lResult;
+        uint32_t ulX1[ p256WORDS ];
+        uint32_t ulY1[ p256WORDS ];
+        uint32_t ulZ1[ p256WORDS ];
+        uint32_t ulX2[ p256WORDS ];
+        uint32_t ulY2[ p256WORDS ];
+        uint32_t ulT1[ p256WORDS ];
+        uint32_t ulT2[ p256WORDS ];
+        uint32_t ulT3[ p256WORDS ];
+        uint32_t ulT4[ p256WORDS ];
+
+        /* P or Q is zero. */
+        if( mbedtls_mpi_cmp_int( &P->Z, 0 ) == 0 )
+        {
+            return mbedtls_ecp_copy( R, Q );
+        }
+
+        if( ( Q->Z.p != NULL ) && ( mbedtls_mpi_cmp_int( &Q->Z, 0 ) == 0 ) )
+        {
+            return mbedtls_ecp_copy( R, P );
+        }
+
+        /* Q must be affine; an unset Z means 1. */
+        if( ( Q->Z.p != NULL ) && ( mbedtls_mpi_cmp_int( &Q->Z, 1 ) != 0 ) )
+        {
+            return MBEDTLS_ERR_ECP_BAD_INPUT_DATA;
+        }
+
+        /* R may be P or Q, so everything is read before anything is
+         * written. */
+        lResult = prvReadElement( grp, ulX1, &P->X );
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulY1, &P->Y );
+        }
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulZ1, &P->Z );
+        }
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulX2, &Q->X );
+        }
+
+        if( lResult == 0 )
+        {
+            lResult = prvReadElement( grp, ulY2, &Q->Y );
+        }
+
+        if( lResult != 0 )
+        {
+            return lResult;
+        }
+
+        /* T1 = Z1^2.X2 - X1, T2 = Z1^3.Y2 - Y1 */
+        prvSqr( ulT1, ulZ1 );
+        prvMul( ulT2, ulT1, ulZ1 );
+        prvMul( ulT1, ulT1, ulX2 );
+        prvMul( ulT2, ulT2, ulY2 );
+        prvSub( ulT1, ulT1, ulX1 );
+        prvSub( ulT2, ulT2, ulY1 );
+
+        /* P == Q, or P == -Q. */
+        if( prvIsZero( ulT1 ) )
+        {
+            if( prvIsZero( ulT2 ) )
+            {
+                prvDouble( ulX1, ulY1, ulZ1 );
+
+                return prvWritePoint( R, ulX1, ulY1, ulZ1 );
+            }
+
+            return mbedtls_ecp_set_zero( R );
+        }
+
+        /* Z = Z1.T1 */
+        prvMul( ulZ1, ulZ1, ulT1 );
+
+        /* X = T2^2 - 2.X1.T1^2 - T1^3 */
+        prvSqr( ulT3, ulT1 );
+        prvMul( ulT4, ulT3, ulT1 );
+        prvMul( ulT3, ulT3, ulX1 );
+        prvAdd( ulT1, ulT3, ulT3 );
+        prvSqr( ulX2, ulT2 );
+        prvSub( ulX2, ulX2, ulT1 );
+        prvSub( ulX2, ulX2, ulT4 );
+
+        /* Y = (X1.T1^2 - X).T2 - Y1.T1^3 */
+        prvSub( ulT3, ulT3, ulX2 );
+        prvMul( ulT3, ulT3, ulT2 );
+        prvMul( ulT4, ulT4, ulY1 );
+        prvSub( ulY2, ulT3, ulT4 );
+
+        return prvWritePoint( R, ulX2, ulY2, ulZ1 );
+    }
+
+#endif /* MBEDTLS_ECP_ADD_MIXED_ALT */
+
+#endif /* MBEDTLS_ECP_C && MBEDTLS_ECP_INTERNAL_ALT */
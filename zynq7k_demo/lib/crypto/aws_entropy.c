@@ -0,0 +1,144 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_entropy.c
+ * @brief Health tests and conditioning of a raw hardware noise source.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "aws_entropy.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/sha256.h"
+
+/*-----------------------------------------------------------*/
+
+void ENTROPY_HealthInit( EntropyHealth_t * pxHealth )
+{
+    configASSERT( pxHealth != NULL );
+
+    pxHealth->ucRctValue = 0;
+    pxHealth->ulRctCount = 0;
+    pxHealth->ucAptValue = 0;
+    pxHealth->ulAptCount = 0;
+    pxHealth->ulAptIndex = 0;
+    pxHealth->ulSamples = 0;
+    pxHealth->ulRctFailures = 0;
+    pxHealth->ulAptFailures = 0;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t ENTROPY_HealthTest( EntropyHealth_t * pxHealth,
+                               uint8_t ucSample )
+{
+    BaseType_t xStatus = pdPASS;
+
+    pxHealth->ulSamples++;
+
+    /* Repetition count test, a sample repeated entropyconfigRCT_CUTOFF
+     * times in a row is a stuck source. */
+    if( ( pxHealth->ulRctCount > 0UL ) && ( ucSample == pxHealth->ucRctValue ) )
+    {
+        pxHealth->ulRctCount++;
+
+        if( pxHealth->ulRctCount >= ( uint32_t ) entropyconfigRCT_CUTOFF )
+        {
+            pxHealth->ulRctFailures++;
+            pxHealth->ulRctCount = 0;
+            xStatus = pdFAIL;
+        }
+    }
+    else
+    {
+        pxHealth->ucRctValue = ucSample;
+        pxHealth->ulRctCount = 1;
+    }
+
+    /* Adaptive proportion test, the first sample of a window occurring
+     * entropyconfigAPT_CUTOFF times in the window is a loss of entropy. */
+    if( pxHealth->ulAptIndex == 0UL )
+    {
+        pxHealth->ucAptValue = ucSample;
+        pxHealth->ulAptCount = 1;
+    }
+    else if( ucSample == pxHealth->ucAptValue )
+    {
+        pxHealth->ulAptCount++;
+
+        if( pxHealth->ulAptCount >= ( uint32_t ) entropyconfigAPT_CUTOFF )
+        {
+            pxHealth->ulAptFailures++;
+            pxHealth->ulAptCount = 0;
+            xStatus = pdFAIL;
+        }
+    }
+
+    pxHealth->ulAptIndex++;
+
+    if( pxHealth->ulAptIndex >= ( uint32_t ) entropyconfigAPT_WINDOW )
+    {
+        pxHealth->ulAptIndex = 0;
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t ENTROPY_Condition( EntropyHealth_t * pxHealth,
+                              const uint8_t * pucSamples,
+                              uint8_t * pucOutput )
+{
+    BaseType_t xStatus = pdPASS;
+    uint32_t ulIndex;
+
+    configASSERT( pxHealth != NULL );
+    configASSERT( pucSamples != NULL );
+    configASSERT( pucOutput != NULL );
+
+    /* Every sample is tested, even after a failure, so that the failure
+     * counters describe the whole block. */
+    for( ulIndex = 0; ulIndex < ( uint32_t ) entropyconfigSAMPLES_PER_BLOCK; ulIndex++ )
+    {
+        if( ENTROPY_HealthTest( pxHealth, pucSamples[ ulIndex ] ) != pdPASS )
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        if( mbedtls_sha256_ret( pucSamples,
+                                ( size_t ) entropyconfigSAMPLES_PER_BLOCK,
+                                pucOutput,
+                                0 ) != 0 )
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+    return xStatus;
+}
@@ -0,0 +1,571 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_gcm_alt.c
+ * @brief mbedTLS GCM with 8-bit GHASH tables, for MBEDTLS_GCM_ALT.
+ *
+ * Same interface and behavior as library/gcm.c. The differences are in the
+ * inner loops:
+ * - GHASH multiplies by H one byte at a time with a 256 entry table, Shoup's
+ *   method with 8-bit instead of 4-bit windows, on 32-bit words instead of
+ *   the 64-bit words that a 32-bit core splits in two.
+ * - Full blocks are XORed with the key stream and absorbed into GHASH a word
+ *   at a time instead of a byte at a time.
+ *
+ * As with the mbedTLS tables, the table lookups depend on the data and on H.
+ */
+
+#if !defined( MBEDTLS_CONFIG_FILE )
+    #include "mbedtls/config.h"
+#else
+    #include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined( MBEDTLS_GCM_C ) && defined( MBEDTLS_GCM_ALT )
+
+#include <string.h>
+
+#include "mbedtls/gcm.h"
+#include "mbedtls/platform_util.h"
+
+/**
+ * @brief Load and store big-endian words.
+ */
+#define gcmGET_UINT32_BE( pucBytes )                    \
+    ( ( ( uint32_t ) ( pucBytes )[ 0 ] << 24 ) |        \
+      ( ( uint32_t ) ( pucBytes )[ 1 ] << 16 ) |        \
+      ( ( uint32_t ) ( pucBytes )[ 2 ] << 8 ) |         \
+      ( ( uint32_t ) ( pucBytes )[ 3 ] ) )
+
+#define gcmPUT_UINT32_BE( ulWord, pucBytes )                   \
+    do {                                                       \
+        ( pucBytes )[ 0 ] = ( unsigned char ) ( ( ulWord ) >> 24 ); \
+        ( pucBytes )[ 1 ] = ( unsigned char ) ( ( ulWord ) >> 16 ); \
+        ( pucBytes )[ 2 ] = ( unsigned char ) ( ( ulWord ) >> 8 );  \
+        ( pucBytes )[ 3 ] = ( unsigned char ) ( ulWord );           \
+    } while( 0 )
+
+/**
+ * @brief The reduction of the 8 bits shifted out of the accumulator:
+ * usLast8[ x ] is x times P^128, in the top 16 bits of a field element.
+ * The 4-bit table of library/gcm.c is every 16th entry.
+ */
+static const uint16_t usLast8[ 256 ] =
+{
+    0x0000, 0x01C2, 0x0384, 0x0246, 0x0708, 0x06CA, 0x048C, 0x054E,
+    0x0E10, 0x0FD2, 0x0D94, 0x0C56, 0x0918, 0x08DA, 0x0A9C, 0x0B5E,
+    0x1C20, 0x1DE2, 0x1FA4, 0x1E66, 0x1B28, 0x1AEA, 0x18AC, 0x196E,
+    0x1230, 0x13F2, 0x11B4, 0x1076, 0x1538, 0x14FA, 0x16BC, 0x177E,
+    0x3840, 0x3982, 0x3BC4, 0x3A06, 0x3F48, 0x3E8A, 0x3CCC, 0x3D0E,
+    0x3650, 0x3792, 0x35D4, 0x3416, 0x3158, 0x309A, 0x32DC, 0x331E,
+    0x2460, 0x25A2, 0x27E4, 0x2626, 0x2368, 0x22AA, 0x20EC, 0x212E,
+    0x2A70, 0x2BB2, 0x29F4, 0x2836, 0x2D78, 0x2CBA, 0x2EFC, 0x2F3E,
+    0x7080, 0x7142, 0x7304, 0x72C6, 0x7788, 0x764A, 0x740C, 0x75CE,
+    0x7E90, 0x7F52, 0x7D14, 0x7CD6, 0x7998, 0x785A, 0x7A1C, 0x7BDE,
+    0x6CA0, 0x6D62, 0x6F24, 0x6EE6, 0x6BA8, 0x6A6A, 0x682C, 0x69EE,
+    0x62B0, 0x6372, 0x6134, 0x60F6, 0x65B8, 0x647A, 0x663C, 0x67FE,
+    0x48C0, 0x4902, 0x4B44, 0x4A86, 0x4FC8, 0x4E0A, 0x4C4C, 0x4D8E,
+    0x46D0, 0x4712, 0x4554, 0x4496, 0x41D8, 0x401A, 0x425C, 0x439E,
+    0x54E0, 0x5522, 0x5764, 0x56A6, 0x53E8, 0x522A, 0x506C, 0x51AE,
+    0x5AF0, 0x5B32, 0x5974, 0x58B6, 0x5DF8, 0x5C3A, 0x5E7C, 0x5FBE,
+    0xE100, 0xE0C2, 0xE284, 0xE346, 0xE608, 0xE7CA, 0xE58C, 0xE44E,
+    0xEF10, 0xEED2, 0xEC94, 0xED56, 0xE818, 0xE9DA, 0xEB9C, 0xEA5E,
+    0xFD20, 0xFCE2, 0xFEA4, 0xFF66, 0xFA28, 0xFBEA, 0xF9AC, 0xF86E,
+    0xF330, 0xF2F2, 0xF0B4, 0xF176, 0xF438, 0xF5FA, 0xF7BC, 0xF67E,
+    0xD940, 0xD882, 0xDAC4, 0xDB06, 0xDE48, 0xDF8A, 0xDDCC, 0xDC0E,
+    0xD750, 0xD692, 0xD4D4, 0xD516, 0xD058, 0xD19A, 0xD3DC, 0xD21E,
+    0xC560, 0xC4A2, 0xC6E4, 0xC726, 0xC268, 0xC3AA, 0xC1EC, 0xC02E,
+    0xCB70, 0xCAB2, 0xC8F4, 0xC936, 0xCC78, 0xCDBA, 0xCFFC, 0xCE3E,
+    0x9180, 0x9042, 0x9204, 0x93C6, 0x9688, 0x974A, 0x950C, 0x94CE,
+    0x9F90, 0x9E52, 0x9C14, 0x9DD6, 0x9898, 0x995A, 0x9B1C, 0x9ADE,
+    0x8DA0, 0x8C62, 0x8E24, 0x8FE6, 0x8AA8, 0x8B6A, 0x892C, 0x88EE,
+    0x83B0, 0x8272, 0x8034, 0x81F6, 0x84B8, 0x857A, 0x873C, 0x86FE,
+    0xA9C0, 0xA802, 0xAA44, 0xAB86, 0xAEC8, 0xAF0A, 0xAD4C, 0xAC8E,
+    0xA7D0, 0xA612, 0xA454, 0xA596, 0xA0D8, 0xA11A, 0xA35C, 0xA29E,
+    0xB5E0, 0xB422, 0xB664, 0xB7A6, 0xB2E8, 0xB32A, 0xB16C, 0xB0AE,
+    0xBBF0, 0xBA32, 0xB874, 0xB9B6, 0xBCF8, 0xBD3A, 0xBF7C, 0xBEBE,
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Set pulX to pulX times H.
+ *
+ * Field elements are four big-endian words, the most significant bit of the
+ * first word being the coefficient of P^0 as in the GCM specification.
+ */
+static void prvGhashMult( const mbedtls_gcm_context * pxCtx,
+                          uint32_t * pulX )
+{
+    const uint32_t * pulEntry;
+    uint32_t ulZ0, ulZ1, ulZ2, ulZ3;
+    uint32_t ulRem;
+    int32_t lByte;
+    uint32_t ulIndex;
+
+    pulEntry = pxCtx->HTable[ pulX[ 3 ] & 0xFFU ];
+    ulZ0 = pulEntry[ 0 ];
+    ulZ1 = pulEntry[ 1 ];
+    ulZ2 = pulEntry[ 2 ];
+    ulZ3 = pulEntry[ 3 ];
+
+    /* Horner's rule over the bytes, from the last one. */
+    for( lByte = 14; lByte >= 0; lByte-- )
+    {
+        ulRem = ulZ3 & 0xFFU;
+        ulZ3 = ( ulZ3 >> 8 ) | ( ulZ2 << 24 );
+        ulZ2 = ( ulZ2 >> 8 ) | ( ulZ1 << 24 );
+        ulZ1 = ( ulZ1 >> 8 ) | ( ulZ0 << 24 );
+        ulZ0 = ( ulZ0 >> 8 ) ^ ( ( uint32_t ) usLast8[ ulRem ] << 16 );
+
+        ulIndex = ( pulX[ lByte >> 2 ] >> ( 24 - ( 8 * ( lByte & 3 ) ) ) ) & 0xFFU;
+        pulEntry = pxCtx->HTable[ ulIndex ];
+        ulZ0 ^= pulEntry[ 0 ];
+        ulZ1 ^= pulEntry[ 1 ];
+        ulZ2 ^= pulEntry[ 2 ];
+        ulZ3 ^= pulEntry[ 3 ];
+    }
+
+    pulX[ 0 ] = ulZ0;
+    pulX[ 1 ] = ulZ1;
+    pulX[ 2 ] = ulZ2;
+    pulX[ 3 ] = ulZ3;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief XOR up to 16 bytes into the GHASH accumulator and multiply by H.
+ */
+static void prvGhashUpdate( mbedtls_gcm_context * pxCtx,
+                            const unsigned char * pucData,
+                            size_t xLength )
+{
+    unsigned char ucBlock[ 16 ];
+
+    if( xLength == 16 )
+    {
+        pxCtx->buf[ 0 ] ^= gcmGET_UINT32_BE( &pucData[ 0 ] );
+        pxCtx->buf[ 1 ] ^= gcmGET_UINT32_BE( &pucData[ 4 ] );
+        pxCtx->buf[ 2 ] ^= gcmGET_UINT32_BE( &pucData[ 8 ] );
+        pxCtx->buf[ 3 ] ^= gcmGET_UINT32_BE( &pucData[ 12 ] );
+    }
+    else
+    {
+        /* A partial block is padded with zeros. */
+        memset( ucBlock, 0, sizeof( ucBlock ) );
+        memcpy( ucBlock, pucData, xLength );
+        pxCtx->buf[ 0 ] ^= gcmGET_UINT32_BE( &ucBlock[ 0 ] );
+        pxCtx->buf[ 1 ] ^= gcmGET_UINT32_BE( &ucBlock[ 4 ] );
+        pxCtx->buf[ 2 ] ^= gcmGET_UINT32_BE( &ucBlock[ 8 ] );
+        pxCtx->buf[ 3 ] ^= gcmGET_UINT32_BE( &ucBlock[ 12 ] );
+    }
+
+    prvGhashMult( pxCtx, pxCtx->buf );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compute the multiples of H.
+ *
+ * HTable[ 128 ] is H, the byte 0x80 being P^0. The entries of single bits
+ * are H times P^k, a shift right with reduction, and the others are sums
+ * of those.
+ */
+static int prvGenerateTable( mbedtls_gcm_context * pxCtx )
+{
+    unsigned char ucH[ 16 ] = { 0 };
+    size_t xOutputLength = 0;
+    uint32_t ulCarry;
+    uint32_t ulBit;
+    uint32_t i;
+    uint32_t j;
+    int iResult;
+
+    iResult = mbedtls_cipher_update( &pxCtx->cipher_ctx, ucH, 16, ucH, &xOutputLength );
+
+    if( iResult == 0 )
+    {
+        memset( pxCtx->HTable[ 0 ], 0, sizeof( pxCtx->HTable[ 0 ] ) );
+
+        for( j = 0; j < 4; j++ )
+        {
+            pxCtx->HTable[ 128 ][ j ] = gcmGET_UINT32_BE( &ucH[ 4 * j ] );
+        }
+
+        for( ulBit = 64; ulBit > 0; ulBit >>= 1 )
+        {
+            const uint32_t * pulPrevious = pxCtx->HTable[ ulBit << 1 ];
+            uint32_t * pulEntry = pxCtx->HTable[ ulBit ];
+
+            ulCarry = pulPrevious[ 3 ] & 1U;
+            pulEntry[ 3 ] = ( pulPrevious[ 3 ] >> 1 ) | ( pulPrevious[ 2 ] << 31 );
+            pulEntry[ 2 ] = ( pulPrevious[ 2 ] >> 1 ) | ( pulPrevious[ 1 ] << 31 );
+            pulEntry[ 1 ] = ( pulPrevious[ 1 ] >> 1 ) | ( pulPrevious[ 0 ] << 31 );
+            pulEntry[ 0 ] = ( pulPrevious[ 0 ] >> 1 ) ^ ( ulCarry * 0xE1000000U );
+        }
+
+        for( ulBit = 2; ulBit <= 128; ulBit <<= 1 )
+        {
+            for( i = 1; i < ulBit; i++ )
+            {
+                for( j = 0; j < 4; j++ )
+                {
+                    pxCtx->HTable[ ulBit + i ][ j ] = pxCtx->HTable[ ulBit ][ j ] ^ pxCtx->HTable[ i ][ j ];
+                }
+            }
+        }
+    }
+
+    mbedtls_platform_zeroize( ucH, sizeof( ucH ) );
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+void mbedtls_gcm_init( mbedtls_gcm_context * ctx )
+{
+    memset( ctx, 0, sizeof( mbedtls_gcm_context ) );
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_setkey( mbedtls_gcm_context * ctx,
+                        mbedtls_cipher_id_t cipher,
+                        const unsigned char * key,
+                        unsigned int keybits )
+{
+    const mbedtls_cipher_info_t * pxCipherInfo;
+    int iResult;
+
+    pxCipherInfo = mbedtls_cipher_info_from_values( cipher, ( int ) keybits, MBEDTLS_MODE_ECB );
+
+    if( ( pxCipherInfo == NULL ) || ( pxCipherInfo->block_size != 16 ) )
+    {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+
+    mbedtls_cipher_free( &ctx->cipher_ctx );
+
+    iResult = mbedtls_cipher_setup( &ctx->cipher_ctx, pxCipherInfo );
+
+    if( iResult == 0 )
+    {
+        iResult = mbedtls_cipher_setkey( &ctx->cipher_ctx, key, ( int ) keybits, MBEDTLS_ENCRYPT );
+    }
+
+    if( iResult == 0 )
+    {
+        iResult = prvGenerateTable( ctx );
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_starts( mbedtls_gcm_context * ctx,
+                        int mode,
+                        const unsigned char * iv,
+                        size_t iv_len,
+                        const unsigned char * add,
+                        size_t add_len )
+{
+    unsigned char ucLengthBlock[ 16 ] = { 0 };
+    uint64_t ullIvBits = ( uint64_t ) iv_len * 8U;
+    size_t xOutputLength = 0;
+    size_t xUseLength;
+    uint32_t j;
+    int iResult;
+
+    /* The IV and the additional data are limited to 2^64 bits, and the IV
+     * must not be empty. */
+    if( ( iv_len == 0 ) ||
+        ( ( ( uint64_t ) iv_len ) >> 61 != 0 ) ||
+        ( ( ( uint64_t ) add_len ) >> 61 != 0 ) )
+    {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+
+    memset( ctx->y, 0, sizeof( ctx->y ) );
+    memset( ctx->buf, 0, sizeof( ctx->buf ) );
+
+    ctx->mode = mode;
+    ctx->len = 0;
+    ctx->add_len = add_len;
+
+    if( iv_len == 12 )
+    {
+        memcpy( ctx->y, iv, iv_len );
+        ctx->y[ 15 ] = 1;
+    }
+    else
+    {
+        /* The counter block is GHASH( IV || 0 || [ len( IV ) ]64 ). The
+         * accumulator is free until the additional data. */
+        while( iv_len > 0 )
+        {
+            xUseLength = ( iv_len < 16 ) ? iv_len : 16;
+            prvGhashUpdate( ctx, iv, xUseLength );
+            iv_len -= xUseLength;
+            iv += xUseLength;
+        }
+
+        gcmPUT_UINT32_BE( ( uint32_t ) ( ullIvBits >> 32 ), &ucLengthBlock[ 8 ] );
+        gcmPUT_UINT32_BE( ( uint32_t ) ullIvBits, &ucLengthBlock[ 12 ] );
+        prvGhashUpdate( ctx, ucLengthBlock, 16 );
+
+        for( j = 0; j < 4; j++ )
+        {
+            gcmPUT_UINT32_BE( ctx->buf[ j ], &ctx->y[ 4 * j ] );
+        }
+
+        memset( ctx->buf, 0, sizeof( ctx->buf ) );
+    }
+
+    iResult = mbedtls_cipher_update( &ctx->cipher_ctx, ctx->y, 16, ctx->base_ectr, &xOutputLength );
+
+    if( iResult != 0 )
+    {
+        return iResult;
+    }
+
+    while( add_len > 0 )
+    {
+        xUseLength = ( add_len < 16 ) ? add_len : 16;
+        prvGhashUpdate( ctx, add, xUseLength );
+        add_len -= xUseLength;
+        add += xUseLength;
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_update( mbedtls_gcm_context * ctx,
+                        size_t length,
+                        const unsigned char * input,
+                        unsigned char * output )
+{
+    unsigned char ucKeyStream[ 16 ];
+    size_t xOutputLength = 0;
+    size_t xUseLength;
+    uint32_t ulInput;
+    uint32_t ulOutput;
+    uint32_t i;
+    int iResult = 0;
+
+    if( ( output > input ) && ( ( size_t ) ( output - input ) < length ) )
+    {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+
+    /* The total length is limited to 2^36 - 32 bytes. */
+    if( ( ctx->len + length < ctx->len ) ||
+        ( ( uint64_t ) ctx->len + length > 0xFFFFFFFE0ULL ) )
+    {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+
+    ctx->len += length;
+
+    while( ( length > 0 ) && ( iResult == 0 ) )
+    {
+        xUseLength = ( length < 16 ) ? length : 16;
+
+        /* Increment the 32-bit counter. */
+        for( i = 16; i > 12; i-- )
+        {
+            if( ++ctx->y[ i - 1 ] != 0 )
+            {
+                break;
+            }
+        }
+
+        iResult = mbedtls_cipher_update( &ctx->cipher_ctx, ctx->y, 16, ucKeyStream, &xOutputLength );
+
+        if( iResult != 0 )
+        {
+            break;
+        }
+
+        if( xUseLength == 16 )
+        {
+            /* Each input word is read before the output word at the same
+             * offset is written, so the data may be processed in place. */
+            for( i = 0; i < 4; i++ )
+            {
+                ulInput = gcmGET_UINT32_BE( &input[ 4 * i ] );
+                ulOutput = ulInput ^ gcmGET_UINT32_BE( &ucKeyStream[ 4 * i ] );
+                gcmPUT_UINT32_BE( ulOutput, &output[ 4 * i ] );
+                ctx->buf[ i ] ^= ( ctx->mode == MBEDTLS_GCM_DECRYPT ) ? ulInput : ulOutput;
+            }
+
+            prvGhashMult( ctx, ctx->buf );
+        }
+        else
+        {
+            /* The last, partial block. GHASH takes the ciphertext. */
+            if( ctx->mode == MBEDTLS_GCM_DECRYPT )
+            {
+                prvGhashUpdate( ctx, input, xUseLength );
+            }
+
+            for( i = 0; i < xUseLength; i++ )
+            {
+                output[ i ] = ucKeyStream[ i ] ^ input[ i ];
+            }
+
+            if( ctx->mode == MBEDTLS_GCM_ENCRYPT )
+            {
+                prvGhashUpdate( ctx, output, xUseLength );
+            }
+        }
+
+        length -= xUseLength;
+        input += xUseLength;
+        output += xUseLength;
+    }
+
+    mbedtls_platform_zeroize( ucKeyStream, sizeof( ucKeyStream ) );
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_finish( mbedtls_gcm_context * ctx,
+                        unsigned char * tag,
+                        size_t tag_len )
+{
+    unsigned char ucHash[ 16 ];
+    uint64_t ullBits = ctx->len * 8U;
+    uint64_t ullAddBits = ctx->add_len * 8U;
+    size_t i;
+
+    if( ( tag_len > 16 ) || ( tag_len < 4 ) )
+    {
+        return MBEDTLS_ERR_GCM_BAD_INPUT;
+    }
+
+    memcpy( tag, ctx->base_ectr, tag_len );
+
+    if( ( ullBits != 0 ) || ( ullAddBits != 0 ) )
+    {
+        ctx->buf[ 0 ] ^= ( uint32_t ) ( ullAddBits >> 32 );
+        ctx->buf[ 1 ] ^= ( uint32_t ) ullAddBits;
+        ctx->buf[ 2 ] ^= ( uint32_t ) ( ullBits >> 32 );
+        ctx->buf[ 3 ] ^= ( uint32_t ) ullBits;
+
+        prvGhashMult( ctx, ctx->buf );
+
+        for( i = 0; i < 4; i++ )
+        {
+            gcmPUT_UINT32_BE( ctx->buf[ i ], &ucHash[ 4 * i ] );
+        }
+
+        for( i = 0; i < tag_len; i++ )
+        {
+            tag[ i ] ^= ucHash[ i ];
+        }
+    }
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_crypt_and_tag( mbedtls_gcm_context * ctx,
+                               int mode,
+                               size_t length,
+                               const unsigned char * iv,
+                               size_t iv_len,
+                               const unsigned char * add,
+                               size_t add_len,
+                               const unsigned char * input,
+                               unsigned char * output,
+                               size_t tag_len,
+                               unsigned char * tag )
+{
+    int iResult;
+
+    iResult = mbedtls_gcm_starts( ctx, mode, iv, iv_len, add, add_len );
+
+    if( iResult == 0 )
+    {
+        iResult = mbedtls_gcm_update( ctx, length, input, output );
+    }
+
+    if( iResult == 0 )
+    {
+        iResult = mbedtls_gcm_finish( ctx, tag, tag_len );
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+int mbedtls_gcm_auth_decrypt( mbedtls_gcm_context * ctx,
+                              size_t length,
+                              const unsigned char * iv,
+                              size_t iv_len,
+                              const unsigned char * add,
+                              size_t add_len,
+                              const unsigned char * tag,
+                              size_t tag_len,
+                              const unsigned char * input,
+                              unsigned char * output )
+{
+    unsigned char ucCheckTag[ 16 ];
+    unsigned char ucDiff = 0;
+    size_t i;
+    int iResult;
+
+    iResult = mbedtls_gcm_crypt_and_tag( ctx, MBEDTLS_GCM_DECRYPT, length,
+                                         iv, iv_len, add, add_len,
+                                         input, output, tag_len, ucCheckTag );
+
+    if( iResult == 0 )
+    {
+        /* Compare the tags in constant time. */
+        for( i = 0; i < tag_len; i++ )
+        {
+            ucDiff |= tag[ i ] ^ ucCheckTag[ i ];
+        }
+
+        if( ucDiff != 0 )
+        {
+            mbedtls_platform_zeroize( output, length );
+            iResult = MBEDTLS_ERR_GCM_AUTH_FAILED;
+        }
+    }
+
+    return iResult;
+}
+/*-----------------------------------------------------------*/
+
+void mbedtls_gcm_free( mbedtls_gcm_context * ctx )
+{
+    mbedtls_cipher_free( &ctx->cipher_ctx );
+    mbedtls_platform_zeroize( ctx, sizeof( mbedtls_gcm_context ) );
+}
+
+#endif /* MBEDTLS_GCM_C && MBEDTLS_GCM_ALT */
@@ -0,0 +1,189 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_sha256_alt.c
+ * @brief SHA-256 block function for MBEDTLS_SHA256_PROCESS_ALT.
+ *
+ * Computes the same as the unrolled function of library/sha256.c, with
+ * less work per round for a 32-bit core with a barrel shifter:
+ * - the message schedule lives in a 16 word ring instead of a 64 word
+ *   array, and is expanded just ahead of the rounds using it,
+ * - the working variables are renamed by the round macro instead of being
+ *   indexed, so they stay in registers,
+ * - Maj( a, b, c ) is b ^ ( ( a ^ b ) & ( b ^ c ) ), and a ^ b of one round
+ *   is b ^ c of the next, which saves an operation per round.
+ */
+
+#if !defined( MBEDTLS_CONFIG_FILE )
+    #include "mbedtls/config.h"
+#else
+    #include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined( MBEDTLS_SHA256_C ) && defined( MBEDTLS_SHA256_PROCESS_ALT )
+
+#include "mbedtls/sha256.h"
+
+/**
+ * @brief Round constants.
+ */
+static const uint32_t ulK[ 64 ] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+#define shaROTR( x, n )         ( ( ( x ) >> ( n ) ) | ( ( x ) << ( 32 - ( n ) ) ) )
+
+#define shaBIG_SIGMA0( x )      ( shaROTR( x, 2 ) ^ shaROTR( x, 13 ) ^ shaROTR( x, 22 ) )
+#define shaBIG_SIGMA1( x )      ( shaROTR( x, 6 ) ^ shaROTR( x, 11 ) ^ shaROTR( x, 25 ) )
+#define shaSMALL_SIGMA0( x )    ( shaROTR( x, 7 ) ^ shaROTR( x, 18 ) ^ ( ( x ) >> 3 ) )
+#define shaSMALL_SIGMA1( x )    ( shaROTR( x, 17 ) ^ shaROTR( x, 19 ) ^ ( ( x ) >> 10 ) )
+
+#define shaCH( e, f, g )        ( ( g ) ^ ( ( e ) & ( ( f ) ^ ( g ) ) ) )
+
+/**
+ * @brief Big-endian load, which compilers turn into a load and a byte
+ * reverse.
+ */
+#define shaGET_UINT32_BE( pucBytes )                \
+    ( ( ( uint32_t ) ( pucBytes )[ 0 ] << 24 ) |    \
+      ( ( uint32_t ) ( pucBytes )[ 1 ] << 16 ) |    \
+      ( ( uint32_t ) ( pucBytes )[ 2 ] << 8 ) |     \
+      ( ( uint32_t ) ( pucBytes )[ 3 ] ) )
+
+/**
+ * @brief Expand the next message word in place of the one 16 words back,
+ * t being the position in the ring.
+ */
+#define shaEXPAND( t )                                               \
+    ( ulW[ ( t ) & 15 ] += shaSMALL_SIGMA1( ulW[ ( ( t ) - 2 ) & 15 ] ) + \
+                          ulW[ ( ( t ) - 7 ) & 15 ] +                     \
+                          shaSMALL_SIGMA0( ulW[ ( ( t ) - 15 ) & 15 ] ) )
+
+/**
+ * @brief One round. ulAB receives a ^ b, ulBC holds b ^ c from the
+ * previous round.
+ */
+#define shaROUND( a, b, c, d, e, f, g, h, ulWord, ulConstant, ulAB, ulBC ) \
+    do {                                                                   \
+        h += shaBIG_SIGMA1( e ) + shaCH( e, f, g ) + ( ulConstant ) + ( ulWord ); \
+        d += h;                                                            \
+        ulAB = a ^ b;                                                      \
+        h += shaBIG_SIGMA0( a ) + ( b ^ ( ulAB & ulBC ) );                 \
+    } while( 0 )
+
+/**
+ * @brief Eight rounds, with message words xWORD( k ) to xWORD( k + 7 ) and
+ * round constants pulConstants[ k ] to pulConstants[ k + 7 ]. k is a
+ * constant, so the ring indexes are too. After eight rounds the working
+ * variables are back in place.
+ */
+#define shaEIGHT_ROUNDS( pulConstants, k, xWORD )                                                              \
+    do {                                                                                                      \
+        shaROUND( ulA, ulB, ulC, ulD, ulE, ulF, ulG, ulH, xWORD( ( k ) + 0 ), ( pulConstants )[ ( k ) + 0 ], ulX, ulY ); \
+        shaROUND( ulH, ulA, ulB, ulC, ulD, ulE, ulF, ulG, xWORD( ( k ) + 1 ), ( pulConstants )[ ( k ) + 1 ], ulY, ulX ); \
+        shaROUND( ulG, ulH, ulA, ulB, ulC, ulD, ulE, ulF, xWORD( ( k ) + 2 ), ( pulConstants )[ ( k ) + 2 ], ulX, ulY ); \
+        shaROUND( ulF, ulG, ulH, ulA, ulB, ulC, ulD, ulE, xWORD( ( k ) + 3 ), ( pulConstants )[ ( k ) + 3 ], ulY, ulX ); \
+        shaROUND( ulE, ulF, ulG, ulH, ulA, ulB, ulC, ulD, xWORD( ( k ) + 4 ), ( pulConstants )[ ( k ) + 4 ], ulX, ulY ); \
+        shaROUND( ulD, ulE, ulF, ulG, ulH, ulA, ulB, ulC, xWORD( ( k ) + 5 ), ( pulConstants )[ ( k ) + 5 ], ulY, ulX ); \
+        shaROUND( ulC, ulD, ulE, ulF, ulG, ulH, ulA, ulB, xWORD( ( k ) + 6 ), ( pulConstants )[ ( k ) + 6 ], ulX, ulY ); \
+        shaROUND( ulB, ulC, ulD, ulE, ulF, ulG, ulH, ulA, xWORD( ( k ) + 7 ), ( pulConstants )[ ( k ) + 7 ], ulY, ulX ); \
+    } while( 0 )
+
+/* Message words of the first 16 rounds, loaded from the block. */
+#define shaLOADED( t )    ( ulW[ ( t ) & 15 ] )
+
+/*-----------------------------------------------------------*/
+
+int mbedtls_internal_sha256_process( mbedtls_sha256_context * ctx,
+                                     const unsigned char data[ 64 ] )
+{
+    uint32_t ulW[ 16 ];
+    uint32_t ulA = ctx->state[ 0 ];
+    uint32_t ulB = ctx->state[ 1 ];
+    uint32_t ulC = ctx->state[ 2 ];
+    uint32_t ulD = ctx->state[ 3 ];
+    uint32_t ulE = ctx->state[ 4 ];
+    uint32_t ulF = ctx->state[ 5 ];
+    uint32_t ulG = ctx->state[ 6 ];
+    uint32_t ulH = ctx->state[ 7 ];
+    uint32_t ulX;
+    uint32_t ulY = ulB ^ ulC;
+    const uint32_t * pulConstants;
+    uint32_t i;
+
+    for( i = 0; i < 16; i++ )
+    {
+        ulW[ i ] = shaGET_UINT32_BE( &data[ 4 * i ] );
+    }
+
+    shaEIGHT_ROUNDS( ulK, 0, shaLOADED );
+    shaEIGHT_ROUNDS( ulK, 8, shaLOADED );
+
+    /* An even number of rounds has passed, so ulY holds b ^ c again. */
+    for( pulConstants = &ulK[ 16 ]; pulConstants < &ulK[ 64 ]; pulConstants += 16 )
+    {
+        shaEIGHT_ROUNDS( pulConstants, 0, shaEXPAND );
+        shaEIGHT_ROUNDS( pulConstants, 8, shaEXPAND );
+    }
+
+    ctx->state[ 0 ] += ulA;
+    ctx->state[ 1 ] += ulB;
+    ctx->state[ 2 ] += ulC;
+    ctx->state[ 3 ] += ulD;
+    ctx->state[ 4 ] += ulE;
+    ctx->state[ 5 ] += ulF;
+    ctx->state[ 6 ] += ulG;
+    ctx->state[ 7 ] += ulH;
+
+    return 0;
+}
+/*-----------------------------------------------------------*/
+
+#if !defined( MBEDTLS_DEPRECATED_REMOVED )
+    void mbedtls_sha256_process( mbedtls_sha256_context * ctx,
+                                 const unsigned char data[ 64 ] )
+    {
+        ( void ) mbedtls_internal_sha256_process( ctx, data );
+    }
+#endif
+
+#endif /* MBEDTLS_SHA256_C && MBEDTLS_SHA256_PROCESS_ALT */
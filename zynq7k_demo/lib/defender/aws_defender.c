@@ -27,12 +27,27 @@
 #include "aws_cbor_alloc.h"
 #include "aws_cbor_print.h"
 #include "aws_defender_internals.h"
+#include "aws_static_memory.h"
 
 #include "FreeRTOS.h"
 #include "aws_clientcredential.h"
 #include "aws_mqtt_agent.h"
+#include "event_groups.h"
 #include "task.h"
 
+/* Event bits set by the accept and reject topic callbacks. */
+#define defenderACK_ACCEPTED_BIT    ( ( EventBits_t ) 1 << 0 )
+#define defenderACK_REJECTED_BIT    ( ( EventBits_t ) 1 << 1 )
+#define defenderACK_ALL_BITS        ( defenderACK_ACCEPTED_BIT | defenderACK_REJECTED_BIT )
+
+/* Topics on which the service responds to a report. */
+#define defenderACCEPTED_TOPIC                    \
+    "$aws/things/" clientcredentialIOT_THING_NAME \
+    "/defender/metrics/cbor/accepted"
+#define defenderREJECTED_TOPIC                    \
+    "$aws/things/" clientcredentialIOT_THING_NAME \
+    "/defender/metrics/cbor/rejected"
+
 typedef enum
 {
     eDefenderFalse = 0,
@@ -54,19 +69,42 @@ static DefenderState_t eDefenderState;
 static uint32_t ulDelayPeriodSec = 300;
 /* Handle for the MQTT agent. */
 static MQTTAgentHandle_t xDefenderMQTTAgent;
+/* Set when the MQTT agent is owned by the application and shared with the
+ * agent.  A shared agent is never connected, disconnected or deleted here. */
+static DEFENDERBool_t xDefenderAgentShared;
+/* Set while the agent's own MQTT connection is up. */
+static volatile DEFENDERBool_t xDefenderConnected;
+/* Set once the accept and reject topics are subscribed on the connection. */
+static volatile DEFENDERBool_t xDefenderSubscribed;
+/* Signals the service response to the agent task. */
+static EventGroupHandle_t xDefenderAckEvents = NULL;
 /* Handle for the agent task. */
 static TaskHandle_t xDefenderTaskHandle = NULL;
+/* Set from DEFENDER_Start() until the agent task has stopped. */
+static volatile DEFENDERBool_t xDefenderRunning;
 /* Timeout period for MQTT connections. */
 static TickType_t xMQTTTimeoutPeriodTicks = pdMS_TO_TICKS( 10U * 1000U );
 
+/* The report is encoded in place, so no heap is used for it. */
+static uint8_t ucReportBuffer[ DEFENDER_REPORT_BUFFER_SIZE ] staticmemSECTION( defender );
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    /* Memory for the agent task and the acknowledgement event group. */
+    static StaticEventGroup_t xDefenderAckEventsBuffer staticmemSECTION( defender );
+    static StaticTask_t xDefenderTaskBuffer staticmemSECTION( defender );
+    static StackType_t xDefenderTaskStack[ configMINIMAL_STACK_SIZE ] staticmemSECTION( defender );
+#endif
+
 /**
  * @brief      Publishes metrics report to service
  *
- * @param[in]  xReport  The metrics report
+ * @param[in]  pucReport      The CBOR metrics report
+ * @param[in]  lReportLength  Size of the report
  *
  * @return     Returns true if error occurred, false (0) on success
  */
-static DEFENDERBool_t prvPublishCborToDevDef( CBORHandle_t xReport );
+static DEFENDERBool_t prvPublishCborToDevDef( uint8_t const * pucReport,
+                                              int32_t lReportLength );
 
 /**
  * @brief      Subscribes to the report accept topic
@@ -118,7 +156,24 @@ static MQTTBool_t xAcceptCallback( void * pxPvPublishCallbackContext,
 static MQTTBool_t prvRejectCallback( void * pxPvPublishCallbackContext,
                                      MQTTPublishData_t const * pxPublishData );
 
+/**
+ * @brief      Tracks the state of the agent's own MQTT connection
+ *
+ * @param      pvUserData        Not used
+ * @param      pxCallbackParams  The MQTT agent event
+ *
+ * @return     Always returns pdFALSE
+ */
+static BaseType_t prvMqttEventCallback( void * pvUserData,
+                                        const MQTTAgentCallbackParams_t * const pxCallbackParams );
+
+/**
+ * @brief      Releases the MQTT resources held by the agent
+ */
+static void prvCleanupMqtt( void );
+
 static DefenderState_t prvStateInit( void );
+static DefenderState_t prvStateStart( void );
 static DefenderState_t prvStateNewMQTT( void );
 static DefenderState_t prvStateConnectMqtt( void );
 static DefenderState_t prvStateDisconnectMqtt( void );
@@ -190,7 +245,7 @@ static void DEFENDER_StateFunctionSet( void )
     /* clang-format off */
     DEFENDER_States[ eDefenderStateInit ] = prvStateInit;
 
-    DEFENDER_States[ eDefenderStateStarted ] = prvStateNewMQTT;
+    DEFENDER_States[ eDefenderStateStarted ] = prvStateStart;
     DEFENDER_States[ eDefenderStateNewMqttFailed ] = prvStateSleep;
     DEFENDER_States[ eDefenderStateNewMqttSuccess ] = prvStateConnectMqtt;
     DEFENDER_States[ eDefenderStateConnectMqttFailed ] = prvStateDeleteMqtt;
@@ -198,7 +253,7 @@ static void DEFENDER_StateFunctionSet( void )
     DEFENDER_States[ eDefenderStateSubscribeMqttFailed ] = prvStateDisconnectMqtt;
     DEFENDER_States[ eDefenderStateSubscribeMqttSuccess ] = prvStateCreateReport;
     DEFENDER_States[ eDefenderStateSubmitReportFailed ] = prvStateDisconnectMqtt;
-    DEFENDER_States[ eDefenderStateSubmitReportSuccess ] = prvStateDisconnectMqtt;
+    DEFENDER_States[ eDefenderStateSubmitReportSuccess ] = prvStateSleep;
     DEFENDER_States[ eDefenderStateDisconnectFailed ] = prvStateDisconnectMqtt;
     DEFENDER_States[ eDefenderStateDisconnected ] = prvStateDeleteMqtt;
     DEFENDER_States[ eDefenderStateDeleteFailed ] = prvStateDeleteMqtt;
@@ -211,6 +266,30 @@ static DefenderState_t prvStateInit( void )
     return eDefenderStateStarted;
 }
 
+static DefenderState_t prvStateStart( void )
+{
+    /* Reuse the connection from the previous period when it is still up. */
+    if( ( eDefenderTrue == xDefenderAgentShared ) ||
+        ( eDefenderTrue == xDefenderConnected ) )
+    {
+        if( eDefenderTrue == xDefenderSubscribed )
+        {
+            return eDefenderStateSubscribeMqttSuccess;
+        }
+
+        return eDefenderStateConnectMqttSuccess;
+    }
+
+    /* The connection dropped between reports, release it before reconnecting. */
+    if( NULL != xDefenderMQTTAgent )
+    {
+        ( void ) MQTT_AGENT_Delete( xDefenderMQTTAgent );
+        xDefenderMQTTAgent = NULL;
+    }
+
+    return prvStateNewMQTT();
+}
+
 static DefenderState_t prvStateNewMQTT( void )
 {
     MQTTAgentReturnCode_t xCreateResult =
@@ -237,7 +316,7 @@ static DefenderState_t prvStateConnectMqtt( void )
         .usClientIdLength   = 0,
         .xSecuredConnection = pdTRUE,
         .pvUserData         = NULL,
-        .pxCallback         = NULL,
+        .pxCallback         = prvMqttEventCallback,
         .pcCertificate      = NULL,
         .ulCertificateSize  = 0,
     };
@@ -258,9 +337,26 @@ static DefenderState_t prvStateConnectMqtt( void )
         return eDefenderStateConnectMqttFailed;
     }
 
+    xDefenderConnected = eDefenderTrue;
+
     return eDefenderStateConnectMqttSuccess;
 }
 
+static BaseType_t prvMqttEventCallback( void * pvUserData,
+                                        const MQTTAgentCallbackParams_t * const pxCallbackParams )
+{
+    ( void ) pvUserData;
+
+    if( eMQTTAgentDisconnect == pxCallbackParams->xMQTTEvent )
+    {
+        /* Subscriptions do not survive a disconnect. */
+        xDefenderConnected = eDefenderFalse;
+        xDefenderSubscribed = eDefenderFalse;
+    }
+
+    return pdFALSE;
+}
+
 static DefenderState_t prvStateSubscribe( void )
 {
     DEFENDERBool_t xError = eDefenderFalse;
@@ -273,14 +369,14 @@ static DefenderState_t prvStateSubscribe( void )
         return eDefenderStateSubscribeMqttFailed;
     }
 
+    xDefenderSubscribed = eDefenderTrue;
+
     return eDefenderStateSubscribeMqttSuccess;
 }
 
 static DEFENDERBool_t prvSubscribeToAcceptCbor( void )
 {
-    uint8_t * pucTopic = ( uint8_t * ) "$aws/things/"
-                         clientcredentialIOT_THING_NAME
-                         "/defender/metrics/cbor/accepted";
+    uint8_t * pucTopic = ( uint8_t * ) defenderACCEPTED_TOPIC;
     MQTTAgentSubscribeParams_t xSubParams =
     {
         .pucTopic                 = NULL,
@@ -311,15 +407,14 @@ static MQTTBool_t xAcceptCallback( void * pxPvPublishCallbackContext,
     ( void ) pxPublishData;
 
     eDefenderReportStatus = eDefenderRepSuccess;
+    ( void ) xEventGroupSetBits( xDefenderAckEvents, defenderACK_ACCEPTED_BIT );
 
     return eMQTTFalse;
 }
 
 static DEFENDERBool_t prvSubscribeToRejectCbor( void )
 {
-    uint8_t * pucTopic = ( uint8_t * ) "$aws/things/"
-                         clientcredentialIOT_THING_NAME
-                         "/defender/metrics/cbor/rejected";
+    uint8_t * pucTopic = ( uint8_t * ) defenderREJECTED_TOPIC;
     MQTTAgentSubscribeParams_t xSubParams =
     {
         .pucTopic                 = NULL,
@@ -350,6 +445,7 @@ static MQTTBool_t prvRejectCallback( void * pxPvPublishCallbackContext,
     ( void ) pxPublishData;
 
     eDefenderReportStatus = eDefenderRepRejected;
+    ( void ) xEventGroupSetBits( xDefenderAckEvents, defenderACK_REJECTED_BIT );
 
     return eMQTTFalse;
 }
@@ -357,30 +453,52 @@ static MQTTBool_t prvRejectCallback( void * pxPvPublishCallbackContext,
 
 static DefenderState_t prvStateCreateReport( void )
 {
-    CBORHandle_t xReport;
+    int32_t lReportLength;
 
-    xReport = CreateReport();
+    lReportLength = CreateReport( ucReportBuffer, sizeof( ucReportBuffer ) );
 
-    if( NULL == xReport )
+    if( 0 == lReportLength )
     {
         return eDefenderStateSubmitReportFailed;
     }
 
-    DEFENDERBool_t xError = prvPublishCborToDevDef( xReport );
-    CBOR_Delete( &xReport );
+    /* Discard any late response to a previous report. */
+    ( void ) xEventGroupClearBits( xDefenderAckEvents, defenderACK_ALL_BITS );
 
-    /* Wait for ack from service */
-    vTaskDelay( pdMS_TO_TICKS( 10000 ) );
+    DEFENDERBool_t xError = prvPublishCborToDevDef( ucReportBuffer,
+                                                    lReportLength );
 
     if( true == xError )
     {
+        /* The subscriptions are redone once the connection recovers. */
+        xDefenderSubscribed = eDefenderFalse;
+
         return eDefenderStateSubmitReportFailed;
     }
 
+    /* Wait for ack from service.  The status is updated by the callbacks, and
+     * remains eDefenderRepNoAck if no response arrives before the timeout. */
+    EventBits_t xAckBits = xEventGroupWaitBits( xDefenderAckEvents,
+                                                defenderACK_ALL_BITS,
+                                                pdTRUE,
+                                                pdFALSE,
+                                                xMQTTTimeoutPeriodTicks );
+
+    /* A shared connection can be re-established by the application without
+     * the agent seeing the disconnect, in which case a clean session drops the
+     * accept and reject subscriptions.  Redo them on the next report if no
+     * response arrived; subscribing again to the same topic is harmless. */
+    if( ( 0 == ( xAckBits & defenderACK_ALL_BITS ) ) &&
+        ( eDefenderTrue == xDefenderAgentShared ) )
+    {
+        xDefenderSubscribed = eDefenderFalse;
+    }
+
     return eDefenderStateSubmitReportSuccess;
 }
 
-static DEFENDERBool_t prvPublishCborToDevDef( CBORHandle_t xReport )
+static DEFENDERBool_t prvPublishCborToDevDef( uint8_t const * pucReport,
+                                              int32_t lReportLength )
 {
     MQTTAgentPublishParams_t xPubRecParams =
     {
@@ -394,15 +512,13 @@ static DEFENDERBool_t prvPublishCborToDevDef( CBORHandle_t xReport )
                          "$aws/things/"
                          clientcredentialIOT_THING_NAME
                          "/defender/metrics/cbor";
-    uint8_t const * pucBuffer = CBOR_GetRawBuffer( xReport );
-    int32_t lBufLen = CBOR_GetBufferSize( xReport );
     MQTTAgentReturnCode_t xPublishResult = 0;
 
     /* Initialize non-static field values. */
     xPubRecParams.pucTopic = pucTopic;
     xPubRecParams.usTopicLength = ( uint16_t ) strlen( ( char * ) pucTopic );
-    xPubRecParams.pvData = pucBuffer;
-    xPubRecParams.ulDataLength = lBufLen;
+    xPubRecParams.pvData = pucReport;
+    xPubRecParams.ulDataLength = lReportLength;
 
     xPublishResult = MQTT_AGENT_Publish( xDefenderMQTTAgent,
                                          &xPubRecParams,
@@ -422,6 +538,20 @@ static DEFENDERBool_t prvPublishCborToDevDef( CBORHandle_t xReport )
 
 static DefenderState_t prvStateDisconnectMqtt( void )
 {
+    /* A shared connection is managed by the application. */
+    if( eDefenderTrue == xDefenderAgentShared )
+    {
+        return eDefenderStateSleep;
+    }
+
+    xDefenderSubscribed = eDefenderFalse;
+
+    /* Nothing to disconnect if the broker already closed the connection. */
+    if( eDefenderFalse == xDefenderConnected )
+    {
+        return eDefenderStateDisconnected;
+    }
+
     if( eMQTTAgentSuccess
         != MQTT_AGENT_Disconnect(
             xDefenderMQTTAgent, xMQTTTimeoutPeriodTicks ) )
@@ -429,6 +559,8 @@ static DefenderState_t prvStateDisconnectMqtt( void )
         return eDefenderStateDisconnectFailed;
     }
 
+    xDefenderConnected = eDefenderFalse;
+
     return eDefenderStateDisconnected;
 }
 
@@ -439,9 +571,57 @@ static DefenderState_t prvStateDeleteMqtt( void )
         return eDefenderStateDeleteFailed;
     }
 
+    xDefenderMQTTAgent = NULL;
+
     return eDefenderStateSleep;
 }
 
+static void prvCleanupMqtt( void )
+{
+    if( NULL == xDefenderMQTTAgent )
+    {
+        return;
+    }
+
+    if( eDefenderTrue == xDefenderAgentShared )
+    {
+        /* Leave the application's connection up, but stop routing the service
+         * responses to the agent. */
+        if( eDefenderTrue == xDefenderSubscribed )
+        {
+            uint8_t * pucAccepted = ( uint8_t * ) defenderACCEPTED_TOPIC;
+            uint8_t * pucRejected = ( uint8_t * ) defenderREJECTED_TOPIC;
+            MQTTAgentUnsubscribeParams_t xUnsubParams;
+
+            xUnsubParams.pucTopic = pucAccepted;
+            xUnsubParams.usTopicLength = ( uint16_t ) strlen( ( char * ) pucAccepted );
+            ( void ) MQTT_AGENT_Unsubscribe( xDefenderMQTTAgent,
+                                             &xUnsubParams,
+                                             xMQTTTimeoutPeriodTicks );
+
+            xUnsubParams.pucTopic = pucRejected;
+            xUnsubParams.usTopicLength = ( uint16_t ) strlen( ( char * ) pucRejected );
+            ( void ) MQTT_AGENT_Unsubscribe( xDefenderMQTTAgent,
+                                             &xUnsubParams,
+                                             xMQTTTimeoutPeriodTicks );
+        }
+    }
+    else
+    {
+        if( eDefenderTrue == xDefenderConnected )
+        {
+            ( void ) MQTT_AGENT_Disconnect( xDefenderMQTTAgent,
+                                            xMQTTTimeoutPeriodTicks );
+        }
+
+        ( void ) MQTT_AGENT_Delete( xDefenderMQTTAgent );
+        xDefenderMQTTAgent = NULL;
+    }
+
+    xDefenderConnected = eDefenderFalse;
+    xDefenderSubscribed = eDefenderFalse;
+}
+
 static DefenderState_t prvStateSleep( void )
 {
     static TickType_t xWakeTick;
@@ -480,6 +660,28 @@ DefenderErr_t DEFENDER_ReportPeriodSet( uint32_t ulPeriodSec )
     return eDefenderErrSuccess;
 }
 
+DefenderErr_t DEFENDER_MqttAgentSet( MQTTAgentHandle_t xMQTTAgent )
+{
+    if( eDefenderTrue == xDefenderRunning )
+    {
+        return eDefenderErrAlreadyStarted;
+    }
+
+    xDefenderMQTTAgent = xMQTTAgent;
+    xDefenderAgentShared = ( NULL != xMQTTAgent ) ? eDefenderTrue : eDefenderFalse;
+    xDefenderConnected = eDefenderFalse;
+    xDefenderSubscribed = eDefenderFalse;
+
+    return eDefenderErrSuccess;
+}
+
+void DEFENDER_MqttAgentDisconnected( void )
+{
+    /* Only the flag is cleared here, as this is called from the MQTT agent
+     * task.  The agent task resubscribes before its next report. */
+    xDefenderSubscribed = eDefenderFalse;
+}
+
 DefenderErr_t DEFENDER_ConnectionTimeoutSet( uint32_t ulTimeoutMs )
 {
     xMQTTTimeoutPeriodTicks = pdMS_TO_TICKS( ulTimeoutMs );
@@ -500,20 +702,52 @@ DefenderReportStatus_t DEFENDER_ReportStatusGet( void )
 
 DefenderErr_t DEFENDER_Start( void )
 {
-    if( NULL != xDefenderTaskHandle )
+    if( eDefenderTrue == xDefenderRunning )
     {
         return eDefenderErrAlreadyStarted;
     }
 
+    if( NULL == xDefenderAckEvents )
+    {
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xDefenderAckEvents = xEventGroupCreateStatic( &xDefenderAckEventsBuffer );
+        #else
+            xDefenderAckEvents = xEventGroupCreate();
+        #endif
+
+        if( NULL == xDefenderAckEvents )
+        {
+            return eDefenderErrFailedToCreateTask;
+        }
+    }
+
     xDefenderKill = eDefenderFalse;
+    xDefenderRunning = eDefenderTrue;
 
-    /* Returns pdTrue (1) on success. */
-    BaseType_t xSuccess =
-        xTaskCreate( prvAgentLoop, "DD_Agent", configMINIMAL_STACK_SIZE,
-                     NULL, tskIDLE_PRIORITY, &xDefenderTaskHandle );
+    /* The task is created on the first start only.  Once stopped it waits
+     * to be started again rather than deleting itself, so that its static
+     * memory is never reused while the kernel may still reference it. */
+    if( NULL != xDefenderTaskHandle )
+    {
+        ( void ) xTaskNotifyGive( xDefenderTaskHandle );
+
+        return eDefenderErrSuccess;
+    }
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        xDefenderTaskHandle =
+            xTaskCreateStatic( prvAgentLoop, "DD_Agent", configMINIMAL_STACK_SIZE,
+                               NULL, tskIDLE_PRIORITY, xDefenderTaskStack,
+                               &xDefenderTaskBuffer );
+    #else
+        ( void ) xTaskCreate( prvAgentLoop, "DD_Agent", configMINIMAL_STACK_SIZE,
+                              NULL, tskIDLE_PRIORITY, &xDefenderTaskHandle );
+    #endif
 
-    if( 1 != xSuccess )
+    if( NULL == xDefenderTaskHandle )
     {
+        xDefenderRunning = eDefenderFalse;
+
         return eDefenderErrFailedToCreateTask;
     }
 
@@ -522,7 +756,7 @@ DefenderErr_t DEFENDER_Start( void )
 
 DefenderErr_t DEFENDER_Stop( void )
 {
-    if( NULL == xDefenderTaskHandle )
+    if( eDefenderFalse == xDefenderRunning )
     {
         return eDefenderErrNotStarted;
     }
@@ -540,22 +774,28 @@ static void prvAgentLoop( void * params )
 
     for( ; ; )
     {
-        /* Check if a kill was requested before the report was started */
-        if( xDefenderKill )
+        for( ; ; )
         {
-            break;
-            /* TODO: Appropriately clean up resources on kill request */
+            /* Check if a kill was requested before the report was started */
+            if( xDefenderKill )
+            {
+                break;
+            }
+
+            eDefenderState = DEFENDER_StateFunction( eDefenderState );
+
+            int32_t lStatePeriodMS = 5;
+            vTaskDelay( pdMS_TO_TICKS( lStatePeriodMS ) );
         }
 
-        eDefenderState = DEFENDER_StateFunction( eDefenderState );
+        /* The connection is kept between reports, so release it on exit. */
+        prvCleanupMqtt();
+        eDefenderState = eDefenderStateInit;
+        xDefenderRunning = eDefenderFalse;
 
-        int32_t lStatePeriodMS = 5;
-        vTaskDelay( pdMS_TO_TICKS( lStatePeriodMS ) );
+        /* Wait for DEFENDER_Start(). */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
     }
-
-    TaskHandle_t xTaskHandle = xDefenderTaskHandle;
-    xDefenderTaskHandle = NULL;
-    vTaskDelete( xTaskHandle );
 }
 
 char const * DEFENDER_ErrAsString( DefenderErr_t eErrNum )
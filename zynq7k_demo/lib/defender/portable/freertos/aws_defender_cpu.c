@@ -23,16 +23,92 @@
  * http://www.FreeRTOS.org
  */
 #include <stdint.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
 
 #include "aws_defender_cpu.h"
+#include "aws_task_stats.h"
+#include "aws_static_memory.h"
+
+/* Maximum number of tasks measured on each refresh.  Nothing is measured
+ * when more tasks exist, and the previous figures are kept. */
+#ifndef DEFENDER_MAX_TASKS
+    #define DEFENDER_MAX_TASKS    ( 32 )
+#endif
+
+/* Kept static so that a refresh does not allocate. */
+static TaskStatsTask_t xTaskStats[ DEFENDER_MAX_TASKS ] staticmemSECTION( defender );
+static DefenderTaskCpu_t xTaskCpu[ DEFENDER_MAX_TASKS ] staticmemSECTION( defender );
+static int32_t lTaskCpuCount;
+static int32_t lDefenderCpuLoadPercent = -1;
 
 int32_t CpuLoadGet( void )
 {
-    /* #error return CPU as a percentage * cores. */
-    return -1;
+    return lDefenderCpuLoadPercent;
 }
 
 void CpuLoadRefresh( void )
 {
-    /* #error measure and store CPU percentage * cores. */
+    TaskStatsInterval_t xInterval = { 0 };
+
+    /* The interval starts at the previous sample, which telemetry may also
+     * have taken. */
+    if( pdPASS != TASKSTATS_Sample( xTaskStats, DEFENDER_MAX_TASKS, &xInterval ) )
+    {
+        return;
+    }
+
+    /* The first refresh has no previous sample to compare against. */
+    if( 0 == xInterval.ulRunTime )
+    {
+        return;
+    }
+
+    /* Hold off CpuTaskLoadGet while the per task figures are rewritten. */
+    vTaskSuspendAll();
+
+    for( size_t xI = 0; xI < xInterval.xTaskCount; ++xI )
+    {
+        TaskStatsTask_t const * const pxStats = &xTaskStats[ xI ];
+        DefenderTaskCpu_t * const pxCpu = &xTaskCpu[ xI ];
+
+        ( void ) strncpy( pxCpu->cTaskName,
+                          pxStats->cTaskName,
+                          DEFENDER_TASK_NAME_LENGTH - 1 );
+        pxCpu->cTaskName[ DEFENDER_TASK_NAME_LENGTH - 1 ] = '\0';
+        pxCpu->ulTaskNumber = pxStats->ulTaskNumber;
+        pxCpu->ulRunTime = pxStats->ulRunTime;
+        pxCpu->lLoadPercent =
+            ( int32_t ) ( ( ( uint64_t ) pxStats->ulRunTime * 100U ) / xInterval.ulRunTime );
+        pxCpu->ulStackHeadroom = pxStats->ulStackHeadroom;
+    }
+
+    lTaskCpuCount = ( int32_t ) xInterval.xTaskCount;
+
+    ( void ) xTaskResumeAll();
+
+    lDefenderCpuLoadPercent =
+        ( int32_t ) ( ( ( uint64_t ) xInterval.ulBusyRunTime * 100U ) / xInterval.ulRunTime );
+}
+
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks )
+{
+    int32_t lCount;
+
+    if( ( NULL == pxTaskCpu ) || ( lMaxTasks < 0 ) )
+    {
+        return 0;
+    }
+
+    vTaskSuspendAll();
+    {
+        lCount = ( lTaskCpuCount < lMaxTasks ) ? lTaskCpuCount : lMaxTasks;
+        ( void ) memcpy( pxTaskCpu, xTaskCpu, ( size_t ) lCount * sizeof( DefenderTaskCpu_t ) );
+    }
+    ( void ) xTaskResumeAll();
+
+    return lCount;
 }
@@ -23,11 +23,18 @@
  * http://www.FreeRTOS.org
  */
 #include "FreeRTOS.h"
-#include "list.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
 
 #include "aws_defender_tcp_conn.h"
 
-extern List_t xBoundTCPSocketsList;
+/* Time to wait for the IP-task to count the connections. */
+#define DEFENDER_TCP_CONN_TIMEOUT_MS    ( 1000 )
+
+/* Filled in by the IP-task.  Static so that it remains valid if the IP-task
+ * handles the request after TcpConnRefresh has timed out. */
+static TCPNetStatCount_t xDefenderNetStat;
 static int32_t lDefenderTCPConnCount;
 
 int32_t TcpConnGet( void )
@@ -37,22 +44,14 @@ int32_t TcpConnGet( void )
 
 void TcpConnRefresh( void )
 {
-    int32_t lTCPConnCount[ 2 ];
-    int32_t lTries = 10;
-
-    do
+    /* xBoundTCPSocketsList may only be walked by the IP-task. */
+    if( pdPASS != FreeRTOS_netstat_count( &xDefenderNetStat,
+                                          pdMS_TO_TICKS( DEFENDER_TCP_CONN_TIMEOUT_MS ) ) )
     {
-        lTCPConnCount[ 0 ] = listCURRENT_LIST_LENGTH( &xBoundTCPSocketsList );
-        lTCPConnCount[ 1 ] = listCURRENT_LIST_LENGTH( &xBoundTCPSocketsList );
-        lTries--;
-
-        if( 0 == lTries )
-        {
-            lDefenderTCPConnCount = -1;
+        lDefenderTCPConnCount = -1;
 
-            return;
-        }
-    } while( lTCPConnCount[ 0 ] != lTCPConnCount[ 1 ] );
+        return;
+    }
 
-    lDefenderTCPConnCount = lTCPConnCount[ 0 ];
+    lDefenderTCPConnCount = ( int32_t ) xDefenderNetStat.uxEstablished;
 }
@@ -32,3 +32,12 @@ int32_t CpuLoadGet( void )
 void CpuLoadRefresh( void )
 {
 }
+
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks )
+{
+    ( void ) pxTaskCpu;
+    ( void ) lMaxTasks;
+
+    return -1;
+}
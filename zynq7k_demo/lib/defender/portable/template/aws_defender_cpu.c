@@ -35,3 +35,11 @@ void CpuLoadRefresh( void )
 {
     #error measure and store CPU percentage * cores.
 }
+
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks )
+{
+    #error copy per task CPU usage, or return -1 if not supported.
+
+    return -1;
+}
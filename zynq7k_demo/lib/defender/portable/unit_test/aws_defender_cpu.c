@@ -36,3 +36,12 @@ void CpuLoadRefresh( void )
 {
     xReportLoad = xDefenderCurrentLoad;
 }
+
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks )
+{
+    ( void ) pxTaskCpu;
+    ( void ) lMaxTasks;
+
+    return 0;
+}
@@ -53,3 +53,12 @@ void CpuLoadRefresh( void )
     xPrevClockTime = xClockTime;
     xPrevTime = xCurrentTime;
 }
+
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks )
+{
+    ( void ) pxTaskCpu;
+    ( void ) lMaxTasks;
+
+    return -1;
+}
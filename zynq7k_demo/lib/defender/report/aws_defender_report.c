@@ -52,45 +52,36 @@ DefenderErr_t DEFENDER_MetricsInitFunc( DefenderMetric_t * xMetrics,
     return eDefenderErrSuccess;
 }
 
-CBORHandle_t CreateReport( void )
+int32_t CreateReport( uint8_t * pucBuffer,
+                      int32_t lBufferSize )
 {
-    /*Create new empty report*/
-    CBORHandle_t xReport = CBOR_New( 0 );
-    /*Create new report header*/
-    CBORHandle_t xHeader = GetHeader();
+    CBOREncoder_t xReport;
 
-    /*Copy header to the report*/
-    CBOR_AppendKeyWithMap( xReport, DEFENDER_HEADER_TAG, xHeader );
-    /*Delete the header*/
-    CBOR_Delete( &xHeader );
-    /*Create new empty metrics document*/
-    CBORHandle_t xMetrics = CBOR_New( 0 );
-
-    /*For each metric, append it to the metrics document*/
+    /*Update the data for every metric*/
     for( int32_t lI = 0; lI < lMetricsCount; ++lI )
     {
-        /*Update the date for the metric*/
         xMetricsList[ lI ]->UpdateMetric();
-        /*Get report from the metric*/
-        CBORHandle_t xMetric = xMetricsList[ lI ]->ReportMetric();
-        /*Copy the metric to the metrics document*/
-        CBOR_AppendMap( xMetrics, xMetric );
-        /*Delete the metric document*/
-        CBOR_Delete( &xMetric );
     }
 
-    /*Copy the metrics document to the report*/
-    CBOR_AppendKeyWithMap( xReport, DEFENDER_METRICS_TAG, xMetrics );
-    /*Delete the metrics document*/
-    CBOR_Delete( &xMetrics );
+    /*Write the report in order, straight into the caller's buffer*/
+    CBOR_EncoderInit( &xReport, pucBuffer, lBufferSize );
+    CBOR_EncodeMap( &xReport, 2 );
+    CBOR_EncodeString( &xReport, DEFENDER_HEADER_TAG );
+    EncodeHeader( &xReport );
+    CBOR_EncodeKeyWithMap( &xReport, DEFENDER_METRICS_TAG, lMetricsCount );
+
+    /*Each metric writes one key value pair of the metrics map*/
+    for( int32_t lI = 0; lI < lMetricsCount; ++lI )
+    {
+        xMetricsList[ lI ]->EncodeMetric( &xReport );
+    }
 
-    /*If an error occurred */
-    if( eCborErrNoError != CBOR_CheckError( xReport ) )
+    /*If an error occurred, e.g. the report did not fit */
+    if( eCborErrNoError != CBOR_EncoderCheckError( &xReport ) )
     {
-        /*Delete the report*/
-        CBOR_Delete( &xReport );
+        return 0;
     }
 
-    /*Return the report*/
-    return xReport;
+    /*Return the size of the report*/
+    return CBOR_EncoderSize( &xReport );
 }
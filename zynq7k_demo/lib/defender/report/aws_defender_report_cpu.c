@@ -27,16 +27,12 @@
 struct DefenderMetric_s xDefenderMetricCpu_s =
 {
     CpuLoadRefresh,
-    CpuReportGet,
+    CpuReportEncode,
 };
 
 DefenderMetric_t xDEFENDER_metric_cpu = &xDefenderMetricCpu_s;
 
-CBORHandle_t CpuReportGet( void )
+void CpuReportEncode( CBOREncoder_t * pxEncoder )
 {
-    CBORHandle_t xCpuMetrics = CBOR_New( 0 );
-
-    CBOR_AssignKeyWithInt( xCpuMetrics, "cpu", CpuLoadGet() );
-
-    return xCpuMetrics;
+    CBOR_EncodeKeyWithInt( pxEncoder, "cpu", CpuLoadGet() );
 }
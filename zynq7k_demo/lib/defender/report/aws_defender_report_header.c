@@ -40,17 +40,14 @@ static uint32_t prvDEFENDER_ReportIdInit( void )
     return ulId;
 }
 
-CBORHandle_t GetHeader( void )
+void EncodeHeader( CBOREncoder_t * pxEncoder )
 {
     lReportId = lReportId == 0 ? prvDEFENDER_ReportIdInit() : lReportId;
 
-    CBORHandle_t xHeader = CBOR_New( 0 );
-
-    CBOR_AssignKeyWithInt( xHeader, DEFENDER_REPORT_ID_TAG, ++lReportId );
-    CBOR_AssignKeyWithString(
-        xHeader, DEFENDER_VERSION_TAG, pcDEFENDER_METRICS_VERSION );
-
-    return xHeader;
+    CBOR_EncodeMap( pxEncoder, 2 );
+    CBOR_EncodeKeyWithInt( pxEncoder, DEFENDER_REPORT_ID_TAG, ++lReportId );
+    CBOR_EncodeKeyWithString(
+        pxEncoder, DEFENDER_VERSION_TAG, pcDEFENDER_METRICS_VERSION );
 }
 
 int32_t GetLastReportId( void )
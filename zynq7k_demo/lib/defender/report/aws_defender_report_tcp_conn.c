@@ -27,25 +27,14 @@
 static struct DefenderMetric_s xDefenderTCPConnectionsS =
 {
     TcpConnRefresh,
-    TcpConnReportGet,
+    TcpConnReportEncode,
 };
 
 DefenderMetric_t xDefenderTCPConnections = &xDefenderTCPConnectionsS;
 
-CBORHandle_t TcpConnReportGet( void )
+void TcpConnReportEncode( CBOREncoder_t * pxEncoder )
 {
-    CBORHandle_t xEstConn = CBOR_New( 0 );
-
-    CBOR_AssignKeyWithInt( xEstConn, DEFENDER_TOTAL_TAG, TcpConnGet() );
-
-    CBORHandle_t xTcpConnMetrics = CBOR_New( 0 );
-    CBOR_AssignKeyWithMap( xTcpConnMetrics, DEFENDER_EST_CONN_TAG, xEstConn );
-    CBOR_Delete( &xEstConn );
-
-    CBORHandle_t xTcpConnReport = CBOR_New( 0 );
-    CBOR_AssignKeyWithMap(
-        xTcpConnReport, DEFENDER_TCP_CONN_TAG, xTcpConnMetrics );
-    CBOR_Delete( &xTcpConnMetrics );
-
-    return xTcpConnReport;
+    CBOR_EncodeKeyWithMap( pxEncoder, DEFENDER_TCP_CONN_TAG, 1 );
+    CBOR_EncodeKeyWithMap( pxEncoder, DEFENDER_EST_CONN_TAG, 1 );
+    CBOR_EncodeKeyWithInt( pxEncoder, DEFENDER_TOTAL_TAG, TcpConnGet() );
 }
@@ -27,16 +27,12 @@
 static struct DefenderMetric_s xDefenderMetricUptimeS =
 {
     UptimeRefresh,
-    UptimeReportGet,
+    UptimeReportEncode,
 };
 
 DefenderMetric_t xDefenderMetricUptime = &xDefenderMetricUptimeS;
 
-CBORHandle_t UptimeReportGet( void )
+void UptimeReportEncode( CBOREncoder_t * pxEncoder )
 {
-    CBORHandle_t xUptimeMetrics = CBOR_New( 0 );
-
-    CBOR_AppendKeyWithInt( xUptimeMetrics, "ut", UptimeSecondsGet() );
-
-    return xUptimeMetrics;
+    CBOR_EncodeKeyWithInt( pxEncoder, "ut", UptimeSecondsGet() );
 }
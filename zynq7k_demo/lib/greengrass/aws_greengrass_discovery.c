@@ -64,8 +64,78 @@
 #define ggdJSON_FILE_HOST_ADDRESS    "HostAddress"
 #define ggdJSON_FILE_CERTIFICATE     "CAs"
 #define ggdJSON_FILE_PORT_NUMBER     "PortNumber"
+#define ggdJSON_FILE_GROUPS          "GGGroups"
+#define ggdJSON_FILE_CORES           "Cores"
+#define ggdJSON_FILE_CONNECTIVITY    "Connectivity"
 /** @} */
 
+/**
+ * @brief Streaming parser: lexer states.
+ */
+/** @{ */
+#define ggdSTREAM_LEX_BETWEEN_TOKENS    ( ( uint8_t ) 0 )
+#define ggdSTREAM_LEX_STRING            ( ( uint8_t ) 1 )
+#define ggdSTREAM_LEX_STRING_ESCAPE     ( ( uint8_t ) 2 )
+#define ggdSTREAM_LEX_STRING_UNICODE    ( ( uint8_t ) 3 )
+#define ggdSTREAM_LEX_SCALAR            ( ( uint8_t ) 4 )
+/** @} */
+
+/**
+ * @brief Streaming parser: what a container holds, from its position in
+ * the document.
+ */
+/** @{ */
+#define ggdSTREAM_ROLE_OTHER           ( ( uint8_t ) 0 )
+#define ggdSTREAM_ROLE_ROOT            ( ( uint8_t ) 1 )
+#define ggdSTREAM_ROLE_GROUPS          ( ( uint8_t ) 2 )
+#define ggdSTREAM_ROLE_GROUP           ( ( uint8_t ) 3 )
+#define ggdSTREAM_ROLE_CORES           ( ( uint8_t ) 4 )
+#define ggdSTREAM_ROLE_CORE            ( ( uint8_t ) 5 )
+#define ggdSTREAM_ROLE_CONNECTIVITY    ( ( uint8_t ) 6 )
+#define ggdSTREAM_ROLE_ENTRY           ( ( uint8_t ) 7 )
+#define ggdSTREAM_ROLE_CAS             ( ( uint8_t ) 8 )
+/** @} */
+
+/**
+ * @brief Streaming parser: discovery keys, index in pcStreamKeys.
+ */
+/** @{ */
+#define ggdSTREAM_KEY_NONE            ( ( uint8_t ) 0 )
+#define ggdSTREAM_KEY_GROUPS          ( ( uint8_t ) 1 )
+#define ggdSTREAM_KEY_GROUPID         ( ( uint8_t ) 2 )
+#define ggdSTREAM_KEY_CORES           ( ( uint8_t ) 3 )
+#define ggdSTREAM_KEY_THING_ARN       ( ( uint8_t ) 4 )
+#define ggdSTREAM_KEY_CONNECTIVITY    ( ( uint8_t ) 5 )
+#define ggdSTREAM_KEY_HOST_ADDRESS    ( ( uint8_t ) 6 )
+#define ggdSTREAM_KEY_PORT_NUMBER     ( ( uint8_t ) 7 )
+#define ggdSTREAM_KEY_CERTIFICATE     ( ( uint8_t ) 8 )
+#define ggdSTREAM_KEY_COUNT           ( ( uint8_t ) 9 )
+/** @} */
+
+/**
+ * @brief Streaming parser: what is done with the string or scalar being parsed.
+ */
+/** @{ */
+#define ggdSTREAM_VALUE_IGNORE          ( ( uint8_t ) 0 )
+#define ggdSTREAM_VALUE_KEY             ( ( uint8_t ) 1 )
+#define ggdSTREAM_VALUE_GROUPID         ( ( uint8_t ) 2 )
+#define ggdSTREAM_VALUE_THING_ARN       ( ( uint8_t ) 3 )
+#define ggdSTREAM_VALUE_HOST_ADDRESS    ( ( uint8_t ) 4 )
+#define ggdSTREAM_VALUE_PORT_NUMBER     ( ( uint8_t ) 5 )
+#define ggdSTREAM_VALUE_CERTIFICATE     ( ( uint8_t ) 6 )
+/** @} */
+
+/**
+ * @brief Deepest nesting supported by the streaming parser, limited by
+ * the width of GGD_JSONStream_t::ulArrayMask.
+ */
+#define ggdSTREAM_MAX_NESTING    ( ( uint8_t ) 32 )
+
+/**
+ * @brief Highest valid port number.
+ */
+#define ggdMAX_PORT_NUMBER       ( ( uint32_t ) 0xFFFF )
+
 /**
  * @brief HTTP command to retrieve JSON file from the Cloud.
  */
@@ -103,6 +173,22 @@ char ggdCLOUD_DISCOVERY_ADDRESS[ggdCLOUD_DISCOVERY_ADDRESS_BYTES + 1];
  */
 #define ggdLOOP_BACK_IP            "127.0.0.1"
 
+/**
+ * @brief Keys recognized by the streaming parser, indexed by ggdSTREAM_KEY_*.
+ */
+static const char * const pcStreamKeys[ ggdSTREAM_KEY_COUNT ] = /*lint !e971 can use char without signed/unsigned. */
+{
+    NULL,
+    ggdJSON_FILE_GROUPS,
+    ggdJSON_FILE_GROUPID,
+    ggdJSON_FILE_CORES,
+    ggdJSON_FILE_THING_ARN,
+    ggdJSON_FILE_CONNECTIVITY,
+    ggdJSON_FILE_HOST_ADDRESS,
+    ggdJSON_FILE_PORT_NUMBER,
+    ggdJSON_FILE_CERTIFICATE
+};
+
 /**
  * @brief JSON parsing helper functions.
  *
@@ -144,6 +230,46 @@ static BaseType_t prvIsIPvalid( const char * pcIP,
                                 uint32_t ulIPlength );
 /** @} */
 
+/**
+ * @brief Streaming parser helper functions.
+ *
+ * The discovery document is tokenized one character at a time. Each container
+ * is given a role from its parent's role and the key that introduced it, and
+ * strings and scalars are routed to the field they belong to as they are read.
+ * Entries and certificate of a core or group are kept tentatively and dropped
+ * when the core or group closes without matching.
+ */
+/** @{ */
+static BaseType_t prvStreamBetweenTokens( GGD_JSONStream_t * pxStream,
+                                          const char cChar ); /*lint !e971 can use char without signed/unsigned. */
+static BaseType_t prvStreamOpen( GGD_JSONStream_t * pxStream,
+                                 const BaseType_t xIsArray );
+static BaseType_t prvStreamClose( GGD_JSONStream_t * pxStream,
+                                  const BaseType_t xIsArray );
+static uint8_t prvStreamRole( const GGD_JSONStream_t * pxStream );
+static void prvStreamValueStart( GGD_JSONStream_t * pxStream );
+static void prvStreamValueChar( GGD_JSONStream_t * pxStream,
+                                const char cChar ); /*lint !e971 can use char without signed/unsigned. */
+static void prvStreamValueEnd( GGD_JSONStream_t * pxStream );
+static void prvStreamMatchChar( GGD_JSONStream_t * pxStream,
+                                const char * pcMatchString, /*lint !e971 can use char without signed/unsigned. */
+                                const char cChar );         /*lint !e971 can use char without signed/unsigned. */
+static BaseType_t prvStreamMatchEnd( const GGD_JSONStream_t * pxStream,
+                                     const char * pcMatchString ); /*lint !e971 can use char without signed/unsigned. */
+/** @} */
+
+/**
+ * @brief Try the connectivity entries of the selected core in turn, starting
+ * with the fastest one when ggdconfigPARALLEL_PROBE is enabled.
+ *
+ * On success the host address is copied after the certificate in pcBuffer,
+ * so pxHostAddressData does not reference pxStream.
+ */
+static BaseType_t prvGGDConnectToEntries( const GGD_JSONStream_t * pxStream,
+                                          char * pcBuffer, /*lint !e971 can use char without signed/unsigned. */
+                                          const uint32_t ulBufferSize,
+                                          GGD_HostAddressData_t * pxHostAddressData );
+
 /**
  * @brief Search for length field in server HTTP response
  *
@@ -161,9 +287,12 @@ BaseType_t GGD_GetGGCIPandCertificate( char * pcBuffer, /*lint !e971 can use cha
 {
     Socket_t xSocket;
     uint32_t ulJSONFileSize = 0;
-    BaseType_t xJSONFileRetrieveCompleted = pdFALSE;
+    uint32_t ulByteLeft;
     uint32_t ulByteRead = 0;
+    uint32_t ulReadSize;
     BaseType_t xStatus;
+    GGD_JSONStream_t xStream;
+    char cChunk[ ggdconfigJSON_STREAM_CHUNK_SIZE ]; /*lint !e971 can use char without signed/unsigned. */
 
     configASSERT( pxHostAddressData != NULL );
     configASSERT( pcBuffer != NULL );
@@ -177,46 +306,47 @@ BaseType_t GGD_GetGGCIPandCertificate( char * pcBuffer, /*lint !e971 can use cha
 
     if( xStatus == pdPASS )
     {
-        /* Loop until the full JSON is retrieved. */
-        do {
-            xStatus = GGD_JSONRequestGetFile( &xSocket,
-                                              &pcBuffer[ulByteRead],
-                                              ulBufferSize - ulByteRead,
-                                              &ulByteRead,
-                                              &xJSONFileRetrieveCompleted,
-                                              ulJSONFileSize ); /*lint !e644 ulJSONFileSize has been initialized if code reaches here. */
-        } while ( ( xStatus == pdPASS ) && ( xJSONFileRetrieveCompleted != pdTRUE ) && ( ulBufferSize - ulByteRead ) > 0 );
+        /* The JSON file is parsed as it is received, only the certificate
+         * of the selected group is written to pcBuffer. */
+        GGD_JSONStreamInit( &xStream, NULL, pcBuffer, ulBufferSize );
 
-        /* If the JSON file was not completely received and there
-         * is no space left in the buffer, it means that the buffer
-         * is not large enough to hold the complete GreenGrass
-         * Discovery document. The user should increase the size of
-         * the buffer. */
-        if( ( xJSONFileRetrieveCompleted == pdFALSE ) && ( ( ulBufferSize - ulByteRead ) ==  0 ) )
-        {
-            ggdconfigPRINT( "[ERROR] The supplied buffer is not large enough to hold the GreenGrass discovery document. \r\n" );
-            ggdconfigPRINT( "[ERROR] Consider increasing the size of the supplied buffer. \r\n" );
-        }
+        /* GGD_JSONRequestGetSize counts the '\0' added at the end. */
+        ulByteLeft = ulJSONFileSize - ( uint32_t ) 1; /*lint !e644 ulJSONFileSize has been initialized if code reaches here. */
 
-        if( xSocket != SOCKETS_INVALID_SOCKET )             /* Check connection is closed. */
+        /* Stop as soon as a group is selected, the rest is not needed. */
+        while( ( xStatus == pdPASS ) &&
+               ( ulByteLeft > ( uint32_t ) 0 ) &&
+               ( xStream.xGroupSelected != pdTRUE ) )
         {
-            GGD_JSONRequestAbort( &xSocket );
-            xStatus = pdFAIL;
+            ulReadSize = ( ulByteLeft < ( uint32_t ) sizeof( cChunk ) ) ? ulByteLeft : ( uint32_t ) sizeof( cChunk );
+
+            xStatus = GGD_SecureConnect_Read( cChunk,
+                                              ulReadSize,
+                                              xSocket,
+                                              &ulByteRead );
+
+            if( xStatus == pdPASS )
+            {
+                ulByteLeft -= ulByteRead;
+                xStatus = GGD_JSONStreamParse( &xStream, cChunk, ulByteRead );
+            }
         }
 
-        if( xJSONFileRetrieveCompleted != pdTRUE )
+        GGD_JSONRequestAbort( &xSocket );
+
+        if( ( xStatus == pdPASS ) && ( xStream.xGroupSelected != pdTRUE ) )
         {
+            ggdconfigPRINT( "JSON parsing: Couldn't find Green Grass Core\r\n" );
             xStatus = pdFAIL;
         }
     }
 
     if( xStatus == pdPASS )
     {
-        xStatus = GGD_GetIPandCertificateFromJSON( pcBuffer,
-                                                   ulJSONFileSize,
-                                                   NULL,
-                                                   pxHostAddressData,
-                                                   pdTRUE );
+        xStatus = prvGGDConnectToEntries( &xStream,
+                                          pcBuffer,
+                                          ulBufferSize,
+                                          pxHostAddressData );
     }
 
     return xStatus;
@@ -241,6 +371,23 @@ BaseType_t GGD_JSONRequestStart( Socket_t * pxSocket )
                                          ggdconfigTCP_RECEIVE_TIMEOUT_MS,
                                          ggdconfigTCP_SEND_TIMEOUT_MS );
 
+    #if ( ggdconfigKEEP_STANDBY_CONNECTION == 1 )
+        if( xStatus == pdPASS )
+        {
+            SocketsStandbyEndpoint_t xEndpoint = { 0 };
+
+            /* The options GGD_SecureConnect_Connect() sets for a DNS name. */
+            xEndpoint.pcHostName = xHostAddressData.pcHostAddress;
+            xEndpoint.usPort = xHostAddressData.usPort;
+            xEndpoint.xServerNameIndication = pdTRUE;
+
+            if( SOCKETS_StandbyAdd( &xEndpoint ) < 0 )
+            {
+                ggdconfigPRINT( "No standby connection kept for the discovery endpoint\r\n" );
+            }
+        }
+    #endif
+
     if( xStatus == pdPASS )
     {
         (void)snprintf(ggdCLOUD_DISCOVERY_ADDRESS,ggdCLOUD_DISCOVERY_ADDRESS_BYTES + 1,
@@ -446,6 +593,163 @@ void GGD_JSONRequestAbort( Socket_t * pxSocket )
 
 /*-----------------------------------------------------------*/
 
+void GGD_JSONStreamInit( GGD_JSONStream_t * pxStream,
+                         const HostParameters_t * pxHostParameters,
+                         char * pcCertificateBuffer, /*lint !e971 can use char without signed/unsigned. */
+                         const uint32_t ulCertificateBufferSize )
+{
+    configASSERT( pxStream != NULL );
+    configASSERT( pcCertificateBuffer != NULL );
+    configASSERT( ulCertificateBufferSize > ( uint32_t ) 0 );
+
+    memset( pxStream, 0, sizeof( GGD_JSONStream_t ) );
+
+    pxStream->pxHostParameters = pxHostParameters;
+    pxStream->pcCertificate = pcCertificateBuffer;
+    pxStream->ulCertificateBufferSize = ulCertificateBufferSize;
+    pxStream->ucLexState = ggdSTREAM_LEX_BETWEEN_TOKENS;
+    pxStream->xGroupSelected = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t GGD_JSONStreamParse( GGD_JSONStream_t * pxStream,
+                                const char * pcChunk, /*lint !e971 can use char without signed/unsigned. */
+                                const uint32_t ulChunkSize )
+{
+    BaseType_t xStatus = pdPASS;
+    uint32_t ulIndex = 0;
+    char cChar; /*lint !e971 can use char without signed/unsigned. */
+
+    configASSERT( pxStream != NULL );
+    configASSERT( pcChunk != NULL );
+
+    while( ( xStatus == pdPASS ) && ( ulIndex < ulChunkSize ) )
+    {
+        cChar = pcChunk[ ulIndex ];
+        ulIndex++;
+
+        switch( pxStream->ucLexState )
+        {
+            case ggdSTREAM_LEX_STRING:
+
+                if( cChar == '\\' )
+                {
+                    pxStream->ucLexState = ggdSTREAM_LEX_STRING_ESCAPE;
+                }
+                else if( cChar == '"' )
+                {
+                    pxStream->ucLexState = ggdSTREAM_LEX_BETWEEN_TOKENS;
+                    prvStreamValueEnd( pxStream );
+                }
+                else
+                {
+                    prvStreamValueChar( pxStream, cChar );
+                }
+
+                break;
+
+            case ggdSTREAM_LEX_STRING_ESCAPE:
+                pxStream->ucLexState = ggdSTREAM_LEX_STRING;
+
+                switch( cChar )
+                {
+                    case 'n':
+                        prvStreamValueChar( pxStream, '\n' );
+                        break;
+
+                    case 'r':
+                        prvStreamValueChar( pxStream, '\r' );
+                        break;
+
+                    case 't':
+                        prvStreamValueChar( pxStream, '\t' );
+                        break;
+
+                    case 'b':
+                        prvStreamValueChar( pxStream, '\b' );
+                        break;
+
+                    case 'f':
+                        prvStreamValueChar( pxStream, '\f' );
+                        break;
+
+                    case 'u':
+                        pxStream->ucUnicodeCount = 0;
+                        pxStream->ucLexState = ggdSTREAM_LEX_STRING_UNICODE;
+                        break;
+
+                    default:
+                        /* '"', '\\' and '/' stand for themselves. */
+                        prvStreamValueChar( pxStream, cChar );
+                        break;
+                }
+
+                break;
+
+            case ggdSTREAM_LEX_STRING_UNICODE:
+                pxStream->ucUnicodeCount++;
+
+                /* None of the discovery fields use non ASCII characters,
+                 * a placeholder is enough to make sure they do not match. */
+                if( pxStream->ucUnicodeCount == ( uint8_t ) 4 )
+                {
+                    pxStream->ucLexState = ggdSTREAM_LEX_STRING;
+                    prvStreamValueChar( pxStream, '?' );
+                }
+
+                break;
+
+            case ggdSTREAM_LEX_SCALAR:
+
+                if( ( cChar == ',' ) || ( cChar == '}' ) || ( cChar == ']' ) ||
+                    ( cChar == ' ' ) || ( cChar == '\t' ) || ( cChar == '\r' ) || ( cChar == '\n' ) )
+                {
+                    pxStream->ucLexState = ggdSTREAM_LEX_BETWEEN_TOKENS;
+                    prvStreamValueEnd( pxStream );
+
+                    /* The delimiter is handled between tokens. */
+                    xStatus = prvStreamBetweenTokens( pxStream, cChar );
+                }
+                else
+                {
+                    prvStreamValueChar( pxStream, cChar );
+                }
+
+                break;
+
+            default:
+                xStatus = prvStreamBetweenTokens( pxStream, cChar );
+                break;
+        }
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t GGD_JSONStreamGetHostAddressData( const GGD_JSONStream_t * pxStream,
+                                             const uint8_t ucEntry,
+                                             GGD_HostAddressData_t * pxHostAddressData )
+{
+    BaseType_t xStatus = pdFAIL;
+
+    configASSERT( pxStream != NULL );
+    configASSERT( pxHostAddressData != NULL );
+
+    if( ( pxStream->xGroupSelected == pdTRUE ) && ( ucEntry < pxStream->ucEntryCount ) )
+    {
+        pxHostAddressData->pcHostAddress = pxStream->xEntries[ ucEntry ].cHostAddress;
+        pxHostAddressData->usPort = pxStream->xEntries[ ucEntry ].usPort;
+        pxHostAddressData->pcCertificate = pxStream->pcCertificate;
+        /* Same convention as GGD_GetIPandCertificateFromJSON, the size includes the '\0'. */
+        pxHostAddressData->ulCertificateSize = pxStream->ulCertificateLength + ( uint32_t ) 1;
+        xStatus = pdPASS;
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t GGD_GetIPandCertificateFromJSON( char * pcJSONFile, /*lint !e971 can use char without signed/unsigned. */
                                             const uint32_t ulJSONFileSize,
                                             const HostParameters_t * pxHostParameters,
@@ -864,6 +1168,582 @@ static BaseType_t prvGGDGetIPOnInterface( char * pcJSONFile, /*lint !e971 can us
 }
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvGGDConnectToEntries( const GGD_JSONStream_t * pxStream,
+                                          char * pcBuffer, /*lint !e971 can use char without signed/unsigned. */
+                                          const uint32_t ulBufferSize,
+                                          GGD_HostAddressData_t * pxHostAddressData )
+{
+    Socket_t xSocket;
+    BaseType_t xStatus = pdFAIL;
+    uint8_t ucAttempt;
+    uint8_t ucFirstEntry = 0;
+    uint32_t ulHostAddressSize;
+
+    #if ( ggdconfigPARALLEL_PROBE == 1 )
+        {
+            /* Start with the entry that accepted a TCP connection first, the
+             * others are only tried if the TLS connection to it fails. */
+            if( pxStream->ucEntryCount > ( uint8_t ) 1 )
+            {
+                ( void ) GGD_SecureConnect_Probe( pxStream->xEntries,
+                                                  pxStream->ucEntryCount,
+                                                  ggdconfigPROBE_TIMEOUT_MS,
+                                                  &ucFirstEntry );
+            }
+        }
+    #endif
+
+    for( ucAttempt = 0; ucAttempt < pxStream->ucEntryCount; ucAttempt++ )
+    {
+        ( void ) GGD_JSONStreamGetHostAddressData( pxStream,
+                                                   ( uint8_t ) ( ( ucFirstEntry + ucAttempt ) % pxStream->ucEntryCount ),
+                                                   pxHostAddressData );
+
+        if( prvIsIPvalid( pxHostAddressData->pcHostAddress,
+                          strlen( pxHostAddressData->pcHostAddress ) ) == pdTRUE )
+        {
+            if( GGD_SecureConnect_Connect( pxHostAddressData,
+                                           &xSocket,
+                                           ggdconfigTCP_RECEIVE_TIMEOUT_MS,
+                                           ggdconfigTCP_SEND_TIMEOUT_MS )
+                == pdPASS )
+            {
+                /* Interface found, disconnect. */
+                GGD_SecureConnect_Disconnect( &xSocket );
+                xStatus = pdPASS;
+                break;
+            }
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        /* The certificate is already at the beginning of pcBuffer. */
+        ulHostAddressSize = ( uint32_t ) strlen( pxHostAddressData->pcHostAddress ) + ( uint32_t ) 1;
+
+        if( ( ulBufferSize - pxHostAddressData->ulCertificateSize ) >= ulHostAddressSize )
+        {
+            memcpy( &pcBuffer[ pxHostAddressData->ulCertificateSize ],
+                    pxHostAddressData->pcHostAddress,
+                    ulHostAddressSize );
+            pxHostAddressData->pcHostAddress = &pcBuffer[ pxHostAddressData->ulCertificateSize ];
+        }
+        else
+        {
+            ggdconfigPRINT( "[ERROR] The supplied buffer is not large enough to hold the GreenGrass core address. \r\n" );
+            xStatus = pdFAIL;
+        }
+    }
+    else
+    {
+        ggdconfigPRINT( "GGD - Can't connect to greengrass Core\r\n" );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamBetweenTokens( GGD_JSONStream_t * pxStream,
+                                          const char cChar ) /*lint !e971 can use char without signed/unsigned. */
+{
+    BaseType_t xStatus = pdPASS;
+
+    switch( cChar )
+    {
+        case '{':
+            xStatus = prvStreamOpen( pxStream, pdFALSE );
+            break;
+
+        case '[':
+            xStatus = prvStreamOpen( pxStream, pdTRUE );
+            break;
+
+        case '}':
+            xStatus = prvStreamClose( pxStream, pdFALSE );
+            break;
+
+        case ']':
+            xStatus = prvStreamClose( pxStream, pdTRUE );
+            break;
+
+        case ',':
+
+            /* Inside an object, a key follows. */
+            if( ( pxStream->ucDepth > ( uint8_t ) 0 ) &&
+                ( ( pxStream->ulArrayMask & ( ( uint32_t ) 1 << ( pxStream->ucDepth - ( uint8_t ) 1 ) ) ) == ( uint32_t ) 0 ) )
+            {
+                pxStream->xExpectKey = pdTRUE;
+            }
+
+            pxStream->ucKey = ggdSTREAM_KEY_NONE;
+            break;
+
+        case ':':
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+
+        case '"':
+            prvStreamValueStart( pxStream );
+            pxStream->ucLexState = ggdSTREAM_LEX_STRING;
+            break;
+
+        default:
+            /* Number, true, false or null. */
+            prvStreamValueStart( pxStream );
+            pxStream->ucLexState = ggdSTREAM_LEX_SCALAR;
+            prvStreamValueChar( pxStream, cChar );
+            break;
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvStreamRole( const GGD_JSONStream_t * pxStream )
+{
+    uint8_t ucRole = ggdSTREAM_ROLE_OTHER;
+
+    if( ( pxStream->ucDepth > ( uint8_t ) 0 ) &&
+        ( pxStream->ucDepth <= ( uint8_t ) ggdJSON_STREAM_MAX_DEPTH ) )
+    {
+        ucRole = pxStream->ucRoles[ pxStream->ucDepth - ( uint8_t ) 1 ];
+    }
+
+    return ucRole;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamOpen( GGD_JSONStream_t * pxStream,
+                                 const BaseType_t xIsArray )
+{
+    BaseType_t xStatus = pdPASS;
+    const uint8_t ucParentRole = prvStreamRole( pxStream );
+    const BaseType_t xAutoSelect = ( pxStream->pxHostParameters == NULL ) ? pdTRUE : pdFALSE;
+    uint8_t ucRole = ggdSTREAM_ROLE_OTHER;
+
+    if( pxStream->ucDepth >= ggdSTREAM_MAX_NESTING )
+    {
+        ggdconfigPRINT( "JSON parsing: Document nested too deep\r\n" );
+        xStatus = pdFAIL;
+    }
+    else if( pxStream->ucDepth == ( uint8_t ) 0 )
+    {
+        ucRole = ( xIsArray == pdTRUE ) ? ggdSTREAM_ROLE_OTHER : ggdSTREAM_ROLE_ROOT;
+    }
+    else if( pxStream->xGroupSelected == pdTRUE )
+    {
+        /* Nothing left to collect. */
+    }
+    else if( xIsArray == pdTRUE )
+    {
+        if( ( ucParentRole == ggdSTREAM_ROLE_ROOT ) && ( pxStream->ucKey == ggdSTREAM_KEY_GROUPS ) )
+        {
+            ucRole = ggdSTREAM_ROLE_GROUPS;
+        }
+        else if( ( ucParentRole == ggdSTREAM_ROLE_GROUP ) && ( pxStream->ucKey == ggdSTREAM_KEY_CORES ) )
+        {
+            ucRole = ggdSTREAM_ROLE_CORES;
+        }
+        else if( ( ucParentRole == ggdSTREAM_ROLE_GROUP ) && ( pxStream->ucKey == ggdSTREAM_KEY_CERTIFICATE ) )
+        {
+            ucRole = ggdSTREAM_ROLE_CAS;
+        }
+        else if( ( ucParentRole == ggdSTREAM_ROLE_CORE ) && ( pxStream->ucKey == ggdSTREAM_KEY_CONNECTIVITY ) )
+        {
+            ucRole = ggdSTREAM_ROLE_CONNECTIVITY;
+        }
+        else
+        {
+            /* Not a discovery container. */
+        }
+    }
+    else
+    {
+        if( ucParentRole == ggdSTREAM_ROLE_GROUPS )
+        {
+            /* Entries and certificate of a previous, non matching, group
+             * are discarded. */
+            ucRole = ggdSTREAM_ROLE_GROUP;
+            pxStream->ucEntryCount = 0;
+            pxStream->ulCertificateLength = 0;
+            pxStream->xGroupHasCertificate = pdFALSE;
+            pxStream->xCertificateOverflow = pdFALSE;
+            pxStream->xGroupMatch = xAutoSelect;
+        }
+        else if( ucParentRole == ggdSTREAM_ROLE_CORES )
+        {
+            ucRole = ggdSTREAM_ROLE_CORE;
+            pxStream->ucCoreEntryStart = pxStream->ucEntryCount;
+            pxStream->ucCoreInterface = 0;
+            pxStream->xCoreMatch = xAutoSelect;
+        }
+        else if( ucParentRole == ggdSTREAM_ROLE_CONNECTIVITY )
+        {
+            ucRole = ggdSTREAM_ROLE_ENTRY;
+            pxStream->ucCoreInterface++;
+            pxStream->xEntryHasHost = pdFALSE;
+            pxStream->xEntryHasPort = pdFALSE;
+
+            /* Interfaces are numbered from 1, as in prvGGDGetIPOnInterface. */
+            pxStream->xEntryStore =
+                ( ( pxStream->ucEntryCount < ( uint8_t ) ggdconfigMAX_CONNECTIVITY_ENTRIES ) &&
+                  ( ( xAutoSelect == pdTRUE ) ||
+                    ( pxStream->ucCoreInterface == pxStream->pxHostParameters->ucInterface ) ) ) ? pdTRUE : pdFALSE;
+        }
+        else
+        {
+            /* Not a discovery container. */
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        if( pxStream->ucDepth < ( uint8_t ) ggdJSON_STREAM_MAX_DEPTH )
+        {
+            pxStream->ucRoles[ pxStream->ucDepth ] = ucRole;
+        }
+
+        if( xIsArray == pdTRUE )
+        {
+            pxStream->ulArrayMask |= ( uint32_t ) 1 << pxStream->ucDepth;
+        }
+        else
+        {
+            pxStream->ulArrayMask &= ~( ( uint32_t ) 1 << pxStream->ucDepth );
+        }
+
+        pxStream->ucDepth++;
+        pxStream->ucKey = ggdSTREAM_KEY_NONE;
+        pxStream->xExpectKey = ( xIsArray == pdTRUE ) ? pdFALSE : pdTRUE;
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamClose( GGD_JSONStream_t * pxStream,
+                                  const BaseType_t xIsArray )
+{
+    BaseType_t xStatus = pdPASS;
+    uint8_t ucRole;
+    BaseType_t xTopIsArray;
+
+    if( pxStream->ucDepth == ( uint8_t ) 0 )
+    {
+        xStatus = pdFAIL;
+    }
+    else
+    {
+        xTopIsArray = ( ( pxStream->ulArrayMask & ( ( uint32_t ) 1 << ( pxStream->ucDepth - ( uint8_t ) 1 ) ) ) != ( uint32_t ) 0 ) ? pdTRUE : pdFALSE;
+
+        if( xTopIsArray != xIsArray )
+        {
+            xStatus = pdFAIL;
+        }
+    }
+
+    if( xStatus == pdPASS )
+    {
+        ucRole = prvStreamRole( pxStream );
+        pxStream->ucDepth--;
+        pxStream->ucKey = ggdSTREAM_KEY_NONE;
+        pxStream->xExpectKey = pdFALSE;
+
+        switch( ucRole )
+        {
+            case ggdSTREAM_ROLE_ENTRY:
+
+                if( ( pxStream->xEntryStore == pdTRUE ) &&
+                    ( pxStream->xEntryHasHost == pdTRUE ) &&
+                    ( pxStream->xEntryHasPort == pdTRUE ) )
+                {
+                    pxStream->ucEntryCount++;
+                }
+
+                pxStream->xEntryStore = pdFALSE;
+                break;
+
+            case ggdSTREAM_ROLE_CORE:
+
+                if( pxStream->xCoreMatch != pdTRUE )
+                {
+                    pxStream->ucEntryCount = pxStream->ucCoreEntryStart;
+                }
+
+                break;
+
+            case ggdSTREAM_ROLE_GROUP:
+
+                if( pxStream->xGroupMatch == pdTRUE )
+                {
+                    if( pxStream->xCertificateOverflow == pdTRUE )
+                    {
+                        ggdconfigPRINT( "[ERROR] The supplied buffer is not large enough to hold the GreenGrass group certificate. \r\n" );
+                        ggdconfigPRINT( "[ERROR] Consider increasing the size of the supplied buffer. \r\n" );
+                        xStatus = pdFAIL;
+                    }
+                    else if( ( pxStream->xGroupHasCertificate == pdTRUE ) &&
+                             ( pxStream->ucEntryCount > ( uint8_t ) 0 ) )
+                    {
+                        pxStream->xGroupSelected = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Keep looking, a later group may match. */
+                    }
+                }
+
+                break;
+
+            default:
+                break;
+        }
+    }
+    else
+    {
+        ggdconfigPRINT( "JSON parsing: Unbalanced '%c'\r\n", ( xIsArray == pdTRUE ) ? ']' : '}' );
+    }
+
+    return xStatus;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamValueStart( GGD_JSONStream_t * pxStream )
+{
+    const uint8_t ucRole = prvStreamRole( pxStream );
+    const BaseType_t xAutoSelect = ( pxStream->pxHostParameters == NULL ) ? pdTRUE : pdFALSE;
+
+    pxStream->ucValue = ggdSTREAM_VALUE_IGNORE;
+    pxStream->usMatchIndex = 0;
+    pxStream->xValueMatches = pdTRUE;
+    pxStream->ulNumber = 0;
+
+    if( pxStream->xExpectKey == pdTRUE )
+    {
+        pxStream->ucValue = ggdSTREAM_VALUE_KEY;
+        pxStream->ucKeyLength = 0;
+        pxStream->xExpectKey = pdFALSE;
+    }
+    else if( ( ucRole == ggdSTREAM_ROLE_GROUP ) &&
+             ( pxStream->ucKey == ggdSTREAM_KEY_GROUPID ) &&
+             ( xAutoSelect == pdFALSE ) )
+    {
+        pxStream->ucValue = ggdSTREAM_VALUE_GROUPID;
+    }
+    else if( ( ucRole == ggdSTREAM_ROLE_CORE ) &&
+             ( pxStream->ucKey == ggdSTREAM_KEY_THING_ARN ) &&
+             ( xAutoSelect == pdFALSE ) )
+    {
+        pxStream->ucValue = ggdSTREAM_VALUE_THING_ARN;
+    }
+    else if( ( ucRole == ggdSTREAM_ROLE_ENTRY ) && ( pxStream->xEntryStore == pdTRUE ) )
+    {
+        if( pxStream->ucKey == ggdSTREAM_KEY_HOST_ADDRESS )
+        {
+            pxStream->ucValue = ggdSTREAM_VALUE_HOST_ADDRESS;
+        }
+        else if( pxStream->ucKey == ggdSTREAM_KEY_PORT_NUMBER )
+        {
+            pxStream->ucValue = ggdSTREAM_VALUE_PORT_NUMBER;
+        }
+        else
+        {
+            /* Id, Metadata... */
+        }
+    }
+    else if( ( ucRole == ggdSTREAM_ROLE_CAS ) && ( pxStream->xGroupHasCertificate == pdFALSE ) )
+    {
+        /* Only the first CA of the group is kept. */
+        pxStream->ucValue = ggdSTREAM_VALUE_CERTIFICATE;
+        pxStream->ulCertificateLength = 0;
+    }
+    else
+    {
+        /* Not a discovery field. */
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamValueChar( GGD_JSONStream_t * pxStream,
+                                const char cChar ) /*lint !e971 can use char without signed/unsigned. */
+{
+    GGD_ConnectivityEntry_t * pxEntry = &pxStream->xEntries[ pxStream->ucEntryCount ];
+
+    switch( pxStream->ucValue )
+    {
+        case ggdSTREAM_VALUE_KEY:
+
+            /* A key longer than the buffer is not a discovery key,
+             * ucKeyLength then stays one past the buffer. */
+            if( pxStream->ucKeyLength < ( uint8_t ) ggdJSON_STREAM_KEY_LENGTH )
+            {
+                pxStream->cKey[ pxStream->ucKeyLength ] = cChar;
+                pxStream->ucKeyLength++;
+            }
+            else
+            {
+                pxStream->ucKeyLength = ( uint8_t ) ggdJSON_STREAM_KEY_LENGTH + ( uint8_t ) 1;
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_GROUPID:
+            prvStreamMatchChar( pxStream, pxStream->pxHostParameters->pcGroupName, cChar );
+            break;
+
+        case ggdSTREAM_VALUE_THING_ARN:
+            prvStreamMatchChar( pxStream, pxStream->pxHostParameters->pcCoreAddress, cChar );
+            break;
+
+        case ggdSTREAM_VALUE_HOST_ADDRESS:
+
+            if( pxStream->usMatchIndex < ( uint16_t ) ggdconfigHOST_ADDRESS_MAX_LENGTH )
+            {
+                pxEntry->cHostAddress[ pxStream->usMatchIndex ] = cChar;
+                pxStream->usMatchIndex++;
+            }
+            else
+            {
+                pxStream->xValueMatches = pdFALSE;
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_PORT_NUMBER:
+
+            if( ( cChar >= '0' ) && ( cChar <= '9' ) && ( pxStream->ulNumber <= ggdMAX_PORT_NUMBER ) )
+            {
+                pxStream->ulNumber = ( pxStream->ulNumber * ( uint32_t ) ggJSON_CONVERTION_RADIX ) +
+                                     ( uint32_t ) ( cChar - '0' );
+                pxStream->usMatchIndex++;
+            }
+            else
+            {
+                pxStream->xValueMatches = pdFALSE;
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_CERTIFICATE:
+
+            /* Keep room for the '\0'. */
+            if( ( pxStream->ulCertificateLength + ( uint32_t ) 1 ) < pxStream->ulCertificateBufferSize )
+            {
+                pxStream->pcCertificate[ pxStream->ulCertificateLength ] = cChar;
+                pxStream->ulCertificateLength++;
+            }
+            else
+            {
+                pxStream->xCertificateOverflow = pdTRUE;
+            }
+
+            break;
+
+        default:
+            break;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamValueEnd( GGD_JSONStream_t * pxStream )
+{
+    GGD_ConnectivityEntry_t * pxEntry = &pxStream->xEntries[ pxStream->ucEntryCount ];
+    uint8_t ucKey;
+
+    switch( pxStream->ucValue )
+    {
+        case ggdSTREAM_VALUE_KEY:
+            pxStream->ucKey = ggdSTREAM_KEY_NONE;
+
+            for( ucKey = ggdSTREAM_KEY_GROUPS; ucKey < ggdSTREAM_KEY_COUNT; ucKey++ )
+            {
+                if( ( strlen( pcStreamKeys[ ucKey ] ) == ( size_t ) pxStream->ucKeyLength ) &&
+                    ( strncmp( pcStreamKeys[ ucKey ], pxStream->cKey, ( size_t ) pxStream->ucKeyLength ) == 0 ) )
+                {
+                    pxStream->ucKey = ucKey;
+                    break;
+                }
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_GROUPID:
+            pxStream->xGroupMatch = prvStreamMatchEnd( pxStream, pxStream->pxHostParameters->pcGroupName );
+            break;
+
+        case ggdSTREAM_VALUE_THING_ARN:
+            pxStream->xCoreMatch = prvStreamMatchEnd( pxStream, pxStream->pxHostParameters->pcCoreAddress );
+            break;
+
+        case ggdSTREAM_VALUE_HOST_ADDRESS:
+
+            if( ( pxStream->xValueMatches == pdTRUE ) && ( pxStream->usMatchIndex > ( uint16_t ) 0 ) )
+            {
+                pxEntry->cHostAddress[ pxStream->usMatchIndex ] = '\0';
+                pxStream->xEntryHasHost = pdTRUE;
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_PORT_NUMBER:
+
+            if( ( pxStream->xValueMatches == pdTRUE ) &&
+                ( pxStream->usMatchIndex > ( uint16_t ) 0 ) &&
+                ( pxStream->ulNumber <= ggdMAX_PORT_NUMBER ) )
+            {
+                pxEntry->usPort = ( uint16_t ) pxStream->ulNumber;
+                pxStream->xEntryHasPort = pdTRUE;
+            }
+
+            break;
+
+        case ggdSTREAM_VALUE_CERTIFICATE:
+            pxStream->pcCertificate[ pxStream->ulCertificateLength ] = '\0';
+            pxStream->xGroupHasCertificate = pdTRUE;
+            break;
+
+        default:
+            break;
+    }
+
+    pxStream->ucValue = ggdSTREAM_VALUE_IGNORE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStreamMatchChar( GGD_JSONStream_t * pxStream,
+                                const char * pcMatchString, /*lint !e971 can use char without signed/unsigned. */
+                                const char cChar )          /*lint !e971 can use char without signed/unsigned. */
+{
+    if( ( pxStream->xValueMatches == pdTRUE ) &&
+        ( pcMatchString[ pxStream->usMatchIndex ] == cChar ) )
+    {
+        pxStream->usMatchIndex++;
+    }
+    else
+    {
+        pxStream->xValueMatches = pdFALSE;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStreamMatchEnd( const GGD_JSONStream_t * pxStream,
+                                     const char * pcMatchString ) /*lint !e971 can use char without signed/unsigned. */
+{
+    BaseType_t xMatch = pdFALSE;
+
+    if( ( pxStream->xValueMatches == pdTRUE ) &&
+        ( pcMatchString[ pxStream->usMatchIndex ] == '\0' ) )
+    {
+        xMatch = pdTRUE;
+    }
+
+    return xMatch;
+}
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvCheckForContentLengthString( uint8_t * pucIndex,
                                                   const char cNewChar ) /*lint !e971 can use char without signed/unsigned. */
 {
@@ -43,10 +43,18 @@
 #include "aws_ggd_config.h"
 #include "aws_ggd_config_defaults.h"
 
+#if ( ggdconfigPARALLEL_PROBE == 1 )
+    /* The probe needs non-blocking connect and select, which the secure
+     * sockets API does not offer. */
+    #include "FreeRTOS_IP.h"
+    #include "FreeRTOS_Sockets.h"
+#endif
+
 /* Standard includes. */
 #include <string.h>
 
 #define helperMAX_IP_ADDRESS_OCTETS    4u
+#define helperLOOP_BACK_NETWORK        127UL
 
 /**
  * @brief This function return non 0 if it is an IP and 0 if it isn't
@@ -337,6 +345,147 @@ BaseType_t GGD_SecureConnect_Read( char * pcBuffer, /*lint !e971 can use char wi
 /*-----------------------------------------------------------*/
 
 
+#if ( ggdconfigPARALLEL_PROBE == 1 )
+
+    BaseType_t GGD_SecureConnect_Probe( const GGD_ConnectivityEntry_t * pxEntries,
+                                        const uint8_t ucEntryCount,
+                                        uint32_t ulTimeOut,
+                                        uint8_t * pucFirstConnected )
+    {
+        Socket_t xSockets[ ggdconfigMAX_CONNECTIVITY_ENTRIES ];
+        struct freertos_sockaddr xAddress;
+        SocketSet_t xSocketSet;
+        const TickType_t xDontBlock = 0;
+        TickType_t xTicksToWait = pdMS_TO_TICKS( ulTimeOut );
+        TimeOut_t xTimeOut;
+        EventBits_t xBits;
+        UBaseType_t uxPending = 0;
+        uint8_t ucEntry;
+        BaseType_t xResult;
+        BaseType_t xStatus = pdFAIL;
+
+        configASSERT( pxEntries != NULL );
+        configASSERT( pucFirstConnected != NULL );
+        configASSERT( ucEntryCount <= ( uint8_t ) ggdconfigMAX_CONNECTIVITY_ENTRIES );
+
+        xSocketSet = FreeRTOS_CreateSocketSet();
+
+        if( xSocketSet != NULL )
+        {
+            /* Start all the connections without waiting for them. */
+            for( ucEntry = 0; ucEntry < ucEntryCount; ucEntry++ )
+            {
+                xSockets[ ucEntry ] = FREERTOS_INVALID_SOCKET;
+
+                xAddress.sin_addr = prvIsIPaddress( pxEntries[ ucEntry ].cHostAddress );
+
+                if( ( xAddress.sin_addr == 0UL ) &&
+                    ( strchr( pxEntries[ ucEntry ].cHostAddress, ':' ) == NULL ) )
+                {
+                    xAddress.sin_addr = FreeRTOS_gethostbyname( pxEntries[ ucEntry ].cHostAddress );
+                }
+
+                /* FreeRTOS+TCP is IPv4 only, and there is nothing to probe
+                 * on the loopback network. */
+                if( ( xAddress.sin_addr != 0UL ) &&
+                    ( ( FreeRTOS_ntohl( xAddress.sin_addr ) >> 24 ) != helperLOOP_BACK_NETWORK ) )
+                {
+                    xSockets[ ucEntry ] = FreeRTOS_socket( FREERTOS_AF_INET,
+                                                           FREERTOS_SOCK_STREAM,
+                                                           FREERTOS_IPPROTO_TCP );
+                }
+
+                if( xSockets[ ucEntry ] != FREERTOS_INVALID_SOCKET )
+                {
+                    /* A zero receive timeout makes FreeRTOS_connect() return
+                     * as soon as the SYN is queued. */
+                    ( void ) FreeRTOS_setsockopt( xSockets[ ucEntry ],
+                                                  0,
+                                                  FREERTOS_SO_RCVTIMEO,
+                                                  &xDontBlock,
+                                                  sizeof( xDontBlock ) );
+
+                    xAddress.sin_port = FreeRTOS_htons( pxEntries[ ucEntry ].usPort );
+                    xResult = FreeRTOS_connect( xSockets[ ucEntry ], &xAddress, sizeof( xAddress ) );
+
+                    if( ( xResult == 0 ) || ( xResult == -pdFREERTOS_ERRNO_EWOULDBLOCK ) )
+                    {
+                        FreeRTOS_FD_SET( xSockets[ ucEntry ],
+                                         xSocketSet,
+                                         ( EventBits_t ) eSELECT_WRITE | ( EventBits_t ) eSELECT_EXCEPT );
+                        uxPending++;
+                    }
+                    else
+                    {
+                        ( void ) FreeRTOS_closesocket( xSockets[ ucEntry ] );
+                        xSockets[ ucEntry ] = FREERTOS_INVALID_SOCKET;
+                    }
+                }
+            }
+
+            /* Wait for the first connection to complete, dropping the ones
+             * that are refused or reset. */
+            vTaskSetTimeOutState( &xTimeOut );
+
+            while( ( xStatus == pdFAIL ) && ( uxPending > 0U ) )
+            {
+                ( void ) FreeRTOS_select( xSocketSet, xTicksToWait );
+
+                for( ucEntry = 0; ucEntry < ucEntryCount; ucEntry++ )
+                {
+                    if( xSockets[ ucEntry ] != FREERTOS_INVALID_SOCKET )
+                    {
+                        xBits = FreeRTOS_FD_ISSET( xSockets[ ucEntry ], xSocketSet );
+
+                        if( ( ( xBits & ( EventBits_t ) eSELECT_WRITE ) != 0U ) &&
+                            ( FreeRTOS_issocketconnected( xSockets[ ucEntry ] ) > 0 ) )
+                        {
+                            *pucFirstConnected = ucEntry;
+                            xStatus = pdPASS;
+                            break;
+                        }
+
+                        if( ( xBits & ( EventBits_t ) eSELECT_EXCEPT ) != 0U )
+                        {
+                            FreeRTOS_FD_CLR( xSockets[ ucEntry ], xSocketSet, ( EventBits_t ) eSELECT_ALL );
+                            ( void ) FreeRTOS_closesocket( xSockets[ ucEntry ] );
+                            xSockets[ ucEntry ] = FREERTOS_INVALID_SOCKET;
+                            uxPending--;
+                        }
+                    }
+                }
+
+                if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) != pdFALSE )
+                {
+                    break;
+                }
+            }
+
+            /* The probe connections are not reused, the TLS session is
+             * opened by GGD_SecureConnect_Connect(). */
+            for( ucEntry = 0; ucEntry < ucEntryCount; ucEntry++ )
+            {
+                if( xSockets[ ucEntry ] != FREERTOS_INVALID_SOCKET )
+                {
+                    FreeRTOS_FD_CLR( xSockets[ ucEntry ], xSocketSet, ( EventBits_t ) eSELECT_ALL );
+                    ( void ) FreeRTOS_closesocket( xSockets[ ucEntry ] );
+                }
+            }
+
+            FreeRTOS_DeleteSocketSet( xSocketSet );
+        }
+
+        if( xStatus == pdFAIL )
+        {
+            ggdconfigPRINT( "SecureConnect - no connectivity entry answered the probe\r\n" );
+        }
+
+        return xStatus;
+    }
+
+#endif /* if ( ggdconfigPARALLEL_PROBE == 1 ) */
+/*-----------------------------------------------------------*/
+
 static uint32_t prvIsIPaddress( const char * pcIPAddress )
 {
     const uint32_t ulDecimalBase = 10u;
@@ -0,0 +1,606 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_hrtimer.c
+ * @brief High resolution software timers on a one-shot hardware comparator.
+ */
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* High resolution timer includes. */
+#include "aws_hrtimer.h"
+#include "aws_static_memory.h"
+
+/**
+ * @brief Comparator value meaning that the comparator is disabled.
+ */
+#define hrtimerCOMPARE_DISABLED    ( UINT64_MAX )
+
+/**
+ * @brief Active timers, ordered as a binary min-heap on their expiry.
+ * Only accessed with interrupts masked.
+ */
+static HrTimer_t * pxHeap[ hrtimerconfigMAX_ACTIVE_TIMERS ] staticmemSECTION( hrtimer );
+static uint32_t ulHeapSize;
+
+/**
+ * @brief Value last written to the comparator. Only accessed with interrupts
+ * masked.
+ */
+static uint64_t ullCompare = hrtimerCOMPARE_DISABLED;
+
+/**
+ * @brief Timer whose callback the timer task is running, NULL otherwise. Only
+ * accessed with interrupts masked.
+ */
+static HrTimer_t * pxRunningTimer;
+
+/**
+ * @brief Handle of the timer task, NULL until HRTIMER_Init() is called.
+ */
+static TaskHandle_t xHrTimerTask;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    static StaticTask_t xHrTimerTaskBuffer staticmemSECTION( hrtimer );
+    static StackType_t xHrTimerTaskStack[ hrtimerconfigTASK_STACK_SIZE ] staticmemSECTION( hrtimer );
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Place a timer at a position of the heap.
+ */
+static void prvHeapSet( uint32_t ulIndex,
+                        HrTimer_t * pxTimer );
+
+/**
+ * @brief Move the timer at ulIndex towards the root until the heap is ordered.
+ */
+static void prvHeapSiftUp( uint32_t ulIndex );
+
+/**
+ * @brief Move the timer at ulIndex towards the leaves until the heap is ordered.
+ */
+static void prvHeapSiftDown( uint32_t ulIndex );
+
+/**
+ * @brief Add a timer to the heap.
+ *
+ * @return pdPASS if there was room for the timer, pdFAIL otherwise.
+ */
+static BaseType_t prvHeapInsert( HrTimer_t * pxTimer );
+
+/**
+ * @brief Remove an active timer from the heap.
+ */
+static void prvHeapRemove( HrTimer_t * pxTimer );
+
+/**
+ * @brief Program the comparator with the earliest expiry.
+ *
+ * The comparator only interrupts when the counter passes its value, so an
+ * expiry which has already been reached when the comparator is written would
+ * be missed. The caller wakes the timer task instead.
+ *
+ * @return pdTRUE if the earliest timer is due and the timer task must be
+ * woken, pdFALSE otherwise.
+ */
+static BaseType_t prvProgramCompare( void );
+
+/**
+ * @brief Start a timer. Must be called with interrupts masked.
+ *
+ * @param[out] pxDue Set to pdTRUE if the timer task must be woken.
+ */
+static BaseType_t prvStart( HrTimer_t * pxTimer,
+                            uint64_t ullExpiry,
+                            uint64_t ullPeriod,
+                            BaseType_t * pxDue );
+
+/**
+ * @brief Take the earliest timer off the heap if it has expired.
+ *
+ * A periodic timer is put back with its next expiry before its callback
+ * runs, so that the callback can stop or restart it.
+ *
+ * @param[out] pxDue Set to pdTRUE if no timer has expired but the earliest
+ * one is due before the comparator can be used.
+ *
+ * @return The expired timer, or NULL if none has expired.
+ */
+static HrTimer_t * prvTakeExpired( BaseType_t * pxDue );
+
+/**
+ * @brief Task running the callbacks of the expired timers.
+ */
+static void prvHrTimerTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapSet( uint32_t ulIndex,
+                        HrTimer_t * pxTimer )
+{
+    pxHeap[ ulIndex ] = pxTimer;
+    pxTimer->ulHeapIndex = ulIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapSiftUp( uint32_t ulIndex )
+{
+    HrTimer_t * pxTimer = pxHeap[ ulIndex ];
+    uint32_t ulParent = 0;
+
+    while( ulIndex > 0UL )
+    {
+        ulParent = ( ulIndex - 1UL ) / 2UL;
+
+        if( pxHeap[ ulParent ]->ullExpiry <= pxTimer->ullExpiry )
+        {
+            break;
+        }
+
+        prvHeapSet( ulIndex, pxHeap[ ulParent ] );
+        ulIndex = ulParent;
+    }
+
+    prvHeapSet( ulIndex, pxTimer );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapSiftDown( uint32_t ulIndex )
+{
+    HrTimer_t * pxTimer = pxHeap[ ulIndex ];
+    uint32_t ulChild = 0;
+
+    for( ; ; )
+    {
+        ulChild = ( 2UL * ulIndex ) + 1UL;
+
+        if( ulChild >= ulHeapSize )
+        {
+            break;
+        }
+
+        /* Pick the earlier of the two children. */
+        if( ( ( ulChild + 1UL ) < ulHeapSize ) &&
+            ( pxHeap[ ulChild + 1UL ]->ullExpiry < pxHeap[ ulChild ]->ullExpiry ) )
+        {
+            ulChild++;
+        }
+
+        if( pxTimer->ullExpiry <= pxHeap[ ulChild ]->ullExpiry )
+        {
+            break;
+        }
+
+        prvHeapSet( ulIndex, pxHeap[ ulChild ] );
+        ulIndex = ulChild;
+    }
+
+    prvHeapSet( ulIndex, pxTimer );
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvHeapInsert( HrTimer_t * pxTimer )
+{
+    BaseType_t xResult = pdFAIL;
+
+    if( ulHeapSize < ( uint32_t ) hrtimerconfigMAX_ACTIVE_TIMERS )
+    {
+        prvHeapSet( ulHeapSize, pxTimer );
+        ulHeapSize++;
+        prvHeapSiftUp( pxTimer->ulHeapIndex );
+        xResult = pdPASS;
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapRemove( HrTimer_t * pxTimer )
+{
+    uint32_t ulIndex = pxTimer->ulHeapIndex;
+    HrTimer_t * pxLast = NULL;
+
+    configASSERT( ( ulIndex < ulHeapSize ) && ( pxHeap[ ulIndex ] == pxTimer ) );
+
+    ulHeapSize--;
+    pxTimer->ulHeapIndex = hrtimerNOT_ACTIVE;
+
+    /* Fill the hole with the last timer and restore the order. */
+    if( ulIndex != ulHeapSize )
+    {
+        pxLast = pxHeap[ ulHeapSize ];
+        prvHeapSet( ulIndex, pxLast );
+
+        if( ( ulIndex > 0UL ) &&
+            ( pxLast->ullExpiry < pxHeap[ ( ulIndex - 1UL ) / 2UL ]->ullExpiry ) )
+        {
+            prvHeapSiftUp( ulIndex );
+        }
+        else
+        {
+            prvHeapSiftDown( ulIndex );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvProgramCompare( void )
+{
+    BaseType_t xDue = pdFALSE;
+    uint64_t ullExpiry = hrtimerCOMPARE_DISABLED;
+
+    if( ulHeapSize > 0UL )
+    {
+        ullExpiry = pxHeap[ 0 ]->ullExpiry;
+    }
+
+    if( ullExpiry != ullCompare )
+    {
+        if( ullExpiry == hrtimerCOMPARE_DISABLED )
+        {
+            hrtimerconfigDISABLE_COMPARE();
+        }
+        else
+        {
+            hrtimerconfigSET_COMPARE( ullExpiry );
+        }
+
+        ullCompare = ullExpiry;
+    }
+
+    /* Read the counter after writing the comparator. */
+    if( ( ullExpiry != hrtimerCOMPARE_DISABLED ) &&
+        ( ( hrtimerconfigGET_TIME() + ( uint64_t ) hrtimerconfigMIN_COMPARE_DELTA ) >= ullExpiry ) )
+    {
+        xDue = pdTRUE;
+    }
+
+    return xDue;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStart( HrTimer_t * pxTimer,
+                            uint64_t ullExpiry,
+                            uint64_t ullPeriod,
+                            BaseType_t * pxDue )
+{
+    BaseType_t xResult = pdFAIL;
+
+    configASSERT( xHrTimerTask != NULL );
+    configASSERT( ullExpiry != hrtimerCOMPARE_DISABLED );
+
+    if( pxTimer->ulHeapIndex != hrtimerNOT_ACTIVE )
+    {
+        prvHeapRemove( pxTimer );
+    }
+
+    pxTimer->ullExpiry = ullExpiry;
+    pxTimer->ullPeriod = ullPeriod;
+    pxTimer->ulOverruns = 0;
+
+    xResult = prvHeapInsert( pxTimer );
+    *pxDue = prvProgramCompare();
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static HrTimer_t * prvTakeExpired( BaseType_t * pxDue )
+{
+    HrTimer_t * pxTimer = NULL;
+    uint64_t ullNow = hrtimerconfigGET_TIME();
+    uint64_t ullNext = 0;
+    uint64_t ullMissed = 0;
+
+    *pxDue = pdFALSE;
+
+    if( ( ulHeapSize > 0UL ) && ( pxHeap[ 0 ]->ullExpiry <= ullNow ) )
+    {
+        pxTimer = pxHeap[ 0 ];
+        prvHeapRemove( pxTimer );
+        pxTimer->ulOverruns = 0;
+
+        if( pxTimer->ullPeriod != 0ULL )
+        {
+            /* Keep to the original grid of expiries, and count the ones
+             * which have already passed instead of dispatching them. */
+            ullNext = pxTimer->ullExpiry + pxTimer->ullPeriod;
+
+            if( ullNext <= ullNow )
+            {
+                ullMissed = ( ( ullNow - ullNext ) / pxTimer->ullPeriod ) + 1ULL;
+                ullNext += ullMissed * pxTimer->ullPeriod;
+                pxTimer->ulOverruns = ( ullMissed > ( uint64_t ) UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) ullMissed;
+            }
+
+            pxTimer->ullExpiry = ullNext;
+
+            /* Cannot fail, the timer was just removed. */
+            ( void ) prvHeapInsert( pxTimer );
+        }
+    }
+    else
+    {
+        *pxDue = prvProgramCompare();
+    }
+
+    return pxTimer;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvHrTimerTask( void * pvParameters )
+{
+    HrTimer_t * pxTimer = NULL;
+    HrTimerCallback_t xCallback = NULL;
+    void * pvContext = NULL;
+    BaseType_t xDue = pdFALSE;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+        /* Run the callbacks of all the expired timers, then program the
+         * comparator with the next expiry. */
+        do
+        {
+            taskENTER_CRITICAL();
+            {
+                pxTimer = prvTakeExpired( &xDue );
+
+                if( pxTimer != NULL )
+                {
+                    xCallback = pxTimer->xCallback;
+                    pvContext = pxTimer->pvContext;
+                    pxRunningTimer = pxTimer;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if( pxTimer != NULL )
+            {
+                xCallback( pxTimer, pvContext );
+
+                /* HRTIMER_Stop() waits for this before the timer can be
+                 * freed. */
+                taskENTER_CRITICAL();
+                {
+                    pxRunningTimer = NULL;
+                }
+                taskEXIT_CRITICAL();
+            }
+        } while( ( pxTimer != NULL ) || ( xDue == pdTRUE ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t HRTIMER_Init( void )
+{
+    if( xHrTimerTask == NULL )
+    {
+        hrtimerconfigDISABLE_COMPARE();
+
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xHrTimerTask = xTaskCreateStatic( prvHrTimerTask,
+                                              "HrTimer",
+                                              hrtimerconfigTASK_STACK_SIZE,
+                                              NULL,
+                                              hrtimerconfigTASK_PRIORITY,
+                                              xHrTimerTaskStack,
+                                              &xHrTimerTaskBuffer );
+        #else
+            ( void ) xTaskCreate( prvHrTimerTask,
+                                  "HrTimer",
+                                  hrtimerconfigTASK_STACK_SIZE,
+                                  NULL,
+                                  hrtimerconfigTASK_PRIORITY,
+                                  &xHrTimerTask );
+        #endif
+    }
+
+    return ( xHrTimerTask != NULL ) ? pdPASS : pdFAIL;
+}
+
+/*-----------------------------------------------------------*/
+
+void HRTIMER_Create( HrTimer_t * pxTimer,
+                     HrTimerCallback_t xCallback,
+                     void * pvContext )
+{
+    configASSERT( ( pxTimer != NULL ) && ( xCallback != NULL ) );
+
+    pxTimer->ullExpiry = 0;
+    pxTimer->ullPeriod = 0;
+    pxTimer->xCallback = xCallback;
+    pxTimer->pvContext = pvContext;
+    pxTimer->ulHeapIndex = hrtimerNOT_ACTIVE;
+    pxTimer->ulOverruns = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t HRTIMER_StartAt( HrTimer_t * pxTimer,
+                            uint64_t ullExpiry,
+                            uint64_t ullPeriod )
+{
+    BaseType_t xResult = pdFAIL;
+    BaseType_t xDue = pdFALSE;
+
+    taskENTER_CRITICAL();
+    {
+        xResult = prvStart( pxTimer, ullExpiry, ullPeriod, &xDue );
+    }
+    taskEXIT_CRITICAL();
+
+    if( xDue == pdTRUE )
+    {
+        ( void ) xTaskNotifyGive( xHrTimerTask );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t HRTIMER_Start( HrTimer_t * pxTimer,
+                          uint64_t ullDelay,
+                          uint64_t ullPeriod )
+{
+    return HRTIMER_StartAt( pxTimer, hrtimerconfigGET_TIME() + ullDelay, ullPeriod );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t HRTIMER_StartAtFromISR( HrTimer_t * pxTimer,
+                                   uint64_t ullExpiry,
+                                   uint64_t ullPeriod,
+                                   BaseType_t * pxHigherPriorityTaskWoken )
+{
+    BaseType_t xResult = pdFAIL;
+    BaseType_t xDue = pdFALSE;
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    xResult = prvStart( pxTimer, ullExpiry, ullPeriod, &xDue );
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+
+    if( xDue == pdTRUE )
+    {
+        vTaskNotifyGiveFromISR( xHrTimerTask, pxHigherPriorityTaskWoken );
+    }
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+void HRTIMER_Stop( HrTimer_t * pxTimer )
+{
+    BaseType_t xRunning = pdFALSE;
+
+    /* A callback stopping its own timer must not wait for itself. */
+    BaseType_t xWait = ( xTaskGetCurrentTaskHandle() != xHrTimerTask ) ? pdTRUE : pdFALSE;
+
+    do
+    {
+        if( xRunning == pdTRUE )
+        {
+            vTaskDelay( 1 );
+        }
+
+        /* Removed on every pass, as a running callback may restart its
+         * timer. */
+        taskENTER_CRITICAL();
+        {
+            if( pxTimer->ulHeapIndex != hrtimerNOT_ACTIVE )
+            {
+                prvHeapRemove( pxTimer );
+
+                /* Removing a timer only delays the next expiry, so the
+                 * timer task never needs waking here. */
+                ( void ) prvProgramCompare();
+            }
+
+            xRunning = ( ( xWait == pdTRUE ) && ( pxRunningTimer == pxTimer ) ) ? pdTRUE : pdFALSE;
+        }
+        taskEXIT_CRITICAL();
+    } while( xRunning == pdTRUE );
+}
+
+/*-----------------------------------------------------------*/
+
+void HRTIMER_StopFromISR( HrTimer_t * pxTimer )
+{
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    if( pxTimer->ulHeapIndex != hrtimerNOT_ACTIVE )
+    {
+        prvHeapRemove( pxTimer );
+        ( void ) prvProgramCompare();
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR( uxSavedInterruptStatus );
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t HRTIMER_IsActive( const HrTimer_t * pxTimer )
+{
+    return ( pxTimer->ulHeapIndex != hrtimerNOT_ACTIVE ) ? pdTRUE : pdFALSE;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t HRTIMER_GetExpiry( const HrTimer_t * pxTimer )
+{
+    uint64_t ullExpiry = 0;
+
+    /* The expiry is 64 bits wide, so it cannot be read atomically. */
+    taskENTER_CRITICAL();
+    {
+        ullExpiry = pxTimer->ullExpiry;
+    }
+    taskEXIT_CRITICAL();
+
+    return ullExpiry;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t HRTIMER_GetOverruns( const HrTimer_t * pxTimer )
+{
+    return pxTimer->ulOverruns;
+}
+
+/*-----------------------------------------------------------*/
+
+uint64_t HRTIMER_GetTime( void )
+{
+    return hrtimerconfigGET_TIME();
+}
+
+/*-----------------------------------------------------------*/
+
+void HRTIMER_CompareFromISR( BaseType_t * pxHigherPriorityTaskWoken )
+{
+    if( xHrTimerTask != NULL )
+    {
+        vTaskNotifyGiveFromISR( xHrTimerTask, pxHigherPriorityTaskWoken );
+    }
+}
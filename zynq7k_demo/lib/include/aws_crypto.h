@@ -94,4 +94,53 @@ BaseType_t CRYPTO_SignatureVerificationFinal( void * pvContext,
                                               uint8_t * pucSignature,
                                               size_t xSignatureLength );
 
+/**
+ * @brief Reads a signer certificate.
+ *
+ * Same contract as the OTA PAL's prvPAL_ReadAndAssumeCertificate(): the
+ * returned buffer is allocated with pvPortMalloc() and freed by the caller.
+ *
+ * @param[in] pucCertName Name of the certificate, such as a file path.
+ * @param[out] pulCertSize Length in bytes of the certificate.
+ *
+ * @return The certificate, or NULL if it cannot be read.
+ */
+typedef uint8_t * ( * CRYPTO_ReadSignerCertificate_t )( const uint8_t * const pucCertName,
+                                                        uint32_t * const pulCertSize );
+
+/**
+ * @brief Verifies a digital signature computation using the public key of a
+ * named signer.
+ *
+ * The public key is parsed once and kept in a cache of
+ * cryptoconfigSIGNER_KEY_CACHE_SIZE keys. xReadCertificate is only called
+ * when pucSignerName is not in the cache. Several tasks may verify at once.
+ *
+ * @param[in] pvContext Opaque context structure, freed by this call.
+ * @param[in] pucSignerName Name of the signer certificate, the cache key.
+ * @param[in] xReadCertificate Reads the signer certificate on a cache miss.
+ * @param[in] pucSignature Digital signature result to verify.
+ * @param[in] xSignatureLength in bytes of digital signature result.
+ *
+ * @return pdTRUE if the signature is correct or pdFALSE if the signature is
+ * invalid or the signer certificate cannot be read.
+ *
+ * @note Meant for prvPAL_CheckFileSignature() of an OTA PAL. The only PAL in
+ * this tree, lib/ota/portable/vendor/board, is a template, so nothing but
+ * Full_CRYPTO calls it yet.
+ */
+BaseType_t CRYPTO_SignatureVerificationFinalCached( void * pvContext,
+                                                    const uint8_t * pucSignerName,
+                                                    CRYPTO_ReadSignerCertificate_t xReadCertificate,
+                                                    uint8_t * pucSignature,
+                                                    size_t xSignatureLength );
+
+/**
+ * @brief Forgets the cached signer public keys.
+ *
+ * Call it when a signer certificate is replaced. Keys in use by a
+ * verification are freed when that verification ends.
+ */
+void CRYPTO_SignerKeyCacheFlush( void );
+
 #endif /* ifndef __AWS_CRYPTO__H__ */
@@ -28,6 +28,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "aws_mqtt_agent.h"
+
 /**
  * @brief Pointer to a Defender metric structure
  * @note Calling application should not access the contents of the structure
@@ -117,6 +119,32 @@ DefenderErr_t DEFENDER_MetricsInitFunc( DefenderMetric_t * pxMetricsList,
  */
 DefenderErr_t DEFENDER_ReportPeriodSet( uint32_t ulPeriodSec );
 
+/**
+ * @brief      Share an existing MQTT agent connection with the defender agent
+ *
+ * By default the agent creates its own MQTT connection on the first report and
+ * keeps it open between reports.  When a connected agent handle is provided,
+ * reports are published over that connection instead, and the agent never
+ * connects, disconnects or deletes it.  Pass NULL to return to a private
+ * connection.  Must be called while the agent is stopped.
+ *
+ * @param[in]  xMQTTAgent  Handle of a connected MQTT agent, or NULL
+ *
+ * @return     DefenderErr_t
+ */
+DefenderErr_t DEFENDER_MqttAgentSet( MQTTAgentHandle_t xMQTTAgent );
+
+/**
+ * @brief      Tell the agent that the shared MQTT connection was lost
+ *
+ * The agent cannot register for disconnect events on a connection it does not
+ * own.  An application sharing its agent with DEFENDER_MqttAgentSet() should
+ * call this from its own callback on eMQTTAgentDisconnect, so the accept and
+ * reject topics are subscribed again before the next report.  Reports that
+ * receive no response also cause the subscriptions to be redone.
+ */
+void DEFENDER_MqttAgentDisconnected( void );
+
 /**
  * @brief      Set the timeout period for various connection actions
  *
@@ -0,0 +1,116 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_entropy.h
+ * @brief Health tests and conditioning of a raw hardware noise source.
+ *
+ * A port samples its noise source into 8-bit raw samples and gives them to
+ * ENTROPY_Condition(), which runs the continuous health tests of NIST
+ * SP 800-90B section 4.4 on every sample and compresses a block of samples
+ * that passed into a full entropy output with SHA-256. The tests and the
+ * block size are derived from the min-entropy per raw sample that the
+ * source was assessed to have, entropyconfigMIN_ENTROPY_MILLIBITS.
+ *
+ * The functions keep no state besides the EntropyHealth_t given to them,
+ * so they also run on a host, on samples captured from the board. See
+ * tests/entropy.
+ */
+
+#ifndef _AWS_ENTROPY_H_
+#define _AWS_ENTROPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "aws_entropy_config.h"
+#include "aws_entropy_config_defaults.h"
+
+/**
+ * @brief Size of a conditioned output block, in bytes.
+ */
+#define entropyOUTPUT_BYTES    ( 32 )
+
+/**
+ * @brief State of the continuous health tests of one noise source.
+ * The members are private except for the counters.
+ */
+typedef struct EntropyHealth
+{
+    uint8_t ucRctValue;      /**< Last sample, for the repetition count test. */
+    uint32_t ulRctCount;     /**< Number of times ucRctValue was seen in a row. */
+    uint8_t ucAptValue;      /**< First sample of the adaptive proportion window. */
+    uint32_t ulAptCount;     /**< Occurrences of ucAptValue in the window. */
+    uint32_t ulAptIndex;     /**< Samples seen in the window. */
+    uint32_t ulSamples;      /**< Samples tested. */
+    uint32_t ulRctFailures;  /**< Repetition count test failures. */
+    uint32_t ulAptFailures;  /**< Adaptive proportion test failures. */
+} EntropyHealth_t;
+
+/**
+ * @brief Reset the health tests, before the start-up test of a source.
+ * @param[out] pxHealth The state to reset.
+ */
+void ENTROPY_HealthInit( EntropyHealth_t * pxHealth );
+
+/**
+ * @brief Run the repetition count and adaptive proportion tests on one raw
+ * sample.
+ * @param[in,out] pxHealth The state of the source.
+ * @param[in] ucSample The raw sample.
+ * @return pdPASS, or pdFAIL if either test failed. A failed test is reset,
+ * so a source which recovers passes again.
+ */
+BaseType_t ENTROPY_HealthTest( EntropyHealth_t * pxHealth,
+                               uint8_t ucSample );
+
+/**
+ * @brief Health test a block of raw samples and condition it.
+ * @param[in,out] pxHealth The state of the source.
+ * @param[in] pucSamples entropyconfigSAMPLES_PER_BLOCK raw samples.
+ * @param[out] pucOutput entropyOUTPUT_BYTES bytes of full entropy output.
+ * @return pdPASS, or pdFAIL if a sample failed a health test, in which case
+ * the block must be discarded and pucOutput is not written.
+ */
+BaseType_t ENTROPY_Condition( EntropyHealth_t * pxHealth,
+                              const uint8_t * pucSamples,
+                              uint8_t * pucOutput );
+
+/**
+ * @brief Read raw, untested samples from the noise source of the port.
+ *
+ * Implemented by the port, to capture samples for the checks in
+ * tests/entropy. Must not be called while the source may be polled for
+ * entropy.
+ *
+ * @param[out] pucSamples Buffer for the samples.
+ * @param[in] xCount Number of samples to read.
+ * @return pdPASS, or pdFAIL if the source cannot be read.
+ */
+BaseType_t ENTROPY_ReadRawSamples( uint8_t * pucSamples,
+                                   size_t xCount );
+
+#endif /* _AWS_ENTROPY_H_ */
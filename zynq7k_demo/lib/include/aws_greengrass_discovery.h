@@ -33,6 +33,23 @@
 #include "FreeRTOS.h"
 #include "aws_clientcredential.h"
 #include "aws_secure_sockets.h"
+#include "aws_ggd_config.h"
+#include "aws_ggd_config_defaults.h"
+
+/**
+ * @brief Maximum length of a JSON key tracked by the streaming parser.
+ *
+ * Longer keys are never one of the discovery keys and are ignored.
+ */
+#define ggdJSON_STREAM_KEY_LENGTH    16
+
+/**
+ * @brief Number of nesting levels for which the streaming parser records
+ * what the container holds.
+ *
+ * The discovery fields sit at depth 7 at most, deeper containers are skipped.
+ */
+#define ggdJSON_STREAM_MAX_DEPTH     8
 
 /**
  * @brief Input from user to locate GGC inside JSON file.
@@ -64,6 +81,58 @@ typedef struct
     uint16_t usPort;            /**< Port to connect to the GGC. */
 } GGD_HostAddressData_t;
 
+/**
+ * @brief Green Grass Core connectivity entry.
+ *
+ * One "Connectivity" element of the selected core, as extracted
+ * by the streaming parser.
+ */
+typedef struct
+{
+    char cHostAddress[ ggdconfigHOST_ADDRESS_MAX_LENGTH + 1 ]; /**< Null terminated host address. */
+    uint16_t usPort;                                           /**< Port to connect to the GGC. */
+} GGD_ConnectivityEntry_t;
+
+/**
+ * @brief Streaming discovery document parser context.
+ *
+ * Holds everything needed to parse the discovery document one chunk at a
+ * time, so the document never has to be held in RAM as a whole.
+ * Must be initialized with GGD_JSONStreamInit(), the fields are private.
+ */
+typedef struct
+{
+    const HostParameters_t * pxHostParameters; /**< Group and core to select, NULL for auto select. */
+    char * pcCertificate;                      /**< Buffer receiving the group CA certificate. */
+    uint32_t ulCertificateBufferSize;          /**< Size of pcCertificate. */
+    uint32_t ulCertificateLength;              /**< Number of certificate bytes written. */
+    GGD_ConnectivityEntry_t xEntries[ ggdconfigMAX_CONNECTIVITY_ENTRIES ];
+    uint8_t ucEntryCount;                      /**< Number of complete entries in xEntries. */
+    uint8_t ucCoreEntryStart;                  /**< ucEntryCount when the current core was opened. */
+    uint8_t ucCoreInterface;                   /**< Number of entries seen in the current core. */
+    uint8_t ucDepth;                           /**< Current nesting depth. */
+    uint8_t ucRoles[ ggdJSON_STREAM_MAX_DEPTH ];
+    uint32_t ulArrayMask;                      /**< Bit n is set when the container at depth n is an array. */
+    uint8_t ucLexState;
+    uint8_t ucKey;                             /**< Discovery key owning the current value. */
+    uint8_t ucValue;                           /**< What is done with the current value. */
+    uint8_t ucKeyLength;
+    char cKey[ ggdJSON_STREAM_KEY_LENGTH ];
+    uint8_t ucUnicodeCount;
+    uint16_t usMatchIndex;
+    uint32_t ulNumber;
+    BaseType_t xExpectKey;
+    BaseType_t xValueMatches;
+    BaseType_t xGroupMatch;
+    BaseType_t xCoreMatch;
+    BaseType_t xEntryStore;
+    BaseType_t xEntryHasHost;
+    BaseType_t xEntryHasPort;
+    BaseType_t xGroupHasCertificate;
+    BaseType_t xCertificateOverflow;
+    BaseType_t xGroupSelected;                 /**< pdTRUE once the selected group has been parsed. */
+} GGD_JSONStream_t;
+
 /*
  * @brief Connect directly to the green grass core.
  *
@@ -71,10 +140,10 @@ typedef struct
  * This function will perform in series:
  * 1. GGD_JSONRequest.
  * 2. GGD_GetJSONFileSize.
- * 3. GGD_GetJSONFile.
+ * 3. GGD_JSONStreamParse on the JSON file as it is received.
  * 4. GGD_ConnectToHost with auto slection parameters set to true.
- * The buffer size of pcBuffer need to be big enough to hold the complete
- * JSON file.
+ * The JSON file is never held in RAM as a whole: pcBuffer only needs to be
+ * big enough to hold the group certificate and the selected host address.
  *
  * @param [in] pcBuffer: Memory buffer provided by the user.
  *
@@ -218,4 +287,64 @@ BaseType_t GGD_GetIPandCertificateFromJSON( char * pcJSONFile,
                                             const HostParameters_t * pxHostParameters,
                                             GGD_HostAddressData_t * pxHostAddressData,
                                             const BaseType_t xAutoSelectFlag );
+
+/*
+ * @brief Initialize a streaming discovery document parser.
+ *
+ * @note: The parser selects the group matching pxHostParameters->pcGroupName
+ * and, in it, keeps the connectivity entry number pxHostParameters->ucInterface
+ * of the core matching pxHostParameters->pcCoreAddress. When pxHostParameters
+ * is NULL, the first group with a certificate and at least one connectivity
+ * entry is selected and up to ggdconfigMAX_CONNECTIVITY_ENTRIES entries of all
+ * its cores are kept.
+ *
+ * @param [out] pxStream: Parser context to initialize.
+ *
+ * @param [in] pxHostParameters: Group and core to select, NULL for auto select.
+ *
+ * @param [in] pcCertificateBuffer: Buffer receiving the group certificate.
+ *
+ * @param [in] ulCertificateBufferSize: Size of the certificate buffer.
+ */
+void GGD_JSONStreamInit( GGD_JSONStream_t * pxStream,
+                         const HostParameters_t * pxHostParameters,
+                         char * pcCertificateBuffer,
+                         const uint32_t ulCertificateBufferSize );
+
+/*
+ * @brief Parse the next chunk of a discovery document.
+ *
+ * Chunks can be of any size and split the document anywhere.
+ *
+ * @param [in] pxStream: Parser context.
+ *
+ * @param [in] pcChunk: Next bytes of the document.
+ *
+ * @param [in] ulChunkSize: Number of bytes in pcChunk.
+ *
+ * @return pdFAIL if the document is malformed or if the certificate of the
+ * selected group does not fit in the certificate buffer. Otherwise pdPASS.
+ */
+BaseType_t GGD_JSONStreamParse( GGD_JSONStream_t * pxStream,
+                                const char * pcChunk,
+                                const uint32_t ulChunkSize );
+
+/*
+ * @brief Get a connectivity entry of the selected core.
+ *
+ * @param [in] pxStream: Parser context fed with the complete document, or
+ * at least until the selected group was closed.
+ *
+ * @param [in] ucEntry: Index of the entry, starting from 0.
+ *
+ * @param [out] pxHostAddressData: Host address data. pcHostAddress points
+ * into pxStream and pcCertificate into the certificate buffer.
+ *
+ * @return pdPASS if a group was selected and the entry exists.
+ * Otherwise pdFAIL is returned.
+ */
+BaseType_t GGD_JSONStreamGetHostAddressData( const GGD_JSONStream_t * pxStream,
+                                             const uint8_t ucEntry,
+                                             GGD_HostAddressData_t * pxHostAddressData );
+
 #endif /* _AWS_GREENGRASS_DISCOVERY_H_ */
@@ -0,0 +1,226 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_hrtimer.h
+ * @brief Software timers with the resolution of a hardware compare timer.
+ *
+ * The timers of timers.c expire on a tick and every start or stop is a
+ * command sent to the timer task. These timers instead expire at a time of a
+ * free-running hardware counter, kept as 64-bit counts of
+ * hrtimerconfigCOUNTS_PER_SECOND. Active timers are held in a min-heap and the
+ * earliest expiry is programmed into a one-shot hardware comparator, so the
+ * cost of a start or a stop is a heap update in a short critical section and
+ * does not depend on the tick.
+ *
+ * The comparator interrupt wakes the high resolution timer task, which runs
+ * the callbacks of the expired timers at hrtimerconfigTASK_PRIORITY. The
+ * hardware is reached through the hrtimerconfigGET_TIME(),
+ * hrtimerconfigSET_COMPARE() and hrtimerconfigDISABLE_COMPARE() macros, and the
+ * port's comparator interrupt handler must call HRTIMER_CompareFromISR().
+ */
+
+#ifndef _AWS_HRTIMER_H_
+#define _AWS_HRTIMER_H_
+
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "aws_hrtimer_config.h"
+#include "aws_hrtimer_config_defaults.h"
+
+/**
+ * @brief Converts microseconds to counts, rounding down.
+ *
+ * Whole seconds are converted separately so that the product cannot
+ * overflow.
+ */
+#define hrtimerUS_TO_COUNTS( ullUs )                                                                        \
+    ( ( ( uint64_t ) ( ullUs ) / 1000000ULL ) * ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND +                \
+      ( ( ( uint64_t ) ( ullUs ) % 1000000ULL ) * ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND ) / 1000000ULL )
+
+/**
+ * @brief Converts nanoseconds to counts, rounding up.
+ */
+#define hrtimerNS_TO_COUNTS( ullNs )                                                                       \
+    ( ( ( uint64_t ) ( ullNs ) / 1000000000ULL ) * ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND +            \
+      ( ( ( ( uint64_t ) ( ullNs ) % 1000000000ULL ) * ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND ) +      \
+        999999999ULL ) / 1000000000ULL )
+
+/**
+ * @brief Converts counts to nanoseconds, rounding down.
+ */
+#define hrtimerCOUNTS_TO_NS( ullCounts )                                                                      \
+    ( ( ( uint64_t ) ( ullCounts ) / ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND ) * 1000000000ULL +           \
+      ( ( ( uint64_t ) ( ullCounts ) % ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND ) * 1000000000ULL ) /       \
+      ( uint64_t ) hrtimerconfigCOUNTS_PER_SECOND )
+
+struct HrTimer;
+
+/**
+ * @brief Called from the high resolution timer task when a timer expires.
+ *
+ * The callback may start or stop any timer, including its own. It must not
+ * block, since it delays every other timer.
+ *
+ * @param[in] pxTimer The timer which expired.
+ * @param[in] pvContext The context given to HRTIMER_Create().
+ */
+typedef void ( * HrTimerCallback_t )( struct HrTimer * pxTimer,
+                                      void * pvContext );
+
+/**
+ * @brief A high resolution timer. The memory is owned by the caller and must
+ * remain valid until the timer is stopped. The members are private.
+ */
+typedef struct HrTimer
+{
+    uint64_t ullExpiry;           /**< Time of the next expiry, in counts. */
+    uint64_t ullPeriod;           /**< Period in counts, 0 for a one-shot timer. */
+    HrTimerCallback_t xCallback;  /**< Called when the timer expires. */
+    void * pvContext;             /**< Passed to xCallback. */
+    uint32_t ulHeapIndex;         /**< Position in the heap, hrtimerNOT_ACTIVE when stopped. */
+    uint32_t ulOverruns;          /**< Expiries missed before the last one dispatched. */
+} HrTimer_t;
+
+/**
+ * @brief ulHeapIndex of a timer which is not active.
+ */
+#define hrtimerNOT_ACTIVE    ( 0xFFFFFFFFUL )
+
+/**
+ * @brief Create the high resolution timer task.
+ *
+ * Must be called once before any timer is started.
+ *
+ * @return pdPASS if the task was created, pdFAIL otherwise.
+ */
+BaseType_t HRTIMER_Init( void );
+
+/**
+ * @brief Initialize a timer. The timer is not active.
+ *
+ * @param[out] pxTimer The timer to initialize.
+ * @param[in] xCallback Called when the timer expires.
+ * @param[in] pvContext Passed to xCallback.
+ */
+void HRTIMER_Create( HrTimer_t * pxTimer,
+                     HrTimerCallback_t xCallback,
+                     void * pvContext );
+
+/**
+ * @brief Start a timer, or restart it if it is already active.
+ *
+ * A periodic timer expires every ullPeriod counts after its first expiry,
+ * without drift. If the timer task falls behind by more than a period, the
+ * missed expiries are counted rather than dispatched, see
+ * HRTIMER_GetOverruns().
+ *
+ * @param[in] pxTimer The timer to start.
+ * @param[in] ullExpiry Time of the first expiry, in counts. A time in the past
+ * expires immediately.
+ * @param[in] ullPeriod Period in counts, or 0 for a one-shot timer.
+ *
+ * @return pdPASS if the timer was started, pdFAIL if
+ * hrtimerconfigMAX_ACTIVE_TIMERS timers are already active.
+ */
+BaseType_t HRTIMER_StartAt( HrTimer_t * pxTimer,
+                            uint64_t ullExpiry,
+                            uint64_t ullPeriod );
+
+/**
+ * @brief Start a timer ullDelay counts from now.
+ *
+ * @see HRTIMER_StartAt().
+ */
+BaseType_t HRTIMER_Start( HrTimer_t * pxTimer,
+                          uint64_t ullDelay,
+                          uint64_t ullPeriod );
+
+/**
+ * @brief Interrupt safe version of HRTIMER_StartAt().
+ *
+ * @param[out] pxHigherPriorityTaskWoken Set to pdTRUE if the timer expires
+ * immediately and a context switch should be requested before the interrupt
+ * exits.
+ */
+BaseType_t HRTIMER_StartAtFromISR( HrTimer_t * pxTimer,
+                                   uint64_t ullExpiry,
+                                   uint64_t ullPeriod,
+                                   BaseType_t * pxHigherPriorityTaskWoken );
+
+/**
+ * @brief Stop a timer. Stopping a timer which is not active has no effect.
+ *
+ * If the timer task is running the timer's callback, this waits for the
+ * callback to return, so the timer can be freed as soon as this returns.
+ * Called from the callback itself, it does not wait.
+ *
+ * @param[in] pxTimer The timer to stop.
+ */
+void HRTIMER_Stop( HrTimer_t * pxTimer );
+
+/**
+ * @brief Interrupt safe version of HRTIMER_Stop().
+ *
+ * Does not wait for a callback which the timer task has already started, so
+ * the timer must not be freed from an interrupt.
+ */
+void HRTIMER_StopFromISR( HrTimer_t * pxTimer );
+
+/**
+ * @brief Whether a timer is active.
+ *
+ * @return pdTRUE if the timer is waiting to expire, pdFALSE otherwise.
+ */
+BaseType_t HRTIMER_IsActive( const HrTimer_t * pxTimer );
+
+/**
+ * @brief Time of the next expiry of an active timer, in counts.
+ */
+uint64_t HRTIMER_GetExpiry( const HrTimer_t * pxTimer );
+
+/**
+ * @brief Number of expiries of a periodic timer which were missed before the
+ * one being dispatched. Meaningful in the callback.
+ */
+uint32_t HRTIMER_GetOverruns( const HrTimer_t * pxTimer );
+
+/**
+ * @brief Current time, in counts.
+ */
+uint64_t HRTIMER_GetTime( void );
+
+/**
+ * @brief Called by the port from the comparator interrupt.
+ *
+ * Wakes the high resolution timer task. The port clears the interrupt.
+ *
+ * @param[out] pxHigherPriorityTaskWoken Set to pdTRUE if a context switch
+ * should be requested before the interrupt exits.
+ */
+void HRTIMER_CompareFromISR( BaseType_t * pxHigherPriorityTaskWoken );
+
+#endif /* _AWS_HRTIMER_H_ */
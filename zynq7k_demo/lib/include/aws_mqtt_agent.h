@@ -289,6 +289,10 @@ MQTTAgentReturnCode_t MQTT_AGENT_Disconnect( MQTTAgentHandle_t xMQTTHandle,
  *   in no particular order. If the user decides to take the ownership of the MQTT buffer in
  *   any of the callback by returning eMQTTTrue, no further callbacks are invoked.
  *
+ * @note With the default central buffer pool (mqttconfigSHARE_BUFFER_FXN is not NULL), all
+ * the matching callbacks are invoked regardless. Every callback which returns eMQTTTrue owns
+ * a reference to the same buffer and must return it with MQTT_AGENT_ReturnBuffer.
+ *
  * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
  * @param[in] pxSubscribeParams Subscribe parameters.
  * @param[in] xTimeoutTicks Maximum time in ticks after which the operation should fail. Use pdMS_TO_TICKS
@@ -356,4 +360,21 @@ MQTTAgentReturnCode_t MQTT_AGENT_Publish( MQTTAgentHandle_t xMQTTHandle,
 MQTTAgentReturnCode_t MQTT_AGENT_ReturnBuffer( MQTTAgentHandle_t xMQTTHandle,
                                                MQTTBufferHandle_t xBufferHandle );
 
+/**
+ * @brief Adds a reference to a buffer provided in the publish callback.
+ *
+ * A task which owns a received buffer can hand it to another task without copying it.
+ * It calls MQTT_AGENT_ShareBuffer before passing the buffer on, and each task calls
+ * MQTT_AGENT_ReturnBuffer once when it is done. The buffer is recycled when the last
+ * reference is returned.
+ *
+ * @param[in] xMQTTHandle The opaque handle as returned from MQTT_AGENT_Create.
+ * @param[in] xBufferHandle The buffer to share. The caller must own a reference to it.
+ *
+ * @return eMQTTAgentSuccess if the buffer was shared, eMQTTAgentFailure if the buffer
+ * pool does not count references (mqttconfigSHARE_BUFFER_FXN is NULL).
+ */
+MQTTAgentReturnCode_t MQTT_AGENT_ShareBuffer( MQTTAgentHandle_t xMQTTHandle,
+                                              MQTTBufferHandle_t xBufferHandle );
+
 #endif /* _AWS_MQTT_AGENT_H_ */
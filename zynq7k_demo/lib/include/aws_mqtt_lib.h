@@ -410,6 +410,20 @@ typedef uint8_t * ( * MQTTGetFreeBuffer_t ) ( uint32_t * pulBufferLength );
  */
 typedef void ( * MQTTReturnBuffer_t ) ( uint8_t * pucBuffer );
 
+/**
+ * @brief Signature of the optional callback supplied by the user as
+ * part of MQTTBufferPoolInterface_t to add a reference to a buffer
+ * obtained using MQTTGetFreeBuffer_t.
+ *
+ * A buffer pool that counts references lets the library hand one
+ * received publish to every matching subscription callback without
+ * copying it. Each reference is dropped with MQTTReturnBuffer_t and the
+ * buffer must only go back to the pool when the last one is dropped.
+ *
+ * @param[in] pucBuffer The buffer to add a reference to.
+ */
+typedef void ( * MQTTShareBuffer_t ) ( uint8_t * pucBuffer );
+
 /**
  * @brief Represents a subscription entry in the subscription manager.
  */
@@ -446,11 +460,18 @@ typedef void ( * MQTTReturnBuffer_t ) ( uint8_t * pucBuffer );
  *
  * The library uses this interface to get a buffer from the pool
  * of free buffers and return it back to the pool whenever done.
+ *
+ * pxShareBufferFxn is optional. If it is NULL, the first publish callback
+ * which takes the ownership of a received buffer stops the others from
+ * being invoked. If it is set, every matching publish callback is invoked
+ * and each one which takes the ownership holds its own reference to the
+ * buffer, which it returns when done.
  */
 typedef struct MQTTBufferPoolInterface
 {
     MQTTGetFreeBuffer_t pxGetBufferFxn;   /**< The function to get a free buffer. @see MQTTGetFreeBuffer_t. */
     MQTTReturnBuffer_t pxReturnBufferFxn; /**< The function to return the buffer. @see MQTTReturnBuffer_t. */
+    MQTTShareBuffer_t pxShareBufferFxn;   /**< The function to add a reference to a buffer, or NULL. @see MQTTShareBuffer_t. */
 } MQTTBufferPoolInterface_t;
 
 /**
@@ -647,6 +668,11 @@ MQTTReturnCode_t MQTT_Disconnect( MQTTContext_t * pxMQTTContext );
  *   in no particular order. If the user decides to take the ownership of the MQTT buffer in
  *   any of the callback by returning eMQTTTrue, no further callbacks are invoked.
  *
+ * @note If the buffer pool interface supplies pxShareBufferFxn, all the matching callbacks
+ * are invoked regardless. Every callback which returns eMQTTTrue owns a reference to the
+ * same buffer and must return it with MQTT_ReturnBuffer when done. The buffer is recycled
+ * once all of them have returned it.
+ *
  * @param[in] pxMQTTContext The initialized MQTT context.
  * @param[in] pxSubscribeParams Subscribe parameters.
  *
@@ -710,6 +736,9 @@ MQTTReturnCode_t MQTT_ParseReceivedData( MQTTContext_t * pxMQTTContext,
  * can take the ownership by returning eMQTTTrue from the callback. The user should later
  * return the buffer whenever done by calling the MQTT_ReturnBuffer API.
  *
+ * @note If pxShareBufferFxn is supplied, the buffer may be shared with other owners and
+ * its content is left untouched. It is cleared when it is next taken from the pool.
+ *
  * @param[in] pxMQTTContext The initialized MQTT context.
  * @param[in] xBufferHandle The buffer to return.
  *
@@ -404,5 +404,37 @@ uint32_t OTA_GetPacketsProcessed( void );
  */
 uint32_t OTA_GetPacketsDropped( void );
 
+/**
+ * @brief Get the number of received files closed and signature checked by
+ * the OTA agent.
+ *
+ * @note Calling OTA_AgentInit() will reset this statistic.
+ *
+ * @return The number of files passed to prvPAL_CloseFile(), whatever the
+ * result of the signature check.
+ */
+uint32_t OTA_GetFilesVerified( void );
+
+/**
+ * @brief Get the time taken to close and signature check the last received
+ * file.
+ *
+ * @note Calling OTA_AgentInit() will reset this statistic.
+ *
+ * @return The time in milliseconds spent in prvPAL_CloseFile() for the last
+ * file.
+ */
+uint32_t OTA_GetLastVerifyTime( void );
+
+/**
+ * @brief Get the time taken to close and signature check all received files.
+ *
+ * @note Calling OTA_AgentInit() will reset this statistic.
+ *
+ * @return The time in milliseconds spent in prvPAL_CloseFile(). Divide by
+ * OTA_GetFilesVerified() for the mean per file.
+ */
+uint32_t OTA_GetTotalVerifyTime( void );
+
 /* _AWS_OTA_AGENT_H_ */
 #endif
@@ -106,4 +106,27 @@ typedef struct PKCS11_GenerateKeyPrivateTemplate
 
 #define pkcs11INVALID_OBJECT_HANDLE                     0
 
+/**
+ * @brief Counters of the object and key caches, see PKCS11_GetCacheStats().
+ */
+typedef struct PKCS11_CacheStats
+{
+    CK_ULONG ulObjectHits;   /**< Object values served from RAM. */
+    CK_ULONG ulObjectLoads;  /**< Object values read from storage. */
+    CK_ULONG ulObjectLoadUs; /**< Total time spent reading object values from storage, in microseconds. */
+    CK_ULONG ulKeyHits;      /**< Sign and verify operations started with an already parsed key. */
+    CK_ULONG ulKeyParses;    /**< Keys parsed from their object value. */
+} PKCS11_CacheStats_t;
+
+/**
+ * @brief Read the counters of the object and key caches.
+ *
+ * Object values are read from storage once and kept in RAM, and keys are
+ * parsed once and shared by all sessions, until the object is saved again.
+ * This is not a PKCS#11 function.
+ *
+ * @param[out] pxStats The counters since the module was first initialized.
+ */
+void PKCS11_GetCacheStats( PKCS11_CacheStats_t * pxStats );
+
 #endif /* ifndef _AWS_PKCS11_H_ */
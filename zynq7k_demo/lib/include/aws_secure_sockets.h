@@ -157,6 +157,8 @@ typedef void * Socket_t;
 #define SOCKETS_SO_NONBLOCK                      ( 9 )  /**< Socket is nonblocking. */
 #define SOCKETS_SO_ALPN_PROTOCOLS                ( 10 ) /**< Application protocol list to be included in TLS ClientHello. */
 #define SOCKETS_SO_WAKEUP_CALLBACK               ( 17 ) /**< Set the callback to be called whenever there is data available on the socket for reading. */
+#define SOCKETS_SO_TLS_COALESCE                  ( 18 ) /**< Coalesce small TLS writes until flushed. */
+#define SOCKETS_SO_TLS_FLUSH                     ( 19 ) /**< Send the coalesced TLS writes now. */
 
 /**@} */
 
@@ -402,6 +404,20 @@ int32_t SOCKETS_Close( Socket_t xSocket );
  *      - The ALPN list is expressed as an array of NULL-terminated ANSI
  *        strings.
  *      - xOptionLength is the number of items in the array.
+ *    - @ref SOCKETS_SO_TLS_COALESCE
+ *      - Copy sends shorter than tlsconfigCOALESCE_BUFFER_SIZE into one
+ *        TLS record instead of encrypting each of them separately.
+ *      - The data is sent by @ref SOCKETS_SO_TLS_FLUSH, by SOCKETS_Recv(),
+ *        by SOCKETS_Shutdown(), when the buffer fills, or by a
+ *        SOCKETS_Send() made after tlsconfigCOALESCE_DEADLINE_MS.
+ *      - This socket option should be set before SOCKETS_Connect() is
+ *        called, and is ignored if @ref SOCKETS_SO_REQUIRE_TLS is not set.
+ *      - pvOptionValue is ignored for this option.
+ *    - @ref SOCKETS_SO_TLS_FLUSH
+ *      - Send the coalesced TLS writes now.
+ *      - Returns SOCKETS_EWOULDBLOCK if a non-blocking socket did not take
+ *        all of them. The rest is sent by the next flush.
+ *      - pvOptionValue is ignored for this option.
  *
  * @return
  * * On success, 0 is returned.
@@ -413,6 +429,81 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                             const void * pvOptionValue,
                             size_t xOptionLength );
 
+/**
+ * @brief An endpoint for which a warm standby connection is kept.
+ *
+ * The fields mirror the options a caller sets on its socket. A secured
+ * SOCKETS_Connect() to the same port with the same options is served by the
+ * standby connection instead of a new TCP connection and TLS handshake.
+ */
+typedef struct SocketsStandbyEndpoint
+{
+    const char * pcHostName;             /**< DNS name or dotted IP address of the server. */
+    uint16_t usPort;                     /**< Server port, in host byte order. */
+    BaseType_t xServerNameIndication;    /**< pdTRUE if pcHostName is sent with @ref SOCKETS_SO_SERVER_NAME_INDICATION. */
+    const char * pcServerCertificate;    /**< Trusted server certificate, or NULL for the default trust list. */
+    uint32_t ulServerCertificateLength;  /**< Length of pcServerCertificate, including the null terminator. */
+    const char ** ppcAlpnProtocols;      /**< Application protocol list, or NULL. */
+    uint32_t ulAlpnProtocolsCount;       /**< Number of items in ppcAlpnProtocols. */
+    BaseType_t xCoalesceWrites;          /**< pdTRUE if @ref SOCKETS_SO_TLS_COALESCE is set. */
+} SocketsStandbyEndpoint_t;
+
+/**
+ * @brief Counters of the standby connections of one endpoint, see
+ * SOCKETS_StandbyGetStats().
+ *
+ * The time to first byte is measured from the start of SOCKETS_Connect() to
+ * the first SOCKETS_Recv() which returns data.
+ */
+typedef struct SocketsStandbyStats
+{
+    uint32_t ulWarmConnects;          /**< Connections served by a standby connection. */
+    uint32_t ulColdConnects;          /**< Connections opened while no standby connection was ready. */
+    uint32_t ulOpened;                /**< Standby connections established. */
+    uint32_t ulOpenFailures;          /**< Standby connections which could not be established. */
+    uint32_t ulDropped;               /**< Standby connections closed by the server or replaced for their age. */
+    uint32_t ulWarmFirstByteMs;       /**< Time to first byte of the last warm connection. */
+    uint32_t ulWarmFirstByteTotalMs;  /**< Sum of the times to first byte of the warm connections. */
+    uint32_t ulWarmFirstByteCount;    /**< Number of warm connections which received data. */
+    uint32_t ulColdFirstByteMs;       /**< Time to first byte of the last cold connection. */
+    uint32_t ulColdFirstByteTotalMs;  /**< Sum of the times to first byte of the cold connections. */
+    uint32_t ulColdFirstByteCount;    /**< Number of cold connections which received data. */
+} SocketsStandbyStats_t;
+
+/**
+ * @brief Keeps a warm standby connection to an endpoint.
+ *
+ * A background task opens an authenticated connection to the endpoint, checks
+ * that the server keeps it open, replaces it when it gets older than
+ * socketsconfigSTANDBY_MAX_AGE_MS and opens a new one as soon as it is handed
+ * out. Failed attempts are retried after a backoff between
+ * socketsconfigSTANDBY_RETRY_MIN_MS and socketsconfigSTANDBY_RETRY_MAX_MS.
+ *
+ * The endpoint is copied. Adding an endpoint which is already kept returns
+ * its existing index.
+ *
+ * @param[in] pxEndpoint The endpoint.
+ *
+ * @return
+ * * The index of the endpoint, for SOCKETS_StandbyGetStats().
+ * * SOCKETS_ENOMEM if socketsconfigSTANDBY_MAX_ENDPOINTS endpoints are kept
+ *   already or the endpoint could not be copied.
+ */
+int32_t SOCKETS_StandbyAdd( const SocketsStandbyEndpoint_t * pxEndpoint );
+
+/**
+ * @brief Reads the counters of the standby connections of one endpoint.
+ *
+ * @param[in] lEndpoint Index returned by SOCKETS_StandbyAdd().
+ * @param[out] pxStats The counters.
+ *
+ * @return
+ * * On success, 0 is returned.
+ * * SOCKETS_EINVAL if lEndpoint is not a kept endpoint.
+ */
+int32_t SOCKETS_StandbyGetStats( int32_t lEndpoint,
+                                 SocketsStandbyStats_t * pxStats );
+
 /**
  * @brief Resolve a host name using Domain Name Service.
  *
@@ -267,6 +267,26 @@ typedef BaseType_t ( * ShadowDeltaCallback_t )( void * pvUserData,
                                                 uint32_t ulDocumentLength,
                                                 MQTTBufferHandle_t xBuffer );
 
+/**
+ * @brief Function signature of the completion callback of #SHADOW_UpdateAsync,
+ * #SHADOW_GetAsync and #SHADOW_DeleteAsync.
+ *
+ * @param pvCallbackContext The context passed with the operation.
+ * @param xResult The #ShadowReturnCode of the operation, as the blocking
+ * function would have returned it.
+ * @param pxOperationParams The #ShadowOperationParams_t passed with the
+ * operation. After a successful get, it holds the Shadow document; its MQTT
+ * buffer must be returned by calling #SHADOW_ReturnMQTTBuffer.
+ *
+ * @note Completion callbacks are called from the MQTT task, or from the timer
+ * service task when the operation times out.
+ * @warning <b> Do not make any blocking calls (including #SHADOW_Update, #SHADOW_Get, or
+ * #SHADOW_Delete) in a callback function! </b>
+ */
+typedef void ( * ShadowOperationCallback_t )( void * pvCallbackContext,
+                                              ShadowReturnCode_t xResult,
+                                              ShadowOperationParams_t * const pxOperationParams );
+
 /**
  * @brief Parameters to #SHADOW_RegisterCallbacks.
  */
@@ -388,11 +408,45 @@ ShadowReturnCode_t SHADOW_ClientDelete( ShadowClientHandle_t xShadowClientHandle
  * will not be notified if acceptance occurs after a timeout. The user may
  * intentionally set a short timeout if the result of the update isn't relevant,
  * but the timeout must still be long enough for the update to be published.
+ * - The response is matched to the update by the "clientToken" of the update
+ * document. Updates of the same Thing that may be in progress at the same
+ * time should have distinct client tokens; updates without one are matched in
+ * the order they were published.
  */
 ShadowReturnCode_t SHADOW_Update( ShadowClientHandle_t xShadowClientHandle,
                                   ShadowOperationParams_t * const pxUpdateParams,
                                   TickType_t xTimeoutTicks );
 
+/**
+ * @brief Update a Thing Shadow without waiting for the response.
+ *
+ * @param[in] xShadowClientHandle Handle of Shadow Client to use for update.
+ * @param[in] pxUpdateParams A pointer to a #ShadowOperationParams struct. The
+ * struct must remain valid until @p xCallback is called. The update document
+ * is only used until this function returns.
+ * @param[in] xTimeoutTicks Number of ticks within which the update must be
+ * accepted or rejected.
+ * @param[in] xCallback Called with the result of the update.
+ * @param[in] pvCallbackContext Passed to @p xCallback.
+ *
+ * @return #eShadowSuccess if the update was published; @p xCallback is then
+ * called exactly once, possibly before this function returns. Otherwise the
+ * #ShadowReturnCode of the failure, and @p xCallback is not called.
+ *
+ * @note
+ * - Up to #shadowconfigMAX_PENDING_OPERATIONS operations may be in progress on
+ * a Shadow Client. When none is free, this function blocks until one is or
+ * @p xTimeoutTicks expires.
+ * - Responses are matched to updates as in #SHADOW_Update.
+ * - The accepted and rejected topics stay subscribed;
+ * #ShadowOperationParams_t.ucKeepSubscriptions is ignored.
+ */
+ShadowReturnCode_t SHADOW_UpdateAsync( ShadowClientHandle_t xShadowClientHandle,
+                                       ShadowOperationParams_t * const pxUpdateParams,
+                                       TickType_t xTimeoutTicks,
+                                       ShadowOperationCallback_t xCallback,
+                                       void * pvCallbackContext );
+
 /**
  * @brief Get a Thing Shadow from the cloud.
  *
@@ -416,6 +470,30 @@ ShadowReturnCode_t SHADOW_Get( ShadowClientHandle_t xShadowClientHandle,
                                ShadowOperationParams_t * const pxGetParams,
                                TickType_t xTimeoutTicks );
 
+/**
+ * @brief Get a Thing Shadow from the cloud without waiting for the response.
+ *
+ * @param[in] xShadowClientHandle Handle of Shadow Client to use for get.
+ * @param pxGetParams A pointer to a #ShadowOperationParams struct. It must
+ * remain valid until @p xCallback is called, which receives the Shadow
+ * document in it.
+ * @param[in] xTimeoutTicks Number of ticks within which the get must be
+ * accepted or rejected.
+ * @param[in] xCallback Called with the result of the get.
+ * @param[in] pvCallbackContext Passed to @p xCallback.
+ *
+ * @return #eShadowSuccess if the get was published; @p xCallback is then
+ * called exactly once, possibly before this function returns. Otherwise the
+ * #ShadowReturnCode of the failure, and @p xCallback is not called.
+ *
+ * @note See #SHADOW_UpdateAsync.
+ */
+ShadowReturnCode_t SHADOW_GetAsync( ShadowClientHandle_t xShadowClientHandle,
+                                    ShadowOperationParams_t * const pxGetParams,
+                                    TickType_t xTimeoutTicks,
+                                    ShadowOperationCallback_t xCallback,
+                                    void * pvCallbackContext );
+
 /**
  * @brief Delete a Thing Shadow in the cloud.
  *
@@ -439,6 +517,29 @@ ShadowReturnCode_t SHADOW_Delete( ShadowClientHandle_t xShadowClientHandle,
                                   ShadowOperationParams_t * const pxDeleteParams,
                                   TickType_t xTimeoutTicks );
 
+/**
+ * @brief Delete a Thing Shadow in the cloud without waiting for the response.
+ *
+ * @param[in] xShadowClientHandle Handle of Shadow Client to use for delete.
+ * @param[in] pxDeleteParams A pointer to a #ShadowOperationParams struct. It
+ * must remain valid until @p xCallback is called.
+ * @param[in] xTimeoutTicks Number of ticks within which the delete must be
+ * accepted or rejected.
+ * @param[in] xCallback Called with the result of the delete.
+ * @param[in] pvCallbackContext Passed to @p xCallback.
+ *
+ * @return #eShadowSuccess if the delete was published; @p xCallback is then
+ * called exactly once, possibly before this function returns. Otherwise the
+ * #ShadowReturnCode of the failure, and @p xCallback is not called.
+ *
+ * @note See #SHADOW_UpdateAsync.
+ */
+ShadowReturnCode_t SHADOW_DeleteAsync( ShadowClientHandle_t xShadowClientHandle,
+                                       ShadowOperationParams_t * const pxDeleteParams,
+                                       TickType_t xTimeoutTicks,
+                                       ShadowOperationCallback_t xCallback,
+                                       void * pvCallbackContext );
+
 /**
  * @brief Register callback functions.
  *
@@ -488,4 +589,21 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
 ShadowReturnCode_t SHADOW_ReturnMQTTBuffer( ShadowClientHandle_t xShadowClientHandle,
                                             MQTTBufferHandle_t xBufferHandle );
 
+/**
+ * @brief Add a reference to an MQTT Buffer taken by the Shadow Client.
+ *
+ * Lets a document received in #SHADOW_Get or in a callback be handed to other
+ * tasks without copying it. Call this function before passing the buffer on;
+ * every task that received it then calls #SHADOW_ReturnMQTTBuffer once. The
+ * buffer is recycled when the last reference is returned.
+ *
+ * @param[in] xShadowClientHandle Handle of Shadow Client which took the MQTT Buffer.
+ * @param[in] xBufferHandle Handle of MQTT Buffer to share.
+ *
+ * @return #ShadowReturnCode. #eShadowFailure if the MQTT buffer pool does not
+ * count references.
+ */
+ShadowReturnCode_t SHADOW_ShareMQTTBuffer( ShadowClientHandle_t xShadowClientHandle,
+                                           MQTTBufferHandle_t xBufferHandle );
+
 #endif /* _AWS_SHADOW_H_ */
@@ -0,0 +1,248 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_shadow_state.h
+ * @brief Local copy of a Thing Shadow with coalesced, delta-only reported updates.
+ *
+ * A Shadow state keeps the desired and reported value of each of a fixed set
+ * of top level keys, and the version of the Shadow document. Values are kept
+ * as JSON text, e.g. "\"red\"" or "42", and are compared as text.
+ *
+ * - Reported values set with #SHADOW_StateSetReported are only marked for
+ * publishing if they differ from the last value reported. Changes made within
+ * #ShadowStateParams_t.xCoalesceTicks of the first one are published together
+ * by #SHADOW_StateProcess in one update carrying only the changed keys.
+ * - /update/delta documents passed to #SHADOW_StateApplyDelta only update the
+ * keys they contain, and the application is called back only for keys whose
+ * desired value changed. Deltas older than the cached version are ignored.
+ */
+
+#ifndef _AWS_SHADOW_STATE_H_
+#define _AWS_SHADOW_STATE_H_
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+#include "aws_shadow.h"
+#include "aws_shadow_json.h"
+
+/* Shadow configuration includes. */
+#include "aws_shadow_config.h"
+#include "aws_shadow_config_defaults.h"
+
+/**
+ * @brief Function signature of the callback called when the desired value of
+ * a key changes.
+ *
+ * @param[in] pvUserData #ShadowStateParams_t.pvUserData.
+ * @param[in] pcKey The key, as given in #ShadowStateParams_t.ppcKeys.
+ * @param[in] pcValue The new desired value as JSON text, not terminated.
+ * @param[in] ucValueLength The length of pcValue.
+ *
+ * @note The callback is called from the context of the task that applied the
+ * document, usually the MQTT task. It may call #SHADOW_StateSetReported, but
+ * must not block nor apply a document to the same state.
+ */
+typedef void ( * ShadowStateDesiredCallback_t )( void * pvUserData,
+                                                 const char * pcKey,
+                                                 const char * pcValue,
+                                                 uint8_t ucValueLength );
+
+/**
+ * @brief Parameters to pass into #SHADOW_StateInit.
+ */
+typedef struct ShadowStateParams
+{
+    ShadowClientHandle_t xShadowClientHandle;      /**< Shadow Client the reported updates are published with. */
+    const char * pcThingName;                      /**< Thing name of the Shadow, must remain valid. */
+    const char * const * ppcKeys;                  /**< Top level keys of the state, must remain valid. Keys are not escaped. */
+    UBaseType_t uxKeyCount;                        /**< Number of keys, at most #shadowconfigSTATE_MAX_FIELDS. */
+    TickType_t xCoalesceTicks;                     /**< Time reported changes are collected before they are published. */
+    ShadowStateDesiredCallback_t xDesiredCallback; /**< Called when a desired value changes, may be NULL. */
+    void * pvUserData;                             /**< Passed to xDesiredCallback. */
+} ShadowStateParams_t;
+
+/**
+ * @brief Cached values of one key.
+ */
+typedef struct ShadowStateField
+{
+    const char * pcKey;                                    /**< The key. */
+    char cReported[ shadowconfigSTATE_MAX_VALUE_LENGTH ];  /**< Last reported value, JSON text. */
+    char cDesired[ shadowconfigSTATE_MAX_VALUE_LENGTH ];   /**< Last desired value, JSON text. */
+    uint8_t ucKeyLength;                                   /**< Length of pcKey. */
+    uint8_t ucReportedLength;                              /**< Length of cReported, 0 if unknown. */
+    uint8_t ucDesiredLength;                               /**< Length of cDesired, 0 if unknown. */
+    uint8_t ucFlags;                                       /**< Publishing state of the reported value. */
+} ShadowStateField_t;
+
+/**
+ * @brief Parsed keys and values of a Shadow document, so that the values of
+ * changed fields can be passed to the callback once the mutex is released.
+ */
+typedef struct ShadowStateParse
+{
+    ShadowJSONDoc_t xDoc;
+    jsmntok_t xTokens[ shadowconfigJSON_JSMN_TOKENS ];
+    int16_t sValueToken[ shadowconfigSTATE_MAX_FIELDS ]; /**< Token of the new desired value of each field. */
+    uint32_t ulChangedFields;                            /**< Bit n set if the desired value of field n changed. */
+} ShadowStateParse_t;
+
+/**
+ * @brief A Shadow state.
+ *
+ * Allocated by the application and initialized with #SHADOW_StateInit. The
+ * members are private to the Shadow state functions.
+ */
+typedef struct ShadowState
+{
+    ShadowClientHandle_t xShadowClientHandle;
+    const char * pcThingName;
+    TickType_t xCoalesceTicks;
+    ShadowStateDesiredCallback_t xDesiredCallback;
+    void * pvUserData;
+    uint32_t ulVersion;                /**< Version of the last document applied, 0 if none. */
+    uint32_t ulUpdateCount;            /**< Number of updates published, used in the client token. */
+    TickType_t xFirstChangeTicks;      /**< Time of the first reported change not yet published. */
+    BaseType_t xChangePending;         /**< pdTRUE if reported changes wait to be published. */
+    UBaseType_t uxFieldCount;
+    ShadowStateField_t xFields[ shadowconfigSTATE_MAX_FIELDS ];
+    char cDocument[ shadowconfigSTATE_DOCUMENT_LENGTH ]; /**< Update document built by #SHADOW_StateProcess. */
+    ShadowStateParse_t xParse;                           /**< Document being applied, kept off the stack of the MQTT task. */
+    SemaphoreHandle_t xMutex;
+    StaticSemaphore_t xMutexBuffer;
+    SemaphoreHandle_t xParseMutex; /**< Guards xParse until the desired callbacks return. */
+    StaticSemaphore_t xParseMutexBuffer;
+} ShadowState_t;
+
+/**
+ * @brief Initialize a Shadow state.
+ *
+ * All values are unknown until reported by the application or applied from a
+ * Shadow document.
+ *
+ * @param[out] pxState The Shadow state to initialize.
+ * @param[in] pxParams A pointer to a #ShadowStateParams struct.
+ *
+ * @return pdPASS on success; pdFAIL if there are too many keys or a key is
+ * too long.
+ */
+BaseType_t SHADOW_StateInit( ShadowState_t * const pxState,
+                             const ShadowStateParams_t * const pxParams );
+
+/**
+ * @brief Set the reported value of a key.
+ *
+ * The value is published by #SHADOW_StateProcess if it differs from the last
+ * value set or applied from a Shadow document.
+ *
+ * @param[in] pxState The Shadow state.
+ * @param[in] pcKey The key.
+ * @param[in] pcValue The value as JSON text, e.g. "\"red\"" or "42".
+ * @param[in] ucValueLength The length of pcValue, less than
+ * #shadowconfigSTATE_MAX_VALUE_LENGTH.
+ *
+ * @return pdPASS if the value was stored; pdFAIL if the key is unknown or the
+ * value is too long.
+ */
+BaseType_t SHADOW_StateSetReported( ShadowState_t * const pxState,
+                                    const char * const pcKey,
+                                    const char * const pcValue,
+                                    uint8_t ucValueLength );
+
+/**
+ * @brief Copy the desired value of a key.
+ *
+ * @param[in] pxState The Shadow state.
+ * @param[in] pcKey The key.
+ * @param[out] pcBuffer Buffer the value is copied to, as JSON text.
+ * @param[in] xBufferLength The size of pcBuffer. The value is zero
+ * terminated if it fits.
+ *
+ * @return The length of the value; 0 if the key or its desired value is
+ * unknown, or the value does not fit in pcBuffer.
+ */
+uint8_t SHADOW_StateGetDesired( ShadowState_t * const pxState,
+                                const char * const pcKey,
+                                char * const pcBuffer,
+                                size_t xBufferLength );
+
+/**
+ * @brief Apply a document received on /update/delta.
+ *
+ * Only the keys of the delta are parsed and updated. Unknown keys and values
+ * too long for the cache are ignored.
+ *
+ * @param[in] pxState The Shadow state.
+ * @param[in] pcDeltaDocument The delta document, e.g. as received by a
+ * #ShadowDeltaCallback_t.
+ * @param[in] ulDocumentLength The length of pcDeltaDocument.
+ *
+ * @return #eShadowSuccess, also if the delta is older than the cached version;
+ * jsmn error if the document could not be parsed; #eShadowFailure if it has no
+ * "state".
+ */
+ShadowReturnCode_t SHADOW_StateApplyDelta( ShadowState_t * const pxState,
+                                           const char * const pcDeltaDocument,
+                                           uint32_t ulDocumentLength );
+
+/**
+ * @brief Apply a full Shadow document, as returned by #SHADOW_Get.
+ *
+ * The desired and reported values of the document replace the cached ones,
+ * except for reported values changed locally and not yet published.
+ *
+ * @param[in] pxState The Shadow state.
+ * @param[in] pcDocument The Shadow document.
+ * @param[in] ulDocumentLength The length of pcDocument.
+ *
+ * @return See #SHADOW_StateApplyDelta.
+ *
+ * @note The document includes "metadata", so it takes about twice as many
+ * jsmn tokens as its state. Raise #shadowconfigJSON_JSMN_TOKENS if needed.
+ */
+ShadowReturnCode_t SHADOW_StateApplyDocument( ShadowState_t * const pxState,
+                                              const char * const pcDocument,
+                                              uint32_t ulDocumentLength );
+
+/**
+ * @brief Publish the reported changes once they have been coalesced.
+ *
+ * Must be called by a single task, which should block for at most the
+ * returned time before calling it again. The update document holds only the
+ * keys whose reported value changed. If the update fails, they are published
+ * again after another #ShadowStateParams_t.xCoalesceTicks.
+ *
+ * @param[in] pxState The Shadow state.
+ * @param[in] xTimeoutTicks Passed to #SHADOW_Update.
+ *
+ * @return The number of ticks until this function needs to be called again;
+ * portMAX_DELAY if no change is pending.
+ */
+TickType_t SHADOW_StateProcess( ShadowState_t * const pxState,
+                                TickType_t xTimeoutTicks );
+
+#endif /* _AWS_SHADOW_STATE_H_ */
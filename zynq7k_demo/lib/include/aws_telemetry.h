@@ -0,0 +1,157 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_telemetry.h
+ * @brief Run time statistics of the kernel, the heap and the TCP/IP stack.
+ *
+ * The telemetry task samples the CPU time and stack headroom of every task,
+ * the heap and the network buffers every telemetryconfigSAMPLE_PERIOD_MS. A
+ * summary of each sample is kept in a ring so that an overload can be looked
+ * at after the fact, and a CBOR snapshot of the latest sample is published
+ * every telemetryconfigPUBLISH_PERIOD_MS once an MQTT agent has been set.
+ *
+ * CPU time is measured with the kernel's run time stats counter, so
+ * configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS must be 1.
+ */
+
+#ifndef _AWS_TELEMETRY_H_
+#define _AWS_TELEMETRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "aws_mqtt_agent.h"
+
+/**
+ * @brief Length of the task name stored in TelemetryTask_t, including the
+ * terminating zero.
+ */
+#define telemetryTASK_NAME_LENGTH    ( 16 )
+
+/**
+ * @brief Use of one task during the last sample interval.
+ */
+typedef struct TelemetryTask
+{
+    char cTaskName[ telemetryTASK_NAME_LENGTH ]; /**< Zero terminated, may be truncated. */
+    uint32_t ulTaskNumber;                       /**< Unique number assigned to the task by the kernel. */
+    uint32_t ulCpuLoad;                          /**< Share of the interval, in tenths of a percent. */
+    uint32_t ulStackHeadroom;                    /**< Minimum free stack since the task started, in words. */
+} TelemetryTask_t;
+
+/**
+ * @brief Summary of one sample, as kept in the history ring.
+ */
+typedef struct TelemetrySample
+{
+    uint32_t ulUptimeMs;              /**< Time of the sample since the scheduler started. */
+    uint16_t usCpuLoad;               /**< Share of the interval not spent idle, in tenths of a percent. */
+    uint16_t usBusiestTaskLoad;       /**< Load of the busiest task other than idle, in tenths of a percent. */
+    uint32_t ulBusiestTaskNumber;     /**< Task number of the busiest task other than idle. */
+    uint32_t ulLowestStackHeadroom;   /**< Lowest stack headroom of all tasks, in words. */
+    uint32_t ulLowestStackTaskNumber; /**< Task number of the task with the lowest stack headroom. */
+    uint32_t ulHeapFree;              /**< Free heap, in bytes. */
+    uint32_t ulHeapMinimumEverFree;   /**< Lowest free heap since boot, in bytes. */
+    uint16_t usNetworkBuffersFree;    /**< Free network buffers. */
+    uint16_t usNetworkBuffersMinimum; /**< Lowest number of free network buffers since boot. */
+} TelemetrySample_t;
+
+/**
+ * @brief Take a sample now.
+ *
+ * The CPU load is measured since the previous sample, which Device Defender
+ * may also have taken. The first sample only starts the interval and is not
+ * recorded. The telemetry task calls this periodically, so it only needs to
+ * be called directly when the task is not used.
+ *
+ * @return pdPASS if the sample was recorded, pdFAIL if it was the first one
+ * or there are more than telemetryconfigMAX_TASKS tasks.
+ */
+BaseType_t TELEMETRY_Sample( void );
+
+/**
+ * @brief Number of samples not taken because there were more than
+ * telemetryconfigMAX_TASKS tasks.
+ *
+ * The figures of the last sample taken are kept while samples are skipped, so
+ * a non-zero count means they may be stale.
+ */
+uint32_t TELEMETRY_GetSkippedSamples( void );
+
+/**
+ * @brief Copy the per task figures of the last sample.
+ *
+ * @param[out] pxTasks Array receiving the figures.
+ * @param[in] xMaxTasks Number of entries in pxTasks.
+ *
+ * @return Number of entries written.
+ */
+size_t TELEMETRY_GetTasks( TelemetryTask_t * pxTasks,
+                           size_t xMaxTasks );
+
+/**
+ * @brief Copy the most recent samples from the history ring, oldest first.
+ *
+ * @param[out] pxSamples Array receiving the samples.
+ * @param[in] xMaxSamples Number of entries in pxSamples.
+ *
+ * @return Number of entries written.
+ */
+size_t TELEMETRY_ReadHistory( TelemetrySample_t * pxSamples,
+                              size_t xMaxSamples );
+
+/**
+ * @brief Encode the last sample as CBOR.
+ *
+ * The snapshot is a map of "up" in seconds, "cpu", "heap" {"free", "min"},
+ * "net" {"free", "min"} and "tasks", an array of [name, cpu, stack] arrays.
+ *
+ * @return Size of the snapshot, 0 if it did not fit in xBufferSize bytes.
+ */
+size_t TELEMETRY_EncodeSnapshot( uint8_t * pucBuffer,
+                                 size_t xBufferSize );
+
+/**
+ * @brief Set the connected MQTT agent the snapshots are published with.
+ *
+ * Waits for a snapshot being published with the previous agent, up to
+ * telemetryconfigPUBLISH_TIMEOUT_MS, so that agent can be disconnected and
+ * deleted as soon as this returns.
+ *
+ * @param[in] xMQTTAgent The agent, or NULL to stop publishing before the
+ * agent is disconnected.
+ */
+void TELEMETRY_MqttAgentSet( MQTTAgentHandle_t xMQTTAgent );
+
+/**
+ * @brief Start the telemetry task.
+ *
+ * @return pdPASS if the task was created, pdFAIL otherwise.
+ */
+BaseType_t TELEMETRY_Start( void );
+
+#endif /* _AWS_TELEMETRY_H_ */
@@ -69,6 +69,8 @@ typedef BaseType_t ( * NetworkSend_t ) ( void * pvCallerContext,
  * @param[in] pxNetworkSend Caller-defined network send function pointer.
  * @param[in] pvCallerContext Caller-defined context handle to be used with callback
  * functions.
+ * @param[in] xCoalesceWrites pdTRUE to coalesce small writes into one record
+ * until TLS_Flush() is called, see tlsconfigCOALESCE_BUFFER_SIZE.
  */
 typedef struct xTLS_PARAMS
 {
@@ -82,6 +84,7 @@ typedef struct xTLS_PARAMS
     NetworkRecv_t pxNetworkRecv;
     NetworkSend_t pxNetworkSend;
     void * pvCallerContext;
+    BaseType_t xCoalesceWrites;
 } TLSParams_t;
 
 /**
@@ -126,11 +129,38 @@ BaseType_t TLS_Recv( void * pvContext,
  * @param xMsgLength Length in bytes of write buffer.
  *
  * @return Number of bytes read. Error return codes have the high bit set.
+ *
+ * @note If the context coalesces writes, data shorter than
+ * tlsconfigCOALESCE_BUFFER_SIZE may be buffered and counted as written. It is
+ * sent by TLS_Flush(), by TLS_Recv(), when the buffer fills, or by a
+ * TLS_Send() made after tlsconfigCOALESCE_DEADLINE_MS.
  */
 BaseType_t TLS_Send( void * pvContext,
                      const unsigned char * pucMsg,
                      size_t xMsgLength );
 
+/**
+ * @brief Sends the writes coalesced by TLS_Send() as one record.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ *
+ * @return Number of bytes still buffered, zero once everything was sent.
+ * Error return codes have the high bit set.
+ */
+BaseType_t TLS_Flush( void * pvContext );
+
+/**
+ * @brief Changes the caller context handle passed to the network callbacks.
+ *
+ * Lets a connected context be handed to a new owner of the underlying
+ * network connection.
+ *
+ * @param pvContext Opaque context handle for TLS library.
+ * @param pvCallerContext New caller-defined context handle.
+ */
+void TLS_SetCallerContext( void * pvContext,
+                           void * pvCallerContext );
+
 /**
  * @brief Frees resources consumed by the TLS context.
  *
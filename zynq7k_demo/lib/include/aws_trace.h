@@ -0,0 +1,133 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace.h
+ * @brief Lightweight binary event tracing.
+ *
+ * Events are 16 byte records written into a ring owned by the core that
+ * records them. Recording is lock-free and never masks interrupts, so it can
+ * be used from the kernel trace macros, from interrupts and from tasks. When
+ * the ring is full the oldest events are overwritten; the reader reports how
+ * many it missed.
+ *
+ * This header only depends on stdint.h so that it can be included at the end
+ * of FreeRTOSConfig.h to define the kernel trace macros. Tracing is compiled
+ * in when configUSE_AWS_TRACE is set to 1, otherwise TRACE_EVENT() expands to
+ * nothing and aws_trace.c does not need to be built.
+ *
+ * The ring is drained with the functions of aws_trace_drain.h and converted
+ * to Chrome trace JSON on the host with lib/trace/aws_trace_to_chrome.py.
+ */
+
+#ifndef _AWS_TRACE_H_
+#define _AWS_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef configUSE_AWS_TRACE
+    #define configUSE_AWS_TRACE    0
+#endif
+
+/**
+ * @brief Event identifiers. Values are part of the binary format understood
+ * by the host converter, new events are only ever added at the end.
+ */
+typedef enum TraceEventId
+{
+    eTraceEventsLost = 0,          /**< ulArgument: number of events overwritten before they were read. */
+    eTraceTaskName,                /**< usTask named, ulArgument: 4 characters of the name, sent in order. */
+    eTraceTaskSwitchedIn,          /**< usTask starts running. */
+    eTraceQueueSend,               /**< ulArgument: queue, semaphore or mutex. */
+    eTraceQueueSendFromISR,        /**< ulArgument: queue or semaphore. */
+    eTraceQueueReceive,            /**< ulArgument: queue, semaphore or mutex. */
+    eTraceQueueReceiveFromISR,     /**< ulArgument: queue or semaphore. */
+    eTraceQueueBlockOnSend,        /**< ulArgument: queue the task blocks on. */
+    eTraceQueueBlockOnReceive,     /**< ulArgument: queue the task blocks on. */
+    eTraceNetworkTransmit,         /**< A frame is handed to the Ethernet driver. */
+    eTraceNetworkReceive,          /**< A frame is received by the Ethernet driver. */
+    eTraceNetworkEvent,            /**< ulArgument: eIPEvent_t processed by the IP task. */
+    eTraceMqttCommandQueued,       /**< ulArgument: message identifier | MQTT agent command. */
+    eTraceMqttCommandDequeued,     /**< ulArgument: message identifier | MQTT agent command. */
+    eTraceMqttPacketSent,          /**< ulArgument: message identifier. The packet was written to the socket. */
+    eTraceMqttCommandNotified,     /**< ulArgument: message identifier | notification code | status. */
+    eTraceMqttCommandComplete,     /**< ulArgument: message identifier. The calling task has the result. */
+    eTraceTlsHandshakeState,       /**< ulArgument: mbedTLS handshake state about to be processed. */
+    eTraceTlsHandshakeDone,        /**< ulArgument: handshake result. */
+    eTraceTlsWriteBegin,           /**< ulArgument: bytes to encrypt and send. */
+    eTraceTlsWriteEnd,             /**< ulArgument: bytes sent, or an error. */
+    eTraceOtaBlockReceived,        /**< ulArgument: block index. */
+    eTraceOtaBlockWritten,         /**< ulArgument: block index. */
+    eTraceOtaFileClosed            /**< ulArgument: close result. */
+} TraceEventId_t;
+
+/**
+ * @brief A recorded event.
+ */
+typedef struct TraceEvent
+{
+    uint32_t ulTimestamp; /**< Microseconds, wrapping. */
+    uint8_t ucEvent;      /**< TraceEventId_t. */
+    uint8_t ucCpu;        /**< Core that recorded the event. */
+    uint16_t usTask;      /**< Task number of the running task, 0 before the scheduler starts. */
+    uint32_t ulArgument;  /**< Event specific. */
+    uint32_t ulSequence;  /**< Position in the ring plus one, 0 while being written. */
+} TraceEvent_t;
+
+#if ( configUSE_AWS_TRACE == 1 )
+
+    /**
+     * @brief Record an event for the running task.
+     *
+     * Safe to call from tasks, interrupts and critical sections.
+     *
+     * @param[in] ucEvent TraceEventId_t.
+     * @param[in] ulArgument Event specific.
+     */
+    void TRACE_Record( uint8_t ucEvent,
+                       uint32_t ulArgument );
+
+    /**
+     * @brief Record an event for a given task number.
+     *
+     * Used by the kernel trace macros, which know the task number without looking
+     * it up.
+     */
+    void TRACE_RecordTask( uint8_t ucEvent,
+                           uint16_t usTask,
+                           uint32_t ulArgument );
+
+    /**
+     * @brief Record the name of a task as eTraceTaskName events.
+     */
+    void TRACE_RecordTaskName( uint16_t usTask,
+                               const char * pcName );
+
+    #define TRACE_EVENT( ucEvent, ulArgument )    TRACE_Record( ( uint8_t ) ( ucEvent ), ( uint32_t ) ( ulArgument ) )
+#else
+    #define TRACE_EVENT( ucEvent, ulArgument )
+#endif /* configUSE_AWS_TRACE */
+
+#endif /* _AWS_TRACE_H_ */
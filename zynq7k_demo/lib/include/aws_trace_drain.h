@@ -0,0 +1,124 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace_drain.h
+ * @brief Reading the trace ring and streaming it off the device.
+ *
+ * A drain stream starts with a TraceStreamHeader_t, followed by the names of
+ * the tasks that already exist and then by TraceEvent_t records, all little
+ * endian. The same stream can be written to a TCP connection with
+ * TRACE_StartSocketDrain() or to any other byte sink, such as a UART, with
+ * TRACE_WriteStreamHeader() and TRACE_DrainOnce().
+ */
+
+#ifndef _AWS_TRACE_DRAIN_H_
+#define _AWS_TRACE_DRAIN_H_
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "aws_trace.h"
+
+/**
+ * @brief First bytes of a drain stream, "ATRC".
+ */
+#define traceSTREAM_MAGIC      ( 0x43525441UL )
+
+/**
+ * @brief Version of the stream format.
+ */
+#define traceSTREAM_VERSION    ( 1 )
+
+/**
+ * @brief Start of a drain stream. Same size as a TraceEvent_t.
+ */
+typedef struct TraceStreamHeader
+{
+    uint32_t ulMagic;       /**< traceSTREAM_MAGIC. */
+    uint16_t usVersion;     /**< traceSTREAM_VERSION. */
+    uint8_t ucCpu;          /**< Core whose ring follows. */
+    uint8_t ucReserved;     /**< Zero. */
+    uint32_t ulTimestamp;   /**< Time the stream was started, microseconds. */
+    uint32_t ulEventCount;  /**< Number of events the ring holds. */
+} TraceStreamHeader_t;
+
+/**
+ * @brief Writes bytes to a drain sink.
+ *
+ * @return pdPASS if all xLength bytes were written, pdFAIL otherwise.
+ */
+typedef BaseType_t ( * TraceWriteFunction_t )( void * pvContext,
+                                                const void * pvData,
+                                                size_t xLength );
+
+/**
+ * @brief Copy the oldest unread events out of the ring.
+ *
+ * There must only be one reader. Events that were overwritten before they
+ * could be read are skipped and counted.
+ *
+ * @param[out] pxEvents Buffer for the events.
+ * @param[in] xMaxEvents Size of pxEvents.
+ * @param[out] pulLost Number of events skipped.
+ *
+ * @return Number of events copied into pxEvents.
+ */
+size_t TRACE_Read( TraceEvent_t * pxEvents,
+                   size_t xMaxEvents,
+                   uint32_t * pulLost );
+
+/**
+ * @brief Write the stream header and the name of every existing task.
+ *
+ * @return pdPASS if everything was written, pdFAIL otherwise.
+ */
+BaseType_t TRACE_WriteStreamHeader( TraceWriteFunction_t xWrite,
+                                    void * pvContext );
+
+/**
+ * @brief Write every event that can be read now.
+ *
+ * Lost events are reported in the stream as eTraceEventsLost events.
+ *
+ * @return pdPASS if everything was written, pdFAIL otherwise.
+ */
+BaseType_t TRACE_DrainOnce( TraceWriteFunction_t xWrite,
+                            void * pvContext );
+
+/**
+ * @brief Start a task that connects to the trace collector on the host and
+ * streams the ring to it every traceconfigDRAIN_PERIOD_MS.
+ *
+ * The collector is given by traceconfigDRAIN_HOST_ADDR0..3 and
+ * traceconfigDRAIN_HOST_PORT, which have no default. The connection is
+ * retried if it fails or breaks.
+ *
+ * @return pdPASS if the task was created, pdFAIL otherwise, including when no
+ * collector is configured.
+ */
+BaseType_t TRACE_StartSocketDrain( void );
+
+#endif /* _AWS_TRACE_DRAIN_H_ */
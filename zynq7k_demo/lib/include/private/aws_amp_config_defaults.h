@@ -0,0 +1,102 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_amp_config_defaults.h
+ * @brief Default values for the AMP inter-core channel and sockets proxy.
+ */
+
+#ifndef _AWS_AMP_CONFIG_DEFAULTS_H_
+#define _AWS_AMP_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Largest payload carried by a single channel message.
+ *
+ * Bounds the data moved by one proxied SOCKETS_Send() or SOCKETS_Recv() call
+ * and the size of a trusted server certificate. The rings must be at least
+ * twice this size plus the message header.
+ */
+#ifndef ampconfigMAX_PAYLOAD
+    #define ampconfigMAX_PAYLOAD    ( 2048 )
+#endif
+
+/**
+ * @brief Number of calls that may wait for a reply at the same time on one
+ * channel. Further callers block until a call completes.
+ */
+#ifndef ampconfigMAX_PENDING_CALLS
+    #define ampconfigMAX_PENDING_CALLS    ( 8 )
+#endif
+
+/**
+ * @brief Ticks to wait before retrying when the transmit ring is full.
+ *
+ * The other core does not signal freed ring space, so senders poll.
+ */
+#ifndef ampconfigRING_FULL_RETRY_TICKS
+    #define ampconfigRING_FULL_RETRY_TICKS    ( 1 )
+#endif
+
+/**
+ * @brief Stack size and priority of the task that drains the receive ring.
+ */
+#ifndef ampconfigRECEIVE_TASK_STACK_SIZE
+    #define ampconfigRECEIVE_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+
+#ifndef ampconfigRECEIVE_TASK_PRIORITY
+    #define ampconfigRECEIVE_TASK_PRIORITY    ( configMAX_PRIORITIES - 2 )
+#endif
+
+/**
+ * @brief Number of tasks serving proxied socket calls on the network core.
+ *
+ * A blocking SOCKETS_Recv() holds a worker for its whole timeout, so this
+ * should be at least one more than the number of sockets in use.
+ */
+#ifndef ampconfigSOCKETS_SERVER_WORKERS
+    #define ampconfigSOCKETS_SERVER_WORKERS    ( 4 )
+#endif
+
+/**
+ * @brief Stack size and priority of the socket server workers. The workers
+ * run the TLS handshake, so they need a large stack.
+ */
+#ifndef ampconfigSOCKETS_WORKER_STACK_SIZE
+    #define ampconfigSOCKETS_WORKER_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 16 )
+#endif
+
+#ifndef ampconfigSOCKETS_WORKER_PRIORITY
+    #define ampconfigSOCKETS_WORKER_PRIORITY    ( tskIDLE_PRIORITY + 5 )
+#endif
+
+/**
+ * @brief Maximum number of ALPN protocols forwarded by SOCKETS_SetSockOpt().
+ */
+#ifndef ampconfigSOCKETS_MAX_ALPN_PROTOCOLS
+    #define ampconfigSOCKETS_MAX_ALPN_PROTOCOLS    ( 4 )
+#endif
+
+#endif /* _AWS_AMP_CONFIG_DEFAULTS_H_ */
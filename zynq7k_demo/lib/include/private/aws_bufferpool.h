@@ -29,6 +29,16 @@
  * @brief Buffer Pool Interface.
  *
  * The central pool of buffers.
+ *
+ * Buffers are reference counted. A buffer obtained from the pool has one
+ * reference, owned by the caller. An owner that hands the buffer to another
+ * task without copying it calls BUFFERPOOL_ShareBuffer() first, and every
+ * owner calls BUFFERPOOL_ReturnBuffer() exactly once when it is done. The
+ * buffer goes back to the pool when its last reference is returned, so it is
+ * freed exactly once whichever consumer finishes last.
+ *
+ * The FromISR variants may be called from interrupts whose priority is at or
+ * below configMAX_SYSCALL_INTERRUPT_PRIORITY.
  */
 
 #ifndef _AWS_BUFFER_POOL_H_
@@ -64,10 +74,46 @@ lib_initDECLARE_LIB_INIT( BUFFERPOOL_Init );
 uint8_t * BUFFERPOOL_GetFreeBuffer( uint32_t * pulBufferLength );
 
 /**
- * @brief Returns the buffer back to the central buffer pool.
+ * @brief Interrupt safe version of BUFFERPOOL_GetFreeBuffer().
+ *
+ * @param[in, out] pulBufferLength See BUFFERPOOL_GetFreeBuffer().
+ *
+ * @return The pointer to the buffer if one is available, NULL otherwise.
+ */
+uint8_t * BUFFERPOOL_GetFreeBufferFromISR( uint32_t * pulBufferLength );
+
+/**
+ * @brief Adds a reference to a buffer obtained from the central buffer pool.
+ *
+ * The caller must own a reference to the buffer. The new reference is
+ * typically handed to another task, which returns it with
+ * BUFFERPOOL_ReturnBuffer() when it is done with the buffer.
+ *
+ * @param[in] pucBuffer The buffer to share.
+ */
+void BUFFERPOOL_ShareBuffer( uint8_t * const pucBuffer );
+
+/**
+ * @brief Interrupt safe version of BUFFERPOOL_ShareBuffer().
+ *
+ * @param[in] pucBuffer The buffer to share.
+ */
+void BUFFERPOOL_ShareBufferFromISR( uint8_t * const pucBuffer );
+
+/**
+ * @brief Drops a reference to a buffer obtained from the central buffer pool.
+ *
+ * The buffer goes back to the pool when its last reference is dropped.
  *
  * @param[in] pucBuffer The buffer to return to the buffer pool.
  */
 void BUFFERPOOL_ReturnBuffer( uint8_t * const pucBuffer );
 
+/**
+ * @brief Interrupt safe version of BUFFERPOOL_ReturnBuffer().
+ *
+ * @param[in] pucBuffer The buffer to return to the buffer pool.
+ */
+void BUFFERPOOL_ReturnBufferFromISR( uint8_t * const pucBuffer );
+
 #endif /* _AWS_BUFFER_POOL_H_ */
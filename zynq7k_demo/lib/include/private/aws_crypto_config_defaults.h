@@ -0,0 +1,47 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_crypto_config_defaults.h
+ * @brief Default values for the crypto library configuration.
+ */
+
+#ifndef _AWS_CRYPTO_CONFIG_DEFAULTS_H_
+#define _AWS_CRYPTO_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Number of signer public keys kept parsed by
+ * CRYPTO_SignatureVerificationFinalCached().
+ *
+ * Keys are looked up by the signer name given by the caller, usually the
+ * certificate path of an OTA job document. When the cache is full the least
+ * recently used key which no verification is using is replaced. Set to 0 to
+ * read and parse the signer certificate for every verification.
+ */
+#ifndef cryptoconfigSIGNER_KEY_CACHE_SIZE
+    #define cryptoconfigSIGNER_KEY_CACHE_SIZE    ( 0 )
+#endif
+
+#endif /* _AWS_CRYPTO_CONFIG_DEFAULTS_H_ */
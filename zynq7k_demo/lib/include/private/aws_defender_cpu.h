@@ -25,7 +25,36 @@
 #ifndef AWS_DEFENDER_CPU_H
 #define AWS_DEFENDER_CPU_H
 
+#include <stdint.h>
+
+/** Length of the task name stored in DefenderTaskCpu_t, including the NULL */
+#define DEFENDER_TASK_NAME_LENGTH    ( 16 )
+
+/**
+ * @brief CPU time used by one task during the last refresh interval
+ */
+typedef struct DefenderTaskCpu
+{
+    char cTaskName[ DEFENDER_TASK_NAME_LENGTH ];
+    uint32_t ulTaskNumber;   /**< Unique number assigned to the task by the kernel */
+    uint32_t ulRunTime;      /**< Run time counter ticks used in the interval */
+    int32_t lLoadPercent;    /**< Share of the interval, in percent */
+    uint32_t ulStackHeadroom; /**< Minimum free stack, in words, since start */
+} DefenderTaskCpu_t;
+
 int32_t CpuLoadGet( void );
 void CpuLoadRefresh( void );
 
+/**
+ * @brief Copies the per task CPU usage measured by the last CpuLoadRefresh
+ *
+ * @param[out] pxTaskCpu  Array to receive the per task usage
+ * @param[in]  lMaxTasks  Number of entries in pxTaskCpu
+ *
+ * @return Number of entries written, 0 if pxTaskCpu is NULL or lMaxTasks is
+ *         negative, or -1 if not supported by the port
+ */
+int32_t CpuTaskLoadGet( DefenderTaskCpu_t * pxTaskCpu,
+                        int32_t lMaxTasks );
+
 #endif /* end of include guard: AWS_DEFENDER_CPU_H */
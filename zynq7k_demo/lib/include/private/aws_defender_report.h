@@ -32,7 +32,21 @@
 #define DEFENDER_METRICS_TAG    DEFENDER_SelectTag( "metrics", "met" )
 #define DEFENDER_TOTAL_TAG      DEFENDER_SelectTag( "total", "t" )
 
-CBORHandle_t CreateReport( void );
+/* Size of the report buffer.  A report that does not fit is not sent. */
+#ifndef DEFENDER_REPORT_BUFFER_SIZE
+    #define DEFENDER_REPORT_BUFFER_SIZE    ( 256 )
+#endif
+
+/**
+ * @brief Encodes the metrics report into the given buffer.
+ *
+ * @param[out] pucBuffer    Buffer receiving the CBOR report
+ * @param[in]  lBufferSize  Size of the buffer
+ *
+ * @return The size of the report, 0 if it could not be encoded.
+ */
+int32_t CreateReport( uint8_t * pucBuffer,
+                      int32_t lBufferSize );
 
 #endif /* ifndef AWS_DEFENDER_REPORT_H */
 
@@ -27,6 +27,6 @@
 
 #include "aws_cbor.h"
 
-CBORHandle_t CpuReportGet( void );
+void CpuReportEncode( CBOREncoder_t * pxEncoder );
 
 #endif /* ifndef AWS_DEFENDER_CPU_H */
@@ -33,6 +33,7 @@ extern const char * DEFENDER_METRICS_VERSION;
 #define DEFENDER_REPORT_ID_TAG    DEFENDER_SelectTag( "report_id", "rid" )
 #define DEFENDER_VERSION_TAG      DEFENDER_SelectTag( "version", "v" )
 
-CBORHandle_t GetHeader( void );
+/* Writes the report header map, taking the next report ID */
+void EncodeHeader( CBOREncoder_t * pxEncoder );
 
 #endif /* end of include guard: AWS_DEFENDER_HEADER_H */
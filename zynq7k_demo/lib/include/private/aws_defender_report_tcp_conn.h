@@ -32,6 +32,6 @@
 #define DEFENDER_EST_CONN_TAG \
     DEFENDER_SelectTag( "established_connections", "ec" )
 
-CBORHandle_t TcpConnReportGet( void );
+void TcpConnReportEncode( CBOREncoder_t * pxEncoder );
 
 #endif /* end of include guard: AWS_DEFENDER_REPORT_TCP_CONN_H */
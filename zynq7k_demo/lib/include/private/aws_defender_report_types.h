@@ -28,12 +28,14 @@
 #include "aws_cbor.h"
 
 typedef void (* UpdateMetric_t)( void );
-typedef CBORHandle_t (* ReportMetric_t)( void );
+
+/* Writes the metric as one key value pair of the report's metrics map */
+typedef void (* EncodeMetric_t)( CBOREncoder_t * );
 
 struct DefenderMetric_s
 {
     UpdateMetric_t UpdateMetric;
-    ReportMetric_t ReportMetric;
+    EncodeMetric_t EncodeMetric;
 };
 
 /**
@@ -27,6 +27,6 @@
 
 #include "aws_cbor.h"
 
-CBORHandle_t UptimeReportGet( void );
+void UptimeReportEncode( CBOREncoder_t * pxEncoder );
 
 #endif /* end of include guard: AWS_DEFENDER_UPTIME_H */
@@ -0,0 +1,97 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_entropy_config_defaults.h
+ * @brief Default values for the entropy source configuration.
+ *
+ * The defaults assume 0.5 bit of min-entropy per raw sample. A port whose
+ * source was assessed differently must set all of the values below, the
+ * host checks in tests/entropy recompute them from
+ * entropyconfigMIN_ENTROPY_MILLIBITS.
+ */
+
+#ifndef _AWS_ENTROPY_CONFIG_DEFAULTS_H_
+#define _AWS_ENTROPY_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Assessed min-entropy of one raw sample, in thousandths of a bit.
+ */
+#ifndef entropyconfigMIN_ENTROPY_MILLIBITS
+    #define entropyconfigMIN_ENTROPY_MILLIBITS    ( 500 )
+#endif
+
+/**
+ * @brief Raw samples conditioned into one output block.
+ *
+ * SHA-256 output has full entropy when it is given at least 64 bits more
+ * than its 256 bits, so ( 256 + 64 ) * 1000 / entropyconfigMIN_ENTROPY_MILLIBITS.
+ */
+#ifndef entropyconfigSAMPLES_PER_BLOCK
+    #define entropyconfigSAMPLES_PER_BLOCK    ( 640 )
+#endif
+
+/**
+ * @brief Repetition count test cutoff.
+ *
+ * 1 + ceil( 20 / H ) for a false positive rate of 2^-20, SP 800-90B 4.4.1.
+ */
+#ifndef entropyconfigRCT_CUTOFF
+    #define entropyconfigRCT_CUTOFF    ( 41 )
+#endif
+
+/**
+ * @brief Adaptive proportion test window, SP 800-90B 4.4.2.
+ */
+#ifndef entropyconfigAPT_WINDOW
+    #define entropyconfigAPT_WINDOW    ( 512 )
+#endif
+
+/**
+ * @brief Adaptive proportion test cutoff.
+ *
+ * 1 + CRITBINOM( W, 2^-H, 1 - 2^-20 ), SP 800-90B 4.4.2.
+ */
+#ifndef entropyconfigAPT_CUTOFF
+    #define entropyconfigAPT_CUTOFF    ( 410 )
+#endif
+
+/**
+ * @brief Raw samples health tested and discarded when a source starts,
+ * SP 800-90B 4.3.
+ */
+#ifndef entropyconfigSTARTUP_SAMPLES
+    #define entropyconfigSTARTUP_SAMPLES    ( 1024 )
+#endif
+
+/**
+ * @brief Blocks in a row which may fail the health tests before the source
+ * is reported as failed.
+ */
+#ifndef entropyconfigMAX_FAILED_BLOCKS
+    #define entropyconfigMAX_FAILED_BLOCKS    ( 3 )
+#endif
+
+#endif /* _AWS_ENTROPY_CONFIG_DEFAULTS_H_ */
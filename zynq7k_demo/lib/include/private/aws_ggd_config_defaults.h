@@ -77,6 +77,68 @@
     #define ggdconfigJSON_MAX_TOKENS    ( 128 )        /* Size of the array used by jsmn to store the tokens. */
 #endif
 
+/**
+ * @brief Size of the buffer used to receive the discovery document in chunks.
+ *
+ * The discovery document is parsed as it is received, so only this many
+ * bytes of it are held in RAM at any time.
+ */
+#ifndef ggdconfigJSON_STREAM_CHUNK_SIZE
+    #define ggdconfigJSON_STREAM_CHUNK_SIZE    ( 128 )
+#endif
+
+/**
+ * @brief Maximum number of connectivity entries kept for the selected core.
+ *
+ * Further entries are skipped while parsing the discovery document.
+ */
+#ifndef ggdconfigMAX_CONNECTIVITY_ENTRIES
+    #define ggdconfigMAX_CONNECTIVITY_ENTRIES    ( 4 )
+#endif
+
+/**
+ * @brief Maximum length of a connectivity entry host address, excluding the
+ * null terminator.
+ *
+ * Entries with a longer host address are skipped.
+ */
+#ifndef ggdconfigHOST_ADDRESS_MAX_LENGTH
+    #define ggdconfigHOST_ADDRESS_MAX_LENGTH    ( 64 )
+#endif
+
+/**
+ * @brief Set to 1 to probe all the connectivity entries of the selected core
+ * at once before the TLS connection.
+ *
+ * Non-blocking TCP connects are started to every entry and the entry that
+ * completes first is tried first. Requires FreeRTOS+TCP with
+ * ipconfigSUPPORT_SELECT_FUNCTION set to 1. When 0, the entries are tried
+ * one by one in the order of the discovery document.
+ */
+#ifndef ggdconfigPARALLEL_PROBE
+    #define ggdconfigPARALLEL_PROBE    ( 0 )
+#endif
+
+/**
+ * @brief Time in milliseconds to wait for one of the probed entries to accept
+ * the TCP connection.
+ */
+#ifndef ggdconfigPROBE_TIMEOUT_MS
+    #define ggdconfigPROBE_TIMEOUT_MS    ( 3000 )
+#endif
+
+/**
+ * @brief Set to 1 to keep a standby connection to the discovery endpoint.
+ *
+ * After a successful connect, GGD_JSONRequestStart() registers the endpoint
+ * with SOCKETS_StandbyAdd(), so the next discovery request skips the TCP
+ * connection and the TLS handshake. The secure sockets port must keep standby
+ * connections, see socketsconfigSTANDBY_MAX_ENDPOINTS.
+ */
+#ifndef ggdconfigKEEP_STANDBY_CONNECTION
+    #define ggdconfigKEEP_STANDBY_CONNECTION    ( 0 )
+#endif
+
 #ifndef ggdconfigPRINT
     #define ggdconfigPRINT    vLoggingPrintf
 #endif
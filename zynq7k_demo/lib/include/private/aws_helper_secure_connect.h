@@ -105,4 +105,32 @@ BaseType_t GGD_SecureConnect_Read( char * pcBuffer,
                                    const Socket_t xSocket,
                                    uint32_t * pulDataRecvSize );
 
+#if ( ggdconfigPARALLEL_PROBE == 1 )
+
+/*
+ * @brief Find the connectivity entry that accepts a TCP connection first.
+ *
+ * A non-blocking TCP connect is started to every entry, then the function
+ * waits for the first one to complete. All the probe connections are closed
+ * before returning, no TLS session is established.
+ * Loopback and IPv6 addresses are skipped.
+ *
+ * @param [in] pxEntries: Connectivity entries to probe.
+ *
+ * @param [in] ucEntryCount: Number of entries, at most
+ * ggdconfigMAX_CONNECTIVITY_ENTRIES.
+ *
+ * @param [in] ulTimeOut: Time in milliseconds to wait for a connection.
+ *
+ * @param [out] pucFirstConnected: Index of the entry that connected first.
+ *
+ * @return If an entry accepted the connection in time then pdPASS is
+ * returned.  Otherwise pdFAIL is returned.
+ */
+    BaseType_t GGD_SecureConnect_Probe( const GGD_ConnectivityEntry_t * pxEntries,
+                                        const uint8_t ucEntryCount,
+                                        uint32_t ulTimeOut,
+                                        uint8_t * pucFirstConnected );
+#endif
+
 #endif /* _AWS_HELPER_SECURE_CONNECT_H_ */
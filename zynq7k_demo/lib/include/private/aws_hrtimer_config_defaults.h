@@ -0,0 +1,86 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_hrtimer_config_defaults.h
+ * @brief Default values for the high resolution timer configuration.
+ */
+
+#ifndef _AWS_HRTIMER_CONFIG_DEFAULTS_H_
+#define _AWS_HRTIMER_CONFIG_DEFAULTS_H_
+
+/* The port must provide the hardware counter and comparator. */
+#ifndef hrtimerconfigCOUNTS_PER_SECOND
+    #error hrtimerconfigCOUNTS_PER_SECOND must be defined in aws_hrtimer_config.h
+#endif
+
+#ifndef hrtimerconfigGET_TIME
+    #error hrtimerconfigGET_TIME must be defined in aws_hrtimer_config.h
+#endif
+
+#ifndef hrtimerconfigSET_COMPARE
+    #error hrtimerconfigSET_COMPARE must be defined in aws_hrtimer_config.h
+#endif
+
+#ifndef hrtimerconfigDISABLE_COMPARE
+    #error hrtimerconfigDISABLE_COMPARE must be defined in aws_hrtimer_config.h
+#endif
+
+/**
+ * @brief Largest number of timers active at the same time.
+ *
+ * Each slot of the heap takes one pointer. Starts and stops take
+ * O(log hrtimerconfigMAX_ACTIVE_TIMERS) with interrupts masked.
+ */
+#ifndef hrtimerconfigMAX_ACTIVE_TIMERS
+    #define hrtimerconfigMAX_ACTIVE_TIMERS    ( 16 )
+#endif
+
+/**
+ * @brief Priority of the task running the timer callbacks.
+ */
+#ifndef hrtimerconfigTASK_PRIORITY
+    #define hrtimerconfigTASK_PRIORITY    ( configMAX_PRIORITIES - 1 )
+#endif
+
+/**
+ * @brief Stack size of the task running the timer callbacks.
+ */
+#ifndef hrtimerconfigTASK_STACK_SIZE
+    #define hrtimerconfigTASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/**
+ * @brief Counts it takes to program the comparator and take its interrupt.
+ *
+ * Timers expiring within this margin of the current time are dispatched
+ * without programming the comparator, which could otherwise be set to a time
+ * that has passed by the time it is written.
+ */
+#ifndef hrtimerconfigMIN_COMPARE_DELTA
+    #define hrtimerconfigMIN_COMPARE_DELTA    ( 0 )
+#endif
+
+#endif /* _AWS_HRTIMER_CONFIG_DEFAULTS_H_ */
@@ -107,6 +107,33 @@
     #error "mqttconfigMQTT_TASK_MAX_BLOCK_TICKS must be defined in aws_mqtt_agent_config.h."
 #endif
 
+/**
+ * @brief Controls whether the packets sent on a secured connection during one
+ * pass of the MQTT task are coalesced into as few TLS records as possible.
+ *
+ * If mqttconfigCOALESCE_TLS_WRITES is set to 1, secured connections are opened
+ * with SOCKETS_SO_TLS_COALESCE and the MQTT task flushes them with
+ * SOCKETS_SO_TLS_FLUSH before it blocks again. The secure sockets port must
+ * support both options.
+ */
+#ifndef mqttconfigCOALESCE_TLS_WRITES
+    #define mqttconfigCOALESCE_TLS_WRITES    ( 0 )
+#endif
+
+/**
+ * @brief Controls whether a standby connection to the broker is kept for the
+ * next connect.
+ *
+ * If mqttconfigKEEP_STANDBY_CONNECTION is set to 1, the broker of each
+ * successful secured connect is registered with SOCKETS_StandbyAdd(), so a
+ * reconnect does not wait for a TCP connection and a TLS handshake. The
+ * secure sockets port must keep standby connections, see
+ * socketsconfigSTANDBY_MAX_ENDPOINTS.
+ */
+#ifndef mqttconfigKEEP_STANDBY_CONNECTION
+    #define mqttconfigKEEP_STANDBY_CONNECTION    ( 0 )
+#endif
+
 /**
  * @defgroup MQTTTask MQTT task configuration parameters.
  */
@@ -167,8 +194,27 @@
  * #define mqttconfigGET_FREE_BUFFER_FXN       UserDefined_GetFreeBuffer
  * #define mqttconfigRETURN_BUFFER_FXN         UserDefined_ReturnBuffer
  * @endcode
+ *
+ * mqttconfigSHARE_BUFFER_FXN adds a reference to a buffer so that a received publish
+ * can be handed to every matching subscription callback without copying it. It defaults
+ * to BUFFERPOOL_ShareBuffer when the central buffer pool is used and to NULL, which
+ * disables sharing, when the user supplies their own buffer management functions. A
+ * user supplied pool which counts references can define it as well:
+ * @code
+ * void UserDefined_ShareBuffer( uint8_t * const pucBuffer );
+ *
+ * #define mqttconfigSHARE_BUFFER_FXN          UserDefined_ShareBuffer
+ * @endcode
  */
 /** @{ */
+#ifndef mqttconfigSHARE_BUFFER_FXN
+    #if defined( mqttconfigGET_FREE_BUFFER_FXN ) || defined( mqttconfigRETURN_BUFFER_FXN )
+        #define mqttconfigSHARE_BUFFER_FXN    NULL
+    #else
+        #define mqttconfigSHARE_BUFFER_FXN    BUFFERPOOL_ShareBuffer
+    #endif
+#endif
+
 #ifndef mqttconfigGET_FREE_BUFFER_FXN
     #define mqttconfigGET_FREE_BUFFER_FXN    BUFFERPOOL_GetFreeBuffer
 #endif
@@ -39,6 +39,12 @@
 #define BITS_PER_BYTE           ( 1UL << LOG2_BITS_PER_BYTE )   /* Number of bits in a byte. This is used by the block bitmap implementation. */
 #define OTA_FILE_BLOCK_SIZE     ( 1UL << otaconfigLOG2_FILE_BLOCK_SIZE ) /* Data section size of the file data block message (excludes the header). */
 
+/* When configSUPPORT_STATIC_ALLOCATION is 1, the strings, signature and block bitmap of the
+ * file being received are allocated from a static arena of this many bytes instead of the heap. */
+#ifndef otaconfigSTATIC_ARENA_SIZE
+    #define otaconfigSTATIC_ARENA_SIZE    1024U
+#endif
+
 typedef enum
 {
     eIngest_Result_FileComplete = -1,      /* The file transfer is complete and the signature check passed. */
@@ -38,6 +38,20 @@ BaseType_t OTA_CBOR_Decode_GetStreamResponseMessage(
     uint8_t **ppucPayload,
     size_t *pxPayloadSize );
 
+/**
+ * @brief Decode a Get Stream response message from AWS IoT OTA into a caller
+ * supplied buffer. *pxPayloadSize is the size of the buffer on entry and the
+ * size of the payload on return.
+ */
+BaseType_t OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer(
+    const uint8_t *pucMessageBuffer,
+    size_t xMessageSize,
+    int32_t *plFileId,
+    int32_t *plBlockId,
+    int32_t *plBlockSize,
+    uint8_t *pucPayload,
+    size_t *pxPayloadSize );
+
 /**
  * @brief Create an encoded Get Stream Request message for the AWS IoT OTA
  * service.
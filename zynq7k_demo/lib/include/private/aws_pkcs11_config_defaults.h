@@ -0,0 +1,45 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_pkcs11_config_defaults.h
+ * @brief Default values for the PKCS#11 module configuration.
+ */
+
+#ifndef _AWS_PKCS11_CONFIG_DEFAULTS_H_
+#define _AWS_PKCS11_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Number of DRBGs the module generates random numbers with.
+ *
+ * Each task is mapped to one of the DRBGs, so that TLS sessions and
+ * signatures in different tasks rarely wait for each other's DRBG. All the
+ * DRBGs are seeded from the same entropy source.
+ */
+#ifndef pkcs11configDRBG_POOL_SIZE
+    #define pkcs11configDRBG_POOL_SIZE    ( 4 )
+#endif
+
+#endif /* _AWS_PKCS11_CONFIG_DEFAULTS_H_ */
@@ -0,0 +1,54 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_platform_fs.h
+ * @brief The SD card file system of the board, defined by the PKCS#11 PAL.
+ */
+
+#ifndef _AWS_PLATFORM_FS_H_
+#define _AWS_PLATFORM_FS_H_
+
+/**
+ * @brief Mount the file system and create the mutex of platform_fs_lock().
+ *
+ * @return 0 on success, -1 if the card could be neither mounted nor formatted.
+ */
+int platform_init_fs( void );
+
+/**
+ * @brief Take the mutex which serializes all FatFs calls.
+ *
+ * FatFs is built without re-entrancy, every task accessing the card must
+ * hold the mutex. Does nothing before platform_init_fs() is called.
+ */
+void platform_fs_lock( void );
+
+/**
+ * @brief Give the mutex taken by platform_fs_lock().
+ */
+void platform_fs_unlock( void );
+
+#endif /* _AWS_PLATFORM_FS_H_ */
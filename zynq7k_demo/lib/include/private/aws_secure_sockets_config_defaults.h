@@ -61,4 +61,58 @@
     #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 10000 )
 #endif
 
+/**
+ * @brief Number of endpoints for which a warm standby connection can be kept,
+ * see SOCKETS_StandbyAdd().
+ *
+ * Each standby holds a connected TCP socket and a negotiated TLS context.
+ * Set to 0 to leave the standby connections out.
+ */
+#ifndef socketsconfigSTANDBY_MAX_ENDPOINTS
+    #define socketsconfigSTANDBY_MAX_ENDPOINTS    ( 0 )
+#endif
+
+/**
+ * @brief Stack size and priority of the task which opens and checks the
+ * standby connections. The stack must hold a TLS handshake.
+ */
+#ifndef socketsconfigSTANDBY_TASK_STACK_SIZE
+    #define socketsconfigSTANDBY_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 8 )
+#endif
+
+#ifndef socketsconfigSTANDBY_TASK_PRIORITY
+    #define socketsconfigSTANDBY_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#endif
+
+/**
+ * @brief Interval in milliseconds between two health checks of a standby
+ * connection.
+ */
+#ifndef socketsconfigSTANDBY_CHECK_PERIOD_MS
+    #define socketsconfigSTANDBY_CHECK_PERIOD_MS    ( 1000 )
+#endif
+
+/**
+ * @brief Age in milliseconds at which a standby connection is replaced.
+ *
+ * Each replacement costs a TCP connection and a TLS handshake, so keep it in
+ * minutes. A standby closed earlier by the server is found by the health
+ * checks and replaced then.
+ */
+#ifndef socketsconfigSTANDBY_MAX_AGE_MS
+    #define socketsconfigSTANDBY_MAX_AGE_MS    ( 5UL * 60UL * 1000UL )
+#endif
+
+/**
+ * @brief Bounds in milliseconds of the backoff after a standby connection
+ * could not be opened. The backoff doubles on each failure.
+ */
+#ifndef socketsconfigSTANDBY_RETRY_MIN_MS
+    #define socketsconfigSTANDBY_RETRY_MIN_MS    ( 1000 )
+#endif
+
+#ifndef socketsconfigSTANDBY_RETRY_MAX_MS
+    #define socketsconfigSTANDBY_RETRY_MAX_MS    ( 60000 )
+#endif
+
 #endif /* AWS_INC_SECURE_SOCKETS_CONFIG_DEFAULTS_H_ */
@@ -39,6 +39,18 @@
     #define shadowconfigJSON_JSMN_TOKENS    ( 64 )
 #endif
 
+/**
+ * @brief Number of top-level keys of a JSON document indexed by hash when it
+ * is parsed.
+ *
+ * Shadow responses have few top-level keys ("state", "metadata", "version",
+ * "timestamp", "clientToken", or "code" and "message"). Documents with more
+ * keys are still searched, by scanning their tokens.
+ */
+#ifndef shadowconfigJSON_KEY_INDEX_SIZE
+    #define shadowconfigJSON_KEY_INDEX_SIZE    ( 8 )
+#endif
+
 /**
  * @brief Maximum number of Shadow Clients.
  *
@@ -100,4 +112,79 @@
     #define shadowconfigCLEANUP_TIME_MS    ( 5000UL )
 #endif
 
+/**
+ * @brief Number of operations that may be in progress at once on each Shadow
+ * Client.
+ *
+ * Update, get and delete requests are published without waiting for the
+ * response to the previous one, and responses are matched to requests by
+ * their "clientToken". Each pending operation takes an entry of a table in
+ * the Shadow Client. When the table is full, new operations wait for an entry
+ * within their timeout.
+ *
+ * @note Set to @c 1 to allow only one operation at a time.
+ */
+#ifndef shadowconfigMAX_PENDING_OPERATIONS
+    #define shadowconfigMAX_PENDING_OPERATIONS    ( 4 )
+#endif
+
+/**
+ * @brief Number of Things whose subscriptions each Shadow Client keeps track
+ * of.
+ *
+ * The first operation of each type on a Thing subscribes to its accepted and
+ * rejected topics. The subscription is recorded so that the operations
+ * pipelined behind it, and the later ones when ucKeepSubscriptions is set, do
+ * not subscribe again. Operations on further Things still work, but subscribe
+ * every time.
+ */
+#ifndef shadowconfigMAX_SUBSCRIBED_THINGS
+    #define shadowconfigMAX_SUBSCRIBED_THINGS    ( 2 )
+#endif
+
+/**
+ * @brief Maximum length of a "clientToken", in bytes.
+ *
+ * The client token of each pending operation is kept in the Shadow Client.
+ * The Shadow service rejects client tokens longer than 64 bytes.
+ */
+#ifndef shadowconfigMAX_CLIENT_TOKEN_LENGTH
+    #define shadowconfigMAX_CLIENT_TOKEN_LENGTH    ( 64 )
+#endif
+
+/**
+ * @brief Maximum number of keys of a Shadow state.
+ *
+ * See aws_shadow_state.h. Each key of a Shadow state caches its desired and
+ * reported value.
+ *
+ * @note Should be at most 32.
+ */
+#ifndef shadowconfigSTATE_MAX_FIELDS
+    #define shadowconfigSTATE_MAX_FIELDS    ( 8 )
+#endif
+
+/**
+ * @brief Size of the desired and reported value buffers of each key of a
+ * Shadow state, in bytes.
+ *
+ * Values are kept as JSON text, so string values include their quotes. Values
+ * that do not fit are not cached.
+ *
+ * @note Should be less than 256.
+ */
+#ifndef shadowconfigSTATE_MAX_VALUE_LENGTH
+    #define shadowconfigSTATE_MAX_VALUE_LENGTH    ( 32 )
+#endif
+
+/**
+ * @brief Size of the reported update document built by a Shadow state, in
+ * bytes.
+ *
+ * Changes that do not fit in one update are published in the next one.
+ */
+#ifndef shadowconfigSTATE_DOCUMENT_LENGTH
+    #define shadowconfigSTATE_DOCUMENT_LENGTH    ( 256 )
+#endif
+
 #endif /* _AWS_SHADOW_CONFIG_DEFAULTS_H_ */
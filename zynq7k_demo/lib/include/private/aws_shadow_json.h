@@ -23,10 +23,14 @@
  * http://www.FreeRTOS.org
  */
 
-
 /**
  * @file aws_shadow_json.h
  * @brief Shadow JSON utility functions.
+ *
+ * A document is tokenized once by SHADOW_JSONParse() into a token arena owned
+ * by the caller, and all other functions read the resulting handle. The keys
+ * of the top-level object are indexed by hash while parsing, so looking up
+ * "clientToken", "code" or "state" does not scan the tokens.
  */
 
 #ifndef _AWS_SHADOW_JSON_H_
@@ -34,35 +38,104 @@
 
 #include "FreeRTOS.h"
 
+/* Shadow configuration includes. */
+#include "aws_shadow_config.h"
+#include "aws_shadow_config_defaults.h"
+
+/* Other includes. */
+#include "jsmn.h"
+
+/**
+ * @brief A parsed JSON document.
+ *
+ * The handle points into the document and into the token arena given to
+ * SHADOW_JSONParse(); both must remain valid while the handle is used.
+ */
+typedef struct ShadowJSONDoc
+{
+    const char * pcDoc;                                      /**< The document. */
+    const jsmntok_t * pxTokens;                              /**< The token arena. */
+    int16_t sTokenCount;                                     /**< Tokens parsed, or a jsmn error. */
+    uint16_t usKeyCount;                                     /**< Top-level keys in the key index. */
+    BaseType_t xKeyIndexFull;                                /**< pdTRUE if some top-level keys did not fit in the key index. */
+    uint16_t usKeyHashes[ shadowconfigJSON_KEY_INDEX_SIZE ]; /**< Hash of each indexed key. */
+    int16_t sKeyTokens[ shadowconfigJSON_KEY_INDEX_SIZE ];   /**< Token of each indexed key. */
+} ShadowJSONDoc_t;
+
+/**
+ * @brief Tokenize a JSON document and index the keys of its top-level object.
+ *
+ * @param[out] pxDoc The parsed document.
+ * @param[in] pxTokens The token arena. It is overwritten.
+ * @param[in] sMaxTokens The number of tokens of pxTokens.
+ * @param[in] pcDoc JSON string
+ * @param[in] ulDocLength the length of pcDoc
+ * @return the number of tokens parsed; jsmn error (see jsmn.h) if jsmn fails
+ *     to parse pcDoc. The result is also kept in pxDoc->sTokenCount.
+ */
+int16_t SHADOW_JSONParse( ShadowJSONDoc_t * const pxDoc,
+                          jsmntok_t * const pxTokens,
+                          int16_t sMaxTokens,
+                          const char * const pcDoc,
+                          uint32_t ulDocLength );
+
+/**
+ * @brief Find a key of an object of a parsed document.
+ *
+ * @param[in] pxDoc The parsed document.
+ * @param[in] sObjectIndex The token of the object; 0 for the top-level object.
+ * @param[in] pcKey The key.
+ * @return the token of the value of pcKey; -1 if the object has no such key
+ *     or sObjectIndex is not an object.
+ */
+int16_t SHADOW_JSONFindKey( const ShadowJSONDoc_t * const pxDoc,
+                            int16_t sObjectIndex,
+                            const char * const pcKey );
+
+/**
+ * @brief Skip a token of a parsed document and all of its children.
+ *
+ * @param[in] pxDoc The parsed document.
+ * @param[in] sIndex The token to skip.
+ * @return the token that follows sIndex and its children.
+ */
+int16_t SHADOW_JSONSkipToken( const ShadowJSONDoc_t * const pxDoc,
+                              int16_t sIndex );
+
+/**
+ * @brief Check if the client tokens of two parsed documents match.
+ *
+ * @param[in] pxDoc1, pxDoc2 The parsed documents.
+ * @return pdTRUE if the client tokens in pxDoc1 and pxDoc2 match; pdFALSE
+ *     if the client tokens don't match or either document has none.
+ */
+BaseType_t SHADOW_JSONDocClientTokenMatch( const ShadowJSONDoc_t * const pxDoc1,
+                                           const ShadowJSONDoc_t * const pxDoc2 );
+
 /**
- * @brief Check if the client tokens in pcDoc1 and pcDoc2 match.
+ * @brief Find the client token of a parsed document.
  *
- * @param[in] pcDoc1, pcDoc2 JSON strings
- * @param[in] ulDoc1Length, ulDoc2Length the lengths of pcDoc1 and pcDoc2,
- *     respectively
- * @return pdTRUE if the client tokens in pcDoc1 and pcDoc2 match; pdFALSE
- *     if the client tokens don't match; jsmn error (see jsmn.h) if jsmn
- *     fails to parse either string.
+ * @param[in] pxDoc The parsed document.
+ * @param[out] ppcClientToken set to the location of the client token in the
+ *     document, without quotes.
+ * @return the length of the client token; 0 if the document has no client
+ *     token or jsmn failed to parse it.
  */
-BaseType_t SHADOW_JSONDocClientTokenMatch( const char * const pcDoc1,
-                                           uint32_t ulDoc1Length,
-                                           const char * const pcDoc2,
-                                           uint32_t ulDoc2Length );
+uint16_t SHADOW_JSONGetClientToken( const ShadowJSONDoc_t * const pxDoc,
+                                    const char ** ppcClientToken );
 
 /**
- * @brief Extracts the error code and message from a Shadow error JSON string.
+ * @brief Extracts the error code and message from a parsed Shadow error document.
  *
- * @param[in] pcErrorJSON a Shadow error JSON string
- * @param[in] ulErrorJSONLength the length of pcErrorJSON
- * @param[out] ppcErrorMessage set to the location of the error message in pcErrorJSON.
+ * @param[in] pxDoc The parsed error document.
+ * @param[out] ppcErrorMessage set to the location of the error message in the document.
  *     Pass NULL to ignore error message.
  * @param[out] pusErrorMessageLength set to the size of the error message
  *     Pass NULL to ignore error message.
  * @return a positive code corresponding to an error reason on success; jsmn error
- *     (see jsmn.h) if jsmn fails to parse pcErrorJSON; 0 for bad pointer arguments
+ *     (see jsmn.h) if jsmn failed to parse the document; 0 if it has no error code
  */
-int16_t SHADOW_JSONGetErrorCodeAndMessage( const char * const pcErrorJSON,
-                                           uint32_t ulErrorJSONLength,
+int16_t SHADOW_JSONGetErrorCodeAndMessage( const ShadowJSONDoc_t * const pxDoc,
                                            char ** ppcErrorMessage,
                                            uint16_t * pusErrorMessageLength );
 
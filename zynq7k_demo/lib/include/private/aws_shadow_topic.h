@@ -0,0 +1,174 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_shadow_topic.h
+ * @brief Building, classifying and indexing Shadow MQTT topics.
+ *
+ * Incoming topics are split into Thing Name and operation in one pass, and
+ * the Thing Name is hashed on the way. Things are looked up in an index of
+ * Thing Names with their lengths and hashes, so no topic string is rebuilt to
+ * classify a message.
+ */
+
+#ifndef _AWS_SHADOW_TOPIC_H_
+#define _AWS_SHADOW_TOPIC_H_
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Maximum length of a Thing Name. 128 is currently the longest Thing
+ * Name that AWS IoT accepts.
+ */
+#define shadowTOPIC_MAX_THING_NAME_LENGTH    ( 128 )
+
+/**
+ * @brief Size of a buffer that holds any Shadow MQTT topic, including the
+ * terminating zero. update/documents is the longest operation.
+ */
+#define shadowTOPIC_BUFFER_LENGTH \
+    ( shadowTOPIC_MAX_THING_NAME_LENGTH + ( int16_t ) sizeof( "$aws/things//shadow/update/documents" ) )
+
+/**
+ * @brief Shadow operation that can be parsed from MQTT topics.
+ *
+ */
+typedef enum ShadowOperationName
+{
+    eShadowOperationUpdate,
+    eShadowOperationGet,
+    eShadowOperationDelete,
+    eShadowOperationUpdateDocuments,
+    eShadowOperationUpdateDelta,
+    eShadowOperationDeletedByAnother,
+    eShadowOperationOther
+} ShadowOperationName_t;
+
+/**
+ * @brief Whether a topic is the accepted or rejected response of an operation.
+ */
+typedef enum ShadowTopicStatus
+{
+    eShadowTopicNoStatus,
+    eShadowTopicAccepted,
+    eShadowTopicRejected
+} ShadowTopicStatus_t;
+
+/**
+ * @brief A classified Shadow MQTT topic.
+ */
+typedef struct ShadowTopic
+{
+    const char * pcThingName;             /**< Thing Name in the topic, not terminated. */
+    uint16_t usThingNameLength;           /**< Length of pcThingName. */
+    uint32_t ulThingNameHash;             /**< SHADOW_TopicHash() of the Thing Name. */
+    ShadowOperationName_t xOperationName; /**< update, get, delete, update/documents or update/delta. */
+    ShadowTopicStatus_t xStatus;          /**< accepted or rejected suffix, if any. */
+} ShadowTopic_t;
+
+/**
+ * @brief A Thing of a topic index.
+ */
+typedef struct ShadowTopicIndexEntry
+{
+    const char * pcThingName; /**< NULL if the entry is free. Must remain valid while set. */
+    uint32_t ulThingNameHash;
+    uint16_t usThingNameLength;
+} ShadowTopicIndexEntry_t;
+
+/**
+ * @brief Hash a Thing Name, with FNV-1a.
+ *
+ * Also hashes the keys of the key index of aws_shadow_json.c.
+ *
+ * @param[in] pcThingName The Thing Name, need not be terminated.
+ * @param[in] usThingNameLength The length of pcThingName.
+ *
+ * @return The hash, as computed by SHADOW_TopicParse().
+ */
+uint32_t SHADOW_TopicHash( const char * const pcThingName,
+                           uint16_t usThingNameLength );
+
+/**
+ * @brief Classify a Shadow MQTT topic.
+ *
+ * @param[in] pucTopic The topic, need not be terminated.
+ * @param[in] usTopicLength The length of pucTopic.
+ * @param[out] pxTopic The Thing Name, its hash and the operation of the topic.
+ *
+ * @return pdTRUE if the topic is one of the Shadow topics that can be built
+ * by SHADOW_TopicBuild(); pdFALSE otherwise.
+ */
+BaseType_t SHADOW_TopicParse( const uint8_t * const pucTopic,
+                              uint16_t usTopicLength,
+                              ShadowTopic_t * const pxTopic );
+
+/**
+ * @brief Build a Shadow MQTT topic.
+ *
+ * @param[out] pcBuffer The topic, zero terminated.
+ * @param[in] usBufferLength The size of pcBuffer.
+ * @param[in] pcThingName The Thing Name.
+ * @param[in] usThingNameLength The length of pcThingName.
+ * @param[in] xOperationName update, get, delete, update/documents or update/delta.
+ * @param[in] xStatus Whether to build the accepted or rejected topic of the
+ * operation. Must be #eShadowTopicNoStatus for update/documents and update/delta.
+ *
+ * @return The length of the topic; 0 if it does not fit in pcBuffer.
+ */
+uint16_t SHADOW_TopicBuild( char * const pcBuffer,
+                            uint16_t usBufferLength,
+                            const char * const pcThingName,
+                            uint16_t usThingNameLength,
+                            ShadowOperationName_t xOperationName,
+                            ShadowTopicStatus_t xStatus );
+
+/**
+ * @brief Set or clear an entry of a topic index.
+ *
+ * @param[out] pxEntry The entry.
+ * @param[in] pcThingName The Thing Name, zero terminated; NULL to free the entry.
+ */
+void SHADOW_TopicIndexSet( ShadowTopicIndexEntry_t * const pxEntry,
+                           const char * const pcThingName );
+
+/**
+ * @brief Find a Thing in a topic index.
+ *
+ * @param[in] pxEntries The entries of the index.
+ * @param[in] xEntryCount The number of entries.
+ * @param[in] pcThingName The Thing Name, need not be terminated.
+ * @param[in] usThingNameLength The length of pcThingName.
+ * @param[in] ulThingNameHash SHADOW_TopicHash() of the Thing Name.
+ *
+ * @return The index of the entry of the Thing; -1 if it is not in the index.
+ */
+BaseType_t SHADOW_TopicIndexFind( const ShadowTopicIndexEntry_t * const pxEntries,
+                                  BaseType_t xEntryCount,
+                                  const char * const pcThingName,
+                                  uint16_t usThingNameLength,
+                                  uint32_t ulThingNameHash );
+
+#endif /* _AWS_SHADOW_TOPIC_H_ */
@@ -0,0 +1,48 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_static_memory.h
+ * @brief Placement of the libraries' statically allocated memory.
+ *
+ * Buffers declared with staticmemSECTION( library ) are placed in the section
+ * .bss.afr_static.library. They remain ordinary zero initialized data, but a
+ * linker script can collect the sections of each library together and define
+ * start and end symbols for them, so that the memory used by every library is
+ * visible in the map file and can be reported at boot.
+ *
+ * Only zero initialized variables may be tagged.
+ */
+
+#ifndef _AWS_STATIC_MEMORY_H_
+#define _AWS_STATIC_MEMORY_H_
+
+#if defined( __GNUC__ ) && defined( __ELF__ )
+    #define staticmemSECTION( library )    __attribute__( ( section( ".bss.afr_static." #library ) ) )
+#else
+    #define staticmemSECTION( library )
+#endif
+
+#endif /* _AWS_STATIC_MEMORY_H_ */
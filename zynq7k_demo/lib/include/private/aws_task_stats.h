@@ -0,0 +1,99 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_task_stats.h
+ * @brief Run time used by each task, shared by Device Defender and telemetry.
+ *
+ * One sampler keeps the run time counters of the previous sample, so every
+ * sample measures the interval since the previous one, whichever library
+ * took it. Loads are shares of the interval, so they do not depend on how
+ * long it was.
+ *
+ * configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS must be 1.
+ */
+
+#ifndef _AWS_TASK_STATS_H_
+#define _AWS_TASK_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+/**
+ * @brief Maximum number of tasks the sampler keeps the counters of. Nothing
+ * is measured while more tasks exist.
+ */
+#ifndef taskstatsMAX_TASKS
+    #define taskstatsMAX_TASKS    ( 32 )
+#endif
+
+/**
+ * @brief Length of the task name stored in TaskStatsTask_t, including the
+ * terminating zero.
+ */
+#define taskstatsTASK_NAME_LENGTH    ( 16 )
+
+/**
+ * @brief Use of one task during the interval.
+ */
+typedef struct TaskStatsTask
+{
+    char cTaskName[ taskstatsTASK_NAME_LENGTH ]; /**< Zero terminated, may be truncated. */
+    uint32_t ulTaskNumber;                       /**< Unique number assigned to the task by the kernel. */
+    uint32_t ulRunTime;                          /**< Run time counter ticks used in the interval. */
+    uint32_t ulStackHeadroom;                    /**< Minimum free stack since the task started, in words. */
+} TaskStatsTask_t;
+
+/**
+ * @brief The interval measured by a sample.
+ */
+typedef struct TaskStatsInterval
+{
+    uint32_t ulRunTime;        /**< Run time counter ticks in the interval, 0 for the first sample. */
+    uint32_t ulBusyRunTime;    /**< Ticks of the interval not spent in the idle task. */
+    uint32_t ulIdleTaskNumber; /**< Task number of the idle task. */
+    size_t xTaskCount;         /**< Number of tasks measured. */
+} TaskStatsInterval_t;
+
+/**
+ * @brief Measure the run time used by each task since the previous sample.
+ *
+ * The first sample has no previous one, so its interval and the run time of
+ * every task are 0.
+ *
+ * @param[out] pxTasks Array receiving the use of each task.
+ * @param[in] xMaxTasks Number of entries in pxTasks.
+ * @param[out] pxInterval Receives the interval.
+ *
+ * @return pdPASS if the sample was taken, pdFAIL if there are more than
+ * taskstatsMAX_TASKS or xMaxTasks tasks. Nothing is written on failure.
+ */
+BaseType_t TASKSTATS_Sample( TaskStatsTask_t * pxTasks,
+                             size_t xMaxTasks,
+                             TaskStatsInterval_t * pxInterval );
+
+#endif /* _AWS_TASK_STATS_H_ */
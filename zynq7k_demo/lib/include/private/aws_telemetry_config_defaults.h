@@ -0,0 +1,112 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_telemetry_config_defaults.h
+ * @brief Default values for the telemetry configuration.
+ */
+
+#ifndef _AWS_TELEMETRY_CONFIG_DEFAULTS_H_
+#define _AWS_TELEMETRY_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Maximum number of tasks measured. Nothing is measured while more
+ * tasks exist.
+ */
+#ifndef telemetryconfigMAX_TASKS
+    #define telemetryconfigMAX_TASKS    ( 32 )
+#endif
+
+/**
+ * @brief Number of samples kept in the history ring.
+ *
+ * Each sample takes 32 bytes.
+ */
+#ifndef telemetryconfigHISTORY_LENGTH
+    #define telemetryconfigHISTORY_LENGTH    ( 60 )
+#endif
+
+/**
+ * @brief Time between two samples.
+ *
+ * Must be shorter than the time the run time stats counter takes to wrap.
+ */
+#ifndef telemetryconfigSAMPLE_PERIOD_MS
+    #define telemetryconfigSAMPLE_PERIOD_MS    ( 1000 )
+#endif
+
+/**
+ * @brief Time between two published snapshots.
+ */
+#ifndef telemetryconfigPUBLISH_PERIOD_MS
+    #define telemetryconfigPUBLISH_PERIOD_MS    ( 60000 )
+#endif
+
+/**
+ * @brief Appended to the thing name to make the topic the snapshots are
+ * published to.
+ */
+#ifndef telemetryconfigTOPIC_SUFFIX
+    #define telemetryconfigTOPIC_SUFFIX    "/telemetry"
+#endif
+
+/**
+ * @brief Size of the buffer holding the topic, including the terminating
+ * zero. Nothing is published if the topic does not fit.
+ */
+#ifndef telemetryconfigTOPIC_BUFFER_SIZE
+    #define telemetryconfigTOPIC_BUFFER_SIZE    ( 128 )
+#endif
+
+/**
+ * @brief Time to wait for a snapshot to be published.
+ */
+#ifndef telemetryconfigPUBLISH_TIMEOUT_MS
+    #define telemetryconfigPUBLISH_TIMEOUT_MS    ( 5000 )
+#endif
+
+/**
+ * @brief Size of the buffer the snapshot is encoded into. A snapshot takes
+ * about 30 bytes per task.
+ */
+#ifndef telemetryconfigSNAPSHOT_BUFFER_SIZE
+    #define telemetryconfigSNAPSHOT_BUFFER_SIZE    ( 1024 )
+#endif
+
+/**
+ * @brief Stack size of the telemetry task.
+ */
+#ifndef telemetryconfigTASK_STACK_SIZE
+    #define telemetryconfigTASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 2 )
+#endif
+
+/**
+ * @brief Priority of the telemetry task.
+ */
+#ifndef telemetryconfigTASK_PRIORITY
+    #define telemetryconfigTASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#endif /* _AWS_TELEMETRY_CONFIG_DEFAULTS_H_ */
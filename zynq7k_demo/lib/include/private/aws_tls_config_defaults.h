@@ -0,0 +1,74 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_tls_config_defaults.h
+ * @brief Default values for the TLS layer configuration.
+ */
+
+#ifndef _AWS_TLS_CONFIG_DEFAULTS_H_
+#define _AWS_TLS_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Size of the per-connection buffer in which small writes are
+ * coalesced into one TLS record.
+ *
+ * Writes shorter than this are copied into the buffer, longer writes are
+ * encrypted directly. Coalescing only happens on connections which ask for
+ * it with TLSParams_t::xCoalesceWrites. Set to 0 to remove the buffer from
+ * the TLS context.
+ */
+#ifndef tlsconfigCOALESCE_BUFFER_SIZE
+    #define tlsconfigCOALESCE_BUFFER_SIZE    ( 0 )
+#endif
+
+/**
+ * @brief Time in milliseconds after which coalesced data is sent by the
+ * next TLS_Send() even though the buffer is not full.
+ *
+ * TLS_Recv() and TLS_Flush() always send coalesced data first.
+ */
+#ifndef tlsconfigCOALESCE_DEADLINE_MS
+    #define tlsconfigCOALESCE_DEADLINE_MS    ( 10 )
+#endif
+
+/**
+ * @brief Maximum fragment length requested from the server, in bytes.
+ *
+ * One of 512, 1024, 2048 or 4096, and no more than the smaller of
+ * MBEDTLS_SSL_IN_CONTENT_LEN and MBEDTLS_SSL_OUT_CONTENT_LEN. Set to 0 to
+ * leave the max_fragment_length extension out of the ClientHello. A server
+ * may ignore the request, so MBEDTLS_SSL_IN_CONTENT_LEN must still be able
+ * to hold the records it would send otherwise.
+ *
+ * Some servers abort the handshake when the extension is present. The value
+ * applies to every TLS connection, so only set it when all the endpoints the
+ * device connects to are known to accept it.
+ */
+#ifndef tlsconfigMAX_FRAGMENT_LENGTH
+    #define tlsconfigMAX_FRAGMENT_LENGTH    ( 0 )
+#endif
+
+#endif /* _AWS_TLS_CONFIG_DEFAULTS_H_ */
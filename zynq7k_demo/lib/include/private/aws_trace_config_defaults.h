@@ -0,0 +1,107 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace_config_defaults.h
+ * @brief Default values for the event tracing configuration.
+ */
+
+#ifndef _AWS_TRACE_CONFIG_DEFAULTS_H_
+#define _AWS_TRACE_CONFIG_DEFAULTS_H_
+
+/**
+ * @brief Number of events the ring holds. Must be a power of two.
+ *
+ * Each event takes 16 bytes.
+ */
+#ifndef traceconfigEVENT_COUNT
+    #define traceconfigEVENT_COUNT    ( 1024 )
+#endif
+
+/**
+ * @brief Core recording the events, copied into every event so that the
+ * streams of several cores can be merged.
+ */
+#ifndef traceconfigCPU_ID
+    #define traceconfigCPU_ID    ( 0 )
+#endif
+
+/**
+ * @brief Current time in microseconds, may wrap.
+ *
+ * Called for every event, including from the context switch. The default
+ * only has tick resolution; ports with a free-running timer should override
+ * it.
+ */
+#ifndef traceconfigGET_TIMESTAMP
+    #define traceconfigGET_TIMESTAMP()    ( ( uint32_t ) xTaskGetTickCountFromISR() * ( 1000000UL / configTICK_RATE_HZ ) )
+#endif
+
+/**
+ * @brief Time between two drains of the ring by the socket drain task.
+ *
+ * The drain task sleeps between drains even if events are waiting, since
+ * sending them records new events.
+ */
+#ifndef traceconfigDRAIN_PERIOD_MS
+    #define traceconfigDRAIN_PERIOD_MS    ( 100 )
+#endif
+
+/**
+ * @brief Time to wait before connecting again to the trace collector.
+ */
+#ifndef traceconfigDRAIN_RETRY_MS
+    #define traceconfigDRAIN_RETRY_MS    ( 5000 )
+#endif
+
+/**
+ * @brief Number of events sent per socket write.
+ */
+#ifndef traceconfigDRAIN_BATCH_EVENTS
+    #define traceconfigDRAIN_BATCH_EVENTS    ( 64 )
+#endif
+
+/**
+ * @brief Number of tasks whose names are sent at the start of a stream.
+ */
+#ifndef traceconfigDRAIN_MAX_TASKS
+    #define traceconfigDRAIN_MAX_TASKS    ( 24 )
+#endif
+
+/**
+ * @brief Stack size of the socket drain task.
+ */
+#ifndef traceconfigDRAIN_TASK_STACK_SIZE
+    #define traceconfigDRAIN_TASK_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#endif
+
+/**
+ * @brief Priority of the socket drain task.
+ */
+#ifndef traceconfigDRAIN_TASK_PRIORITY
+    #define traceconfigDRAIN_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1 )
+#endif
+
+#endif /* _AWS_TRACE_CONFIG_DEFAULTS_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file gcm_alt.h
+ * @brief GCM context of the table driven implementation in aws_gcm_alt.c,
+ * used when MBEDTLS_GCM_ALT is defined.
+ */
+
+#ifndef __GCM_ALT_H__
+#define __GCM_ALT_H__
+
+#include <stdint.h>
+
+#include "mbedtls/cipher.h"
+
+/**
+ * @brief The GCM context structure.
+ *
+ * HTable holds all 256 multiples of H by an 8-bit field element, so that
+ * GHASH takes one table lookup per byte instead of two per byte with the
+ * 16 entry tables of the mbedTLS implementation, at the cost of 4 KB per
+ * context.
+ */
+typedef struct mbedtls_gcm_context
+{
+    mbedtls_cipher_context_t cipher_ctx; /**< The block cipher, in ECB mode. */
+    uint32_t HTable[ 256 ][ 4 ];         /**< i times H, as big-endian words. */
+    uint64_t len;                        /**< Bytes of data processed. */
+    uint64_t add_len;                    /**< Bytes of additional data. */
+    unsigned char base_ectr[ 16 ];       /**< Encrypted first counter block, for the tag. */
+    unsigned char y[ 16 ];               /**< Counter block. */
+    uint32_t buf[ 4 ];                   /**< GHASH accumulator, as big-endian words. */
+    int mode;                            /**< MBEDTLS_GCM_ENCRYPT or MBEDTLS_GCM_DECRYPT. */
+} mbedtls_gcm_context;
+
+#endif /* ifndef __GCM_ALT_H__ */
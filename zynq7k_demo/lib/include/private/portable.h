@@ -122,6 +122,42 @@ typedef struct HeapRegion
  */
 void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions ) PRIVILEGED_FUNCTION;
 
+/* Used to pass information about the heap out of vPortGetHeapStats(). */
+typedef struct xHeapStats
+{
+	size_t xAvailableHeapSpaceInBytes;		/* The total heap size currently available - this is the sum of all the free blocks, not the largest block that can be allocated. */
+	size_t xSizeOfLargestFreeBlockInBytes; 	/* The maximum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xSizeOfSmallestFreeBlockInBytes; /* The minimum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xNumberOfFreeBlocks;				/* The number of free memory blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xMinimumEverFreeBytesRemaining;	/* The minimum amount of total free memory (sum of all free blocks) there has been in the heap since the system booted. */
+	size_t xNumberOfSuccessfulAllocations;	/* The number of calls to pvPortMalloc() that have returned a valid memory block. */
+	size_t xNumberOfSuccessfulFrees;		/* The number of calls to vPortFree() that has successfully freed a block of memory. */
+} HeapStats_t;
+
+/* Used to pass per call site allocation counts out of
+uxPortGetHeapCallSiteStats(), which is provided by heap_tlsf.c when
+configHEAP_TRACK_CALL_SITES is 1. */
+typedef struct xHeapCallSiteStats
+{
+	void *pvCallSite;						/* The return address of the call to pvPortMalloc(), or NULL for call sites that did not fit in the table. */
+	size_t xCurrentBytes;					/* The heap space, in bytes, currently held by blocks allocated from the call site. */
+	size_t xPeakBytes;						/* The maximum value xCurrentBytes has had. */
+	size_t xNumberOfAllocations;			/* The number of successful allocations made from the call site. */
+	size_t xNumberOfFrees;					/* The number of blocks allocated from the call site that have been freed. */
+} HeapCallSiteStats_t;
+
+/*
+ * Returns a HeapStats_t structure filled with information about the current
+ * heap state.  Provided by heap_4.c and heap_tlsf.c.
+ */
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copies up to uxMaxEntries call site records into pxCallSiteStats and returns
+ * the number copied.
+ */
+UBaseType_t uxPortGetHeapCallSiteStats( HeapCallSiteStats_t *pxCallSiteStats, UBaseType_t uxMaxEntries ) PRIVILEGED_FUNCTION;
+
 
 /*
  * Map to the memory management routines required for the port.
@@ -36,6 +36,10 @@
 
 /* Buffer Pool includes. */
 #include "aws_bufferpool.h"
+#include "aws_static_memory.h"
+
+/* Event tracing includes. */
+#include "aws_trace.h"
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
@@ -250,7 +254,7 @@ static const uint16_t usUserNameLength = ( uint16_t ) ( sizeof( cUserName ) - 1U
  * to an MQTT broker. The maximum number of simultaneous connections is set by
  * mqttconfigMAX_BROKERS.
  */
-static MQTTBrokerConnection_t xMQTTConnections[ mqttconfigMAX_BROKERS ];
+static MQTTBrokerConnection_t xMQTTConnections[ mqttconfigMAX_BROKERS ] staticmemSECTION( mqtt );
 
 /**
  * @brief Handle of the command queue used to pass commands from application
@@ -382,6 +386,19 @@ static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnectio
  */
 static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData );
 
+#if ( mqttconfigKEEP_STANDBY_CONNECTION == 1 )
+
+/**
+ * @brief Registers the broker of a successful secured connect with
+ * SOCKETS_StandbyAdd().
+ *
+ * @param[in] pxConnectParams The parameters of the connect.
+ * @param[in] usNetworkPort The port connected to, in network byte order.
+ */
+    static void prvKeepStandbyConnection( const MQTTAgentConnectParams_t * const pxConnectParams,
+                                          uint16_t usNetworkPort );
+#endif
+
 /**
  * @brief Gracefully terminates the connection.
  *
@@ -850,6 +867,39 @@ static MQTTNotificationData_t * prvRetrieveNotificationData( MQTTBrokerConnectio
 }
 /*-----------------------------------------------------------*/
 
+#if ( mqttconfigKEEP_STANDBY_CONNECTION == 1 )
+
+    static void prvKeepStandbyConnection( const MQTTAgentConnectParams_t * const pxConnectParams,
+                                          uint16_t usNetworkPort )
+    {
+        SocketsStandbyEndpoint_t xEndpoint = { 0 };
+        const char * ppcAlpns[] = { socketsAWS_IOT_ALPN_MQTT };
+
+        /* The same options as prvSetupConnection() sets on the socket. */
+        xEndpoint.pcHostName = pxConnectParams->pcURL;
+        xEndpoint.usPort = SOCKETS_ntohs( usNetworkPort );
+        xEndpoint.xServerNameIndication = ( ( ( pxConnectParams->xFlags & mqttagentURL_IS_IP_ADDRESS ) == 0 ) &&
+                                            ( pxConnectParams->xURLIsIPAddress == pdFALSE ) ) ? pdTRUE : pdFALSE;
+        xEndpoint.pcServerCertificate = pxConnectParams->pcCertificate;
+        xEndpoint.ulServerCertificateLength = ( pxConnectParams->pcCertificate != NULL ) ? pxConnectParams->ulCertificateSize : 0U;
+
+        if( ( pxConnectParams->xFlags & mqttagentUSE_AWS_IOT_ALPN_443 ) != 0 )
+        {
+            xEndpoint.ppcAlpnProtocols = ppcAlpns;
+            xEndpoint.ulAlpnProtocolsCount = sizeof( ppcAlpns ) / sizeof( ppcAlpns[ 0 ] );
+        }
+
+        xEndpoint.xCoalesceWrites = ( mqttconfigCOALESCE_TLS_WRITES == 1 ) ? pdTRUE : pdFALSE;
+
+        if( SOCKETS_StandbyAdd( &xEndpoint ) < 0 )
+        {
+            mqttconfigDEBUG_LOG( ( "No standby connection kept for %s.\r\n", pxConnectParams->pcURL ) );
+        }
+    }
+
+#endif /* if ( mqttconfigKEEP_STANDBY_CONNECTION == 1 ) */
+/*-----------------------------------------------------------*/
+
 static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData )
 {
     SocketsSockaddr_t xMQTTServerAddress = { 0 };
@@ -949,6 +999,22 @@ static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData
                         xStatus = pdFAIL;
                     }
                 }
+
+                #if ( mqttconfigCOALESCE_TLS_WRITES == 1 )
+                    /* Coalesce the packets sent in one pass of the MQTT task,
+                     * they are flushed in prvManageConnections. */
+                    if( xStatus == pdPASS )
+                    {
+                        if( SOCKETS_SetSockOpt( pxConnection->xSocket,
+                                                0, /* Level - Unused. */
+                                                SOCKETS_SO_TLS_COALESCE,
+                                                NULL,
+                                                0 ) != SOCKETS_ERROR_NONE )
+                        {
+                            xStatus = pdFAIL;
+                        }
+                    }
+                #endif
             }
 
             /* Establish the connection. */
@@ -968,6 +1034,13 @@ static BaseType_t prvSetupConnection( const MQTTEventData_t * const pxEventData
                                              SOCKETS_SO_NONBLOCK,
                                              NULL /* Unused. */,
                                              0 /* Unused. */ );
+
+                #if ( mqttconfigKEEP_STANDBY_CONNECTION == 1 )
+                    if( ( pxConnection->uxFlags & mqttCONNECTION_SECURED ) == mqttCONNECTION_SECURED )
+                    {
+                        prvKeepStandbyConnection( pxEventData->u.pxConnectParams, xMQTTServerAddress.usPort );
+                    }
+                #endif
             }
             else
             {
@@ -1249,6 +1322,7 @@ static void prvNotifyRequestingTask( MQTTNotificationData_t * const pxNotificati
         /* Encode the notification code and status in the notification value. */
         pxNotificationData->ulMessageIdentifier |= ( UBaseType_t ) xNotificationCode;
         pxNotificationData->ulMessageIdentifier |= uxStatus;
+        TRACE_EVENT( eTraceMqttCommandNotified, pxNotificationData->ulMessageIdentifier );
 
         /* Notify the task. */
         ( void ) xTaskNotify( pxNotificationData->xTaskToNotify, pxNotificationData->ulMessageIdentifier, eSetValueWithoutOverwrite );
@@ -1266,6 +1340,10 @@ static TickType_t prvManageConnections( void )
     BaseType_t xAnyConnectedClient = pdFALSE;
     int32_t lBytesReceived;
     TickType_t xNextMQTTPeriodicInvokeTicks, xNextTimeoutTicks = portMAX_DELAY;
+
+    #if ( mqttconfigCOALESCE_TLS_WRITES == 1 )
+        int32_t lFlushStatus;
+    #endif
     uint64_t xTickCount = 0;
 
     /* For each broker the MQTT task might be connected to. */
@@ -1334,6 +1412,36 @@ static TickType_t prvManageConnections( void )
 
         /* Update the next timeout value. */
         xNextTimeoutTicks = configMIN( xNextTimeoutTicks, xNextMQTTPeriodicInvokeTicks );
+
+        #if ( mqttconfigCOALESCE_TLS_WRITES == 1 )
+            {
+                /* Send what the commands, the received packets and
+                 * MQTT_Periodic queued on this connection before the MQTT
+                 * task blocks. MQTT_Periodic may have closed the socket. */
+                if( pxConnection->xSocket != SOCKETS_INVALID_SOCKET )
+                {
+                    lFlushStatus = SOCKETS_SetSockOpt( pxConnection->xSocket,
+                                                       0, /* Level - Unused. */
+                                                       SOCKETS_SO_TLS_FLUSH,
+                                                       NULL,
+                                                       0 );
+
+                    if( lFlushStatus == SOCKETS_EWOULDBLOCK )
+                    {
+                        /* The socket is full, try again on the next tick. */
+                        xNextTimeoutTicks = configMIN( xNextTimeoutTicks, ( TickType_t ) 1 );
+                    }
+                    else if( lFlushStatus != SOCKETS_ERROR_NONE )
+                    {
+                        ( void ) MQTT_Disconnect( &( pxConnection->xMQTTContext ) );
+                    }
+                    else
+                    {
+                        /* Everything was sent. */
+                    }
+                }
+            }
+        #endif /* if ( mqttconfigCOALESCE_TLS_WRITES == 1 ) */
     }
 
     /* The MQTT task must not block for more than mqttconfigMQTT_TASK_MAX_BLOCK_TICKS
@@ -1590,6 +1698,7 @@ static void prvInitiateMQTTPublish( MQTTEventData_t * const pxEventData )
 
         if( MQTT_Publish( &( pxConnection->xMQTTContext ), &( xPublishParams ) ) == eMQTTSuccess )
         {
+            TRACE_EVENT( eTraceMqttPacketSent, pxEventData->xNotificationData.ulMessageIdentifier );
             xStatus = pdPASS;
         }
         else
@@ -1672,6 +1781,7 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
          * are sent on a queue, and a signal is sent back using a task
          * notification. */
         mqttconfigDEBUG_LOG( ( "Sending command to MQTT task.\r\n" ) );
+        TRACE_EVENT( eTraceMqttCommandQueued, pxEventData->xNotificationData.ulMessageIdentifier | ( uint32_t ) pxEventData->xEventType );
         xReturn = xQueueSendToBack( xCommandQueue, pxEventData, pxEventData->xTicksToWait );
 
         if( xReturn != pdFALSE )
@@ -1693,6 +1803,8 @@ static MQTTAgentReturnCode_t prvSendCommandToMQTTTask( MQTTEventData_t * pxEvent
 
                 if( pxEventData->xNotificationData.ulMessageIdentifier == ( ulReceivedMessageIdentifier & mqttMESSAGE_IDENTIFIER_MASK ) )
                 {
+                    TRACE_EVENT( eTraceMqttCommandComplete, ulReceivedMessageIdentifier );
+
                     /* A reply to the message was received.  The low 16-bits
                      * contain a status code, of which the least significant it
                      * is 1 (pdPASS) if the status code indicates a pass, and
@@ -1754,6 +1866,7 @@ static void prvMQTTTask( void * pvParameters )
         if( xQueueReceive( xCommandQueue, &xMQTTCommand, xNextTimeoutTicks ) != pdFALSE )
         {
             mqttconfigDEBUG_LOG( ( "Received message %x from queue.\r\n", xMQTTCommand.xNotificationData.ulMessageIdentifier ) );
+            TRACE_EVENT( eTraceMqttCommandDequeued, xMQTTCommand.xNotificationData.ulMessageIdentifier | ( uint32_t ) xMQTTCommand.xEventType );
 
             /* The connection index identifies the broker to communicate with -
              * starting from an index of 0.  Check the index is valid here so
@@ -1823,17 +1936,17 @@ BaseType_t MQTT_AGENT_Init( void )
      * long as the MQTT application is running. */
 
     /* The variable used to hold the queue's data structure. */
-    static StaticQueue_t xStaticQueue;
+    static StaticQueue_t xStaticQueue staticmemSECTION( mqtt );
 
     /* The array to use as the queue's storage area.  This must be at least
      * uxQueueLength * uxItemSize bytes.  Again, must be static. */
-    static uint8_t ucQueueStorageArea[ mqttCOMMAND_QUEUE_LENGTH * sizeof( MQTTEventData_t ) ];
+    static uint8_t ucQueueStorageArea[ mqttCOMMAND_QUEUE_LENGTH * sizeof( MQTTEventData_t ) ] staticmemSECTION( mqtt );
 
     /* The stack used by the MQTT task. */
-    static StackType_t xStack[ mqttconfigMQTT_TASK_STACK_DEPTH ];
+    static StackType_t xStack[ mqttconfigMQTT_TASK_STACK_DEPTH ] staticmemSECTION( mqtt );
 
     /* The variable used to hold the MQTT task's data structures. */
-    static StaticTask_t xStaticTask;
+    static StaticTask_t xStaticTask staticmemSECTION( mqtt );
 
     BaseType_t xReturnCode = pdPASS;
     UBaseType_t x, y;
@@ -1865,6 +1978,7 @@ BaseType_t MQTT_AGENT_Init( void )
             xInitParams.pxGetTicksFxn = prvMQTTGetTicks;
             xInitParams.xBufferPoolInterface.pxGetBufferFxn = mqttconfigGET_FREE_BUFFER_FXN;
             xInitParams.xBufferPoolInterface.pxReturnBufferFxn = mqttconfigRETURN_BUFFER_FXN;
+            xInitParams.xBufferPoolInterface.pxShareBufferFxn = mqttconfigSHARE_BUFFER_FXN;
 
             if( MQTT_Init( &xMQTTConnections[ x ].xMQTTContext, &xInitParams ) != eMQTTSuccess )
             {
@@ -2063,3 +2177,23 @@ MQTTAgentReturnCode_t MQTT_AGENT_ReturnBuffer( MQTTAgentHandle_t xMQTTHandle,
     return eMQTTAgentSuccess;
 }
 /*-----------------------------------------------------------*/
+
+MQTTAgentReturnCode_t MQTT_AGENT_ShareBuffer( MQTTAgentHandle_t xMQTTHandle,
+                                              MQTTBufferHandle_t xBufferHandle )
+{
+    MQTTAgentReturnCode_t xReturnCode = eMQTTAgentFailure;
+    const MQTTShareBuffer_t pxShareBufferFxn = mqttconfigSHARE_BUFFER_FXN;
+
+    /* Remove compiler warnings about unused parameters. */
+    ( void ) xMQTTHandle;
+
+    /* Only buffer pools which count references can share buffers. */
+    if( pxShareBufferFxn != NULL )
+    {
+        pxShareBufferFxn( mqttbufferGET_RAW_BUFFER_FROM_HANDLE( xBufferHandle ) );
+        xReturnCode = eMQTTAgentSuccess;
+    }
+
+    return xReturnCode;
+}
+/*-----------------------------------------------------------*/
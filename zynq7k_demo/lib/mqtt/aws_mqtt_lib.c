@@ -350,6 +350,8 @@ static MQTTBufferHandle_t prvGetFreeBuffer( MQTTContext_t * pxMQTTContext,
  *
  * Removes the buffer from the Tx buffer list if it is part of that and returns
  * it back to the free buffer pool using the user supplied buffer pool interface.
+ * The payload is cleared first, unless the buffer pool shares buffers in which
+ * case other owners may still be reading it and prvGetFreeBuffer clears it.
  *
  * @param[in] pxMQTTContext The MQTT context to which to return the buffer.
  * @param[in] xBuffer The buffer to return.
@@ -757,8 +759,10 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
  * publish message is received.
  *
  * It stops as soon as the user takes the ownership of the MQTT buffer by
- * returning eMQTTTrue from the callback. It follows the following sequence
- * for invoking callbacks:
+ * returning eMQTTTrue from the callback, unless the buffer pool shares buffers
+ * in which case every matching callback is invoked with its own reference (see
+ * prvInvokePublishCallback). It follows the following sequence for invoking
+ * callbacks:
  * - First it tries to find an exact match with the entries containing topic
  *   filters without wild-cards.
  * - Then it tries to find entries containing topic filters with wild-cards
@@ -779,6 +783,30 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
+/**
+ * @brief Invokes the callback registered with one subscription.
+ *
+ * If the buffer pool shares buffers, the callback is given its own reference
+ * to the MQTT buffer, which it keeps by returning eMQTTTrue. The reference is
+ * dropped here otherwise. The library's own reference is never passed on, so
+ * eMQTTFalse is returned and further callbacks can be invoked on the same
+ * buffer.
+ *
+ * @param[in] pxMQTTContext The MQTT context the publish message was received on.
+ * @param[in] pxSubscription The subscription with a registered callback.
+ * @param[in] pxPublishData The publish data containing the topic and the received message.
+ *
+ * @return eMQTTTrue if the callback took the library's ownership of the MQTT
+ * buffer, eMQTTFalse otherwise.
+ */
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static MQTTBool_t prvInvokePublishCallback( MQTTContext_t * pxMQTTContext,
+                                                const MQTTSubscription_t * pxSubscription,
+                                                const MQTTPublishData_t * pxPublishData );
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+
 /**
  * @brief Infers the type of the given topic filter.
  *
@@ -862,6 +890,13 @@ static MQTTBufferHandle_t prvGetFreeBuffer( MQTTContext_t * pxMQTTContext,
         /* Get the handle to return. */
         xFreeBufferHandle = mqttbufferGET_HANDLE_FROM_RAW_BUFFER( pucFreeBuffer ); /*lint !e9087 Opaque pointer. */
 
+        /* Shared buffers are not cleared when returned, as other
+         * owners may still be reading them. Clear them here instead. */
+        if( pxMQTTContext->xBufferPoolInterface.pxShareBufferFxn != NULL )
+        {
+            memset( mqttbufferGET_DATA( xFreeBufferHandle ), 0x00, mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xFreeBufferHandle ) );
+        }
+
         /* Ensure that the actual space in the buffer to store
          * data is at least what the user requested. */
         mqttconfigASSERT( mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xFreeBufferHandle ) >= ulBufferLength );
@@ -876,8 +911,12 @@ static void prvReturnBuffer( MQTTContext_t * pxMQTTContext,
 {
     if( xBuffer != NULL )
     {
-        /* Clear the payload memory. */
-        memset( mqttbufferGET_DATA( xBuffer ), 0x00, mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) );
+        /* Clear the payload memory, unless other owners may still
+         * be reading it. */
+        if( pxMQTTContext->xBufferPoolInterface.pxShareBufferFxn == NULL )
+        {
+            memset( mqttbufferGET_DATA( xBuffer ), 0x00, mqttbufferGET_EFFECTIVE_BUFFER_LENGTH( xBuffer ) );
+        }
 
         /* If the buffer is part of Tx list, remove it. */
         mqttbufferLIST_REMOVE( xBuffer );
@@ -2163,7 +2202,7 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                         *pxSubscriptionCallbackInvoked = eMQTTTrue;
 
                         /* Invoke callback. */
-                        xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+                        xBufferOwnershipTaken = prvInvokePublishCallback( pxMQTTContext, pxSubscription, pxPublishData );
 
                         /* If the user takes the buffer ownership, do
                          * not invoke any other callbacks. */
@@ -2205,7 +2244,7 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
                             *pxSubscriptionCallbackInvoked = eMQTTTrue;
 
                             /* Invoke callback. */
-                            xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+                            xBufferOwnershipTaken = prvInvokePublishCallback( pxMQTTContext, pxSubscription, pxPublishData );
 
                             /* If the user takes the buffer ownership, do
                              * not invoke any other callbacks. */
@@ -2227,6 +2266,39 @@ static uint8_t prvDecodeRemainingLength( const uint8_t * const pucEncodedRemaini
 #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 /*-----------------------------------------------------------*/
 
+#if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
+
+    static MQTTBool_t prvInvokePublishCallback( MQTTContext_t * pxMQTTContext,
+                                                const MQTTSubscription_t * pxSubscription,
+                                                const MQTTPublishData_t * pxPublishData )
+    {
+        MQTTBool_t xBufferOwnershipTaken = eMQTTFalse;
+        uint8_t * pucRawBuffer = mqttbufferGET_RAW_BUFFER_FROM_HANDLE( pxPublishData->xBuffer );
+
+        if( pxMQTTContext->xBufferPoolInterface.pxShareBufferFxn == NULL )
+        {
+            /* Only one callback can own the buffer. */
+            xBufferOwnershipTaken = pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData );
+        }
+        else
+        {
+            /* Give the callback a reference of its own. */
+            pxMQTTContext->xBufferPoolInterface.pxShareBufferFxn( pucRawBuffer );
+
+            if( pxSubscription->pxPublishCallback( pxSubscription->pvPublishCallbackContext, pxPublishData ) == eMQTTFalse )
+            {
+                /* The callback is done with the buffer. The library still
+                 * holds a reference, so this never frees the buffer. */
+                pxMQTTContext->xBufferPoolInterface.pxReturnBufferFxn( pucRawBuffer );
+            }
+        }
+
+        return xBufferOwnershipTaken;
+    }
+
+#endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
+/*-----------------------------------------------------------*/
+
 #if ( mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT == 1 )
 
     static MQTTTopicFilterType_t prvGetTopicFilterType( const uint8_t * const pucTopicFilter,
@@ -51,6 +51,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /* MQTT includes. */
 #include "aws_mqtt_agent.h"
 
+/* Event tracing includes. */
+#include "aws_trace.h"
+
+/* Static memory placement. */
+#include "aws_static_memory.h"
+
 /* JSON job document parser includes. */
 #include "jsmn.h"           /*lint !e537 All headers have multiple inclusion prevention. */
 #include "mbedtls/base64.h"
@@ -96,6 +102,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #define OTA_MAX_JSON_TOKENS             64U             /* Number of JSON tokens supported in a single parser call. */
 #define OTA_MAX_TOPIC_LEN               256U            /* Max length of a dynamically generated topic string (usually on the stack). */
+#define OTA_MAX_JOB_NAME_LEN            64U             /* Max length of the active job name with static allocation. The service limits job IDs to 64 characters. */
 
 /* When subscribing to MQTT topics with a callback handler, we use the callback
  * context variable as a subscription type to expedite dispatch of the published
@@ -216,7 +223,8 @@ typedef enum {
 	eOTA_JobParseErr_ZeroFileSize,          /* Job document specified a zero sized file. This is not allowed. */
 	eOTA_JobParseErr_NonConformingJobDoc,   /* The job document failed to fulfill the model requirements. */
 	eOTA_JobParseErr_BadModelInitParams,    /* There was an invalid initialization parameter used in the document model. */
-    eOTA_JobParseErr_NoContextAvailable     /* There wasn't an OTA context available. */
+    eOTA_JobParseErr_NoContextAvailable,    /* There wasn't an OTA context available. */
+    eOTA_JobParseErr_JobNameTooLong         /* The job ID is too long to be stored as the active job name. */
 } OTA_JobParseErr_t;
 
 
@@ -250,6 +258,19 @@ bool_t JSON_IsCStringEqual( const char * pcJSONString, uint32_t ulLen, const cha
 
 static void prvOTAUpdateTask(void* pvUnused);
 
+/* Allocate and free the memory of the strings, signature and block bitmap of an OTA file. */
+
+static void * prvOTA_Malloc( size_t xSize );
+static void prvOTA_Free( void * pvMemory );
+
+/* Make the job name of the file context the active job name. Returns pdFALSE if it can't be stored. */
+
+static bool_t prvSetActiveJobName( OTA_FileContext_t * C );
+
+/* Release the active job name once the job is done. */
+
+static void prvClearActiveJobName( void );
+
 /* Start a timer to kick-off the OTA update request. Pass it the OTA file context. */
 
 static void prvStartRequestTimer(OTA_FileContext_t* C);
@@ -368,6 +389,9 @@ typedef struct ota_agent_statistics {
     uint32_t ulOTA_PacketsProcessed;                        /* Number of OTA packets processed by the OTA task. */
     uint32_t ulOTA_PacketsDropped;                          /* Number of OTA packets dropped due to congestion. */
     uint32_t ulOTA_PublishFailures;                         /* Number of MQTT publish failures. */
+    uint32_t ulOTA_FilesVerified;                           /* Number of received files closed and signature checked. */
+    uint32_t ulOTA_LastVerifyTimeMs;                        /* Time taken by the last close and signature check. */
+    uint32_t ulOTA_TotalVerifyTimeMs;                       /* Time taken by all closes and signature checks. */
 } OTA_AgentStatistics_t;
 
 /* The OTA agent is a singleton today. The structure keeps it nice and organized. */
@@ -407,6 +431,49 @@ static OTA_AgentContext_t xOTA_Agent = {
 };
 
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/* Memory for the agent's kernel objects, used instead of the FreeRTOS heap. */
+
+static StaticTask_t xOTA_TaskBuffer staticmemSECTION( ota );
+static StackType_t xOTA_TaskStack[ otaconfigSTACK_SIZE ] staticmemSECTION( ota );
+static StaticEventGroup_t xOTA_EventFlagsBuffer staticmemSECTION( ota );
+static StaticTimer_t xOTA_RequestTimerBuffers[ OTA_MAX_FILES ] staticmemSECTION( ota );
+static TimerHandle_t xOTA_RequestTimers[ OTA_MAX_FILES ] staticmemSECTION( ota );
+
+/* The strings, signature and block bitmap of the file being received are allocated
+ * from this arena. It is emptied when the file context is closed, which works because
+ * only one file is received at a time. */
+
+static uint32_t ulOTA_Arena[ ( otaconfigSTATIC_ARENA_SIZE + 3U ) / 4U ] staticmemSECTION( ota );
+static uint32_t ulOTA_ArenaUsed;
+
+/* The active job name outlives the file context, so it is copied here. */
+
+static uint8_t ucOTA_ActiveJobName[ OTA_MAX_JOB_NAME_LEN + 1U ] staticmemSECTION( ota );
+
+/* The tokens of the job document being parsed and the payload of the data block being
+ * ingested. Both are only used by the OTA task. */
+
+static jsmntok_t xOTA_JSONTokens[ OTA_MAX_JSON_TOKENS ] staticmemSECTION( ota );
+static uint8_t ucOTA_BlockPayload[ OTA_FILE_BLOCK_SIZE ] staticmemSECTION( ota );
+
+/* Runs the agent each time it is initialized. The task is created once and waits for the
+ * next OTA_AgentInit() after a shutdown rather than deleting itself, so that its memory is
+ * never reused while the kernel may still reference it. */
+
+static void prvOTAAgentTask( void * pvUnused )
+{
+    for( ; ; )
+    {
+        prvOTAUpdateTask( pvUnused );
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+    }
+}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
+
 /* This is the default OTA callback handler if the user does not provide
  * one. It will do the basic activation and commit of accepted images.
  *
@@ -498,6 +565,9 @@ OTA_State_t OTA_AgentInit(void *pvClient, const uint8_t *pcThingName, pxOTACompl
 	xOTA_Agent.xStatistics.ulOTA_PacketsQueued = 0;
 	xOTA_Agent.xStatistics.ulOTA_PacketsProcessed = 0;
 	xOTA_Agent.xStatistics.ulOTA_PublishFailures = 0;
+	xOTA_Agent.xStatistics.ulOTA_FilesVerified = 0;
+	xOTA_Agent.xStatistics.ulOTA_LastVerifyTimeMs = 0;
+	xOTA_Agent.xStatistics.ulOTA_TotalVerifyTimeMs = 0;
 
 	if ( pcThingName != NULL )
 	{
@@ -520,7 +590,20 @@ OTA_State_t OTA_AgentInit(void *pvClient, const uint8_t *pcThingName, pxOTACompl
 	        for (ulIndex = 0; ulIndex < OTA_MAX_FILES; ulIndex++) {
 	            xOTA_Agent.pxOTA_Files[ulIndex].pacFilepath = NULL;
 	        }
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	        if ( pxOTA_TaskHandle == NULL )
+	        {
+	            pxOTA_TaskHandle = xTaskCreateStatic(prvOTAAgentTask, "OTA Task", otaconfigSTACK_SIZE, NULL, otaconfigAGENT_PRIORITY, xOTA_TaskStack, &xOTA_TaskBuffer);
+	        }
+	        else
+	        {
+	            /* Restart the agent task that was parked by the last shutdown. */
+	            ( void ) xTaskNotifyGive( pxOTA_TaskHandle );
+	        }
+	        xReturn = ( pxOTA_TaskHandle != NULL ) ? pdPASS : pdFAIL;
+#else
 	        xReturn = xTaskCreate(prvOTAUpdateTask, "OTA Task", otaconfigSTACK_SIZE, NULL, otaconfigAGENT_PRIORITY, &pxOTA_TaskHandle);
+#endif
 	        portEXIT_CRITICAL();                                /* Protected elements are initialized. It's now safe to context switch. */
 	        if (xReturn == pdPASS)
 	        {
@@ -607,6 +690,21 @@ uint32_t OTA_GetPacketsReceived( void )
     return xOTA_Agent.xStatistics.ulOTA_PacketsReceived;
 }
 
+uint32_t OTA_GetFilesVerified( void )
+{
+    return xOTA_Agent.xStatistics.ulOTA_FilesVerified;
+}
+
+uint32_t OTA_GetLastVerifyTime( void )
+{
+    return xOTA_Agent.xStatistics.ulOTA_LastVerifyTimeMs;
+}
+
+uint32_t OTA_GetTotalVerifyTime( void )
+{
+    return xOTA_Agent.xStatistics.ulOTA_TotalVerifyTimeMs;
+}
+
 /* Request for the next available OTA job from the job service by publishing
  * a "get next job" message to the job service. */
 
@@ -696,11 +794,7 @@ static void prvAgentShutdownCleanup( OTA_PubMsg_t *pxMsgMetaData )
     }
 
 	/* Free any remaining string memory holding the job name. */
-	if ( xOTA_Agent.pcOTA_Singleton_ActiveJobName != NULL )
-	{
-		vPortFree ( xOTA_Agent.pcOTA_Singleton_ActiveJobName );
-		xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
-	}
+	prvClearActiveJobName();
 
     /* If there are any queued OTA messages from MQTT, give the buffers back to MQTT for re-use. */
 	if ( pxMsgMetaData != NULL )
@@ -917,8 +1011,7 @@ static OTA_Err_t prvSetImageStateWithReason (OTA_ImageState_t eState, uint32_t u
 				    prvUpdateJobStatus (NULL, eJobStatus_Failed, ( int32_t ) eJobReason_Aborted, ( int32_t ) ulReason);
 				}
 				/* We don't need the job name memory anymore since we're done with this job. */
-				vPortFree (xOTA_Agent.pcOTA_Singleton_ActiveJobName);
-				xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
+				prvClearActiveJobName();
 			}
             xErr = kOTA_Err_None;
 		}
@@ -1216,7 +1309,9 @@ static MQTTBool_t prvOTAPublishCallback(void * pvCallbackContext,
 		{
 			xOTA_Agent.xStatistics.ulOTA_PacketsQueued++;
 			( void ) xEventGroupSetBits(xOTA_Agent.xOTA_EventFlags, OTA_EVT_MASK_MSG_READY);
-			/* Take ownership of the MQTT buffer. */
+			/* Take ownership of the MQTT buffer. The OTA task returns it once the
+			 * message is processed. Other subscribers of the topic hold their own
+			 * references, so the message is queued without being copied. */
 			xTakeOwnership = eMQTTTrue;
 		}
 		else
@@ -1252,7 +1347,11 @@ static void prvOTAUpdateTask( void* pvUnused )
 	/* Subscribe to the OTA job notification topic. */
 	if ( prvSubscribeToJobNotificationTopics() == ( bool_t ) pdTRUE)
 	{
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		xOTA_Agent.xOTA_EventFlags = xEventGroupCreateStatic ( &xOTA_EventFlagsBuffer );
+#else
 		xOTA_Agent.xOTA_EventFlags = xEventGroupCreate ();
+#endif
 		if (xOTA_Agent.xOTA_EventFlags != NULL)
 		{
 		    /* Check if the firmware image is in self test mode. If so, enable the self test timer. */
@@ -1401,11 +1500,7 @@ static void prvOTAUpdateTask( void* pvUnused )
                                         xOTA_Agent.pxOTAJobCompleteCallback ((xResult == eIngest_Result_FileComplete) ? eOTA_JobEvent_Activate : eOTA_JobEvent_Fail);
 
                                         /* Free any remaining string memory holding the job name since this job is done. */
-                                        if (xOTA_Agent.pcOTA_Singleton_ActiveJobName != NULL)
-                                        {
-                                            vPortFree (xOTA_Agent.pcOTA_Singleton_ActiveJobName);
-                                            xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
-                                        }
+                                        prvClearActiveJobName();
                                     }
                                     else
                                     {	/* We're actively receiving a file so update the job status as needed. */
@@ -1457,7 +1552,9 @@ static void prvOTAUpdateTask( void* pvUnused )
 	 * Finally, self destruct. */
     xOTA_Agent.eImageState = eOTA_ImageState_Unknown;
 	xOTA_Agent.eState = eOTA_AgentState_NotReady;
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
 	vTaskDelete(NULL);
+#endif
 }
 
 
@@ -1564,11 +1661,28 @@ static void prvStartRequestTimer( OTA_FileContext_t * C )
 
     if( C->pvRequestTimer == NULL )
     {
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        /* Static timers are created once and only stopped when the file is closed, since a
+         * delete command still pending in the timer queue would act on a timer recreated
+         * in the same memory. */
+        uint32_t ulIndex = ( uint32_t ) ( C - xOTA_Agent.pxOTA_Files );
+        if( xOTA_RequestTimers[ ulIndex ] == NULL )
+        {
+            xOTA_RequestTimers[ ulIndex ] = xTimerCreateStatic( pcTimerName,
+                                                                pdMS_TO_TICKS( otaconfigFILE_REQUEST_WAIT_MS ),
+                                                                pdFALSE,
+                                                                ( void * ) C, /*lint !e9087 Using the file context as the timer ID does not cause undefined behavior. */
+                                                                prvRequestTimer_Callback,
+                                                                &xOTA_RequestTimerBuffers[ ulIndex ] );
+        }
+        C->pvRequestTimer = xOTA_RequestTimers[ ulIndex ];
+#else
         C->pvRequestTimer = xTimerCreate( pcTimerName,
                                           pdMS_TO_TICKS( otaconfigFILE_REQUEST_WAIT_MS ),
                                           pdFALSE,
                                           ( void * ) C, /*lint !e9087 Using the file context as the timer ID does not cause undefined behavior. */
                                           prvRequestTimer_Callback );
+#endif
         if( C->pvRequestTimer != NULL )
         {
             xTimerStarted = xTimerStart( C->pvRequestTimer, 0 );
@@ -1614,47 +1728,52 @@ static bool_t prvOTA_Close( OTA_FileContext_t * const C )
     OTA_LOG_L1( "[%s] Context->0x%08x\r\n", OTA_METHOD_NAME, C );
     if ( C != NULL )
     {
-        /* Stop and delete any existing transfer request timer. */
+        /* Stop and delete any existing transfer request timer. Static timers are kept. */
         if ( C->pvRequestTimer != NULL )
         {
             ( void ) xTimerStop( C->pvRequestTimer, 0 );
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
             ( void ) xTimerDelete( C->pvRequestTimer, 0 );
+#endif
             C->pvRequestTimer = NULL;
         }
         if ( C->pacStreamName != NULL )
         {
             ( void ) prvUnSubscribeFromDataStream( C ); /* Unsubscribe from the data stream if needed. */
-            vPortFree ( C->pacStreamName );             /* Free any previously allocated stream name memory. */
+            prvOTA_Free ( C->pacStreamName );           /* Free any previously allocated stream name memory. */
             C->pacStreamName = NULL;
         }
         if ( C->pacJobName != NULL )
         {
-            vPortFree ( C->pacJobName );                /* Free the job name memory. */
+            prvOTA_Free ( C->pacJobName );              /* Free the job name memory. */
             C->pacJobName = NULL;
         }
         if ( C->pacRxBlockBitmap != NULL )
         {
-            vPortFree( C->pacRxBlockBitmap );           /* Free the previously allocated block bitmap. */
+            prvOTA_Free( C->pacRxBlockBitmap );         /* Free the previously allocated block bitmap. */
             C->pacRxBlockBitmap = NULL;
         }
         if ( C->pxSignature != NULL )
         {
-            vPortFree( C->pxSignature );               /* Free the image signature memory. */
+            prvOTA_Free( C->pxSignature );              /* Free the image signature memory. */
             C->pxSignature = NULL;
         }
         if ( C->pacFilepath != NULL )
         {
-            vPortFree( C->pacFilepath );                /* Free the file path name string memory. */
+            prvOTA_Free( C->pacFilepath );              /* Free the file path name string memory. */
             C->pacFilepath = NULL;
         }
         if ( C->pacCertFilepath != NULL )
         {
-            vPortFree( C->pacCertFilepath );            /* Free the certificate path name string memory. */
+            prvOTA_Free( C->pacCertFilepath );          /* Free the certificate path name string memory. */
             C->pacCertFilepath = NULL;
         }
         /* Abort any active file access and release the file resource, if needed. */
         ( void ) prvPAL_Abort( C );
         memset( C, 0, sizeof( OTA_FileContext_t ) );    /* Clear the entire structure now that it is free. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        ulOTA_ArenaUsed = 0U;                           /* Everything allocated for the file is released. */
+#endif
         xResult = pdTRUE;
     }
     return xResult;
@@ -1789,8 +1908,12 @@ static DocParseErr_t prvParseJSONbyModel( const char *pcJSON, uint32_t ulMsgLen,
             if ( ulNumTokens <= OTA_MAX_JSON_TOKENS )
             {
                 /* Allocate space for the document JSON tokens. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                pxTokens = xOTA_JSONTokens;                                                 /* Only the OTA task parses documents. */
+#else
                 void* pvTokenArray = pvPortMalloc( ulNumTokens * sizeof( jsmntok_t ) );     /* Allocate space on heap for temporary token array. */
                 pxTokens = ( jsmntok_t* ) pvTokenArray;                                     /*lint !e9079 !e9087 heap allocations return void* so we allow casting to a pointer to the actual type. */
+#endif
                 if ( pxTokens != NULL )
                 {
                     /* Reset Jasmine again and tokenize the document for real. */
@@ -1865,7 +1988,7 @@ static DocParseErr_t prvParseJSONbyModel( const char *pcJSON, uint32_t ulMsgLen,
                                         {
                                             /* Malloc memory for a copy of the value string plus a zero terminator. */
                                             ulTokenLen = ( uint32_t ) ( pxValTok->end ) - ( uint32_t ) ( pxValTok->start );
-                                            void* pvStringCopy = pvPortMalloc( ulTokenLen + 1U );
+                                            void* pvStringCopy = prvOTA_Malloc( ulTokenLen + 1U );
                                             if ( pvStringCopy != NULL)
                                             {
                                                 *xParamAddr.ppvPtr = pvStringCopy;
@@ -1927,7 +2050,7 @@ static DocParseErr_t prvParseJSONbyModel( const char *pcJSON, uint32_t ulMsgLen,
                                         else if ( eModelParamType_SigBase64 == pxModelParam[usModelParamIndex].xModelParamType )
                                         {
                                             /* Allocate space for and decode the base64 signature. */
-                                            void* pvSignature = pvPortMalloc( sizeof( Sig256_t ) );
+                                            void* pvSignature = prvOTA_Malloc( sizeof( Sig256_t ) );
                                             if ( pvSignature != NULL)
                                             {
                                                 size_t xActualLen;
@@ -1980,7 +2103,9 @@ static DocParseErr_t prvParseJSONbyModel( const char *pcJSON, uint32_t ulMsgLen,
                             }
                         }
                         /* Free the token memory. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
                         vPortFree(pxTokens);    /*lint !e850 ulIndex is intentionally modified within the loop to skip over unknown tags. */
+#endif
                         if ( eErr == eDocParseErr_None )
                         {
                             uint32_t ulMissingParams = ( pxDocModel->ulParamsReceivedBitmap & pxDocModel->ulParamsRequiredBitmap )
@@ -2161,7 +2286,7 @@ static OTA_FileContext_t *prvParseJobDoc(const char *pcJSON, uint32_t ulMsgLen )
                     else
                     {   /* The same job is being reported so free the duplicate job name from the context. */
                         OTA_LOG_L1("[%s] Superfluous report of current job.\r\n", OTA_METHOD_NAME);
-                        vPortFree (C->pacJobName);
+                        prvOTA_Free (C->pacJobName);
                         C->pacJobName = NULL;
                         eErr = eOTA_JobParseErr_BusyWithSameJob;
                     }
@@ -2172,10 +2297,15 @@ static OTA_FileContext_t *prvParseJobDoc(const char *pcJSON, uint32_t ulMsgLen )
                     eErr = eOTA_JobParseErr_NullJob;
                 }
             }
+            /* Assume control of the job name from the context. */
+            else if ( prvSetActiveJobName( C ) == ( bool_t ) pdFALSE )
+            {
+                OTA_LOG_L1("[%s] Job name is too long.\r\n", OTA_METHOD_NAME);
+                eErr = eOTA_JobParseErr_JobNameTooLong;
+            }
             else
-            {   /* Assume control of the job name from the context. */
-                xOTA_Agent.pcOTA_Singleton_ActiveJobName = C->pacJobName;
-                C->pacJobName = NULL;
+            {
+                /* The job is now the active job. */
             }
             if (eErr == eOTA_JobParseErr_None)
             {
@@ -2259,20 +2389,17 @@ static OTA_FileContext_t *prvParseJobDoc(const char *pcJSON, uint32_t ulMsgLen )
         {
             /* If job parsing failed AND there's a job ID, update the job state to FAILED with
              * a reason code.  Without a job ID, we can't update the status in the job service. */
-            if ( C->pacJobName != NULL )
+            /* Assume control of the job name from the context. */
+            if ( ( C->pacJobName != NULL ) && ( prvSetActiveJobName( C ) == ( bool_t ) pdTRUE ) )
             {
                 OTA_LOG_L1( "[%s] Rejecting job due to OTA_JobParseErr_t %d\r\n", OTA_METHOD_NAME, eErr );
-                /* Assume control of the job name from the context. */
-                xOTA_Agent.pcOTA_Singleton_ActiveJobName = C->pacJobName;
-                C->pacJobName = NULL;
                 prvUpdateJobStatus( NULL, eJobStatus_FailedWithVal, ( int32_t ) kOTA_Err_JobParserError, ( int32_t ) eErr );
                 /* We don't need the job name memory anymore since we're done with this job. */
-                vPortFree( xOTA_Agent.pcOTA_Singleton_ActiveJobName );
-                xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
+                prvClearActiveJobName();
             }
             else
             {
-                OTA_LOG_L1( "[%s] Ignoring job without ID.\r\n", OTA_METHOD_NAME );
+                OTA_LOG_L1( "[%s] Ignoring job without a usable ID.\r\n", OTA_METHOD_NAME );
             }
         }
     }
@@ -2309,7 +2436,7 @@ static OTA_FileContext_t* prvProcessOTAJobMsg( const char *pcRawMsg, uint32_t ul
 
         if ( pstUpdateFile->pacRxBlockBitmap != NULL )
         {
-            vPortFree( pstUpdateFile->pacRxBlockBitmap );           /* Free any previously allocated bitmap. */
+            prvOTA_Free( pstUpdateFile->pacRxBlockBitmap );         /* Free any previously allocated bitmap. */
             pstUpdateFile->pacRxBlockBitmap = NULL;
         }
         /* Calculate how many bytes we need in our bitmap for tracking received blocks.
@@ -2317,7 +2444,7 @@ static OTA_FileContext_t* prvProcessOTAJobMsg( const char *pcRawMsg, uint32_t ul
 
         ulNumBlocks = ( pstUpdateFile->ulFileSize + ( OTA_FILE_BLOCK_SIZE - 1U ) ) >> otaconfigLOG2_FILE_BLOCK_SIZE;
         ulBitmapLen = ( ulNumBlocks + ( BITS_PER_BYTE - 1U ) ) >> LOG2_BITS_PER_BYTE;
-        pstUpdateFile->pacRxBlockBitmap = (uint8_t*)pvPortMalloc( ulBitmapLen ); /*lint !e9079 FreeRTOS malloc port returns void*. */
+        pstUpdateFile->pacRxBlockBitmap = (uint8_t*)prvOTA_Malloc( ulBitmapLen ); /*lint !e9079 FreeRTOS malloc port returns void*. */
         if ( pstUpdateFile->pacRxBlockBitmap != NULL ) {
 
             if ( (BaseType_t)(prvSubscribeToDataStream( pstUpdateFile )) == pdTRUE ) {
@@ -2404,6 +2531,18 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                 prvStartRequestTimer( C );
 
                 /* Decode the CBOR content. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                pucPayload = ucOTA_BlockPayload;
+                xPayloadSize = sizeof( ucOTA_BlockPayload );
+                if( pdFALSE == OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer(
+                    (const uint8_t * ) pcRawMsg,
+                    ulMsgSize,
+                    &lFileId,
+                    (int32_t*)&ulBlockIndex,    /*lint !e9087 CBOR requires pointer to int and our block index's never exceed 31 bits. */
+                    (int32_t*)&ulBlockSize,     /*lint !e9087 CBOR requires pointer to int and our block sizes never exceed 31 bits. */
+                    pucPayload,                 /* Blocks larger than OTA_FILE_BLOCK_SIZE are rejected. */
+                    ( size_t* ) &xPayloadSize ) )
+#else
                 if( pdFALSE == OTA_CBOR_Decode_GetStreamResponseMessage(
                     (const uint8_t * ) pcRawMsg,
                     ulMsgSize,
@@ -2412,6 +2551,7 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                     (int32_t*)&ulBlockSize,     /*lint !e9087 CBOR requires pointer to int and our block sizes never exceed 31 bits. */
                     &pucPayload,                /* This payload gets malloc'd by OTA_CBOR_Decode_GetStreamResponseMessage(). We must free it. */
                     ( size_t* ) &xPayloadSize ) )
+#endif
                 {
                     eIngestResult = eIngest_Result_BadData;
                 }
@@ -2427,6 +2567,7 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                         ( ( ( uint32_t )ulBlockIndex == iLastBlock ) && ( ( uint32_t )ulBlockSize == ( C->ulFileSize - ( iLastBlock * OTA_FILE_BLOCK_SIZE ) ) ) ) )
                     {
                         OTA_LOG_L1("[%s] Received file block %u, size %u\r\n", OTA_METHOD_NAME, ulBlockIndex, ulBlockSize);
+                        TRACE_EVENT( eTraceOtaBlockReceived, ulBlockIndex );
 
                         /* Create bit mask for use in our bitmap. */
                         uint8_t ulBitMask = 1U << ( ulBlockIndex % BITS_PER_BYTE ); /*lint !e9031 The composite expression will never be greater than BITS_PER_BYTE(8). */
@@ -2454,6 +2595,7 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                                 }
                                 else
                                 {
+                                    TRACE_EVENT( eTraceOtaBlockWritten, ulBlockIndex );
                                     C->pacRxBlockBitmap[ulByte] &= ~ulBitMask;  /* Mark this block as received in our bitmap. */
                                     C->ulBlocksRemaining--;
                                     eIngestResult = eIngest_Result_Accepted_Continue;
@@ -2470,11 +2612,22 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
                             {
                                 OTA_LOG_L1( "[%s] Received final expected block of file.\r\n", OTA_METHOD_NAME );
                                 prvStopRequestTimer( C );         /* Don't request any more since we're done. */
-                                vPortFree( C->pacRxBlockBitmap ); /* Free the bitmap now that we're done with the download. */
+                                prvOTA_Free( C->pacRxBlockBitmap ); /* Free the bitmap now that we're done with the download. */
                                 C->pacRxBlockBitmap = NULL;
                                 if ( C->pucFile != NULL )
                                 {
+                                    TickType_t xCloseStart = xTaskGetTickCount();
+                                    uint32_t ulVerifyTimeMs;
+
+                                    /* The PAL checks the file signature when it closes the file. */
                                     *pxCloseResult = prvPAL_CloseFile( C );
+                                    TRACE_EVENT( eTraceOtaFileClosed, *pxCloseResult );
+
+                                    ulVerifyTimeMs = ( uint32_t ) ( ( ( uint64_t ) ( xTaskGetTickCount() - xCloseStart ) * 1000ULL ) / configTICK_RATE_HZ );
+                                    xOTA_Agent.xStatistics.ulOTA_FilesVerified++;
+                                    xOTA_Agent.xStatistics.ulOTA_LastVerifyTimeMs = ulVerifyTimeMs;
+                                    xOTA_Agent.xStatistics.ulOTA_TotalVerifyTimeMs += ulVerifyTimeMs;
+                                    OTA_LOG_L1( "[%s] File closed in %u ms.\r\n", OTA_METHOD_NAME, ulVerifyTimeMs );
 
                                     if ( *pxCloseResult == kOTA_Err_None )
                                     {
@@ -2532,10 +2685,12 @@ static IngestResult_t prvIngestDataBlock( OTA_FileContext_t * C,
     {
         eIngestResult = eIngest_Result_NullContext;
     }
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
 	if ( NULL != pucPayload )
     {
         vPortFree( pucPayload );
     }
+#endif
     return eIngestResult;
 }
 
@@ -2727,6 +2882,89 @@ static void prvUnSubscribeFromJobNotificationTopic( void )
 }
 
 
+/* Allocate memory for the file being received. With static allocation the memory comes from
+ * the arena, in 4 byte units so that the signature stays aligned, and is all released when the
+ * file context is closed. */
+
+static void * prvOTA_Malloc( size_t xSize )
+{
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    void * pvMemory = NULL;
+    uint32_t ulWords = ( uint32_t ) ( ( xSize + 3U ) / 4U );
+
+    if ( ulWords <= ( ( sizeof( ulOTA_Arena ) / sizeof( ulOTA_Arena[ 0 ] ) ) - ulOTA_ArenaUsed ) )
+    {
+        pvMemory = &ulOTA_Arena[ ulOTA_ArenaUsed ];
+        ulOTA_ArenaUsed += ulWords;
+    }
+    return pvMemory;
+#else
+    return pvPortMalloc( xSize );
+#endif
+}
+
+
+/* Free memory allocated by prvOTA_Malloc(). Arena memory is released by prvOTA_Close(). */
+
+static void prvOTA_Free( void * pvMemory )
+{
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    ( void ) pvMemory;
+#else
+    vPortFree( pvMemory );
+#endif
+}
+
+
+/* Make the job name of the file context the active job name. The dynamic job name is taken over
+ * from the context. With static allocation it is copied since the arena is released when the
+ * context is closed. */
+
+static bool_t prvSetActiveJobName( OTA_FileContext_t * C )
+{
+    bool_t xResult = ( bool_t ) pdTRUE;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    size_t xLength = 0;
+
+    if ( C->pacJobName == NULL )
+    {
+        xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
+    }
+    else if ( ( xLength = strlen( ( const char * ) C->pacJobName ) ) <= OTA_MAX_JOB_NAME_LEN )
+    {
+        memcpy( ucOTA_ActiveJobName, C->pacJobName, xLength + 1U );
+        xOTA_Agent.pcOTA_Singleton_ActiveJobName = ucOTA_ActiveJobName;
+    }
+    else
+    {
+        xResult = ( bool_t ) pdFALSE;
+    }
+#else
+    xOTA_Agent.pcOTA_Singleton_ActiveJobName = C->pacJobName;
+#endif
+    if ( xResult == ( bool_t ) pdTRUE )
+    {
+        C->pacJobName = NULL;
+    }
+    return xResult;
+}
+
+
+/* Release the active job name once the job is done. */
+
+static void prvClearActiveJobName( void )
+{
+#if ( configSUPPORT_STATIC_ALLOCATION == 0 )
+    if ( xOTA_Agent.pcOTA_Singleton_ActiveJobName != NULL )
+    {
+        vPortFree( xOTA_Agent.pcOTA_Singleton_ActiveJobName );
+    }
+#endif
+    xOTA_Agent.pcOTA_Singleton_ActiveJobName = NULL;
+}
+
+
 /* Publish a message to the specified client/topic at the given QOS. */
 
 static MQTTAgentReturnCode_t prvPublishMessage( void * const pvClient,
@@ -49,13 +49,16 @@ typedef struct OTAMessageDecodeContext
 } OTAMessageDecodeContext_t, * OTAMessageDecodeContextPtr_t;
 
 /**
- * @brief Decode a Get Stream response message from AWS IoT OTA.
+ * @brief Decode a Get Stream response message into pucPayloadBuffer, or into
+ * memory allocated from the heap if pucPayloadBuffer is NULL.
  */
-BaseType_t OTA_CBOR_Decode_GetStreamResponseMessage( const uint8_t * pucMessageBuffer,
+static BaseType_t prvDecodeGetStreamResponseMessage( const uint8_t * pucMessageBuffer,
                                                      size_t xMessageSize,
                                                      int32_t * plFileId,
                                                      int32_t * plBlockId,
                                                      int32_t * plBlockSize,
+                                                     uint8_t * pucPayloadBuffer,
+                                                     size_t xPayloadBufferSize,
                                                      uint8_t ** ppucPayload,
                                                      size_t * pxPayloadSize )
 {
@@ -183,7 +186,18 @@ BaseType_t OTA_CBOR_Decode_GetStreamResponseMessage( const uint8_t * pucMessageB
 
     if( CborNoError == xCborResult )
     {
-        *ppucPayload = pvPortMalloc( *pxPayloadSize );
+        if( NULL == pucPayloadBuffer )
+        {
+            *ppucPayload = pvPortMalloc( *pxPayloadSize );
+        }
+        else if( *pxPayloadSize <= xPayloadBufferSize )
+        {
+            *ppucPayload = pucPayloadBuffer;
+        }
+        else
+        {
+            *ppucPayload = NULL;
+        }
 
         if( NULL == *ppucPayload )
         {
@@ -203,7 +217,53 @@ BaseType_t OTA_CBOR_Decode_GetStreamResponseMessage( const uint8_t * pucMessageB
     return CborNoError == xCborResult;
 }
 
+/**
+ * @brief Decode a Get Stream response message from AWS IoT OTA.
+ */
+BaseType_t OTA_CBOR_Decode_GetStreamResponseMessage( const uint8_t * pucMessageBuffer,
+                                                     size_t xMessageSize,
+                                                     int32_t * plFileId,
+                                                     int32_t * plBlockId,
+                                                     int32_t * plBlockSize,
+                                                     uint8_t ** ppucPayload,
+                                                     size_t * pxPayloadSize )
+{
+    return prvDecodeGetStreamResponseMessage( pucMessageBuffer,
+                                              xMessageSize,
+                                              plFileId,
+                                              plBlockId,
+                                              plBlockSize,
+                                              NULL,
+                                              0,
+                                              ppucPayload,
+                                              pxPayloadSize );
+}
 
+/**
+ * @brief Decode a Get Stream response message from AWS IoT OTA into a
+ * caller supplied buffer. *pxPayloadSize is the size of the buffer on entry
+ * and the size of the payload on return.
+ */
+BaseType_t OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer( const uint8_t * pucMessageBuffer,
+                                                               size_t xMessageSize,
+                                                               int32_t * plFileId,
+                                                               int32_t * plBlockId,
+                                                               int32_t * plBlockSize,
+                                                               uint8_t * pucPayload,
+                                                               size_t * pxPayloadSize )
+{
+    uint8_t * pucDecodedPayload = NULL;
+
+    return prvDecodeGetStreamResponseMessage( pucMessageBuffer,
+                                              xMessageSize,
+                                              plFileId,
+                                              plBlockId,
+                                              plBlockSize,
+                                              pucPayload,
+                                              *pxPayloadSize,
+                                              &pucDecodedPayload,
+                                              pxPayloadSize );
+}
 
 /**
  * @brief Create an encoded Get Stream Request message for the AWS IoT OTA
@@ -35,6 +35,7 @@
 #include "FreeRTOS.h"
 #include "FreeRTOSIPConfig.h"
 #include "aws_pkcs11_config.h"
+#include "aws_pkcs11_config_defaults.h"
 #include "task.h"
 #include "semphr.h"
 #include "aws_crypto.h"
@@ -70,12 +71,36 @@ typedef int ( * pfnMbedTlsSign )( void * ctx,
 /* The size of the buffer malloc'ed for the exported public key in C_GenerateKeyPair */
 #define pkcs11KEY_GEN_MAX_DER_SIZE    200
 
+/* The number of parsed keys kept. One for each key object, plus one for a
+ * key which is still used by a session after its object was saved again. */
+#define pkcs11PARSED_KEY_COUNT        4
+
+/**
+ * @brief A key parsed once and shared by all the sessions signing or
+ * verifying with it.
+ */
+typedef struct P11ParsedKey
+{
+    mbedtls_pk_context xKey;
+    CK_OBJECT_HANDLE xHandle;   /* pkcs11INVALID_OBJECT_HANDLE when the entry is free. */
+    CK_BBOOL xIsPrivate;
+    CK_BBOOL xIsCurrent;        /* CK_FALSE once the object was saved again. */
+    uint32_t ulRefs;            /* Sessions using the key. */
+    SemaphoreHandle_t xLock;    /* Serializes operations, mbedTLS writes to the key on its first use. */
+    StaticSemaphore_t xLockBuffer;
+} P11ParsedKey_t;
+
 /* PKCS#11 Object */
 typedef struct P11Struct_t
 {
     CK_BBOOL xIsInitialized;
-    mbedtls_ctr_drbg_context xMbedDrbgCtx;
+    mbedtls_ctr_drbg_context xMbedDrbgCtx[ pkcs11configDRBG_POOL_SIZE ]; /* Each task uses one, see prvGetDrbg(). */
     mbedtls_entropy_context xMbedEntropyContext;
+    SemaphoreHandle_t xKeyMutex; /* Guards xParsedKeys. */
+    StaticSemaphore_t xKeyMutexBuffer;
+    P11ParsedKey_t xParsedKeys[ pkcs11PARSED_KEY_COUNT ];
+    uint32_t ulKeyHits;
+    uint32_t ulKeyParses;
 } P11Struct_t, * P11Context_t;
 
 static P11Struct_t xP11Context;
@@ -93,8 +118,8 @@ typedef struct P11Session
     CK_BBOOL xFindObjectComplete;
     uint8_t * xFindObjectLabel;
     uint8_t xFindObjectLabelLength;
-    mbedtls_pk_context xVerifyKey;
-    mbedtls_pk_context xSignKey;
+    P11ParsedKey_t * pxVerifyKey;
+    P11ParsedKey_t * pxSignKey;
     mbedtls_sha256_context xSHA256Context;
 } P11Session_t, * P11SessionPtr_t;
 
@@ -149,6 +174,16 @@ extern BaseType_t PKCS11_PAL_GetObjectValue( CK_OBJECT_HANDLE xHandle,
 extern void PKCS11_PAL_GetObjectValueCleanup( uint8_t * pucBuffer,
                                               uint32_t ulBufferSize );
 
+/**
+ *  @brief Read the objects into RAM, called from C_Initialize().
+ */
+extern CK_RV PKCS11_PAL_Initialize( void );
+
+/**
+ *  @brief Fill in the object counters of the PAL's cache.
+ */
+extern void PKCS11_PAL_GetCacheStats( PKCS11_CacheStats_t * pxStats );
+
 /*-----------------------------------------------------------*/
 
 
@@ -254,6 +289,203 @@ P11SessionPtr_t prvSessionPointerFromHandle( CK_SESSION_HANDLE xSession )
     return ( P11SessionPtr_t ) xSession; /*lint !e923 Allow casting integer type to pointer for handle. */
 }
 
+/*-----------------------------------------------------------*/
+/*---------------------- Parsed keys ------------------------*/
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the parsed key of an object, parsing the object value only if
+ * no session has used this key since the object was last saved.
+ *
+ * The key must be released with prvReleaseParsedKey().
+ */
+static CK_RV prvAcquireParsedKey( CK_OBJECT_HANDLE xHandle,
+                                  P11ParsedKey_t ** ppxKey )
+{
+    CK_RV xResult = CKR_OK;
+    P11ParsedKey_t * pxKey = NULL;
+    P11ParsedKey_t * pxFree = NULL;
+    uint8_t * pucKeyData = NULL;
+    uint32_t ulKeyDataLength = 0;
+    CK_BBOOL xIsPrivate = CK_TRUE;
+    uint32_t i;
+
+    ( void ) xSemaphoreTake( xP11Context.xKeyMutex, portMAX_DELAY );
+
+    for( i = 0; i < pkcs11PARSED_KEY_COUNT; i++ )
+    {
+        if( ( xP11Context.xParsedKeys[ i ].xHandle == xHandle ) &&
+            ( xP11Context.xParsedKeys[ i ].xIsCurrent == CK_TRUE ) )
+        {
+            pxKey = &xP11Context.xParsedKeys[ i ];
+            break;
+        }
+    }
+
+    if( pxKey != NULL )
+    {
+        xP11Context.ulKeyHits++;
+    }
+    else
+    {
+        /* Prefer a free entry, else evict a key no session is using. */
+        for( i = 0; i < pkcs11PARSED_KEY_COUNT; i++ )
+        {
+            if( xP11Context.xParsedKeys[ i ].xHandle == pkcs11INVALID_OBJECT_HANDLE )
+            {
+                pxFree = &xP11Context.xParsedKeys[ i ];
+                break;
+            }
+
+            if( ( pxFree == NULL ) && ( xP11Context.xParsedKeys[ i ].ulRefs == 0 ) )
+            {
+                pxFree = &xP11Context.xParsedKeys[ i ];
+            }
+        }
+
+        if( pxFree == NULL )
+        {
+            xResult = CKR_HOST_MEMORY;
+        }
+        else
+        {
+            if( pxFree->xHandle != pkcs11INVALID_OBJECT_HANDLE )
+            {
+                mbedtls_pk_free( &pxFree->xKey );
+                pxFree->xHandle = pkcs11INVALID_OBJECT_HANDLE;
+            }
+
+            xResult = PKCS11_PAL_GetObjectValue( xHandle, &pucKeyData, &ulKeyDataLength, &xIsPrivate );
+        }
+
+        if( xResult == CKR_OK )
+        {
+            mbedtls_pk_init( &pxFree->xKey );
+
+            if( xIsPrivate == CK_TRUE )
+            {
+                if( 0 != mbedtls_pk_parse_key( &pxFree->xKey, pucKeyData, ulKeyDataLength, NULL, 0 ) )
+                {
+                    xResult = CKR_KEY_HANDLE_INVALID;
+                }
+            }
+            else if( 0 != mbedtls_pk_parse_public_key( &pxFree->xKey, pucKeyData, ulKeyDataLength ) )
+            {
+                /* The device public key is stored with the private key. */
+                if( 0 != mbedtls_pk_parse_key( &pxFree->xKey, pucKeyData, ulKeyDataLength, NULL, 0 ) )
+                {
+                    xResult = CKR_KEY_HANDLE_INVALID;
+                }
+            }
+
+            PKCS11_PAL_GetObjectValueCleanup( pucKeyData, ulKeyDataLength );
+
+            if( xResult == CKR_OK )
+            {
+                pxFree->xHandle = xHandle;
+                pxFree->xIsPrivate = xIsPrivate;
+                pxFree->xIsCurrent = CK_TRUE;
+                pxFree->ulRefs = 0;
+                pxKey = pxFree;
+                xP11Context.ulKeyParses++;
+            }
+            else
+            {
+                mbedtls_pk_free( &pxFree->xKey );
+            }
+        }
+    }
+
+    if( pxKey != NULL )
+    {
+        pxKey->ulRefs++;
+    }
+
+    ( void ) xSemaphoreGive( xP11Context.xKeyMutex );
+
+    *ppxKey = pxKey;
+
+    return xResult;
+}
+
+/**
+ * @brief Release a key acquired with prvAcquireParsedKey(). A key whose
+ * object was saved again is freed with its last user.
+ */
+static void prvReleaseParsedKey( P11ParsedKey_t * pxKey )
+{
+    ( void ) xSemaphoreTake( xP11Context.xKeyMutex, portMAX_DELAY );
+
+    pxKey->ulRefs--;
+
+    if( ( pxKey->ulRefs == 0 ) && ( pxKey->xIsCurrent == CK_FALSE ) )
+    {
+        mbedtls_pk_free( &pxKey->xKey );
+        pxKey->xHandle = pkcs11INVALID_OBJECT_HANDLE;
+    }
+
+    ( void ) xSemaphoreGive( xP11Context.xKeyMutex );
+}
+
+/**
+ * @brief Forget all parsed keys, after an object was saved. Keys still used
+ * by a session are freed when they are released.
+ */
+static void prvInvalidateParsedKeys( void )
+{
+    uint32_t i;
+    P11ParsedKey_t * pxKey;
+
+    ( void ) xSemaphoreTake( xP11Context.xKeyMutex, portMAX_DELAY );
+
+    for( i = 0; i < pkcs11PARSED_KEY_COUNT; i++ )
+    {
+        pxKey = &xP11Context.xParsedKeys[ i ];
+        pxKey->xIsCurrent = CK_FALSE;
+
+        if( ( pxKey->xHandle != pkcs11INVALID_OBJECT_HANDLE ) && ( pxKey->ulRefs == 0 ) )
+        {
+            mbedtls_pk_free( &pxKey->xKey );
+            pxKey->xHandle = pkcs11INVALID_OBJECT_HANDLE;
+        }
+    }
+
+    ( void ) xSemaphoreGive( xP11Context.xKeyMutex );
+}
+
+/**
+ * @brief Read the object and key cache counters, see aws_pkcs11.h.
+ */
+void PKCS11_GetCacheStats( PKCS11_CacheStats_t * pxStats )
+{
+    configASSERT( pxStats != NULL );
+
+    PKCS11_PAL_GetCacheStats( pxStats );
+
+    pxStats->ulKeyHits = xP11Context.ulKeyHits;
+    pxStats->ulKeyParses = xP11Context.ulKeyParses;
+}
+
+/*-----------------------------------------------------------*/
+/*------------------------ DRBG pool ------------------------*/
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Select the DRBG of the calling task.
+ *
+ * A task always uses the same DRBG. The TCB address is mixed with a
+ * multiplicative hash, TCBs are allocated from a few regions and aligned,
+ * so their low bits alone would map most tasks to the same DRBG.
+ */
+static mbedtls_ctr_drbg_context * prvGetDrbg( void )
+{
+    uint32_t ulHash = ( uint32_t ) ( ( uintptr_t ) xTaskGetCurrentTaskHandle() >> 3 );
+
+    ulHash *= 2654435761UL;
+
+    return &xP11Context.xMbedDrbgCtx[ ( ulHash >> 16 ) % pkcs11configDRBG_POOL_SIZE ];
+}
+
 
 /*
  * PKCS#11 module implementation.
@@ -340,6 +572,8 @@ static CK_FUNCTION_LIST prvP11FunctionList =
 CK_RV prvMbedTLS_Initialize( void )
 {
     CK_RV xResult = CKR_OK;
+    uint32_t i;
+    char cPersonalization[ 24 ];
 
     if( xP11Context.xIsInitialized == CK_TRUE )
     {
@@ -357,19 +591,46 @@ CK_RV prvMbedTLS_Initialize( void )
                                    aws_mbedtls_mutex_lock,
                                    aws_mbedtls_mutex_unlock );
 
-        /* Initialze the entropy source and DRBG for the PKCS#11 module */
+        /* The parsed keys outlive C_Finalize(), a session may still use one. */
+        if( xP11Context.xKeyMutex == NULL )
+        {
+            xP11Context.xKeyMutex = xSemaphoreCreateMutexStatic( &xP11Context.xKeyMutexBuffer );
+
+            for( i = 0; i < pkcs11PARSED_KEY_COUNT; i++ )
+            {
+                xP11Context.xParsedKeys[ i ].xLock =
+                    xSemaphoreCreateMutexStatic( &xP11Context.xParsedKeys[ i ].xLockBuffer );
+            }
+        }
+
+        /* Read the objects into RAM once, rather than in every session. */
+        ( void ) PKCS11_PAL_Initialize();
+
+        /* Initialze the entropy source and DRBGs for the PKCS#11 module.
+         * The DRBGs share the entropy source, each is personalized with its
+         * index so that no two start in the same state. */
         mbedtls_entropy_init( &xP11Context.xMbedEntropyContext );
-        mbedtls_ctr_drbg_init( &xP11Context.xMbedDrbgCtx );
 
-        if( 0 != mbedtls_ctr_drbg_seed( &xP11Context.xMbedDrbgCtx,
-                                        mbedtls_entropy_func,
-                                        &xP11Context.xMbedEntropyContext,
-                                        NULL,
-                                        0 ) )
+        for( i = 0; i < pkcs11configDRBG_POOL_SIZE; i++ )
         {
-            xResult = CKR_FUNCTION_FAILED;
+            mbedtls_ctr_drbg_init( &xP11Context.xMbedDrbgCtx[ i ] );
         }
-        else
+
+        for( i = 0; ( i < pkcs11configDRBG_POOL_SIZE ) && ( xResult == CKR_OK ); i++ )
+        {
+            ( void ) snprintf( cPersonalization, sizeof( cPersonalization ), "aws_pkcs11 drbg %d", ( int ) i );
+
+            if( 0 != mbedtls_ctr_drbg_seed( &xP11Context.xMbedDrbgCtx[ i ],
+                                            mbedtls_entropy_func,
+                                            &xP11Context.xMbedEntropyContext,
+                                            ( const unsigned char * ) cPersonalization,
+                                            strlen( cPersonalization ) ) )
+            {
+                xResult = CKR_FUNCTION_FAILED;
+            }
+        }
+
+        if( xResult == CKR_OK )
         {
             xP11Context.xIsInitialized = CK_TRUE;
         }
@@ -397,6 +658,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_Finalize )( CK_VOID_PTR pvReserved )
 {
     /*lint !e9072 It's OK to have different parameter name. */
     CK_RV xResult = CKR_OK;
+    uint32_t i;
 
     if( NULL != pvReserved )
     {
@@ -415,11 +677,13 @@ CK_DEFINE_FUNCTION( CK_RV, C_Finalize )( CK_VOID_PTR pvReserved )
             mbedtls_entropy_free( &xP11Context.xMbedEntropyContext );
         }
 
-        if( NULL != &xP11Context.xMbedDrbgCtx )
+        for( i = 0; i < pkcs11configDRBG_POOL_SIZE; i++ )
         {
-            mbedtls_ctr_drbg_free( &xP11Context.xMbedDrbgCtx );
+            mbedtls_ctr_drbg_free( &xP11Context.xMbedDrbgCtx[ i ] );
         }
 
+        prvInvalidateParsedKeys();
+
         xP11Context.xIsInitialized = CK_FALSE;
     }
 
@@ -579,15 +843,15 @@ CK_DEFINE_FUNCTION( CK_RV, C_CloseSession )( CK_SESSION_HANDLE xSession )
          * Tear down the session.
          */
 
-        if( NULL != pxSession->xSignKey.pk_ctx )
+        if( NULL != pxSession->pxSignKey )
         {
-            mbedtls_pk_free( &pxSession->xSignKey );
+            prvReleaseParsedKey( pxSession->pxSignKey );
         }
 
-        /* Free the public key context if it exists. */
-        if( NULL != pxSession->xVerifyKey.pk_ctx )
+        /* Release the public key if it exists. */
+        if( NULL != pxSession->pxVerifyKey )
         {
-            mbedtls_pk_free( &pxSession->xVerifyKey );
+            prvReleaseParsedKey( pxSession->pxVerifyKey );
         }
 
         if( NULL != &pxSession->xSHA256Context )
@@ -766,10 +1030,14 @@ CK_DEFINE_FUNCTION( CK_RV, C_CreateObject )( CK_SESSION_HANDLE xSession,
                     break;
                 }
 
-                /* Save the key to NVM. */
-                if( 0 == ( *pxObject = PKCS11_PAL_SaveObject( &pxKeyTemplate->xLabel,
-                                                              pxKeyTemplate->xValue.pValue,
-                                                              pxKeyTemplate->xValue.ulValueLen ) ) )
+                /* Save the key to NVM. The keys parsed from the old value
+                 * are stale even if the save failed. */
+                *pxObject = PKCS11_PAL_SaveObject( &pxKeyTemplate->xLabel,
+                                                   pxKeyTemplate->xValue.pValue,
+                                                   pxKeyTemplate->xValue.ulValueLen );
+                prvInvalidateParsedKeys();
+
+                if( 0 == *pxObject )
                 {
                     xResult = CKR_DEVICE_ERROR;
                     break;
@@ -809,7 +1077,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_GetAttributeValue )( CK_SESSION_HANDLE xSession,
     CK_RV xResult = CKR_OK;
     CK_BBOOL xIsPrivate = CK_TRUE;
     CK_ULONG iAttrib;
-    mbedtls_pk_context privateKeyContext;
+    P11ParsedKey_t * pxParsedKey = NULL;
     mbedtls_pk_type_t xKeyType;
     CK_KEY_TYPE xPkcsKeyType = ( CK_KEY_TYPE ) ~0;
 
@@ -874,16 +1142,13 @@ CK_DEFINE_FUNCTION( CK_RV, C_GetAttributeValue )( CK_SESSION_HANDLE xSession,
                     }
                     else
                     {
-                        mbedtls_pk_init( &privateKeyContext );
-                        xResult = mbedtls_pk_parse_key( &privateKeyContext, pxObjectValue, ulLength, NULL, 0 );
-
-                        if( 0 != xResult )
+                        if( CKR_OK != prvAcquireParsedKey( xObject, &pxParsedKey ) )
                         {
                             xResult = CKR_FUNCTION_FAILED;
                         }
                         else
                         {
-                            xKeyType = mbedtls_pk_get_type( &privateKeyContext );
+                            xKeyType = mbedtls_pk_get_type( &pxParsedKey->xKey );
 
                             switch( xKeyType )
                             {
@@ -908,10 +1173,9 @@ CK_DEFINE_FUNCTION( CK_RV, C_GetAttributeValue )( CK_SESSION_HANDLE xSession,
                             }
 
                             memcpy( pxTemplate[ iAttrib ].pValue, &xPkcsKeyType, sizeof( CK_KEY_TYPE ) );
-                        }
 
-                        /* Free the mbedTLS structure used to parse the key. */
-                        mbedtls_pk_free( &privateKeyContext );
+                            prvReleaseParsedKey( pxParsedKey );
+                        }
                     }
 
                     break;
@@ -1200,12 +1464,10 @@ CK_DEFINE_FUNCTION( CK_RV, C_SignInit )( CK_SESSION_HANDLE xSession,
                                          CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
-    CK_BBOOL xIsPrivate;
 
     /*lint !e9072 It's OK to have different parameter name. */
     P11SessionPtr_t pxSession = prvSessionPointerFromHandle( xSession );
-    uint8_t * keyData = NULL;
-    uint32_t ulKeyDataLength = 0;
+    P11ParsedKey_t * pxKey = NULL;
 
     if( NULL == pxMechanism )
     {
@@ -1213,34 +1475,32 @@ CK_DEFINE_FUNCTION( CK_RV, C_SignInit )( CK_SESSION_HANDLE xSession,
     }
     else
     {
-        xResult = PKCS11_PAL_GetObjectValue( xKey, &keyData, &ulKeyDataLength, &xIsPrivate );
+        /* The key is parsed by the first session using it, later sessions
+         * share it. */
+        xResult = prvAcquireParsedKey( xKey, &pxKey );
 
-        if( xIsPrivate != CK_TRUE )
+        if( ( xResult == CKR_OK ) && ( pxKey->xIsPrivate != CK_TRUE ) )
         {
+            prvReleaseParsedKey( pxKey );
             xResult = CKR_KEY_TYPE_INCONSISTENT;
         }
 
         if( xResult == CKR_OK )
         {
-            mbedtls_pk_init( &pxSession->xSignKey );
-
-            if( 0 == mbedtls_pk_parse_key( &pxSession->xSignKey, keyData, ulKeyDataLength, NULL, 0 ) )
-            {
-                /* TODO: Check the mechanism.  Note: Currently, mechanism is being set to CKM_SHA256, rather than
-                 * CKM_RSA_PKCS
-                 * CKM_SHA256_RSA_PKCS
-                 * CKM_ECDSA
-                 * Calling function does not know whether key is RSA or ECDSA.
-                 * xKeyType = mbedtls_pk_get_type( &pxSession->xSignKey );
-                 */
-            }
-            else
+            /* TODO: Check the mechanism.  Note: Currently, mechanism is being set to CKM_SHA256, rather than
+             * CKM_RSA_PKCS
+             * CKM_SHA256_RSA_PKCS
+             * CKM_ECDSA
+             * Calling function does not know whether key is RSA or ECDSA.
+             * xKeyType = mbedtls_pk_get_type( &pxKey->xKey );
+             */
+            if( NULL != pxSession->pxSignKey )
             {
-                xResult = CKR_KEY_HANDLE_INVALID;
+                prvReleaseParsedKey( pxSession->pxSignKey );
             }
-        }
 
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+            pxSession->pxSignKey = pxKey;
+        }
     }
 
     return xResult;
@@ -1286,16 +1546,25 @@ CK_DEFINE_FUNCTION( CK_RV, C_Sign )( CK_SESSION_HANDLE xSession,
              * Sign the data.
              */
 
+            if( ( CKR_OK == xResult ) && ( NULL == pxSessionObj->pxSignKey ) )
+            {
+                xResult = CKR_OPERATION_NOT_INITIALIZED;
+            }
+
             if( CKR_OK == xResult )
             {
-                BaseType_t x = mbedtls_pk_sign( &pxSessionObj->xSignKey,
+                ( void ) xSemaphoreTake( pxSessionObj->pxSignKey->xLock, portMAX_DELAY );
+
+                BaseType_t x = mbedtls_pk_sign( &pxSessionObj->pxSignKey->xKey,
                                                 MBEDTLS_MD_SHA256,
                                                 pucData,
                                                 ulDataLen,
                                                 pucSignature,
                                                 ( size_t * ) pulSignatureLen,
                                                 mbedtls_ctr_drbg_random,
-                                                &xP11Context.xMbedDrbgCtx );
+                                                prvGetDrbg() );
+
+                ( void ) xSemaphoreGive( pxSessionObj->pxSignKey->xLock );
 
                 if( x != CKR_OK )
                 {
@@ -1316,10 +1585,8 @@ CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
                                            CK_OBJECT_HANDLE xKey )
 {
     CK_RV xResult = CKR_OK;
-    CK_BBOOL xIsPrivate = CK_TRUE;
     P11SessionPtr_t pxSession;
-    uint8_t * keyData = NULL;
-    uint32_t ulKeyDataLength = 0;
+    P11ParsedKey_t * pxKey = NULL;
 
     /*lint !e9072 It's OK to have different parameter name. */
     ( void ) ( xSession );
@@ -1333,28 +1600,23 @@ CK_DEFINE_FUNCTION( CK_RV, C_VerifyInit )( CK_SESSION_HANDLE xSession,
 
     if( xResult == CKR_OK )
     {
-        xResult = PKCS11_PAL_GetObjectValue( xKey, &keyData, &ulKeyDataLength, &xIsPrivate );
+        xResult = prvAcquireParsedKey( xKey, &pxKey );
     }
 
-    if( ( xResult == CKR_OK ) && ( xIsPrivate != CK_FALSE ) )
+    if( ( xResult == CKR_OK ) && ( pxKey->xIsPrivate != CK_FALSE ) )
     {
         xResult = CKR_KEY_TYPE_INCONSISTENT;
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+        prvReleaseParsedKey( pxKey );
     }
 
     if( xResult == CKR_OK )
     {
-        mbedtls_pk_init( &pxSession->xVerifyKey );
-
-        if( 0 != mbedtls_pk_parse_public_key( &pxSession->xVerifyKey, keyData, ulKeyDataLength ) )
+        if( NULL != pxSession->pxVerifyKey )
         {
-            if( 0 != mbedtls_pk_parse_key( &pxSession->xVerifyKey, keyData, ulKeyDataLength, NULL, 0 ) )
-            {
-                xResult = CKR_KEY_HANDLE_INVALID;
-            }
+            prvReleaseParsedKey( pxSession->pxVerifyKey );
         }
 
-        PKCS11_PAL_GetObjectValueCleanup( keyData, ulKeyDataLength );
+        pxSession->pxVerifyKey = pxKey;
     }
 
     return xResult;
@@ -1386,9 +1648,11 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
         pxSessionObj = prvSessionPointerFromHandle( xSession ); /*lint !e9072 It's OK to have different parameter name. */
 
         /* Verify the signature. If a public key is present, use it. */
-        if( NULL != pxSessionObj->xVerifyKey.pk_ctx )
+        if( NULL != pxSessionObj->pxVerifyKey )
         {
-            if( 0 != mbedtls_pk_verify( &pxSessionObj->xVerifyKey,
+            ( void ) xSemaphoreTake( pxSessionObj->pxVerifyKey->xLock, portMAX_DELAY );
+
+            if( 0 != mbedtls_pk_verify( &pxSessionObj->pxVerifyKey->xKey,
                                         MBEDTLS_MD_SHA256,
                                         pucData,
                                         ulDataLen,
@@ -1397,6 +1661,8 @@ CK_DEFINE_FUNCTION( CK_RV, C_Verify )( CK_SESSION_HANDLE xSession,
             {
                 xResult = CKR_SIGNATURE_INVALID;
             }
+
+            ( void ) xSemaphoreGive( pxSessionObj->pxVerifyKey->xLock );
         }
 
         /* TODO: Deleted else. */
@@ -1463,7 +1729,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_GenerateKeyPair )( CK_SESSION_HANDLE xSession,
         if( 0 != mbedtls_ecp_gen_key( MBEDTLS_ECP_DP_SECP256R1,
                                       mbedtls_pk_ec( xCtx ),
                                       mbedtls_ctr_drbg_random,
-                                      &xP11Context.xMbedDrbgCtx ) )
+                                      prvGetDrbg() ) )
         {
             xResult = CKR_FUNCTION_FAILED;
         }
@@ -1480,6 +1746,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_GenerateKeyPair )( CK_SESSION_HANDLE xSession,
     if( xResult > 0 )
     {
         *pxPrivateKey = PKCS11_PAL_SaveObject( &pxPrivateTemplate->xLabel, pucDerFile + pkcs11KEY_GEN_MAX_DER_SIZE - xResult, xResult );
+        prvInvalidateParsedKeys();
         /* FIXME: This is a hack.*/
         *pxPublicKey = *pxPrivateKey + 1;
         xResult = CKR_OK;
@@ -1519,7 +1786,7 @@ CK_DEFINE_FUNCTION( CK_RV, C_GenerateRandom )( CK_SESSION_HANDLE xSession,
     }
     else
     {
-        if( 0 != mbedtls_ctr_drbg_random( &xP11Context.xMbedDrbgCtx, pucRandomData, ulRandomLen ) )
+        if( 0 != mbedtls_ctr_drbg_random( prvGetDrbg(), pucRandomData, ulRandomLen ) )
         {
             xResult = CKR_FUNCTION_FAILED;
         }
@@ -37,6 +37,14 @@
 #include "ff.h"
 #include "xil_printf.h"
 #include "task.h"
+#include "semphr.h"
+#include "aws_entropy.h"
+#include "aws_platform_fs.h"
+#include "xtime_l.h"
+#include "xadcps.h"
+
+/* mbedTLS includes. */
+#include "mbedtls/entropy.h"
 
 /* C runtime includes. */
 #include <stdio.h>
@@ -101,12 +109,327 @@ void prvLabelToFilenameHandle( uint8_t * pcLabel,
         }
     }
 }
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Object values are kept in RAM after they are first read. Each value
+ * is preceded by this header in a single allocation.
+ *
+ * The cache holds one reference while the value is current and every
+ * PKCS11_PAL_GetObjectValue() holds one until its
+ * PKCS11_PAL_GetObjectValueCleanup(), so saving an object while a caller
+ * still uses the old value is safe. The reference counts and the cache
+ * slots are only changed in short critical sections, file I/O is done
+ * holding the file system mutex instead.
+ */
+typedef struct PKCS11CachedObject
+{
+    uint32_t ulRefs; /**< Number of references, the value is freed when it drops to 0. */
+    uint32_t ulSize; /**< Size of the value which follows, in bytes. */
+} PKCS11CachedObject_t;
+
+/**
+ * @brief Index of an object file in the cache.
+ * The public and private key handles share the key file.
+ */
+typedef enum
+{
+    ePalCertificateSlot = 0,
+    ePalKeySlot,
+    ePalCodeSignKeySlot,
+    ePalSlotCount
+} PKCS11CacheSlot_t;
+
+/**
+ * @brief The current value of each object file, NULL when it is not cached.
+ */
+static PKCS11CachedObject_t * pxObjectCache[ ePalSlotCount ];
+
+/**
+ * @brief pdTRUE when the file of a slot was found not to exist, so that
+ * looking for an object which was never provisioned does not read the card.
+ */
+static BaseType_t xObjectAbsent[ ePalSlotCount ];
+
+/**
+ * @brief Cache counters, reported by PKCS11_PAL_GetCacheStats().
+ */
+static uint32_t ulObjectHits;
+static uint32_t ulObjectLoads;
+static uint32_t ulObjectLoadUs;
+
+/**
+ * @brief Serializes FatFs, which is built without re-entrancy.
+ */
+static SemaphoreHandle_t xFsMutex = NULL;
+static StaticSemaphore_t xFsMutexBuffer;
 
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Map an object handle to its cache slot.
+ * @return The slot, or ePalSlotCount if the handle is not valid.
+ */
+static PKCS11CacheSlot_t prvHandleToSlot( CK_OBJECT_HANDLE xHandle,
+                                          CK_BBOOL * pxIsPrivate );
+
+/**
+ * @brief Name of the file which stores the objects of a slot.
+ */
+static const char * prvSlotToFileName( PKCS11CacheSlot_t xSlot );
+
+/**
+ * @brief Read the file of a slot into a new cached object.
+ * Must be called holding the file system mutex.
+ */
+static CK_RV prvLoadObject( PKCS11CacheSlot_t xSlot,
+                            PKCS11CachedObject_t ** ppxObject );
+
+/**
+ * @brief Get a reference to the current value of a slot, reading it from
+ * the file if it is not cached.
+ */
+static CK_RV prvAcquireObject( PKCS11CacheSlot_t xSlot,
+                               PKCS11CachedObject_t ** ppxObject );
+
+/**
+ * @brief Drop a reference taken by prvAcquireObject().
+ */
+static void prvReleaseObject( PKCS11CachedObject_t * pxObject );
+
+/*-----------------------------------------------------------*/
+
+static PKCS11CacheSlot_t prvHandleToSlot( CK_OBJECT_HANDLE xHandle,
+                                          CK_BBOOL * pxIsPrivate )
+{
+    PKCS11CacheSlot_t xSlot = ePalSlotCount;
+    CK_BBOOL xIsPrivate = CK_FALSE;
+
+    if( xHandle == eAwsDeviceCertificate )
+    {
+        xSlot = ePalCertificateSlot;
+    }
+    else if( xHandle == eAwsDevicePrivateKey )
+    {
+        xSlot = ePalKeySlot;
+        xIsPrivate = CK_TRUE;
+    }
+    else if( xHandle == eAwsDevicePublicKey )
+    {
+        /* Public and private key are stored together in same file. */
+        xSlot = ePalKeySlot;
+    }
+    else if( xHandle == eAwsCodeSigningKey )
+    {
+        xSlot = ePalCodeSignKeySlot;
+    }
+
+    if( pxIsPrivate != NULL )
+    {
+        *pxIsPrivate = xIsPrivate;
+    }
+
+    return xSlot;
+}
+/*-----------------------------------------------------------*/
+
+static const char * prvSlotToFileName( PKCS11CacheSlot_t xSlot )
+{
+    const char * pcFileName;
+
+    if( xSlot == ePalCertificateSlot )
+    {
+        pcFileName = pkcs11configFILE_NAME_CLIENT_CERTIFICATE;
+    }
+    else if( xSlot == ePalKeySlot )
+    {
+        pcFileName = pkcs11configFILE_NAME_KEY;
+    }
+    else
+    {
+        pcFileName = pkcs11palFILE_CODE_SIGN_PUBLIC_KEY;
+    }
+
+    return pcFileName;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvLoadObject( PKCS11CacheSlot_t xSlot,
+                            PKCS11CachedObject_t ** ppxObject )
+{
+    static FIL fil;
+    FRESULT Res;
+    UINT n = 0;
+    XTime xStart;
+    XTime xEnd;
+    PKCS11CachedObject_t * pxObject = NULL;
+    const char * pcFileName = prvSlotToFileName( xSlot );
+    CK_RV xResult = CKR_OK;
+
+    XTime_GetTime( &xStart );
+
+    Res = f_open( &fil, pcFileName, FA_READ );
+
+    if( Res )
+    {
+        if( ( Res == FR_NO_FILE ) || ( Res == FR_NO_PATH ) )
+        {
+            xObjectAbsent[ xSlot ] = pdTRUE;
+        }
+
+        xil_printf( "PKCS11_PAL ERROR: Unable to open file %s  Res %d\r\n", pcFileName, Res );
+        return CKR_FUNCTION_FAILED;
+    }
+
+    pxObject = pvPortMalloc( sizeof( PKCS11CachedObject_t ) + fil.fsize );
+
+    if( pxObject == NULL )
+    {
+        xil_printf( "PKCS11_PAL ERROR: buf alloc failed \r\n" );
+        xResult = CKR_DEVICE_MEMORY;
+    }
+    else
+    {
+        Res = f_read( &fil, pxObject + 1, fil.fsize, &n );
+
+        if( ( n == 0 ) || ( Res != 0 ) )
+        {
+            xil_printf( "PKCS11_PAL ERROR: Read from file %s failed  Res %d\r\n", pcFileName, Res );
+            vPortFree( pxObject );
+            pxObject = NULL;
+            xResult = CKR_FUNCTION_FAILED;
+        }
+        else
+        {
+            /* One reference for the cache, one for the caller. */
+            pxObject->ulRefs = 2;
+            pxObject->ulSize = ( uint32_t ) n;
+        }
+    }
+
+    f_close( &fil );
+
+    XTime_GetTime( &xEnd );
+
+    if( xResult == CKR_OK )
+    {
+        ulObjectLoads++;
+        ulObjectLoadUs += ( uint32_t ) ( ( ( xEnd - xStart ) * 1000000ULL ) / COUNTS_PER_SECOND );
+        xObjectAbsent[ xSlot ] = pdFALSE;
+        *ppxObject = pxObject;
+    }
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static CK_RV prvAcquireObject( PKCS11CacheSlot_t xSlot,
+                               PKCS11CachedObject_t ** ppxObject )
+{
+    PKCS11CachedObject_t * pxObject;
+    CK_RV xResult = CKR_OK;
+
+    taskENTER_CRITICAL();
+    pxObject = pxObjectCache[ xSlot ];
+
+    if( pxObject != NULL )
+    {
+        pxObject->ulRefs++;
+        ulObjectHits++;
+    }
+
+    taskEXIT_CRITICAL();
+
+    if( pxObject == NULL )
+    {
+        platform_fs_lock();
+
+        /* Another task may have read the file while this one waited. */
+        taskENTER_CRITICAL();
+        pxObject = pxObjectCache[ xSlot ];
+
+        if( pxObject != NULL )
+        {
+            pxObject->ulRefs++;
+            ulObjectHits++;
+        }
+
+        taskEXIT_CRITICAL();
+
+        if( pxObject == NULL )
+        {
+            if( xObjectAbsent[ xSlot ] == pdTRUE )
+            {
+                xResult = CKR_FUNCTION_FAILED;
+            }
+            else
+            {
+                xResult = prvLoadObject( xSlot, &pxObject );
+            }
+
+            if( xResult == CKR_OK )
+            {
+                taskENTER_CRITICAL();
+                pxObjectCache[ xSlot ] = pxObject;
+                taskEXIT_CRITICAL();
+            }
+        }
+
+        platform_fs_unlock();
+    }
+
+    *ppxObject = pxObject;
+
+    return xResult;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReleaseObject( PKCS11CachedObject_t * pxObject )
+{
+    uint32_t ulRefs;
+
+    taskENTER_CRITICAL();
+    ulRefs = --pxObject->ulRefs;
+    taskEXIT_CRITICAL();
+
+    if( ulRefs == 0 )
+    {
+        vPortFree( pxObject );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read every object into RAM.
+ *
+ * Called from a task when the PKCS#11 module is initialized, so that
+ * sessions do not read the card. Objects which are already cached are not
+ * read again and objects which are not provisioned are skipped.
+ *
+ * @return CKR_OK.
+ */
+CK_RV PKCS11_PAL_Initialize( void )
+{
+    PKCS11CacheSlot_t xSlot;
+    PKCS11CachedObject_t * pxObject;
+
+    for( xSlot = ePalCertificateSlot; xSlot < ePalSlotCount; xSlot++ )
+    {
+        if( prvAcquireObject( xSlot, &pxObject ) == CKR_OK )
+        {
+            prvReleaseObject( pxObject );
+        }
+    }
+
+    return CKR_OK;
+}
+/*-----------------------------------------------------------*/
 
 /**
  * @brief Saves an object in non-volatile storage.
  *
- * Port-specific file write for cryptographic information.
+ * Port-specific file write for cryptographic information. The cached value
+ * of the object is replaced by the new one.
  *
  * @param[in] pxLabel       The label of the object to be stored.
  * @param[in] pucData       The object data to be saved
@@ -124,6 +447,9 @@ CK_OBJECT_HANDLE PKCS11_PAL_SaveObject( CK_ATTRIBUTE_PTR pxLabel,
     uint32_t n;
     uint8_t * pcFileName;
     CK_OBJECT_HANDLE xHandle;
+    PKCS11CacheSlot_t xSlot;
+    PKCS11CachedObject_t * pxNew = NULL;
+    PKCS11CachedObject_t * pxOld;
 
     prvLabelToFilenameHandle( pxLabel->pValue,
                               &pcFileName,
@@ -131,12 +457,13 @@ CK_OBJECT_HANDLE PKCS11_PAL_SaveObject( CK_ATTRIBUTE_PTR pxLabel,
 
     if( xHandle != eInvalidHandle )
     {
-        taskENTER_CRITICAL();
+        xSlot = prvHandleToSlot( xHandle, NULL );
+
+        platform_fs_lock();
         Res = f_open( &fil, pcFileName, FA_CREATE_ALWAYS | FA_WRITE );
 
         if( Res )
         {
-            taskEXIT_CRITICAL();
             xil_printf( "PKCS11_PAL_SaveObject ERROR: Unable to open file %s  Res %d\r\n", pcFileName, Res );
             xHandle = eInvalidHandle;
         }
@@ -144,7 +471,6 @@ CK_OBJECT_HANDLE PKCS11_PAL_SaveObject( CK_ATTRIBUTE_PTR pxLabel,
         {
             Res = f_write( &fil, pucData, ulDataSize, ( UINT * ) ( &n ) );
             f_close( &fil );
-            taskEXIT_CRITICAL();
 
             if( ( n < ulDataSize ) || ( Res != 0 ) )
             {
@@ -152,6 +478,33 @@ CK_OBJECT_HANDLE PKCS11_PAL_SaveObject( CK_ATTRIBUTE_PTR pxLabel,
                 xHandle = eInvalidHandle;
             }
         }
+
+        /* Cache the new value. If it cannot be cached, or the file is in an
+         * unknown state, the next access reads the file again. */
+        if( xHandle != eInvalidHandle )
+        {
+            pxNew = pvPortMalloc( sizeof( PKCS11CachedObject_t ) + ulDataSize );
+
+            if( pxNew != NULL )
+            {
+                pxNew->ulRefs = 1;
+                pxNew->ulSize = ulDataSize;
+                memcpy( pxNew + 1, pucData, ulDataSize );
+            }
+        }
+
+        taskENTER_CRITICAL();
+        pxOld = pxObjectCache[ xSlot ];
+        pxObjectCache[ xSlot ] = pxNew;
+        xObjectAbsent[ xSlot ] = pdFALSE;
+        taskEXIT_CRITICAL();
+
+        platform_fs_unlock();
+
+        if( pxOld != NULL )
+        {
+            prvReleaseObject( pxOld );
+        }
     }
 
     return xHandle;
@@ -176,8 +529,9 @@ CK_OBJECT_HANDLE PKCS11_PAL_FindObject( uint8_t * pLabel,
 {
     CK_OBJECT_HANDLE xHandle = eInvalidHandle;
     uint8_t * pcFileName = NULL;
-    static FIL fil;
-    FRESULT Res;
+    PKCS11CachedObject_t * pxObject;
+
+    ( void ) usLength;
 
     /* Converts a label to its respective filename and handle. */
     prvLabelToFilenameHandle( pLabel,
@@ -185,20 +539,19 @@ CK_OBJECT_HANDLE PKCS11_PAL_FindObject( uint8_t * pLabel,
                               &xHandle );
 
     /* Check if object exists/has been created before returning. */
-    taskENTER_CRITICAL();
-
-    Res = f_open( &fil, ( TCHAR * ) pcFileName, FA_READ );
-
-    if( Res )
+    if( xHandle != eInvalidHandle )
     {
-        taskEXIT_CRITICAL();
-        xil_printf( "PKCS11_PAL_FindObject ERROR: File %s does not exist\r\n", pcFileName );
-        return eInvalidHandle;
+        if( prvAcquireObject( prvHandleToSlot( xHandle, NULL ), &pxObject ) == CKR_OK )
+        {
+            prvReleaseObject( pxObject );
+        }
+        else
+        {
+            xil_printf( "PKCS11_PAL_FindObject ERROR: File %s does not exist\r\n", pcFileName );
+            xHandle = eInvalidHandle;
+        }
     }
 
-    f_close( &fil );
-    taskEXIT_CRITICAL();
-
     return xHandle;
 }
 
@@ -207,14 +560,13 @@ CK_OBJECT_HANDLE PKCS11_PAL_FindObject( uint8_t * pLabel,
  *
  * Port-specific file access for cryptographic information.
  *
- * This call dynamically allocates the buffer which object value
- * data is copied into.  PKCS11_PAL_GetObjectValueCleanup()
- * should be called after each use to free the dynamically allocated
- * buffer.
+ * The returned buffer is the cached value of the object and must not be
+ * modified. PKCS11_PAL_GetObjectValueCleanup() must be called after each
+ * use to release it.
  *
  * @sa PKCS11_PAL_GetObjectValueCleanup
  *
- * @param[in] pcFileName    The name of the file to be read.
+ * @param[in] xHandle       The handle of the object.
  * @param[out] ppucData     Pointer to buffer for file data.
  * @param[out] pulDataSize  Size (in bytes) of data located in file.
  * @param[out] pIsPrivate   Boolean indicating if value is private (CK_TRUE)
@@ -230,94 +582,35 @@ CK_RV PKCS11_PAL_GetObjectValue( CK_OBJECT_HANDLE xHandle,
                                  uint32_t * pulDataSize,
                                  CK_BBOOL * pIsPrivate )
 {
-    CK_RV ulReturn = CKR_OK;
-    FRESULT Res;
-    static FIL fil;
-    uint32_t n;
-    uint8_t * buf;
-    char * pcFileName = NULL;
-
-    if( xHandle == eAwsDeviceCertificate )
-    {
-        pcFileName = pkcs11configFILE_NAME_CLIENT_CERTIFICATE;
-        *pIsPrivate = CK_FALSE;
-    }
-    else if( xHandle == eAwsDevicePrivateKey )
-    {
-        pcFileName = pkcs11configFILE_NAME_KEY;
-        *pIsPrivate = CK_TRUE;
-    }
-    else if( xHandle == eAwsDevicePublicKey )
-    {
-        /* Public and private key are stored together in same file. */
-        pcFileName = pkcs11configFILE_NAME_KEY;
-        *pIsPrivate = CK_FALSE;
-    }
-    else if( xHandle == eAwsCodeSigningKey )
-    {
-        pcFileName = pkcs11palFILE_CODE_SIGN_PUBLIC_KEY;
-        *pIsPrivate = CK_FALSE;
-    }
-    else
-    {
-        return CKR_KEY_HANDLE_INVALID;
-    }
-
-    taskENTER_CRITICAL();
-
-    Res = f_open( &fil, pcFileName, FA_READ );
-
-    if( Res )
-    {
-        taskEXIT_CRITICAL();
-        xil_printf( "PKCS11_PAL_GetObjectValue ERROR: Unable to open file %s  Res %d\r\n", pcFileName, Res );
-        return CKR_FUNCTION_FAILED;
-    }
+    CK_RV ulReturn;
+    PKCS11CacheSlot_t xSlot;
+    PKCS11CachedObject_t * pxObject;
 
-    n = fil.fsize;
-    buf = pvPortMalloc( n );
+    xSlot = prvHandleToSlot( xHandle, pIsPrivate );
 
-    if( buf == NULL )
+    if( xSlot == ePalSlotCount )
     {
-        taskEXIT_CRITICAL();
-        xil_printf( "PKCS11_PAL_GetObjectValue ERROR: buf alloc failed \r\n" );
-        return CKR_DEVICE_MEMORY;
+        return CKR_KEY_HANDLE_INVALID;
     }
 
-    Res = f_read( &fil, buf, n, ( UINT * ) pulDataSize );
+    ulReturn = prvAcquireObject( xSlot, &pxObject );
 
-    if( ( *pulDataSize == 0 ) || ( Res != 0 ) )
+    if( ulReturn == CKR_OK )
     {
-        f_close( &fil );
-        vPortFree( buf );
-        taskEXIT_CRITICAL();
-        xil_printf( "PKCS11_PAL_GetObjectValue ERROR: Read from file %s failed  Res %d\r\n", pcFileName, Res );
-        return CKR_FUNCTION_FAILED;
-    }
-
-    if( Res != 0 )
-    {
-        f_close( &fil );
-        vPortFree( buf );
-        taskEXIT_CRITICAL();
-        xil_printf( "PKCS11_PAL_GetObjectValue ERROR: Decryption of file %s failed  Res %d\r\n", pcFileName, Res );
-        return CKR_FUNCTION_FAILED;
+        *ppucData = ( uint8_t * ) ( pxObject + 1 );
+        *pulDataSize = pxObject->ulSize;
     }
 
-    *ppucData = buf;
-    f_close( &fil );
-    taskEXIT_CRITICAL();
-
-    return CKR_OK;
+    return ulReturn;
 }
 
 
 /**
  * @brief Cleanup after PKCS11_GetObjectValue().
  *
- * @param[in] pucData       The buffer to free.
+ * @param[in] pucData       The buffer to release.
  *                          (*ppucData from PKCS11_PAL_GetObjectValue())
- * @param[in] ulDataSize    The length of the buffer to free.
+ * @param[in] ulDataSize    The length of the buffer to release.
  *                          (*pulDataSize from PKCS11_PAL_GetObjectValue())
  */
 void PKCS11_PAL_GetObjectValueCleanup( uint8_t * pucData,
@@ -328,50 +621,245 @@ void PKCS11_PAL_GetObjectValueCleanup( uint8_t * pucData,
 
     if( NULL != pucData )
     {
-        vPortFree( pucData );
+        prvReleaseObject( ( ( PKCS11CachedObject_t * ) pucData ) - 1 );
+    }
+}
+
+
+/**
+ * @brief Fill in the object cache counters.
+ *
+ * @param[out] pxStats Counters of the object cache, the key counters are
+ * left untouched.
+ */
+void PKCS11_PAL_GetCacheStats( PKCS11_CacheStats_t * pxStats )
+{
+    taskENTER_CRITICAL();
+    pxStats->ulObjectHits = ulObjectHits;
+    pxStats->ulObjectLoads = ulObjectLoads;
+    pxStats->ulObjectLoadUs = ulObjectLoadUs;
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The XADC, read through the PS-XADC interface.
+ */
+static XAdcPs xAdc;
+
+/**
+ * @brief pdTRUE once the XADC is configured and the noise source passed its
+ * start-up test.
+ */
+static BaseType_t xEntropyReady = pdFALSE;
+
+/**
+ * @brief Health test state of the noise source.
+ */
+static EntropyHealth_t xEntropyHealth;
+
+/**
+ * @brief One block of raw samples. mbedTLS polls the source holding the
+ * mutex of its entropy context, so a single buffer is enough.
+ */
+static uint8_t ucEntropySamples[ entropyconfigSAMPLES_PER_BLOCK ];
+
+/**
+ * @brief Configure the XADC, on first use.
+ * @return pdPASS if the XADC can be read.
+ */
+static BaseType_t prvEntropySourceInit( void )
+{
+    static BaseType_t xAdcReady = pdFALSE;
+    XAdcPs_Config * pxConfig;
+
+    if( xAdcReady == pdFALSE )
+    {
+        pxConfig = XAdcPs_LookupConfig( XPAR_XADCPS_0_DEVICE_ID );
+
+        /* The default sequence converts the temperature and the supply
+         * voltages continuously. */
+        if( ( pxConfig != NULL ) &&
+            ( XAdcPs_CfgInitialize( &xAdc, pxConfig, pxConfig->BaseAddress ) == XST_SUCCESS ) )
+        {
+            xAdcReady = pdTRUE;
+        }
+        else
+        {
+            xil_printf( "PKCS11_PAL ERROR: XADC initialization failed\r\n" );
+        }
     }
+
+    return xAdcReady;
 }
 
+/**
+ * @brief Read one raw noise sample.
+ *
+ * The low 4 bits are the least significant bits of an XADC conversion,
+ * rotating over the on-chip sensors, which carry thermal and quantization
+ * noise. The high 4 bits are the low bits of the global timer count it took
+ * to read the conversion through the PS-XADC FIFO, whose clock is not
+ * related to the CPU clock. The Zynq PS has no ring oscillator without
+ * logic in the PL, the read jitter stands in for it.
+ */
+static uint8_t prvSampleNoise( void )
+{
+    static const uint8_t ucChannels[] =
+    {
+        XADCPS_CH_TEMP, XADCPS_CH_VCCINT, XADCPS_CH_VCCAUX, XADCPS_CH_VCCPINT
+    };
+    static uint32_t ulChannel = 0;
+    XTime xStart;
+    XTime xEnd;
+    uint16_t usConversion;
+
+    XTime_GetTime( &xStart );
+    usConversion = XAdcPs_GetAdcData( &xAdc, ucChannels[ ulChannel ] );
+    XTime_GetTime( &xEnd );
+
+    ulChannel = ( ulChannel + 1UL ) % ( sizeof( ucChannels ) / sizeof( ucChannels[ 0 ] ) );
+
+    /* The 12-bit conversion is held in bits 15:4 of the register. */
+    return ( uint8_t ) ( ( ( usConversion >> 4 ) & 0x0FU ) |
+                         ( ( ( uint32_t ) ( xEnd - xStart ) & 0x0FUL ) << 4 ) );
+}
+
+/**
+ * @brief Read raw samples from the XADC and global timer noise source.
+ */
+BaseType_t ENTROPY_ReadRawSamples( uint8_t * pucSamples,
+                                   size_t xCount )
+{
+    size_t xIndex;
+
+    if( prvEntropySourceInit() != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    for( xIndex = 0; xIndex < xCount; xIndex++ )
+    {
+        pucSamples[ xIndex ] = prvSampleNoise();
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
 
+/**
+ * @brief mbedTLS hardware entropy source.
+ *
+ * Returns one block of conditioned output, health tested as described in
+ * aws_entropy.h. The source runs its start-up test on first use. If
+ * entropyconfigMAX_FAILED_BLOCKS blocks in a row fail the health tests, no
+ * output is returned and seeding or reseeding a DRBG fails.
+ */
 int mbedtls_hardware_poll( void * data,
                            unsigned char * output,
                            size_t len,
                            size_t * olen )
 {
+    uint8_t ucBlock[ entropyOUTPUT_BYTES ];
+    uint32_t ulIndex;
+    uint32_t ulFailedBlocks = 0;
+    BaseType_t xStatus = pdFAIL;
+
     ( void ) data;
 
-    int copylen = len;
-    int size;
-    int entropy;
+    *olen = 0;
 
-    size = sizeof( entropy );
+    if( xEntropyReady == pdFALSE )
+    {
+        if( prvEntropySourceInit() == pdPASS )
+        {
+            /* Start-up test, the samples are discarded. */
+            ENTROPY_HealthInit( &xEntropyHealth );
+            xEntropyReady = pdTRUE;
+
+            for( ulIndex = 0; ulIndex < ( uint32_t ) entropyconfigSTARTUP_SAMPLES; ulIndex++ )
+            {
+                if( ENTROPY_HealthTest( &xEntropyHealth, prvSampleNoise() ) != pdPASS )
+                {
+                    xEntropyReady = pdFALSE;
+                }
+            }
+        }
 
-    while( copylen > 0 )
+        if( xEntropyReady == pdFALSE )
+        {
+            xil_printf( "PKCS11_PAL ERROR: Entropy source failed its start-up test\r\n" );
+            return MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+        }
+    }
+
+    while( ( xStatus != pdPASS ) && ( ulFailedBlocks < ( uint32_t ) entropyconfigMAX_FAILED_BLOCKS ) )
     {
-        entropy = rand();
+        for( ulIndex = 0; ulIndex < ( uint32_t ) entropyconfigSAMPLES_PER_BLOCK; ulIndex++ )
+        {
+            ucEntropySamples[ ulIndex ] = prvSampleNoise();
+        }
+
+        xStatus = ENTROPY_Condition( &xEntropyHealth, ucEntropySamples, ucBlock );
 
-        if( entropy == 0 )
+        if( xStatus != pdPASS )
         {
-            xil_printf( "Error RAND is returning 0 at copylen 0x%x \n\r", copylen );
+            ulFailedBlocks++;
         }
+    }
 
-        memcpy( output, &entropy, size );
-        output += size;
-        copylen -= size;
+    if( xStatus != pdPASS )
+    {
+        xil_printf( "PKCS11_PAL ERROR: Entropy source failed its health tests, RCT %u APT %u\r\n",
+                    xEntropyHealth.ulRctFailures,
+                    xEntropyHealth.ulAptFailures );
+        return MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
     }
 
-    *olen = len;
+    /* mbedTLS polls again until it has gathered enough. */
+    *olen = ( len < sizeof( ucBlock ) ) ? len : sizeof( ucBlock );
+    memcpy( output, ucBlock, *olen );
+    memset( ucBlock, 0, sizeof( ucBlock ) );
 
     return 0;
 }
+/*-----------------------------------------------------------*/
 
+/**
+ * @brief Take the mutex which serializes all FatFs calls.
+ * FatFs is not re-entrant, every task accessing the card must hold it.
+ */
+void platform_fs_lock( void )
+{
+    if( xFsMutex != NULL )
+    {
+        ( void ) xSemaphoreTake( xFsMutex, portMAX_DELAY );
+    }
+}
 
-int platform_init_fs()
+/**
+ * @brief Give the mutex taken by platform_fs_lock().
+ */
+void platform_fs_unlock( void )
+{
+    if( xFsMutex != NULL )
+    {
+        ( void ) xSemaphoreGive( xFsMutex );
+    }
+}
+
+
+int platform_init_fs( void )
 {
     static FATFS fatfs;
     FRESULT Res;
     TCHAR * Path = "0:/";
 
+    if( xFsMutex == NULL )
+    {
+        xFsMutex = xSemaphoreCreateMutexStatic( &xFsMutexBuffer );
+    }
+
     /*
      * Register volume work area, initialize device
      */
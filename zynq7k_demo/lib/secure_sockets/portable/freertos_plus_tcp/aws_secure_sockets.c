@@ -32,8 +32,13 @@
 #include "aws_secure_sockets.h"
 #include "aws_tls.h"
 #include "task.h"
+#include "semphr.h"
 #include "aws_pkcs11.h"
 #include "aws_crypto.h"
+#include "aws_static_memory.h"
+
+/* Standard includes. */
+#include <string.h>
 
 /* Internal context structure. */
 typedef struct SSOCKETContext
@@ -49,8 +54,44 @@ typedef struct SSOCKETContext
     char ** ppcAlpnProtocols;
     uint32_t ulAlpnProtocolsCount;
     BaseType_t xConnectAttempted;
+    BaseType_t xCoalesceWrites;
+
+    /* Options to apply again if a standby connection is adopted. */
+    TickType_t xRecvTimeout;
+    TickType_t xSendTimeout;
+    void * pvWakeupCallback;
+    BaseType_t xOtherOptionsSet;
+
+    /* Standby endpoint matched by SOCKETS_Connect(), -1 if none. */
+    int32_t lStandbyEndpoint;
+    BaseType_t xStandbyAdopted;
+    BaseType_t xFirstByteReceived;
+    TickType_t xConnectTime;
 } SSOCKETContext_t, * SSOCKETContextPtr_t;
 
+#if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+
+/*
+ * @brief Hands a ready standby connection matching the socket's options to
+ * the socket, and starts its time to first byte.
+ *
+ * @return pdTRUE if the socket is now connected.
+ */
+    static BaseType_t prvStandbyTake( SSOCKETContextPtr_t pxContext,
+                                      const SocketsSockaddr_t * pxAddress );
+
+/*
+ * @brief Records the time to first byte of a socket matched to a standby
+ * endpoint.
+ */
+    static void prvStandbyFirstByte( SSOCKETContextPtr_t pxContext );
+
+/*
+ * @brief Creates the mutex guarding the standby endpoints.
+ */
+    static void prvStandbyInit( void );
+#endif
+
 /*
  * Helper routines.
  */
@@ -82,73 +123,50 @@ static BaseType_t prvNetworkRecv( void * pvContext,
 /*-----------------------------------------------------------*/
 
 /*
- * Interface routines.
+ * @brief Frees the copies of the socket options.
  */
-
-int32_t SOCKETS_Close( Socket_t xSocket )
+static void prvFreeOptions( SSOCKETContextPtr_t pxContext )
 {
-    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
     uint32_t ulProtocol;
-    int32_t lReturn;
 
-    if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( NULL != pxContext ) )
+    /* Clean-up destination string. */
+    if( NULL != pxContext->pcDestination )
     {
-        /* Clean-up destination string. */
-        if( NULL != pxContext->pcDestination )
-        {
-            vPortFree( pxContext->pcDestination );
-        }
+        vPortFree( pxContext->pcDestination );
+    }
 
-        /* Clean-up server certificate. */
-        if( NULL != pxContext->pcServerCertificate )
-        {
-            vPortFree( pxContext->pcServerCertificate );
-        }
+    /* Clean-up server certificate. */
+    if( NULL != pxContext->pcServerCertificate )
+    {
+        vPortFree( pxContext->pcServerCertificate );
+    }
 
-        /* Clean-up application protocol array. */
-        if( NULL != pxContext->ppcAlpnProtocols )
+    /* Clean-up application protocol array. */
+    if( NULL != pxContext->ppcAlpnProtocols )
+    {
+        for( ulProtocol = 0;
+             ulProtocol < pxContext->ulAlpnProtocolsCount;
+             ulProtocol++ )
         {
-            for( ulProtocol = 0;
-                 ulProtocol < pxContext->ulAlpnProtocolsCount;
-                 ulProtocol++ )
+            if( NULL != pxContext->ppcAlpnProtocols[ ulProtocol ] )
             {
-                if( NULL != pxContext->ppcAlpnProtocols[ ulProtocol ] )
-                {
-                    vPortFree( pxContext->ppcAlpnProtocols[ ulProtocol ] );
-                }
+                vPortFree( pxContext->ppcAlpnProtocols[ ulProtocol ] );
             }
-
-            vPortFree( pxContext->ppcAlpnProtocols );
         }
 
-        /* Clean-up TLS context. */
-        if( pdTRUE == pxContext->xRequireTLS )
-        {
-            TLS_Cleanup( pxContext->pvTLSContext );
-        }
-
-        /* Close the underlying socket handle. */
-        ( void ) FreeRTOS_closesocket( pxContext->xSocket );
-
-        /* Free the context. */
-        vPortFree( pxContext );
-        lReturn = SOCKETS_ERROR_NONE;
-    }
-    else
-    {
-        lReturn = SOCKETS_EINVAL;
+        vPortFree( pxContext->ppcAlpnProtocols );
     }
-
-    return lReturn;
 }
 /*-----------------------------------------------------------*/
 
-int32_t SOCKETS_Connect( Socket_t xSocket,
-                         SocketsSockaddr_t * pxAddress,
-                         Socklen_t xAddressLength )
+/*
+ * @brief Connects the wrapped socket and negotiates TLS if requested.
+ */
+static int32_t prvConnect( SSOCKETContextPtr_t pxContext,
+                           SocketsSockaddr_t * pxAddress,
+                           Socklen_t xAddressLength )
 {
     int32_t lStatus = SOCKETS_ERROR_NONE;
-    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
     TLSParams_t xTLSParams = { 0 };
     struct freertos_sockaddr xTempAddress = { 0 };
 
@@ -177,6 +195,7 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
             xTLSParams.pvCallerContext = pxContext;
             xTLSParams.pxNetworkRecv = prvNetworkRecv;
             xTLSParams.pxNetworkSend = prvNetworkSend;
+            xTLSParams.xCoalesceWrites = pxContext->xCoalesceWrites;
             lStatus = TLS_Init( &pxContext->pvTLSContext, &xTLSParams );
 
             if( SOCKETS_ERROR_NONE == lStatus )
@@ -199,6 +218,68 @@ int32_t SOCKETS_Connect( Socket_t xSocket,
 }
 /*-----------------------------------------------------------*/
 
+/*
+ * Interface routines.
+ */
+
+int32_t SOCKETS_Close( Socket_t xSocket )
+{
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+    int32_t lReturn;
+
+    if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( NULL != pxContext ) )
+    {
+        /* Clean-up the copies of the options. */
+        prvFreeOptions( pxContext );
+
+        /* Clean-up TLS context. */
+        if( pdTRUE == pxContext->xRequireTLS )
+        {
+            TLS_Cleanup( pxContext->pvTLSContext );
+        }
+
+        /* Close the underlying socket handle. */
+        ( void ) FreeRTOS_closesocket( pxContext->xSocket );
+
+        /* Free the context. */
+        vPortFree( pxContext );
+        lReturn = SOCKETS_ERROR_NONE;
+    }
+    else
+    {
+        lReturn = SOCKETS_EINVAL;
+    }
+
+    return lReturn;
+}
+/*-----------------------------------------------------------*/
+
+int32_t SOCKETS_Connect( Socket_t xSocket,
+                         SocketsSockaddr_t * pxAddress,
+                         Socklen_t xAddressLength )
+{
+    int32_t lStatus = SOCKETS_ERROR_NONE;
+    SSOCKETContextPtr_t pxContext = ( SSOCKETContextPtr_t ) xSocket; /*lint !e9087 cast used for portability. */
+
+    #if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+        if( ( pxContext != SOCKETS_INVALID_SOCKET ) &&
+            ( pxAddress != NULL ) &&
+            ( pdTRUE == prvStandbyTake( pxContext, pxAddress ) ) )
+        {
+            /* Connected by a standby connection. */
+        }
+        else
+        {
+            lStatus = prvConnect( pxContext, pxAddress, xAddressLength );
+        }
+    #else
+        lStatus = prvConnect( pxContext, pxAddress, xAddressLength );
+    #endif
+
+    return lStatus;
+}
+/*-----------------------------------------------------------*/
+
 uint32_t SOCKETS_GetHostByName( const char * pcHostName )
 {
     return FreeRTOS_gethostbyname( pcHostName );
@@ -222,6 +303,13 @@ int32_t SOCKETS_Recv( Socket_t xSocket,
         {
             /* Receive through TLS pipe, if negotiated. */
             lStatus = TLS_Recv( pxContext->pvTLSContext, pvBuffer, xBufferLength );
+
+            #if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+                if( lStatus > 0 )
+                {
+                    prvStandbyFirstByte( pxContext );
+                }
+            #endif
         }
         else
         {
@@ -397,6 +485,39 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
 
                 break;
 
+            case SOCKETS_SO_TLS_COALESCE:
+
+                /* Do not change how writes are sent if the socket is possibly already connected. */
+                if( pxContext->xConnectAttempted == pdTRUE )
+                {
+                    lStatus = SOCKETS_EISCONN;
+                }
+                else
+                {
+                    pxContext->xCoalesceWrites = pdTRUE;
+                }
+
+                break;
+
+            case SOCKETS_SO_TLS_FLUSH:
+
+                /* Nothing is coalesced without TLS. */
+                if( NULL != pxContext->pvTLSContext )
+                {
+                    lStatus = TLS_Flush( pxContext->pvTLSContext );
+
+                    if( lStatus > 0 )
+                    {
+                        lStatus = SOCKETS_EWOULDBLOCK;
+                    }
+                    else if( lStatus < 0 )
+                    {
+                        lStatus = SOCKETS_TLS_SEND_ERROR;
+                    }
+                }
+
+                break;
+
             case SOCKETS_SO_NONBLOCK:
                 xTimeout = 0;
 
@@ -436,6 +557,15 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                     xTimeout = portMAX_DELAY;
                 }
 
+                if( lOptionName == SOCKETS_SO_RCVTIMEO )
+                {
+                    pxContext->xRecvTimeout = xTimeout;
+                }
+                else
+                {
+                    pxContext->xSendTimeout = xTimeout;
+                }
+
                 lStatus = FreeRTOS_setsockopt( pxContext->xSocket,
                                                lLevel,
                                                lOptionName,
@@ -443,7 +573,19 @@ int32_t SOCKETS_SetSockOpt( Socket_t xSocket,
                                                xOptionLength );
                 break;
 
+            case SOCKETS_SO_WAKEUP_CALLBACK:
+                pxContext->pvWakeupCallback = ( void * ) pvOptionValue;
+                lStatus = FreeRTOS_setsockopt( pxContext->xSocket,
+                                               lLevel,
+                                               lOptionName,
+                                               pvOptionValue,
+                                               xOptionLength );
+                break;
+
             default:
+                /* A standby connection cannot be given options which must
+                 * be set before the connection is made. */
+                pxContext->xOtherOptionsSet = pdTRUE;
                 lStatus = FreeRTOS_setsockopt( pxContext->xSocket,
                                                lLevel,
                                                lOptionName,
@@ -469,6 +611,14 @@ int32_t SOCKETS_Shutdown( Socket_t xSocket,
 
     if( ( xSocket != SOCKETS_INVALID_SOCKET ) && ( xSocket != NULL ) )
     {
+        /* Coalesced writes can no longer be sent once the connection is
+         * shut down for writing. */
+        if( ( NULL != pxContext->pvTLSContext ) &&
+            ( SOCKETS_SHUT_RD != ulHow ) )
+        {
+            ( void ) TLS_Flush( pxContext->pvTLSContext );
+        }
+
         lReturn = FreeRTOS_shutdown( pxContext->xSocket, ( BaseType_t ) ulHow );
     }
     else
@@ -508,6 +658,7 @@ Socket_t SOCKETS_Socket( int32_t lDomain,
         {
             memset( pxContext, 0, sizeof( SSOCKETContext_t ) );
             pxContext->xSocket = xSocket;
+            pxContext->lStandbyEndpoint = -1;
         }
     }
     else
@@ -521,7 +672,10 @@ Socket_t SOCKETS_Socket( int32_t lDomain,
 
 BaseType_t SOCKETS_Init( void )
 {
-    /* Empty initialization for this port. */
+    #if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+        prvStandbyInit();
+    #endif
+
     return pdPASS;
 }
 /*-----------------------------------------------------------*/
@@ -722,3 +876,770 @@ uint32_t ulApplicationGetNextSequenceNumber( uint32_t ulSourceAddress,
     return ulNextSequenceNumber;
 }
 /*-----------------------------------------------------------*/
+
+/*
+ * Standby connections.
+ */
+
+#if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+
+/**
+ * @brief Converts a tick count to milliseconds.
+ */
+    #define socketsTICKS_TO_MS( xTicks )    ( ( uint32_t ) ( ( ( uint64_t ) ( xTicks ) * 1000ULL ) / ( uint64_t ) configTICK_RATE_HZ ) )
+
+/**
+ * @brief An endpoint and its standby connection.
+ */
+    typedef struct SocketsStandby
+    {
+        SocketsStandbyEndpoint_t xEndpoint; /**< Copy of the endpoint, owned by the standby. */
+        uint32_t ulAddress;                 /**< Server address found by the last attempt. */
+        SSOCKETContextPtr_t pxReady;        /**< Connected standby socket, NULL if none. */
+        TickType_t xOpenedAt;               /**< Tick count at which pxReady was connected. */
+        TimeOut_t xRetryTimeOut;            /**< Start of the backoff. */
+        TickType_t xRetryTicks;             /**< Backoff remaining. */
+        uint32_t ulBackoffMs;               /**< Current backoff, 0 after a success. */
+        SocketsStandbyStats_t xStats;       /**< Counters. */
+    } SocketsStandby_t;
+
+    static SocketsStandby_t xStandbys[ socketsconfigSTANDBY_MAX_ENDPOINTS ] staticmemSECTION( sockets );
+
+/**
+ * @brief Number of endpoints in xStandbys. It only grows, and a slot is
+ * filled in before it is counted.
+ */
+    static UBaseType_t uxStandbyCount;
+
+/**
+ * @brief Guards xStandbys, held only for short non-blocking operations.
+ */
+    static SemaphoreHandle_t xStandbyMutex;
+
+    static TaskHandle_t xStandbyTask;
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+        static StaticSemaphore_t xStandbyMutexBuffer staticmemSECTION( sockets );
+        static StaticTask_t xStandbyTaskBuffer staticmemSECTION( sockets );
+        static StackType_t xStandbyTaskStack[ socketsconfigSTANDBY_TASK_STACK_SIZE ] staticmemSECTION( sockets );
+    #endif
+
+/*-----------------------------------------------------------*/
+
+    static void prvStandbyInit( void )
+    {
+        if( NULL == xStandbyMutex )
+        {
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xStandbyMutex = xSemaphoreCreateMutexStatic( &xStandbyMutexBuffer );
+            #else
+                xStandbyMutex = xSemaphoreCreateMutex();
+            #endif
+            configASSERT( xStandbyMutex != NULL );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvEndpointFree( SocketsStandbyEndpoint_t * pxEndpoint )
+    {
+        uint32_t ulProtocol;
+
+        if( NULL != pxEndpoint->pcHostName )
+        {
+            vPortFree( ( void * ) pxEndpoint->pcHostName );
+        }
+
+        if( NULL != pxEndpoint->pcServerCertificate )
+        {
+            vPortFree( ( void * ) pxEndpoint->pcServerCertificate );
+        }
+
+        if( NULL != pxEndpoint->ppcAlpnProtocols )
+        {
+            for( ulProtocol = 0; ulProtocol < pxEndpoint->ulAlpnProtocolsCount; ulProtocol++ )
+            {
+                if( NULL != pxEndpoint->ppcAlpnProtocols[ ulProtocol ] )
+                {
+                    vPortFree( ( void * ) pxEndpoint->ppcAlpnProtocols[ ulProtocol ] );
+                }
+            }
+
+            vPortFree( ( void * ) pxEndpoint->ppcAlpnProtocols );
+        }
+
+        memset( pxEndpoint, 0, sizeof( SocketsStandbyEndpoint_t ) );
+    }
+/*-----------------------------------------------------------*/
+
+    static char * prvStringCopy( const char * pcString,
+                                 size_t xLength )
+    {
+        char * pcCopy = ( char * ) pvPortMalloc( xLength + 1U );
+
+        if( NULL != pcCopy )
+        {
+            memcpy( pcCopy, pcString, xLength );
+            pcCopy[ xLength ] = '\0';
+        }
+
+        return pcCopy;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvEndpointCopy( SocketsStandbyEndpoint_t * pxCopy,
+                                       const SocketsStandbyEndpoint_t * pxEndpoint )
+    {
+        BaseType_t xStatus = pdPASS;
+        const char ** ppcAlpnCopy = NULL;
+        uint32_t ulProtocol;
+
+        *pxCopy = *pxEndpoint;
+        pxCopy->pcServerCertificate = NULL;
+        pxCopy->ppcAlpnProtocols = NULL;
+        pxCopy->pcHostName = prvStringCopy( pxEndpoint->pcHostName, strlen( pxEndpoint->pcHostName ) );
+
+        if( NULL == pxCopy->pcHostName )
+        {
+            xStatus = pdFAIL;
+        }
+
+        if( ( pdPASS == xStatus ) && ( NULL != pxEndpoint->pcServerCertificate ) )
+        {
+            pxCopy->pcServerCertificate = pvPortMalloc( pxEndpoint->ulServerCertificateLength );
+
+            if( NULL == pxCopy->pcServerCertificate )
+            {
+                xStatus = pdFAIL;
+            }
+            else
+            {
+                memcpy( ( void * ) pxCopy->pcServerCertificate,
+                        pxEndpoint->pcServerCertificate,
+                        pxEndpoint->ulServerCertificateLength );
+            }
+        }
+
+        if( ( pdPASS == xStatus ) && ( NULL != pxEndpoint->ppcAlpnProtocols ) )
+        {
+            ppcAlpnCopy = ( const char ** ) pvPortMalloc( pxEndpoint->ulAlpnProtocolsCount * sizeof( char * ) );
+
+            if( NULL == ppcAlpnCopy )
+            {
+                xStatus = pdFAIL;
+            }
+            else
+            {
+                memset( ppcAlpnCopy, 0, pxEndpoint->ulAlpnProtocolsCount * sizeof( char * ) );
+                pxCopy->ppcAlpnProtocols = ppcAlpnCopy;
+            }
+
+            for( ulProtocol = 0;
+                 ( ulProtocol < pxEndpoint->ulAlpnProtocolsCount ) && ( pdPASS == xStatus );
+                 ulProtocol++ )
+            {
+                ppcAlpnCopy[ ulProtocol ] = prvStringCopy( pxEndpoint->ppcAlpnProtocols[ ulProtocol ],
+                                                           strlen( pxEndpoint->ppcAlpnProtocols[ ulProtocol ] ) );
+
+                if( NULL == ppcAlpnCopy[ ulProtocol ] )
+                {
+                    xStatus = pdFAIL;
+                }
+            }
+        }
+        else
+        {
+            pxCopy->ulAlpnProtocolsCount = 0;
+        }
+
+        if( pdFAIL == xStatus )
+        {
+            prvEndpointFree( pxCopy );
+        }
+
+        return xStatus;
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvEndpointEqual( const SocketsStandbyEndpoint_t * pxA,
+                                        const SocketsStandbyEndpoint_t * pxB )
+    {
+        BaseType_t xEqual = pdFALSE;
+        uint32_t ulProtocol;
+
+        if( ( 0 == strcmp( pxA->pcHostName, pxB->pcHostName ) ) &&
+            ( pxA->usPort == pxB->usPort ) &&
+            ( pxA->xServerNameIndication == pxB->xServerNameIndication ) &&
+            ( pxA->xCoalesceWrites == pxB->xCoalesceWrites ) &&
+            ( ( NULL == pxA->pcServerCertificate ) == ( NULL == pxB->pcServerCertificate ) ) &&
+            ( ( NULL == pxA->ppcAlpnProtocols ) == ( NULL == pxB->ppcAlpnProtocols ) ) )
+        {
+            xEqual = pdTRUE;
+        }
+
+        if( ( pdTRUE == xEqual ) && ( NULL != pxA->pcServerCertificate ) )
+        {
+            if( ( pxA->ulServerCertificateLength != pxB->ulServerCertificateLength ) ||
+                ( 0 != memcmp( pxA->pcServerCertificate, pxB->pcServerCertificate, pxA->ulServerCertificateLength ) ) )
+            {
+                xEqual = pdFALSE;
+            }
+        }
+
+        if( ( pdTRUE == xEqual ) && ( NULL != pxA->ppcAlpnProtocols ) )
+        {
+            if( pxA->ulAlpnProtocolsCount != pxB->ulAlpnProtocolsCount )
+            {
+                xEqual = pdFALSE;
+            }
+
+            for( ulProtocol = 0; ( ulProtocol < pxA->ulAlpnProtocolsCount ) && ( pdTRUE == xEqual ); ulProtocol++ )
+            {
+                if( 0 != strcmp( pxA->ppcAlpnProtocols[ ulProtocol ], pxB->ppcAlpnProtocols[ ulProtocol ] ) )
+                {
+                    xEqual = pdFALSE;
+                }
+            }
+        }
+
+        return xEqual;
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Checks whether a socket about to be connected has the options of a
+ * standby endpoint. Called with xStandbyMutex held.
+ */
+    static BaseType_t prvStandbyMatch( const SSOCKETContext_t * pxContext,
+                                       const SocketsSockaddr_t * pxAddress,
+                                       const SocketsStandby_t * pxStandby )
+    {
+        const SocketsStandbyEndpoint_t * pxEndpoint = &pxStandby->xEndpoint;
+        BaseType_t xMatch = pdFALSE;
+        uint32_t ulProtocol;
+
+        if( ( pdTRUE == pxContext->xRequireTLS ) &&
+            ( pdFALSE == pxContext->xOtherOptionsSet ) &&
+            ( pxAddress->usPort == SOCKETS_htons( pxEndpoint->usPort ) ) &&
+            ( pxContext->xCoalesceWrites == pxEndpoint->xCoalesceWrites ) &&
+            ( ( NULL == pxContext->pcServerCertificate ) == ( NULL == pxEndpoint->pcServerCertificate ) ) )
+        {
+            xMatch = pdTRUE;
+        }
+
+        /* The same server: by name if it is sent with SNI, by address
+         * otherwise. */
+        if( pdTRUE == xMatch )
+        {
+            if( pdTRUE == pxEndpoint->xServerNameIndication )
+            {
+                if( ( NULL == pxContext->pcDestination ) ||
+                    ( 0 != strcmp( pxContext->pcDestination, pxEndpoint->pcHostName ) ) )
+                {
+                    xMatch = pdFALSE;
+                }
+            }
+            else if( ( NULL != pxContext->pcDestination ) ||
+                     ( pxAddress->ulAddress != pxStandby->ulAddress ) )
+            {
+                xMatch = pdFALSE;
+            }
+            else
+            {
+                /* Same address. */
+            }
+        }
+
+        if( ( pdTRUE == xMatch ) && ( NULL != pxEndpoint->pcServerCertificate ) )
+        {
+            if( ( pxContext->ulServerCertificateLength != pxEndpoint->ulServerCertificateLength ) ||
+                ( 0 != memcmp( pxContext->pcServerCertificate,
+                               pxEndpoint->pcServerCertificate,
+                               pxEndpoint->ulServerCertificateLength ) ) )
+            {
+                xMatch = pdFALSE;
+            }
+        }
+
+        /* The socket's ALPN array has a terminating NULL entry. */
+        if( pdTRUE == xMatch )
+        {
+            if( NULL == pxEndpoint->ppcAlpnProtocols )
+            {
+                xMatch = ( NULL == pxContext->ppcAlpnProtocols ) ? pdTRUE : pdFALSE;
+            }
+            else if( ( NULL == pxContext->ppcAlpnProtocols ) ||
+                     ( pxContext->ulAlpnProtocolsCount != ( pxEndpoint->ulAlpnProtocolsCount + 1U ) ) )
+            {
+                xMatch = pdFALSE;
+            }
+            else
+            {
+                for( ulProtocol = 0; ( ulProtocol < pxEndpoint->ulAlpnProtocolsCount ) && ( pdTRUE == xMatch ); ulProtocol++ )
+                {
+                    if( 0 != strcmp( pxContext->ppcAlpnProtocols[ ulProtocol ], pxEndpoint->ppcAlpnProtocols[ ulProtocol ] ) )
+                    {
+                        xMatch = pdFALSE;
+                    }
+                }
+            }
+        }
+
+        return xMatch;
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Moves the connection of a standby socket to the caller's socket,
+ * then frees the standby socket and the caller's unconnected socket. Called
+ * only after prvStandbyMatch() found the options equal.
+ */
+    static void prvStandbyAdopt( SSOCKETContextPtr_t pxContext,
+                                 SSOCKETContextPtr_t pxStandby )
+    {
+        Socket_t xUnconnected = pxContext->xSocket;
+        char * pcDestination = pxContext->pcDestination;
+        char * pcServerCertificate = pxContext->pcServerCertificate;
+        char ** ppcAlpnProtocols = pxContext->ppcAlpnProtocols;
+
+        pxContext->xSocket = pxStandby->xSocket;
+        pxContext->pvTLSContext = pxStandby->pvTLSContext;
+
+        /* The TLS context points to the options of the standby socket, which
+         * are equal to the caller's. Keep them, and free the caller's. */
+        pxContext->pcDestination = pxStandby->pcDestination;
+        pxContext->pcServerCertificate = pxStandby->pcServerCertificate;
+        pxContext->ppcAlpnProtocols = pxStandby->ppcAlpnProtocols;
+        pxStandby->pcDestination = pcDestination;
+        pxStandby->pcServerCertificate = pcServerCertificate;
+        pxStandby->ppcAlpnProtocols = ppcAlpnProtocols;
+        pxContext->xConnectAttempted = pdTRUE;
+        TLS_SetCallerContext( pxContext->pvTLSContext, pxContext );
+
+        /* Apply the options the caller set on its own socket. */
+        if( 0U != pxContext->xRecvTimeout )
+        {
+            ( void ) FreeRTOS_setsockopt( pxContext->xSocket,
+                                          0,
+                                          SOCKETS_SO_RCVTIMEO,
+                                          &pxContext->xRecvTimeout,
+                                          sizeof( pxContext->xRecvTimeout ) );
+        }
+
+        if( 0U != pxContext->xSendTimeout )
+        {
+            ( void ) FreeRTOS_setsockopt( pxContext->xSocket,
+                                          0,
+                                          SOCKETS_SO_SNDTIMEO,
+                                          &pxContext->xSendTimeout,
+                                          sizeof( pxContext->xSendTimeout ) );
+        }
+
+        if( NULL != pxContext->pvWakeupCallback )
+        {
+            ( void ) FreeRTOS_setsockopt( pxContext->xSocket,
+                                          0,
+                                          SOCKETS_SO_WAKEUP_CALLBACK,
+                                          pxContext->pvWakeupCallback,
+                                          sizeof( pxContext->pvWakeupCallback ) );
+        }
+
+        prvFreeOptions( pxStandby );
+        vPortFree( pxStandby );
+        ( void ) FreeRTOS_closesocket( xUnconnected );
+    }
+/*-----------------------------------------------------------*/
+
+    static BaseType_t prvStandbyTake( SSOCKETContextPtr_t pxContext,
+                                      const SocketsSockaddr_t * pxAddress )
+    {
+        SSOCKETContextPtr_t pxStandby = NULL;
+        UBaseType_t uxIndex;
+
+        pxContext->xConnectTime = xTaskGetTickCount();
+
+        if( ( 0U < uxStandbyCount ) && ( pdTRUE == pxContext->xRequireTLS ) )
+        {
+            ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+
+            for( uxIndex = 0; uxIndex < uxStandbyCount; uxIndex++ )
+            {
+                if( pdTRUE == prvStandbyMatch( pxContext, pxAddress, &xStandbys[ uxIndex ] ) )
+                {
+                    pxContext->lStandbyEndpoint = ( int32_t ) uxIndex;
+                    pxStandby = xStandbys[ uxIndex ].pxReady;
+                    xStandbys[ uxIndex ].pxReady = NULL;
+
+                    if( NULL != pxStandby )
+                    {
+                        xStandbys[ uxIndex ].xStats.ulWarmConnects++;
+                    }
+                    else
+                    {
+                        xStandbys[ uxIndex ].xStats.ulColdConnects++;
+                    }
+
+                    break;
+                }
+            }
+
+            ( void ) xSemaphoreGive( xStandbyMutex );
+        }
+
+        if( NULL != pxStandby )
+        {
+            prvStandbyAdopt( pxContext, pxStandby );
+            pxContext->xStandbyAdopted = pdTRUE;
+
+            /* Open the next standby connection now. */
+            ( void ) xTaskNotifyGive( xStandbyTask );
+        }
+
+        return pxContext->xStandbyAdopted;
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStandbyFirstByte( SSOCKETContextPtr_t pxContext )
+    {
+        SocketsStandbyStats_t * pxStats;
+        uint32_t ulMs;
+
+        if( ( 0 <= pxContext->lStandbyEndpoint ) && ( pdFALSE == pxContext->xFirstByteReceived ) )
+        {
+            pxContext->xFirstByteReceived = pdTRUE;
+            ulMs = socketsTICKS_TO_MS( xTaskGetTickCount() - pxContext->xConnectTime );
+            pxStats = &xStandbys[ pxContext->lStandbyEndpoint ].xStats;
+
+            ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+
+            if( pdTRUE == pxContext->xStandbyAdopted )
+            {
+                pxStats->ulWarmFirstByteMs = ulMs;
+                pxStats->ulWarmFirstByteTotalMs += ulMs;
+                pxStats->ulWarmFirstByteCount++;
+            }
+            else
+            {
+                pxStats->ulColdFirstByteMs = ulMs;
+                pxStats->ulColdFirstByteTotalMs += ulMs;
+                pxStats->ulColdFirstByteCount++;
+            }
+
+            ( void ) xSemaphoreGive( xStandbyMutex );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Opens a connection to an endpoint with the options a caller would
+ * set.
+ *
+ * @return The connected socket, or SOCKETS_INVALID_SOCKET.
+ */
+    static Socket_t prvStandbyOpen( const SocketsStandbyEndpoint_t * pxEndpoint,
+                                    uint32_t * pulAddress )
+    {
+        Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+        SocketsSockaddr_t xAddress = { 0 };
+        int32_t lStatus = SOCKETS_ERROR_NONE;
+
+        xAddress.ucLength = sizeof( xAddress );
+        xAddress.ucSocketDomain = SOCKETS_AF_INET;
+        xAddress.usPort = SOCKETS_htons( pxEndpoint->usPort );
+        xAddress.ulAddress = SOCKETS_GetHostByName( pxEndpoint->pcHostName );
+        *pulAddress = xAddress.ulAddress;
+
+        if( 0U != xAddress.ulAddress )
+        {
+            xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+        }
+
+        if( SOCKETS_INVALID_SOCKET != xSocket )
+        {
+            lStatus = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_REQUIRE_TLS, NULL, 0 );
+
+            if( ( SOCKETS_ERROR_NONE == lStatus ) && ( NULL != pxEndpoint->pcServerCertificate ) )
+            {
+                lStatus = SOCKETS_SetSockOpt( xSocket,
+                                              0,
+                                              SOCKETS_SO_TRUSTED_SERVER_CERTIFICATE,
+                                              pxEndpoint->pcServerCertificate,
+                                              pxEndpoint->ulServerCertificateLength );
+            }
+
+            if( ( SOCKETS_ERROR_NONE == lStatus ) && ( pdTRUE == pxEndpoint->xServerNameIndication ) )
+            {
+                lStatus = SOCKETS_SetSockOpt( xSocket,
+                                              0,
+                                              SOCKETS_SO_SERVER_NAME_INDICATION,
+                                              pxEndpoint->pcHostName,
+                                              strlen( pxEndpoint->pcHostName ) );
+            }
+
+            if( ( SOCKETS_ERROR_NONE == lStatus ) && ( NULL != pxEndpoint->ppcAlpnProtocols ) )
+            {
+                lStatus = SOCKETS_SetSockOpt( xSocket,
+                                              0,
+                                              SOCKETS_SO_ALPN_PROTOCOLS,
+                                              pxEndpoint->ppcAlpnProtocols,
+                                              pxEndpoint->ulAlpnProtocolsCount );
+            }
+
+            if( ( SOCKETS_ERROR_NONE == lStatus ) && ( pdTRUE == pxEndpoint->xCoalesceWrites ) )
+            {
+                lStatus = SOCKETS_SetSockOpt( xSocket, 0, SOCKETS_SO_TLS_COALESCE, NULL, 0 );
+            }
+
+            /* Connect without looking for a standby connection. */
+            if( SOCKETS_ERROR_NONE == lStatus )
+            {
+                lStatus = prvConnect( ( SSOCKETContextPtr_t ) xSocket, &xAddress, sizeof( xAddress ) );
+            }
+
+            if( SOCKETS_ERROR_NONE != lStatus )
+            {
+                ( void ) SOCKETS_Close( xSocket );
+                xSocket = SOCKETS_INVALID_SOCKET;
+            }
+        }
+
+        return xSocket;
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Checks that nothing was received on a standby connection. A server
+ * only closes it, or sends an alert, to give up on it.
+ */
+    static BaseType_t prvStandbyIsHealthy( SSOCKETContextPtr_t pxStandby )
+    {
+        uint8_t ucByte;
+        BaseType_t xHealthy = pdFALSE;
+
+        if( ( pdTRUE == FreeRTOS_issocketconnected( pxStandby->xSocket ) ) &&
+            ( 0 == FreeRTOS_recv( pxStandby->xSocket,
+                                  &ucByte,
+                                  sizeof( ucByte ),
+                                  FREERTOS_MSG_PEEK | FREERTOS_MSG_DONTWAIT ) ) )
+        {
+            xHealthy = pdTRUE;
+        }
+
+        return xHealthy;
+    }
+/*-----------------------------------------------------------*/
+
+/*
+ * @brief Drops an unhealthy or old standby connection, and opens a new one
+ * unless the endpoint is backing off.
+ */
+    static void prvStandbyService( SocketsStandby_t * pxStandby )
+    {
+        SSOCKETContextPtr_t pxDropped = NULL;
+        Socket_t xOpened;
+        BaseType_t xOpen = pdFALSE;
+        uint32_t ulAddress = 0;
+        uint32_t ulDelayMs;
+
+        ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+
+        if( NULL != pxStandby->pxReady )
+        {
+            if( ( ( xTaskGetTickCount() - pxStandby->xOpenedAt ) >= pdMS_TO_TICKS( socketsconfigSTANDBY_MAX_AGE_MS ) ) ||
+                ( pdFALSE == prvStandbyIsHealthy( pxStandby->pxReady ) ) )
+            {
+                pxDropped = pxStandby->pxReady;
+                pxStandby->pxReady = NULL;
+                pxStandby->xStats.ulDropped++;
+                xOpen = pdTRUE;
+            }
+        }
+        else if( pdFALSE != xTaskCheckForTimeOut( &pxStandby->xRetryTimeOut, &pxStandby->xRetryTicks ) )
+        {
+            xOpen = pdTRUE;
+        }
+        else
+        {
+            /* Backing off. */
+        }
+
+        ( void ) xSemaphoreGive( xStandbyMutex );
+
+        if( NULL != pxDropped )
+        {
+            ( void ) SOCKETS_Close( pxDropped );
+        }
+
+        if( pdTRUE == xOpen )
+        {
+            xOpened = prvStandbyOpen( &pxStandby->xEndpoint, &ulAddress );
+
+            ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+
+            pxStandby->ulAddress = ulAddress;
+
+            if( SOCKETS_INVALID_SOCKET != xOpened )
+            {
+                pxStandby->pxReady = ( SSOCKETContextPtr_t ) xOpened;
+                pxStandby->xOpenedAt = xTaskGetTickCount();
+                pxStandby->ulBackoffMs = 0;
+                pxStandby->xStats.ulOpened++;
+            }
+            else
+            {
+                /* Double the backoff, and wait a random time between half
+                 * of it and all of it so that devices which lost the same
+                 * server do not retry together. */
+                if( 0U == pxStandby->ulBackoffMs )
+                {
+                    pxStandby->ulBackoffMs = socketsconfigSTANDBY_RETRY_MIN_MS;
+                }
+                else if( pxStandby->ulBackoffMs < ( socketsconfigSTANDBY_RETRY_MAX_MS / 2U ) )
+                {
+                    pxStandby->ulBackoffMs *= 2U;
+                }
+                else
+                {
+                    pxStandby->ulBackoffMs = socketsconfigSTANDBY_RETRY_MAX_MS;
+                }
+
+                ulDelayMs = ( pxStandby->ulBackoffMs / 2U ) +
+                            ( ulRand() % ( ( pxStandby->ulBackoffMs / 2U ) + 1U ) );
+                vTaskSetTimeOutState( &pxStandby->xRetryTimeOut );
+                pxStandby->xRetryTicks = pdMS_TO_TICKS( ulDelayMs );
+                pxStandby->xStats.ulOpenFailures++;
+            }
+
+            ( void ) xSemaphoreGive( xStandbyMutex );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    static void prvStandbyTask( void * pvParameters )
+    {
+        UBaseType_t uxIndex;
+
+        ( void ) pvParameters;
+
+        for( ; ; )
+        {
+            for( uxIndex = 0; uxIndex < uxStandbyCount; uxIndex++ )
+            {
+                prvStandbyService( &xStandbys[ uxIndex ] );
+            }
+
+            /* Wake up early when a standby connection is handed out. */
+            ( void ) ulTaskNotifyTake( pdTRUE, pdMS_TO_TICKS( socketsconfigSTANDBY_CHECK_PERIOD_MS ) );
+        }
+    }
+/*-----------------------------------------------------------*/
+
+    int32_t SOCKETS_StandbyAdd( const SocketsStandbyEndpoint_t * pxEndpoint )
+    {
+        int32_t lIndex = SOCKETS_ENOMEM;
+        UBaseType_t uxIndex;
+        SocketsStandby_t * pxStandby;
+
+        configASSERT( pxEndpoint != NULL );
+        configASSERT( pxEndpoint->pcHostName != NULL );
+        configASSERT( xStandbyMutex != NULL );
+
+        ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+
+        for( uxIndex = 0; uxIndex < uxStandbyCount; uxIndex++ )
+        {
+            if( pdTRUE == prvEndpointEqual( &xStandbys[ uxIndex ].xEndpoint, pxEndpoint ) )
+            {
+                lIndex = ( int32_t ) uxIndex;
+                break;
+            }
+        }
+
+        if( ( lIndex < 0 ) && ( uxStandbyCount < ( UBaseType_t ) socketsconfigSTANDBY_MAX_ENDPOINTS ) )
+        {
+            pxStandby = &xStandbys[ uxStandbyCount ];
+            memset( pxStandby, 0, sizeof( SocketsStandby_t ) );
+
+            if( pdPASS == prvEndpointCopy( &pxStandby->xEndpoint, pxEndpoint ) )
+            {
+                vTaskSetTimeOutState( &pxStandby->xRetryTimeOut );
+                lIndex = ( int32_t ) uxStandbyCount;
+                uxStandbyCount++;
+            }
+        }
+
+        if( ( 0 <= lIndex ) && ( NULL == xStandbyTask ) )
+        {
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xStandbyTask = xTaskCreateStatic( prvStandbyTask,
+                                                  "SockStandby",
+                                                  socketsconfigSTANDBY_TASK_STACK_SIZE,
+                                                  NULL,
+                                                  socketsconfigSTANDBY_TASK_PRIORITY,
+                                                  xStandbyTaskStack,
+                                                  &xStandbyTaskBuffer );
+            #else
+                ( void ) xTaskCreate( prvStandbyTask,
+                                      "SockStandby",
+                                      socketsconfigSTANDBY_TASK_STACK_SIZE,
+                                      NULL,
+                                      socketsconfigSTANDBY_TASK_PRIORITY,
+                                      &xStandbyTask );
+            #endif
+        }
+
+        ( void ) xSemaphoreGive( xStandbyMutex );
+
+        if( NULL != xStandbyTask )
+        {
+            ( void ) xTaskNotifyGive( xStandbyTask );
+        }
+
+        return lIndex;
+    }
+/*-----------------------------------------------------------*/
+
+    int32_t SOCKETS_StandbyGetStats( int32_t lEndpoint,
+                                     SocketsStandbyStats_t * pxStats )
+    {
+        int32_t lStatus = SOCKETS_EINVAL;
+
+        configASSERT( pxStats != NULL );
+
+        if( ( 0 <= lEndpoint ) && ( ( UBaseType_t ) lEndpoint < uxStandbyCount ) )
+        {
+            ( void ) xSemaphoreTake( xStandbyMutex, portMAX_DELAY );
+            *pxStats = xStandbys[ lEndpoint ].xStats;
+            ( void ) xSemaphoreGive( xStandbyMutex );
+            lStatus = SOCKETS_ERROR_NONE;
+        }
+
+        return lStatus;
+    }
+
+#else /* if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 ) */
+
+    int32_t SOCKETS_StandbyAdd( const SocketsStandbyEndpoint_t * pxEndpoint )
+    {
+        ( void ) pxEndpoint;
+
+        return SOCKETS_ENOMEM;
+    }
+/*-----------------------------------------------------------*/
+
+    int32_t SOCKETS_StandbyGetStats( int32_t lEndpoint,
+                                     SocketsStandbyStats_t * pxStats )
+    {
+        ( void ) lEndpoint;
+        ( void ) pxStats;
+
+        return SOCKETS_EINVAL;
+    }
+
+#endif /* if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 ) */
+/*-----------------------------------------------------------*/
+
+/* Provide access to private members for testing. */
+#ifdef AMAZON_FREERTOS_ENABLE_UNIT_TESTS
+    #include "aws_secure_sockets_test_access_define.h"
+#endif
+/*-----------------------------------------------------------*/
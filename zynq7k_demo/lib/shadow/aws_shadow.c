@@ -37,47 +37,44 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "timers.h"
 
 /* AWS includes. */
 #include "aws_shadow_config.h"
 #include "aws_shadow_config_defaults.h"
 #include "aws_shadow.h"
 #include "aws_shadow_json.h"
+#include "aws_shadow_topic.h"
+#include "aws_static_memory.h"
 
 /**
- * @brief Format strings for the AWS IoT Shadow MQTT topics.
- * Refer to docs.aws.amazon.com/iot/latest/developerguide/device-shadow-mqtt.html
- * If the MQTT topics change, update them here. Use %s for 'thingName'.
- *
- * These topics may also be changed to trim Thing Shadow messages.
- * Refer to docs.aws.amazon.com/iot/latest/developerguide/using-device-shadows.html#device-shadow-trim-messages
+ * @brief Names of the Shadow operations, as in their MQTT topics. The topics
+ * themselves are built and parsed by aws_shadow_topic.c.
  */
 /** @{ */
-#define shadowTOPIC_PREFIX              "$aws/things/%s/shadow/" /* All shadow topics begin with this. */
 #define shadowTOPIC_OPERATION_UPDATE    "update"
 #define shadowTOPIC_OPERATION_GET       "get"
 #define shadowTOPIC_OPERATION_DELETE    "delete"
-#define shadowTOPIC_SUFFIX_ACCEPTED     "/accepted" /* All accepted topics end with this. */
-#define shadowTOPIC_SUFFIX_REJECTED     "/rejected" /* All rejected topics end with this. */
-
-#define shadowTOPIC_UPDATE              shadowTOPIC_PREFIX shadowTOPIC_OPERATION_UPDATE
-#define shadowTOPIC_UPDATE_ACCEPTED     shadowTOPIC_UPDATE shadowTOPIC_SUFFIX_ACCEPTED
-#define shadowTOPIC_UPDATE_REJECTED     shadowTOPIC_UPDATE shadowTOPIC_SUFFIX_REJECTED
-#define shadowTOPIC_UPDATE_DOCUMENTS    shadowTOPIC_UPDATE "/documents"
-#define shadowTOPIC_UPDATE_DELTA        shadowTOPIC_UPDATE "/delta"
-#define shadowTOPIC_GET                 shadowTOPIC_PREFIX shadowTOPIC_OPERATION_GET
-#define shadowTOPIC_GET_ACCEPTED        shadowTOPIC_GET shadowTOPIC_SUFFIX_ACCEPTED
-#define shadowTOPIC_GET_REJECTED        shadowTOPIC_GET shadowTOPIC_SUFFIX_REJECTED
-#define shadowTOPIC_DELETE              shadowTOPIC_PREFIX shadowTOPIC_OPERATION_DELETE
-#define shadowTOPIC_DELETE_ACCEPTED     shadowTOPIC_DELETE shadowTOPIC_SUFFIX_ACCEPTED
-#define shadowTOPIC_DELETE_REJECTED     shadowTOPIC_DELETE shadowTOPIC_SUFFIX_REJECTED
 /** @} */
 
-/** Maximum length of a Shadow MQTT topic. 128 is currently the longest Thing
-* Name that AWS IoT accepts. shadowTOPIC_UPDATE_DOCUMENTS is currently the
-* longest topic. All Shadow MQTT topics should be shorter than this value. */
-#define configMAX_THING_NAME_LENGTH    128
-#define shadowTOPIC_BUFFER_LENGTH      ( configMAX_THING_NAME_LENGTH + ( int16_t ) sizeof( shadowTOPIC_UPDATE_DOCUMENTS ) )
+/**
+ * @brief Document published by get and delete. It only holds a client token of
+ * shadowGENERATED_CLIENT_TOKEN_LENGTH hexadecimal digits, which the response
+ * carries back.
+ */
+/** @{ */
+#define shadowGENERATED_CLIENT_TOKEN_LENGTH    ( 8 )
+#define shadowCLIENT_TOKEN_DOCUMENT_PREFIX     "{\"clientToken\":\""
+#define shadowCLIENT_TOKEN_DOCUMENT_SUFFIX     "\"}"
+#define shadowCLIENT_TOKEN_DOCUMENT_LENGTH                          \
+    ( sizeof( shadowCLIENT_TOKEN_DOCUMENT_PREFIX ) - 1 +            \
+      shadowGENERATED_CLIENT_TOKEN_LENGTH +                         \
+      sizeof( shadowCLIENT_TOKEN_DOCUMENT_SUFFIX ) )
+/** @} */
+
+#if shadowconfigMAX_CLIENT_TOKEN_LENGTH < shadowGENERATED_CLIENT_TOKEN_LENGTH
+    #error "shadowconfigMAX_CLIENT_TOKEN_LENGTH is too short for the generated client tokens."
+#endif
 
 #if shadowconfigENABLE_DEBUG_LOGS == 1
     #define Shadow_debug_printf( X )    configPRINTF( X )
@@ -85,31 +82,6 @@
     #define Shadow_debug_printf( X )
 #endif
 
-/**
- * @brief Shadow operation that can be parsed from MQTT topics.
- *
- */
-typedef enum ShadowOperationName
-{
-    eShadowOperationUpdate,
-    eShadowOperationGet,
-    eShadowOperationDelete,
-    eShadowOperationUpdateDocuments,
-    eShadowOperationUpdateDelta,
-    eShadowOperationDeletedByAnother,
-    eShadowOperationOther
-} ShadowOperationName_t;
-
-/**
- * @brief Data on the Shadow operation currently in progress.
- *
- */
-typedef struct ShadowOperationData
-{
-    ShadowOperationName_t xOperationInProgress;
-    ShadowOperationParams_t * pxOperationParams;
-} ShadowOperationData_t;
-
 /**
  * @brief Data on the timeout by which a function needs to complete.
  *
@@ -131,11 +103,6 @@ typedef struct ShadowOperationCallParams
     ShadowOperationName_t xOperationName;
     const char * pcOperationName;
 
-    /* Operation MQTT topics. */
-    const char * pcOperationTopic;
-    const char * pcOperationAcceptedTopic;
-    const char * pcOperationRejectedTopic;
-
     /* The message to publish to MQTT topics. */
     const char * pcPublishMessage;
     uint32_t ulPublishMessageLength;
@@ -156,6 +123,59 @@ typedef struct CallbackCatalogEntry
     BaseType_t xInUse;
 } CallbackCatalogEntry_t;
 
+/**
+ * @brief An operation published and waiting for its accepted or rejected
+ * response.
+ *
+ * Entries are claimed under xOperationMutex and changed under
+ * xOperationDataMutex. The entry of a blocking operation is freed by the task
+ * waiting on it; the entry of an asynchronous operation is freed by whatever
+ * completes it.
+ */
+typedef struct ShadowPendingOperation
+{
+    BaseType_t xInUse;
+    BaseType_t xComplete;
+    ShadowOperationName_t xOperationName;
+    ShadowOperationParams_t * pxOperationParams;
+
+    /* Completion callback of an asynchronous operation; NULL for blocking
+     * operations. */
+    ShadowOperationCallback_t xCallback;
+    void * pvCallbackContext;
+
+    /* Asynchronous operations are timed out by the client's timeout timer. */
+    TickType_t xStartTicks;
+    TickType_t xTimeoutTicks;
+
+    /* Order in which operations were published. Also tells a pending
+     * operation apart from a later one that reused its entry. */
+    uint32_t ulSequence;
+
+    /* Result passed to a blocking operation through xCompleteSemaphore. */
+    volatile ShadowReturnCode_t xResult;
+    SemaphoreHandle_t xCompleteSemaphore;
+    StaticSemaphore_t xCompleteSemaphoreBuffer;
+
+    /* Client token that the response must carry. */
+    uint16_t usClientTokenLength;
+    char cClientToken[ shadowconfigMAX_CLIENT_TOKEN_LENGTH ];
+} ShadowPendingOperation_t;
+
+/**
+ * @brief A completed asynchronous operation whose callback is still to be
+ * called.
+ *
+ * Completion callbacks are called after xOperationDataMutex is released.
+ */
+typedef struct ShadowCompletion
+{
+    ShadowOperationCallback_t xCallback;
+    void * pvCallbackContext;
+    ShadowReturnCode_t xResult;
+    ShadowOperationParams_t * pxOperationParams;
+} ShadowCompletion_t;
+
 /**
  * @brief The Shadow Client.
  *
@@ -167,34 +187,47 @@ typedef struct ShadowClient
 
     /* Shadow Client flags. */
     BaseType_t xInUse;
-    BaseType_t xUpdateSubscribed;
-    BaseType_t xGetSubscribed;
-    BaseType_t xDeleteSubscribed;
+
+    /* Things whose accepted and rejected topics are subscribed to, with one
+     * bit per operation in ucSubscribedOperations. An entry whose bits are
+     * all clear is free. The index points to the copies of the names in
+     * cSubscribedThingNames. Changed under xOperationMutex, except that a
+     * disconnect clears all the bits. */
+    ShadowTopicIndexEntry_t xSubscribedIndex[ shadowconfigMAX_SUBSCRIBED_THINGS ];
+    char cSubscribedThingNames[ shadowconfigMAX_SUBSCRIBED_THINGS ][ shadowTOPIC_MAX_THING_NAME_LENGTH + 1 ];
+    volatile uint8_t ucSubscribedOperations[ shadowconfigMAX_SUBSCRIBED_THINGS ];
 
     /* Synchronization mechanisms. */
-    SemaphoreHandle_t xOperationDataMutex; /* Allows only one in-progress operation. */
-    SemaphoreHandle_t xOperationMutex;     /* Allows only one in-progress operation. */
-    SemaphoreHandle_t xCallbackSemaphore;  /* Communication with callbacks. */
+    SemaphoreHandle_t xOperationDataMutex; /* Guards the pending operations. */
+    SemaphoreHandle_t xOperationMutex;     /* Serializes subscription changes. */
+    SemaphoreHandle_t xPendingSlots;       /* Counts the free pending operations. */
     StaticSemaphore_t xOperationMutexBuffer;
-    StaticSemaphore_t xCallbackSemaphoreBuffer;
+    StaticSemaphore_t xPendingSlotsBuffer;
     StaticSemaphore_t xOperationDataMutexBuffer;
 
-    /* Data shared between blocking function and MQTT callback. */
-    ShadowOperationData_t * pxOperationData;
+    /* Operations waiting for their accepted or rejected response. */
+    ShadowPendingOperation_t xPendingOperations[ shadowconfigMAX_PENDING_OPERATIONS ];
+    uint32_t ulNextSequence;
 
-    /* The callback functions pass data to the API calls by setting xOperationResult.
-     * This value is volatile to ensure that the compiler knows the value can change
-     * without anything happening in the API call. */
-    volatile ShadowReturnCode_t xOperationResult;
+    /* Expiry of the timeout timer, valid while xTimerArmed is pdTRUE. */
+    TickType_t xTimerDeadline;
+    BaseType_t xTimerArmed;
 
     /* Callback catalog stores Thing Names and registered callbacks. */
     CallbackCatalogEntry_t xCallbackCatalog[ shadowconfigMAX_THINGS_WITH_CALLBACKS ];
 
-    /* Stores the topic of the in-progress operation. Some of the Shadow API's
-     * static functions depend on this buffer remaining the same throughout a
-     * Shadow API operation. Therefore, only prvShadowOperation (and the static
-     * functions called by prvShadowOperation) should modify the contents of this
-     * buffer. */
+    /* Thing Names of the callback catalog with their lengths and hashes;
+     * entry n holds the Thing of catalog entry n. Incoming topics are matched
+     * against it without building topic strings. */
+    ShadowTopicIndexEntry_t xCallbackIndex[ shadowconfigMAX_THINGS_WITH_CALLBACKS ];
+
+    /* Token arena of the MQTT callback. Each received response is parsed
+     * into it once, then its client token and error are read from it. */
+    jsmntok_t xJSONTokens[ shadowconfigJSON_JSMN_TOKENS ];
+
+    /* Stores the topic of the subscription being changed. Only the functions
+     * that subscribe to or unsubscribe from the accepted and rejected topics
+     * use this buffer, and only while holding xOperationMutex. */
     uint8_t ucTopicBuffer[ shadowTOPIC_BUFFER_LENGTH ];
 } ShadowClient_t;
 
@@ -209,7 +242,7 @@ static BaseType_t prvGetFreeShadowClient( void );
  * returns the next available unused slot index in catalog.
  *
  */
-static BaseType_t prvGetCallbackCatalogEntry( CallbackCatalogEntry_t * const xCallbackCatalog,
+static BaseType_t prvGetCallbackCatalogEntry( ShadowClient_t * const pxShadowClient,
                                               const char * const pcThingName );
 
 
@@ -232,28 +265,29 @@ static ShadowReturnCode_t prvRegisterCallback( BaseType_t xShadowClientID,
                                                const void ** const ppvOldCallback,
                                                const void ** const ppvNewCallback,
                                                const char * const pcThingName,
-                                               const uint8_t * const pucTopicFormat,
+                                               ShadowOperationName_t xOperationName,
+                                               ShadowTopicStatus_t xStatus,
                                                TickType_t xTimeoutTicks );
 
 /**
- * @brief Subscribes to an accepted and rejected topic
+ * @brief Subscribes to the accepted and rejected topics of an operation.
  *
  */
 static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
                                                                 xShadowClientID,
                                                                 const char * const pcThingName,
-                                                                const char * const pcAcceptedTopic,
-                                                                const char * const pcRejectedTopic,
+                                                                ShadowOperationName_t xOperationName,
                                                                 TimeOutData_t * const pxTimeOutData );
 
 /**
- * @brief Unsubscribe to an accepted and rejected topic.
+ * @brief Unsubscribe from the rejected topic of an operation, and from its
+ * accepted topic if xUnsubscribeAccepted is pdTRUE.
  *
  */
 static ShadowReturnCode_t prvShadowUnsubscribeFromAcceptedRejected( BaseType_t xShadowClientID,
                                                                     const char * const pcThingName,
-                                                                    const char * const pcAcceptedTopic,
-                                                                    const char * const pcRejectedTopic,
+                                                                    ShadowOperationName_t xOperationName,
+                                                                    BaseType_t xUnsubscribeAccepted,
                                                                     TimeOutData_t * const pxTimeOutData );
 
 /**
@@ -264,81 +298,188 @@ static BaseType_t prvShadowMQTTCallback( void * pvUserData,
                                          const MQTTAgentCallbackParams_t * const pxCallbackParams );
 
 /**
- * @brief Parses "accepted" or "rejected" from MQTT topic.
+ * @brief Returns the catalog entry of the Thing of a topic, or NULL if no
+ * callback is registered for it.
+ */
+static const CallbackCatalogEntry_t * prvMatchCallbackThing( const ShadowClient_t * const pxShadowClient,
+                                                             const ShadowTopic_t * const pxTopic );
+
+/**
+ * @brief Returns the operation name used in topics and debug messages.
+ */
+static const char * prvGetOperationName( ShadowOperationName_t xOperationName );
+
+/**
+ * @brief Writes the document published by get and delete, which only holds a
+ * generated client token.
+ */
+static uint32_t prvCreateClientTokenDocument( uint32_t ulSequence,
+                                              char * const pcDocument,
+                                              const char ** ppcClientToken );
+
+/**
+ * @brief Claims a free pending operation. Called with xOperationMutex held.
+ */
+static ShadowPendingOperation_t * prvClaimPendingOperation( const ShadowOperationCallParams_t * const pxParams,
+                                                            ShadowOperationCallback_t xCallback,
+                                                            void * pvCallbackContext,
+                                                            const char * const pcClientToken,
+                                                            uint16_t usClientTokenLength,
+                                                            uint32_t ulSequence,
+                                                            TickType_t xStartTicks );
+
+/**
+ * @brief Finds the pending operation a response belongs to. Called with
+ * xOperationDataMutex held.
+ */
+static ShadowPendingOperation_t * prvFindPendingOperation( ShadowClient_t * const pxShadowClient,
+                                                           ShadowOperationName_t xOperationName,
+                                                           const char * const pcThingName,
+                                                           uint16_t usThingNameLength,
+                                                           const char * const pcClientToken,
+                                                           uint16_t usClientTokenLength );
+
+/**
+ * @brief Checks if an operation of the given type is pending.
+ */
+static BaseType_t prvHasPendingOperation( ShadowClient_t * const pxShadowClient,
+                                          const char * const pcThingName,
+                                          ShadowOperationName_t xOperationName );
+
+/**
+ * @brief Completes a pending operation. Called with xOperationDataMutex held.
+ *
+ * @return pdTRUE if the operation is asynchronous; its callback must then be
+ * called with pxCompletion once xOperationDataMutex is released.
+ */
+static BaseType_t prvCompletePendingOperation( ShadowClient_t * const pxShadowClient,
+                                               ShadowPendingOperation_t * const pxOperation,
+                                               ShadowReturnCode_t xResult,
+                                               ShadowCompletion_t * const pxCompletion );
+
+/**
+ * @brief Calls the callbacks of completed asynchronous operations.
+ */
+static void prvInvokeCompletions( const ShadowCompletion_t * const pxCompletions,
+                                  BaseType_t xCompletionCount );
+
+/**
+ * @brief Withdraws a pending operation that has not completed.
  *
+ * @return pdTRUE if the operation was withdrawn; pdFALSE if it had completed.
  */
-static ShadowReturnCode_t prvParseShadowOperationStatus( const uint8_t * const
-                                                         pucTopic,
-                                                         uint16_t usTopicLength );
+static BaseType_t prvCancelPendingOperation( ShadowClient_t * const pxShadowClient,
+                                             ShadowPendingOperation_t * const pxOperation,
+                                             uint32_t ulSequence );
 
 /**
- * @briefMatch topic with registered callback and return reference to catalog entry found or NULL in not found.
+ * @brief Frees the entry of a blocking operation.
  */
-static const CallbackCatalogEntry_t * prvMatchCallbackTopic( const ShadowClient_t *
-                                                             const pxShadowClient,
-                                                             const uint8_t * const pucTopic,
-                                                             uint16_t usTopicLength,
-                                                             ShadowOperationName_t * const pxOperationName );
+static void prvReleasePendingOperation( ShadowClient_t * const pxShadowClient,
+                                        ShadowPendingOperation_t * const pxOperation );
 
 /**
- * @brief Update callback for Shadow Operations.
+ * @brief Arms the timeout timer for the asynchronous operation that expires
+ * first. Called with xOperationDataMutex held.
  */
-static void prvShadowUpdateCallback( BaseType_t xShadowClientID,
-                                     ShadowReturnCode_t xResult,
-                                     const ShadowOperationParams_t * const pxParams,
-                                     const char * const pcData,
-                                     uint32_t ulDataLength );
+static void prvArmTimeoutTimer( BaseType_t xShadowClientID );
 
 /**
- * @brief Get callback for shadow operations
+ * @brief Times out the expired asynchronous operations of a Shadow Client.
  */
-static void prvShadowGetCallback( BaseType_t xShadowClientID,
-                                  ShadowReturnCode_t xResult,
-                                  ShadowOperationParams_t * const pxParams,
-                                  const char * const pcData,
-                                  uint32_t ulDataLength,
-                                  MQTTBufferHandle_t xBuffer );
+static void prvTimeoutTimerCallback( TimerHandle_t xTimer );
 
 /**
- * @briefDelete callback for shadow operations
+ * @brief Updates and returns the ticks left before a timeout.
  */
-static void prvShadowDeleteCallback( BaseType_t xShadowClientID,
-                                     ShadowReturnCode_t xResult,
-                                     const char * const pcData,
-                                     uint32_t ulDataLength );
+static TickType_t prvTicksRemaining( TimeOutData_t * const pxTimeOutData );
 
 /**
  * @brief Handles error codes and messages in callbacks.
  */
-static ShadowReturnCode_t prvGetErrorCodeAndMessage( const char * const pcData,
-                                                     uint32_t ulDataLength,
+static ShadowReturnCode_t prvGetErrorCodeAndMessage( const ShadowJSONDoc_t * const pxDoc,
                                                      BaseType_t xShadowClientID,
                                                      const char * const pcOperationName );
 
+/**
+ * @brief Finds the client token of a document to publish. The document is
+ * parsed on the stack of the calling task.
+ */
+static uint16_t prvGetDocumentClientToken( const char * const pcDoc,
+                                           uint32_t ulDocLength,
+                                           const char ** ppcClientToken );
+
 /**
  * @briefShadow Operation common code.
  */
-static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxParams );
+static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxParams,
+                                              ShadowOperationCallback_t xCallback,
+                                              void * pvCallbackContext );
+
+/**
+ * @brief Common code of #SHADOW_Update and #SHADOW_UpdateAsync.
+ */
+static ShadowReturnCode_t prvShadowUpdate( ShadowClientHandle_t xShadowClientHandle,
+                                           ShadowOperationParams_t * const pxUpdateParams,
+                                           TickType_t xTimeoutTicks,
+                                           ShadowOperationCallback_t xCallback,
+                                           void * pvCallbackContext );
+
+/**
+ * @brief Common code of #SHADOW_Get and #SHADOW_GetAsync.
+ */
+static ShadowReturnCode_t prvShadowGet( ShadowClientHandle_t xShadowClientHandle,
+                                        ShadowOperationParams_t * const pxGetParams,
+                                        TickType_t xTimeoutTicks,
+                                        ShadowOperationCallback_t xCallback,
+                                        void * pvCallbackContext );
+
+/**
+ * @brief Common code of #SHADOW_Delete and #SHADOW_DeleteAsync.
+ */
+static ShadowReturnCode_t prvShadowDelete( ShadowClientHandle_t xShadowClientHandle,
+                                           ShadowOperationParams_t * const pxDeleteParams,
+                                           TickType_t xTimeoutTicks,
+                                           ShadowOperationCallback_t xCallback,
+                                           void * pvCallbackContext );
 
+/**
+ * @brief Returns the entry of a Thing in the subscribed Things of a client,
+ * -1 if there is none.
+ */
+static BaseType_t prvFindSubscribedThing( const ShadowClient_t * const pxShadowClient,
+                                          const char * const pcThingName );
+
+/**
+ * @brief Records whether a client is subscribed to the accepted and rejected
+ * topics of an operation on a Thing.
+ *
+ * If every entry is in use, the subscription is not recorded and the next
+ * operation on the Thing subscribes again, which the MQTT agent accepts.
+ */
 static void prvSetSubscribedFlag( ShadowClient_t * const pxShadowClient,
+                                  const char * const pcThingName,
                                   ShadowOperationName_t xOperationName,
                                   BaseType_t xValue );
 
 static uint8_t prvGetSubscribedFlag( const ShadowClient_t * const pxShadowClient,
+                                     const char * const pcThingName,
                                      ShadowOperationName_t xOperationName );
 
 /**
  * @brief Memory allocated to store Shadow Clients.
  */
-static ShadowClient_t xShadowClients[ shadowconfigMAX_CLIENTS ];
+static ShadowClient_t xShadowClients[ shadowconfigMAX_CLIENTS ] staticmemSECTION( shadow );
 
 /**
- * @brief Custom prvCreateTopic function since prvCreateTopic is not MISRA 2012 compliant (rule 21.6) .
+ * @brief Timers that time out the asynchronous operations of each Shadow
+ * Client.
+ *
+ * They are kept out of the Shadow Clients, which SHADOW_ClientDelete clears,
+ * and are created once and never deleted.
  */
-static uint16_t prvCreateTopic( char * pcTopicString,
-                                const uint16_t usBufferLength,
-                                const char * pcTopicFormat,
-                                const char * pcThingName );
+static TimerHandle_t xTimeoutTimers[ shadowconfigMAX_CLIENTS ] staticmemSECTION( shadow );
+static StaticTimer_t xTimeoutTimerBuffers[ shadowconfigMAX_CLIENTS ] staticmemSECTION( shadow );
 
 /*-----------------------------------------------------------*/
 
@@ -364,51 +505,44 @@ static BaseType_t prvGetFreeShadowClient( void )
 }
 /*-----------------------------------------------------------*/
 
-static BaseType_t prvGetCallbackCatalogEntry( CallbackCatalogEntry_t * const xCallbackCatalog,
+static BaseType_t prvGetCallbackCatalogEntry( ShadowClient_t * const pxShadowClient,
                                               const char * const pcThingName ) /*_RB_ I find the name of this function confusing compared to what it is actually doing. */
 {                                                                              /* Todo: sub manager. */
-    CallbackCatalogEntry_t * pxCallbackCatalogEntry;
-    BaseType_t xIterator, xReturn = -1, xThingNameFound = pdFALSE;
-    size_t xThingNameLengh;
-    size_t xThingName_cb_Lengh;
+    BaseType_t xIterator, xReturn;
+    uint16_t usThingNameLength;
+    uint32_t ulThingNameHash;
+
+    usThingNameLength = ( uint16_t ) strlen( pcThingName );
+    ulThingNameHash = SHADOW_TopicHash( pcThingName, usThingNameLength );
 
     taskENTER_CRITICAL();
     {
-        for( xIterator = 0; xIterator < shadowconfigMAX_THINGS_WITH_CALLBACKS; xIterator++ )
-        {
-            pxCallbackCatalogEntry = &( xCallbackCatalog[ xIterator ] );
+        xReturn = SHADOW_TopicIndexFind( pxShadowClient->xCallbackIndex,
+                                         shadowconfigMAX_THINGS_WITH_CALLBACKS,
+                                         pcThingName,
+                                         usThingNameLength,
+                                         ulThingNameHash );
 
-            if( pxCallbackCatalogEntry->xInUse == pdFALSE )
-            {
-                xReturn = xIterator;
-            }
-            else
+        if( xReturn < 0 )
+        {
+            for( xIterator = 0; xIterator < shadowconfigMAX_THINGS_WITH_CALLBACKS; xIterator++ )
             {
-                xThingNameLengh = strlen( pxCallbackCatalogEntry->xCallbackInfo.pcThingName );
-                xThingName_cb_Lengh = strlen( pcThingName );
-
-                if( xThingNameLengh == xThingName_cb_Lengh )
+                if( pxShadowClient->xCallbackCatalog[ xIterator ].xInUse == pdFALSE )
                 {
-                    if( strncmp( pcThingName,
-                                 pxCallbackCatalogEntry->xCallbackInfo.pcThingName,
-                                 xThingNameLengh ) == 0 )
-                    {
-                        xReturn = xIterator;
-                        xThingNameFound = pdTRUE;
-                        break;
-                    }
+                    xReturn = xIterator;
                 }
             }
+
+            if( xReturn >= 0 )
+            {
+                pxShadowClient->xCallbackCatalog[ xReturn ].xInUse = pdTRUE;
+                pxShadowClient->xCallbackCatalog[ xReturn ].xCallbackInfo.pcThingName = pcThingName;
+                SHADOW_TopicIndexSet( &( pxShadowClient->xCallbackIndex[ xReturn ] ), pcThingName );
+            }
         }
     }
     taskEXIT_CRITICAL();
 
-    if( xThingNameFound == pdFALSE )
-    {
-        xCallbackCatalog[ xReturn ].xInUse = pdTRUE;
-        xCallbackCatalog[ xReturn ].xCallbackInfo.pcThingName = pcThingName;
-    }
-
     return xReturn;
 }
 
@@ -454,73 +588,12 @@ static ShadowReturnCode_t prvConvertMQTTReturnCode( MQTTAgentReturnCode_t xMQTTR
 
 /*-----------------------------------------------------------*/
 
-static uint16_t prvCreateTopic( char * pcTopicString,
-                                const uint16_t usBufferLength,
-                                const char * pcTopicFormat,
-                                const char * pcThingName )
-{
-    uint16_t usTopicFormatIdx;
-    uint16_t usThingIdx;
-    uint16_t usTopicFormatSize;
-    uint16_t usThingNameSize;
-    uint16_t usTopicSize;
-    uint16_t usTopicIdx = 0;
-    char cCurrentChar;
-    char cPrevChar = '0';
-
-    usTopicFormatSize = ( uint16_t ) strlen( pcTopicFormat );
-    usThingNameSize = ( uint16_t ) strlen( pcThingName );
-
-    /* Buffer length check. */
-    if( usTopicFormatSize + usThingNameSize >= usBufferLength )
-    {
-        return 0;
-    }
-
-    /* The topic format string is expected to include a %s. However, the length
-     * check above assumes, worst case, that the %s was for some reason missing. */
-    usTopicSize = usTopicFormatSize + usThingNameSize - ( uint16_t ) 2;
-
-    for( usTopicFormatIdx = 0;
-         usTopicFormatIdx < usTopicFormatSize;
-         usTopicFormatIdx++ )
-    {
-        cCurrentChar = pcTopicFormat[ usTopicFormatIdx ];
-
-        if( ( cPrevChar == '%' ) && ( cCurrentChar == 's' ) )
-        {
-            for( usThingIdx = 0;
-                 usThingIdx < usThingNameSize;
-                 usThingIdx++ )
-            {
-                pcTopicString[ usThingIdx + usTopicFormatIdx - ( uint16_t ) 1 ]
-                    = ( char ) pcThingName[ usThingIdx ];
-            }
-
-            /* Remove 1 because we backtracked in order to overwrite the %s. */
-            usTopicIdx += usThingNameSize - ( uint16_t ) 1;
-        }
-        else
-        {
-            pcTopicString[ usTopicIdx ] = cCurrentChar;
-            usTopicIdx++;
-        }
-
-        cPrevChar = cCurrentChar;
-    }
-
-    pcTopicString[ usTopicIdx ] = '\0';
-
-    return usTopicSize;
-}
-
-/*-----------------------------------------------------------*/
-
 static ShadowReturnCode_t prvRegisterCallback( BaseType_t xShadowClientID,
                                                const void ** const ppvOldCallback,
                                                const void ** const ppvNewCallback,
                                                const char * const pcThingName,
-                                               const uint8_t * const pucTopicFormat,
+                                               ShadowOperationName_t xOperationName,
+                                               ShadowTopicStatus_t xStatus,
                                                TickType_t xTimeoutTicks )
 {
     uint8_t ucTopicString[ shadowTOPIC_BUFFER_LENGTH ];
@@ -531,8 +604,12 @@ static ShadowReturnCode_t prvRegisterCallback( BaseType_t xShadowClientID,
     MQTTAgentReturnCode_t xMQTTReturn;
     uint16_t usTopicLength;
 
-    usTopicLength = prvCreateTopic( ( char * ) ucTopicString, shadowTOPIC_BUFFER_LENGTH,
-                                    ( const char * ) pucTopicFormat, pcThingName );
+    usTopicLength = SHADOW_TopicBuild( ( char * ) ucTopicString,
+                                       shadowTOPIC_BUFFER_LENGTH,
+                                       pcThingName,
+                                       ( uint16_t ) strlen( pcThingName ),
+                                       xOperationName,
+                                       xStatus );
     pxShadowClient = &( xShadowClients[ xShadowClientID ] );
 
     if( *ppvOldCallback != NULL )
@@ -586,9 +663,7 @@ static ShadowReturnCode_t prvRegisterCallback( BaseType_t xShadowClientID,
 static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
                                                                 xShadowClientID,
                                                                 const char * const pcThingName,
-                                                                const char * const
-                                                                pcAcceptedTopic,
-                                                                const char * const pcRejectedTopic,
+                                                                ShadowOperationName_t xOperationName,
                                                                 TimeOutData_t * const pxTimeOutData )
 {
     ShadowReturnCode_t xReturn;
@@ -597,8 +672,10 @@ static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
     MQTTAgentUnsubscribeParams_t xUnsubscribeParams;
     MQTTAgentReturnCode_t xMQTTReturn;
     TickType_t xTimeoutTicks;
+    uint16_t usThingNameLength;
 
     pxShadowClient = &( xShadowClients[ xShadowClientID ] );
+    usThingNameLength = ( uint16_t ) strlen( pcThingName );
 
     /* MQTT subscription parameters. */
     xSubscribeParams.pucTopic = pxShadowClient->ucTopicBuffer;
@@ -611,10 +688,12 @@ static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
     #endif /* mqttconfigENABLE_SUBSCRIPTION_MANAGEMENT */
 
     /* Fill the accepted topic. */
-    xSubscribeParams.usTopicLength = prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                                     shadowTOPIC_BUFFER_LENGTH,
-                                                     pcAcceptedTopic,
-                                                     pcThingName );
+    xSubscribeParams.usTopicLength = SHADOW_TopicBuild( ( char * ) pxShadowClient->ucTopicBuffer,
+                                                        shadowTOPIC_BUFFER_LENGTH,
+                                                        pcThingName,
+                                                        usThingNameLength,
+                                                        xOperationName,
+                                                        eShadowTopicAccepted );
 
     xMQTTReturn = MQTT_AGENT_Subscribe( pxShadowClient->xMQTTClient,
                                         &xSubscribeParams,
@@ -627,9 +706,12 @@ static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
     if( xReturn == eShadowSuccess )
     {
         /* Fill the rejected topic. */
-        xSubscribeParams.usTopicLength = prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                                         shadowTOPIC_BUFFER_LENGTH,
-                                                         pcRejectedTopic, pcThingName );
+        xSubscribeParams.usTopicLength = SHADOW_TopicBuild( ( char * ) pxShadowClient->ucTopicBuffer,
+                                                            shadowTOPIC_BUFFER_LENGTH,
+                                                            pcThingName,
+                                                            usThingNameLength,
+                                                            xOperationName,
+                                                            eShadowTopicRejected );
 
         xMQTTReturn = MQTT_AGENT_Subscribe( pxShadowClient->xMQTTClient,
                                             &xSubscribeParams,
@@ -641,10 +723,12 @@ static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
 
         if( xReturn != eShadowSuccess )
         {
-            xUnsubscribeParams.usTopicLength = prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                                               shadowTOPIC_BUFFER_LENGTH,
-                                                               pcAcceptedTopic,
-                                                               pcThingName );
+            xUnsubscribeParams.usTopicLength = SHADOW_TopicBuild( ( char * ) pxShadowClient->ucTopicBuffer,
+                                                                  shadowTOPIC_BUFFER_LENGTH,
+                                                                  pcThingName,
+                                                                  usThingNameLength,
+                                                                  xOperationName,
+                                                                  eShadowTopicAccepted );
 
             xUnsubscribeParams.pucTopic = pxShadowClient->ucTopicBuffer;
 
@@ -667,28 +751,31 @@ static ShadowReturnCode_t prvShadowSubscribeToAcceptedRejected( BaseType_t
 static ShadowReturnCode_t prvShadowUnsubscribeFromAcceptedRejected( BaseType_t
                                                                     xShadowClientID,
                                                                     const char * const pcThingName,
-                                                                    const char * const
-                                                                    pcAcceptedTopic,
-                                                                    const char * const pcRejectedTopic,
+                                                                    ShadowOperationName_t xOperationName,
+                                                                    BaseType_t xUnsubscribeAccepted,
                                                                     TimeOutData_t * const pxTimeOutData )
 {
-    ShadowReturnCode_t xReturn = eShadowFailure;
+    ShadowReturnCode_t xReturn;
     ShadowClient_t * pxShadowClient;
     MQTTAgentUnsubscribeParams_t xUnsubscribeParams;
     MQTTAgentReturnCode_t xMQTTReturn;
+    uint16_t usThingNameLength;
 
     pxShadowClient = &( xShadowClients[ xShadowClientID ] );
+    usThingNameLength = ( uint16_t ) strlen( pcThingName );
 
     /* MQTT unsubscribe parameters. */
     xUnsubscribeParams.pucTopic = pxShadowClient->ucTopicBuffer;
 
-    if( pcAcceptedTopic != NULL )
+    if( xUnsubscribeAccepted == pdTRUE )
     {
         /* Fill the accepted topic. */
-        xUnsubscribeParams.usTopicLength = prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                                           shadowTOPIC_BUFFER_LENGTH,
-                                                           pcAcceptedTopic,
-                                                           pcThingName );
+        xUnsubscribeParams.usTopicLength = SHADOW_TopicBuild( ( char * ) pxShadowClient->ucTopicBuffer,
+                                                              shadowTOPIC_BUFFER_LENGTH,
+                                                              pcThingName,
+                                                              usThingNameLength,
+                                                              xOperationName,
+                                                              eShadowTopicAccepted );
 
         xMQTTReturn = MQTT_AGENT_Unsubscribe( pxShadowClient->xMQTTClient,
                                               &xUnsubscribeParams,
@@ -699,22 +786,21 @@ static ShadowReturnCode_t prvShadowUnsubscribeFromAcceptedRejected( BaseType_t
                                             "Unsubscribe from accepted topic" );
     }
 
-    if( pcRejectedTopic != NULL )
-    {
-        /* Fill the rejected topic. */
-        xUnsubscribeParams.usTopicLength = prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                                           shadowTOPIC_BUFFER_LENGTH,
-                                                           pcRejectedTopic,
-                                                           pcThingName );
+    /* Fill the rejected topic. */
+    xUnsubscribeParams.usTopicLength = SHADOW_TopicBuild( ( char * ) pxShadowClient->ucTopicBuffer,
+                                                          shadowTOPIC_BUFFER_LENGTH,
+                                                          pcThingName,
+                                                          usThingNameLength,
+                                                          xOperationName,
+                                                          eShadowTopicRejected );
 
-        xMQTTReturn = MQTT_AGENT_Unsubscribe( pxShadowClient->xMQTTClient,
-                                              &xUnsubscribeParams,
-                                              pxTimeOutData->xTicksRemaining );
+    xMQTTReturn = MQTT_AGENT_Unsubscribe( pxShadowClient->xMQTTClient,
+                                          &xUnsubscribeParams,
+                                          pxTimeOutData->xTicksRemaining );
 
-        xReturn = prvConvertMQTTReturnCode( xMQTTReturn,
-                                            ( ShadowClientHandle_t ) xShadowClientID, /*lint !e923 Safe cast from pointer handle. */
-                                            "Unsubscribe from rejected topic" );
-    }
+    xReturn = prvConvertMQTTReturnCode( xMQTTReturn,
+                                        ( ShadowClientHandle_t ) xShadowClientID, /*lint !e923 Safe cast from pointer handle. */
+                                        "Unsubscribe from rejected topic" );
 
     return xReturn;
 }
@@ -726,12 +812,18 @@ static BaseType_t prvShadowMQTTCallback( void * pvUserData,
     BaseType_t xOperationMatched = pdFALSE;
     ShadowClient_t * pxShadowClient;
     const MQTTPublishData_t * pxPublishData;
-    ShadowOperationName_t xOperationName;
+    ShadowTopic_t xTopic;
+    ShadowJSONDoc_t xDoc;
     ShadowReturnCode_t xResult;
     const CallbackCatalogEntry_t * pxCallbackCatalogEntry;
+    ShadowPendingOperation_t * pxOperation;
+    ShadowCompletion_t xCompletions[ shadowconfigMAX_PENDING_OPERATIONS ];
+    BaseType_t xCompletionCount = 0;
     BaseType_t xReturn = pdFALSE;
-    BaseType_t xCompareLen;
     BaseType_t xShadowClientID;
+    BaseType_t xIterator;
+    const char * pcClientToken = NULL;
+    uint16_t usClientTokenLength;
 
 
     xShadowClientID = *( ( BaseType_t * ) pvUserData ); /*lint !e9087 Safe cast from pointer handle. */
@@ -741,95 +833,107 @@ static BaseType_t prvShadowMQTTCallback( void * pvUserData,
     {
         pxPublishData = ( &( pxCallbackParams->u.xPublishData ) );
 
-        /* If xOperationMutex is locked, the client is waiting on the acceptance
-         * or rejection of a publish. Publish results take priority over user notify
-         * callbacks. This also means that the client will not be notified of gets or
-         * deletes performed by itself in a user notify callback. However, the client
-         * will still be notified of updates performed by itself if it has registered
-         * a callback for /update/documents or update/delta. */
+        /* Classify the topic once; both the pending operations and the
+         * callback catalog are then matched on the parsed Thing Name. */
+        if( SHADOW_TopicParse( pxPublishData->pucTopic,
+                               pxPublishData->usTopicLength,
+                               &xTopic ) == pdFALSE )
+        {
+            xTopic.xOperationName = eShadowOperationOther;
+            xTopic.xStatus = eShadowTopicNoStatus;
+        }
 
-        if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
-                            portMAX_DELAY ) == pdPASS )
+        /* Responses to pending operations take priority over user notify
+         * callbacks. This also means that the client will not be notified of
+         * gets or deletes performed by itself in a user notify callback.
+         * However, the client will still be notified of updates performed by
+         * itself if it has registered a callback for /update/documents or
+         * update/delta. */
+        if( xTopic.xStatus != eShadowTopicNoStatus )
         {
-            if( pxShadowClient->pxOperationData != NULL )
+            xResult = ( xTopic.xStatus == eShadowTopicAccepted ) ? eShadowSuccess : eShadowFailure;
+
+            /* The response carries the client token of the operation it
+             * answers. Parse it before locking the pending operations. The
+             * MQTT agent calls back from one task, so the client's token
+             * arena is not shared. */
+            ( void ) SHADOW_JSONParse( &xDoc,
+                                       pxShadowClient->xJSONTokens,
+                                       shadowconfigJSON_JSMN_TOKENS,
+                                       ( const char * ) pxPublishData->pvData,
+                                       pxPublishData->ulDataLength );
+            usClientTokenLength = SHADOW_JSONGetClientToken( &xDoc, &pcClientToken );
+
+            if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                                portMAX_DELAY ) == pdPASS )
             {
-                /* Verify Thing Name and operation by comparing the received topic with
-                 * the current operation's topic. */
-
-                xCompareLen = ( BaseType_t ) configMIN( ( BaseType_t ) strlen( ( const char * ) pxShadowClient->ucTopicBuffer ),
-                                                        ( BaseType_t ) pxPublishData->usTopicLength );
-
-                if( strncmp( ( const char * ) pxPublishData->pucTopic,
-                             ( const char * ) pxShadowClient->ucTopicBuffer,
-                             ( size_t ) xCompareLen ) == 0 )
+                pxOperation = prvFindPendingOperation( pxShadowClient,
+                                                       xTopic.xOperationName,
+                                                       xTopic.pcThingName,
+                                                       xTopic.usThingNameLength,
+                                                       pcClientToken,
+                                                       usClientTokenLength );
+
+                if( pxOperation != NULL )
                 {
-                    /* Parse the in-progress operation and result. */
-                    xOperationName = ( pxShadowClient->pxOperationData )->xOperationInProgress;
-                    xResult = prvParseShadowOperationStatus( pxPublishData->pucTopic,
-                                                             pxPublishData->usTopicLength );
-
-                    /* Both an operation and result were identified, and both match
-                     * the operation this Shadow Client is waiting on; call the
-                     * operation-specific callback. */
-                    if( ( xResult != eShadowUnknown ) && ( xOperationName != eShadowOperationOther ) )
+                    xOperationMatched = pdTRUE;
+
+                    /* For failures, get the code and message. */
+                    if( xResult == eShadowFailure )
                     {
-                        xOperationMatched = pdTRUE;
+                        xResult = prvGetErrorCodeAndMessage( &xDoc,
+                                                             xShadowClientID,
+                                                             prvGetOperationName( xTopic.xOperationName ) );
+                    }
 
-                        switch( xOperationName )
+                    if( xTopic.xOperationName == eShadowOperationGet )
+                    {
+                        /* For successes, fill the user's buffer with the Shadow
+                         * document and take the MQTT buffer. */
+                        if( xResult == eShadowSuccess )
+                        {
+                            pxOperation->pxOperationParams->pcData = ( const char * ) pxPublishData->pvData;
+                            pxOperation->pxOperationParams->ulDataLength = pxPublishData->ulDataLength;
+                            pxOperation->pxOperationParams->xBuffer = pxPublishData->xBuffer;
+                            xReturn = pdTRUE;
+                        }
+                        else
                         {
-                            case eShadowOperationUpdate:
-                                prvShadowUpdateCallback( xShadowClientID,
-                                                         xResult,
-                                                         ( pxShadowClient->pxOperationData )->pxOperationParams,
-                                                         ( const char * ) pxPublishData->pvData,
-                                                         pxPublishData->ulDataLength );
-                                break;
-
-                            case eShadowOperationGet:
-                                prvShadowGetCallback( xShadowClientID,
-                                                      xResult,
-                                                      ( pxShadowClient->pxOperationData )->pxOperationParams,
-                                                      ( const char * ) pxPublishData->pvData,
-                                                      pxPublishData->ulDataLength,
-                                                      pxPublishData->xBuffer );
-
-                                /* Only take an MQTT buffer if the Get operation succeeded. */
-                                if( xResult == eShadowSuccess )
-                                {
-                                    xReturn = pdTRUE;
-                                }
-
-                                break;
-
-                            case eShadowOperationDelete:
-                                prvShadowDeleteCallback( xShadowClientID,
-                                                         xResult,
-                                                         ( const char * ) pxPublishData->pvData,
-                                                         pxPublishData->ulDataLength );
-                                break;
-
-                            default:
-                                /* Should not fall here. */
-                                break;
+                            pxOperation->pxOperationParams->pcData = NULL;
+                            pxOperation->pxOperationParams->ulDataLength = 0;
                         }
                     }
+
+                    if( prvCompletePendingOperation( pxShadowClient,
+                                                     pxOperation,
+                                                     xResult,
+                                                     &( xCompletions[ 0 ] ) ) == pdTRUE )
+                    {
+                        xCompletionCount = 1;
+                    }
                 }
+
+                configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
             }
 
-            configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+            prvInvokeCompletions( xCompletions, xCompletionCount );
         }
 
-        /* If the received topic doesn't match the current operation, it's
+        /* If the received topic doesn't match a pending operation, it's
          * still possible for it to match a registered callback. */
-        if( xOperationMatched == pdFALSE )
+        if( ( xOperationMatched == pdFALSE ) && ( xTopic.xOperationName != eShadowOperationOther ) )
         {
-            pxCallbackCatalogEntry = prvMatchCallbackTopic( pxShadowClient,
-                                                            pxPublishData->pucTopic, pxPublishData->usTopicLength,
-                                                            &xOperationName );
+            pxCallbackCatalogEntry = prvMatchCallbackThing( pxShadowClient, &xTopic );
+
+            if( ( xTopic.xOperationName == eShadowOperationDelete ) &&
+                ( xTopic.xStatus == eShadowTopicAccepted ) )
+            {
+                xTopic.xOperationName = eShadowOperationDeletedByAnother;
+            }
 
             if( pxCallbackCatalogEntry != NULL )
             {
-                switch( xOperationName )
+                switch( xTopic.xOperationName )
                 {
                     case eShadowOperationUpdateDocuments:
 
@@ -882,9 +986,35 @@ static BaseType_t prvShadowMQTTCallback( void * pvUserData,
             Shadow_debug_printf( ( "[Shadow %d] Warning: got an MQTT disconnect"
                                    " message.\r\n", xShadowClientID ) );
 
-            prvSetSubscribedFlag( pxShadowClient, eShadowOperationUpdate, 0 );
-            prvSetSubscribedFlag( pxShadowClient, eShadowOperationGet, 0 );
-            prvSetSubscribedFlag( pxShadowClient, eShadowOperationDelete, 0 );
+            for( xIterator = 0; xIterator < shadowconfigMAX_SUBSCRIBED_THINGS; xIterator++ )
+            {
+                pxShadowClient->ucSubscribedOperations[ xIterator ] = 0;
+            }
+
+            /* The responses to pending operations will not arrive. */
+            if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                                portMAX_DELAY ) == pdPASS )
+            {
+                for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+                {
+                    pxOperation = &( pxShadowClient->xPendingOperations[ xIterator ] );
+
+                    if( ( pxOperation->xInUse == pdTRUE ) && ( pxOperation->xComplete == pdFALSE ) )
+                    {
+                        if( prvCompletePendingOperation( pxShadowClient,
+                                                         pxOperation,
+                                                         eShadowFailure,
+                                                         &( xCompletions[ xCompletionCount ] ) ) == pdTRUE )
+                        {
+                            xCompletionCount++;
+                        }
+                    }
+                }
+
+                configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+            }
+
+            prvInvokeCompletions( xCompletions, xCompletionCount );
 
             /*_RB_ TODO below. */
             /* TODO: resubscribe to all callback topics. */
@@ -896,231 +1026,473 @@ static BaseType_t prvShadowMQTTCallback( void * pvUserData,
 
 /*-----------------------------------------------------------*/
 
-static ShadowReturnCode_t prvParseShadowOperationStatus( const uint8_t * const
-                                                         pucTopic,
-                                                         uint16_t usTopicLength )
+static const CallbackCatalogEntry_t * prvMatchCallbackThing( const ShadowClient_t * const pxShadowClient,
+                                                             const ShadowTopic_t * const pxTopic )
 {
-    ShadowReturnCode_t xResult = eShadowUnknown;
-    const uint8_t * pucTopicStatus;
-    size_t xCompareLength;
+    const CallbackCatalogEntry_t * pxReturn = NULL;
+    BaseType_t xIndex;
 
-    xCompareLength = strlen( shadowTOPIC_SUFFIX_ACCEPTED );
-    pucTopicStatus = pucTopic + usTopicLength - xCompareLength;
+    xIndex = SHADOW_TopicIndexFind( pxShadowClient->xCallbackIndex,
+                                    shadowconfigMAX_THINGS_WITH_CALLBACKS,
+                                    pxTopic->pcThingName,
+                                    pxTopic->usThingNameLength,
+                                    pxTopic->ulThingNameHash );
 
-    if( strncmp( ( const char * ) pucTopicStatus,
-                 shadowTOPIC_SUFFIX_ACCEPTED,
-                 xCompareLength ) == 0 )
+    if( ( xIndex >= 0 ) && ( pxShadowClient->xCallbackCatalog[ xIndex ].xInUse == pdTRUE ) )
     {
-        xResult = eShadowSuccess;
-    }
-    else
-    {
-        xCompareLength = strlen( shadowTOPIC_SUFFIX_REJECTED );
-        pucTopicStatus = pucTopic + usTopicLength - xCompareLength;
-
-        if( strncmp( ( const char * ) pucTopicStatus,
-                     shadowTOPIC_SUFFIX_REJECTED,
-                     xCompareLength ) == 0 )
-        {
-            xResult = eShadowFailure;
-        }
+        pxReturn = &( pxShadowClient->xCallbackCatalog[ xIndex ] );
     }
 
-    return xResult;
+    return pxReturn;
 }
 
 /*-----------------------------------------------------------*/
 
-static const CallbackCatalogEntry_t * prvMatchCallbackTopic( const ShadowClient_t * const pxShadowClient,
-                                                             const uint8_t * const pucTopic,
-                                                             uint16_t usTopicLength,
-                                                             ShadowOperationName_t * const pxOperationName )
+static const char * prvGetOperationName( ShadowOperationName_t xOperationName )
 {
-    const CallbackCatalogEntry_t * pxReturn = NULL;
-    BaseType_t xIterator, xTopicFound = pdFALSE;
-    uint8_t ucTopicBuffer[ shadowTOPIC_BUFFER_LENGTH ];
-    size_t xCompareLength;
+    const char * pcReturn;
 
-    for( xIterator = 0; xIterator < shadowconfigMAX_THINGS_WITH_CALLBACKS; xIterator++ )
+    switch( xOperationName )
     {
-        pxReturn = &( pxShadowClient->xCallbackCatalog[ xIterator ] );
-
-        if( pxReturn->xInUse == pdTRUE )
-        {
-            xCompareLength = prvCreateTopic( ( char * ) ucTopicBuffer,
-                                             shadowTOPIC_BUFFER_LENGTH,
-                                             shadowTOPIC_PREFIX, pxReturn->xCallbackInfo.pcThingName );
+        case eShadowOperationUpdate:
+            pcReturn = shadowTOPIC_OPERATION_UPDATE;
+            break;
 
-            if( strncmp( ( const char * ) ucTopicBuffer,
-                         ( const char * ) pucTopic,
-                         xCompareLength ) == 0 )
-            {
-                xTopicFound = pdTRUE;
+        case eShadowOperationGet:
+            pcReturn = shadowTOPIC_OPERATION_GET;
+            break;
 
-                xCompareLength = prvCreateTopic( ( char * ) ucTopicBuffer,
-                                                 shadowTOPIC_BUFFER_LENGTH, shadowTOPIC_UPDATE_DOCUMENTS,
-                                                 pxReturn->xCallbackInfo.pcThingName );
+        case eShadowOperationDelete:
+            pcReturn = shadowTOPIC_OPERATION_DELETE;
+            break;
 
-                xCompareLength = configMAX( xCompareLength, usTopicLength );
+        default:
+            pcReturn = "other";
+            break;
+    }
 
-                if( pxOperationName != NULL )
-                {
-                    if( strncmp( ( const char * ) ucTopicBuffer,
-                                 ( const char * ) pucTopic,
-                                 xCompareLength ) == 0 )
-                    {
-                        *pxOperationName = eShadowOperationUpdateDocuments;
-                    }
-                    else
-                    {
-                        xCompareLength = prvCreateTopic( ( char * ) ucTopicBuffer,
-                                                         shadowTOPIC_BUFFER_LENGTH, shadowTOPIC_UPDATE_DELTA,
-                                                         pxReturn->xCallbackInfo.pcThingName );
+    return pcReturn;
+}
 
-                        xCompareLength = configMAX( xCompareLength, usTopicLength );
+/*-----------------------------------------------------------*/
 
-                        if( strncmp( ( const char * ) ucTopicBuffer,
-                                     ( const char * ) pucTopic,
-                                     xCompareLength ) == 0 )
-                        {
-                            *pxOperationName = eShadowOperationUpdateDelta;
-                        }
-                        else
-                        {
-                            xCompareLength = prvCreateTopic( ( char * ) ucTopicBuffer,
-                                                             shadowTOPIC_BUFFER_LENGTH,
-                                                             shadowTOPIC_DELETE_ACCEPTED,
-                                                             pxReturn->xCallbackInfo.pcThingName );
-
-                            xCompareLength = configMAX( xCompareLength, usTopicLength );
-
-                            if( strncmp( ( const char * ) ucTopicBuffer,
-                                         ( const char * ) pucTopic,
-                                         xCompareLength ) == 0 )
-                            {
-                                *pxOperationName = eShadowOperationDeletedByAnother;
-                            }
-                            else
-                            {
-                                *pxOperationName = eShadowOperationOther;
-                            }
-                        }
-                    }
-                }
+static uint32_t prvCreateClientTokenDocument( uint32_t ulSequence,
+                                              char * const pcDocument,
+                                              const char ** ppcClientToken )
+{
+    static const char cHexDigits[] = "0123456789abcdef";
+    char * pcClientToken;
+    uint32_t ulDigits = ulSequence;
+    BaseType_t xIndex;
 
-                break;
-            }
-        }
-    }
+    ( void ) memcpy( pcDocument,
+                     shadowCLIENT_TOKEN_DOCUMENT_PREFIX,
+                     sizeof( shadowCLIENT_TOKEN_DOCUMENT_PREFIX ) - 1 );
+    pcClientToken = &( pcDocument[ sizeof( shadowCLIENT_TOKEN_DOCUMENT_PREFIX ) - 1 ] );
 
-    if( xTopicFound == pdFALSE )
+    for( xIndex = shadowGENERATED_CLIENT_TOKEN_LENGTH - 1; xIndex >= 0; xIndex-- )
     {
-        pxReturn = NULL;
+        pcClientToken[ xIndex ] = cHexDigits[ ulDigits & 0xFUL ];
+        ulDigits >>= 4;
     }
 
-    return pxReturn;
+    /* The suffix includes the terminating null. */
+    ( void ) memcpy( &( pcClientToken[ shadowGENERATED_CLIENT_TOKEN_LENGTH ] ),
+                     shadowCLIENT_TOKEN_DOCUMENT_SUFFIX,
+                     sizeof( shadowCLIENT_TOKEN_DOCUMENT_SUFFIX ) );
+
+    *ppcClientToken = pcClientToken;
+
+    return ( uint32_t ) ( shadowCLIENT_TOKEN_DOCUMENT_LENGTH - 1 );
 }
 
 /*-----------------------------------------------------------*/
 
-static void prvShadowUpdateCallback( BaseType_t xShadowClientID,
-                                     ShadowReturnCode_t xResult,
-                                     const ShadowOperationParams_t * const pxParams,
-                                     const char * const pcData,
-                                     uint32_t ulDataLength )
+static ShadowPendingOperation_t * prvClaimPendingOperation( const ShadowOperationCallParams_t * const pxParams,
+                                                            ShadowOperationCallback_t xCallback,
+                                                            void * pvCallbackContext,
+                                                            const char * const pcClientToken,
+                                                            uint16_t usClientTokenLength,
+                                                            uint32_t ulSequence,
+                                                            TickType_t xStartTicks )
 {
-    /* Remove warning about unused parameters. */
-    ( void ) pxParams;
-
     ShadowClient_t * pxShadowClient;
+    ShadowPendingOperation_t * pxOperation;
+    ShadowPendingOperation_t * pxReturn = NULL;
+    BaseType_t xIterator;
 
-    BaseType_t xReturn;
+    pxShadowClient = &( xShadowClients[ pxParams->xShadowClientID ] );
 
-    pxShadowClient = &( xShadowClients[ xShadowClientID ] );
+    if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                        portMAX_DELAY ) == pdPASS )
+    {
+        for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+        {
+            pxOperation = &( pxShadowClient->xPendingOperations[ xIterator ] );
+
+            if( pxOperation->xInUse == pdFALSE )
+            {
+                pxOperation->xInUse = pdTRUE;
+                pxOperation->xComplete = pdFALSE;
+                pxOperation->xOperationName = pxParams->xOperationName;
+                pxOperation->pxOperationParams = pxParams->pxOperationParams;
+                pxOperation->xCallback = xCallback;
+                pxOperation->pvCallbackContext = pvCallbackContext;
+                pxOperation->xStartTicks = xStartTicks;
+                pxOperation->xTimeoutTicks = pxParams->xTimeoutTicks;
+                pxOperation->ulSequence = ulSequence;
+                pxOperation->xResult = eShadowUnknown;
+                pxOperation->usClientTokenLength = usClientTokenLength;
+
+                if( usClientTokenLength > ( uint16_t ) 0 )
+                {
+                    ( void ) memcpy( pxOperation->cClientToken,
+                                     pcClientToken,
+                                     ( size_t ) usClientTokenLength );
+                }
 
-    /* Verify client token match. */
-    xReturn = SHADOW_JSONDocClientTokenMatch( pxParams->pcData,
-                                              pxParams->ulDataLength,
-                                              pcData,
-                                              ulDataLength );
+                pxReturn = pxOperation;
+                break;
+            }
+        }
 
-    if( xReturn == pdPASS )
-    {
-        pxShadowClient->xOperationResult = xResult;
+        pxShadowClient->ulNextSequence = ulSequence + ( uint32_t ) 1;
 
-        /* For failures, get the code and message. */
-        if( xResult == eShadowFailure )
+        if( ( pxReturn != NULL ) && ( xCallback != NULL ) )
         {
-            pxShadowClient->xOperationResult = prvGetErrorCodeAndMessage( pcData,
-                                                                          ulDataLength,
-                                                                          xShadowClientID,
-                                                                          shadowTOPIC_OPERATION_UPDATE );
+            prvArmTimeoutTimer( pxParams->xShadowClientID );
         }
 
-        configASSERT( xSemaphoreGive( pxShadowClient->xCallbackSemaphore ) == pdPASS );
+        configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
     }
+
+    return pxReturn;
 }
 
 /*-----------------------------------------------------------*/
 
-static void prvShadowGetCallback( BaseType_t xShadowClientID,
-                                  ShadowReturnCode_t xResult,
-                                  ShadowOperationParams_t * const pxParams,
-                                  const char * const pcData,
-                                  uint32_t ulDataLength,
-                                  MQTTBufferHandle_t xBuffer )
+static ShadowPendingOperation_t * prvFindPendingOperation( ShadowClient_t * const pxShadowClient,
+                                                           ShadowOperationName_t xOperationName,
+                                                           const char * const pcThingName,
+                                                           uint16_t usThingNameLength,
+                                                           const char * const pcClientToken,
+                                                           uint16_t usClientTokenLength )
 {
-    ShadowClient_t * pxShadowClient;
-
-    pxShadowClient = &( xShadowClients[ xShadowClientID ] );
-    pxShadowClient->xOperationResult = xResult;
+    ShadowPendingOperation_t * pxOperation;
+    ShadowPendingOperation_t * pxReturn = NULL;
+    ShadowPendingOperation_t * pxOldest = NULL;
+    uint32_t ulAge, ulOldestAge = 0;
+    BaseType_t xIterator;
 
-/* For successes, fill the user's buffer with the Shadow document. */
-    if( xResult == eShadowSuccess )
+    for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
     {
-        pxParams->pcData = pcData;
-        pxParams->ulDataLength = ulDataLength;
-        pxParams->xBuffer = xBuffer;
+        pxOperation = &( pxShadowClient->xPendingOperations[ xIterator ] );
+
+        if( ( pxOperation->xInUse == pdTRUE ) &&
+            ( pxOperation->xComplete == pdFALSE ) &&
+            ( pxOperation->xOperationName == xOperationName ) &&
+            ( strlen( pxOperation->pxOperationParams->pcThingName ) == ( size_t ) usThingNameLength ) &&
+            ( strncmp( pxOperation->pxOperationParams->pcThingName,
+                       pcThingName,
+                       ( size_t ) usThingNameLength ) == 0 ) )
+        {
+            if( ( usClientTokenLength > ( uint16_t ) 0 ) &&
+                ( pxOperation->usClientTokenLength == usClientTokenLength ) &&
+                ( strncmp( pxOperation->cClientToken,
+                           pcClientToken,
+                           ( size_t ) usClientTokenLength ) == 0 ) )
+            {
+                pxReturn = pxOperation;
+                break;
+            }
+
+            /* A response without a client token, for instance one too large
+             * to be parsed, goes to the oldest operation. A response with an
+             * unknown client token may only go to the oldest operation
+             * published without one. */
+            if( ( usClientTokenLength == ( uint16_t ) 0 ) ||
+                ( pxOperation->usClientTokenLength == ( uint16_t ) 0 ) )
+            {
+                ulAge = pxShadowClient->ulNextSequence - pxOperation->ulSequence;
+
+                if( ( pxOldest == NULL ) || ( ulAge > ulOldestAge ) )
+                {
+                    pxOldest = pxOperation;
+                    ulOldestAge = ulAge;
+                }
+            }
+        }
     }
-/* For failures , get the code and message. */
-    else
+
+    if( pxReturn == NULL )
     {
-        pxShadowClient->xOperationResult = prvGetErrorCodeAndMessage( pcData,
-                                                                      ulDataLength,
-                                                                      xShadowClientID,
-                                                                      shadowTOPIC_OPERATION_GET );
-        pxParams->pcData = NULL;
-        pxParams->ulDataLength = 0;
+        pxReturn = pxOldest;
     }
 
-    configASSERT( xSemaphoreGive( pxShadowClient->xCallbackSemaphore ) == pdPASS );
+    return pxReturn;
 }
+
 /*-----------------------------------------------------------*/
 
-static void prvShadowDeleteCallback( BaseType_t xShadowClientID,
-                                     ShadowReturnCode_t xResult,
-                                     const char * const pcData,
-                                     uint32_t ulDataLength )
+static BaseType_t prvHasPendingOperation( ShadowClient_t * const pxShadowClient,
+                                          const char * const pcThingName,
+                                          ShadowOperationName_t xOperationName )
 {
-    ShadowClient_t * pxShadowClient;
+    BaseType_t xIterator, xReturn = pdFALSE;
 
-    pxShadowClient = &( xShadowClients[ xShadowClientID ] );
-    pxShadowClient->xOperationResult = xResult;
-
-    if( xResult == eShadowFailure )
+    if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                        portMAX_DELAY ) == pdPASS )
     {
-        pxShadowClient->xOperationResult = prvGetErrorCodeAndMessage( pcData,
-                                                                      ulDataLength,
-                                                                      xShadowClientID,
-                                                                      shadowTOPIC_OPERATION_DELETE );
-    }
-
-    configASSERT( xSemaphoreGive( pxShadowClient->xCallbackSemaphore ) == pdPASS );
+        for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+        {
+            if( ( pxShadowClient->xPendingOperations[ xIterator ].xInUse == pdTRUE ) &&
+                ( pxShadowClient->xPendingOperations[ xIterator ].xOperationName == xOperationName ) &&
+                ( strcmp( pxShadowClient->xPendingOperations[ xIterator ].pxOperationParams->pcThingName,
+                          pcThingName ) == 0 ) )
+            {
+                xReturn = pdTRUE;
+                break;
+            }
+        }
+
+        configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCompletePendingOperation( ShadowClient_t * const pxShadowClient,
+                                               ShadowPendingOperation_t * const pxOperation,
+                                               ShadowReturnCode_t xResult,
+                                               ShadowCompletion_t * const pxCompletion )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( pxOperation->xCallback == NULL )
+    {
+        /* Wake the task blocked in prvShadowOperation; it frees the entry. */
+        pxOperation->xResult = xResult;
+        pxOperation->xComplete = pdTRUE;
+        ( void ) xSemaphoreGive( pxOperation->xCompleteSemaphore );
+    }
+    else
+    {
+        pxCompletion->xCallback = pxOperation->xCallback;
+        pxCompletion->pvCallbackContext = pxOperation->pvCallbackContext;
+        pxCompletion->xResult = xResult;
+        pxCompletion->pxOperationParams = pxOperation->pxOperationParams;
+
+        pxOperation->xInUse = pdFALSE;
+        ( void ) xSemaphoreGive( pxShadowClient->xPendingSlots );
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvInvokeCompletions( const ShadowCompletion_t * const pxCompletions,
+                                  BaseType_t xCompletionCount )
+{
+    BaseType_t xIterator;
+
+    for( xIterator = 0; xIterator < xCompletionCount; xIterator++ )
+    {
+        pxCompletions[ xIterator ].xCallback( pxCompletions[ xIterator ].pvCallbackContext,
+                                              pxCompletions[ xIterator ].xResult,
+                                              pxCompletions[ xIterator ].pxOperationParams );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvCancelPendingOperation( ShadowClient_t * const pxShadowClient,
+                                             ShadowPendingOperation_t * const pxOperation,
+                                             uint32_t ulSequence )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                        portMAX_DELAY ) == pdPASS )
+    {
+        /* An asynchronous operation's entry may already have been completed
+         * and reused; ulSequence tells them apart. */
+        if( ( pxOperation->xInUse == pdTRUE ) &&
+            ( pxOperation->ulSequence == ulSequence ) &&
+            ( pxOperation->xComplete == pdFALSE ) )
+        {
+            if( pxOperation->xCallback == NULL )
+            {
+                /* The waiting task frees the entry. */
+                pxOperation->xComplete = pdTRUE;
+            }
+            else
+            {
+                pxOperation->xInUse = pdFALSE;
+                ( void ) xSemaphoreGive( pxShadowClient->xPendingSlots );
+            }
+
+            xReturn = pdTRUE;
+        }
+
+        configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+    }
+
+    return xReturn;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReleasePendingOperation( ShadowClient_t * const pxShadowClient,
+                                        ShadowPendingOperation_t * const pxOperation )
+{
+    if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                        portMAX_DELAY ) == pdPASS )
+    {
+        pxOperation->xInUse = pdFALSE;
+        pxOperation->xComplete = pdFALSE;
+        configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+    }
+
+    ( void ) xSemaphoreGive( pxShadowClient->xPendingSlots );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvArmTimeoutTimer( BaseType_t xShadowClientID )
+{
+    ShadowClient_t * pxShadowClient;
+    ShadowPendingOperation_t * pxOperation;
+    TickType_t xNow, xElapsed, xRemaining, xEarliest = 0;
+    BaseType_t xIterator, xFound = pdFALSE;
+
+    pxShadowClient = &( xShadowClients[ xShadowClientID ] );
+    xNow = xTaskGetTickCount();
+
+    for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+    {
+        pxOperation = &( pxShadowClient->xPendingOperations[ xIterator ] );
+
+        if( ( pxOperation->xInUse == pdTRUE ) &&
+            ( pxOperation->xComplete == pdFALSE ) &&
+            ( pxOperation->xCallback != NULL ) )
+        {
+            xElapsed = xNow - pxOperation->xStartTicks;
+            xRemaining = ( xElapsed < pxOperation->xTimeoutTicks ) ? ( pxOperation->xTimeoutTicks - xElapsed ) : 0;
+
+            if( ( xFound == pdFALSE ) || ( xRemaining < xEarliest ) )
+            {
+                xEarliest = xRemaining;
+                xFound = pdTRUE;
+            }
+        }
+    }
+
+    if( xFound == pdTRUE )
+    {
+        /* The timer service does not accept a period of 0. */
+        if( xEarliest == ( TickType_t ) 0 )
+        {
+            xEarliest = 1;
+        }
+
+        /* Only ever move the timer earlier. When it expires, it is armed
+         * again for the operations that are left. */
+        if( ( pxShadowClient->xTimerArmed == pdFALSE ) ||
+            ( xEarliest < ( TickType_t ) ( pxShadowClient->xTimerDeadline - xNow ) ) )
+        {
+            /* Do not block on the timer command queue while holding
+             * xOperationDataMutex; the timer service task may be waiting for
+             * it. */
+            if( xTimerChangePeriod( xTimeoutTimers[ xShadowClientID ], xEarliest, 0 ) == pdPASS )
+            {
+                pxShadowClient->xTimerDeadline = xNow + xEarliest;
+                pxShadowClient->xTimerArmed = pdTRUE;
+            }
+            else
+            {
+                Shadow_debug_printf( ( "[Shadow %d] Failed to arm the timeout timer.\r\n",
+                                       xShadowClientID ) );
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTimeoutTimerCallback( TimerHandle_t xTimer )
+{
+    ShadowClient_t * pxShadowClient;
+    ShadowPendingOperation_t * pxOperation;
+    ShadowCompletion_t xCompletions[ shadowconfigMAX_PENDING_OPERATIONS ];
+    BaseType_t xCompletionCount = 0;
+    BaseType_t xShadowClientID, xIterator;
+    TickType_t xNow;
+
+    xShadowClientID = ( BaseType_t ) pvTimerGetTimerID( xTimer ); /*lint !e923 Safe cast from timer ID. */
+    pxShadowClient = &( xShadowClients[ xShadowClientID ] );
+
+    /* The client may have been deleted after the timer was armed. */
+    if( pxShadowClient->xInUse == pdTRUE )
+    {
+        if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
+                            portMAX_DELAY ) == pdPASS )
+        {
+            pxShadowClient->xTimerArmed = pdFALSE;
+            xNow = xTaskGetTickCount();
+
+            for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+            {
+                pxOperation = &( pxShadowClient->xPendingOperations[ xIterator ] );
+
+                if( ( pxOperation->xInUse == pdTRUE ) &&
+                    ( pxOperation->xComplete == pdFALSE ) &&
+                    ( pxOperation->xCallback != NULL ) &&
+                    ( ( TickType_t ) ( xNow - pxOperation->xStartTicks ) >= pxOperation->xTimeoutTicks ) )
+                {
+                    Shadow_debug_printf( ( "[Shadow %d] Timeout waiting on"
+                                           " %s accepted/rejected.\r\n",
+                                           xShadowClientID,
+                                           prvGetOperationName( pxOperation->xOperationName ) ) );
+
+                    if( prvCompletePendingOperation( pxShadowClient,
+                                                     pxOperation,
+                                                     eShadowTimeout,
+                                                     &( xCompletions[ xCompletionCount ] ) ) == pdTRUE )
+                    {
+                        xCompletionCount++;
+                    }
+                }
+            }
+
+            prvArmTimeoutTimer( xShadowClientID );
+
+            configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+        }
+
+        prvInvokeCompletions( xCompletions, xCompletionCount );
+    }
 }
+
 /*-----------------------------------------------------------*/
 
-static ShadowReturnCode_t prvGetErrorCodeAndMessage( const char * const pcData,
-                                                     uint32_t ulDataLength,
+static TickType_t prvTicksRemaining( TimeOutData_t * const pxTimeOutData )
+{
+    if( xTaskCheckForTimeOut( &( pxTimeOutData->xTimeOut ),
+                              &( pxTimeOutData->xTicksRemaining ) ) == pdTRUE )
+    {
+        pxTimeOutData->xTicksRemaining = 0;
+    }
+
+    return pxTimeOutData->xTicksRemaining;
+}
+
+/*-----------------------------------------------------------*/
+
+static ShadowReturnCode_t prvGetErrorCodeAndMessage( const ShadowJSONDoc_t * const pxDoc,
                                                      BaseType_t xShadowClientID,
                                                      const char * const pcOperationName )
 {
@@ -1128,8 +1500,7 @@ static ShadowReturnCode_t prvGetErrorCodeAndMessage( const char * const pcData,
     char * pcErrorMessage;
     uint16_t usErrorMessageLength;
 
-    xErrorCode = ( ShadowReturnCode_t ) SHADOW_JSONGetErrorCodeAndMessage( pcData,
-                                                                           ulDataLength,
+    xErrorCode = ( ShadowReturnCode_t ) SHADOW_JSONGetErrorCodeAndMessage( pxDoc,
                                                                            &pcErrorMessage,
                                                                            &usErrorMessageLength );
 
@@ -1152,8 +1523,8 @@ static ShadowReturnCode_t prvGetErrorCodeAndMessage( const char * const pcData,
     ( void ) pcOperationName;
     ( void ) xShadowClientID;
 
-    /* SHADOW_JSONGetErrorCodeAndMessage may return 0 for bad pointer arguments.
-     * Convert this to a JSON parse error, as 0 is eShadowSuccess. */
+    /* SHADOW_JSONGetErrorCodeAndMessage may return 0 for a document without
+     * error code. Convert this to a JSON parse error, as 0 is eShadowSuccess. */
     if( xErrorCode == 0 )
     {
         xErrorCode = eShadowJSMNInval;
@@ -1164,83 +1535,193 @@ static ShadowReturnCode_t prvGetErrorCodeAndMessage( const char * const pcData,
 
 /*-----------------------------------------------------------*/
 
-static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxParams )
+static uint16_t prvGetDocumentClientToken( const char * const pcDoc,
+                                           uint32_t ulDocLength,
+                                           const char ** ppcClientToken )
 {
-    ShadowReturnCode_t xReturn = eShadowFailure;
+    jsmntok_t xTokens[ shadowconfigJSON_JSMN_TOKENS ];
+    ShadowJSONDoc_t xDoc;
+
+    ( void ) SHADOW_JSONParse( &xDoc, xTokens, shadowconfigJSON_JSMN_TOKENS, pcDoc, ulDocLength );
+
+    return SHADOW_JSONGetClientToken( &xDoc, ppcClientToken );
+}
+
+/*-----------------------------------------------------------*/
+
+static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxParams,
+                                              ShadowOperationCallback_t xCallback,
+                                              void * pvCallbackContext )
+{
+    ShadowReturnCode_t xReturn = eShadowSuccess;
     MQTTAgentPublishParams_t xPublishParams;
     ShadowClient_t * pxShadowClient;
+    ShadowPendingOperation_t * pxOperation = NULL;
     TimeOutData_t xTimeOutData;
-    ShadowOperationData_t xOperationData;
     MQTTAgentReturnCode_t xMQTTReturn;
+    uint8_t ucTopic[ shadowTOPIC_BUFFER_LENGTH ];
+    char cClientTokenDocument[ shadowCLIENT_TOKEN_DOCUMENT_LENGTH ];
+    const char * pcPublishMessage = pxParams->pcPublishMessage;
+    uint32_t ulPublishMessageLength = pxParams->ulPublishMessageLength;
+    const char * pcClientToken = NULL;
+    uint16_t usClientTokenLength = 0;
+    uint32_t ulSequence = 0;
+    TickType_t xStartTicks;
+    BaseType_t xOperationMutexTaken = pdFALSE;
+    BaseType_t xUnsubscribeAccepted;
+    uint16_t usThingNameLength;
+
+    usThingNameLength = ( uint16_t ) strlen( ( pxParams->pxOperationParams )->pcThingName );
 
     /* Initialize timeout data. */
+    xStartTicks = xTaskGetTickCount();
+    vTaskSetTimeOutState( &( xTimeOutData.xTimeOut ) );
     xTimeOutData.xTicksRemaining = pxParams->xTimeoutTicks;
 
-    /* Identify the relevant Shadow Client, then lock that client's operation mutex.
-     * This allows only one operation to be in progress. */
     pxShadowClient = &( xShadowClients[ ( pxParams->xShadowClientID ) ] );
 
-    if( xSemaphoreTake( pxShadowClient->xOperationMutex,
-                        xTimeOutData.xTicksRemaining ) == pdPASS )
+    /* Responses are matched to operations by client token. An update carries
+     * the client token of the user's document, if any. Get and delete are
+     * given a generated one below. */
+    if( pcPublishMessage != NULL )
+    {
+        usClientTokenLength = prvGetDocumentClientToken( pcPublishMessage,
+                                                         ulPublishMessageLength,
+                                                         &pcClientToken );
+
+        if( usClientTokenLength > ( uint16_t ) shadowconfigMAX_CLIENT_TOKEN_LENGTH )
+        {
+            Shadow_debug_printf( ( "[Shadow %d] Client token of %s is longer than"
+                                   " shadowconfigMAX_CLIENT_TOKEN_LENGTH.\r\n",
+                                   pxParams->xShadowClientID,
+                                   pxParams->pcOperationName ) );
+            xReturn = eShadowFailure;
+        }
+    }
+
+    /* Wait for a free pending operation. */
+    if( xReturn == eShadowSuccess )
     {
-        /* Subscribe to accepted/rejected if necessary. */
-        if( ( BaseType_t ) prvGetSubscribedFlag( pxShadowClient,
-                                                 pxParams->xOperationName ) == pdFALSE )
+        if( xSemaphoreTake( pxShadowClient->xPendingSlots,
+                            xTimeOutData.xTicksRemaining ) != pdPASS )
         {
-            xReturn = prvShadowSubscribeToAcceptedRejected( pxParams->xShadowClientID,
-                                                            ( pxParams->pxOperationParams )->pcThingName,
-                                                            pxParams->pcOperationAcceptedTopic,
-                                                            pxParams->pcOperationRejectedTopic,
-                                                            &xTimeOutData );
+            xReturn = eShadowTimeout;
+        }
+    }
+
+    /* Subscribe to accepted/rejected if necessary, then claim the pending
+     * operation. xOperationMutex only serializes subscription changes; it is
+     * released before the publish so that other operations may follow this
+     * one without waiting for its response. */
+    if( xReturn == eShadowSuccess )
+    {
+        if( xSemaphoreTake( pxShadowClient->xOperationMutex,
+                            prvTicksRemaining( &xTimeOutData ) ) == pdPASS )
+        {
+            xOperationMutexTaken = pdTRUE;
+
+            if( ( BaseType_t ) prvGetSubscribedFlag( pxShadowClient,
+                                                     ( pxParams->pxOperationParams )->pcThingName,
+                                                     pxParams->xOperationName ) == pdFALSE )
+            {
+                ( void ) prvTicksRemaining( &xTimeOutData );
+                xReturn = prvShadowSubscribeToAcceptedRejected( pxParams->xShadowClientID,
+                                                                ( pxParams->pxOperationParams )->pcThingName,
+                                                                pxParams->xOperationName,
+                                                                &xTimeOutData );
+            }
+
+            if( xReturn == eShadowSuccess )
+            {
+                /* The subscribe to accepted and rejected succeeded, so set the
+                 * appropriate flag. */
+                prvSetSubscribedFlag( pxShadowClient,
+                                      ( pxParams->pxOperationParams )->pcThingName,
+                                      pxParams->xOperationName,
+                                      1 );
+
+                ulSequence = pxShadowClient->ulNextSequence;
+
+                if( pcPublishMessage == NULL )
+                {
+                    ulPublishMessageLength = prvCreateClientTokenDocument( ulSequence,
+                                                                           cClientTokenDocument,
+                                                                           &pcClientToken );
+                    pcPublishMessage = cClientTokenDocument;
+                    usClientTokenLength = shadowGENERATED_CLIENT_TOKEN_LENGTH;
+                }
+
+                /* A slot was taken, so an entry is free. */
+                pxOperation = prvClaimPendingOperation( pxParams,
+                                                        xCallback,
+                                                        pvCallbackContext,
+                                                        pcClientToken,
+                                                        usClientTokenLength,
+                                                        ulSequence,
+                                                        xStartTicks );
+                configASSERT( pxOperation != NULL );
+            }
+
+            configASSERT( xSemaphoreGive( pxShadowClient->xOperationMutex ) == pdPASS );
         }
         else
         {
-            xReturn = eShadowSuccess;
+            xReturn = eShadowTimeout;
         }
 
-        if( xReturn == eShadowSuccess )
+        if( pxOperation == NULL )
         {
-            /* The subscribe to update/accepted and update/rejected succeeded,
-             * so set the appropriate flag. */
-            prvSetSubscribedFlag( pxShadowClient, pxParams->xOperationName, 1 );
-
-            /* This is guarded by xOperationMutex and should never fail. */
-            configASSERT( xSemaphoreTake( pxShadowClient->xCallbackSemaphore,
-                                          xTimeOutData.xTicksRemaining ) == pdPASS );
-
-            /* Fill ucTopicBuffer with the update topic. */
-            xPublishParams.usTopicLength =
-                prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                shadowTOPIC_BUFFER_LENGTH,
-                                pxParams->pcOperationTopic,
-                                ( pxParams->pxOperationParams )->pcThingName );
-
-            /* Operation parameters. */
-            xPublishParams.pucTopic = pxShadowClient->ucTopicBuffer;
-            xPublishParams.pvData = pxParams->pcPublishMessage;
-            xPublishParams.ulDataLength = pxParams->ulPublishMessageLength;
-            xPublishParams.xQoS = ( pxParams->pxOperationParams )->xQoS;
-
-            /* Data to pass to the callback. */
-            xOperationData.xOperationInProgress = pxParams->xOperationName;
-            xOperationData.pxOperationParams = pxParams->pxOperationParams;
-            pxShadowClient->pxOperationData = &xOperationData;
-
-            xMQTTReturn = MQTT_AGENT_Publish( pxShadowClient->xMQTTClient,
-                                              &xPublishParams,
-                                              xTimeOutData.xTicksRemaining );
-
-            /* Publish to operation topic. */
-            xReturn = prvConvertMQTTReturnCode( xMQTTReturn,
-                                                ( ShadowClientHandle_t ) ( pxParams->xShadowClientID ), /*lint !e923 Safe cast from pointer handle. */
-                                                "Publish to operation topic" );
+            ( void ) xSemaphoreGive( pxShadowClient->xPendingSlots );
+        }
+    }
+
+    if( pxOperation != NULL )
+    {
+        /* Operation parameters. The topic is built on the stack as other
+         * operations may be publishing at the same time. */
+        xPublishParams.usTopicLength = SHADOW_TopicBuild( ( char * ) ucTopic,
+                                                          shadowTOPIC_BUFFER_LENGTH,
+                                                          ( pxParams->pxOperationParams )->pcThingName,
+                                                          usThingNameLength,
+                                                          pxParams->xOperationName,
+                                                          eShadowTopicNoStatus );
+        xPublishParams.pucTopic = ucTopic;
+        xPublishParams.pvData = pcPublishMessage;
+        xPublishParams.ulDataLength = ulPublishMessageLength;
+        xPublishParams.xQoS = ( pxParams->pxOperationParams )->xQoS;
+
+        /* Publish to operation topic. */
+        xMQTTReturn = MQTT_AGENT_Publish( pxShadowClient->xMQTTClient,
+                                          &xPublishParams,
+                                          prvTicksRemaining( &xTimeOutData ) );
 
+        xReturn = prvConvertMQTTReturnCode( xMQTTReturn,
+                                            ( ShadowClientHandle_t ) ( pxParams->xShadowClientID ), /*lint !e923 Safe cast from pointer handle. */
+                                            "Publish to operation topic" );
+
+        /* Withdraw the operation, unless the response arrived before the
+         * publish call returned. In that case the operation completed. */
+        if( xReturn != eShadowSuccess )
+        {
+            if( prvCancelPendingOperation( pxShadowClient, pxOperation, ulSequence ) == pdFALSE )
+            {
+                xReturn = eShadowSuccess;
+            }
+        }
+
+        /* An asynchronous operation is now completed by its response or by
+         * the timeout timer. A blocking one waits here. */
+        if( xCallback == NULL )
+        {
             if( xReturn == eShadowSuccess )
             {
-                /* Wait for the semaphore to become available again; it should be
-                 * released by the update callback. */
-                if( xSemaphoreTake( pxShadowClient->xCallbackSemaphore,
-                                    xTimeOutData.xTicksRemaining ) != pdPASS )
+                if( xSemaphoreTake( pxOperation->xCompleteSemaphore,
+                                    prvTicksRemaining( &xTimeOutData ) ) == pdPASS )
+                {
+                    /* The MQTT callback reports the status as xResult. */
+                    xReturn = pxOperation->xResult;
+                }
+                else if( prvCancelPendingOperation( pxShadowClient, pxOperation, ulSequence ) == pdTRUE )
                 {
                     Shadow_debug_printf( ( "[Shadow %d] Timeout waiting on"
                                            " %s accepted/rejected.\r\n",
@@ -1250,83 +1731,76 @@ static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxPa
                 }
                 else
                 {
-                    /* The update callback reports its status as xOperationResult. */
-                    xReturn = pxShadowClient->xOperationResult;
+                    /* The response arrived just as the wait timed out. */
+                    ( void ) xSemaphoreTake( pxOperation->xCompleteSemaphore, 0 );
+                    xReturn = pxOperation->xResult;
                 }
             }
 
-            configASSERT( xSemaphoreGive( pxShadowClient->xCallbackSemaphore ) == pdPASS );
+            prvReleasePendingOperation( pxShadowClient, pxOperation );
         }
+    }
 
-        /* Unsubscribe. */
-        if( ( pxParams->pxOperationParams )->ucKeepSubscriptions == ( uint8_t ) 0 )
-        {
-            xTimeOutData.xTicksRemaining = configMAX( xTimeOutData.xTicksRemaining,
-                                                      pdMS_TO_TICKS( shadowconfigCLEANUP_TIME_MS ) );
+    /* Unsubscribe. Asynchronous operations keep their subscriptions, as the
+     * operations pipelined behind them need the same topics. */
+    if( ( xCallback == NULL ) &&
+        ( xOperationMutexTaken == pdTRUE ) &&
+        ( ( pxParams->pxOperationParams )->ucKeepSubscriptions == ( uint8_t ) 0 ) )
+    {
+        xTimeOutData.xTicksRemaining = configMAX( prvTicksRemaining( &xTimeOutData ),
+                                                  pdMS_TO_TICKS( shadowconfigCLEANUP_TIME_MS ) );
 
-            /* If the Shadow client is subscribed to delete/accepted for this
-             * Thing for a user notify callback, do not unsubscribe; that would
-             * break callback notify. */
-            if( pxParams->xOperationName == eShadowOperationDelete )
+        if( xSemaphoreTake( pxShadowClient->xOperationMutex,
+                            xTimeOutData.xTicksRemaining ) == pdPASS )
+        {
+            /* Other operations of the same type on the same Thing still need
+             * the subscriptions. */
+            if( prvHasPendingOperation( pxShadowClient,
+                                        pxParams->pxOperationParams->pcThingName,
+                                        pxParams->xOperationName ) == pdFALSE )
             {
-                ( void ) prvCreateTopic( ( char * ) pxShadowClient->ucTopicBuffer,
-                                         shadowTOPIC_BUFFER_LENGTH,
-                                         shadowTOPIC_DELETE_ACCEPTED,
-                                         pxParams->pxOperationParams->pcThingName );
-
-                /* If there's a callback registered for delete/accepted, only
-                 * unsubscribe from delete/rejected. */
-                if( prvMatchCallbackTopic( pxShadowClient,
-                                           pxShadowClient->ucTopicBuffer,
-                                           ( uint16_t )
-                                           strlen( ( const char * ) pxShadowClient->ucTopicBuffer ),
-                                           NULL ) == NULL )
+                /* If the Shadow client is subscribed to delete/accepted for this
+                 * Thing for a user notify callback, do not unsubscribe; that would
+                 * break callback notify. */
+                if( pxParams->xOperationName == eShadowOperationDelete )
                 {
-                    if( prvShadowUnsubscribeFromAcceptedRejected( pxParams->xShadowClientID,
-                                                                  pxParams->pxOperationParams->pcThingName,
-                                                                  NULL,
-                                                                  pxParams->pcOperationRejectedTopic,
-                                                                  &xTimeOutData ) == eShadowSuccess )
+                    /* If there's a callback registered for this Thing, it is
+                     * subscribed to delete/accepted; only unsubscribe from
+                     * delete/rejected. */
+                    xUnsubscribeAccepted = pdFALSE;
+
+                    if( SHADOW_TopicIndexFind( pxShadowClient->xCallbackIndex,
+                                               shadowconfigMAX_THINGS_WITH_CALLBACKS,
+                                               pxParams->pxOperationParams->pcThingName,
+                                               usThingNameLength,
+                                               SHADOW_TopicHash( pxParams->pxOperationParams->pcThingName,
+                                                                 usThingNameLength ) ) < 0 )
                     {
-                        prvSetSubscribedFlag( pxShadowClient,
-                                              pxParams->xOperationName,
-                                              0 );
+                        xUnsubscribeAccepted = pdTRUE;
                     }
                 }
-            }
-            else
-            {
+                else
+                {
+                    xUnsubscribeAccepted = pdTRUE;
+                }
+
                 if( prvShadowUnsubscribeFromAcceptedRejected( pxParams->xShadowClientID,
                                                               pxParams->pxOperationParams->pcThingName,
-                                                              pxParams->pcOperationAcceptedTopic,
-                                                              pxParams->pcOperationRejectedTopic,
+                                                              pxParams->xOperationName,
+                                                              xUnsubscribeAccepted,
                                                               &xTimeOutData ) == eShadowSuccess )
                 {
                     prvSetSubscribedFlag( pxShadowClient,
+                                          pxParams->pxOperationParams->pcThingName,
                                           pxParams->xOperationName,
                                           0 );
                 }
             }
-        }
 
-        /* Delete this operation's data so that the next operation has a clean Shadow
-         * Client, then release the operation mutex. */
-        if( xSemaphoreTake( pxShadowClient->xOperationDataMutex,
-                            portMAX_DELAY ) == pdPASS )
-        {
-            pxShadowClient->pxOperationData = NULL;
-            configASSERT( xSemaphoreGive( pxShadowClient->xOperationDataMutex ) == pdPASS );
+            memset( pxShadowClient->ucTopicBuffer, 0, shadowTOPIC_BUFFER_LENGTH );
+            configASSERT( xSemaphoreGive( pxShadowClient->xOperationMutex )
+                          == pdPASS );
         }
-        else
-        {
-            Shadow_debug_printf( ( "Error while taking mutex\n" ) );
-            configASSERT( 0 );
-        }
-
-        pxShadowClient->xOperationResult = eShadowSuccess;
-        memset( pxShadowClient->ucTopicBuffer, 0, shadowTOPIC_BUFFER_LENGTH );
-        configASSERT( xSemaphoreGive( pxShadowClient->xOperationMutex )
-                      == pdPASS );
     }
 
     return xReturn;
@@ -1334,54 +1808,82 @@ static ShadowReturnCode_t prvShadowOperation( ShadowOperationCallParams_t * pxPa
 
 /*-----------------------------------------------------------*/
 
+static BaseType_t prvFindSubscribedThing( const ShadowClient_t * const pxShadowClient,
+                                          const char * const pcThingName )
+{
+    uint16_t usThingNameLength = ( uint16_t ) strlen( pcThingName );
+
+    return SHADOW_TopicIndexFind( pxShadowClient->xSubscribedIndex,
+                                  shadowconfigMAX_SUBSCRIBED_THINGS,
+                                  pcThingName,
+                                  usThingNameLength,
+                                  SHADOW_TopicHash( pcThingName, usThingNameLength ) );
+}
+
+/*-----------------------------------------------------------*/
+
 static void prvSetSubscribedFlag( ShadowClient_t * const pxShadowClient,
+                                  const char * const pcThingName,
                                   ShadowOperationName_t xOperationName,
                                   BaseType_t xValue )
 {
-    switch( xOperationName )
-    {
-        case eShadowOperationUpdate:
-            pxShadowClient->xUpdateSubscribed = xValue;
-            break;
+    BaseType_t xIndex = prvFindSubscribedThing( pxShadowClient, pcThingName );
+    uint8_t ucBit = ( uint8_t ) ( 1U << ( uint32_t ) xOperationName );
 
-        case eShadowOperationGet:
-            pxShadowClient->xGetSubscribed = xValue;
-            break;
+    if( xValue != 0 )
+    {
+        /* Take a free entry for a Thing not recorded yet. */
+        if( xIndex < 0 )
+        {
+            for( xIndex = 0; xIndex < shadowconfigMAX_SUBSCRIBED_THINGS; xIndex++ )
+            {
+                if( pxShadowClient->ucSubscribedOperations[ xIndex ] == 0U )
+                {
+                    break;
+                }
+            }
 
-        case eShadowOperationDelete:
-            pxShadowClient->xDeleteSubscribed = xValue;
-            break;
+            if( ( xIndex < shadowconfigMAX_SUBSCRIBED_THINGS ) &&
+                ( strlen( pcThingName ) <= ( size_t ) shadowTOPIC_MAX_THING_NAME_LENGTH ) )
+            {
+                ( void ) strcpy( pxShadowClient->cSubscribedThingNames[ xIndex ], pcThingName );
+                SHADOW_TopicIndexSet( &( pxShadowClient->xSubscribedIndex[ xIndex ] ),
+                                      pxShadowClient->cSubscribedThingNames[ xIndex ] );
+            }
+            else
+            {
+                xIndex = -1;
+            }
+        }
 
-        default:
-            /* Should not fall here. */
-            break;
+        if( xIndex >= 0 )
+        {
+            pxShadowClient->ucSubscribedOperations[ xIndex ] |= ucBit;
+        }
+    }
+    else if( xIndex >= 0 )
+    {
+        pxShadowClient->ucSubscribedOperations[ xIndex ] &= ( uint8_t ) ~ucBit;
+    }
+    else
+    {
+        /* Not recorded, nothing to clear. */
     }
 }
 
 /*-----------------------------------------------------------*/
 
 static uint8_t prvGetSubscribedFlag( const ShadowClient_t * const pxShadowClient,
+                                     const char * const pcThingName,
                                      ShadowOperationName_t xOperationName )
 {
+    BaseType_t xIndex = prvFindSubscribedThing( pxShadowClient, pcThingName );
     uint8_t ucReturn = 0;
 
-    switch( xOperationName )
+    if( ( xIndex >= 0 ) &&
+        ( ( pxShadowClient->ucSubscribedOperations[ xIndex ] & ( uint8_t ) ( 1U << ( uint32_t ) xOperationName ) ) != 0U ) )
     {
-        case eShadowOperationUpdate:
-            ucReturn = ( uint8_t ) pxShadowClient->xUpdateSubscribed;
-            break;
-
-        case eShadowOperationGet:
-            ucReturn = ( uint8_t ) pxShadowClient->xGetSubscribed;
-            break;
-
-        case eShadowOperationDelete:
-            ucReturn = ( uint8_t ) pxShadowClient->xDeleteSubscribed;
-            break;
-
-        default:
-            /* Should not fall here. */
-            break;
+        ucReturn = 1;
     }
 
     return ucReturn;
@@ -1393,7 +1895,7 @@ ShadowReturnCode_t SHADOW_ClientCreate( ShadowClientHandle_t * pxShadowClientHan
                                         const ShadowCreateParams_t * const pxShadowCreateParams )
 {
     ShadowClient_t * pxShadowClient;
-    BaseType_t xShadowClientID;
+    BaseType_t xShadowClientID, xIterator;
     ShadowReturnCode_t xReturn = eShadowFailure;
     MQTTAgentReturnCode_t xMQTTReturn;
 
@@ -1420,10 +1922,32 @@ ShadowReturnCode_t SHADOW_ClientCreate( ShadowClientHandle_t * pxShadowClientHan
         if( xReturn == eShadowSuccess )
         {
             /* Create synchronization mechanisms; these calls should never fail. */
-            pxShadowClient->xCallbackSemaphore = xSemaphoreCreateBinaryStatic( &( pxShadowClient->xCallbackSemaphoreBuffer ) );
             pxShadowClient->xOperationMutex = xSemaphoreCreateMutexStatic( &( pxShadowClient->xOperationMutexBuffer ) );
             pxShadowClient->xOperationDataMutex = xSemaphoreCreateMutexStatic( &( pxShadowClient->xOperationDataMutexBuffer ) );
-            configASSERT( xSemaphoreGive( pxShadowClient->xCallbackSemaphore ) == pdPASS );
+            pxShadowClient->xPendingSlots = xSemaphoreCreateCountingStatic( shadowconfigMAX_PENDING_OPERATIONS,
+                                                                            shadowconfigMAX_PENDING_OPERATIONS,
+                                                                            &( pxShadowClient->xPendingSlotsBuffer ) );
+
+            for( xIterator = 0; xIterator < shadowconfigMAX_PENDING_OPERATIONS; xIterator++ )
+            {
+                pxShadowClient->xPendingOperations[ xIterator ].xCompleteSemaphore =
+                    xSemaphoreCreateBinaryStatic( &( pxShadowClient->xPendingOperations[ xIterator ].xCompleteSemaphoreBuffer ) );
+            }
+
+            /* Start the generated client tokens at a different value for each
+             * client, so that a late response to an earlier client of the same
+             * Thing is unlikely to match. */
+            pxShadowClient->ulNextSequence = ( uint32_t ) xTaskGetTickCount() ^ ( ( uint32_t ) xShadowClientID << 24 );
+
+            if( xTimeoutTimers[ xShadowClientID ] == NULL )
+            {
+                xTimeoutTimers[ xShadowClientID ] = xTimerCreateStatic( "ShadowTimeout",
+                                                                        1,
+                                                                        pdFALSE,
+                                                                        ( void * ) xShadowClientID, /*lint !e923 Safe cast to timer ID. */
+                                                                        prvTimeoutTimerCallback,
+                                                                        &( xTimeoutTimerBuffers[ xShadowClientID ] ) );
+            }
 
             /* Set the output parameter. */
             *pxShadowClientHandle = ( ShadowClientHandle_t ) xShadowClientID; /*lint !e923 Safe cast from pointer handle. */
@@ -1522,6 +2046,12 @@ ShadowReturnCode_t SHADOW_ClientDelete( ShadowClientHandle_t xShadowClientHandle
 
     if( xReturn == eShadowSuccess )
     {
+        /* The timer is reused by the next client created in this slot. */
+        if( xTimeoutTimers[ ( BaseType_t ) xShadowClientHandle ] != NULL ) /*lint !e923 Safe cast from pointer handle. */
+        {
+            ( void ) xTimerStop( xTimeoutTimers[ ( BaseType_t ) xShadowClientHandle ], portMAX_DELAY ); /*lint !e923 Safe cast from pointer handle. */
+        }
+
         taskENTER_CRITICAL();
         memset( pxShadowClient, 0, sizeof( ShadowClient_t ) );
         taskEXIT_CRITICAL();
@@ -1532,9 +2062,11 @@ ShadowReturnCode_t SHADOW_ClientDelete( ShadowClientHandle_t xShadowClientHandle
 
 /*-----------------------------------------------------------*/
 
-ShadowReturnCode_t SHADOW_Update( ShadowClientHandle_t xShadowClientHandle,
-                                  ShadowOperationParams_t * const pxUpdateParams,
-                                  TickType_t xTimeoutTicks )
+static ShadowReturnCode_t prvShadowUpdate( ShadowClientHandle_t xShadowClientHandle,
+                                           ShadowOperationParams_t * const pxUpdateParams,
+                                           TickType_t xTimeoutTicks,
+                                           ShadowOperationCallback_t xCallback,
+                                           void * pvCallbackContext )
 {
     ShadowOperationCallParams_t xUpdateCallParams;
 
@@ -1552,23 +2084,22 @@ ShadowReturnCode_t SHADOW_Update( ShadowClientHandle_t xShadowClientHandle,
 
     xUpdateCallParams.pcOperationName = shadowTOPIC_OPERATION_UPDATE;
 
-    xUpdateCallParams.pcOperationTopic = shadowTOPIC_UPDATE;
-    xUpdateCallParams.pcOperationAcceptedTopic = shadowTOPIC_UPDATE_ACCEPTED;
-    xUpdateCallParams.pcOperationRejectedTopic = shadowTOPIC_UPDATE_REJECTED;
 
     xUpdateCallParams.pcPublishMessage = pxUpdateParams->pcData;
     xUpdateCallParams.ulPublishMessageLength = pxUpdateParams->ulDataLength;
     xUpdateCallParams.pxOperationParams = ( ShadowOperationParams_t * ) pxUpdateParams;
     xUpdateCallParams.xTimeoutTicks = xTimeoutTicks;
 
-    return prvShadowOperation( &xUpdateCallParams );
+    return prvShadowOperation( &xUpdateCallParams, xCallback, pvCallbackContext );
 }
 
 /*-----------------------------------------------------------*/
 
-ShadowReturnCode_t SHADOW_Get( ShadowClientHandle_t xShadowClientHandle,
-                               ShadowOperationParams_t * const pxGetParams,
-                               TickType_t xTimeoutTicks )
+static ShadowReturnCode_t prvShadowGet( ShadowClientHandle_t xShadowClientHandle,
+                                        ShadowOperationParams_t * const pxGetParams,
+                                        TickType_t xTimeoutTicks,
+                                        ShadowOperationCallback_t xCallback,
+                                        void * pvCallbackContext )
 {
     ShadowOperationCallParams_t xGetCallParams;
 
@@ -1585,26 +2116,25 @@ ShadowReturnCode_t SHADOW_Get( ShadowClientHandle_t xShadowClientHandle,
 
     xGetCallParams.pcOperationName = shadowTOPIC_OPERATION_GET;
 
-    xGetCallParams.pcOperationTopic = shadowTOPIC_GET;
-    xGetCallParams.pcOperationAcceptedTopic = shadowTOPIC_GET_ACCEPTED;
-    xGetCallParams.pcOperationRejectedTopic = shadowTOPIC_GET_REJECTED;
 
-    xGetCallParams.pcPublishMessage = "";
+    /* The message is a generated client token. */
+    xGetCallParams.pcPublishMessage = NULL;
     xGetCallParams.ulPublishMessageLength = 0;
     xGetCallParams.pxOperationParams = pxGetParams;
     xGetCallParams.xTimeoutTicks = xTimeoutTicks;
 
-    return prvShadowOperation( &xGetCallParams );
+    return prvShadowOperation( &xGetCallParams, xCallback, pvCallbackContext );
 }
 
 /*-----------------------------------------------------------*/
 
-ShadowReturnCode_t SHADOW_Delete( ShadowClientHandle_t xShadowClientHandle,
-                                  ShadowOperationParams_t * const pxDeleteParams,
-                                  TickType_t xTimeoutTicks )
+static ShadowReturnCode_t prvShadowDelete( ShadowClientHandle_t xShadowClientHandle,
+                                           ShadowOperationParams_t * const pxDeleteParams,
+                                           TickType_t xTimeoutTicks,
+                                           ShadowOperationCallback_t xCallback,
+                                           void * pvCallbackContext )
 {
     ShadowOperationCallParams_t xDeleteCallParams;
-    ShadowReturnCode_t xStatus;
 
     configASSERT( ( ( BaseType_t ) xShadowClientHandle >= 0 &&
                     ( BaseType_t ) xShadowClientHandle < shadowconfigMAX_CLIENTS ) ); /*lint !e923 Safe cast from pointer handle. */
@@ -1619,18 +2149,80 @@ ShadowReturnCode_t SHADOW_Delete( ShadowClientHandle_t xShadowClientHandle,
 
     xDeleteCallParams.pcOperationName = shadowTOPIC_OPERATION_DELETE;
 
-    xDeleteCallParams.pcOperationTopic = shadowTOPIC_DELETE;
-    xDeleteCallParams.pcOperationAcceptedTopic = shadowTOPIC_DELETE_ACCEPTED;
-    xDeleteCallParams.pcOperationRejectedTopic = shadowTOPIC_DELETE_REJECTED;
 
-    xDeleteCallParams.pcPublishMessage = "";
+    /* The message is a generated client token. */
+    xDeleteCallParams.pcPublishMessage = NULL;
     xDeleteCallParams.ulPublishMessageLength = 0;
     xDeleteCallParams.pxOperationParams = ( ShadowOperationParams_t * ) pxDeleteParams;
     xDeleteCallParams.xTimeoutTicks = xTimeoutTicks;
 
-    xStatus = prvShadowOperation( &xDeleteCallParams );
+    return prvShadowOperation( &xDeleteCallParams, xCallback, pvCallbackContext );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_Update( ShadowClientHandle_t xShadowClientHandle,
+                                  ShadowOperationParams_t * const pxUpdateParams,
+                                  TickType_t xTimeoutTicks )
+{
+    return prvShadowUpdate( xShadowClientHandle, pxUpdateParams, xTimeoutTicks, NULL, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_UpdateAsync( ShadowClientHandle_t xShadowClientHandle,
+                                       ShadowOperationParams_t * const pxUpdateParams,
+                                       TickType_t xTimeoutTicks,
+                                       ShadowOperationCallback_t xCallback,
+                                       void * pvCallbackContext )
+{
+    configASSERT( ( xCallback != NULL ) );
+
+    return prvShadowUpdate( xShadowClientHandle, pxUpdateParams, xTimeoutTicks, xCallback, pvCallbackContext );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_Get( ShadowClientHandle_t xShadowClientHandle,
+                               ShadowOperationParams_t * const pxGetParams,
+                               TickType_t xTimeoutTicks )
+{
+    return prvShadowGet( xShadowClientHandle, pxGetParams, xTimeoutTicks, NULL, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_GetAsync( ShadowClientHandle_t xShadowClientHandle,
+                                    ShadowOperationParams_t * const pxGetParams,
+                                    TickType_t xTimeoutTicks,
+                                    ShadowOperationCallback_t xCallback,
+                                    void * pvCallbackContext )
+{
+    configASSERT( ( xCallback != NULL ) );
+
+    return prvShadowGet( xShadowClientHandle, pxGetParams, xTimeoutTicks, xCallback, pvCallbackContext );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_Delete( ShadowClientHandle_t xShadowClientHandle,
+                                  ShadowOperationParams_t * const pxDeleteParams,
+                                  TickType_t xTimeoutTicks )
+{
+    return prvShadowDelete( xShadowClientHandle, pxDeleteParams, xTimeoutTicks, NULL, NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_DeleteAsync( ShadowClientHandle_t xShadowClientHandle,
+                                       ShadowOperationParams_t * const pxDeleteParams,
+                                       TickType_t xTimeoutTicks,
+                                       ShadowOperationCallback_t xCallback,
+                                       void * pvCallbackContext )
+{
+    configASSERT( ( xCallback != NULL ) );
 
-    return xStatus;
+    return prvShadowDelete( xShadowClientHandle, pxDeleteParams, xTimeoutTicks, xCallback, pvCallbackContext );
 }
 
 /*-----------------------------------------------------------*/
@@ -1653,7 +2245,7 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
     pxShadowClient = &( xShadowClients[ ( BaseType_t ) xShadowClientHandle ] ); /*lint !e923 Safe cast from pointer handle. */
     configASSERT( ( pxShadowClient->xInUse == pdTRUE ) );
 
-    xCallbackCatalogIndex = prvGetCallbackCatalogEntry( pxShadowClient->xCallbackCatalog,
+    xCallbackCatalogIndex = prvGetCallbackCatalogEntry( pxShadowClient,
                                                         pxCallbackParams->pcThingName );
     configASSERT( xCallbackCatalogIndex >= 0 );
 
@@ -1668,7 +2260,8 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
                                    ( const void ** ) &( ( pxCallbackCatalogEntry->xCallbackInfo ).xShadowUpdatedCallback ), /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. No const is being cast away either.*/
                                    ( const void ** ) &( pxCallbackParams->xShadowUpdatedCallback ),                         /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. */
                                    pxCallbackParams->pcThingName,
-                                   ( const uint8_t * ) shadowTOPIC_UPDATE_DOCUMENTS,
+                                   eShadowOperationUpdateDocuments,
+                                   eShadowTopicNoStatus,
                                    xTimeoutTicks );
 
     if( xReturn == eShadowSuccess )
@@ -1677,7 +2270,8 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
                                        ( const void ** ) &( ( pxCallbackCatalogEntry->xCallbackInfo ).xShadowDeletedCallback ), /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. No const is being cast away either.*/
                                        ( const void ** ) &( pxCallbackParams->xShadowDeletedCallback ),                         /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. */
                                        pxCallbackParams->pcThingName,
-                                       ( const uint8_t * ) shadowTOPIC_DELETE_ACCEPTED,
+                                       eShadowOperationDelete,
+                                       eShadowTopicAccepted,
                                        xTimeoutTicks );
     }
 
@@ -1687,7 +2281,8 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
                                        ( const void ** ) &( ( pxCallbackCatalogEntry->xCallbackInfo ).xShadowDeltaCallback ), /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. No const is being cast away either.*/
                                        ( const void ** ) &( pxCallbackParams->xShadowDeltaCallback ),                         /*lint !e9087 !e9005 cast is opaque and recast correctly inside the function. */
                                        pxCallbackParams->pcThingName,
-                                       ( const uint8_t * ) shadowTOPIC_UPDATE_DELTA,
+                                       eShadowOperationUpdateDelta,
+                                       eShadowTopicNoStatus,
                                        xTimeoutTicks );
     }
 
@@ -1700,6 +2295,7 @@ ShadowReturnCode_t SHADOW_RegisterCallbacks( ShadowClientHandle_t xShadowClientH
             memset( pxCallbackCatalogEntry,
                     0,
                     sizeof( CallbackCatalogEntry_t ) );
+            SHADOW_TopicIndexSet( &( pxShadowClient->xCallbackIndex[ xCallbackCatalogIndex ] ), NULL );
         }
         taskEXIT_CRITICAL();
     }
@@ -1731,3 +2327,28 @@ ShadowReturnCode_t SHADOW_ReturnMQTTBuffer( ShadowClientHandle_t xShadowClientHa
 
     return xReturn;
 }
+
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_ShareMQTTBuffer( ShadowClientHandle_t xShadowClientHandle,
+                                           MQTTBufferHandle_t xBufferHandle )
+{
+    ShadowClient_t * pxShadowClient;
+    MQTTAgentReturnCode_t xMQTTReturn;
+    ShadowReturnCode_t xReturn = eShadowFailure;
+
+    configASSERT( ( ( BaseType_t ) xShadowClientHandle >= 0 &&
+                    ( BaseType_t ) xShadowClientHandle < shadowconfigMAX_CLIENTS ) ); /*lint !e923 Safe cast from pointer handle. */
+
+    pxShadowClient = &( xShadowClients[ ( BaseType_t ) xShadowClientHandle ] );       /*lint !e923 Safe cast from pointer handle. */
+    configASSERT( ( pxShadowClient->xInUse == pdTRUE ) );
+
+    xMQTTReturn = MQTT_AGENT_ShareBuffer( pxShadowClient->xMQTTClient,
+                                          xBufferHandle );
+
+    xReturn = prvConvertMQTTReturnCode( xMQTTReturn,
+                                        xShadowClientHandle,
+                                        "Share MQTT buffer" );
+
+    return xReturn;
+}
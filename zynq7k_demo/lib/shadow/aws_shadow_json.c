@@ -1,5 +1,5 @@
 /*
- * Amazon FreeRTOS Shadow V1.0.5
+ * Amazon FreeRTOS
  * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy of
@@ -34,13 +34,7 @@
 
 /* AWS includes. */
 #include "aws_shadow_json.h"
-
-/* Other includes. */
-#include "jsmn.h"
-
-/* Sockets configuration includes. */
-#include "aws_shadow_config.h"
-#include "aws_shadow_config_defaults.h"
+#include "aws_shadow_topic.h"
 
 /* The JSON keys to search for when looking for the error code and message,
  * and client token, respectively. */
@@ -49,74 +43,178 @@
 #define shadowJSON_CLIENT_TOKEN     "clientToken"
 
 /**
- * @brief Given a JSON key, get its value. Does not work on arrays or objects.  Returns
- * length of value and sets ppcValue to the start of the value.  Returns 0 on
- * error (key-value does not exist).
+ * @brief Hash of a key of the key index, the low half of SHADOW_TopicHash().
  */
-static uint16_t prvGetJSONValue( const char ** ppcValue,
-                                 const char * const pcKey,
-                                 const char * const pcDoc,
-                                 jsmntok_t * pxJSMNTokens,
-                                 int16_t sTokensParsed );
+#define shadowJSON_HASH_KEY( pcKey, usKeyLength ) \
+    ( ( uint16_t ) SHADOW_TopicHash( ( pcKey ), ( usKeyLength ) ) )
 
 /**
- * @brief Wrapper for jsmn functions. Returns negative values (see jsmn error codes) on
- * error.  Returns the number of tokens parsed on success.
+ * @brief Returns pdTRUE if the token at sIndex is the string pcKey.
  */
-static int16_t prvParseJSON( const char * const pcDoc,
-                             uint32_t ulDocLength,
-                             jsmntok_t * pxJSMNTokens );
+static BaseType_t prvKeyEquals( const ShadowJSONDoc_t * const pxDoc,
+                                int16_t sIndex,
+                                const char * const pcKey,
+                                uint16_t usKeyLength );
+
+/**
+ * @brief Given a top-level JSON key, get its value. Does not work on arrays or
+ * objects. Returns length of value and sets ppcValue to the start of the value.
+ * Returns 0 on error (key-value does not exist).
+ */
+static uint16_t prvGetJSONValue( const ShadowJSONDoc_t * const pxDoc,
+                                 const char * const pcKey,
+                                 const char ** ppcValue );
 
 /*-----------------------------------------------------------*/
 
-BaseType_t SHADOW_JSONDocClientTokenMatch( const char * const pcDoc1,
-                                           uint32_t ulDoc1Length,
-                                           const char * const pcDoc2,
-                                           uint32_t ulDoc2Length )
+int16_t SHADOW_JSONParse( ShadowJSONDoc_t * const pxDoc,
+                          jsmntok_t * const pxTokens,
+                          int16_t sMaxTokens,
+                          const char * const pcDoc,
+                          uint32_t ulDocLength )
 {
-    jsmntok_t pxJSMNTokens[ shadowconfigJSON_JSMN_TOKENS ];
-    BaseType_t xReturn = pdFAIL;
-    uint16_t usClientToken1Length, usClientToken2Length;
-    int16_t sNbTokens;
-    char * pcClientToken1;
-    char * pcClientToken2;
+    jsmn_parser xJSMNParser;
+    int16_t sIndex;
+    int lPairs;
+
+    configASSERT( pxDoc != NULL );
+    configASSERT( pxTokens != NULL );
 
-    /* Parse pcDoc1 with jsmn. */
-    sNbTokens = prvParseJSON( pcDoc1, ulDoc1Length, pxJSMNTokens );
+    pxDoc->pcDoc = pcDoc;
+    pxDoc->pxTokens = pxTokens;
+    pxDoc->usKeyCount = 0;
+    pxDoc->xKeyIndexFull = pdFALSE;
 
-    if( sNbTokens > 0 )
+    jsmn_init( &xJSMNParser );
+    pxDoc->sTokenCount = ( int16_t ) jsmn_parse( &xJSMNParser,
+                                                 pcDoc,
+                                                 ulDocLength,
+                                                 pxTokens,
+                                                 ( unsigned int ) sMaxTokens );
+
+    /* Index the keys of the top-level object, which are the keys that the
+     * Shadow library looks up. */
+    if( ( pxDoc->sTokenCount > 0 ) && ( pxTokens[ 0 ].type == JSMN_OBJECT ) )
     {
-        /* Attempt to find the "clientToken" string in parsed pcDoc1. */
-        usClientToken1Length = prvGetJSONValue( ( const char ** ) &pcClientToken1,
-                                                shadowJSON_CLIENT_TOKEN,
-                                                pcDoc1,
-                                                ( jsmntok_t * ) pxJSMNTokens,
-                                                sNbTokens );
-
-        if( usClientToken1Length > ( uint16_t ) 0 )
+        sIndex = 1;
+
+        for( lPairs = pxTokens[ 0 ].size;
+             ( lPairs > 0 ) && ( ( sIndex + 1 ) < pxDoc->sTokenCount );
+             lPairs-- )
         {
-            /* Parse pcDoc2 with jsmn. */
-            sNbTokens = prvParseJSON( pcDoc2, ulDoc2Length, pxJSMNTokens );
+            if( pxDoc->usKeyCount == ( uint16_t ) shadowconfigJSON_KEY_INDEX_SIZE )
+            {
+                pxDoc->xKeyIndexFull = pdTRUE;
+                break;
+            }
+
+            pxDoc->usKeyHashes[ pxDoc->usKeyCount ] =
+                shadowJSON_HASH_KEY( pcDoc + pxTokens[ sIndex ].start,
+                                     ( uint16_t ) ( pxTokens[ sIndex ].end - pxTokens[ sIndex ].start ) );
+            pxDoc->sKeyTokens[ pxDoc->usKeyCount ] = sIndex;
+            pxDoc->usKeyCount++;
+
+            sIndex = SHADOW_JSONSkipToken( pxDoc, sIndex + 1 );
+        }
+    }
 
-            if( sNbTokens > 0 )
+    return pxDoc->sTokenCount;
+}
+/*-----------------------------------------------------------*/
+
+int16_t SHADOW_JSONFindKey( const ShadowJSONDoc_t * const pxDoc,
+                            int16_t sObjectIndex,
+                            const char * const pcKey )
+{
+    const jsmntok_t * pxTokens = pxDoc->pxTokens;
+    uint16_t usKeyLength = ( uint16_t ) strlen( pcKey );
+    uint16_t usHash;
+    uint16_t usKey;
+    int16_t sIndex = sObjectIndex + 1;
+    int16_t sReturn = -1;
+    int lPairs;
+
+    if( ( sObjectIndex >= 0 ) &&
+        ( sObjectIndex < pxDoc->sTokenCount ) &&
+        ( pxTokens[ sObjectIndex ].type == JSMN_OBJECT ) )
+    {
+        if( ( sObjectIndex == 0 ) && ( pxDoc->xKeyIndexFull == pdFALSE ) )
+        {
+            usHash = shadowJSON_HASH_KEY( pcKey, usKeyLength );
+
+            for( usKey = 0; usKey < pxDoc->usKeyCount; usKey++ )
+            {
+                if( ( pxDoc->usKeyHashes[ usKey ] == usHash ) &&
+                    ( prvKeyEquals( pxDoc, pxDoc->sKeyTokens[ usKey ], pcKey, usKeyLength ) == pdTRUE ) )
+                {
+                    sReturn = pxDoc->sKeyTokens[ usKey ] + 1;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            for( lPairs = pxTokens[ sObjectIndex ].size;
+                 ( lPairs > 0 ) && ( ( sIndex + 1 ) < pxDoc->sTokenCount );
+                 lPairs-- )
             {
-                /* If "clientToken" was found in pcDoc1, attempt to find "clientToken" in pcDoc2. */
-                usClientToken2Length = prvGetJSONValue( ( const char ** ) &pcClientToken2,
-                                                        shadowJSON_CLIENT_TOKEN,
-                                                        pcDoc2,
-                                                        ( jsmntok_t * ) pxJSMNTokens,
-                                                        sNbTokens );
-
-                /* Compare the client tokens. */
-                if( usClientToken2Length == usClientToken1Length )
+                if( prvKeyEquals( pxDoc, sIndex, pcKey, usKeyLength ) == pdTRUE )
                 {
-                    if( strncmp( ( const char * ) pcClientToken1,
-                                 ( const char * ) pcClientToken2,
-                                 ( size_t ) usClientToken1Length ) == 0 )
-                    {
-                        xReturn = pdPASS;
-                    }
+                    sReturn = sIndex + 1;
+                    break;
                 }
+
+                sIndex = SHADOW_JSONSkipToken( pxDoc, sIndex + 1 );
+            }
+        }
+    }
+
+    return sReturn;
+}
+/*-----------------------------------------------------------*/
+
+int16_t SHADOW_JSONSkipToken( const ShadowJSONDoc_t * const pxDoc,
+                              int16_t sIndex )
+{
+    int lEnd = pxDoc->pxTokens[ sIndex ].end;
+
+    /* Children start before the end of their parent. */
+    for( sIndex++; sIndex < pxDoc->sTokenCount; sIndex++ )
+    {
+        if( pxDoc->pxTokens[ sIndex ].start >= lEnd )
+        {
+            break;
+        }
+    }
+
+    return sIndex;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t SHADOW_JSONDocClientTokenMatch( const ShadowJSONDoc_t * const pxDoc1,
+                                           const ShadowJSONDoc_t * const pxDoc2 )
+{
+    BaseType_t xReturn = pdFAIL;
+    uint16_t usClientToken1Length, usClientToken2Length;
+    const char * pcClientToken1;
+    const char * pcClientToken2;
+
+    /* Attempt to find the "clientToken" string in pxDoc1. */
+    usClientToken1Length = SHADOW_JSONGetClientToken( pxDoc1, &pcClientToken1 );
+
+    if( usClientToken1Length > ( uint16_t ) 0 )
+    {
+        /* If "clientToken" was found in pxDoc1, attempt to find "clientToken" in pxDoc2. */
+        usClientToken2Length = SHADOW_JSONGetClientToken( pxDoc2, &pcClientToken2 );
+
+        /* Compare the client tokens. */
+        if( usClientToken2Length == usClientToken1Length )
+        {
+            if( strncmp( pcClientToken1,
+                         pcClientToken2,
+                         ( size_t ) usClientToken1Length ) == 0 )
+            {
+                xReturn = pdPASS;
             }
         }
     }
@@ -125,26 +223,26 @@ BaseType_t SHADOW_JSONDocClientTokenMatch( const char * const pcDoc1,
 }
 /*-----------------------------------------------------------*/
 
-int16_t SHADOW_JSONGetErrorCodeAndMessage( const char * const pcErrorJSON,
-                                           uint32_t ulErrorJSONLength,
+uint16_t SHADOW_JSONGetClientToken( const ShadowJSONDoc_t * const pxDoc,
+                                    const char ** ppcClientToken )
+{
+    return prvGetJSONValue( pxDoc, shadowJSON_CLIENT_TOKEN, ppcClientToken );
+}
+/*-----------------------------------------------------------*/
+
+int16_t SHADOW_JSONGetErrorCodeAndMessage( const ShadowJSONDoc_t * const pxDoc,
                                            char ** ppcErrorMessage,
                                            uint16_t * pusErrorMessageLength )
 {
-    jsmntok_t pxJSMNTokens[ shadowconfigJSON_JSMN_TOKENS ];
     char * pcErrorCode;
     int16_t sReturn = 0;
-    int16_t sTokensParsed;
 
-    sTokensParsed = prvParseJSON( pcErrorJSON, ulErrorJSONLength, pxJSMNTokens );
-
-    if( sTokensParsed > 0 )
+    if( pxDoc->sTokenCount > 0 )
     {
         /* Attempt to find the error code. */
-        sReturn = ( int16_t ) prvGetJSONValue( ( const char ** ) &pcErrorCode,
+        sReturn = ( int16_t ) prvGetJSONValue( pxDoc,
                                                shadowJSON_ERROR_CODE,
-                                               pcErrorJSON,
-                                               pxJSMNTokens,
-                                               sTokensParsed );
+                                               ( const char ** ) &pcErrorCode );
 
         if( sReturn > 0 )
         {
@@ -154,85 +252,63 @@ int16_t SHADOW_JSONGetErrorCodeAndMessage( const char * const pcErrorJSON,
             if( ( ppcErrorMessage != NULL ) && ( pusErrorMessageLength != NULL ) )
             {
                 /* Set the pointer to the error message and the error message length. */
-                *pusErrorMessageLength = prvGetJSONValue( ( const char ** ) ppcErrorMessage,
+                *pusErrorMessageLength = prvGetJSONValue( pxDoc,
                                                           shadowJSON_ERROR_MESSAGE,
-                                                          pcErrorJSON,
-                                                          pxJSMNTokens,
-                                                          sTokensParsed );
+                                                          ( const char ** ) ppcErrorMessage );
             }
         }
     }
     else
     {
-        /* On failure, sTokenParsed returns a jsmn error code.  Return this error code. */
-        sReturn = sTokensParsed;
+        /* On failure, sTokenCount holds a jsmn error code.  Return this error code. */
+        sReturn = pxDoc->sTokenCount;
     }
 
     return sReturn;
 }
 /*-----------------------------------------------------------*/
 
-static int16_t prvParseJSON( const char * const pcDoc,
-                             uint32_t ulDocLength,
-                             jsmntok_t * pxJSMNTokens )
+static BaseType_t prvKeyEquals( const ShadowJSONDoc_t * const pxDoc,
+                                int16_t sIndex,
+                                const char * const pcKey,
+                                uint16_t usKeyLength )
 {
-    jsmn_parser xJSMNParser;
-    int16_t sReturn;
+    const jsmntok_t * pxToken = &( pxDoc->pxTokens[ sIndex ] );
+    BaseType_t xReturn = pdFALSE;
 
-    jsmn_init( &xJSMNParser );
-    sReturn = ( int16_t ) jsmn_parse( &xJSMNParser,
-                                      pcDoc,
-                                      ulDocLength,
-                                      pxJSMNTokens,
-                                      shadowconfigJSON_JSMN_TOKENS );
+    if( ( pxToken->type == JSMN_STRING ) &&
+        ( ( uint16_t ) ( pxToken->end - pxToken->start ) == usKeyLength ) &&
+        ( memcmp( pxDoc->pcDoc + pxToken->start, pcKey, usKeyLength ) == 0 ) )
+    {
+        xReturn = pdTRUE;
+    }
 
-    return sReturn;
+    return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static uint16_t prvGetJSONValue( const char ** ppcValue,
+static uint16_t prvGetJSONValue( const ShadowJSONDoc_t * const pxDoc,
                                  const char * const pcKey,
-                                 const char * const pcDoc,
-                                 jsmntok_t * pxJSMNTokens,
-                                 int16_t sTokensParsed )
+                                 const char ** ppcValue )
 {
-    jsmntok_t * pxJSMNToken;
+    const jsmntok_t * pxJSMNToken;
     uint16_t usReturn = 0;
-    int16_t sIterator;
-    uint16_t usCompareLength;
-    BaseType_t xValueFound = pdFALSE;
+    int16_t sValueIndex;
 
-    if( ppcValue != NULL )
+    if( ( ppcValue != NULL ) && ( pxDoc->sTokenCount > 0 ) )
     {
-        /* "clientToken" is usually (but not guaranteed to be) the last key in the Shadow JSON document.
-         * Since this function is primarily used to find "clientToken", find "clientToken" faster
-         * by starting from the end. */
-        for( sIterator = ( sTokensParsed - 1 ); sIterator >= 0; sIterator-- )
-        {
-            pxJSMNToken = &( pxJSMNTokens[ sIterator ] );
-            usCompareLength = configMAX( ( ( uint16_t ) pxJSMNToken->end - ( uint16_t ) pxJSMNToken->start ),
-                                         ( ( uint16_t ) strlen( pcKey ) ) );
+        sValueIndex = SHADOW_JSONFindKey( pxDoc, 0, pcKey );
 
-            /* Compare pcKey with the keys in the JSON document. */
-            if( ( ( strncmp( pcKey, pcDoc + pxJSMNToken->start, usCompareLength ) ) == 0 ) && ( pxJSMNToken->size == 1 ) )
-            {
-                /* The JSON value is the next jsmn token after the key. */
-                pxJSMNToken++;
+        if( sValueIndex >= 0 )
+        {
+            pxJSMNToken = &( pxDoc->pxTokens[ sValueIndex ] );
 
-                /* Set the pointer to the value and the value's length. */
-                *ppcValue = ( const char * ) ( pcDoc + pxJSMNToken->start );
-                usReturn = ( uint16_t ) pxJSMNToken->end - ( uint16_t ) pxJSMNToken->start;
-                xValueFound = pdTRUE;
-                break;
-            }
+            /* Set the pointer to the value and the value's length. */
+            *ppcValue = ( const char * ) ( pxDoc->pcDoc + pxJSMNToken->start );
+            usReturn = ( uint16_t ) pxJSMNToken->end - ( uint16_t ) pxJSMNToken->start;
         }
     }
 
-    if( xValueFound == pdFALSE )
-    {
-        usReturn = 0;
-    }
-
     return usReturn;
 }
 /*-----------------------------------------------------------*/
@@ -0,0 +1,710 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_shadow_state.c
+ * @brief Local copy of a Thing Shadow with coalesced, delta-only reported updates.
+ */
+
+/* C library includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* AWS includes. */
+#include "aws_shadow_state.h"
+#include "aws_shadow_json.h"
+
+#if shadowconfigSTATE_MAX_FIELDS > 32
+    #error "shadowconfigSTATE_MAX_FIELDS must be at most 32."
+#endif
+
+#if shadowconfigSTATE_MAX_VALUE_LENGTH > 255
+    #error "shadowconfigSTATE_MAX_VALUE_LENGTH must be less than 256."
+#endif
+
+#if shadowconfigENABLE_DEBUG_LOGS == 1
+    #define Shadow_debug_printf( X )    configPRINTF( X )
+#else
+    #define Shadow_debug_printf( X )
+#endif
+
+/**
+ * @brief Publishing state of the reported value of a field.
+ */
+/** @{ */
+#define shadowstateFLAG_DIRTY        ( 0x01U ) /* Changed and not yet published. */
+#define shadowstateFLAG_IN_FLIGHT    ( 0x02U ) /* Being published. */
+/** @} */
+
+/**
+ * @brief The parts of the reported update document.
+ */
+/** @{ */
+#define shadowstateDOCUMENT_PREFIX    "{\"state\":{\"reported\":{"
+#define shadowstateDOCUMENT_SUFFIX    "}},\"clientToken\":\"state-%08lx\"}"
+#define shadowstateDOCUMENT_SUFFIX_LENGTH \
+    ( sizeof( shadowstateDOCUMENT_SUFFIX ) - sizeof( "%08lx" ) + 8 )
+/** @} */
+
+/**
+ * @brief The keys of a Shadow document the state is read from.
+ */
+/** @{ */
+#define shadowstateJSON_STATE       "state"
+#define shadowstateJSON_DESIRED     "desired"
+#define shadowstateJSON_REPORTED    "reported"
+#define shadowstateJSON_VERSION     "version"
+/** @} */
+
+/**
+ * @brief Which value of the fields a JSON object is applied to.
+ */
+typedef enum ShadowStateSection
+{
+    eShadowStateDesired,
+    eShadowStateReported
+} ShadowStateSection_t;
+
+/**
+ * @brief Returns the JSON text of the value at sIndex. Strings keep their quotes.
+ */
+static uint16_t prvGetValue( const ShadowStateParse_t * const pxParse,
+                             int16_t sIndex,
+                             const char ** ppcValue );
+
+/**
+ * @brief Parses an unsigned integer token; returns 0 if it is not one.
+ */
+static uint32_t prvGetUnsigned( const ShadowStateParse_t * const pxParse,
+                                int16_t sIndex );
+
+/**
+ * @brief Returns the field of a key, or NULL if the key is unknown.
+ */
+static ShadowStateField_t * prvFindField( ShadowState_t * const pxState,
+                                          const char * const pcKey,
+                                          uint16_t usKeyLength );
+
+/**
+ * @brief Copies the values of the object at sObjectIndex into the desired or
+ * reported values of the fields. Must be called with the mutex held.
+ */
+static void prvApplyObject( ShadowState_t * const pxState,
+                            ShadowStateParse_t * const pxParse,
+                            int16_t sObjectIndex,
+                            ShadowStateSection_t xSection );
+
+/**
+ * @brief Parses a document, checks its version and applies its state. The
+ * state of a delta only holds desired values.
+ */
+static ShadowReturnCode_t prvApplyDocument( ShadowState_t * const pxState,
+                                            const char * const pcDocument,
+                                            uint32_t ulDocumentLength,
+                                            BaseType_t xIsDelta );
+
+/**
+ * @brief Builds the update document of the dirty fields and marks them in
+ * flight. Returns the length of the document, and sets pxMore to pdTRUE if
+ * some dirty fields did not fit. Must be called with the mutex held.
+ */
+static uint32_t prvBuildUpdate( ShadowState_t * const pxState,
+                                BaseType_t * const pxMore );
+
+/**
+ * @brief Clears the in flight flags once an update completed. If it failed,
+ * the fields are marked dirty again. Must be called with the mutex held.
+ */
+static void prvCompleteUpdate( ShadowState_t * const pxState,
+                               BaseType_t xSucceeded );
+
+/*-----------------------------------------------------------*/
+
+static uint16_t prvGetValue( const ShadowStateParse_t * const pxParse,
+                             int16_t sIndex,
+                             const char ** ppcValue )
+{
+    const jsmntok_t * pxToken = &( pxParse->xTokens[ sIndex ] );
+    int lStart = pxToken->start;
+    int lEnd = pxToken->end;
+
+    /* jsmn does not include the quotes in string tokens. */
+    if( pxToken->type == JSMN_STRING )
+    {
+        lStart--;
+        lEnd++;
+    }
+
+    *ppcValue = pxParse->xDoc.pcDoc + lStart;
+
+    return ( uint16_t ) ( lEnd - lStart );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvGetUnsigned( const ShadowStateParse_t * const pxParse,
+                                int16_t sIndex )
+{
+    const jsmntok_t * pxToken = &( pxParse->xTokens[ sIndex ] );
+    uint32_t ulValue = 0;
+    int lIndex;
+    char cDigit;
+
+    if( pxToken->type == JSMN_PRIMITIVE )
+    {
+        for( lIndex = pxToken->start; lIndex < pxToken->end; lIndex++ )
+        {
+            cDigit = pxParse->xDoc.pcDoc[ lIndex ];
+
+            if( ( cDigit < '0' ) || ( cDigit > '9' ) )
+            {
+                ulValue = 0;
+                break;
+            }
+
+            ulValue = ( ulValue * 10UL ) + ( uint32_t ) ( cDigit - '0' );
+        }
+    }
+
+    return ulValue;
+}
+/*-----------------------------------------------------------*/
+
+static ShadowStateField_t * prvFindField( ShadowState_t * const pxState,
+                                          const char * const pcKey,
+                                          uint16_t usKeyLength )
+{
+    ShadowStateField_t * pxReturn = NULL;
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0; uxIndex < pxState->uxFieldCount; uxIndex++ )
+    {
+        if( ( pxState->xFields[ uxIndex ].ucKeyLength == usKeyLength ) &&
+            ( memcmp( pxState->xFields[ uxIndex ].pcKey, pcKey, usKeyLength ) == 0 ) )
+        {
+            pxReturn = &( pxState->xFields[ uxIndex ] );
+            break;
+        }
+    }
+
+    return pxReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvApplyObject( ShadowState_t * const pxState,
+                            ShadowStateParse_t * const pxParse,
+                            int16_t sObjectIndex,
+                            ShadowStateSection_t xSection )
+{
+    ShadowStateField_t * pxField;
+    const jsmntok_t * pxKeyToken;
+    const char * pcValue;
+    uint16_t usValueLength;
+    int16_t sIndex = sObjectIndex + 1;
+    int lPairs;
+
+    if( ( sObjectIndex < 0 ) || ( pxParse->xTokens[ sObjectIndex ].type != JSMN_OBJECT ) )
+    {
+        return;
+    }
+
+    for( lPairs = pxParse->xTokens[ sObjectIndex ].size;
+         ( lPairs > 0 ) && ( ( sIndex + 1 ) < pxParse->xDoc.sTokenCount );
+         lPairs-- )
+    {
+        pxKeyToken = &( pxParse->xTokens[ sIndex ] );
+        pxField = prvFindField( pxState,
+                                pxParse->xDoc.pcDoc + pxKeyToken->start,
+                                ( uint16_t ) ( pxKeyToken->end - pxKeyToken->start ) );
+        usValueLength = prvGetValue( pxParse, sIndex + 1, &pcValue );
+
+        if( pxField == NULL )
+        {
+            /* Not a key of this state. */
+        }
+        else if( usValueLength >= ( uint16_t ) shadowconfigSTATE_MAX_VALUE_LENGTH )
+        {
+            Shadow_debug_printf( ( "[Shadow state] Value of %s too long, ignored.\r\n", pxField->pcKey ) );
+        }
+        else if( xSection == eShadowStateDesired )
+        {
+            if( ( pxField->ucDesiredLength != ( uint8_t ) usValueLength ) ||
+                ( memcmp( pxField->cDesired, pcValue, usValueLength ) != 0 ) )
+            {
+                memcpy( pxField->cDesired, pcValue, usValueLength );
+                pxField->ucDesiredLength = ( uint8_t ) usValueLength;
+                pxParse->sValueToken[ pxField - pxState->xFields ] = sIndex + 1;
+                pxParse->ulChangedFields |= 1UL << ( uint32_t ) ( pxField - pxState->xFields );
+            }
+        }
+        else if( ( pxField->ucFlags & ( shadowstateFLAG_DIRTY | shadowstateFLAG_IN_FLIGHT ) ) == 0U )
+        {
+            /* Local changes not yet acknowledged are newer than the document. */
+            memcpy( pxField->cReported, pcValue, usValueLength );
+            pxField->ucReportedLength = ( uint8_t ) usValueLength;
+        }
+
+        sIndex = SHADOW_JSONSkipToken( &( pxParse->xDoc ), sIndex + 1 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static ShadowReturnCode_t prvApplyDocument( ShadowState_t * const pxState,
+                                            const char * const pcDocument,
+                                            uint32_t ulDocumentLength,
+                                            BaseType_t xIsDelta )
+{
+    /* Parsed into the state rather than on the stack of the caller, which is
+     * usually the MQTT task. */
+    ShadowStateParse_t * const pxParse = &( pxState->xParse );
+    ShadowReturnCode_t xReturn = eShadowSuccess;
+    int16_t sStateIndex, sVersionIndex;
+    uint32_t ulVersion = 0;
+    UBaseType_t uxIndex;
+    const char * pcValue;
+    uint16_t usValueLength;
+
+    configASSERT( pxState != NULL );
+    configASSERT( pcDocument != NULL );
+
+    /* Held until the desired callbacks return, as they read the values from
+     * the parsed document. */
+    ( void ) xSemaphoreTake( pxState->xParseMutex, portMAX_DELAY );
+
+    pxParse->ulChangedFields = 0;
+
+    if( SHADOW_JSONParse( &( pxParse->xDoc ),
+                          pxParse->xTokens,
+                          shadowconfigJSON_JSMN_TOKENS,
+                          pcDocument,
+                          ulDocumentLength ) < 0 )
+    {
+        xReturn = ( ShadowReturnCode_t ) pxParse->xDoc.sTokenCount;
+    }
+    else
+    {
+        sStateIndex = SHADOW_JSONFindKey( &( pxParse->xDoc ), 0, shadowstateJSON_STATE );
+        sVersionIndex = SHADOW_JSONFindKey( &( pxParse->xDoc ), 0, shadowstateJSON_VERSION );
+
+        if( sVersionIndex >= 0 )
+        {
+            ulVersion = prvGetUnsigned( pxParse, sVersionIndex );
+        }
+
+        if( sStateIndex < 0 )
+        {
+            xReturn = eShadowFailure;
+        }
+    }
+
+    if( xReturn == eShadowSuccess )
+    {
+        ( void ) xSemaphoreTake( pxState->xMutex, portMAX_DELAY );
+
+        if( ( ulVersion != 0UL ) && ( ulVersion <= pxState->ulVersion ) )
+        {
+            /* Deltas may arrive out of order; this one is stale. */
+            Shadow_debug_printf( ( "[Shadow state] Ignoring version %lu, have %lu.\r\n",
+                                   ( unsigned long ) ulVersion,
+                                   ( unsigned long ) pxState->ulVersion ) );
+        }
+        else
+        {
+            if( ulVersion != 0UL )
+            {
+                pxState->ulVersion = ulVersion;
+            }
+
+            if( xIsDelta == pdTRUE )
+            {
+                /* The state of a delta only holds desired values. */
+                prvApplyObject( pxState, pxParse, sStateIndex, eShadowStateDesired );
+            }
+            else
+            {
+                prvApplyObject( pxState,
+                                pxParse,
+                                SHADOW_JSONFindKey( &( pxParse->xDoc ), sStateIndex, shadowstateJSON_REPORTED ),
+                                eShadowStateReported );
+                prvApplyObject( pxState,
+                                pxParse,
+                                SHADOW_JSONFindKey( &( pxParse->xDoc ), sStateIndex, shadowstateJSON_DESIRED ),
+                                eShadowStateDesired );
+            }
+        }
+
+        ( void ) xSemaphoreGive( pxState->xMutex );
+
+        /* The values are passed from the document, so that the callback may
+         * set reported values. */
+        if( pxState->xDesiredCallback != NULL )
+        {
+            for( uxIndex = 0; uxIndex < pxState->uxFieldCount; uxIndex++ )
+            {
+                if( ( pxParse->ulChangedFields & ( 1UL << uxIndex ) ) != 0UL )
+                {
+                    usValueLength = prvGetValue( pxParse, pxParse->sValueToken[ uxIndex ], &pcValue );
+                    pxState->xDesiredCallback( pxState->pvUserData,
+                                               pxState->xFields[ uxIndex ].pcKey,
+                                               pcValue,
+                                               ( uint8_t ) usValueLength );
+                }
+            }
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxState->xParseMutex );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBuildUpdate( ShadowState_t * const pxState,
+                                BaseType_t * const pxMore )
+{
+    ShadowStateField_t * pxField;
+    UBaseType_t uxIndex;
+    uint32_t ulLength = sizeof( shadowstateDOCUMENT_PREFIX ) - 1;
+    uint32_t ulPairLength;
+    BaseType_t xFirst = pdTRUE;
+
+    *pxMore = pdFALSE;
+    memcpy( pxState->cDocument, shadowstateDOCUMENT_PREFIX, ulLength );
+
+    for( uxIndex = 0; uxIndex < pxState->uxFieldCount; uxIndex++ )
+    {
+        pxField = &( pxState->xFields[ uxIndex ] );
+
+        if( ( pxField->ucFlags & shadowstateFLAG_DIRTY ) == 0U )
+        {
+            continue;
+        }
+
+        /* ,"key":value */
+        ulPairLength = ( uint32_t ) pxField->ucKeyLength + pxField->ucReportedLength + 4UL;
+
+        if( ( ulLength + ulPairLength + shadowstateDOCUMENT_SUFFIX_LENGTH ) > shadowconfigSTATE_DOCUMENT_LENGTH )
+        {
+            *pxMore = pdTRUE;
+            continue;
+        }
+
+        if( xFirst == pdFALSE )
+        {
+            pxState->cDocument[ ulLength++ ] = ',';
+        }
+
+        xFirst = pdFALSE;
+        pxState->cDocument[ ulLength++ ] = '"';
+        memcpy( &( pxState->cDocument[ ulLength ] ), pxField->pcKey, pxField->ucKeyLength );
+        ulLength += pxField->ucKeyLength;
+        pxState->cDocument[ ulLength++ ] = '"';
+        pxState->cDocument[ ulLength++ ] = ':';
+        memcpy( &( pxState->cDocument[ ulLength ] ), pxField->cReported, pxField->ucReportedLength );
+        ulLength += pxField->ucReportedLength;
+
+        pxField->ucFlags = ( uint8_t ) ( ( pxField->ucFlags & ~shadowstateFLAG_DIRTY ) | shadowstateFLAG_IN_FLIGHT );
+    }
+
+    if( xFirst == pdTRUE )
+    {
+        /* Nothing fits, or nothing is dirty. */
+        ulLength = 0;
+    }
+    else
+    {
+        pxState->ulUpdateCount++;
+        ulLength += ( uint32_t ) snprintf( &( pxState->cDocument[ ulLength ] ),
+                                           shadowconfigSTATE_DOCUMENT_LENGTH - ulLength,
+                                           shadowstateDOCUMENT_SUFFIX,
+                                           ( unsigned long ) pxState->ulUpdateCount );
+    }
+
+    return ulLength;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCompleteUpdate( ShadowState_t * const pxState,
+                               BaseType_t xSucceeded )
+{
+    ShadowStateField_t * pxField;
+    UBaseType_t uxIndex;
+
+    for( uxIndex = 0; uxIndex < pxState->uxFieldCount; uxIndex++ )
+    {
+        pxField = &( pxState->xFields[ uxIndex ] );
+
+        if( ( pxField->ucFlags & shadowstateFLAG_IN_FLIGHT ) != 0U )
+        {
+            pxField->ucFlags &= ( uint8_t ) ~shadowstateFLAG_IN_FLIGHT;
+
+            if( xSucceeded == pdFALSE )
+            {
+                pxField->ucFlags |= shadowstateFLAG_DIRTY;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t SHADOW_StateInit( ShadowState_t * const pxState,
+                             const ShadowStateParams_t * const pxParams )
+{
+    BaseType_t xReturn = pdPASS;
+    UBaseType_t uxIndex;
+    size_t xKeyLength;
+
+    configASSERT( pxState != NULL );
+    configASSERT( pxParams != NULL );
+    configASSERT( pxParams->pcThingName != NULL );
+
+    memset( pxState, 0x00, sizeof( ShadowState_t ) );
+
+    if( pxParams->uxKeyCount > ( UBaseType_t ) shadowconfigSTATE_MAX_FIELDS )
+    {
+        xReturn = pdFAIL;
+    }
+
+    for( uxIndex = 0; ( xReturn == pdPASS ) && ( uxIndex < pxParams->uxKeyCount ); uxIndex++ )
+    {
+        xKeyLength = strlen( pxParams->ppcKeys[ uxIndex ] );
+
+        /* A key and its value must fit in the update document. */
+        if( ( xKeyLength == 0 ) ||
+            ( xKeyLength > 0xFFU ) ||
+            ( ( sizeof( shadowstateDOCUMENT_PREFIX ) + xKeyLength + shadowconfigSTATE_MAX_VALUE_LENGTH +
+                4 + shadowstateDOCUMENT_SUFFIX_LENGTH ) > shadowconfigSTATE_DOCUMENT_LENGTH ) )
+        {
+            xReturn = pdFAIL;
+        }
+        else
+        {
+            pxState->xFields[ uxIndex ].pcKey = pxParams->ppcKeys[ uxIndex ];
+            pxState->xFields[ uxIndex ].ucKeyLength = ( uint8_t ) xKeyLength;
+        }
+    }
+
+    if( xReturn == pdPASS )
+    {
+        pxState->xShadowClientHandle = pxParams->xShadowClientHandle;
+        pxState->pcThingName = pxParams->pcThingName;
+        pxState->xCoalesceTicks = pxParams->xCoalesceTicks;
+        pxState->xDesiredCallback = pxParams->xDesiredCallback;
+        pxState->pvUserData = pxParams->pvUserData;
+        pxState->uxFieldCount = pxParams->uxKeyCount;
+        pxState->xMutex = xSemaphoreCreateMutexStatic( &( pxState->xMutexBuffer ) );
+        configASSERT( pxState->xMutex != NULL );
+        pxState->xParseMutex = xSemaphoreCreateMutexStatic( &( pxState->xParseMutexBuffer ) );
+        configASSERT( pxState->xParseMutex != NULL );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t SHADOW_StateSetReported( ShadowState_t * const pxState,
+                                    const char * const pcKey,
+                                    const char * const pcValue,
+                                    uint8_t ucValueLength )
+{
+    ShadowStateField_t * pxField;
+    BaseType_t xReturn = pdFAIL;
+
+    configASSERT( pxState != NULL );
+    configASSERT( pcKey != NULL );
+    configASSERT( pcValue != NULL );
+
+    if( ( ucValueLength > 0U ) && ( ucValueLength < ( uint8_t ) shadowconfigSTATE_MAX_VALUE_LENGTH ) )
+    {
+        ( void ) xSemaphoreTake( pxState->xMutex, portMAX_DELAY );
+
+        pxField = prvFindField( pxState, pcKey, ( uint16_t ) strlen( pcKey ) );
+
+        if( pxField != NULL )
+        {
+            xReturn = pdPASS;
+
+            if( ( pxField->ucReportedLength != ucValueLength ) ||
+                ( memcmp( pxField->cReported, pcValue, ucValueLength ) != 0 ) )
+            {
+                memcpy( pxField->cReported, pcValue, ucValueLength );
+                pxField->ucReportedLength = ucValueLength;
+                pxField->ucFlags |= shadowstateFLAG_DIRTY;
+
+                /* The coalescing window starts with the first change. */
+                if( pxState->xChangePending == pdFALSE )
+                {
+                    pxState->xChangePending = pdTRUE;
+                    pxState->xFirstChangeTicks = xTaskGetTickCount();
+                }
+            }
+        }
+
+        ( void ) xSemaphoreGive( pxState->xMutex );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint8_t SHADOW_StateGetDesired( ShadowState_t * const pxState,
+                                const char * const pcKey,
+                                char * const pcBuffer,
+                                size_t xBufferLength )
+{
+    ShadowStateField_t * pxField;
+    uint8_t ucReturn = 0;
+
+    configASSERT( pxState != NULL );
+    configASSERT( pcKey != NULL );
+    configASSERT( pcBuffer != NULL );
+
+    ( void ) xSemaphoreTake( pxState->xMutex, portMAX_DELAY );
+
+    pxField = prvFindField( pxState, pcKey, ( uint16_t ) strlen( pcKey ) );
+
+    if( ( pxField != NULL ) && ( pxField->ucDesiredLength <= xBufferLength ) )
+    {
+        ucReturn = pxField->ucDesiredLength;
+        memcpy( pcBuffer, pxField->cDesired, ucReturn );
+
+        if( ucReturn < xBufferLength )
+        {
+            pcBuffer[ ucReturn ] = '\0';
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxState->xMutex );
+
+    return ucReturn;
+}
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_StateApplyDelta( ShadowState_t * const pxState,
+                                           const char * const pcDeltaDocument,
+                                           uint32_t ulDocumentLength )
+{
+    return prvApplyDocument( pxState, pcDeltaDocument, ulDocumentLength, pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+ShadowReturnCode_t SHADOW_StateApplyDocument( ShadowState_t * const pxState,
+                                              const char * const pcDocument,
+                                              uint32_t ulDocumentLength )
+{
+    return prvApplyDocument( pxState, pcDocument, ulDocumentLength, pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+TickType_t SHADOW_StateProcess( ShadowState_t * const pxState,
+                                TickType_t xTimeoutTicks )
+{
+    ShadowOperationParams_t xUpdateParams;
+    ShadowReturnCode_t xResult;
+    TickType_t xElapsed, xReturn;
+    uint32_t ulLength = 0;
+    BaseType_t xMore = pdFALSE;
+
+    configASSERT( pxState != NULL );
+
+    ( void ) xSemaphoreTake( pxState->xMutex, portMAX_DELAY );
+
+    if( pxState->xChangePending == pdFALSE )
+    {
+        xReturn = portMAX_DELAY;
+    }
+    else
+    {
+        xElapsed = xTaskGetTickCount() - pxState->xFirstChangeTicks;
+
+        if( xElapsed < pxState->xCoalesceTicks )
+        {
+            xReturn = pxState->xCoalesceTicks - xElapsed;
+        }
+        else
+        {
+            /* Changes made while the update is in progress start a new window. */
+            pxState->xChangePending = pdFALSE;
+            ulLength = prvBuildUpdate( pxState, &xMore );
+            xReturn = portMAX_DELAY;
+        }
+    }
+
+    ( void ) xSemaphoreGive( pxState->xMutex );
+
+    if( ulLength > 0UL )
+    {
+        Shadow_debug_printf( ( "[Shadow state] Reporting %.*s\r\n", ( int ) ulLength, pxState->cDocument ) );
+
+        xUpdateParams.pcThingName = pxState->pcThingName;
+        xUpdateParams.pcData = pxState->cDocument;
+        xUpdateParams.ulDataLength = ulLength;
+        xUpdateParams.xBuffer = NULL;
+        xUpdateParams.ucKeepSubscriptions = pdTRUE;
+        xUpdateParams.xQoS = eMQTTQoS0;
+
+        xResult = SHADOW_Update( pxState->xShadowClientHandle, &xUpdateParams, xTimeoutTicks );
+
+        if( xResult != eShadowSuccess )
+        {
+            Shadow_debug_printf( ( "[Shadow state] Update failed, returned %d.\r\n", xResult ) );
+        }
+
+        ( void ) xSemaphoreTake( pxState->xMutex, portMAX_DELAY );
+
+        prvCompleteUpdate( pxState, ( xResult == eShadowSuccess ) ? pdTRUE : pdFALSE );
+
+        if( ( xResult != eShadowSuccess ) || ( xMore == pdTRUE ) )
+        {
+            /* Fields that did not fit are published right away, failed
+             * updates are retried after another window. */
+            if( pxState->xChangePending == pdFALSE )
+            {
+                pxState->xChangePending = pdTRUE;
+                pxState->xFirstChangeTicks = xTaskGetTickCount();
+
+                if( xResult == eShadowSuccess )
+                {
+                    pxState->xFirstChangeTicks -= pxState->xCoalesceTicks;
+                }
+            }
+        }
+
+        if( pxState->xChangePending == pdTRUE )
+        {
+            xElapsed = xTaskGetTickCount() - pxState->xFirstChangeTicks;
+            xReturn = ( xElapsed < pxState->xCoalesceTicks ) ? ( pxState->xCoalesceTicks - xElapsed ) : 0;
+        }
+
+        ( void ) xSemaphoreGive( pxState->xMutex );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
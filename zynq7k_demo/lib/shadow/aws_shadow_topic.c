@@ -0,0 +1,339 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_shadow_topic.c
+ * @brief Building, classifying and indexing Shadow MQTT topics.
+ */
+
+/* C library includes. */
+#include <string.h>
+
+/* AWS includes. */
+#include "aws_shadow_topic.h"
+
+/**
+ * @brief The parts of the Shadow MQTT topics.
+ * Refer to docs.aws.amazon.com/iot/latest/developerguide/device-shadow-mqtt.html
+ * If the MQTT topics change, update them here.
+ */
+/** @{ */
+#define shadowTOPIC_THINGS_PREFIX       "$aws/things/"
+#define shadowTOPIC_SHADOW_INFIX        "/shadow/"
+#define shadowTOPIC_OPERATION_UPDATE    "update"
+#define shadowTOPIC_OPERATION_GET       "get"
+#define shadowTOPIC_OPERATION_DELETE    "delete"
+#define shadowTOPIC_SUFFIX_ACCEPTED     "/accepted"
+#define shadowTOPIC_SUFFIX_REJECTED     "/rejected"
+#define shadowTOPIC_SUFFIX_DOCUMENTS    "/documents"
+#define shadowTOPIC_SUFFIX_DELTA        "/delta"
+/** @} */
+
+/**
+ * @brief FNV-1a parameters of SHADOW_TopicHash().
+ */
+/** @{ */
+#define shadowTOPIC_HASH_OFFSET         ( 2166136261UL )
+#define shadowTOPIC_HASH_PRIME          ( 16777619UL )
+/** @} */
+
+/**
+ * @brief A string and its length, for the parts of the topics.
+ */
+typedef struct ShadowTopicPart
+{
+    const char * pcString;
+    uint16_t usLength;
+} ShadowTopicPart_t;
+
+#define shadowTOPIC_PART( x )    { ( x ), ( uint16_t ) ( sizeof( x ) - 1 ) }
+
+/* Indexed by ShadowOperationName_t. update/documents and update/delta are the
+ * update operation followed by a suffix. */
+static const ShadowTopicPart_t xOperations[] =
+{
+    shadowTOPIC_PART( shadowTOPIC_OPERATION_UPDATE ),
+    shadowTOPIC_PART( shadowTOPIC_OPERATION_GET ),
+    shadowTOPIC_PART( shadowTOPIC_OPERATION_DELETE )
+};
+
+/* Indexed by ShadowTopicStatus_t. */
+static const ShadowTopicPart_t xStatuses[] =
+{
+    { "", 0 },
+    shadowTOPIC_PART( shadowTOPIC_SUFFIX_ACCEPTED ),
+    shadowTOPIC_PART( shadowTOPIC_SUFFIX_REJECTED )
+};
+
+static const ShadowTopicPart_t xDocumentsSuffix = shadowTOPIC_PART( shadowTOPIC_SUFFIX_DOCUMENTS );
+static const ShadowTopicPart_t xDeltaSuffix = shadowTOPIC_PART( shadowTOPIC_SUFFIX_DELTA );
+static const ShadowTopicPart_t xThingsPrefix = shadowTOPIC_PART( shadowTOPIC_THINGS_PREFIX );
+static const ShadowTopicPart_t xShadowInfix = shadowTOPIC_PART( shadowTOPIC_SHADOW_INFIX );
+
+/**
+ * @brief Returns pdTRUE if pcString starts with xPart and has usLength bytes
+ * left for it.
+ */
+static BaseType_t prvStartsWith( const char * const pcString,
+                                 uint16_t usLength,
+                                 const ShadowTopicPart_t * const pxPart );
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStartsWith( const char * const pcString,
+                                 uint16_t usLength,
+                                 const ShadowTopicPart_t * const pxPart )
+{
+    BaseType_t xReturn = pdFALSE;
+
+    if( ( usLength >= pxPart->usLength ) &&
+        ( memcmp( pcString, pxPart->pcString, pxPart->usLength ) == 0 ) )
+    {
+        xReturn = pdTRUE;
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t SHADOW_TopicHash( const char * const pcThingName,
+                           uint16_t usThingNameLength )
+{
+    uint32_t ulHash = shadowTOPIC_HASH_OFFSET;
+    uint16_t usIndex;
+
+    for( usIndex = 0; usIndex < usThingNameLength; usIndex++ )
+    {
+        ulHash = ( ulHash ^ ( uint8_t ) pcThingName[ usIndex ] ) * shadowTOPIC_HASH_PRIME;
+    }
+
+    return ulHash;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t SHADOW_TopicParse( const uint8_t * const pucTopic,
+                              uint16_t usTopicLength,
+                              ShadowTopic_t * const pxTopic )
+{
+    const char * pcTopic = ( const char * ) pucTopic;
+    const char * pcRest;
+    uint16_t usRestLength;
+    uint16_t usIndex;
+    uint32_t ulHash = shadowTOPIC_HASH_OFFSET;
+    BaseType_t xOperation;
+    BaseType_t xStatus;
+    BaseType_t xReturn = pdFALSE;
+
+    configASSERT( pucTopic != NULL );
+    configASSERT( pxTopic != NULL );
+
+    if( prvStartsWith( pcTopic, usTopicLength, &xThingsPrefix ) == pdTRUE )
+    {
+        /* Thing Names cannot contain '/'. Hash the name while looking for its end. */
+        for( usIndex = xThingsPrefix.usLength; usIndex < usTopicLength; usIndex++ )
+        {
+            if( pcTopic[ usIndex ] == '/' )
+            {
+                break;
+            }
+
+            ulHash = ( ulHash ^ ( uint8_t ) pcTopic[ usIndex ] ) * shadowTOPIC_HASH_PRIME;
+        }
+
+        pxTopic->pcThingName = &( pcTopic[ xThingsPrefix.usLength ] );
+        pxTopic->usThingNameLength = usIndex - xThingsPrefix.usLength;
+        pxTopic->ulThingNameHash = ulHash;
+        pcRest = &( pcTopic[ usIndex ] );
+        usRestLength = usTopicLength - usIndex;
+
+        if( ( pxTopic->usThingNameLength > 0U ) &&
+            ( prvStartsWith( pcRest, usRestLength, &xShadowInfix ) == pdTRUE ) )
+        {
+            pcRest += xShadowInfix.usLength;
+            usRestLength -= xShadowInfix.usLength;
+
+            for( xOperation = 0; xOperation < ( BaseType_t ) ( sizeof( xOperations ) / sizeof( xOperations[ 0 ] ) ); xOperation++ )
+            {
+                if( prvStartsWith( pcRest, usRestLength, &( xOperations[ xOperation ] ) ) == pdTRUE )
+                {
+                    pcRest += xOperations[ xOperation ].usLength;
+                    usRestLength -= xOperations[ xOperation ].usLength;
+                    pxTopic->xOperationName = ( ShadowOperationName_t ) xOperation;
+                    break;
+                }
+            }
+
+            if( xOperation < ( BaseType_t ) ( sizeof( xOperations ) / sizeof( xOperations[ 0 ] ) ) )
+            {
+                /* The suffix must be the rest of the topic. */
+                for( xStatus = 0; xStatus < ( BaseType_t ) ( sizeof( xStatuses ) / sizeof( xStatuses[ 0 ] ) ); xStatus++ )
+                {
+                    if( ( usRestLength == xStatuses[ xStatus ].usLength ) &&
+                        ( prvStartsWith( pcRest, usRestLength, &( xStatuses[ xStatus ] ) ) == pdTRUE ) )
+                    {
+                        pxTopic->xStatus = ( ShadowTopicStatus_t ) xStatus;
+                        xReturn = pdTRUE;
+                        break;
+                    }
+                }
+
+                if( ( xReturn == pdFALSE ) && ( pxTopic->xOperationName == eShadowOperationUpdate ) )
+                {
+                    pxTopic->xStatus = eShadowTopicNoStatus;
+
+                    if( ( usRestLength == xDocumentsSuffix.usLength ) &&
+                        ( prvStartsWith( pcRest, usRestLength, &xDocumentsSuffix ) == pdTRUE ) )
+                    {
+                        pxTopic->xOperationName = eShadowOperationUpdateDocuments;
+                        xReturn = pdTRUE;
+                    }
+                    else if( ( usRestLength == xDeltaSuffix.usLength ) &&
+                             ( prvStartsWith( pcRest, usRestLength, &xDeltaSuffix ) == pdTRUE ) )
+                    {
+                        pxTopic->xOperationName = eShadowOperationUpdateDelta;
+                        xReturn = pdTRUE;
+                    }
+                    else
+                    {
+                        /* Not a Shadow topic. */
+                    }
+                }
+            }
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+uint16_t SHADOW_TopicBuild( char * const pcBuffer,
+                            uint16_t usBufferLength,
+                            const char * const pcThingName,
+                            uint16_t usThingNameLength,
+                            ShadowOperationName_t xOperationName,
+                            ShadowTopicStatus_t xStatus )
+{
+    const ShadowTopicPart_t * pxOperation;
+    const ShadowTopicPart_t * pxSuffix;
+    uint16_t usLength = 0;
+
+    configASSERT( pcBuffer != NULL );
+    configASSERT( pcThingName != NULL );
+
+    switch( xOperationName )
+    {
+        case eShadowOperationUpdateDocuments:
+            pxOperation = &( xOperations[ eShadowOperationUpdate ] );
+            pxSuffix = &xDocumentsSuffix;
+            break;
+
+        case eShadowOperationUpdateDelta:
+            pxOperation = &( xOperations[ eShadowOperationUpdate ] );
+            pxSuffix = &xDeltaSuffix;
+            break;
+
+        case eShadowOperationUpdate:
+        case eShadowOperationGet:
+        case eShadowOperationDelete:
+            pxOperation = &( xOperations[ xOperationName ] );
+            pxSuffix = &( xStatuses[ xStatus ] );
+            break;
+
+        default:
+            pxOperation = NULL;
+            pxSuffix = NULL;
+            break;
+    }
+
+    configASSERT( pxOperation != NULL );
+
+    if( ( pxOperation != NULL ) &&
+        ( ( ( uint32_t ) xThingsPrefix.usLength + usThingNameLength + xShadowInfix.usLength +
+            pxOperation->usLength + pxSuffix->usLength ) < usBufferLength ) )
+    {
+        memcpy( pcBuffer, xThingsPrefix.pcString, xThingsPrefix.usLength );
+        usLength = xThingsPrefix.usLength;
+        memcpy( &( pcBuffer[ usLength ] ), pcThingName, usThingNameLength );
+        usLength += usThingNameLength;
+        memcpy( &( pcBuffer[ usLength ] ), xShadowInfix.pcString, xShadowInfix.usLength );
+        usLength += xShadowInfix.usLength;
+        memcpy( &( pcBuffer[ usLength ] ), pxOperation->pcString, pxOperation->usLength );
+        usLength += pxOperation->usLength;
+        memcpy( &( pcBuffer[ usLength ] ), pxSuffix->pcString, pxSuffix->usLength );
+        usLength += pxSuffix->usLength;
+        pcBuffer[ usLength ] = '\0';
+    }
+
+    return usLength;
+}
+/*-----------------------------------------------------------*/
+
+void SHADOW_TopicIndexSet( ShadowTopicIndexEntry_t * const pxEntry,
+                           const char * const pcThingName )
+{
+    configASSERT( pxEntry != NULL );
+
+    if( pcThingName != NULL )
+    {
+        pxEntry->usThingNameLength = ( uint16_t ) strlen( pcThingName );
+        pxEntry->ulThingNameHash = SHADOW_TopicHash( pcThingName, pxEntry->usThingNameLength );
+    }
+    else
+    {
+        pxEntry->usThingNameLength = 0;
+        pxEntry->ulThingNameHash = 0;
+    }
+
+    pxEntry->pcThingName = pcThingName;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t SHADOW_TopicIndexFind( const ShadowTopicIndexEntry_t * const pxEntries,
+                                  BaseType_t xEntryCount,
+                                  const char * const pcThingName,
+                                  uint16_t usThingNameLength,
+                                  uint32_t ulThingNameHash )
+{
+    BaseType_t xIndex;
+    BaseType_t xReturn = -1;
+
+    configASSERT( pxEntries != NULL );
+
+    /* Names are only compared when the hash and length match. */
+    for( xIndex = 0; xIndex < xEntryCount; xIndex++ )
+    {
+        if( ( pxEntries[ xIndex ].ulThingNameHash == ulThingNameHash ) &&
+            ( pxEntries[ xIndex ].usThingNameLength == usThingNameLength ) &&
+            ( pxEntries[ xIndex ].pcThingName != NULL ) &&
+            ( memcmp( pxEntries[ xIndex ].pcThingName, pcThingName, usThingNameLength ) == 0 ) )
+        {
+            xReturn = xIndex;
+            break;
+        }
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
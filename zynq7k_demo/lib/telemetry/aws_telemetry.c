@@ -0,0 +1,423 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_telemetry.c
+ * @brief Samples and publishes the run time statistics.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "NetworkBufferManagement.h"
+
+/* Telemetry includes. */
+#include "aws_telemetry.h"
+#include "aws_clientcredential.h"
+#include "aws_telemetry_config.h"
+#include "aws_telemetry_config_defaults.h"
+#include "aws_task_stats.h"
+
+/* CBOR and static memory includes. */
+#include "aws_cbor.h"
+#include "aws_static_memory.h"
+
+/**
+ * @brief Share of ulTotal taken by ulPart, in tenths of a percent.
+ */
+#define telemetryLOAD( ulPart, ulTotal ) \
+    ( ( ( ulTotal ) == 0UL ) ? 0UL : ( uint32_t ) ( ( ( uint64_t ) ( ulPart ) * 1000U ) / ( ulTotal ) ) )
+
+/**
+ * @brief Run time of each task in the last interval. Only used by the sampler.
+ */
+static TaskStatsTask_t xTaskStats[ telemetryconfigMAX_TASKS ] staticmemSECTION( telemetry );
+
+/**
+ * @brief Per task figures and history ring. Written with the scheduler
+ * suspended so that readers see a consistent sample.
+ */
+static TelemetryTask_t xTasks[ telemetryconfigMAX_TASKS ] staticmemSECTION( telemetry );
+static size_t xTaskCount;
+static TelemetrySample_t xHistory[ telemetryconfigHISTORY_LENGTH ] staticmemSECTION( telemetry );
+static uint32_t ulSampleCount;
+
+/**
+ * @brief Samples not taken because more than telemetryconfigMAX_TASKS tasks
+ * existed.
+ */
+static volatile uint32_t ulSamplesSkipped;
+
+/**
+ * @brief Agent the snapshots are published with, NULL when not connected.
+ * Held across a publish by xTelemetryAgentMutex, so that the agent is not
+ * cleared while it is in use.
+ */
+static MQTTAgentHandle_t xTelemetryMqttAgent;
+static SemaphoreHandle_t xTelemetryAgentMutex;
+
+/**
+ * @brief Snapshot being published and its topic. Only used by the telemetry
+ * task.
+ */
+static uint8_t ucSnapshot[ telemetryconfigSNAPSHOT_BUFFER_SIZE ] staticmemSECTION( telemetry );
+static char cTopic[ telemetryconfigTOPIC_BUFFER_SIZE ] staticmemSECTION( telemetry );
+static uint16_t usTopicLength;
+
+/**
+ * @brief Handle of the telemetry task, NULL until it is started.
+ */
+static TaskHandle_t xTelemetryTask;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    static StaticTask_t xTelemetryTaskBuffer staticmemSECTION( telemetry );
+    static StackType_t xTelemetryTaskStack[ telemetryconfigTASK_STACK_SIZE ] staticmemSECTION( telemetry );
+    static StaticSemaphore_t xTelemetryAgentMutexBuffer staticmemSECTION( telemetry );
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Return the mutex guarding the agent handle, creating it on first
+ * use as the agent may be set before the task is started.
+ */
+static SemaphoreHandle_t prvGetAgentMutex( void );
+
+/**
+ * @brief Publish a snapshot of the last sample if an agent is set.
+ */
+static void prvPublishSnapshot( void );
+
+/**
+ * @brief Samples every telemetryconfigSAMPLE_PERIOD_MS and publishes every
+ * telemetryconfigPUBLISH_PERIOD_MS.
+ */
+static void prvTelemetryTask( void * pvParameters );
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TELEMETRY_Sample( void )
+{
+    TelemetrySample_t xSample = { 0 };
+    TaskStatsInterval_t xInterval = { 0 };
+    size_t xI = 0;
+
+    if( TASKSTATS_Sample( xTaskStats, telemetryconfigMAX_TASKS, &xInterval ) != pdPASS )
+    {
+        ulSamplesSkipped++;
+
+        return pdFAIL;
+    }
+
+    /* The first sample only starts the interval. Its load would be measured
+     * since boot and hide any overload in the history. */
+    if( xInterval.ulRunTime == 0UL )
+    {
+        return pdFAIL;
+    }
+
+    xSample.ulUptimeMs = ( uint32_t ) xTaskGetTickCount() * portTICK_PERIOD_MS;
+    xSample.usCpuLoad = ( uint16_t ) telemetryLOAD( xInterval.ulBusyRunTime, xInterval.ulRunTime );
+    xSample.ulLowestStackHeadroom = UINT32_MAX;
+    xSample.ulHeapFree = ( uint32_t ) xPortGetFreeHeapSize();
+    xSample.ulHeapMinimumEverFree = ( uint32_t ) xPortGetMinimumEverFreeHeapSize();
+    xSample.usNetworkBuffersFree = ( uint16_t ) uxGetNumberOfFreeNetworkBuffers();
+    xSample.usNetworkBuffersMinimum = ( uint16_t ) uxGetMinimumFreeNetworkBuffers();
+
+    /* Hold off the readers while the per task figures are rewritten. */
+    vTaskSuspendAll();
+    {
+        for( xI = 0; xI < xInterval.xTaskCount; xI++ )
+        {
+            const TaskStatsTask_t * pxStats = &xTaskStats[ xI ];
+            TelemetryTask_t * pxTask = &xTasks[ xI ];
+
+            ( void ) strncpy( pxTask->cTaskName, pxStats->cTaskName, telemetryTASK_NAME_LENGTH - 1 );
+            pxTask->cTaskName[ telemetryTASK_NAME_LENGTH - 1 ] = '\0';
+            pxTask->ulTaskNumber = pxStats->ulTaskNumber;
+            pxTask->ulCpuLoad = telemetryLOAD( pxStats->ulRunTime, xInterval.ulRunTime );
+            pxTask->ulStackHeadroom = pxStats->ulStackHeadroom;
+
+            if( ( pxTask->ulTaskNumber != xInterval.ulIdleTaskNumber ) &&
+                ( pxTask->ulCpuLoad >= xSample.usBusiestTaskLoad ) )
+            {
+                xSample.usBusiestTaskLoad = ( uint16_t ) pxTask->ulCpuLoad;
+                xSample.ulBusiestTaskNumber = pxTask->ulTaskNumber;
+            }
+
+            if( pxTask->ulStackHeadroom < xSample.ulLowestStackHeadroom )
+            {
+                xSample.ulLowestStackHeadroom = pxTask->ulStackHeadroom;
+                xSample.ulLowestStackTaskNumber = pxTask->ulTaskNumber;
+            }
+        }
+
+        xTaskCount = xInterval.xTaskCount;
+
+        xHistory[ ulSampleCount % telemetryconfigHISTORY_LENGTH ] = xSample;
+        ulSampleCount++;
+    }
+    ( void ) xTaskResumeAll();
+
+    return pdPASS;
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t TELEMETRY_GetSkippedSamples( void )
+{
+    return ulSamplesSkipped;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t TELEMETRY_GetTasks( TelemetryTask_t * pxTasks,
+                           size_t xMaxTasks )
+{
+    size_t xCount = 0;
+
+    vTaskSuspendAll();
+    {
+        xCount = ( xTaskCount < xMaxTasks ) ? xTaskCount : xMaxTasks;
+        ( void ) memcpy( pxTasks, xTasks, xCount * sizeof( TelemetryTask_t ) );
+    }
+    ( void ) xTaskResumeAll();
+
+    return xCount;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t TELEMETRY_ReadHistory( TelemetrySample_t * pxSamples,
+                              size_t xMaxSamples )
+{
+    size_t xCount = 0;
+    size_t xI = 0;
+    uint32_t ulFirst = 0;
+
+    vTaskSuspendAll();
+    {
+        xCount = ( ulSampleCount < telemetryconfigHISTORY_LENGTH ) ? ( size_t ) ulSampleCount : telemetryconfigHISTORY_LENGTH;
+
+        if( xCount > xMaxSamples )
+        {
+            xCount = xMaxSamples;
+        }
+
+        ulFirst = ulSampleCount - ( uint32_t ) xCount;
+
+        for( xI = 0; xI < xCount; xI++ )
+        {
+            pxSamples[ xI ] = xHistory[ ( ulFirst + ( uint32_t ) xI ) % telemetryconfigHISTORY_LENGTH ];
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xCount;
+}
+
+/*-----------------------------------------------------------*/
+
+size_t TELEMETRY_EncodeSnapshot( uint8_t * pucBuffer,
+                                 size_t xBufferSize )
+{
+    CBOREncoder_t xEncoder;
+    const TelemetrySample_t * pxLast = NULL;
+    size_t xI = 0;
+    size_t xSize = 0;
+
+    /* Encoding a few hundred bytes is quicker than copying the tasks out. */
+    vTaskSuspendAll();
+    {
+        if( ulSampleCount > 0 )
+        {
+            pxLast = &xHistory[ ( ulSampleCount - 1U ) % telemetryconfigHISTORY_LENGTH ];
+
+            CBOR_EncoderInit( &xEncoder, pucBuffer, ( cbor_ssize_t ) xBufferSize );
+            CBOR_EncodeMap( &xEncoder, 5 );
+            /* In seconds, the milliseconds would not fit in a cbor_int_t after
+             * 24 days. */
+            CBOR_EncodeKeyWithInt( &xEncoder, "up", ( cbor_int_t ) ( pxLast->ulUptimeMs / 1000UL ) );
+            CBOR_EncodeKeyWithInt( &xEncoder, "cpu", ( cbor_int_t ) pxLast->usCpuLoad );
+            CBOR_EncodeKeyWithMap( &xEncoder, "heap", 2 );
+            CBOR_EncodeKeyWithInt( &xEncoder, "free", ( cbor_int_t ) pxLast->ulHeapFree );
+            CBOR_EncodeKeyWithInt( &xEncoder, "min", ( cbor_int_t ) pxLast->ulHeapMinimumEverFree );
+            CBOR_EncodeKeyWithMap( &xEncoder, "net", 2 );
+            CBOR_EncodeKeyWithInt( &xEncoder, "free", ( cbor_int_t ) pxLast->usNetworkBuffersFree );
+            CBOR_EncodeKeyWithInt( &xEncoder, "min", ( cbor_int_t ) pxLast->usNetworkBuffersMinimum );
+            CBOR_EncodeString( &xEncoder, "tasks" );
+            CBOR_EncodeArray( &xEncoder, ( cbor_ssize_t ) xTaskCount );
+
+            for( xI = 0; xI < xTaskCount; xI++ )
+            {
+                CBOR_EncodeArray( &xEncoder, 3 );
+                CBOR_EncodeString( &xEncoder, xTasks[ xI ].cTaskName );
+                CBOR_EncodeInt( &xEncoder, ( cbor_int_t ) xTasks[ xI ].ulCpuLoad );
+                CBOR_EncodeInt( &xEncoder, ( cbor_int_t ) xTasks[ xI ].ulStackHeadroom );
+            }
+
+            if( CBOR_EncoderCheckError( &xEncoder ) == eCborErrNoError )
+            {
+                xSize = ( size_t ) CBOR_EncoderSize( &xEncoder );
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static SemaphoreHandle_t prvGetAgentMutex( void )
+{
+    vTaskSuspendAll();
+    {
+        if( xTelemetryAgentMutex == NULL )
+        {
+            #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+                xTelemetryAgentMutex = xSemaphoreCreateMutexStatic( &xTelemetryAgentMutexBuffer );
+            #else
+                xTelemetryAgentMutex = xSemaphoreCreateMutex();
+            #endif
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xTelemetryAgentMutex;
+}
+
+/*-----------------------------------------------------------*/
+
+void TELEMETRY_MqttAgentSet( MQTTAgentHandle_t xMQTTAgent )
+{
+    SemaphoreHandle_t xMutex = prvGetAgentMutex();
+
+    configASSERT( xMutex != NULL );
+
+    /* Waits for a publish in flight, so the previous agent is no longer used
+     * once this returns. */
+    ( void ) xSemaphoreTake( xMutex, portMAX_DELAY );
+    xTelemetryMqttAgent = xMQTTAgent;
+    ( void ) xSemaphoreGive( xMutex );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPublishSnapshot( void )
+{
+    SemaphoreHandle_t xMutex = prvGetAgentMutex();
+    MQTTAgentPublishParams_t xPublishParams = { 0 };
+    size_t xSize = 0;
+
+    configASSERT( xMutex != NULL );
+
+    ( void ) xSemaphoreTake( xMutex, portMAX_DELAY );
+
+    if( ( xTelemetryMqttAgent != NULL ) && ( usTopicLength > 0 ) )
+    {
+        xSize = TELEMETRY_EncodeSnapshot( ucSnapshot, sizeof( ucSnapshot ) );
+    }
+
+    if( xSize > 0 )
+    {
+        xPublishParams.pucTopic = ( const uint8_t * ) cTopic;
+        xPublishParams.usTopicLength = usTopicLength;
+        xPublishParams.xQoS = eMQTTQoS0;
+        xPublishParams.pvData = ucSnapshot;
+        xPublishParams.ulDataLength = ( uint32_t ) xSize;
+
+        /* A failed publish is not retried, the next snapshot is newer. */
+        ( void ) MQTT_AGENT_Publish( xTelemetryMqttAgent, &xPublishParams, pdMS_TO_TICKS( telemetryconfigPUBLISH_TIMEOUT_MS ) );
+    }
+
+    ( void ) xSemaphoreGive( xMutex );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTelemetryTask( void * pvParameters )
+{
+    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t xLastPublishTime = xLastWakeTime;
+    int lLength = 0;
+
+    ( void ) pvParameters;
+
+    /* The thing name is only known at run time. */
+    lLength = snprintf( cTopic, sizeof( cTopic ), "%s%s", clientcredentialIOT_THING_NAME, telemetryconfigTOPIC_SUFFIX );
+
+    if( ( lLength > 0 ) && ( ( size_t ) lLength < sizeof( cTopic ) ) )
+    {
+        usTopicLength = ( uint16_t ) lLength;
+    }
+
+    for( ; ; )
+    {
+        vTaskDelayUntil( &xLastWakeTime, pdMS_TO_TICKS( telemetryconfigSAMPLE_PERIOD_MS ) );
+
+        if( ( TELEMETRY_Sample() == pdPASS ) &&
+            ( ( xLastWakeTime - xLastPublishTime ) >= pdMS_TO_TICKS( telemetryconfigPUBLISH_PERIOD_MS ) ) )
+        {
+            xLastPublishTime = xLastWakeTime;
+            prvPublishSnapshot();
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TELEMETRY_Start( void )
+{
+    if( xTelemetryTask == NULL )
+    {
+        #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+            xTelemetryTask = xTaskCreateStatic( prvTelemetryTask,
+                                                "Telemetry",
+                                                telemetryconfigTASK_STACK_SIZE,
+                                                NULL,
+                                                telemetryconfigTASK_PRIORITY,
+                                                xTelemetryTaskStack,
+                                                &xTelemetryTaskBuffer );
+        #else
+            ( void ) xTaskCreate( prvTelemetryTask,
+                                  "Telemetry",
+                                  telemetryconfigTASK_STACK_SIZE,
+                                  NULL,
+                                  telemetryconfigTASK_PRIORITY,
+                                  &xTelemetryTask );
+        #endif
+    }
+
+    return ( xTelemetryTask != NULL ) ? pdPASS : pdFAIL;
+}
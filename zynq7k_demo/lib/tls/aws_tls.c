@@ -27,12 +27,15 @@
 #include "FreeRTOS.h"
 #include "FreeRTOSIPConfig.h"
 #include "aws_tls.h"
+#include "aws_tls_config.h"
+#include "aws_tls_config_defaults.h"
 #include "aws_crypto.h"
 #include "aws_pkcs11.h"
 #include "aws_pkcs11_config.h"
 #include "task.h"
 #include "aws_clientcredential.h"
 #include "aws_default_root_certificates.h"
+#include "aws_trace.h"
 
 /* mbedTLS includes. */
 #include "mbedtls/platform.h"
@@ -52,6 +55,23 @@
 #include <time.h>
 #include <stdio.h>
 
+/**
+ * @brief max_fragment_length code for tlsconfigMAX_FRAGMENT_LENGTH.
+ */
+#if ( tlsconfigMAX_FRAGMENT_LENGTH == 0 )
+    #define tlsMAX_FRAG_LEN_CODE    MBEDTLS_SSL_MAX_FRAG_LEN_NONE
+#elif ( tlsconfigMAX_FRAGMENT_LENGTH == 512 )
+    #define tlsMAX_FRAG_LEN_CODE    MBEDTLS_SSL_MAX_FRAG_LEN_512
+#elif ( tlsconfigMAX_FRAGMENT_LENGTH == 1024 )
+    #define tlsMAX_FRAG_LEN_CODE    MBEDTLS_SSL_MAX_FRAG_LEN_1024
+#elif ( tlsconfigMAX_FRAGMENT_LENGTH == 2048 )
+    #define tlsMAX_FRAG_LEN_CODE    MBEDTLS_SSL_MAX_FRAG_LEN_2048
+#elif ( tlsconfigMAX_FRAGMENT_LENGTH == 4096 )
+    #define tlsMAX_FRAG_LEN_CODE    MBEDTLS_SSL_MAX_FRAG_LEN_4096
+#else
+    #error "tlsconfigMAX_FRAGMENT_LENGTH must be 0, 512, 1024, 2048 or 4096."
+#endif
+
 /**
  * @brief Internal context structure.
  *
@@ -70,6 +90,10 @@
  * @param[out] xP11FunctionList PKCS#11 function list structure.
  * @param[out] xP11Session PKCS#11 session context.
  * @param[out] xP11PrivateKey PKCS#11 private key context.
+ * @param[in] xCoalesceWrites Whether small writes are coalesced.
+ * @param[out] xPending Bytes waiting in ucCoalesceBuffer.
+ * @param[out] xPendingSince Tick count at which the oldest of them was written.
+ * @param[out] ucCoalesceBuffer Plaintext of the writes not sent yet.
  */
 typedef struct TLSContext
 {
@@ -96,6 +120,14 @@ typedef struct TLSContext
     CK_FUNCTION_LIST_PTR xP11FunctionList;
     CK_SESSION_HANDLE xP11Session;
     CK_OBJECT_HANDLE xP11PrivateKey;
+
+    /* Write coalescing. */
+    #if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+        BaseType_t xCoalesceWrites;
+        size_t xPending;
+        TickType_t xPendingSince;
+        unsigned char ucCoalesceBuffer[ tlsconfigCOALESCE_BUFFER_SIZE ];
+    #endif
 } TLSContext_t;
 
 
@@ -130,6 +162,150 @@ static void prvFreeContext( TLSContext_t * pxCtx )
     }
 }
 
+/**
+ * @brief Encrypts and sends a byte buffer, one or more records at a time.
+ *
+ * @param[in] pxCtx TLS context.
+ * @param[in] pucMsg Plaintext to send.
+ * @param[in] xMsgLength Length of the plaintext.
+ *
+ * @return Number of bytes sent, or a negative value on error. A hard error
+ * invalidates the context.
+ */
+static BaseType_t prvWrite( TLSContext_t * pxCtx,
+                            const unsigned char * pucMsg,
+                            size_t xMsgLength )
+{
+    BaseType_t xResult = 0;
+    size_t xWritten = 0;
+
+    while( xWritten < xMsgLength )
+    {
+        xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx,
+                                     pucMsg + xWritten,
+                                     xMsgLength - xWritten );
+
+        if( 0 < xResult )
+        {
+            /* Sent data, so update the tally and keep looping. */
+            xWritten += ( size_t ) xResult;
+        }
+        else if( 0 == xResult )
+        {
+            /* No data sent (and no error). The secure sockets
+             * API supports non-blocking send, so stop the loop but don't
+             * flag an error. */
+            break;
+        }
+        else if( MBEDTLS_ERR_SSL_WANT_WRITE != xResult )
+        {
+            /* Hard error: invalidate the context and stop. */
+            prvFreeContext( pxCtx );
+            break;
+        }
+    }
+
+    if( 0 <= xResult )
+    {
+        xResult = ( BaseType_t ) xWritten;
+    }
+
+    return xResult;
+}
+
+#if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+
+/**
+ * @brief Sends the coalesced writes as one record.
+ *
+ * @param[in] pxCtx TLS context.
+ *
+ * @return Number of bytes still buffered, or a negative value on error.
+ */
+    static BaseType_t prvFlush( TLSContext_t * pxCtx )
+    {
+        BaseType_t xResult = 0;
+
+        if( 0U < pxCtx->xPending )
+        {
+            xResult = prvWrite( pxCtx, pxCtx->ucCoalesceBuffer, pxCtx->xPending );
+
+            if( 0 <= xResult )
+            {
+                /* Keep what a non-blocking socket did not take. */
+                pxCtx->xPending -= ( size_t ) xResult;
+                memmove( pxCtx->ucCoalesceBuffer,
+                         &pxCtx->ucCoalesceBuffer[ xResult ],
+                         pxCtx->xPending );
+                xResult = ( BaseType_t ) pxCtx->xPending;
+            }
+            else
+            {
+                pxCtx->xPending = 0;
+            }
+        }
+
+        return xResult;
+    }
+
+/**
+ * @brief Buffers a short write behind the pending ones, or sends a long one
+ * once nothing is pending.
+ *
+ * @param[in] pxCtx TLS context.
+ * @param[in] pucMsg Plaintext to send.
+ * @param[in] xMsgLength Length of the plaintext.
+ *
+ * @return Number of bytes buffered or sent, or a negative value on error.
+ */
+    static BaseType_t prvCoalesce( TLSContext_t * pxCtx,
+                                   const unsigned char * pucMsg,
+                                   size_t xMsgLength )
+    {
+        BaseType_t xResult = 0;
+        const TickType_t xDeadline = pdMS_TO_TICKS( tlsconfigCOALESCE_DEADLINE_MS );
+
+        /* Send the buffered data when it is due, or when this write does not
+         * fit behind it. */
+        if( ( 0U < pxCtx->xPending ) &&
+            ( ( ( pxCtx->xPending + xMsgLength ) > sizeof( pxCtx->ucCoalesceBuffer ) ) ||
+              ( ( xTaskGetTickCount() - pxCtx->xPendingSince ) >= xDeadline ) ) )
+        {
+            xResult = prvFlush( pxCtx );
+        }
+
+        if( 0 <= xResult )
+        {
+            if( ( xMsgLength < sizeof( pxCtx->ucCoalesceBuffer ) ) &&
+                ( ( pxCtx->xPending + xMsgLength ) <= sizeof( pxCtx->ucCoalesceBuffer ) ) )
+            {
+                if( 0U == pxCtx->xPending )
+                {
+                    pxCtx->xPendingSince = xTaskGetTickCount();
+                }
+
+                memcpy( &pxCtx->ucCoalesceBuffer[ pxCtx->xPending ], pucMsg, xMsgLength );
+                pxCtx->xPending += xMsgLength;
+                xResult = ( BaseType_t ) xMsgLength;
+            }
+            else if( 0U == pxCtx->xPending )
+            {
+                /* Too long to be worth copying. */
+                xResult = prvWrite( pxCtx, pucMsg, xMsgLength );
+            }
+            else
+            {
+                /* A non-blocking socket did not take all of the buffered
+                 * data, so none of this write can be sent yet. */
+                xResult = 0;
+            }
+        }
+
+        return xResult;
+    }
+
+#endif /* if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 ) */
+
 /**
  * @brief Network send callback shim.
  *
@@ -535,6 +711,10 @@ BaseType_t TLS_Init( void ** ppvContext,
         pxCtx->xNetworkSend = pxParams->pxNetworkSend;
         pxCtx->pvCallerContext = pxParams->pvCallerContext;
 
+        #if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+            pxCtx->xCoalesceWrites = pxParams->xCoalesceWrites;
+        #endif
+
         /* Get the function pointer list for the PKCS#11 module. */
         xCkGetFunctionList = C_GetFunctionList;
         xResult = ( BaseType_t ) xCkGetFunctionList( &pxCtx->xP11FunctionList );
@@ -669,6 +849,17 @@ BaseType_t TLS_Connect( void * pvContext )
             pxCtx->ppcAlpnProtocols );
     }
 
+    #if ( tlsMAX_FRAG_LEN_CODE != MBEDTLS_SSL_MAX_FRAG_LEN_NONE )
+        if( 0 == xResult )
+        {
+            /* Ask the server for records no longer than the output buffer.
+             * Only built in when opted in with tlsconfigMAX_FRAGMENT_LENGTH,
+             * as some servers abort the handshake on the extension. */
+            xResult = mbedtls_ssl_conf_max_frag_len( &pxCtx->xMbedSslConfig,
+                                                     tlsMAX_FRAG_LEN_CODE );
+        }
+    #endif
+
     #ifdef MBEDTLS_DEBUG_C
 
         /* If mbedTLS is being compiled with debug support, assume that the
@@ -698,10 +889,16 @@ BaseType_t TLS_Connect( void * pvContext )
                              prvNetworkRecv,
                              NULL );
 
-        /* Negotiate. */
-        while( 0 != ( xResult = mbedtls_ssl_handshake( &pxCtx->xMbedSslCtx ) ) )
+        /* Negotiate. The handshake is stepped here rather than with
+         * mbedtls_ssl_handshake() so that each phase can be traced. */
+        while( MBEDTLS_SSL_HANDSHAKE_OVER != pxCtx->xMbedSslCtx.state )
         {
-            if( ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
+            TRACE_EVENT( eTraceTlsHandshakeState, pxCtx->xMbedSslCtx.state );
+
+            xResult = mbedtls_ssl_handshake_step( &pxCtx->xMbedSslCtx );
+
+            if( ( 0 != xResult ) &&
+                ( MBEDTLS_ERR_SSL_WANT_READ != xResult ) &&
                 ( MBEDTLS_ERR_SSL_WANT_WRITE != xResult ) )
             {
                 /* There was an unexpected error. Per mbedTLS API documentation,
@@ -712,6 +909,8 @@ BaseType_t TLS_Connect( void * pvContext )
                 break;
             }
         }
+
+        TRACE_EVENT( eTraceTlsHandshakeDone, xResult );
     }
 
     /* Keep track of successful completion of the handshake. */
@@ -739,6 +938,17 @@ BaseType_t TLS_Recv( void * pvContext,
 
     if( ( NULL != pxCtx ) && ( pdTRUE == pxCtx->xTLSHandshakeSuccessful ) )
     {
+        #if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+            /* The peer may be waiting for the coalesced writes before it
+             * sends anything. */
+            xResult = prvFlush( pxCtx );
+
+            if( 0 > xResult )
+            {
+                return xResult;
+            }
+        #endif
+
         while( xRead < xReadLength )
         {
             xResult = mbedtls_ssl_read( &pxCtx->xMbedSslCtx,
@@ -786,44 +996,58 @@ BaseType_t TLS_Send( void * pvContext,
 {
     BaseType_t xResult = 0;
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
-    size_t xWritten = 0;
+
+    TRACE_EVENT( eTraceTlsWriteBegin, xMsgLength );
 
     if( ( NULL != pxCtx ) && ( pdTRUE == pxCtx->xTLSHandshakeSuccessful ) )
     {
-        while( xWritten < xMsgLength )
-        {
-            xResult = mbedtls_ssl_write( &pxCtx->xMbedSslCtx,
-                                         pucMsg + xWritten,
-                                         xMsgLength - xWritten );
-
-            if( 0 < xResult )
+        #if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+            if( pdTRUE == pxCtx->xCoalesceWrites )
             {
-                /* Sent data, so update the tally and keep looping. */
-                xWritten += ( size_t ) xResult;
+                xResult = prvCoalesce( pxCtx, pucMsg, xMsgLength );
             }
-            else if( 0 == xResult )
-            {
-                /* No data sent (and no error). The secure sockets
-                 * API supports non-blocking send, so stop the loop but don't
-                 * flag an error. */
-                break;
-            }
-            else if( MBEDTLS_ERR_SSL_WANT_WRITE != xResult )
+            else
             {
-                /* Hard error: invalidate the context and stop. */
-                prvFreeContext( pxCtx );
-                break;
+                xResult = prvWrite( pxCtx, pucMsg, xMsgLength );
             }
-        }
+        #else
+            xResult = prvWrite( pxCtx, pucMsg, xMsgLength );
+        #endif
     }
     else
     {
         xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
     }
 
-    if( 0 <= xResult )
+    TRACE_EVENT( eTraceTlsWriteEnd, xResult );
+
+    return xResult;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TLS_Flush( void * pvContext )
+{
+    BaseType_t xResult = 0;
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( ( NULL != pxCtx ) && ( pdTRUE == pxCtx->xTLSHandshakeSuccessful ) )
     {
-        xResult = ( BaseType_t ) xWritten;
+        #if ( tlsconfigCOALESCE_BUFFER_SIZE > 0 )
+            const size_t xPending = pxCtx->xPending;
+
+            if( 0U < xPending )
+            {
+                TRACE_EVENT( eTraceTlsWriteBegin, xPending );
+                xResult = prvFlush( pxCtx );
+                TRACE_EVENT( eTraceTlsWriteEnd,
+                             ( 0 > xResult ) ? xResult : ( BaseType_t ) ( xPending - ( size_t ) xResult ) );
+            }
+        #endif
+    }
+    else
+    {
+        xResult = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
     }
 
     return xResult;
@@ -831,6 +1055,19 @@ BaseType_t TLS_Send( void * pvContext,
 
 /*-----------------------------------------------------------*/
 
+void TLS_SetCallerContext( void * pvContext,
+                           void * pvCallerContext )
+{
+    TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
+
+    if( NULL != pxCtx )
+    {
+        pxCtx->pvCallerContext = pvCallerContext;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 void TLS_Cleanup( void * pvContext )
 {
     TLSContext_t * pxCtx = ( TLSContext_t * ) pvContext; /*lint !e9087 !e9079 Allow casting void* to other types. */
@@ -0,0 +1,192 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace.c
+ * @brief Lock-free recording of binary trace events.
+ *
+ * Writers claim a slot with an atomic increment of the ring head and then
+ * fill it, so tasks and interrupts can record concurrently without masking
+ * interrupts. That matters because the kernel calls traceTASK_SWITCHED_IN()
+ * from the context switch, where the interrupt mask must not be touched.
+ *
+ * A slot's sequence number is cleared before the slot is written and set to
+ * its position in the ring afterwards. The reader checks it before and after
+ * copying the slot, like a sequence lock, to detect slots that are still
+ * being written or that were overwritten while it copied them. The reader
+ * runs on the core that owns the ring, so only compiler ordering is needed
+ * between the writes of a slot.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Trace includes. */
+#include "aws_trace.h"
+#include "aws_trace_drain.h"
+#include "aws_trace_config.h"
+#include "aws_trace_config_defaults.h"
+
+#if ( ( traceconfigEVENT_COUNT & ( traceconfigEVENT_COUNT - 1 ) ) != 0 )
+    #error "traceconfigEVENT_COUNT must be a power of two."
+#endif
+
+#define traceINDEX_MASK    ( ( uint32_t ) traceconfigEVENT_COUNT - 1UL )
+
+/* Stops the compiler from moving memory accesses across it. */
+#define traceCOMPILER_BARRIER()    __atomic_signal_fence( __ATOMIC_SEQ_CST )
+
+/**
+ * @brief The ring.
+ */
+static TraceEvent_t xTraceEvents[ traceconfigEVENT_COUNT ];
+
+/**
+ * @brief Number of slots ever claimed by writers.
+ */
+static uint32_t ulTraceHead = 0;
+
+/**
+ * @brief Number of slots consumed by the reader.
+ */
+static uint32_t ulTraceTail = 0;
+
+/*-----------------------------------------------------------*/
+
+void TRACE_RecordTask( uint8_t ucEvent,
+                       uint16_t usTask,
+                       uint32_t ulArgument )
+{
+    uint32_t ulIndex = __atomic_fetch_add( &ulTraceHead, 1UL, __ATOMIC_RELAXED );
+    TraceEvent_t * pxEvent = &xTraceEvents[ ulIndex & traceINDEX_MASK ];
+
+    pxEvent->ulSequence = 0;
+    traceCOMPILER_BARRIER();
+
+    pxEvent->ulTimestamp = traceconfigGET_TIMESTAMP();
+    pxEvent->ucEvent = ucEvent;
+    pxEvent->ucCpu = ( uint8_t ) traceconfigCPU_ID;
+    pxEvent->usTask = usTask;
+    pxEvent->ulArgument = ulArgument;
+
+    traceCOMPILER_BARRIER();
+    pxEvent->ulSequence = ulIndex + 1UL;
+}
+
+/*-----------------------------------------------------------*/
+
+void TRACE_Record( uint8_t ucEvent,
+                   uint32_t ulArgument )
+{
+    /* Returns 0 for a NULL handle, before the scheduler has started. */
+    uint16_t usTask = ( uint16_t ) uxTaskGetTaskNumber( xTaskGetCurrentTaskHandle() );
+
+    TRACE_RecordTask( ucEvent, usTask, ulArgument );
+}
+
+/*-----------------------------------------------------------*/
+
+void TRACE_RecordTaskName( uint16_t usTask,
+                           const char * pcName )
+{
+    uint32_t ulCharacters = 0;
+    size_t xLength = strlen( pcName );
+    size_t xOffset = 0;
+
+    /* Four characters per event, the last event is padded with zeros. */
+    do
+    {
+        ulCharacters = 0;
+        memcpy( &ulCharacters,
+                &pcName[ xOffset ],
+                ( xLength - xOffset < sizeof( ulCharacters ) ) ? xLength - xOffset : sizeof( ulCharacters ) );
+        TRACE_RecordTask( eTraceTaskName, usTask, ulCharacters );
+        xOffset += sizeof( ulCharacters );
+    } while( xOffset < xLength );
+}
+
+/*-----------------------------------------------------------*/
+
+size_t TRACE_Read( TraceEvent_t * pxEvents,
+                   size_t xMaxEvents,
+                   uint32_t * pulLost )
+{
+    size_t xCount = 0;
+    uint32_t ulHead = __atomic_load_n( &ulTraceHead, __ATOMIC_RELAXED );
+    uint32_t ulSequence = 0;
+    const TraceEvent_t * pxSlot = NULL;
+
+    *pulLost = 0;
+
+    /* Everything older than one ring behind the head is gone. */
+    if( ( ulHead - ulTraceTail ) > ( uint32_t ) traceconfigEVENT_COUNT )
+    {
+        *pulLost = ulHead - ulTraceTail - ( uint32_t ) traceconfigEVENT_COUNT;
+        ulTraceTail = ulHead - ( uint32_t ) traceconfigEVENT_COUNT;
+    }
+
+    while( ( xCount < xMaxEvents ) && ( ulTraceTail != ulHead ) )
+    {
+        pxSlot = &xTraceEvents[ ulTraceTail & traceINDEX_MASK ];
+        ulSequence = pxSlot->ulSequence;
+        traceCOMPILER_BARRIER();
+
+        if( ulSequence != ulTraceTail + 1UL )
+        {
+            if( ( int32_t ) ( ulSequence - ( ulTraceTail + 1UL ) ) > 0 )
+            {
+                /* Overwritten by a later event. */
+                ( *pulLost )++;
+                ulTraceTail++;
+                continue;
+            }
+
+            /* The writer that claimed this slot has not finished; it was
+             * interrupted or preempted. Leave the slot for the next read. */
+            break;
+        }
+
+        pxEvents[ xCount ] = *pxSlot;
+        traceCOMPILER_BARRIER();
+
+        if( pxSlot->ulSequence == ulSequence )
+        {
+            xCount++;
+        }
+        else
+        {
+            /* Overwritten while it was being copied. */
+            ( *pulLost )++;
+        }
+
+        ulTraceTail++;
+    }
+
+    return xCount;
+}
@@ -0,0 +1,278 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_trace_drain.c
+ * @brief Streams the trace ring to the host.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Trace includes. */
+#include "aws_trace.h"
+#include "aws_trace_drain.h"
+#include "aws_trace_config.h"
+#include "aws_trace_config_defaults.h"
+
+/* Secure sockets includes. */
+#include "aws_secure_sockets.h"
+
+/* The socket drain needs a collector, which has no sensible default. */
+#if defined( traceconfigDRAIN_HOST_ADDR0 ) && defined( traceconfigDRAIN_HOST_PORT )
+    #define traceDRAIN_HOST_CONFIGURED    1
+#elif ( configUSE_AWS_TRACE == 1 )
+    #error "Define the trace collector address in aws_trace_config.h."
+#else
+    #define traceDRAIN_HOST_CONFIGURED    0
+#endif
+
+/**
+ * @brief Events copied out of the ring. Only used by the single reader.
+ */
+static TraceEvent_t xDrainEvents[ traceconfigDRAIN_BATCH_EVENTS ];
+
+/**
+ * @brief Task status used to name the existing tasks. Only used by the
+ * single reader.
+ */
+static TaskStatus_t xDrainTasks[ traceconfigDRAIN_MAX_TASKS ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write a task name as eTraceTaskName events, like
+ * TRACE_RecordTaskName() but straight to the sink.
+ */
+static BaseType_t prvWriteTaskName( TraceWriteFunction_t xWrite,
+                                    void * pvContext,
+                                    uint16_t usTask,
+                                    const char * pcName );
+
+#if ( traceDRAIN_HOST_CONFIGURED == 1 )
+
+/**
+ * @brief TraceWriteFunction_t sending to a connected socket.
+ */
+    static BaseType_t prvSocketWrite( void * pvContext,
+                                      const void * pvData,
+                                      size_t xLength );
+
+/**
+ * @brief Connects to the collector and drains the ring into the connection.
+ */
+    static void prvSocketDrainTask( void * pvParameters );
+#endif
+
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvWriteTaskName( TraceWriteFunction_t xWrite,
+                                    void * pvContext,
+                                    uint16_t usTask,
+                                    const char * pcName )
+{
+    BaseType_t xStatus = pdPASS;
+    TraceEvent_t xEvent = { 0 };
+    size_t xOffset = 0;
+
+    xEvent.ulTimestamp = traceconfigGET_TIMESTAMP();
+    xEvent.ucEvent = ( uint8_t ) eTraceTaskName;
+    xEvent.ucCpu = ( uint8_t ) traceconfigCPU_ID;
+    xEvent.usTask = usTask;
+
+    do
+    {
+        xEvent.ulArgument = 0;
+        strncpy( ( char * ) &xEvent.ulArgument, &pcName[ xOffset ], sizeof( xEvent.ulArgument ) );
+        xStatus = xWrite( pvContext, &xEvent, sizeof( xEvent ) );
+        xOffset += sizeof( xEvent.ulArgument );
+    } while( ( xStatus == pdPASS ) && ( xOffset < strlen( pcName ) ) );
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TRACE_WriteStreamHeader( TraceWriteFunction_t xWrite,
+                                    void * pvContext )
+{
+    BaseType_t xStatus = pdPASS;
+    TraceStreamHeader_t xHeader = { 0 };
+    UBaseType_t uxTasks = 0;
+    UBaseType_t uxTask = 0;
+
+    xHeader.ulMagic = traceSTREAM_MAGIC;
+    xHeader.usVersion = traceSTREAM_VERSION;
+    xHeader.ucCpu = ( uint8_t ) traceconfigCPU_ID;
+    xHeader.ulTimestamp = traceconfigGET_TIMESTAMP();
+    xHeader.ulEventCount = traceconfigEVENT_COUNT;
+
+    xStatus = xWrite( pvContext, &xHeader, sizeof( xHeader ) );
+
+    /* The creation events of long lived tasks have usually been overwritten,
+     * so name every task again. Nothing is named if there are more tasks than
+     * traceconfigDRAIN_MAX_TASKS. */
+    if( xStatus == pdPASS )
+    {
+        uxTasks = uxTaskGetSystemState( xDrainTasks, traceconfigDRAIN_MAX_TASKS, NULL );
+    }
+
+    for( uxTask = 0; ( uxTask < uxTasks ) && ( xStatus == pdPASS ); uxTask++ )
+    {
+        xStatus = prvWriteTaskName( xWrite,
+                                    pvContext,
+                                    ( uint16_t ) xDrainTasks[ uxTask ].xTaskNumber,
+                                    xDrainTasks[ uxTask ].pcTaskName );
+    }
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TRACE_DrainOnce( TraceWriteFunction_t xWrite,
+                            void * pvContext )
+{
+    BaseType_t xStatus = pdPASS;
+    TraceEvent_t xLostEvent = { 0 };
+    uint32_t ulLost = 0;
+    size_t xCount = 0;
+
+    do
+    {
+        xCount = TRACE_Read( xDrainEvents, traceconfigDRAIN_BATCH_EVENTS, &ulLost );
+
+        if( ulLost > 0 )
+        {
+            xLostEvent.ulTimestamp = ( xCount > 0 ) ? xDrainEvents[ 0 ].ulTimestamp : traceconfigGET_TIMESTAMP();
+            xLostEvent.ucEvent = ( uint8_t ) eTraceEventsLost;
+            xLostEvent.ucCpu = ( uint8_t ) traceconfigCPU_ID;
+            xLostEvent.ulArgument = ulLost;
+            xStatus = xWrite( pvContext, &xLostEvent, sizeof( xLostEvent ) );
+        }
+
+        if( ( xStatus == pdPASS ) && ( xCount > 0 ) )
+        {
+            xStatus = xWrite( pvContext, xDrainEvents, xCount * sizeof( TraceEvent_t ) );
+        }
+    } while( ( xStatus == pdPASS ) && ( xCount == traceconfigDRAIN_BATCH_EVENTS ) );
+
+    return xStatus;
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( traceDRAIN_HOST_CONFIGURED == 1 )
+
+    static BaseType_t prvSocketWrite( void * pvContext,
+                                      const void * pvData,
+                                      size_t xLength )
+    {
+        BaseType_t xStatus = pdPASS;
+        Socket_t xSocket = ( Socket_t ) pvContext;
+        const uint8_t * pucData = ( const uint8_t * ) pvData;
+        int32_t lSent = 0;
+
+        while( ( xLength > 0 ) && ( xStatus == pdPASS ) )
+        {
+            lSent = SOCKETS_Send( xSocket, pucData, xLength, 0 );
+
+            if( lSent > 0 )
+            {
+                pucData += lSent;
+                xLength -= ( size_t ) lSent;
+            }
+            else
+            {
+                xStatus = pdFAIL;
+            }
+        }
+
+        return xStatus;
+    }
+
+/*-----------------------------------------------------------*/
+
+    static void prvSocketDrainTask( void * pvParameters )
+    {
+        BaseType_t xStatus = pdFAIL;
+        Socket_t xSocket = SOCKETS_INVALID_SOCKET;
+        SocketsSockaddr_t xCollector = { 0 };
+
+        ( void ) pvParameters;
+
+        xCollector.ucLength = sizeof( xCollector );
+        xCollector.ucSocketDomain = SOCKETS_AF_INET;
+        xCollector.usPort = SOCKETS_htons( traceconfigDRAIN_HOST_PORT );
+        xCollector.ulAddress = SOCKETS_inet_addr_quick( traceconfigDRAIN_HOST_ADDR0,
+                                                        traceconfigDRAIN_HOST_ADDR1,
+                                                        traceconfigDRAIN_HOST_ADDR2,
+                                                        traceconfigDRAIN_HOST_ADDR3 );
+
+        for( ; ; )
+        {
+            xSocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+
+            if( xSocket != SOCKETS_INVALID_SOCKET )
+            {
+                if( SOCKETS_Connect( xSocket, &xCollector, sizeof( xCollector ) ) == SOCKETS_ERROR_NONE )
+                {
+                    xStatus = TRACE_WriteStreamHeader( prvSocketWrite, xSocket );
+
+                    while( xStatus == pdPASS )
+                    {
+                        xStatus = TRACE_DrainOnce( prvSocketWrite, xSocket );
+                        vTaskDelay( pdMS_TO_TICKS( traceconfigDRAIN_PERIOD_MS ) );
+                    }
+                }
+
+                ( void ) SOCKETS_Shutdown( xSocket, SOCKETS_SHUT_RDWR );
+                ( void ) SOCKETS_Close( xSocket );
+            }
+
+            vTaskDelay( pdMS_TO_TICKS( traceconfigDRAIN_RETRY_MS ) );
+        }
+    }
+#endif /* traceDRAIN_HOST_CONFIGURED */
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TRACE_StartSocketDrain( void )
+{
+    #if ( traceDRAIN_HOST_CONFIGURED == 1 )
+        return xTaskCreate( prvSocketDrainTask,
+                            "TraceDrain",
+                            traceconfigDRAIN_TASK_STACK_SIZE,
+                            NULL,
+                            traceconfigDRAIN_TASK_PRIORITY,
+                            NULL );
+    #else
+        return pdFAIL;
+    #endif
+}
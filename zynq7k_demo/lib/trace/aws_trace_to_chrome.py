@@ -0,0 +1,300 @@
+#!/usr/bin/env python
+#
+# Amazon FreeRTOS Trace Library V1.0.0
+# Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy of
+# this software and associated documentation files (the "Software"), to deal in
+# the Software without restriction, including without limitation the rights to
+# use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+# the Software, and to permit persons to whom the Software is furnished to do so,
+# subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+# FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+# COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+# IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+# http://aws.amazon.com/freertos
+# http://www.FreeRTOS.org
+#
+
+"""Convert aws_trace binary streams to Chrome trace event JSON.
+
+The output loads in chrome://tracing and in the Perfetto UI. Each CPU is a
+process and each task a thread. MQTT commands are shown as async slices split
+into their queue wait, send, acknowledgement wait and wakeup stages, and a
+summary of the publish stage latencies is printed.
+
+Usage:
+    aws_trace_to_chrome.py --listen 9010 --save capture.bin
+    aws_trace_to_chrome.py capture.bin [more.bin ...] -o trace.json
+"""
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+STREAM_MAGIC = 0x43525441
+STREAM_VERSION = 1
+
+HEADER_FORMAT = "<IHBBII"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+EVENT_FORMAT = "<IBBHII"
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+
+# Must match TraceEventId_t in aws_trace.h.
+EVENT_NAMES = [
+    "EventsLost",
+    "TaskName",
+    "TaskSwitchedIn",
+    "QueueSend",
+    "QueueSendFromISR",
+    "QueueReceive",
+    "QueueReceiveFromISR",
+    "QueueBlockOnSend",
+    "QueueBlockOnReceive",
+    "NetworkTransmit",
+    "NetworkReceive",
+    "NetworkEvent",
+    "MqttCommandQueued",
+    "MqttCommandDequeued",
+    "MqttPacketSent",
+    "MqttCommandNotified",
+    "MqttCommandComplete",
+    "TlsHandshakeState",
+    "TlsHandshakeDone",
+    "TlsWriteBegin",
+    "TlsWriteEnd",
+    "OtaBlockReceived",
+    "OtaBlockWritten",
+    "OtaFileClosed",
+]
+EVENT_ID = dict((name, index) for index, name in enumerate(EVENT_NAMES))
+
+# Must match MQTTAction_t in aws_mqtt_agent.c.
+MQTT_ACTIONS = ["ServiceSocket", "Connect", "Disconnect", "Subscribe", "Unsubscribe", "Publish"]
+
+# Stage names in the order the MQTT events are emitted.
+MQTT_STAGES = [
+    ("MqttCommandQueued", "MqttCommandDequeued", "queue wait"),
+    ("MqttCommandDequeued", "MqttPacketSent", "send"),
+    ("MqttPacketSent", "MqttCommandNotified", "ack wait"),
+    ("MqttCommandNotified", "MqttCommandComplete", "wakeup"),
+]
+
+
+def read_stream(data):
+    """Split a capture into (header, [events]) pairs, one per connection."""
+    streams = []
+    offset = 0
+    while offset + HEADER_SIZE <= len(data):
+        magic, version, cpu, _, timestamp, count = struct.unpack_from(HEADER_FORMAT, data, offset)
+        if magic != STREAM_MAGIC or version != STREAM_VERSION:
+            raise ValueError("no stream header at offset %d" % offset)
+        offset += HEADER_SIZE
+        events = []
+        while offset + EVENT_SIZE <= len(data):
+            if struct.unpack_from("<IH", data, offset) == (STREAM_MAGIC, STREAM_VERSION):
+                # The device reconnected and started a new stream.
+                break
+            events.append(struct.unpack_from(EVENT_FORMAT, data, offset))
+            offset += EVENT_SIZE
+        streams.append(((cpu, timestamp, count), events))
+    return streams
+
+
+class Unwrapper(object):
+    """Extend the 32-bit microsecond timestamps of one CPU to 64 bits."""
+
+    def __init__(self):
+        self.high = 0
+        self.last = None
+
+    def __call__(self, timestamp):
+        if self.last is not None and timestamp < self.last and self.last - timestamp > 0x80000000:
+            self.high += 1 << 32
+        self.last = timestamp
+        return self.high + timestamp
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    index = int(round(fraction * (len(ordered) - 1)))
+    return ordered[index]
+
+
+def convert(streams):
+    trace = []
+    latencies = dict((stage[2], []) for stage in MQTT_STAGES)
+    latencies["total"] = []
+    task_names = {}
+    unwrappers = {}
+    running = {}
+    handshake = {}
+    commands = {}
+    last_name = None
+    base = None
+
+    for (cpu, _, _), events in streams:
+        unwrap = unwrappers.setdefault(cpu, Unwrapper())
+        for timestamp, event, event_cpu, task, argument, _ in events:
+            ts = unwrap(timestamp)
+            if base is None:
+                base = ts
+            ts -= base
+            name = EVENT_NAMES[event] if event < len(EVENT_NAMES) else "Event%d" % event
+
+            if name == "TaskName":
+                key = (event_cpu, task)
+                chunk = struct.pack("<I", argument).split(b"\0")[0].decode("ascii", "replace")
+                if last_name == key:
+                    task_names[key] += chunk
+                else:
+                    task_names[key] = chunk
+                last_name = key
+                continue
+            last_name = None
+
+            if name == "TaskSwitchedIn":
+                previous = running.get(event_cpu)
+                if previous is not None and previous[0] != task:
+                    trace.append({"ph": "X", "name": "run", "pid": event_cpu, "tid": previous[0],
+                                  "ts": previous[1], "dur": ts - previous[1]})
+                if previous is None or previous[0] != task:
+                    running[event_cpu] = (task, ts)
+            elif name == "TlsHandshakeState":
+                previous = handshake.get((event_cpu, task))
+                if previous is not None:
+                    trace.append({"ph": "X", "name": "tls state %d" % previous[0], "cat": "tls",
+                                  "pid": event_cpu, "tid": task, "ts": previous[1], "dur": ts - previous[1]})
+                handshake[(event_cpu, task)] = (argument, ts)
+            elif name == "TlsHandshakeDone":
+                previous = handshake.pop((event_cpu, task), None)
+                if previous is not None:
+                    trace.append({"ph": "X", "name": "tls state %d" % previous[0], "cat": "tls",
+                                  "pid": event_cpu, "tid": task, "ts": previous[1], "dur": ts - previous[1]})
+            elif name.startswith("Mqtt"):
+                action = argument & 0xFFFF
+                identifier = argument & 0xFFFF0000
+                if name in ("MqttCommandQueued", "MqttCommandDequeued"):
+                    if action == 0:
+                        continue
+                    action_name = MQTT_ACTIONS[action] if action < len(MQTT_ACTIONS) else str(action)
+                    if name == "MqttCommandQueued":
+                        commands[identifier] = {"action": action_name}
+                command = commands.get(identifier)
+                if command is None:
+                    continue
+                command[name] = (ts, event_cpu, task)
+                if name == "MqttCommandComplete" or \
+                        (name == "MqttCommandNotified" and command["action"] != "Publish"):
+                    emit_command(trace, latencies, identifier, command)
+                    del commands[identifier]
+            else:
+                trace.append({"ph": "i", "s": "t", "name": name, "pid": event_cpu, "tid": task,
+                              "ts": ts, "args": {"argument": "0x%08x" % argument}})
+
+    for key, name in task_names.items():
+        trace.append({"ph": "M", "name": "thread_name", "pid": key[0], "tid": key[1],
+                      "args": {"name": "%s (%d)" % (name, key[1])}})
+    for cpu in unwrappers:
+        trace.append({"ph": "M", "name": "process_name", "pid": cpu, "args": {"name": "CPU %d" % cpu}})
+
+    return trace, latencies
+
+
+def emit_command(trace, latencies, identifier, command):
+    """Emit the async slices of one MQTT command."""
+    first = command.get("MqttCommandQueued")
+    last = command.get("MqttCommandComplete") or command.get("MqttCommandNotified")
+    if first is None or last is None:
+        return
+    async_id = "0x%04x" % (identifier >> 16)
+    title = "MQTT %s %s" % (command["action"], async_id)
+    trace.append({"ph": "b", "cat": "mqtt", "name": title, "id": async_id, "pid": first[1], "ts": first[0]})
+    for begin, end, stage in MQTT_STAGES:
+        if begin in command and end in command:
+            start = command[begin][0]
+            finish = command[end][0]
+            trace.append({"ph": "b", "cat": "mqtt", "name": stage, "id": async_id, "pid": first[1], "ts": start})
+            trace.append({"ph": "e", "cat": "mqtt", "name": stage, "id": async_id, "pid": first[1], "ts": finish})
+            if command["action"] == "Publish":
+                latencies[stage].append(finish - start)
+    trace.append({"ph": "e", "cat": "mqtt", "name": title, "id": async_id, "pid": first[1], "ts": last[0]})
+    if command["action"] == "Publish":
+        latencies["total"].append(last[0] - first[0])
+
+
+def print_summary(latencies, out):
+    out.write("%-12s %8s %10s %10s %10s\n" % ("stage", "count", "mean us", "p50 us", "p99 us"))
+    for stage in [stage[2] for stage in MQTT_STAGES] + ["total"]:
+        values = latencies[stage]
+        if values:
+            out.write("%-12s %8d %10.1f %10d %10d\n" % (stage, len(values), float(sum(values)) / len(values),
+                                                        percentile(values, 0.5), percentile(values, 0.99)))
+        else:
+            out.write("%-12s %8d %10s %10s %10s\n" % (stage, 0, "-", "-", "-"))
+
+
+def listen(port, path):
+    """Accept one connection from the drain task and save it until it closes."""
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("", port))
+    server.listen(1)
+    print("Waiting for the trace drain on port %d" % port)
+    connection, address = server.accept()
+    print("Connected to %s, press Ctrl+C to stop" % address[0])
+    received = 0
+    with open(path, "wb") as capture:
+        try:
+            while True:
+                data = connection.recv(65536)
+                if not data:
+                    break
+                capture.write(data)
+                received += len(data)
+        except KeyboardInterrupt:
+            pass
+    connection.close()
+    server.close()
+    print("Saved %d bytes to %s" % (received, path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert aws_trace streams to Chrome trace JSON.")
+    parser.add_argument("captures", nargs="*", help="binary captures, one per CPU")
+    parser.add_argument("--listen", type=int, metavar="PORT", help="receive a capture from the drain task first")
+    parser.add_argument("--save", default="trace.bin", help="file the received capture is saved to")
+    parser.add_argument("-o", "--output", default="trace.json", help="Chrome trace JSON file")
+    args = parser.parse_args()
+
+    captures = list(args.captures)
+    if args.listen is not None:
+        listen(args.listen, args.save)
+        captures.append(args.save)
+    if not captures:
+        parser.error("no capture given")
+
+    streams = []
+    for path in captures:
+        with open(path, "rb") as capture:
+            streams.extend(read_stream(capture.read()))
+
+    trace, latencies = convert(streams)
+    with open(args.output, "w") as output:
+        json.dump({"traceEvents": trace, "displayTimeUnit": "ns"}, output)
+    print("Wrote %d trace events to %s" % (len(trace), args.output))
+    print_summary(latencies, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
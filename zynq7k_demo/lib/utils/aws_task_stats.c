@@ -0,0 +1,138 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_task_stats.c
+ * @brief Run time used by each task, shared by Device Defender and telemetry.
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Task stats includes. */
+#include "aws_task_stats.h"
+#include "aws_static_memory.h"
+
+#if ( configUSE_TRACE_FACILITY != 1 ) || ( configGENERATE_RUN_TIME_STATS != 1 )
+    #error configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS must be 1 to measure CPU load
+#endif
+
+/* Matches the default name given to the idle task in tasks.c. */
+#ifndef configIDLE_TASK_NAME
+    #define configIDLE_TASK_NAME    "IDLE"
+#endif
+
+/**
+ * @brief Kernel task states of the current sample, and the run time counters
+ * of the previous one. Only used with the scheduler suspended.
+ */
+static TaskStatus_t xTaskStatus[ taskstatsMAX_TASKS ] staticmemSECTION( taskstats );
+static uint32_t ulPrevRunTime[ taskstatsMAX_TASKS ] staticmemSECTION( taskstats );
+static UBaseType_t uxPrevTaskNumber[ taskstatsMAX_TASKS ] staticmemSECTION( taskstats );
+static UBaseType_t uxPrevTaskCount;
+static uint32_t ulPrevTotalRunTime;
+static BaseType_t xHasPrevSample;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t TASKSTATS_Sample( TaskStatsTask_t * pxTasks,
+                             size_t xMaxTasks,
+                             TaskStatsInterval_t * pxInterval )
+{
+    BaseType_t xResult = pdFAIL;
+    uint32_t ulTotalRunTime = 0;
+    uint32_t ulIdleRunTime = 0;
+    uint32_t ulIdleTaskNumber = 0;
+    UBaseType_t uxCount = 0;
+    UBaseType_t uxI = 0;
+    UBaseType_t uxJ = 0;
+
+    configASSERT( pxTasks != NULL );
+    configASSERT( pxInterval != NULL );
+
+    /* Samples taken by different tasks share the previous counters. */
+    vTaskSuspendAll();
+    {
+        uxCount = uxTaskGetSystemState( xTaskStatus, taskstatsMAX_TASKS, &ulTotalRunTime );
+
+        /* Nothing is returned when the array is too small, there is always at
+         * least the idle task. */
+        if( ( uxCount > 0 ) && ( ( size_t ) uxCount <= xMaxTasks ) )
+        {
+            for( uxI = 0; uxI < uxCount; uxI++ )
+            {
+                const TaskStatus_t * pxStatus = &xTaskStatus[ uxI ];
+                TaskStatsTask_t * pxTask = &pxTasks[ uxI ];
+                uint32_t ulPrev = 0;
+
+                for( uxJ = 0; uxJ < uxPrevTaskCount; uxJ++ )
+                {
+                    if( uxPrevTaskNumber[ uxJ ] == pxStatus->xTaskNumber )
+                    {
+                        ulPrev = ulPrevRunTime[ uxJ ];
+                        break;
+                    }
+                }
+
+                ( void ) strncpy( pxTask->cTaskName, pxStatus->pcTaskName, taskstatsTASK_NAME_LENGTH - 1 );
+                pxTask->cTaskName[ taskstatsTASK_NAME_LENGTH - 1 ] = '\0';
+                pxTask->ulTaskNumber = ( uint32_t ) pxStatus->xTaskNumber;
+                pxTask->ulRunTime = ( xHasPrevSample == pdTRUE ) ? ( pxStatus->ulRunTimeCounter - ulPrev ) : 0UL;
+                pxTask->ulStackHeadroom = ( uint32_t ) pxStatus->usStackHighWaterMark;
+
+                /* The idle task only runs when no other task is ready. */
+                if( strcmp( pxStatus->pcTaskName, configIDLE_TASK_NAME ) == 0 )
+                {
+                    ulIdleRunTime += pxTask->ulRunTime;
+                    ulIdleTaskNumber = pxTask->ulTaskNumber;
+                }
+            }
+
+            pxInterval->ulRunTime = ( xHasPrevSample == pdTRUE ) ? ( ulTotalRunTime - ulPrevTotalRunTime ) : 0UL;
+            pxInterval->ulBusyRunTime = ( ulIdleRunTime < pxInterval->ulRunTime ) ? ( pxInterval->ulRunTime - ulIdleRunTime ) : 0UL;
+            pxInterval->ulIdleTaskNumber = ulIdleTaskNumber;
+            pxInterval->xTaskCount = ( size_t ) uxCount;
+
+            /* Keep the raw counters for the next delta. */
+            for( uxI = 0; uxI < uxCount; uxI++ )
+            {
+                uxPrevTaskNumber[ uxI ] = xTaskStatus[ uxI ].xTaskNumber;
+                ulPrevRunTime[ uxI ] = xTaskStatus[ uxI ].ulRunTimeCounter;
+            }
+
+            uxPrevTaskCount = uxCount;
+            ulPrevTotalRunTime = ulTotalRunTime;
+            xHasPrevSample = pdTRUE;
+            xResult = pdPASS;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return xResult;
+}
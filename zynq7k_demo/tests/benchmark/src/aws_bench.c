@@ -0,0 +1,386 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Host benchmark harness
+ */
+
+#include "aws_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "jsmn.h"
+
+/** Maximum number of JSON tokens in a baseline file. */
+#define benchMAX_BASELINE_TOKENS    ( 8 * benchMAX_RESULTS + 16 )
+
+/** Number of key/value pairs in one benchmark object of a baseline file. */
+#define benchBASELINE_FIELDS        ( 4 )
+
+volatile uintptr_t uxBenchSink = 0;
+
+static const char * pcBenchFilter = NULL;
+static double xBenchClockMHz = 0.0;
+static BenchResult_t xBenchResults[ benchMAX_RESULTS ];
+static size_t xBenchResultCount = 0;
+static uint64_t ullBenchAllocations = 0;
+static uint64_t ullBenchAllocatedBytes = 0;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNanoseconds( void )
+{
+    struct timespec xNow;
+
+    clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+    return ( uint64_t ) xNow.tv_sec * 1000000000ULL + ( uint64_t ) xNow.tv_nsec;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvTimeRun( BenchFunction_t xFunction,
+                            uint32_t ulIterations )
+{
+    uint64_t ullStart = prvNanoseconds();
+
+    xFunction( ulIterations );
+
+    return prvNanoseconds() - ullStart;
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_SetFilter( const char * pcFilter )
+{
+    pcBenchFilter = pcFilter;
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_SetClockMHz( double xMHz )
+{
+    xBenchClockMHz = xMHz;
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_CountAllocation( size_t xSize )
+{
+    ullBenchAllocations++;
+    ullBenchAllocatedBytes += xSize;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPrintResult( const BenchResult_t * pxResult )
+{
+    printf( "%-40s %12.1f ns/op %10.0f B/op %8.0f allocs/op",
+            pxResult->pcName,
+            pxResult->xNanosecondsPerOp,
+            pxResult->xBytesPerOp,
+            pxResult->xAllocationsPerOp );
+
+    if( pxResult->xPayloadBytes > 0.0 )
+    {
+        printf( " %9.1f MB/s", 1000.0 * pxResult->xPayloadBytes / pxResult->xNanosecondsPerOp );
+
+        if( xBenchClockMHz > 0.0 )
+        {
+            printf( " %8.2f cycles/B", pxResult->xNanosecondsPerOp * xBenchClockMHz / ( 1000.0 * pxResult->xPayloadBytes ) );
+        }
+    }
+    else if( xBenchClockMHz > 0.0 )
+    {
+        printf( " %12.0f cycles/op", pxResult->xNanosecondsPerOp * xBenchClockMHz / 1000.0 );
+    }
+
+    printf( "\n" );
+    fflush( stdout );
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Run( const char * pcName,
+                BenchFunction_t xFunction )
+{
+    BENCH_RunThroughput( pcName, xFunction, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_RunThroughput( const char * pcName,
+                          BenchFunction_t xFunction,
+                          size_t xPayloadBytes )
+{
+    BenchResult_t * pxResult = NULL;
+    uint64_t ullTime = 0;
+    uint64_t ullFastest = UINT64_MAX;
+    uint32_t ulIterations = 1;
+    int iRun = 0;
+
+    if( ( ( pcBenchFilter == NULL ) || ( strstr( pcName, pcBenchFilter ) != NULL ) ) &&
+        ( xBenchResultCount < benchMAX_RESULTS ) )
+    {
+        pxResult = &xBenchResults[ xBenchResultCount++ ];
+        pxResult->pcName = pcName;
+        pxResult->xPayloadBytes = ( double ) xPayloadBytes;
+
+        /* A single operation, also warming up caches and lazily initialized
+         * state, gives the heap use. */
+        ullBenchAllocations = 0;
+        ullBenchAllocatedBytes = 0;
+        xFunction( 1 );
+        pxResult->xAllocationsPerOp = ( double ) ullBenchAllocations;
+        pxResult->xBytesPerOp = ( double ) ullBenchAllocatedBytes;
+
+        /* Grow the iteration count until one run is long enough to time. */
+        while( ( prvTimeRun( xFunction, ulIterations ) < benchMIN_RUN_NS ) &&
+               ( ulIterations < 0x80000000UL ) )
+        {
+            ulIterations *= 2;
+        }
+
+        for( iRun = 0; iRun < benchRUNS; iRun++ )
+        {
+            ullTime = prvTimeRun( xFunction, ulIterations );
+            ullFastest = ( ullTime < ullFastest ) ? ullTime : ullFastest;
+        }
+
+        pxResult->xNanosecondsPerOp = ( double ) ullFastest / ulIterations;
+
+        prvPrintResult( pxResult );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+int BENCH_WriteJSON( const char * pcPath )
+{
+    FILE * pxFile = fopen( pcPath, "w" );
+    size_t x = 0;
+
+    if( pxFile == NULL )
+    {
+        return -1;
+    }
+
+    fprintf( pxFile, "{\n  \"compiler\": \"%s\",\n  \"benchmarks\": [\n", __VERSION__ );
+
+    for( x = 0; x < xBenchResultCount; x++ )
+    {
+        fprintf( pxFile,
+                 "    { \"name\": \"%s\", \"ns_per_op\": %.1f, \"bytes_per_op\": %.0f, \"allocs_per_op\": %.0f }%s\n",
+                 xBenchResults[ x ].pcName,
+                 xBenchResults[ x ].xNanosecondsPerOp,
+                 xBenchResults[ x ].xBytesPerOp,
+                 xBenchResults[ x ].xAllocationsPerOp,
+                 ( x + 1 < xBenchResultCount ) ? "," : "" );
+    }
+
+    fprintf( pxFile, "  ]\n}\n" );
+
+    return ( fclose( pxFile ) == 0 ) ? 0 : -1;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvTokenEquals( const char * pcJSON,
+                           const jsmntok_t * pxToken,
+                           const char * pcString )
+{
+    size_t xLength = ( size_t ) ( pxToken->end - pxToken->start );
+
+    return ( pxToken->type == JSMN_STRING ) &&
+           ( strlen( pcString ) == xLength ) &&
+           ( strncmp( &pcJSON[ pxToken->start ], pcString, xLength ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static char * prvReadFile( const char * pcPath,
+                           size_t * pxLength )
+{
+    FILE * pxFile = fopen( pcPath, "rb" );
+    char * pcContents = NULL;
+    long lLength = 0;
+
+    if( pxFile != NULL )
+    {
+        if( ( fseek( pxFile, 0, SEEK_END ) == 0 ) && ( ( lLength = ftell( pxFile ) ) > 0 ) )
+        {
+            rewind( pxFile );
+            pcContents = malloc( ( size_t ) lLength + 1 );
+
+            if( ( pcContents != NULL ) && ( fread( pcContents, 1, ( size_t ) lLength, pxFile ) == ( size_t ) lLength ) )
+            {
+                pcContents[ lLength ] = '\0';
+                *pxLength = ( size_t ) lLength;
+            }
+            else
+            {
+                free( pcContents );
+                pcContents = NULL;
+            }
+        }
+
+        fclose( pxFile );
+    }
+
+    return pcContents;
+}
+
+/*-----------------------------------------------------------*/
+
+static int prvCompareOne( const BenchResult_t * pxBaseline,
+                          double xThresholdPercent )
+{
+    const BenchResult_t * pxResult = NULL;
+    double xChange = 0.0;
+    int iRegression = 0;
+    size_t x = 0;
+
+    for( x = 0; ( x < xBenchResultCount ) && ( pxResult == NULL ); x++ )
+    {
+        if( strcmp( xBenchResults[ x ].pcName, pxBaseline->pcName ) == 0 )
+        {
+            pxResult = &xBenchResults[ x ];
+        }
+    }
+
+    if( pxResult != NULL )
+    {
+        xChange = ( pxBaseline->xNanosecondsPerOp > 0.0 ) ?
+                  100.0 * ( pxResult->xNanosecondsPerOp - pxBaseline->xNanosecondsPerOp ) / pxBaseline->xNanosecondsPerOp : 0.0;
+
+        iRegression = ( xChange > xThresholdPercent ) ||
+                      ( pxResult->xBytesPerOp > pxBaseline->xBytesPerOp ) ||
+                      ( pxResult->xAllocationsPerOp > pxBaseline->xAllocationsPerOp );
+
+        printf( "%-40s %12.1f -> %12.1f ns/op %+7.1f%%  %6.0f -> %6.0f B/op  %3.0f -> %3.0f allocs/op%s\n",
+                pxResult->pcName,
+                pxBaseline->xNanosecondsPerOp,
+                pxResult->xNanosecondsPerOp,
+                xChange,
+                pxBaseline->xBytesPerOp,
+                pxResult->xBytesPerOp,
+                pxBaseline->xAllocationsPerOp,
+                pxResult->xAllocationsPerOp,
+                iRegression ? "  REGRESSION" : "" );
+    }
+
+    return iRegression;
+}
+
+/*-----------------------------------------------------------*/
+
+int BENCH_Compare( const char * pcPath,
+                   double xThresholdPercent )
+{
+    static jsmntok_t xTokens[ benchMAX_BASELINE_TOKENS ];
+    static char cNames[ benchMAX_RESULTS ][ 64 ];
+    jsmn_parser xParser;
+    BenchResult_t xBaseline;
+    const jsmntok_t * pxKey = NULL;
+    const jsmntok_t * pxValue = NULL;
+    size_t xLength = 0;
+    size_t xBaselines = 0;
+    int iTokens = 0;
+    int iToken = 0;
+    int iField = 0;
+    int iRegressions = 0;
+    char * pcJSON = prvReadFile( pcPath, &xLength );
+
+    if( pcJSON == NULL )
+    {
+        return -1;
+    }
+
+    jsmn_init( &xParser );
+    iTokens = jsmn_parse( &xParser, pcJSON, xLength, xTokens, benchMAX_BASELINE_TOKENS );
+
+    printf( "\nComparison with %s, threshold %.1f%%:\n", pcPath, xThresholdPercent );
+
+    /* Every benchmark is an object of four scalar fields. */
+    for( iToken = 0; iToken < iTokens; iToken++ )
+    {
+        if( ( xTokens[ iToken ].type != JSMN_OBJECT ) ||
+            ( xTokens[ iToken ].size != benchBASELINE_FIELDS ) ||
+            ( iToken + 2 * benchBASELINE_FIELDS >= iTokens ) )
+        {
+            continue;
+        }
+
+        memset( &xBaseline, 0, sizeof( xBaseline ) );
+
+        for( iField = 0; iField < benchBASELINE_FIELDS; iField++ )
+        {
+            pxKey = &xTokens[ iToken + 1 + 2 * iField ];
+            pxValue = pxKey + 1;
+
+            if( prvTokenEquals( pcJSON, pxKey, "name" ) && ( xBaselines < benchMAX_RESULTS ) )
+            {
+                snprintf( cNames[ xBaselines ], sizeof( cNames[ 0 ] ), "%.*s",
+                          pxValue->end - pxValue->start, &pcJSON[ pxValue->start ] );
+                xBaseline.pcName = cNames[ xBaselines ];
+            }
+            else if( prvTokenEquals( pcJSON, pxKey, "ns_per_op" ) )
+            {
+                xBaseline.xNanosecondsPerOp = strtod( &pcJSON[ pxValue->start ], NULL );
+            }
+            else if( prvTokenEquals( pcJSON, pxKey, "bytes_per_op" ) )
+            {
+                xBaseline.xBytesPerOp = strtod( &pcJSON[ pxValue->start ], NULL );
+            }
+            else if( prvTokenEquals( pcJSON, pxKey, "allocs_per_op" ) )
+            {
+                xBaseline.xAllocationsPerOp = strtod( &pcJSON[ pxValue->start ], NULL );
+            }
+        }
+
+        if( xBaseline.pcName != NULL )
+        {
+            xBaselines++;
+            iRegressions += prvCompareOne( &xBaseline, xThresholdPercent );
+        }
+
+        iToken += 2 * benchBASELINE_FIELDS;
+    }
+
+    free( pcJSON );
+
+    if( iTokens < 0 )
+    {
+        return -1;
+    }
+
+    printf( "%d regression(s)\n", iRegressions );
+
+    return iRegressions;
+}
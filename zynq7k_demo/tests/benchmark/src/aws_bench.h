@@ -0,0 +1,162 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+#ifndef AWS_BENCH_H /* Guards against multiple inclusion */
+#define AWS_BENCH_H
+
+/**
+ * @file
+ * @brief Host benchmark harness.
+ *
+ * A benchmark is a function that performs its operation ulIterations times.
+ * BENCH_Run() picks an iteration count that makes one run last at least
+ * benchMIN_RUN_NS, repeats the run benchRUNS times and keeps the fastest.
+ * Interference from the rest of the host only ever adds time, so the fastest
+ * run is the most repeatable estimate. Heap use is counted through
+ * pvPortMalloc(), which the host port implements.
+ *
+ * Inputs are fixed at compile time or generated from a fixed seed, so every
+ * run of a benchmark does exactly the same work.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Minimum duration of one timed run, in nanoseconds.
+ */
+#define benchMIN_RUN_NS                    ( 10000000ULL )
+
+/**
+ * @brief Number of timed runs, the fastest of which is reported.
+ */
+#define benchRUNS                          ( 11 )
+
+/**
+ * @brief Maximum number of benchmarks in one invocation.
+ */
+#define benchMAX_RESULTS                   ( 64 )
+
+/**
+ * @brief Slowdown, in percent, above which a benchmark is reported as a
+ * regression by BENCH_Compare() unless overridden on the command line.
+ */
+#define benchDEFAULT_THRESHOLD_PERCENT     ( 10.0 )
+
+/**
+ * @brief Performs the operation under test ulIterations times.
+ */
+typedef void ( * BenchFunction_t )( uint32_t ulIterations );
+
+/**
+ * @brief Result of one benchmark.
+ */
+typedef struct BenchResult
+{
+    const char * pcName;       /**< Benchmark name, "<library>/<operation>". */
+    double xNanosecondsPerOp;  /**< Time of one operation in the fastest run. */
+    double xBytesPerOp;        /**< Heap bytes allocated by one operation. */
+    double xAllocationsPerOp;  /**< Heap allocations made by one operation. */
+    double xPayloadBytes;      /**< Bytes processed by one operation, 0 if not a throughput benchmark. */
+} BenchResult_t;
+
+/**
+ * @brief Keeps the compiler from discarding the result of an operation.
+ */
+extern volatile uintptr_t uxBenchSink;
+#define BENCH_CONSUME( x )    ( uxBenchSink += ( uintptr_t ) ( x ) )
+
+/**
+ * @brief Only benchmarks whose name contains this string are run. NULL runs
+ * them all.
+ */
+void BENCH_SetFilter( const char * pcFilter );
+
+/**
+ * @brief Time a benchmark and record its result.
+ *
+ * @param[in] pcName Benchmark name, "<library>/<operation>".
+ * @param[in] xFunction The benchmark.
+ */
+void BENCH_Run( const char * pcName,
+                BenchFunction_t xFunction );
+
+/**
+ * @brief Time a benchmark that processes xPayloadBytes bytes per operation,
+ * and also report its throughput.
+ *
+ * @param[in] pcName Benchmark name, "<library>/<operation>".
+ * @param[in] xFunction The benchmark.
+ * @param[in] xPayloadBytes Bytes processed by one operation.
+ */
+void BENCH_RunThroughput( const char * pcName,
+                          BenchFunction_t xFunction,
+                          size_t xPayloadBytes );
+
+/**
+ * @brief Clock frequency of the CPU running the benchmarks. When set, times
+ * are also reported in cycles, per byte for throughput benchmarks and per
+ * operation for the others. 0, the default, reports time only.
+ */
+void BENCH_SetClockMHz( double xMHz );
+
+/**
+ * @brief Record a heap allocation. Called by the host port.
+ */
+void BENCH_CountAllocation( size_t xSize );
+
+/**
+ * @brief Write the recorded results as a JSON baseline.
+ *
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+int BENCH_WriteJSON( const char * pcPath );
+
+/**
+ * @brief Compare the recorded results with a JSON baseline and print the
+ * differences.
+ *
+ * A benchmark regresses if it is more than xThresholdPercent slower than the
+ * baseline, or if it allocates more often or more bytes. Heap use is
+ * deterministic, so any increase counts.
+ *
+ * @return The number of regressions, or -1 if the baseline cannot be read.
+ */
+int BENCH_Compare( const char * pcPath,
+                   double xThresholdPercent );
+
+/*
+ * Benchmark suites, one per library.
+ */
+void BENCH_Mqtt( void );
+void BENCH_Shadow( void );
+void BENCH_OtaCbor( void );
+void BENCH_Cbor( void );
+void BENCH_BufferPool( void );
+void BENCH_StreamBuffer( void );
+void BENCH_Checksum( void );
+void BENCH_Crypto( void );
+
+#endif /* ifndef AWS_BENCH_H */
@@ -0,0 +1,70 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmark of the static buffer pool used by the MQTT agent.
+ */
+
+#include "FreeRTOS.h"
+#include "aws_bufferpool.h"
+#include "aws_bufferpool_config.h"
+
+#include "aws_bench.h"
+
+/*-----------------------------------------------------------*/
+
+static void prvGetAndReturn( uint32_t ulIterations )
+{
+    uint8_t * pucBuffers[ bufferpoolconfigNUM_BUFFERS ];
+    uint32_t ulLength = 0;
+    size_t x = 0;
+
+    /* Take and return every buffer, so that each search walks further into
+     * the pool. */
+    while( ulIterations-- > 0 )
+    {
+        for( x = 0; x < bufferpoolconfigNUM_BUFFERS; x++ )
+        {
+            ulLength = bufferpoolconfigBUFFER_SIZE;
+            pucBuffers[ x ] = BUFFERPOOL_GetFreeBuffer( &ulLength );
+            configASSERT( pucBuffers[ x ] != NULL );
+        }
+
+        for( x = 0; x < bufferpoolconfigNUM_BUFFERS; x++ )
+        {
+            BUFFERPOOL_ReturnBuffer( pucBuffers[ x ] );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_BufferPool( void )
+{
+    ( void ) BUFFERPOOL_Init();
+
+    BENCH_Run( "bufferpool/fill_and_drain", prvGetAndReturn );
+}
@@ -0,0 +1,128 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the CBOR library, building and reading a report shaped
+ * like the Device Defender metrics report.
+ */
+
+#include "aws_cbor.h"
+
+#include "aws_bench.h"
+
+#define benchCBOR_BUFFER_SIZE    ( 256 )
+
+static CBORHandle_t xCborReport = NULL;
+
+/*-----------------------------------------------------------*/
+
+static CBORHandle_t prvBuildReportWithHandles( cbor_int_t xReportId )
+{
+    CBORHandle_t xReport = CBOR_New( benchCBOR_BUFFER_SIZE );
+    CBORHandle_t xHeader = CBOR_New( 0 );
+    CBORHandle_t xMetrics = CBOR_New( 0 );
+    CBORHandle_t xConnections = CBOR_New( 0 );
+    CBORHandle_t xTcp = CBOR_New( 0 );
+
+    CBOR_AssignKeyWithInt( xHeader, "report_id", xReportId );
+    CBOR_AssignKeyWithString( xHeader, "version", "1.0" );
+    CBOR_AppendKeyWithMap( xReport, "header", xHeader );
+
+    CBOR_AssignKeyWithInt( xConnections, "total", 3 );
+    CBOR_AssignKeyWithMap( xTcp, "established_connections", xConnections );
+    CBOR_AssignKeyWithInt( xMetrics, "cpu", 42 );
+    CBOR_AppendKeyWithInt( xMetrics, "ut", 86400 );
+    CBOR_AssignKeyWithMap( xMetrics, "tcp_connections", xTcp );
+    CBOR_AppendKeyWithMap( xReport, "metrics", xMetrics );
+
+    CBOR_Delete( &xTcp );
+    CBOR_Delete( &xConnections );
+    CBOR_Delete( &xMetrics );
+    CBOR_Delete( &xHeader );
+
+    return xReport;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBuildWithHandles( uint32_t ulIterations )
+{
+    CBORHandle_t xReport = NULL;
+
+    while( ulIterations-- > 0 )
+    {
+        xReport = prvBuildReportWithHandles( ( cbor_int_t ) ulIterations );
+        BENCH_CONSUME( CBOR_GetBufferSize( xReport ) );
+        CBOR_Delete( &xReport );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvBuildWithEncoder( uint32_t ulIterations )
+{
+    cbor_byte_t xBuffer[ benchCBOR_BUFFER_SIZE ];
+    CBOREncoder_t xEncoder;
+
+    while( ulIterations-- > 0 )
+    {
+        CBOR_EncoderInit( &xEncoder, xBuffer, sizeof( xBuffer ) );
+        CBOR_EncodeMap( &xEncoder, 2 );
+        CBOR_EncodeKeyWithMap( &xEncoder, "header", 2 );
+        CBOR_EncodeKeyWithInt( &xEncoder, "report_id", ( cbor_int_t ) ulIterations );
+        CBOR_EncodeKeyWithString( &xEncoder, "version", "1.0" );
+        CBOR_EncodeKeyWithMap( &xEncoder, "metrics", 3 );
+        CBOR_EncodeKeyWithInt( &xEncoder, "cpu", 42 );
+        CBOR_EncodeKeyWithInt( &xEncoder, "ut", 86400 );
+        CBOR_EncodeKeyWithMap( &xEncoder, "tcp_connections", 1 );
+        CBOR_EncodeKeyWithMap( &xEncoder, "established_connections", 1 );
+        CBOR_EncodeKeyWithInt( &xEncoder, "total", 3 );
+        BENCH_CONSUME( CBOR_EncoderSize( &xEncoder ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvReadKey( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        BENCH_CONSUME( CBOR_FindKey( xCborReport, "metrics" ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Cbor( void )
+{
+    xCborReport = prvBuildReportWithHandles( 1 );
+
+    BENCH_Run( "cbor/defender_report_handles", prvBuildWithHandles );
+    BENCH_Run( "cbor/defender_report_encoder", prvBuildWithEncoder );
+    BENCH_Run( "cbor/find_key", prvReadKey );
+
+    CBOR_Delete( &xCborReport );
+}
@@ -0,0 +1,104 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the FreeRTOS+TCP internet checksum, over raw data and
+ * over a full size TCP segment including its pseudo header.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Sockets.h"
+
+#include "aws_bench.h"
+
+/* Value usGenerateProtocolChecksum() returns for a received segment whose
+ * checksum is correct, private to FreeRTOS_IP.c. */
+#define benchCORRECT_CRC            ( 0xffffu )
+
+#define benchCHECKSUM_FRAME_SIZE    ( ipSIZE_OF_ETH_HEADER + ipconfigNETWORK_MTU )
+
+/* Aligned as a network buffer: the IP header follows the 14 byte Ethernet
+ * header and ipconfigPACKET_FILLER_SIZE bytes of padding. */
+static uint8_t ucChecksumBuffer[ ipconfigPACKET_FILLER_SIZE + benchCHECKSUM_FRAME_SIZE ] __attribute__( ( aligned( 8 ) ) );
+static uint8_t * const pucChecksumFrame = &ucChecksumBuffer[ ipconfigPACKET_FILLER_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+static void prvSetUpFrame( void )
+{
+    TCPPacket_t * pxPacket = ( TCPPacket_t * ) pucChecksumFrame;
+    size_t x = 0;
+
+    for( x = 0; x < benchCHECKSUM_FRAME_SIZE; x++ )
+    {
+        pucChecksumFrame[ x ] = ( uint8_t ) ( x * 31 );
+    }
+
+    pxPacket->xEthernetHeader.usFrameType = ipIPv4_FRAME_TYPE;
+    pxPacket->xIPHeader.ucVersionHeaderLength = 0x45u;
+    pxPacket->xIPHeader.usLength = FreeRTOS_htons( ipconfigNETWORK_MTU );
+    pxPacket->xIPHeader.ucProtocol = ( uint8_t ) ipPROTOCOL_TCP;
+    pxPacket->xIPHeader.ulSourceIPAddress = FreeRTOS_inet_addr_quick( 10, 136, 247, 2 );
+    pxPacket->xIPHeader.ulDestinationIPAddress = FreeRTOS_inet_addr_quick( 10, 136, 247, 1 );
+    pxPacket->xTCPHeader.ucTCPOffset = 0x50;
+
+    /* Fill in the checksum, which the receive path must then accept. */
+    ( void ) usGenerateProtocolChecksum( pucChecksumFrame, benchCHECKSUM_FRAME_SIZE, pdTRUE );
+    configASSERT( usGenerateProtocolChecksum( pucChecksumFrame, benchCHECKSUM_FRAME_SIZE, pdFALSE ) == benchCORRECT_CRC );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvChecksumMtu( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        BENCH_CONSUME( usGenerateChecksum( 0UL, &pucChecksumFrame[ ipSIZE_OF_ETH_HEADER ], ipconfigNETWORK_MTU ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvChecksumTcpSegment( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        BENCH_CONSUME( usGenerateProtocolChecksum( pucChecksumFrame, benchCHECKSUM_FRAME_SIZE, pdTRUE ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Checksum( void )
+{
+    prvSetUpFrame();
+
+    BENCH_Run( "checksum/raw_1500", prvChecksumMtu );
+    BENCH_Run( "checksum/tcp_segment_1500", prvChecksumTcpSegment );
+}
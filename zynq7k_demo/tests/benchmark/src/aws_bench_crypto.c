@@ -0,0 +1,224 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the mbedTLS primitives used by TLS and by the PKCS#11
+ * module: SHA-256, AES-128-GCM and P-256.
+ *
+ * mbedTLS is configured as on the board, with the acceleration hooks of
+ * lib/crypto unless the benchmark is built with crypto_ref=1.
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+
+#include "mbedtls/platform.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+
+#include "aws_bench.h"
+
+/* Bytes hashed or encrypted by one operation, about a TLS record. */
+#define benchCRYPTO_PAYLOAD_SIZE    ( 1024 )
+
+/* Start of the random sequence, reset for every operation that uses it. */
+#define benchCRYPTO_SEED            ( 0x2545F491UL )
+
+static unsigned char ucCryptoPayload[ benchCRYPTO_PAYLOAD_SIZE ];
+static unsigned char ucCryptoOutput[ benchCRYPTO_PAYLOAD_SIZE ];
+static unsigned char ucCryptoHash[ 32 ];
+static mbedtls_gcm_context xCryptoGcm;
+static mbedtls_ecp_group xCryptoGroup;
+static mbedtls_ecp_point xCryptoPublic;
+static mbedtls_mpi xCryptoPrivate;
+static mbedtls_mpi xCryptoR;
+static mbedtls_mpi xCryptoS;
+static uint32_t ulCryptoSeed = benchCRYPTO_SEED;
+
+/*-----------------------------------------------------------*/
+
+/* Allocate through pvPortMalloc() so heap use is counted, as
+ * CRYPTO_ConfigureHeap() does on the board. */
+static void * prvCalloc( size_t xNumElements,
+                         size_t xSize )
+{
+    void * pvNew = pvPortMalloc( xNumElements * xSize );
+
+    if( pvNew != NULL )
+    {
+        memset( pvNew, 0, xNumElements * xSize );
+    }
+
+    return pvNew;
+}
+
+/*-----------------------------------------------------------*/
+
+/* A fixed sequence, so every operation does the same work and uses the same
+ * amount of heap. */
+static int prvRng( void * pvContext,
+                   unsigned char * pucOutput,
+                   size_t xLength )
+{
+    ( void ) pvContext;
+
+    while( xLength-- > 0 )
+    {
+        ulCryptoSeed = ulCryptoSeed * 1664525UL + 1013904223UL;
+        *pucOutput++ = ( unsigned char ) ( ulCryptoSeed >> 24 );
+    }
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetUpCrypto( void )
+{
+    static const unsigned char ucKey[ 16 ] = { 0 };
+    size_t x = 0;
+
+    mbedtls_platform_set_calloc_free( prvCalloc, vPortFree );
+
+    for( x = 0; x < sizeof( ucCryptoPayload ); x++ )
+    {
+        ucCryptoPayload[ x ] = ( unsigned char ) ( x * 7 );
+    }
+
+    mbedtls_gcm_init( &xCryptoGcm );
+    configASSERT( mbedtls_gcm_setkey( &xCryptoGcm, MBEDTLS_CIPHER_ID_AES, ucKey, 128 ) == 0 );
+
+    mbedtls_ecp_group_init( &xCryptoGroup );
+    mbedtls_ecp_point_init( &xCryptoPublic );
+    mbedtls_mpi_init( &xCryptoPrivate );
+    mbedtls_mpi_init( &xCryptoR );
+    mbedtls_mpi_init( &xCryptoS );
+    configASSERT( mbedtls_ecp_group_load( &xCryptoGroup, MBEDTLS_ECP_DP_SECP256R1 ) == 0 );
+    configASSERT( mbedtls_ecp_gen_keypair( &xCryptoGroup, &xCryptoPrivate, &xCryptoPublic, prvRng, NULL ) == 0 );
+    configASSERT( mbedtls_sha256_ret( ucCryptoPayload, sizeof( ucCryptoPayload ), ucCryptoHash, 0 ) == 0 );
+    configASSERT( mbedtls_ecdsa_sign( &xCryptoGroup, &xCryptoR, &xCryptoS, &xCryptoPrivate,
+                                      ucCryptoHash, sizeof( ucCryptoHash ), prvRng, NULL ) == 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSha256( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        ( void ) mbedtls_sha256_ret( ucCryptoPayload, sizeof( ucCryptoPayload ), ucCryptoOutput, 0 );
+        BENCH_CONSUME( ucCryptoOutput[ 0 ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* A TLS 1.2 record: 8 bytes of explicit nonce after the 4 byte salt, and
+ * 13 bytes of additional data. */
+static void prvGcmEncrypt( uint32_t ulIterations )
+{
+    static const unsigned char ucIv[ 12 ] = { 0 };
+    static const unsigned char ucAdd[ 13 ] = { 0 };
+    unsigned char ucTag[ 16 ];
+
+    while( ulIterations-- > 0 )
+    {
+        ( void ) mbedtls_gcm_crypt_and_tag( &xCryptoGcm, MBEDTLS_GCM_ENCRYPT, sizeof( ucCryptoPayload ),
+                                            ucIv, sizeof( ucIv ), ucAdd, sizeof( ucAdd ),
+                                            ucCryptoPayload, ucCryptoOutput, sizeof( ucTag ), ucTag );
+        BENCH_CONSUME( ucTag[ 0 ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* The point multiplication of ECDH and of key generation. */
+static void prvP256Mul( uint32_t ulIterations )
+{
+    mbedtls_ecp_point xResult;
+
+    mbedtls_ecp_point_init( &xResult );
+
+    while( ulIterations-- > 0 )
+    {
+        ulCryptoSeed = benchCRYPTO_SEED;
+        ( void ) mbedtls_ecp_mul( &xCryptoGroup, &xResult, &xCryptoPrivate, &xCryptoPublic, prvRng, NULL );
+        BENCH_CONSUME( xResult.X.p[ 0 ] );
+    }
+
+    mbedtls_ecp_point_free( &xResult );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEcdsaSign( uint32_t ulIterations )
+{
+    mbedtls_mpi xR;
+    mbedtls_mpi xS;
+
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    while( ulIterations-- > 0 )
+    {
+        ulCryptoSeed = benchCRYPTO_SEED;
+        ( void ) mbedtls_ecdsa_sign( &xCryptoGroup, &xR, &xS, &xCryptoPrivate,
+                                     ucCryptoHash, sizeof( ucCryptoHash ), prvRng, NULL );
+        BENCH_CONSUME( xS.p[ 0 ] );
+    }
+
+    mbedtls_mpi_free( &xS );
+    mbedtls_mpi_free( &xR );
+}
+
+/*-----------------------------------------------------------*/
+
+/* The server's signature in every TLS handshake, and the OTA image
+ * signature. */
+static void prvEcdsaVerify( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        BENCH_CONSUME( mbedtls_ecdsa_verify( &xCryptoGroup, ucCryptoHash, sizeof( ucCryptoHash ),
+                                             &xCryptoPublic, &xCryptoR, &xCryptoS ) == 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Crypto( void )
+{
+    prvSetUpCrypto();
+
+    BENCH_RunThroughput( "crypto/sha256_1024", prvSha256, benchCRYPTO_PAYLOAD_SIZE );
+    BENCH_RunThroughput( "crypto/aes128_gcm_encrypt_1024", prvGcmEncrypt, benchCRYPTO_PAYLOAD_SIZE );
+    BENCH_Run( "crypto/p256_mul", prvP256Mul );
+    BENCH_Run( "crypto/p256_ecdsa_sign", prvEcdsaSign );
+    BENCH_Run( "crypto/p256_ecdsa_verify", prvEcdsaVerify );
+}
@@ -0,0 +1,120 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Runs the host benchmarks.
+ *
+ * Usage: bench [-f filter] [-o results.json] [-c baseline.json] [-t percent]
+ *              [-m MHz]
+ *
+ * -f  Only run benchmarks whose name contains filter.
+ * -o  Write the results as a JSON baseline.
+ * -c  Compare the results with a JSON baseline. The exit status is 1 if any
+ *     benchmark regressed.
+ * -t  Slowdown in percent counted as a regression, 10 by default.
+ * -m  Clock frequency of the CPU, to also report times in cycles.
+ */
+
+#include "aws_bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main( int argc,
+          char ** argv )
+{
+    const char * pcOutput = NULL;
+    const char * pcBaseline = NULL;
+    double xThresholdPercent = benchDEFAULT_THRESHOLD_PERCENT;
+    int iRegressions = 0;
+    int iArg = 0;
+
+    for( iArg = 1; iArg + 1 < argc; iArg += 2 )
+    {
+        if( strcmp( argv[ iArg ], "-f" ) == 0 )
+        {
+            BENCH_SetFilter( argv[ iArg + 1 ] );
+        }
+        else if( strcmp( argv[ iArg ], "-o" ) == 0 )
+        {
+            pcOutput = argv[ iArg + 1 ];
+        }
+        else if( strcmp( argv[ iArg ], "-c" ) == 0 )
+        {
+            pcBaseline = argv[ iArg + 1 ];
+        }
+        else if( strcmp( argv[ iArg ], "-t" ) == 0 )
+        {
+            xThresholdPercent = atof( argv[ iArg + 1 ] );
+        }
+        else if( strcmp( argv[ iArg ], "-m" ) == 0 )
+        {
+            BENCH_SetClockMHz( atof( argv[ iArg + 1 ] ) );
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( iArg != argc )
+    {
+        fprintf( stderr, "Usage: %s [-f filter] [-o results.json] [-c baseline.json] [-t percent] [-m MHz]\n", argv[ 0 ] );
+
+        return 2;
+    }
+
+    BENCH_Mqtt();
+    BENCH_Shadow();
+    BENCH_OtaCbor();
+    BENCH_Cbor();
+    BENCH_BufferPool();
+    BENCH_StreamBuffer();
+    BENCH_Checksum();
+    BENCH_Crypto();
+
+    if( ( pcOutput != NULL ) && ( BENCH_WriteJSON( pcOutput ) != 0 ) )
+    {
+        fprintf( stderr, "Cannot write %s\n", pcOutput );
+
+        return 2;
+    }
+
+    if( pcBaseline != NULL )
+    {
+        iRegressions = BENCH_Compare( pcBaseline, xThresholdPercent );
+
+        if( iRegressions < 0 )
+        {
+            fprintf( stderr, "Cannot read %s\n", pcBaseline );
+
+            return 2;
+        }
+    }
+
+    return ( iRegressions > 0 ) ? 1 : 0;
+}
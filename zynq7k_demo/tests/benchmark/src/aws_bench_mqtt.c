@@ -0,0 +1,283 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the MQTT library: packet encoding, packet parsing and
+ * topic filter matching.
+ *
+ * The context is connected by feeding it a CONNACK, and subscribed to the
+ * shadow topics the demos use, so that received publishes go through the
+ * subscription manager as they do on the device.
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "aws_mqtt_lib.h"
+#include "aws_bufferpool.h"
+#include "aws_mqtt_lib_test_access_declare.h"
+
+#include "aws_bench.h"
+
+#define benchMQTT_PAYLOAD_LENGTH    ( 256 )
+#define benchMQTT_TOPIC             "$aws/things/MicroZed-0001/shadow/update/delta"
+
+static MQTTContext_t xMqttContext;
+static uint16_t usMqttPacketIdentifier = 1;
+static uint32_t ulMqttPublishesReceived = 0;
+static uint8_t ucMqttPayload[ benchMQTT_PAYLOAD_LENGTH ];
+
+/* Topic length field, topic and payload of the PUBLISH. */
+#define benchMQTT_REMAINING_LENGTH    ( 2 + sizeof( benchMQTT_TOPIC ) - 1 + benchMQTT_PAYLOAD_LENGTH )
+
+/* Fixed header with a two byte remaining length, then the rest. */
+static uint8_t ucMqttPublishPacket[ 3 + benchMQTT_REMAINING_LENGTH ];
+
+/* Filters of the shadow client and the OTA agent, with the wildcard filter
+ * matching benchMQTT_TOPIC last. */
+static const char * const pcMqttFilters[] =
+{
+    "$aws/things/MicroZed-0001/shadow/update/accepted",
+    "$aws/things/MicroZed-0001/shadow/update/rejected",
+    "$aws/things/MicroZed-0001/shadow/get/accepted",
+    "$aws/things/MicroZed-0001/shadow/get/rejected",
+    "$aws/things/MicroZed-0001/jobs/notify-next",
+    "$aws/things/MicroZed-0001/streams/+/data/cbor",
+    "$aws/things/+/shadow/update/delta"
+};
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvSend( void * pvSendContext,
+                         const uint8_t * const pucData,
+                         uint32_t ulDataLength )
+{
+    ( void ) pvSendContext;
+    BENCH_CONSUME( pucData[ 0 ] );
+
+    return ulDataLength;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvGetTicks( uint64_t * pxCurrentTickCount )
+{
+    *pxCurrentTickCount = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvPublishCallback( void * pvPublishCallbackContext,
+                                      const MQTTPublishData_t * const pxPublishData )
+{
+    ( void ) pvPublishCallbackContext;
+    configASSERT( pxPublishData->ulDataLength == benchMQTT_PAYLOAD_LENGTH );
+    ulMqttPublishesReceived++;
+
+    /* Leave the buffer with the library, which returns it to the pool. */
+    return eMQTTFalse;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvAcknowledge( uint8_t ucPacketType,
+                            uint16_t usPacketIdentifier,
+                            uint8_t ucLength )
+{
+    uint8_t ucAck[ 5 ] = { 0 };
+
+    ucAck[ 0 ] = ucPacketType;
+    ucAck[ 1 ] = ucLength;
+    ucAck[ 2 ] = ( uint8_t ) ( usPacketIdentifier >> 8 );
+    ucAck[ 3 ] = ( uint8_t ) usPacketIdentifier;
+    ucAck[ 4 ] = 0x01; /* Granted QoS 1, SUBACK only. */
+
+    configASSERT( MQTT_ParseReceivedData( &xMqttContext, ucAck, 2 + ( size_t ) ucLength ) == eMQTTSuccess );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSetUpContext( void )
+{
+    MQTTInitParams_t xInitParams = { 0 };
+    MQTTConnectParams_t xConnectParams = { 0 };
+    MQTTSubscribeParams_t xSubscribeParams = { 0 };
+    static const uint8_t ucConnAck[] = { 0x20, 0x02, 0x00, 0x00 };
+    size_t x = 0;
+
+    ( void ) BUFFERPOOL_Init();
+
+    xInitParams.pxMQTTSendFxn = prvSend;
+    xInitParams.pxGetTicksFxn = prvGetTicks;
+    xInitParams.xBufferPoolInterface.pxGetBufferFxn = BUFFERPOOL_GetFreeBuffer;
+    xInitParams.xBufferPoolInterface.pxReturnBufferFxn = BUFFERPOOL_ReturnBuffer;
+    xInitParams.xBufferPoolInterface.pxShareBufferFxn = BUFFERPOOL_ShareBuffer;
+    ( void ) MQTT_Init( &xMqttContext, &xInitParams );
+
+    xConnectParams.pucClientId = ( const uint8_t * ) "MicroZed-0001";
+    xConnectParams.usClientIdLength = ( uint16_t ) strlen( "MicroZed-0001" );
+    xConnectParams.usKeepAliveIntervalSeconds = 1200;
+    xConnectParams.ulKeepAliveActualIntervalTicks = 1200000;
+    xConnectParams.ulPingRequestTimeoutTicks = 10000;
+    xConnectParams.ulTimeoutTicks = 10000;
+    configASSERT( MQTT_Connect( &xMqttContext, &xConnectParams ) == eMQTTSuccess );
+    configASSERT( MQTT_ParseReceivedData( &xMqttContext, ucConnAck, sizeof( ucConnAck ) ) == eMQTTSuccess );
+    configASSERT( xMqttContext.xConnectionState == eMQTTConnected );
+
+    for( x = 0; x < sizeof( pcMqttFilters ) / sizeof( pcMqttFilters[ 0 ] ); x++ )
+    {
+        xSubscribeParams.pucTopic = ( const uint8_t * ) pcMqttFilters[ x ];
+        xSubscribeParams.usTopicLength = ( uint16_t ) strlen( pcMqttFilters[ x ] );
+        xSubscribeParams.xQos = eMQTTQoS1;
+        xSubscribeParams.usPacketIdentifier = usMqttPacketIdentifier;
+        xSubscribeParams.ulTimeoutTicks = 10000;
+        xSubscribeParams.pxPublishCallback = prvPublishCallback;
+        configASSERT( MQTT_Subscribe( &xMqttContext, &xSubscribeParams ) == eMQTTSuccess );
+        prvAcknowledge( 0x90, usMqttPacketIdentifier++, 3 );
+    }
+
+    /* QoS 0 PUBLISH to benchMQTT_TOPIC. */
+    for( x = 0; x < sizeof( ucMqttPayload ); x++ )
+    {
+        ucMqttPayload[ x ] = ( uint8_t ) ( 'a' + ( x % 26 ) );
+    }
+
+    ucMqttPublishPacket[ 0 ] = 0x30;
+    ucMqttPublishPacket[ 1 ] = ( uint8_t ) ( 0x80 | ( benchMQTT_REMAINING_LENGTH & 0x7F ) );
+    ucMqttPublishPacket[ 2 ] = ( uint8_t ) ( benchMQTT_REMAINING_LENGTH >> 7 );
+    ucMqttPublishPacket[ 3 ] = 0;
+    ucMqttPublishPacket[ 4 ] = ( uint8_t ) ( sizeof( benchMQTT_TOPIC ) - 1 );
+    memcpy( &ucMqttPublishPacket[ 5 ], benchMQTT_TOPIC, sizeof( benchMQTT_TOPIC ) - 1 );
+    memcpy( &ucMqttPublishPacket[ 5 + sizeof( benchMQTT_TOPIC ) - 1 ], ucMqttPayload, sizeof( ucMqttPayload ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPublish( MQTTQoS_t xQos )
+{
+    MQTTPublishParams_t xPublishParams = { 0 };
+
+    xPublishParams.pucTopic = ( const uint8_t * ) benchMQTT_TOPIC;
+    xPublishParams.usTopicLength = ( uint16_t ) ( sizeof( benchMQTT_TOPIC ) - 1 );
+    xPublishParams.xQos = xQos;
+    xPublishParams.pvData = ucMqttPayload;
+    xPublishParams.ulDataLength = sizeof( ucMqttPayload );
+    xPublishParams.usPacketIdentifier = usMqttPacketIdentifier;
+    xPublishParams.ulTimeoutTicks = 10000;
+
+    configASSERT( MQTT_Publish( &xMqttContext, &xPublishParams ) == eMQTTSuccess );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPublishQoS0( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        prvPublish( eMQTTQoS0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvPublishQoS1AndAck( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        prvPublish( eMQTTQoS1 );
+        prvAcknowledge( 0x40, usMqttPacketIdentifier, 2 );
+
+        /* Identifier 0 is reserved. */
+        usMqttPacketIdentifier = ( uint16_t ) ( usMqttPacketIdentifier + 1 );
+        usMqttPacketIdentifier += ( usMqttPacketIdentifier == 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvParsePublish( uint32_t ulIterations )
+{
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( MQTT_ParseReceivedData( &xMqttContext, ucMqttPublishPacket, sizeof( ucMqttPublishPacket ) ) == eMQTTSuccess );
+    }
+
+    configASSERT( ulMqttPublishesReceived > 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMatchTopic( const char * pcTopic,
+                           const char * pcFilter,
+                           MQTTBool_t xExpected,
+                           uint32_t ulIterations )
+{
+    uint16_t usTopicLength = ( uint16_t ) strlen( pcTopic );
+    uint16_t usFilterLength = ( uint16_t ) strlen( pcFilter );
+
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( Test_prvDoesTopicMatchTopicFilter( ( const uint8_t * ) pcTopic,
+                                                         usTopicLength,
+                                                         ( const uint8_t * ) pcFilter,
+                                                         usFilterLength ) == xExpected );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMatchTopicPlus( uint32_t ulIterations )
+{
+    prvMatchTopic( benchMQTT_TOPIC, "$aws/things/+/shadow/update/delta", eMQTTTrue, ulIterations );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMatchTopicHash( uint32_t ulIterations )
+{
+    prvMatchTopic( benchMQTT_TOPIC, "$aws/things/MicroZed-0001/#", eMQTTTrue, ulIterations );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvMatchTopicMiss( uint32_t ulIterations )
+{
+    prvMatchTopic( benchMQTT_TOPIC, "$aws/things/MicroZed-0001/streams/+/data/cbor", eMQTTFalse, ulIterations );
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Mqtt( void )
+{
+    prvSetUpContext();
+
+    BENCH_Run( "mqtt/publish_qos0_256", prvPublishQoS0 );
+    BENCH_Run( "mqtt/publish_qos1_256_and_puback", prvPublishQoS1AndAck );
+    BENCH_Run( "mqtt/parse_publish_qos0_256", prvParsePublish );
+    BENCH_Run( "mqtt/topic_match_plus", prvMatchTopicPlus );
+    BENCH_Run( "mqtt/topic_match_hash", prvMatchTopicHash );
+    BENCH_Run( "mqtt/topic_match_miss", prvMatchTopicMiss );
+}
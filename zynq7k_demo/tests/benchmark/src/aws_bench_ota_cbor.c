@@ -0,0 +1,135 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the OTA agent's CBOR messages: the Get Stream request
+ * it sends for every window of blocks and the response carrying each block.
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "cbor.h"
+#include "aws_ota_cbor.h"
+#include "aws_ota_cbor_internal.h"
+
+#include "aws_bench.h"
+
+#define benchOTA_BLOCK_SIZE        ( 1024 )
+#define benchOTA_BITMAP_SIZE       ( 16 )
+#define benchOTA_MESSAGE_SIZE      ( benchOTA_BLOCK_SIZE + 64 )
+
+static uint8_t ucOtaBlock[ benchOTA_BLOCK_SIZE ];
+static uint8_t ucOtaBitmap[ benchOTA_BITMAP_SIZE ];
+static uint8_t ucOtaResponse[ benchOTA_MESSAGE_SIZE ];
+static size_t xOtaResponseSize = 0;
+
+/*-----------------------------------------------------------*/
+
+static void prvSetUpResponse( void )
+{
+    CborEncoder xEncoder;
+    CborEncoder xMap;
+    size_t x = 0;
+
+    for( x = 0; x < sizeof( ucOtaBlock ); x++ )
+    {
+        ucOtaBlock[ x ] = ( uint8_t ) ( x * 7 );
+    }
+
+    memset( ucOtaBitmap, 0xFF, sizeof( ucOtaBitmap ) );
+
+    /* The response as the service sends it. */
+    cbor_encoder_init( &xEncoder, ucOtaResponse, sizeof( ucOtaResponse ), 0 );
+    ( void ) cbor_encoder_create_map( &xEncoder, &xMap, 4 );
+    ( void ) cbor_encode_text_stringz( &xMap, OTA_CBOR_FILEID_KEY );
+    ( void ) cbor_encode_int( &xMap, 0 );
+    ( void ) cbor_encode_text_stringz( &xMap, OTA_CBOR_BLOCKID_KEY );
+    ( void ) cbor_encode_int( &xMap, 17 );
+    ( void ) cbor_encode_text_stringz( &xMap, OTA_CBOR_BLOCKSIZE_KEY );
+    ( void ) cbor_encode_int( &xMap, benchOTA_BLOCK_SIZE );
+    ( void ) cbor_encode_text_stringz( &xMap, OTA_CBOR_BLOCKPAYLOAD_KEY );
+    ( void ) cbor_encode_byte_string( &xMap, ucOtaBlock, sizeof( ucOtaBlock ) );
+    ( void ) cbor_encoder_close_container( &xEncoder, &xMap );
+    xOtaResponseSize = cbor_encoder_get_buffer_size( &xEncoder, ucOtaResponse );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvEncodeRequest( uint32_t ulIterations )
+{
+    uint8_t ucMessage[ benchOTA_MESSAGE_SIZE ];
+    size_t xEncodedSize = 0;
+
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( OTA_CBOR_Encode_GetStreamRequestMessage( ucMessage,
+                                                                sizeof( ucMessage ),
+                                                                &xEncodedSize,
+                                                                "rdy",
+                                                                0,
+                                                                benchOTA_BLOCK_SIZE,
+                                                                0,
+                                                                ucOtaBitmap,
+                                                                sizeof( ucOtaBitmap ) ) == pdPASS );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvDecodeResponse( uint32_t ulIterations )
+{
+    int32_t lFileId = 0;
+    int32_t lBlockId = 0;
+    int32_t lBlockSize = 0;
+    uint8_t * pucPayload = NULL;
+    size_t xPayloadSize = 0;
+
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( OTA_CBOR_Decode_GetStreamResponseMessage( ucOtaResponse,
+                                                                 xOtaResponseSize,
+                                                                 &lFileId,
+                                                                 &lBlockId,
+                                                                 &lBlockSize,
+                                                                 &pucPayload,
+                                                                 &xPayloadSize ) == pdPASS );
+        configASSERT( xPayloadSize == benchOTA_BLOCK_SIZE );
+
+        /* The agent frees the block once it is written. */
+        vPortFree( pucPayload );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_OtaCbor( void )
+{
+    prvSetUpResponse();
+
+    BENCH_Run( "ota_cbor/encode_get_stream_request", prvEncodeRequest );
+    BENCH_Run( "ota_cbor/decode_get_stream_response_1k", prvDecodeResponse );
+}
@@ -0,0 +1,226 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmarks of the shadow JSON helpers, on documents shaped like the
+ * ones the shadow demo sends and receives, and of the shadow topic index.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "aws_shadow_json.h"
+#include "aws_shadow_topic.h"
+
+#include "aws_bench.h"
+
+static const char cShadowUpdate[] =
+    "{\"state\":{\"reported\":{\"stateRed\":1,\"stateGreen\":0,\"stateBlue\":1,"
+    "\"firmwareVersion\":\"1.2.3\",\"uptimeSeconds\":86400}},"
+    "\"clientToken\":\"MicroZed-0001-token-0000123456\"}";
+
+static const char cShadowAccepted[] =
+    "{\"state\":{\"reported\":{\"stateRed\":1,\"stateGreen\":0,\"stateBlue\":1,"
+    "\"firmwareVersion\":\"1.2.3\",\"uptimeSeconds\":86400}},"
+    "\"metadata\":{\"reported\":{\"stateRed\":{\"timestamp\":1530000000},"
+    "\"stateGreen\":{\"timestamp\":1530000000},\"stateBlue\":{\"timestamp\":1530000000},"
+    "\"firmwareVersion\":{\"timestamp\":1530000000},\"uptimeSeconds\":{\"timestamp\":1530000000}}},"
+    "\"version\":42,\"timestamp\":1530000000,"
+    "\"clientToken\":\"MicroZed-0001-token-0000123456\"}";
+
+static const char cShadowRejected[] =
+    "{\"code\":409,\"message\":\"Version conflict\",\"timestamp\":1530000000,"
+    "\"clientToken\":\"MicroZed-0001-token-0000123456\"}";
+
+/* Things with registered callbacks, for the topic dispatch benchmarks. */
+#define benchSHADOW_MAX_THINGS    ( 128 )
+
+static char cThingNames[ benchSHADOW_MAX_THINGS ][ 24 ];
+static ShadowTopicIndexEntry_t xThingIndex[ benchSHADOW_MAX_THINGS ];
+
+/*-----------------------------------------------------------*/
+
+static void prvClientTokenMatch( uint32_t ulIterations )
+{
+    jsmntok_t xTokens1[ shadowconfigJSON_JSMN_TOKENS ];
+    jsmntok_t xTokens2[ shadowconfigJSON_JSMN_TOKENS ];
+    ShadowJSONDoc_t xDoc1, xDoc2;
+
+    while( ulIterations-- > 0 )
+    {
+        ( void ) SHADOW_JSONParse( &xDoc1, xTokens1, shadowconfigJSON_JSMN_TOKENS,
+                                   cShadowUpdate, sizeof( cShadowUpdate ) - 1 );
+        ( void ) SHADOW_JSONParse( &xDoc2, xTokens2, shadowconfigJSON_JSMN_TOKENS,
+                                   cShadowAccepted, sizeof( cShadowAccepted ) - 1 );
+        configASSERT( SHADOW_JSONDocClientTokenMatch( &xDoc1, &xDoc2 ) == pdTRUE );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvClientToken( uint32_t ulIterations )
+{
+    jsmntok_t xTokens[ shadowconfigJSON_JSMN_TOKENS ];
+    ShadowJSONDoc_t xDoc;
+    const char * pcClientToken = NULL;
+
+    /* Done by the shadow MQTT callback for every accepted or rejected
+     * response. */
+    while( ulIterations-- > 0 )
+    {
+        ( void ) SHADOW_JSONParse( &xDoc, xTokens, shadowconfigJSON_JSMN_TOKENS,
+                                   cShadowAccepted, sizeof( cShadowAccepted ) - 1 );
+        configASSERT( SHADOW_JSONGetClientToken( &xDoc, &pcClientToken ) == 30 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvErrorCodeAndMessage( uint32_t ulIterations )
+{
+    jsmntok_t xTokens[ shadowconfigJSON_JSMN_TOKENS ];
+    ShadowJSONDoc_t xDoc;
+    char * pcMessage = NULL;
+    uint16_t usMessageLength = 0;
+
+    while( ulIterations-- > 0 )
+    {
+        ( void ) SHADOW_JSONParse( &xDoc, xTokens, shadowconfigJSON_JSMN_TOKENS,
+                                   cShadowRejected, sizeof( cShadowRejected ) - 1 );
+        configASSERT( SHADOW_JSONGetErrorCodeAndMessage( &xDoc,
+                                                         &pcMessage,
+                                                         &usMessageLength ) == 409 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRejectedResponse( uint32_t ulIterations )
+{
+    jsmntok_t xTokens[ shadowconfigJSON_JSMN_TOKENS ];
+    ShadowJSONDoc_t xDoc;
+    const char * pcClientToken = NULL;
+    char * pcMessage = NULL;
+    uint16_t usMessageLength = 0;
+
+    /* Done by the shadow MQTT callback for a rejected response: one parse,
+     * then the client token and the error. */
+    while( ulIterations-- > 0 )
+    {
+        ( void ) SHADOW_JSONParse( &xDoc, xTokens, shadowconfigJSON_JSMN_TOKENS,
+                                   cShadowRejected, sizeof( cShadowRejected ) - 1 );
+        configASSERT( SHADOW_JSONGetClientToken( &xDoc, &pcClientToken ) == 30 );
+        configASSERT( SHADOW_JSONGetErrorCodeAndMessage( &xDoc,
+                                                         &pcMessage,
+                                                         &usMessageLength ) == 409 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTopicDispatch( uint32_t ulIterations,
+                              BaseType_t xThingCount )
+{
+    char cTopic[ shadowTOPIC_BUFFER_LENGTH ];
+    uint16_t usTopicLength;
+    ShadowTopic_t xTopic;
+    const char * pcThingName = cThingNames[ xThingCount - 1 ];
+
+    /* The delta of the last registered Thing, which is found last. */
+    usTopicLength = SHADOW_TopicBuild( cTopic,
+                                       sizeof( cTopic ),
+                                       pcThingName,
+                                       ( uint16_t ) strlen( pcThingName ),
+                                       eShadowOperationUpdateDelta,
+                                       eShadowTopicNoStatus );
+
+    /* Done by the shadow MQTT callback for every received publish. */
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( SHADOW_TopicParse( ( const uint8_t * ) cTopic, usTopicLength, &xTopic ) == pdTRUE );
+        configASSERT( SHADOW_TopicIndexFind( xThingIndex,
+                                             xThingCount,
+                                             xTopic.pcThingName,
+                                             xTopic.usThingNameLength,
+                                             xTopic.ulThingNameHash ) == xThingCount - 1 );
+    }
+}
+
+static void prvTopicDispatch1( uint32_t ulIterations )
+{
+    prvTopicDispatch( ulIterations, 1 );
+}
+
+static void prvTopicDispatch16( uint32_t ulIterations )
+{
+    prvTopicDispatch( ulIterations, 16 );
+}
+
+static void prvTopicDispatch128( uint32_t ulIterations )
+{
+    prvTopicDispatch( ulIterations, 128 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvTopicBuild( uint32_t ulIterations )
+{
+    char cTopic[ shadowTOPIC_BUFFER_LENGTH ];
+
+    /* Done for every subscribe, unsubscribe and publish of an operation. */
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( SHADOW_TopicBuild( cTopic,
+                                         sizeof( cTopic ),
+                                         "MicroZed-0001",
+                                         13,
+                                         eShadowOperationUpdate,
+                                         eShadowTopicAccepted ) == 48 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_Shadow( void )
+{
+    BaseType_t xThing;
+
+    for( xThing = 0; xThing < benchSHADOW_MAX_THINGS; xThing++ )
+    {
+        ( void ) snprintf( cThingNames[ xThing ], sizeof( cThingNames[ xThing ] ), "MicroZed-%04d", ( int ) xThing );
+        SHADOW_TopicIndexSet( &( xThingIndex[ xThing ] ), cThingNames[ xThing ] );
+    }
+
+    BENCH_Run( "shadow/client_token_match", prvClientTokenMatch );
+    BENCH_Run( "shadow/client_token", prvClientToken );
+    BENCH_Run( "shadow/error_code_and_message", prvErrorCodeAndMessage );
+    BENCH_Run( "shadow/rejected_response", prvRejectedResponse );
+    BENCH_Run( "shadow/topic_dispatch_1", prvTopicDispatch1 );
+    BENCH_Run( "shadow/topic_dispatch_16", prvTopicDispatch16 );
+    BENCH_Run( "shadow/topic_dispatch_128", prvTopicDispatch128 );
+    BENCH_Run( "shadow/topic_build", prvTopicBuild );
+}
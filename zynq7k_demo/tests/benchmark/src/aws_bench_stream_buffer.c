@@ -0,0 +1,73 @@
+/*
+ * Amazon FreeRTOS Benchmarks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Benchmark of the FreeRTOS+TCP stream buffer, which holds the data of
+ * every TCP socket, moving one full segment at a time.
+ */
+
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "FreeRTOS_Stream_Buffer.h"
+
+#include "aws_bench.h"
+
+#define benchSTREAM_SEGMENT_SIZE    ( ipconfigTCP_MSS )
+
+static StreamBuffer_t * pxStreamBuffer = NULL;
+static uint8_t ucStreamSegment[ benchSTREAM_SEGMENT_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+static void prvAddAndGet( uint32_t ulIterations )
+{
+    /* The buffer length is not a multiple of the segment size, so the copies
+     * wrap around its end at varying offsets. */
+    while( ulIterations-- > 0 )
+    {
+        configASSERT( uxStreamBufferAdd( pxStreamBuffer, 0, ucStreamSegment, sizeof( ucStreamSegment ) ) == sizeof( ucStreamSegment ) );
+        configASSERT( uxStreamBufferGet( pxStreamBuffer, 0, ucStreamSegment, sizeof( ucStreamSegment ), pdFALSE ) == sizeof( ucStreamSegment ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void BENCH_StreamBuffer( void )
+{
+    /* Allocated as FreeRTOS_Sockets.c allocates a socket's receive stream. */
+    size_t xLength = ipconfigTCP_RX_BUFFER_LENGTH + sizeof( size_t );
+
+    pxStreamBuffer = calloc( 1, sizeof( *pxStreamBuffer ) - sizeof( pxStreamBuffer->ucArray ) + xLength );
+    pxStreamBuffer->LENGTH = xLength;
+
+    BENCH_Run( "stream_buffer/add_and_get_mss", prvAddAndGet );
+
+    free( pxStreamBuffer );
+}
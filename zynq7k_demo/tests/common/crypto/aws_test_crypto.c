@@ -25,12 +25,15 @@
 
 /* Standard includes. */
 #include <stdint.h>
+#include <string.h>
 
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 
 /* Crypto includes. */
 #include "aws_crypto.h"
+#include "aws_crypto_config.h"
+#include "aws_crypto_config_defaults.h"
 
 /* Unity framework includes. */
 #include "unity_fixture.h"
@@ -38,6 +41,60 @@
 
 TEST_GROUP( Full_CRYPTO );
 
+/* ECDSA signer certificate read by prvReadSignerCertificate(), and its
+ * signature of 1024 zero bytes, for VerifySignatureCachedSignerKey. */
+static const char cCachedSignerCertificate[] =
+    "-----BEGIN CERTIFICATE-----\n"
+    "MIICKzCCAdGgAwIBAgIJAKNGg1OpqFRbMAoGCCqGSM49BAMCMHIxCzAJBgNVBAYT\n"
+    "AlVTMQswCQYDVQQIDAJXQTEQMA4GA1UEBwwHU2VhdHRsZTEMMAoGA1UECgwDQVdT\n"
+    "MQwwCgYDVQQLDANJb1QxDDAKBgNVBAMMA0RhbjEaMBgGCSqGSIb3DQEJARYLZGFu\n"
+    "QGZvby5jb20wHhcNMTcwODAxMTUzOTQ4WhcNMTgwODAxMTUzOTQ4WjByMQswCQYD\n"
+    "VQQGEwJVUzELMAkGA1UECAwCV0ExEDAOBgNVBAcMB1NlYXR0bGUxDDAKBgNVBAoM\n"
+    "A0FXUzEMMAoGA1UECwwDSW9UMQwwCgYDVQQDDANEYW4xGjAYBgkqhkiG9w0BCQEW\n"
+    "C2RhbkBmb28uY29tMFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAEQXHTh/4Bglwa\n"
+    "P9Eb4UzekSAbdO7pjTOxiHcySJbF77HwB54VNpURb4Ezdbinq/i/4ZWAgrtXZqAH\n"
+    "3SRhMnIOuKNQME4wHQYDVR0OBBYEFJDG0d5hX9C14PmtSq3pC0cfTjVyMB8GA1Ud\n"
+    "IwQYMBaAFJDG0d5hX9C14PmtSq3pC0cfTjVyMAwGA1UdEwQFMAMBAf8wCgYIKoZI\n"
+    "zj0EAwIDSAAwRQIgfqoTxQqp0eW5rEOZt36vcdVC989DLAMfrdEo49IxjxACIQDX\n"
+    "iR2uXx4o5BNFKfk+aD60EEtFV9tdLvxMYNJy9ftnsg==\n"
+    "-----END CERTIFICATE-----\n";
+static const uint8_t ucCachedSignature[] =
+{
+    0x30, 0x45, 0x02, 0x20, 0x5C, 0xF5, 0x58, 0x76, 0x9F, 0xFC, 0x7E, 0xDE, 0x34, 0xAC, 0x72, 0xB2,
+    0x1A, 0x8B, 0xF9, 0x63, 0xBB, 0x72, 0x3A, 0x08, 0xCA, 0x70, 0x16, 0xE0, 0x9D, 0x6F, 0xBD, 0x03,
+    0xEA, 0x22, 0x61, 0x2F, 0x02, 0x21, 0x00, 0xCD, 0x68, 0xB8, 0x49, 0x81, 0x88, 0x3C, 0xD3, 0xE2,
+    0x2D, 0x15, 0x30, 0xB2, 0xCF, 0xF0, 0x6B, 0x3C, 0xB9, 0x8A, 0x92, 0xE8, 0x70, 0x5F, 0x50, 0xD6,
+    0x00, 0xC0, 0xDF, 0x6E, 0x3A, 0xF5, 0x27
+};
+
+/* A byte of r in ucCachedSignature, after the SEQUENCE header (30 45) and the
+ * INTEGER header of r (02 20), so that the DER encoding stays valid. */
+#define cryptotestSIGNATURE_R_BYTE    ( 20 )
+
+/* Number of calls to prvReadSignerCertificate(). */
+static uint32_t ulSignerCertificateReads;
+
+static uint8_t * prvReadSignerCertificate( const uint8_t * const pucCertName,
+                                           uint32_t * const pulCertSize )
+{
+    uint8_t * pucCertificate = NULL;
+
+    ulSignerCertificateReads++;
+
+    if( 0 == strcmp( ( const char * ) pucCertName, "ecdsa_signer.crt" ) )
+    {
+        pucCertificate = pvPortMalloc( sizeof( cCachedSignerCertificate ) );
+
+        if( NULL != pucCertificate )
+        {
+            memcpy( pucCertificate, cCachedSignerCertificate, sizeof( cCachedSignerCertificate ) );
+            *pulCertSize = sizeof( cCachedSignerCertificate );
+        }
+    }
+
+    return pucCertificate;
+}
+
 TEST_SETUP( Full_CRYPTO )
 {
 }
@@ -49,6 +106,7 @@ TEST_TEAR_DOWN( Full_CRYPTO )
 TEST_GROUP_RUNNER( Full_CRYPTO )
 {
     RUN_TEST_CASE( Full_CRYPTO, VerifySignatureTestVectors );
+    RUN_TEST_CASE( Full_CRYPTO, VerifySignatureCachedSignerKey );
 }
 
 TEST( Full_CRYPTO, VerifySignatureTestVectors )
@@ -281,3 +339,63 @@ TEST( Full_CRYPTO, VerifySignatureTestVectors )
     TEST_ASSERT_FALSE( xResult );
     /** @}*/
 }
+
+static BaseType_t prvVerifyCached( const char * pcSignerName,
+                                   uint8_t * pucSignature,
+                                   size_t xSignatureLength )
+{
+    BaseType_t xResult;
+    void * pvSignatureVerificationContext = NULL;
+    uint8_t ucDataToSign[ TEST_DATA_TO_SIGN_BYTES ] = { 0 };
+
+    xResult = CRYPTO_SignatureVerificationStart(
+        &pvSignatureVerificationContext,
+        cryptoASYMMETRIC_ALGORITHM_ECDSA,
+        cryptoHASH_ALGORITHM_SHA256 );
+    TEST_ASSERT_TRUE( xResult );
+
+    CRYPTO_SignatureVerificationUpdate(
+        pvSignatureVerificationContext,
+        ucDataToSign,
+        sizeof( ucDataToSign ) );
+
+    return CRYPTO_SignatureVerificationFinalCached(
+        pvSignatureVerificationContext,
+        ( const uint8_t * ) pcSignerName,
+        prvReadSignerCertificate,
+        pucSignature,
+        xSignatureLength );
+}
+
+TEST( Full_CRYPTO, VerifySignatureCachedSignerKey )
+{
+    uint8_t ucSignature[ sizeof( ucCachedSignature ) ];
+    uint32_t ulReadsPerVerify = ( cryptoconfigSIGNER_KEY_CACHE_SIZE > 0 ) ? 0U : 1U;
+
+    memcpy( ucSignature, ucCachedSignature, sizeof( ucSignature ) );
+    CRYPTO_SignerKeyCacheFlush();
+    ulSignerCertificateReads = 0;
+
+    /* The first verification reads the certificate. */
+    TEST_ASSERT_TRUE( prvVerifyCached( "ecdsa_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, ulSignerCertificateReads );
+
+    /* Later ones use the cached key, and still reject a bad signature. */
+    TEST_ASSERT_TRUE( prvVerifyCached( "ecdsa_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    ucSignature[ cryptotestSIGNATURE_R_BYTE ] ^= 0x01U;
+    TEST_ASSERT_FALSE( prvVerifyCached( "ecdsa_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    ucSignature[ cryptotestSIGNATURE_R_BYTE ] ^= 0x01U;
+    TEST_ASSERT_EQUAL_UINT32( 1 + ( 2 * ulReadsPerVerify ), ulSignerCertificateReads );
+
+    /* A signer which cannot be read fails, and is not cached. */
+    TEST_ASSERT_FALSE( prvVerifyCached( "missing_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    TEST_ASSERT_FALSE( prvVerifyCached( "missing_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    TEST_ASSERT_EQUAL_UINT32( 3 + ( 2 * ulReadsPerVerify ), ulSignerCertificateReads );
+
+    /* A flush reads the certificate again. */
+    CRYPTO_SignerKeyCacheFlush();
+    TEST_ASSERT_TRUE( prvVerifyCached( "ecdsa_signer.crt", ucSignature, sizeof( ucSignature ) ) );
+    TEST_ASSERT_EQUAL_UINT32( 4 + ( 2 * ulReadsPerVerify ), ulSignerCertificateReads );
+
+    CRYPTO_SignerKeyCacheFlush();
+}
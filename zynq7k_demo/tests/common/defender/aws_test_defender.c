@@ -571,7 +571,12 @@ TEST( Full_DEFENDER, agent_happy_states )
     DEFENDER_AssertStateAndWait( eDefenderStateConnectMqttSuccess );
     DEFENDER_AssertStateAndWait( eDefenderStateSubscribeMqttSuccess );
     DEFENDER_AssertStateAndWait( eDefenderStateSubmitReportSuccess );
-    DEFENDER_AssertStateAndWait( eDefenderStateDisconnected );
+    DEFENDER_AssertStateAndWait( eDefenderStateSleep );
+
+    /* The connection and subscriptions are kept for the next report */
+    DEFENDER_AssertStateAndWait( eDefenderStateStarted );
+    DEFENDER_AssertStateAndWait( eDefenderStateSubscribeMqttSuccess );
+    DEFENDER_AssertStateAndWait( eDefenderStateSubmitReportSuccess );
     DEFENDER_AssertStateAndWait( eDefenderStateSleep );
     DEFENDER_AssertState( eDefenderStateStarted );
 
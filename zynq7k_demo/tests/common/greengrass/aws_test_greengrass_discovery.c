@@ -44,6 +44,7 @@
 #define ggdTestJSON_PORT_ADRESS_1          1234
 #define ggdTestJSON_PORT_ADRESS_3          4321
 #define ggdTestLOOP_NUMBER                 10
+#define ggdTestSTREAM_CHUNK_SIZE           7
 
 #define ggdJSON_FILE_GROUPID               "GGGroupId"
 #define ggdJSON_FILE_THING_ARN             "thingArn"
@@ -82,6 +83,7 @@ TEST_GROUP_RUNNER( Full_GGD )
     RUN_TEST_CASE( Full_GGD, JSONRequestStart );
     RUN_TEST_CASE( Full_GGD, JSONRequestAbort );
     RUN_TEST_CASE( Full_GGD, GetIPandCertificateFromJSON );
+    RUN_TEST_CASE( Full_GGD, JSONStreamParse );
     RUN_TEST_CASE( Full_GGD, GetIPOnInterface );
     RUN_TEST_CASE( Full_GGD, JSONRequestGetSize );
     RUN_TEST_CASE( Full_GGD, JSONRequestGetFile );
@@ -378,6 +380,115 @@ TEST( Full_GGD, GetIPandCertificateFromJSON )
     /** @}*/
 }
 
+/* Feed cJSON_FILE to the streaming parser in chunks of ulChunkSize bytes. */
+static BaseType_t prvStreamParseFile( GGD_JSONStream_t * pxStream,
+                                      uint32_t ulChunkSize )
+{
+    BaseType_t xStatus = pdPASS;
+    uint32_t ulIndex;
+    uint32_t ulSize;
+    uint32_t ulJSONFileSize = strlen( cJSON_FILE );
+
+    for( ulIndex = 0; ( ulIndex < ulJSONFileSize ) && ( xStatus == pdPASS ); ulIndex += ulSize )
+    {
+        ulSize = ( ulJSONFileSize - ulIndex < ulChunkSize ) ? ulJSONFileSize - ulIndex : ulChunkSize;
+        xStatus = GGD_JSONStreamParse( pxStream, &cJSON_FILE[ ulIndex ], ulSize );
+    }
+
+    return xStatus;
+}
+
+TEST( Full_GGD, JSONStreamParse )
+{
+    BaseType_t xStatus;
+    GGD_JSONStream_t xStream;
+    HostParameters_t xHostParameters;
+    GGD_HostAddressData_t xHostAddressData;
+    char cBadGroupId[] = "myBadGroupID";
+
+    if( TEST_PROTECT() )
+    {
+        /** @brief Check auto select keeps the first entries and the certificate,
+         * whatever the chunk size.
+         *  @{
+         */
+        GGD_JSONStreamInit( &xStream, NULL, cBuffer, testrunnerBUFFER_SIZE );
+        xStatus = prvStreamParseFile( &xStream, ggdTestSTREAM_CHUNK_SIZE );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 0, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        TEST_ASSERT_EQUAL_STRING( cIP_ADDRESS_1, xHostAddressData.pcHostAddress );
+        TEST_ASSERT_EQUAL_INT32( ggdTestJSON_PORT_ADRESS_1, xHostAddressData.usPort );
+        TEST_ASSERT_EQUAL_STRING( cCERTIFICATE, xHostAddressData.pcCertificate );
+        TEST_ASSERT_EQUAL_INT32( strlen( cCERTIFICATE ) + 1, xHostAddressData.ulCertificateSize );
+
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 2, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        TEST_ASSERT_EQUAL_STRING( cIP_ADDRESS_3, xHostAddressData.pcHostAddress );
+        TEST_ASSERT_EQUAL_INT32( ggdTestJSON_PORT_ADRESS_3, xHostAddressData.usPort );
+
+        GGD_JSONStreamInit( &xStream, NULL, cBuffer, testrunnerBUFFER_SIZE );
+        xStatus = prvStreamParseFile( &xStream, 1 );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 0, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        TEST_ASSERT_EQUAL_STRING( cIP_ADDRESS_1, xHostAddressData.pcHostAddress );
+        TEST_ASSERT_EQUAL_STRING( cCERTIFICATE, xHostAddressData.pcCertificate );
+        /** @}*/
+
+        /** @brief Check manual select keeps only the requested interface.
+         *  @{
+         */
+        xHostParameters.pcGroupName = cMyGroupID;
+        xHostParameters.pcCoreAddress = cMY_CORE_ARN;
+        xHostParameters.ucInterface = 3;
+        GGD_JSONStreamInit( &xStream, &xHostParameters, cBuffer, testrunnerBUFFER_SIZE );
+        xStatus = prvStreamParseFile( &xStream, ggdTestSTREAM_CHUNK_SIZE );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 0, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        TEST_ASSERT_EQUAL_STRING( cIP_ADDRESS_3, xHostAddressData.pcHostAddress );
+        TEST_ASSERT_EQUAL_INT32( ggdTestJSON_PORT_ADRESS_3, xHostAddressData.usPort );
+
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 1, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdFAIL, xStatus );
+        /** @}*/
+
+        /** @brief Check nothing is selected if the group is not in the file.
+         *  @{
+         */
+        xHostParameters.pcGroupName = cBadGroupId;
+        GGD_JSONStreamInit( &xStream, &xHostParameters, cBuffer, testrunnerBUFFER_SIZE );
+        xStatus = prvStreamParseFile( &xStream, ggdTestSTREAM_CHUNK_SIZE );
+        TEST_ASSERT_EQUAL_INT32( pdPASS, xStatus );
+        xStatus = GGD_JSONStreamGetHostAddressData( &xStream, 0, &xHostAddressData );
+        TEST_ASSERT_EQUAL_INT32( pdFAIL, xStatus );
+        /** @}*/
+
+        /** @brief Check fail is returned if the certificate does not fit.
+         *  @{
+         */
+        GGD_JSONStreamInit( &xStream, NULL, cBuffer, strlen( cCERTIFICATE ) );
+        xStatus = prvStreamParseFile( &xStream, ggdTestSTREAM_CHUNK_SIZE );
+        TEST_ASSERT_EQUAL_INT32( pdFAIL, xStatus );
+        /** @}*/
+
+        /** @brief Check fail is returned on an unbalanced document.
+         *  @{
+         */
+        GGD_JSONStreamInit( &xStream, NULL, cBuffer, testrunnerBUFFER_SIZE );
+        xStatus = GGD_JSONStreamParse( &xStream, "{\"GGGroups\":[}", strlen( "{\"GGGroups\":[}" ) );
+        TEST_ASSERT_EQUAL_INT32( pdFAIL, xStatus );
+        /** @}*/
+    }
+    else
+    {
+        TEST_FAIL();
+    }
+}
+
 TEST( Full_GGD, GetCore )
 {
     BaseType_t xStatus;
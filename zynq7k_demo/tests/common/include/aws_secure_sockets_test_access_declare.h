@@ -0,0 +1,51 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_secure_sockets_test_access_declare.h
+ * @brief Declaration of functions that access private methods in aws_secure_sockets.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_SECURE_SOCKETS_TEST_ACCESS_DECLARE_H_
+#define _AWS_SECURE_SOCKETS_TEST_ACCESS_DECLARE_H_
+
+#include "aws_secure_sockets.h"
+
+#if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+
+/*
+ * Returns whether a socket about to connect to pxAddress would be served by
+ * the standby connection of pxEndpoint, whose server was found at
+ * ulStandbyAddress.
+ */
+    BaseType_t test_prvStandbyMatch( Socket_t xSocket,
+                                     const SocketsSockaddr_t * pxAddress,
+                                     const SocketsStandbyEndpoint_t * pxEndpoint,
+                                     uint32_t ulStandbyAddress );
+#endif
+
+#endif /* _AWS_SECURE_SOCKETS_TEST_ACCESS_DECLARE_H_ */
@@ -0,0 +1,58 @@
+/*
+ * Amazon FreeRTOS
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_secure_sockets_test_access_define.h
+ * @brief Function wrappers to access private methods in aws_secure_sockets.c.
+ *
+ * Needed for testing private functions.
+ */
+
+#ifndef _AWS_SECURE_SOCKETS_TEST_ACCESS_DEFINE_H_
+#define _AWS_SECURE_SOCKETS_TEST_ACCESS_DEFINE_H_
+
+/*-----------------------------------------------------------*/
+
+#if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+    BaseType_t test_prvStandbyMatch( Socket_t xSocket,
+                                     const SocketsSockaddr_t * pxAddress,
+                                     const SocketsStandbyEndpoint_t * pxEndpoint,
+                                     uint32_t ulStandbyAddress )
+    {
+        SocketsStandby_t xStandby;
+
+        memset( &xStandby, 0, sizeof( xStandby ) );
+        xStandby.xEndpoint = *pxEndpoint;
+        xStandby.ulAddress = ulStandbyAddress;
+
+        return prvStandbyMatch( ( const SSOCKETContext_t * ) xSocket, /*lint !e9087 cast used for portability. */
+                                pxAddress,
+                                &xStandby );
+    }
+#endif
+
+/*-----------------------------------------------------------*/
+
+#endif /* _AWS_SECURE_SOCKETS_TEST_ACCESS_DEFINE_H_ */
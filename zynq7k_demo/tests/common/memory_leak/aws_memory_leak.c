@@ -40,6 +40,227 @@
 
 #define memoryleakPRINTF( x )    vLoggingPrintf x
 
+/* The number of allocation and free events recorded while the tests run. */
+#ifndef memoryleakTRACE_LENGTH
+    #define memoryleakTRACE_LENGTH    ( 2048 )
+#endif
+
+/* The number of times each trace is replayed by the heap benchmark. */
+#ifndef memoryleakBENCHMARK_ITERATIONS
+    #define memoryleakBENCHMARK_ITERATIONS    ( 20 )
+#endif
+
+/* The number and size of the blocks allocated by the coalescing test.  Larger
+ * than the slab objects of heap_tlsf.c. */
+#define memoryleakCOALESCE_BLOCKS        ( 8 )
+#define memoryleakCOALESCE_BLOCK_SIZE    ( 1024 )
+
+/**
+ * @brief An allocation or a free in an allocation trace.
+ */
+typedef struct MemoryLeakTraceEvent
+{
+    uint32_t ulSize;       /**< Bytes allocated, or 0 for a free. */
+    uint16_t usAllocation; /**< For a free, the index of the event that allocated the block. */
+} MemoryLeakTraceEvent_t;
+
+/**
+ * @brief A kind of allocation made by the libraries, used to build the
+ * synthetic trace.
+ */
+typedef struct MemoryLeakWorkload
+{
+    uint32_t ulMinSize;
+    uint32_t ulMaxSize;
+    uint16_t usLifetime; /**< Steps the block is held for, multiplied by 1 to 4. */
+    uint8_t ucWeight;    /**< Relative frequency. */
+} MemoryLeakWorkload_t;
+
+/* Allocations made by OTA CBOR decoding, POSIX message queues, logging and
+ * mbedTLS.  The TLS record buffers are held for the length of a connection. */
+static const MemoryLeakWorkload_t xWorkloads[] =
+{
+    { 1024,  4200,  2,   6 },  /* OTA CBOR file block payloads. */
+    { 16,    96,    2,   12 }, /* OTA CBOR map keys and strings. */
+    { 32,    256,   4,   10 }, /* mq_timedsend() message copies. */
+    { 100,   100,   1,   10 }, /* Logging buffers. */
+    { 200,   2500,  8,   6 },  /* mbedTLS handshake temporaries. */
+    { 16717, 16717, 200, 1 }   /* mbedTLS record buffers. */
+};
+
+/* The trace recorded through traceMALLOC() and traceFREE(), and the address of
+ * each block in it that has not been freed. */
+static MemoryLeakTraceEvent_t xRecordedTrace[ memoryleakTRACE_LENGTH ];
+static void * pvRecordedBlocks[ memoryleakTRACE_LENGTH ];
+static UBaseType_t uxRecordedEvents = 0;
+static BaseType_t xRecording = pdTRUE;
+
+/* Used to build the synthetic trace, and to replay both traces. */
+static MemoryLeakTraceEvent_t xSyntheticTrace[ memoryleakTRACE_LENGTH ];
+static void * pvReplayBlocks[ memoryleakTRACE_LENGTH ];
+
+/*-----------------------------------------------------------*/
+
+void vMemoryLeakTraceMalloc( void * pvAddress,
+                             size_t xSize )
+{
+    /* Called by pvPortMalloc() with the scheduler suspended. */
+    if( ( xRecording == pdTRUE ) && ( pvAddress != NULL ) && ( uxRecordedEvents < memoryleakTRACE_LENGTH ) )
+    {
+        xRecordedTrace[ uxRecordedEvents ].ulSize = ( uint32_t ) xSize;
+        xRecordedTrace[ uxRecordedEvents ].usAllocation = 0;
+        pvRecordedBlocks[ uxRecordedEvents ] = pvAddress;
+        uxRecordedEvents++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vMemoryLeakTraceFree( void * pvAddress )
+{
+    UBaseType_t uxIndex;
+
+    /* Called by vPortFree() with the scheduler suspended.  Blocks allocated
+     * before the trace filled up are the ones that can be found. */
+    if( ( xRecording == pdTRUE ) && ( uxRecordedEvents < memoryleakTRACE_LENGTH ) )
+    {
+        for( uxIndex = uxRecordedEvents; uxIndex > 0; uxIndex-- )
+        {
+            if( pvRecordedBlocks[ uxIndex - 1 ] == pvAddress )
+            {
+                pvRecordedBlocks[ uxIndex - 1 ] = NULL;
+                xRecordedTrace[ uxRecordedEvents ].ulSize = 0;
+                xRecordedTrace[ uxRecordedEvents ].usAllocation = ( uint16_t ) ( uxIndex - 1 );
+                pvRecordedBlocks[ uxRecordedEvents ] = NULL;
+                uxRecordedEvents++;
+                break;
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvBuildSyntheticTrace( void )
+{
+    static uint16_t usHeld[ memoryleakTRACE_LENGTH ];
+    static uint32_t ulDue[ memoryleakTRACE_LENGTH ];
+    UBaseType_t uxEvents = 0, uxHeld = 0, uxIndex, uxWeights = 0, uxPick;
+    uint32_t ulStep, ulRandom = 0x2545F491UL;
+    const MemoryLeakWorkload_t * pxWorkload;
+
+    for( uxIndex = 0; uxIndex < sizeof( xWorkloads ) / sizeof( xWorkloads[ 0 ] ); uxIndex++ )
+    {
+        uxWeights += xWorkloads[ uxIndex ].ucWeight;
+    }
+
+    for( ulStep = 0; uxEvents < memoryleakTRACE_LENGTH - 1; ulStep++ )
+    {
+        /* Free the blocks that are due, most recent first. */
+        for( uxIndex = uxHeld; ( uxIndex > 0 ) && ( uxEvents < memoryleakTRACE_LENGTH - 1 ); uxIndex-- )
+        {
+            if( ulDue[ uxIndex - 1 ] <= ulStep )
+            {
+                xSyntheticTrace[ uxEvents ].ulSize = 0;
+                xSyntheticTrace[ uxEvents ].usAllocation = usHeld[ uxIndex - 1 ];
+                uxEvents++;
+                uxHeld--;
+                usHeld[ uxIndex - 1 ] = usHeld[ uxHeld ];
+                ulDue[ uxIndex - 1 ] = ulDue[ uxHeld ];
+            }
+        }
+
+        /* Make one allocation, picking the kind with a linear congruential
+         * generator so that the trace is the same on every run. */
+        ulRandom = ( ulRandom * 1664525UL ) + 1013904223UL;
+        uxPick = ( ulRandom >> 8 ) % uxWeights;
+
+        for( pxWorkload = xWorkloads; uxPick >= pxWorkload->ucWeight; pxWorkload++ )
+        {
+            uxPick -= pxWorkload->ucWeight;
+        }
+
+        ulRandom = ( ulRandom * 1664525UL ) + 1013904223UL;
+        xSyntheticTrace[ uxEvents ].ulSize = pxWorkload->ulMinSize +
+                                             ( ( ulRandom >> 8 ) % ( pxWorkload->ulMaxSize - pxWorkload->ulMinSize + 1 ) );
+        xSyntheticTrace[ uxEvents ].usAllocation = 0;
+        usHeld[ uxHeld ] = ( uint16_t ) uxEvents;
+        ulDue[ uxHeld ] = ulStep + ( pxWorkload->usLifetime * ( 1 + ( ( ulRandom >> 4 ) & 3 ) ) );
+        uxHeld++;
+        uxEvents++;
+    }
+
+    return uxEvents;
+}
+/*-----------------------------------------------------------*/
+
+static void prvReplayTrace( const char * pcName,
+                            const MemoryLeakTraceEvent_t * pxTrace,
+                            UBaseType_t uxEvents )
+{
+    HeapStats_t xStats;
+    size_t xFreeBefore;
+    TickType_t xStart, xTicks = 0;
+    UBaseType_t uxIteration, uxIndex, uxFailures = 0;
+
+    xFreeBefore = xPortGetFreeHeapSize();
+
+    for( uxIteration = 0; uxIteration < memoryleakBENCHMARK_ITERATIONS; uxIteration++ )
+    {
+        xStart = xTaskGetTickCount();
+
+        for( uxIndex = 0; uxIndex < uxEvents; uxIndex++ )
+        {
+            if( pxTrace[ uxIndex ].ulSize != 0 )
+            {
+                pvReplayBlocks[ uxIndex ] = pvPortMalloc( pxTrace[ uxIndex ].ulSize );
+
+                if( pvReplayBlocks[ uxIndex ] == NULL )
+                {
+                    uxFailures++;
+                }
+            }
+            else
+            {
+                vPortFree( pvReplayBlocks[ pxTrace[ uxIndex ].usAllocation ] );
+                pvReplayBlocks[ pxTrace[ uxIndex ].usAllocation ] = NULL;
+            }
+        }
+
+        xTicks += xTaskGetTickCount() - xStart;
+
+        /* Measure fragmentation while the blocks still held at the end of the
+         * trace are allocated. */
+        if( uxIteration == 0 )
+        {
+            vPortGetHeapStats( &xStats );
+        }
+
+        for( uxIndex = 0; uxIndex < uxEvents; uxIndex++ )
+        {
+            if( pxTrace[ uxIndex ].ulSize != 0 )
+            {
+                vPortFree( pvReplayBlocks[ uxIndex ] );
+                pvReplayBlocks[ uxIndex ] = NULL;
+            }
+        }
+    }
+
+    memoryleakPRINTF( ( "Heap benchmark %s: %u events x %u in %u ticks, %u failed. "
+                        "%u free blocks, largest %u of %u free bytes.\r\n",
+                        pcName,
+                        uxEvents,
+                        memoryleakBENCHMARK_ITERATIONS,
+                        xTicks,
+                        uxFailures,
+                        xStats.xNumberOfFreeBlocks,
+                        xStats.xSizeOfLargestFreeBlockInBytes,
+                        xStats.xAvailableHeapSpaceInBytes ) );
+
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE( xFreeBefore,
+                                      xPortGetFreeHeapSize(),
+                                      "Free heap before and after replaying the trace was not the same." );
+}
+/*-----------------------------------------------------------*/
+
 TEST_GROUP( Full_MemoryLeak );
 TEST_SETUP( Full_MemoryLeak )
 {
@@ -52,6 +273,8 @@ TEST_TEAR_DOWN( Full_MemoryLeak )
 TEST_GROUP_RUNNER( Full_MemoryLeak )
 {
     RUN_TEST_CASE( Full_MemoryLeak, CheckHeap );
+    RUN_TEST_CASE( Full_MemoryLeak, HeapCoalescesFreedBlocks );
+    RUN_TEST_CASE( Full_MemoryLeak, HeapBenchmark );
 }
 
 
@@ -70,3 +293,75 @@ TEST( Full_MemoryLeak, CheckHeap )
                                      xHeapChange,
                                      "Free heap before and after tests was not the same." );
 }
+
+/* Freeing every other block leaves holes that cannot be merged.  Once the
+ * blocks in between are freed as well, the heap must be back as it was. */
+TEST( Full_MemoryLeak, HeapCoalescesFreedBlocks )
+{
+    void * pvBlocks[ memoryleakCOALESCE_BLOCKS ];
+    HeapStats_t xBefore, xFragmented, xAfter;
+    UBaseType_t uxIndex, uxFailures = 0;
+
+    /* No other task may allocate in between.  Nothing is asserted while the
+     * scheduler is suspended, as a failed assertion would not resume it. */
+    vTaskSuspendAll();
+    {
+        vPortGetHeapStats( &xBefore );
+
+        for( uxIndex = 0; uxIndex < memoryleakCOALESCE_BLOCKS; uxIndex++ )
+        {
+            pvBlocks[ uxIndex ] = pvPortMalloc( memoryleakCOALESCE_BLOCK_SIZE );
+
+            if( pvBlocks[ uxIndex ] == NULL )
+            {
+                uxFailures++;
+            }
+        }
+
+        for( uxIndex = 0; uxIndex < memoryleakCOALESCE_BLOCKS; uxIndex += 2 )
+        {
+            vPortFree( pvBlocks[ uxIndex ] );
+        }
+
+        vPortGetHeapStats( &xFragmented );
+
+        for( uxIndex = 1; uxIndex < memoryleakCOALESCE_BLOCKS; uxIndex += 2 )
+        {
+            vPortFree( pvBlocks[ uxIndex ] );
+        }
+
+        vPortGetHeapStats( &xAfter );
+    }
+    ( void ) xTaskResumeAll();
+
+    TEST_ASSERT_EQUAL( 0, uxFailures );
+    TEST_ASSERT_GREATER_THAN( xBefore.xNumberOfFreeBlocks, xFragmented.xNumberOfFreeBlocks );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.xAvailableHeapSpaceInBytes, xAfter.xAvailableHeapSpaceInBytes );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.xNumberOfFreeBlocks, xAfter.xNumberOfFreeBlocks );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.xSizeOfLargestFreeBlockInBytes, xAfter.xSizeOfLargestFreeBlockInBytes );
+}
+/*-----------------------------------------------------------*/
+
+/* Replays the allocations recorded while the other tests ran, and a synthetic
+ * trace of the allocations made by the libraries, to compare heap
+ * implementations.  The tests link heap_tlsf.c, as the demo does.  Link
+ * heap_4.c instead to compare them. */
+TEST( Full_MemoryLeak, HeapBenchmark )
+{
+    UBaseType_t uxSyntheticEvents;
+
+    /* The replays must not be recorded. */
+    vTaskSuspendAll();
+    {
+        xRecording = pdFALSE;
+    }
+    ( void ) xTaskResumeAll();
+
+    if( uxRecordedEvents > 0 )
+    {
+        prvReplayTrace( "recorded", xRecordedTrace, uxRecordedEvents );
+    }
+
+    uxSyntheticEvents = prvBuildSyntheticTrace();
+    prvReplayTrace( "synthetic", xSyntheticTrace, uxSyntheticEvents );
+}
@@ -41,6 +41,7 @@
 
 /* Bufferpool includes. */
 #include "aws_bufferpool.h"
+#include "aws_bufferpool_config.h"
 
 /**
  * @brief The callback context registered with the MQTT Core library.
@@ -79,6 +80,17 @@
  * @brief MQTT Control packet flags.
  */
 #define mqttFLAGS_CONNACK                     ( ( uint8_t ) 0 ) /**< Reserved. */
+
+/**
+ * @brief Number of subscriptions a received publish is fanned out to.
+ */
+#define testmqttlibFAN_OUT_SUBSCRIBERS        ( 2 )
+
+/**
+ * @brief Topic and payload of the publish that is fanned out.
+ */
+#define testmqttlibFAN_OUT_TOPIC              "fanout/topic"
+#define testmqttlibFAN_OUT_PAYLOAD            "shared payload"
 /*-----------------------------------------------------------*/
 
 /**
@@ -99,6 +111,12 @@ typedef struct CallbackCounter
  */
 static MQTTContext_t xMQTTContext;
 
+/**
+ * @brief Publishes kept by each subscriber of the fan out tests. The buffer
+ * is NULL when the subscriber has not been called.
+ */
+static MQTTPublishData_t xFanOutPublishes[ testmqttlibFAN_OUT_SUBSCRIBERS ];
+
 /**
  * @brief Callback counter used by all the tests.
  */
@@ -184,6 +202,36 @@ static MQTTReturnCode_t prvSendMQTTConnect( void );
  * @return The return value of MQTT_ParseReceivedData.
  */
 static MQTTReturnCode_t prvReceiveMQTTConnACK( void );
+
+/**
+ * @brief Counts the buffers currently free in the central buffer pool.
+ *
+ * Takes every free buffer and returns them all.
+ *
+ * @return The number of free buffers.
+ */
+static uint32_t prvCountFreeBuffers( void );
+
+/**
+ * @brief Publish callback of the fan out tests, which keeps the buffer.
+ *
+ * @param[in] pvPublishCallbackContext Entry of xFanOutPublishes of the
+ * subscriber.
+ * @param[in] pxPublishData The received publish.
+ *
+ * @return Always eMQTTTrue, the subscriber owns a reference to the buffer.
+ */
+static MQTTBool_t prvFanOutCallback( void * pvPublishCallbackContext,
+                                     const MQTTPublishData_t * const pxPublishData );
+
+/**
+ * @brief Delivers one publish to two subscriptions, then has the subscribers
+ * return their references in the given order.
+ *
+ * @param[in] pxReturnOrder Subscriber indexes, in the order they return the
+ * buffer.
+ */
+static void prvFanOutAndReturn( const uint32_t * pxReturnOrder );
 /*-----------------------------------------------------------*/
 
 static MQTTBool_t prvMQTTEventCallback( void * pvCallbackContext,
@@ -271,6 +319,7 @@ static MQTTReturnCode_t prvInitializeMQTTContext( void )
     xInitParams.pxGetTicksFxn = NULL;
     xInitParams.xBufferPoolInterface.pxGetBufferFxn = BUFFERPOOL_GetFreeBuffer;
     xInitParams.xBufferPoolInterface.pxReturnBufferFxn = BUFFERPOOL_ReturnBuffer;
+    xInitParams.xBufferPoolInterface.pxShareBufferFxn = BUFFERPOOL_ShareBuffer;
 
     /* Initialize MQTT context. */
     xReturnCode = MQTT_Init( &( xMQTTContext ), &( xInitParams ) );
@@ -323,6 +372,117 @@ static MQTTReturnCode_t prvReceiveMQTTConnACK( void )
 }
 /*-----------------------------------------------------------*/
 
+static uint32_t prvCountFreeBuffers( void )
+{
+    uint8_t * pucBuffers[ bufferpoolconfigNUM_BUFFERS ];
+    uint32_t ulBufferLength;
+    uint32_t ulCount = 0;
+    uint32_t ulI;
+
+    while( ulCount < bufferpoolconfigNUM_BUFFERS )
+    {
+        ulBufferLength = 1;
+        pucBuffers[ ulCount ] = BUFFERPOOL_GetFreeBuffer( &( ulBufferLength ) );
+
+        if( pucBuffers[ ulCount ] == NULL )
+        {
+            break;
+        }
+
+        ulCount++;
+    }
+
+    for( ulI = 0; ulI < ulCount; ulI++ )
+    {
+        BUFFERPOOL_ReturnBuffer( pucBuffers[ ulI ] );
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static MQTTBool_t prvFanOutCallback( void * pvPublishCallbackContext,
+                                     const MQTTPublishData_t * const pxPublishData )
+{
+    MQTTPublishData_t * pxKept = ( MQTTPublishData_t * ) pvPublishCallbackContext;
+
+    TEST_ASSERT_NULL( pxKept->xBuffer );
+
+    /* Keep the publish, as a subscriber queueing it to its own task
+     * would. */
+    *pxKept = *pxPublishData;
+
+    return eMQTTTrue;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFanOutAndReturn( const uint32_t * pxReturnOrder )
+{
+    MQTTSubscribeParams_t xSubscribeParams;
+    MQTTReturnCode_t xReturnCode;
+    uint32_t ulFreeBuffers;
+    uint32_t ulI;
+    const char * pcTopicFilters[ testmqttlibFAN_OUT_SUBSCRIBERS ] = { testmqttlibFAN_OUT_TOPIC, "fanout/#" };
+    const uint16_t usTopicLength = ( uint16_t ) strlen( testmqttlibFAN_OUT_TOPIC );
+    const uint16_t usPayloadLength = ( uint16_t ) strlen( testmqttlibFAN_OUT_PAYLOAD );
+    uint8_t ucPublishMessage[ 2 + 2 + sizeof( testmqttlibFAN_OUT_TOPIC ) + sizeof( testmqttlibFAN_OUT_PAYLOAD ) ];
+
+    /* QoS0 PUBLISH: fixed header, topic length, topic and payload. */
+    ucPublishMessage[ 0 ] = ( uint8_t ) 0x30;
+    ucPublishMessage[ 1 ] = ( uint8_t ) ( 2 + usTopicLength + usPayloadLength );
+    ucPublishMessage[ 2 ] = ( uint8_t ) ( usTopicLength >> 8 );
+    ucPublishMessage[ 3 ] = ( uint8_t ) ( usTopicLength & 0xFF );
+    memcpy( &( ucPublishMessage[ 4 ] ), testmqttlibFAN_OUT_TOPIC, usTopicLength );
+    memcpy( &( ucPublishMessage[ 4 + usTopicLength ] ), testmqttlibFAN_OUT_PAYLOAD, usPayloadLength );
+
+    memset( xFanOutPublishes, 0x00, sizeof( xFanOutPublishes ) );
+
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvSendMQTTConnect() );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, prvReceiveMQTTConnACK() );
+
+    /* Two overlapping subscriptions, both match the topic. */
+    for( ulI = 0; ulI < testmqttlibFAN_OUT_SUBSCRIBERS; ulI++ )
+    {
+        xSubscribeParams.pucTopic = ( const uint8_t * ) pcTopicFilters[ ulI ];
+        xSubscribeParams.usTopicLength = ( uint16_t ) strlen( pcTopicFilters[ ulI ] );
+        xSubscribeParams.xQos = eMQTTQoS0;
+        xSubscribeParams.usPacketIdentifier = ( uint16_t ) ( testmqttlibCONNECT_PACKET_ID + 1 + ulI );
+        xSubscribeParams.ulTimeoutTicks = testmqttlibOPERATION_TIMEOUT_TICKS;
+        xSubscribeParams.pvPublishCallbackContext = &( xFanOutPublishes[ ulI ] );
+        xSubscribeParams.pxPublishCallback = &( prvFanOutCallback );
+
+        TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_Subscribe( &( xMQTTContext ), &( xSubscribeParams ) ) );
+    }
+
+    ulFreeBuffers = prvCountFreeBuffers();
+
+    xReturnCode = MQTT_ParseReceivedData( &( xMQTTContext ), ucPublishMessage, 4 + usTopicLength + usPayloadLength );
+    TEST_ASSERT_EQUAL( eMQTTSuccess, xReturnCode );
+
+    /* Both subscribers hold the same buffer, not a copy, and the library
+     * has dropped its own reference. */
+    TEST_ASSERT_NOT_NULL( xFanOutPublishes[ 0 ].xBuffer );
+    TEST_ASSERT_EQUAL_PTR( xFanOutPublishes[ 0 ].xBuffer, xFanOutPublishes[ 1 ].xBuffer );
+    TEST_ASSERT_EQUAL( ulFreeBuffers - 1, prvCountFreeBuffers() );
+
+    /* The first subscriber to finish does not free the buffer, and the
+     * payload is left intact for the other one. */
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ReturnBuffer( &( xMQTTContext ), xFanOutPublishes[ pxReturnOrder[ 0 ] ].xBuffer ) );
+    TEST_ASSERT_EQUAL( ulFreeBuffers - 1, prvCountFreeBuffers() );
+    TEST_ASSERT_EQUAL( usPayloadLength, xFanOutPublishes[ pxReturnOrder[ 1 ] ].ulDataLength );
+    TEST_ASSERT_EQUAL_MEMORY( testmqttlibFAN_OUT_PAYLOAD,
+                              xFanOutPublishes[ pxReturnOrder[ 1 ] ].pvData,
+                              usPayloadLength );
+
+    /* The last one does. */
+    TEST_ASSERT_EQUAL( eMQTTSuccess, MQTT_ReturnBuffer( &( xMQTTContext ), xFanOutPublishes[ pxReturnOrder[ 1 ] ].xBuffer ) );
+    TEST_ASSERT_EQUAL( ulFreeBuffers, prvCountFreeBuffers() );
+
+    /* The generic callback must not have been invoked for the publish. */
+    TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
+}
+/*-----------------------------------------------------------*/
+
 /* Define Test Group. */
 TEST_GROUP( Full_MQTT );
 /*-----------------------------------------------------------*/
@@ -381,6 +541,11 @@ TEST_GROUP_RUNNER( Full_MQTT )
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileAlreadyConnected );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_SecondConnectWhileWaitingForConnACK );
     RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed );
+
+    /* Reference counted buffers. */
+    RUN_TEST_CASE( Full_MQTT, AFQP_BUFFERPOOL_ShareBuffer_LastReturnFrees );
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Publish_FanOutReturnedInOrder );
+    RUN_TEST_CASE( Full_MQTT, AFQP_MQTT_Publish_FanOutReturnedInReverseOrder );
 }
 /*-----------------------------------------------------------*/
 
@@ -728,6 +893,7 @@ TEST( Full_MQTT, AFQP_MQTT_Init_NULLParams )
     xInitParams.pxGetTicksFxn = NULL;
     xInitParams.xBufferPoolInterface.pxGetBufferFxn = BUFFERPOOL_GetFreeBuffer;
     xInitParams.xBufferPoolInterface.pxReturnBufferFxn = BUFFERPOOL_ReturnBuffer;
+    xInitParams.xBufferPoolInterface.pxShareBufferFxn = BUFFERPOOL_ShareBuffer;
 
     if( TEST_PROTECT() )
     {
@@ -1075,3 +1241,56 @@ TEST( Full_MQTT, AFQP_MQTT_Connect_NetworkSendFailed )
     TEST_ASSERT_EQUAL( 0, xCallbackCounter.ulUnidentified );
 }
 /*-----------------------------------------------------------*/
+
+/**
+ * @brief A shared buffer goes back to the pool when its last reference is
+ * returned, and only then.
+ */
+TEST( Full_MQTT, AFQP_BUFFERPOOL_ShareBuffer_LastReturnFrees )
+{
+    uint8_t * pucBuffer;
+    uint32_t ulBufferLength = 1;
+    uint32_t ulFreeBuffers = prvCountFreeBuffers();
+
+    pucBuffer = BUFFERPOOL_GetFreeBuffer( &( ulBufferLength ) );
+    TEST_ASSERT_NOT_NULL( pucBuffer );
+
+    /* Three owners. */
+    BUFFERPOOL_ShareBuffer( pucBuffer );
+    BUFFERPOOL_ShareBuffer( pucBuffer );
+    TEST_ASSERT_EQUAL( ulFreeBuffers - 1, prvCountFreeBuffers() );
+
+    BUFFERPOOL_ReturnBuffer( pucBuffer );
+    TEST_ASSERT_EQUAL( ulFreeBuffers - 1, prvCountFreeBuffers() );
+
+    BUFFERPOOL_ReturnBuffer( pucBuffer );
+    TEST_ASSERT_EQUAL( ulFreeBuffers - 1, prvCountFreeBuffers() );
+
+    BUFFERPOOL_ReturnBuffer( pucBuffer );
+    TEST_ASSERT_EQUAL( ulFreeBuffers, prvCountFreeBuffers() );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A publish matching two subscriptions is shared between them, and
+ * freed when the second subscriber returns it.
+ */
+TEST( Full_MQTT, AFQP_MQTT_Publish_FanOutReturnedInOrder )
+{
+    const uint32_t ulReturnOrder[ testmqttlibFAN_OUT_SUBSCRIBERS ] = { 0, 1 };
+
+    prvFanOutAndReturn( ulReturnOrder );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief As above, with the subscribers returning the buffer in the opposite
+ * order to the one they were called in.
+ */
+TEST( Full_MQTT, AFQP_MQTT_Publish_FanOutReturnedInReverseOrder )
+{
+    const uint32_t ulReturnOrder[ testmqttlibFAN_OUT_SUBSCRIBERS ] = { 1, 0 };
+
+    prvFanOutAndReturn( ulReturnOrder );
+}
+/*-----------------------------------------------------------*/
@@ -550,6 +550,34 @@ TEST( Full_OTA_CBOR, CborOtaApi )
         vPortFree( pucPayload );
         pucPayload = NULL;
     }
+
+    /* Test OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer( ). The payload
+     * is decoded into the block it was encoded from, so clear it first. */
+    memset( ucBlockPayload, 0, sizeof( ucBlockPayload ) );
+    xPayloadSize = sizeof( ucBlockPayload );
+    xResult = OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer(
+        ucCborWork,
+        xEncodedSize,
+        &lFileId,
+        &lBlockIndex,
+        &lBlockSize,
+        ucBlockPayload,
+        &xPayloadSize );
+    TEST_ASSERT_TRUE( xResult );
+    TEST_ASSERT_EQUAL( sizeof( ucBlockPayload ), xPayloadSize );
+    TEST_ASSERT_EQUAL( 1, ucBlockPayload[ 1 ] );
+
+    /* A buffer too small for the payload is rejected. */
+    xPayloadSize = sizeof( ucBlockPayload ) - 1;
+    xResult = OTA_CBOR_Decode_GetStreamResponseMessageIntoBuffer(
+        ucCborWork,
+        xEncodedSize,
+        &lFileId,
+        &lBlockIndex,
+        &lBlockSize,
+        ucBlockPayload,
+        &xPayloadSize );
+    TEST_ASSERT_FALSE( xResult );
 }
 
 TEST( Full_OTA_CBOR, CborOtaAgentIngest )
@@ -1117,6 +1117,7 @@ TEST_GROUP_RUNNER( Full_PKCS11_CryptoOperation )
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_Sign_HappyPath );
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_Sign_InvalidParams );
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignInit_InvalidParams );
+    RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_SignInit_KeyParsedOnce );
 
     /* Object related tests. */
     RUN_TEST_CASE( Full_PKCS11_CryptoOperation, AFQP_Objects_HappyPath );
@@ -1947,6 +1948,51 @@ TEST( Full_PKCS11_CryptoOperation, AFQP_Sign_HappyPath )
     TEST_ASSERT_EQUAL_INT32( 0, xResult );
 }
 
+TEST( Full_PKCS11_CryptoOperation, AFQP_SignInit_KeyParsedOnce )
+{
+    CK_RV xResult = 0;
+    CK_OBJECT_HANDLE xPrivateKey = 0;
+    CK_SESSION_HANDLE xSecondSession = 0;
+    CK_SLOT_ID xSlotId = pkcs11testINVALID_SLOT_ID;
+    CK_ULONG ulCount = 1;
+    CK_MECHANISM xMech = { 0 };
+    PKCS11_CacheStats_t xBefore;
+    PKCS11_CacheStats_t xAfter;
+
+    xResult = prvReprovision( pcValidRSACertificate, pcValidRSAPrivateKey, CKK_RSA );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    xResult = prvGetPrivateKeyHandle( pxGlobalFunctionList, xGlobalSession, &xPrivateKey );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    xResult = pxGlobalFunctionList->C_GetSlotList( CK_TRUE, &xSlotId, &ulCount );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    xResult = pxGlobalFunctionList->C_OpenSession( xSlotId, CKF_SERIAL_SESSION, NULL, NULL, &xSecondSession );
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+
+    PKCS11_GetCacheStats( &xBefore );
+
+    /* The saved key is parsed by the first session and shared with the
+     * second, neither reads the storage. */
+    xMech.mechanism = CKM_SHA256_RSA_PKCS;
+    xResult = pxGlobalFunctionList->C_SignInit( xGlobalSession, &xMech, xPrivateKey );
+
+    if( 0 == xResult )
+    {
+        xResult = pxGlobalFunctionList->C_SignInit( xSecondSession, &xMech, xPrivateKey );
+    }
+
+    PKCS11_GetCacheStats( &xAfter );
+
+    ( void ) pxGlobalFunctionList->C_CloseSession( xSecondSession );
+
+    TEST_ASSERT_EQUAL_INT32( CKR_OK, xResult );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.ulKeyParses + 1, xAfter.ulKeyParses );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.ulKeyHits + 1, xAfter.ulKeyHits );
+    TEST_ASSERT_EQUAL_UINT32( xBefore.ulObjectLoads, xAfter.ulObjectLoads );
+}
+
 TEST( Full_PKCS11_CryptoOperation, AFQP_Objects_HappyPath )
 {
     CK_RV xResult = 0;
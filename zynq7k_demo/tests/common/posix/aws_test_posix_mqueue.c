@@ -51,6 +51,7 @@
 #define posixtestMQ_SMALL_MESSAGE_SIZE    ( sizeof( posixtestMQ_SMALL_MESSAGE ) )  /**< Length (including null-terminator) of posixtestMQ_SMALL_MESSAGE. */
 #define posixtestMQ_DEFAULT_NAME          "/myqueue"                               /**< Default name of message queues in this test. */
 #define posixtestMQ_DEFAULT_MODE          0600                                     /**< Default mode argument for mq_open. */
+#define posixtestMQ_BENCHMARK_MESSAGES    20000                                    /**< Number of messages sent and received by the benchmark. */
 /**@} */
 
 /* Default queue attributes used in these tests. */
@@ -93,6 +94,7 @@ TEST_GROUP_RUNNER( Full_POSIX_MQUEUE )
     RUN_TEST_CASE( Full_POSIX_MQUEUE, mq_send_receive );
     /*RUN_TEST_CASE( Full_POSIX_MQUEUE, mq_send_receive_invalidParams ); */
     RUN_TEST_CASE( Full_POSIX_MQUEUE, mq_send_receive_nonblock );
+    RUN_TEST_CASE( Full_POSIX_MQUEUE, mq_benchmark );
 }
 
 /*-----------------------------------------------------------*/
@@ -550,3 +552,61 @@ TEST( Full_POSIX_MQUEUE, mq_send_receive_nonblock )
 }
 
 /*-----------------------------------------------------------*/
+
+TEST( Full_POSIX_MQUEUE, mq_benchmark )
+{
+    int iStatus = 0;
+    uint32_t ulMessage = 0;
+    volatile mqd_t xMqId = posixtestMQ_INVALID_MQD;
+    char pcReceiveBuffer[ posixtestMQ_SMALL_MESSAGE_SIZE ] = { 0 };
+    HeapStats_t xHeapBefore = { 0 }, xHeapAfter = { 0 };
+    TickType_t xStartTick = 0, xElapsedTicks = 0;
+
+    if( TEST_PROTECT() )
+    {
+        xMqId = mq_open( posixtestMQ_DEFAULT_NAME,
+                         O_CREAT | O_RDWR | O_NONBLOCK,
+                         posixtestMQ_DEFAULT_MODE,
+                         &xDefaultQueueAttr );
+        TEST_ASSERT_NOT_EQUAL( posixtestMQ_INVALID_MQD, xMqId );
+
+        vPortGetHeapStats( &xHeapBefore );
+        xStartTick = xTaskGetTickCount();
+
+        /* Receive in pairs so that both the empty and the non-empty queue
+         * paths are exercised. */
+        for( ulMessage = 0; ulMessage < posixtestMQ_BENCHMARK_MESSAGES; ulMessage++ )
+        {
+            iStatus = mq_send( xMqId, posixtestMQ_SMALL_MESSAGE, posixtestMQ_SMALL_MESSAGE_SIZE, 0 );
+            TEST_ASSERT_EQUAL_INT( 0, iStatus );
+
+            if( ( ulMessage % 2 ) == 1 )
+            {
+                iStatus = ( int ) mq_receive( xMqId, pcReceiveBuffer, posixtestMQ_SMALL_MESSAGE_SIZE, NULL );
+                TEST_ASSERT_EQUAL_INT( posixtestMQ_SMALL_MESSAGE_SIZE, iStatus );
+                iStatus = ( int ) mq_receive( xMqId, pcReceiveBuffer, posixtestMQ_SMALL_MESSAGE_SIZE, NULL );
+                TEST_ASSERT_EQUAL_INT( posixtestMQ_SMALL_MESSAGE_SIZE, iStatus );
+            }
+        }
+
+        xElapsedTicks = xTaskGetTickCount() - xStartTick;
+        vPortGetHeapStats( &xHeapAfter );
+
+        configPRINTF( ( "mq benchmark: %u messages in %u ms (%u msgs/sec), %u mallocs, %u frees\r\n",
+                        ( unsigned ) posixtestMQ_BENCHMARK_MESSAGES,
+                        ( unsigned ) ( xElapsedTicks * portTICK_PERIOD_MS ),
+                        ( unsigned ) ( ( ( uint64_t ) posixtestMQ_BENCHMARK_MESSAGES * configTICK_RATE_HZ ) /
+                                       ( xElapsedTicks + 1 ) ),
+                        ( unsigned ) ( xHeapAfter.xNumberOfSuccessfulAllocations - xHeapBefore.xNumberOfSuccessfulAllocations ),
+                        ( unsigned ) ( xHeapAfter.xNumberOfSuccessfulFrees - xHeapBefore.xNumberOfSuccessfulFrees ) ) );
+
+        /* Sending and receiving must not touch the heap. */
+        TEST_ASSERT_EQUAL( xHeapBefore.xNumberOfSuccessfulAllocations, xHeapAfter.xNumberOfSuccessfulAllocations );
+        TEST_ASSERT_EQUAL( xHeapBefore.xNumberOfSuccessfulFrees, xHeapAfter.xNumberOfSuccessfulFrees );
+    }
+
+    ( void ) mq_close( xMqId );
+    ( void ) mq_unlink( posixtestMQ_DEFAULT_NAME );
+}
+
+/*-----------------------------------------------------------*/
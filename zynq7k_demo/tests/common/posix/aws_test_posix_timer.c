@@ -45,6 +45,13 @@
  */
 #define posixtestSHORT_TIMER_DELAY_NANOSECONDS    ( 50000000L ) /* 50 ms. */
 
+/**
+ * @brief Period of the timers deleted while firing, and the number of times
+ * this is done.
+ */
+#define posixtestFIRING_TIMER_PERIOD_NANOSECONDS  ( 100000L ) /* 100 us. */
+#define posixtestFIRING_TIMER_ITERATIONS          ( 50 )
+
 /**
  * @brief Callback thread that notifies of timer expiration.
  *
@@ -133,6 +140,7 @@ TEST_GROUP_RUNNER( Full_POSIX_TIMER )
 {
     RUN_TEST_CASE( Full_POSIX_TIMER, timer_create );
     RUN_TEST_CASE( Full_POSIX_TIMER, timer_delete_active_timer );
+    RUN_TEST_CASE( Full_POSIX_TIMER, timer_delete_firing_timer );
     RUN_TEST_CASE( Full_POSIX_TIMER, timer_settime_invalid_params );
     RUN_TEST_CASE( Full_POSIX_TIMER, timer_settime_min_resolution );
     RUN_TEST_CASE( Full_POSIX_TIMER, timer_settime_disarm );
@@ -219,6 +227,55 @@ TEST( Full_POSIX_TIMER, timer_delete_active_timer )
 
 /*-----------------------------------------------------------*/
 
+TEST( Full_POSIX_TIMER, timer_delete_firing_timer )
+{
+    int iStatus = 0;
+    int iIteration = 0;
+    volatile BaseType_t xTimerCreated = pdFALSE;
+    timer_t xTimer = NULL;
+    struct sigevent xNotificationEvent = xDefaultSigevent;
+    struct timespec xSleepTime = { .tv_sec = 0, .tv_nsec = 1000000L }; /* 1 ms. */
+    struct itimerspec xInterval =
+    {
+        .it_value.tv_sec     = 0,
+        .it_value.tv_nsec    = posixtestFIRING_TIMER_PERIOD_NANOSECONDS,
+        .it_interval.tv_sec  = 0,
+        .it_interval.tv_nsec = posixtestFIRING_TIMER_PERIOD_NANOSECONDS
+    };
+
+    /* No notification thread, so that the timer task is in the timer's
+     * callback for as large a share of the time as possible. */
+    xNotificationEvent.sigev_notify = SIGEV_NONE;
+
+    if( TEST_PROTECT() )
+    {
+        /* Deleting must wait for a callback in progress before freeing the
+         * timer. The timer task overwrites freed memory otherwise. */
+        for( iIteration = 0; iIteration < posixtestFIRING_TIMER_ITERATIONS; iIteration++ )
+        {
+            iStatus = timer_create( CLOCK_REALTIME, &xNotificationEvent, &xTimer );
+            TEST_ASSERT_EQUAL_INT( 0, iStatus );
+            xTimerCreated = pdTRUE;
+
+            iStatus = timer_settime( xTimer, 0, &xInterval, NULL );
+            TEST_ASSERT_EQUAL_INT( 0, iStatus );
+
+            ( void ) clock_nanosleep( CLOCK_REALTIME, 0, &xSleepTime, NULL );
+
+            iStatus = timer_delete( xTimer );
+            TEST_ASSERT_EQUAL_INT( 0, iStatus );
+            xTimerCreated = pdFALSE;
+        }
+    }
+
+    if( xTimerCreated == pdTRUE )
+    {
+        ( void ) timer_delete( xTimer );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 TEST( Full_POSIX_TIMER, timer_settime_min_resolution )
 {
     int iStatus = 0;
@@ -49,6 +49,9 @@
 /* Update this file with AWS Credentials. */
 #include "aws_clientcredential.h"
 
+/* Access to the private functions of the secure sockets port. */
+#include "aws_secure_sockets_test_access_declare.h"
+
 /* Verbose printing. */
 #define tcptestPRINTF( x )
 /* In case of test failures, FAILUREPRINTF may provide more detailed information. */
@@ -819,6 +822,10 @@ TEST_GROUP_RUNNER( Full_TCP )
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_TwoSecureConnections );
         RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_SetSecureOptionsAfterConnect );
     #endif /* if ( tcptestSECURE_SERVER == 1 ) */
+
+    #if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+        RUN_TEST_CASE( Full_TCP, AFQP_SECURE_SOCKETS_StandbyMatch );
+    #endif
 }
 
 /*-------------------------------------------------------------------*/
@@ -2976,6 +2983,131 @@ TEST( Full_TCP, AFQP_SECURE_SOCKETS_SetSecureOptionsAfterConnect )
     TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, xResult, "Socket failed to close" );
 }
 
+#if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 )
+
+/* Options of the socket and of the standby endpoints it is compared with. */
+    #define tcptestSTANDBY_HOST    "standby.example.com"
+    #define tcptestSTANDBY_PORT    ( 8883 )
+
+    static const char cStandbyCertificate[] = "-----BEGIN CERTIFICATE-----\nstandby-a\n-----END CERTIFICATE-----\n";
+    static const char cOtherCertificate[] = "-----BEGIN CERTIFICATE-----\nstandby-b\n-----END CERTIFICATE-----\n";
+
+    TEST( Full_TCP, AFQP_SECURE_SOCKETS_StandbyMatch )
+    {
+        Socket_t xStandbySocket;
+        SocketsSockaddr_t xAddress;
+        SocketsStandbyEndpoint_t xEndpoint;
+        SocketsStandbyEndpoint_t xMismatch;
+        int32_t lResult;
+        char * pcAlpns[] = { socketsAWS_IOT_ALPN_MQTT };
+        const char * pcOtherAlpns[] = { "x-amzn-other" };
+        const char * pcTwoAlpns[] = { socketsAWS_IOT_ALPN_MQTT, "x-amzn-other" };
+
+        tcptestPRINTF( ( "Starting %s.\r\n", __FUNCTION__ ) );
+
+        xStandbySocket = SOCKETS_Socket( SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP );
+        TEST_ASSERT_NOT_EQUAL_MESSAGE( SOCKETS_INVALID_SOCKET, xStandbySocket, "Socket creation failed" );
+
+        if( TEST_PROTECT() )
+        {
+            lResult = SOCKETS_SetSockOpt( xStandbySocket, 0, SOCKETS_SO_REQUIRE_TLS, NULL, ( size_t ) 0 );
+            TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lResult );
+            lResult = SOCKETS_SetSockOpt( xStandbySocket,
+                                          0,
+                                          SOCKETS_SO_SERVER_NAME_INDICATION,
+                                          tcptestSTANDBY_HOST,
+                                          sizeof( tcptestSTANDBY_HOST ) );
+            TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lResult );
+            lResult = SOCKETS_SetSockOpt( xStandbySocket,
+                                          0,
+                                          SOCKETS_SO_TRUSTED_SERVER_CERTIFICATE,
+                                          cStandbyCertificate,
+                                          sizeof( cStandbyCertificate ) );
+            TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lResult );
+            lResult = SOCKETS_SetSockOpt( xStandbySocket,
+                                          0,
+                                          SOCKETS_SO_ALPN_PROTOCOLS,
+                                          pcAlpns,
+                                          sizeof( pcAlpns ) / sizeof( pcAlpns[ 0 ] ) );
+            TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lResult );
+            lResult = SOCKETS_SetSockOpt( xStandbySocket, 0, SOCKETS_SO_TLS_COALESCE, NULL, ( size_t ) 0 );
+            TEST_ASSERT_EQUAL_INT32( SOCKETS_ERROR_NONE, lResult );
+
+            xAddress.ucLength = sizeof( SocketsSockaddr_t );
+            xAddress.ucSocketDomain = SOCKETS_AF_INET;
+            xAddress.usPort = SOCKETS_htons( tcptestSTANDBY_PORT );
+            xAddress.ulAddress = SOCKETS_inet_addr_quick( 192, 168, 2, 6 );
+
+            /* The endpoint with the options of the socket is a match. */
+            xEndpoint.pcHostName = tcptestSTANDBY_HOST;
+            xEndpoint.usPort = tcptestSTANDBY_PORT;
+            xEndpoint.xServerNameIndication = pdTRUE;
+            xEndpoint.pcServerCertificate = cStandbyCertificate;
+            xEndpoint.ulServerCertificateLength = sizeof( cStandbyCertificate );
+            xEndpoint.ppcAlpnProtocols = ( const char ** ) pcAlpns;
+            xEndpoint.ulAlpnProtocolsCount = sizeof( pcAlpns ) / sizeof( pcAlpns[ 0 ] );
+            xEndpoint.xCoalesceWrites = pdTRUE;
+            TEST_ASSERT_EQUAL( pdTRUE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xEndpoint, xAddress.ulAddress ) );
+
+            /* Port. */
+            xMismatch = xEndpoint;
+            xMismatch.usPort = tcptestSTANDBY_PORT + 1;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            /* SNI: another host name, or the host name not sent. */
+            xMismatch = xEndpoint;
+            xMismatch.pcHostName = "other.example.com";
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            xMismatch = xEndpoint;
+            xMismatch.xServerNameIndication = pdFALSE;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            /* Certificate: other contents of the same length, or the default
+             * trust list. */
+            xMismatch = xEndpoint;
+            xMismatch.pcServerCertificate = cOtherCertificate;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            xMismatch = xEndpoint;
+            xMismatch.ulServerCertificateLength = sizeof( cStandbyCertificate ) - 1;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            xMismatch = xEndpoint;
+            xMismatch.pcServerCertificate = NULL;
+            xMismatch.ulServerCertificateLength = 0;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            /* ALPN: another protocol, more protocols, or none. */
+            xMismatch = xEndpoint;
+            xMismatch.ppcAlpnProtocols = pcOtherAlpns;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            xMismatch = xEndpoint;
+            xMismatch.ppcAlpnProtocols = pcTwoAlpns;
+            xMismatch.ulAlpnProtocolsCount = sizeof( pcTwoAlpns ) / sizeof( pcTwoAlpns[ 0 ] );
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            xMismatch = xEndpoint;
+            xMismatch.ppcAlpnProtocols = NULL;
+            xMismatch.ulAlpnProtocolsCount = 0;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+
+            /* Coalesce. */
+            xMismatch = xEndpoint;
+            xMismatch.xCoalesceWrites = pdFALSE;
+            TEST_ASSERT_EQUAL( pdFALSE, test_prvStandbyMatch( xStandbySocket, &xAddress, &xMismatch, xAddress.ulAddress ) );
+        }
+
+        lResult = SOCKETS_Close( xStandbySocket );
+        TEST_ASSERT_EQUAL_INT32_MESSAGE( SOCKETS_ERROR_NONE, lResult, "Socket failed to close" );
+
+        tcptestPRINTF( ( "%s complete.\r\n", __FUNCTION__ ) );
+    }
+/*-----------------------------------------------------------*/
+
+#endif /* if ( socketsconfigSTANDBY_MAX_ENDPOINTS > 0 ) */
+
 /* TODO: Investigate tests for loopback, other reserved IP addresses */
 /* TODO: Implement tests with a bad TCP connection (dropped packets, repeated packets, connection refused etc */
 /* TODO: Implement tests that have memory allocation errors (freertos heap is full) */
@@ -38,6 +38,7 @@
 /* AWS includes. */
 #include "aws_clientcredential.h"
 #include "aws_shadow.h"
+#include "aws_shadow_state.h"
 
 /* Unity framework includes. */
 #include "unity_fixture.h"
@@ -58,6 +59,26 @@ static char pcUpdateBuffer[ shadowBUFFER_LENGTH ];
 /* notification from callbacks to task*/
 static SemaphoreHandle_t xShadowUpdateSemaphore;
 
+/* Number of updates in flight in the pipelined test. */
+#define shadowtestPIPELINED_UPDATES    ( 4 )
+
+/* Client tokens of the pipelined updates. */
+#define shadowtestPIPELINE_TOKEN       "aws-test-shadow-pipeline-%d"
+
+/* Second Thing of the pipelined test on two Things. */
+#define shadowtestSECOND_THING_NAME    shadowTHING_NAME "-second"
+
+/* Counts the completed pipelined updates. */
+static SemaphoreHandle_t xShadowPipelineSemaphore;
+static ShadowReturnCode_t xPipelineResults[ shadowtestPIPELINED_UPDATES ];
+
+/* Keys of the Shadow state test. */
+#define shadowtestSTATE_KEY_COLOR      "color"
+#define shadowtestSTATE_KEY_LEVEL      "level"
+
+/* Desired values applied by the Shadow state test. */
+static uint32_t ulStateDesiredChanges;
+
 /* Generate initial shadow document */
 static uint32_t prvGenerateShadowJSON( void );
 
@@ -98,6 +119,9 @@ TEST_GROUP_RUNNER( Full_Shadow )
     RUN_TEST_CASE( Full_Shadow, CreateShadowDocument );
     RUN_TEST_CASE( Full_Shadow, DeleteShadowDocument );
     RUN_TEST_CASE( Full_Shadow, UpdateCallback );
+    RUN_TEST_CASE( Full_Shadow, PipelinedUpdates );
+    RUN_TEST_CASE( Full_Shadow, PipelinedUpdatesTwoThings );
+    RUN_TEST_CASE( Full_Shadow, StateDeltaOnlyUpdates );
 }
 
 /* Generate initial shadow document */
@@ -167,6 +191,28 @@ BaseType_t prvTestDeleteCallback( const char * const pcThingName,
     return pdFALSE;
 }
 
+/* Called when a pipelined update is accepted, rejected or times out. */
+static void prvTestPipelineCallback( void * pvCallbackContext,
+                                     ShadowReturnCode_t xResult,
+                                     ShadowOperationParams_t * const pxOperationParams )
+{
+    ( void ) pxOperationParams;
+
+    *( ( ShadowReturnCode_t * ) pvCallbackContext ) = xResult;
+
+    ( void ) xSemaphoreGive( xShadowPipelineSemaphore );
+}
+
+/* Called when a desired value of the Shadow state test changes. */
+static void prvTestStateDesiredCallback( void * pvUserData,
+                                         const char * pcKey,
+                                         const char * pcValue,
+                                         uint8_t ucValueLength )
+{
+    ulStateDesiredChanges++;
+    ( void ) SHADOW_StateSetReported( ( ShadowState_t * ) pvUserData, pcKey, pcValue, ucValueLength );
+}
+
 /* helper functions for setting MQTT params. */
 void TEST_SHADOW_Connect_Helper( MQTTAgentConnectParams_t * xConnectParams,
                                  ShadowClientHandle_t * pxShadowClientHandle )
@@ -527,3 +573,289 @@ TEST( Full_Shadow, UpdateCallback )
         vSemaphoreDelete( xShadowUpdateSemaphore );
     }
 }
+
+/* Test for updates published without waiting for each other's response. */
+TEST( Full_Shadow, PipelinedUpdates )
+{
+    /*Init required params and shadow library for test.*/
+    ShadowClientHandle_t xShadowClientHandle;
+    BaseType_t xClientCreated = pdFALSE;
+    BaseType_t xSemaphoreCreated = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParams;
+    ShadowCreateParams_t xCreateParams;
+    ShadowReturnCode_t xReturn;
+    ShadowOperationParams_t xOperationParams[ shadowtestPIPELINED_UPDATES ];
+    static char cDocuments[ shadowtestPIPELINED_UPDATES ][ shadowBUFFER_LENGTH ];
+    BaseType_t xIndex;
+
+    if( TEST_PROTECT() )
+    {
+        xShadowPipelineSemaphore = xSemaphoreCreateCounting( shadowtestPIPELINED_UPDATES, 0 );
+        TEST_ASSERT_TRUE( xShadowPipelineSemaphore != NULL );
+        xSemaphoreCreated = pdTRUE;
+
+        xCreateParams.xMQTTClientType = eDedicatedMQTTClient;
+        xReturn = SHADOW_ClientCreate( &xShadowClientHandle, &xCreateParams );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+        xClientCreated = pdTRUE;
+
+        memset( &xConnectParams, 0x00, sizeof( xConnectParams ) );
+        TEST_SHADOW_Connect_Helper( &xConnectParams, &xShadowClientHandle );
+        xReturn = SHADOW_ClientConnect( xShadowClientHandle,
+                                        &xConnectParams,
+                                        shadowTIMEOUT );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+
+        /* Publish all updates before any response arrives; each has its own
+         * client token. */
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            xPipelineResults[ xIndex ] = eShadowUnknown;
+
+            xOperationParams[ xIndex ].pcThingName = shadowTHING_NAME;
+            xOperationParams[ xIndex ].xQoS = eMQTTQoS0;
+            xOperationParams[ xIndex ].ucKeepSubscriptions = pdTRUE;
+            xOperationParams[ xIndex ].pcData = cDocuments[ xIndex ];
+            xOperationParams[ xIndex ].ulDataLength = ( uint32_t ) snprintf( cDocuments[ xIndex ],
+                                                                             shadowBUFFER_LENGTH,
+                                                                             "{"
+                                                                             "\"state\":{"
+                                                                             "\"reported\":{"
+                                                                             "\"sequence\":%d"
+                                                                             "}"
+                                                                             "},"
+                                                                             "\"clientToken\": \"" shadowtestPIPELINE_TOKEN "\""
+                                                                             "}",
+                                                                             ( int ) xIndex,
+                                                                             ( int ) xIndex );
+
+            xReturn = SHADOW_UpdateAsync( xShadowClientHandle,
+                                          &( xOperationParams[ xIndex ] ),
+                                          shadowTIMEOUT,
+                                          prvTestPipelineCallback,
+                                          &( xPipelineResults[ xIndex ] ) );
+            TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+        }
+
+        /* Wait for every update to complete. */
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xShadowPipelineSemaphore, shadowTIMEOUT * 2 ) );
+        }
+
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( eShadowSuccess, xPipelineResults[ xIndex ] );
+        }
+
+        xReturn = SHADOW_ClientDisconnect( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+    else
+    {
+        TEST_FAIL();
+    }
+
+    if( xClientCreated )
+    {
+        /* delete shadow client before returning.*/
+        xReturn = SHADOW_ClientDelete( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+
+    if( xSemaphoreCreated )
+    {
+        vSemaphoreDelete( xShadowPipelineSemaphore );
+    }
+}
+
+/* Test for updates on two Things published without waiting for each other's
+ * response. Each Thing needs its own subscriptions to the accepted and
+ * rejected topics. */
+TEST( Full_Shadow, PipelinedUpdatesTwoThings )
+{
+    /*Init required params and shadow library for test.*/
+    ShadowClientHandle_t xShadowClientHandle;
+    BaseType_t xClientCreated = pdFALSE;
+    BaseType_t xSemaphoreCreated = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParams;
+    ShadowCreateParams_t xCreateParams;
+    ShadowReturnCode_t xReturn;
+    ShadowOperationParams_t xOperationParams[ shadowtestPIPELINED_UPDATES ];
+    ShadowOperationParams_t xDeleteParams;
+    static char cDocuments[ shadowtestPIPELINED_UPDATES ][ shadowBUFFER_LENGTH ];
+    static const char * const pcThingNames[ 2 ] = { shadowTHING_NAME, shadowtestSECOND_THING_NAME };
+    BaseType_t xIndex;
+
+    if( TEST_PROTECT() )
+    {
+        xShadowPipelineSemaphore = xSemaphoreCreateCounting( shadowtestPIPELINED_UPDATES, 0 );
+        TEST_ASSERT_TRUE( xShadowPipelineSemaphore != NULL );
+        xSemaphoreCreated = pdTRUE;
+
+        xCreateParams.xMQTTClientType = eDedicatedMQTTClient;
+        xReturn = SHADOW_ClientCreate( &xShadowClientHandle, &xCreateParams );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+        xClientCreated = pdTRUE;
+
+        memset( &xConnectParams, 0x00, sizeof( xConnectParams ) );
+        TEST_SHADOW_Connect_Helper( &xConnectParams, &xShadowClientHandle );
+        xReturn = SHADOW_ClientConnect( xShadowClientHandle,
+                                        &xConnectParams,
+                                        shadowTIMEOUT );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+
+        /* Alternate between the Things, so that the first update of the
+         * second Thing follows one of the first Thing still in flight. */
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            xPipelineResults[ xIndex ] = eShadowUnknown;
+
+            xOperationParams[ xIndex ].pcThingName = pcThingNames[ xIndex % 2 ];
+            xOperationParams[ xIndex ].xQoS = eMQTTQoS0;
+            xOperationParams[ xIndex ].ucKeepSubscriptions = pdTRUE;
+            xOperationParams[ xIndex ].pcData = cDocuments[ xIndex ];
+            xOperationParams[ xIndex ].ulDataLength = ( uint32_t ) snprintf( cDocuments[ xIndex ],
+                                                                             shadowBUFFER_LENGTH,
+                                                                             "{"
+                                                                             "\"state\":{"
+                                                                             "\"reported\":{"
+                                                                             "\"sequence\":%d"
+                                                                             "}"
+                                                                             "},"
+                                                                             "\"clientToken\": \"" shadowtestPIPELINE_TOKEN "\""
+                                                                             "}",
+                                                                             ( int ) xIndex,
+                                                                             ( int ) xIndex );
+
+            xReturn = SHADOW_UpdateAsync( xShadowClientHandle,
+                                          &( xOperationParams[ xIndex ] ),
+                                          shadowTIMEOUT,
+                                          prvTestPipelineCallback,
+                                          &( xPipelineResults[ xIndex ] ) );
+            TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+        }
+
+        /* Wait for every update to complete. */
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( xShadowPipelineSemaphore, shadowTIMEOUT * 2 ) );
+        }
+
+        for( xIndex = 0; xIndex < shadowtestPIPELINED_UPDATES; xIndex++ )
+        {
+            TEST_ASSERT_EQUAL( eShadowSuccess, xPipelineResults[ xIndex ] );
+        }
+
+        /* Remove the document of the second Thing. */
+        xDeleteParams.pcThingName = shadowtestSECOND_THING_NAME;
+        xDeleteParams.xQoS = eMQTTQoS0;
+        xDeleteParams.pcData = NULL;
+        xDeleteParams.ulDataLength = 0;
+        xDeleteParams.ucKeepSubscriptions = pdFALSE;
+        xReturn = SHADOW_Delete( xShadowClientHandle,
+                                 &xDeleteParams,
+                                 shadowTIMEOUT );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+
+        xReturn = SHADOW_ClientDisconnect( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+    else
+    {
+        TEST_FAIL();
+    }
+
+    if( xClientCreated )
+    {
+        /* delete shadow client before returning.*/
+        xReturn = SHADOW_ClientDelete( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+
+    if( xSemaphoreCreated )
+    {
+        vSemaphoreDelete( xShadowPipelineSemaphore );
+    }
+}
+
+/* Test for reported changes coalesced into one update and incremental deltas. */
+TEST( Full_Shadow, StateDeltaOnlyUpdates )
+{
+    /*Init required params and shadow library for test.*/
+    ShadowClientHandle_t xShadowClientHandle;
+    BaseType_t xClientCreated = pdFALSE;
+    MQTTAgentConnectParams_t xConnectParams;
+    ShadowCreateParams_t xCreateParams;
+    ShadowReturnCode_t xReturn;
+    ShadowStateParams_t xStateParams;
+    static ShadowState_t xState;
+    static const char * const pcKeys[] = { shadowtestSTATE_KEY_COLOR, shadowtestSTATE_KEY_LEVEL };
+    static const char cDelta[] = "{\"version\":100,\"state\":{\"level\":7,\"unknown\":[1,2]},"
+                                 "\"metadata\":{\"level\":{\"timestamp\":1}}}";
+    char cDesired[ 8 ];
+
+    if( TEST_PROTECT() )
+    {
+        xCreateParams.xMQTTClientType = eDedicatedMQTTClient;
+        xReturn = SHADOW_ClientCreate( &xShadowClientHandle, &xCreateParams );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+        xClientCreated = pdTRUE;
+
+        memset( &xConnectParams, 0x00, sizeof( xConnectParams ) );
+        TEST_SHADOW_Connect_Helper( &xConnectParams, &xShadowClientHandle );
+        xReturn = SHADOW_ClientConnect( xShadowClientHandle,
+                                        &xConnectParams,
+                                        shadowTIMEOUT );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+
+        xStateParams.xShadowClientHandle = xShadowClientHandle;
+        xStateParams.pcThingName = shadowTHING_NAME;
+        xStateParams.ppcKeys = pcKeys;
+        xStateParams.uxKeyCount = sizeof( pcKeys ) / sizeof( pcKeys[ 0 ] );
+        xStateParams.xCoalesceTicks = shadowtestLOOP_DELAY;
+        xStateParams.xDesiredCallback = prvTestStateDesiredCallback;
+        xStateParams.pvUserData = &xState;
+        TEST_ASSERT_EQUAL( pdPASS, SHADOW_StateInit( &xState, &xStateParams ) );
+
+        /* Both changes are published in one update once the window elapsed. */
+        TEST_ASSERT_EQUAL( pdPASS, SHADOW_StateSetReported( &xState, shadowtestSTATE_KEY_COLOR, "\"red\"", 5 ) );
+        TEST_ASSERT_EQUAL( pdPASS, SHADOW_StateSetReported( &xState, shadowtestSTATE_KEY_LEVEL, "1", 1 ) );
+        TEST_ASSERT_EQUAL( pdFAIL, SHADOW_StateSetReported( &xState, "unknown", "1", 1 ) );
+        TEST_ASSERT_TRUE( SHADOW_StateProcess( &xState, shadowTIMEOUT ) <= shadowtestLOOP_DELAY );
+        vTaskDelay( shadowtestLOOP_DELAY );
+        TEST_ASSERT_EQUAL( portMAX_DELAY, SHADOW_StateProcess( &xState, shadowTIMEOUT ) );
+
+        /* Reporting an unchanged value publishes nothing. */
+        TEST_ASSERT_EQUAL( pdPASS, SHADOW_StateSetReported( &xState, shadowtestSTATE_KEY_COLOR, "\"red\"", 5 ) );
+        TEST_ASSERT_EQUAL( portMAX_DELAY, SHADOW_StateProcess( &xState, shadowTIMEOUT ) );
+
+        /* Only the keys of the delta change, and a stale delta is ignored. */
+        ulStateDesiredChanges = 0;
+        TEST_ASSERT_EQUAL( eShadowSuccess, SHADOW_StateApplyDelta( &xState, cDelta, sizeof( cDelta ) - 1 ) );
+        TEST_ASSERT_EQUAL( 1, ulStateDesiredChanges );
+        TEST_ASSERT_EQUAL( 1, SHADOW_StateGetDesired( &xState, shadowtestSTATE_KEY_LEVEL, cDesired, sizeof( cDesired ) ) );
+        TEST_ASSERT_EQUAL_STRING( "7", cDesired );
+        TEST_ASSERT_EQUAL( 0, SHADOW_StateGetDesired( &xState, shadowtestSTATE_KEY_COLOR, cDesired, sizeof( cDesired ) ) );
+        TEST_ASSERT_EQUAL( eShadowSuccess, SHADOW_StateApplyDelta( &xState, cDelta, sizeof( cDelta ) - 1 ) );
+        TEST_ASSERT_EQUAL( 1, ulStateDesiredChanges );
+
+        /* The callback reported the new level, which is published on its own. */
+        vTaskDelay( shadowtestLOOP_DELAY );
+        TEST_ASSERT_EQUAL( portMAX_DELAY, SHADOW_StateProcess( &xState, shadowTIMEOUT ) );
+
+        xReturn = SHADOW_ClientDisconnect( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+    else
+    {
+        TEST_FAIL();
+    }
+
+    if( xClientCreated )
+    {
+        /* delete shadow client before returning.*/
+        xReturn = SHADOW_ClientDelete( xShadowClientHandle );
+        TEST_ASSERT_EQUAL( eShadowSuccess, xReturn );
+    }
+}
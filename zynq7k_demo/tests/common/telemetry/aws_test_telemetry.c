@@ -0,0 +1,226 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/* Standard includes. */
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Telemetry includes. */
+#include "aws_telemetry.h"
+#include "aws_telemetry_config.h"
+#include "aws_telemetry_config_defaults.h"
+
+/* Unity framework includes. */
+#include "unity_fixture.h"
+
+/* Time given to the idle task to free the tasks deleted by a test. */
+#define telemetrytestCLEANUP_DELAY_MS    ( 500 )
+
+static TelemetryTask_t xTasks[ telemetryconfigMAX_TASKS ];
+static TelemetrySample_t xHistory[ telemetryconfigHISTORY_LENGTH + 1 ];
+static uint8_t ucSnapshot[ telemetryconfigSNAPSHOT_BUFFER_SIZE ];
+
+/*-----------------------------------------------------------*/
+
+TEST_GROUP( Full_TELEMETRY );
+
+TEST_SETUP( Full_TELEMETRY )
+{
+}
+
+TEST_TEAR_DOWN( Full_TELEMETRY )
+{
+}
+
+TEST_GROUP_RUNNER( Full_TELEMETRY )
+{
+    /* Runs first, nothing else samples the run time in the tests. */
+    RUN_TEST_CASE( Full_TELEMETRY, FirstSampleNotRecorded );
+    RUN_TEST_CASE( Full_TELEMETRY, SampleListsCallingTask );
+    RUN_TEST_CASE( Full_TELEMETRY, HistoryKeepsLatestSamples );
+    RUN_TEST_CASE( Full_TELEMETRY, EncodeSnapshotChecksBufferSize );
+    RUN_TEST_CASE( Full_TELEMETRY, SampleCountsTooManyTasks );
+    RUN_TEST_CASE( Full_TELEMETRY, MqttAgentSetWithoutPublish );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvIdleTask( void * pvParameters )
+{
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        vTaskSuspend( NULL );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, FirstSampleNotRecorded )
+{
+    TEST_ASSERT_EQUAL( 0, TELEMETRY_ReadHistory( xHistory, telemetryconfigHISTORY_LENGTH ) );
+
+    /* Only starts the interval, a load since boot is meaningless. */
+    TEST_ASSERT_EQUAL( pdFAIL, TELEMETRY_Sample() );
+    TEST_ASSERT_EQUAL( 0, TELEMETRY_ReadHistory( xHistory, telemetryconfigHISTORY_LENGTH ) );
+    TEST_ASSERT_EQUAL( 0, TELEMETRY_GetSkippedSamples() );
+
+    vTaskDelay( 1 );
+    TEST_ASSERT_EQUAL( pdPASS, TELEMETRY_Sample() );
+    TEST_ASSERT_EQUAL( 1, TELEMETRY_ReadHistory( xHistory, telemetryconfigHISTORY_LENGTH ) );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, SampleListsCallingTask )
+{
+    const char * pcTaskName = pcTaskGetName( NULL );
+    size_t xCount = 0;
+    size_t xI = 0;
+    BaseType_t xFound = pdFALSE;
+
+    /* Let the run time counter advance since the previous sample. */
+    vTaskDelay( 1 );
+    TEST_ASSERT_EQUAL( pdPASS, TELEMETRY_Sample() );
+
+    xCount = TELEMETRY_GetTasks( xTasks, telemetryconfigMAX_TASKS );
+    TEST_ASSERT_GREATER_THAN( 0, xCount );
+
+    for( xI = 0; xI < xCount; xI++ )
+    {
+        TEST_ASSERT_LESS_THAN( 1001, xTasks[ xI ].ulCpuLoad );
+
+        if( strncmp( xTasks[ xI ].cTaskName, pcTaskName, telemetryTASK_NAME_LENGTH - 1 ) == 0 )
+        {
+            xFound = pdTRUE;
+        }
+    }
+
+    TEST_ASSERT_TRUE( xFound );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, HistoryKeepsLatestSamples )
+{
+    size_t xCount = 0;
+    size_t xI = 0;
+
+    /* One more than the ring holds, so the oldest is overwritten. */
+    for( xI = 0; xI <= telemetryconfigHISTORY_LENGTH; xI++ )
+    {
+        vTaskDelay( 1 );
+        TEST_ASSERT_EQUAL( pdPASS, TELEMETRY_Sample() );
+    }
+
+    xCount = TELEMETRY_ReadHistory( xHistory, telemetryconfigHISTORY_LENGTH + 1 );
+    TEST_ASSERT_EQUAL( telemetryconfigHISTORY_LENGTH, xCount );
+
+    for( xI = 1; xI < xCount; xI++ )
+    {
+        TEST_ASSERT_GREATER_THAN( xHistory[ xI - 1 ].ulUptimeMs, xHistory[ xI ].ulUptimeMs );
+    }
+
+    /* Fewer entries than the ring holds get the most recent ones. */
+    TEST_ASSERT_EQUAL( 1, TELEMETRY_ReadHistory( &xHistory[ 0 ], 1 ) );
+    TEST_ASSERT_EQUAL( xHistory[ xCount - 1 ].ulUptimeMs, xHistory[ 0 ].ulUptimeMs );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, EncodeSnapshotChecksBufferSize )
+{
+    size_t xSize = 0;
+
+    vTaskDelay( 1 );
+    TEST_ASSERT_EQUAL( pdPASS, TELEMETRY_Sample() );
+
+    TEST_ASSERT_EQUAL( 0, TELEMETRY_EncodeSnapshot( ucSnapshot, 8 ) );
+
+    xSize = TELEMETRY_EncodeSnapshot( ucSnapshot, sizeof( ucSnapshot ) );
+    TEST_ASSERT_GREATER_THAN( 0, xSize );
+    TEST_ASSERT_LESS_THAN( sizeof( ucSnapshot ) + 1, xSize );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, SampleCountsTooManyTasks )
+{
+    TaskHandle_t xExtraTasks[ telemetryconfigMAX_TASKS ] = { 0 };
+    uint32_t ulSkipped = TELEMETRY_GetSkippedSamples();
+    size_t xI = 0;
+
+    /* With these there are more tasks than a sample can hold. */
+    for( xI = 0; xI < telemetryconfigMAX_TASKS; xI++ )
+    {
+        if( xTaskCreate( prvIdleTask,
+                         "TelemetryTest",
+                         configMINIMAL_STACK_SIZE,
+                         NULL,
+                         tskIDLE_PRIORITY,
+                         &xExtraTasks[ xI ] ) != pdPASS )
+        {
+            xExtraTasks[ xI ] = NULL;
+        }
+    }
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT_NOT_NULL( xExtraTasks[ telemetryconfigMAX_TASKS - 1 ] );
+        TEST_ASSERT_EQUAL( pdFAIL, TELEMETRY_Sample() );
+        TEST_ASSERT_EQUAL( ulSkipped + 1, TELEMETRY_GetSkippedSamples() );
+    }
+
+    for( xI = 0; xI < telemetryconfigMAX_TASKS; xI++ )
+    {
+        if( xExtraTasks[ xI ] != NULL )
+        {
+            vTaskDelete( xExtraTasks[ xI ] );
+        }
+    }
+
+    /* Deleted tasks are counted until the idle task has freed them. */
+    vTaskDelay( pdMS_TO_TICKS( telemetrytestCLEANUP_DELAY_MS ) );
+
+    TEST_ASSERT_EQUAL( pdPASS, TELEMETRY_Sample() );
+    TEST_ASSERT_EQUAL( ulSkipped + 1, TELEMETRY_GetSkippedSamples() );
+}
+
+/*-----------------------------------------------------------*/
+
+TEST( Full_TELEMETRY, MqttAgentSetWithoutPublish )
+{
+    /* Nothing is being published, so clearing the agent returns at once. */
+    TickType_t xStart = xTaskGetTickCount();
+
+    TELEMETRY_MqttAgentSet( NULL );
+    TELEMETRY_MqttAgentSet( NULL );
+
+    TEST_ASSERT_LESS_THAN( pdMS_TO_TICKS( telemetryconfigPUBLISH_TIMEOUT_MS ), xTaskGetTickCount() - xStart );
+}
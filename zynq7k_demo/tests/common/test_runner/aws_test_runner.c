@@ -147,6 +147,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( Full_POSIX_STRESS );
     #endif
 
+    #if ( testrunnerFULL_TELEMETRY_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_TELEMETRY );
+    #endif
+
     #if ( testrunnerFULL_FREERTOS_TCP_ENABLED == 1 )
         RUN_TEST_GROUP( Full_FREERTOS_TCP );
     #endif
@@ -0,0 +1,44 @@
+/*
+ * Amazon FreeRTOS Crypto Checks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Turns the crypto acceleration hooks of mbedtls/config.h off.
+ *
+ * Passed as MBEDTLS_USER_CONFIG_FILE to build the reference that the hooks
+ * are checked and benchmarked against, and usable the same way on the board
+ * to fall back to the mbedTLS code.
+ */
+
+#ifndef CRYPTO_REF_CONFIG_H
+#define CRYPTO_REF_CONFIG_H
+
+#undef MBEDTLS_SHA256_PROCESS_ALT
+#undef MBEDTLS_GCM_ALT
+#undef MBEDTLS_ECP_INTERNAL_ALT
+#undef MBEDTLS_ECP_ADD_MIXED_ALT
+#undef MBEDTLS_ECP_DOUBLE_JAC_ALT
+
+#endif /* CRYPTO_REF_CONFIG_H */
@@ -0,0 +1,442 @@
+/*
+ * Amazon FreeRTOS Crypto Checks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Known answer and differential checks of the mbedTLS crypto hooks.
+ *
+ * Usage: crypto_kat
+ *
+ * Built twice from the same sources: with the hooks of mbedtls/config.h,
+ * and with them turned off by crypto_ref_config.h. Each build runs:
+ * - the mbedTLS self tests of SHA-256, GCM and ECP,
+ * - known answers: the SHA-256 examples of FIPS 180-4, the P-256 key and
+ *   the "sample" signature of RFC 6979 A.2.5,
+ * - consistency checks on generated inputs: SHA-256 fed in pieces against
+ *   one call, GCM fed in pieces, in place, decrypted and with a corrupted
+ *   tag, P-256 ECDH both ways, ECDSA sign then verify, point addition of P
+ *   to P and to -P,
+ * and prints a digest of every output. The inputs come from a fixed seed,
+ * so the two builds must print the same digest; the makefile checks it.
+ * The exit status is 1 if any check failed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/sha256.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/ecdsa.h"
+
+/* Number of generated inputs of each check. */
+#define katSHA256_LENGTHS    ( 600 )
+#define katGCM_CASES         ( 400 )
+#define katP256_CASES        ( 24 )
+
+/* Longest generated GCM plaintext. */
+#define katGCM_MAX_LENGTH    ( 1200 )
+
+static int iFailures = 0;
+static uint64_t ullTranscript = 0xcbf29ce484222325ULL;
+static uint64_t ullSeed = 0x9E3779B97F4A7C15ULL;
+
+/*-----------------------------------------------------------*/
+
+static void prvCheck( int iCondition,
+                      const char * pcWhat,
+                      int iCase )
+{
+    if( !iCondition )
+    {
+        printf( "FAIL %s, case %d\n", pcWhat, iCase );
+        iFailures++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* FNV-1a over every output, independent of the code under test. */
+static void prvRecord( const unsigned char * pucData,
+                       size_t xLength )
+{
+    size_t x = 0;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        ullTranscript = ( ullTranscript ^ pucData[ x ] ) * 0x100000001b3ULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t prvRandom( void )
+{
+    ullSeed ^= ullSeed << 13;
+    ullSeed ^= ullSeed >> 7;
+    ullSeed ^= ullSeed << 17;
+
+    return ( uint32_t ) ( ullSeed >> 32 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRandomBytes( unsigned char * pucData,
+                            size_t xLength )
+{
+    size_t x = 0;
+
+    for( x = 0; x < xLength; x++ )
+    {
+        pucData[ x ] = ( unsigned char ) prvRandom();
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/* Random number generator of the ECP and ECDSA functions. */
+static int prvRng( void * pvContext,
+                   unsigned char * pucOutput,
+                   size_t xLength )
+{
+    ( void ) pvContext;
+    prvRandomBytes( pucOutput, xLength );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvRecordMpi( const mbedtls_mpi * pxValue )
+{
+    unsigned char ucBytes[ 32 ];
+
+    if( mbedtls_mpi_write_binary( pxValue, ucBytes, sizeof( ucBytes ) ) == 0 )
+    {
+        prvRecord( ucBytes, sizeof( ucBytes ) );
+    }
+    else
+    {
+        prvCheck( 0, "mpi fits 256 bits", 0 );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSelfTests( void )
+{
+    prvCheck( mbedtls_sha256_self_test( 0 ) == 0, "SHA-256 self test", 0 );
+    prvCheck( mbedtls_gcm_self_test( 0 ) == 0, "GCM self test", 0 );
+    prvCheck( mbedtls_ecp_self_test( 0 ) == 0, "ECP self test", 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSha256KnownAnswers( void )
+{
+    static const char * const pcMessages[] =
+    {
+        "",
+        "abc",
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    };
+    static const unsigned char ucDigests[][ 32 ] =
+    {
+        { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+          0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 },
+        { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+          0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad },
+        { 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+          0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 },
+    };
+    unsigned char ucDigest[ 32 ];
+    size_t x = 0;
+
+    for( x = 0; x < sizeof( pcMessages ) / sizeof( pcMessages[ 0 ] ); x++ )
+    {
+        prvCheck( mbedtls_sha256_ret( ( const unsigned char * ) pcMessages[ x ], strlen( pcMessages[ x ] ), ucDigest, 0 ) == 0,
+                  "SHA-256 known answer", ( int ) x );
+        prvCheck( memcmp( ucDigest, ucDigests[ x ], sizeof( ucDigest ) ) == 0, "SHA-256 known answer", ( int ) x );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvSha256Pieces( void )
+{
+    static unsigned char ucMessage[ katSHA256_LENGTHS ];
+    unsigned char ucWhole[ 32 ];
+    unsigned char ucPieces[ 32 ];
+    mbedtls_sha256_context xContext;
+    size_t xLength = 0;
+    size_t xOffset = 0;
+    size_t xPiece = 0;
+
+    prvRandomBytes( ucMessage, sizeof( ucMessage ) );
+
+    for( xLength = 0; xLength < katSHA256_LENGTHS; xLength++ )
+    {
+        ( void ) mbedtls_sha256_ret( ucMessage, xLength, ucWhole, 0 );
+
+        mbedtls_sha256_init( &xContext );
+        ( void ) mbedtls_sha256_starts_ret( &xContext, 0 );
+
+        for( xOffset = 0; xOffset < xLength; xOffset += xPiece )
+        {
+            xPiece = prvRandom() % 150;
+            xPiece = ( xPiece > xLength - xOffset ) ? xLength - xOffset : xPiece;
+            ( void ) mbedtls_sha256_update_ret( &xContext, &ucMessage[ xOffset ], xPiece );
+        }
+
+        ( void ) mbedtls_sha256_finish_ret( &xContext, ucPieces );
+        mbedtls_sha256_free( &xContext );
+
+        prvCheck( memcmp( ucWhole, ucPieces, sizeof( ucWhole ) ) == 0, "SHA-256 in pieces", ( int ) xLength );
+        prvRecord( ucWhole, sizeof( ucWhole ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvGcm( void )
+{
+    static unsigned char ucPlain[ katGCM_MAX_LENGTH ];
+    static unsigned char ucCipher[ katGCM_MAX_LENGTH ];
+    static unsigned char ucOther[ katGCM_MAX_LENGTH ];
+    unsigned char ucKey[ 32 ];
+    unsigned char ucIv[ 64 ];
+    unsigned char ucAdd[ 100 ];
+    unsigned char ucTag[ 16 ];
+    unsigned char ucOtherTag[ 16 ];
+    mbedtls_gcm_context xContext;
+    size_t xKeyBits = 0;
+    size_t xIvLength = 0;
+    size_t xAddLength = 0;
+    size_t xLength = 0;
+    size_t xOffset = 0;
+    size_t xPiece = 0;
+    int iCase = 0;
+
+    for( iCase = 0; iCase < katGCM_CASES; iCase++ )
+    {
+        xKeyBits = 128 + 64 * ( prvRandom() % 3 );
+        xIvLength = ( ( iCase % 2 ) == 0 ) ? 12 : 1 + prvRandom() % sizeof( ucIv );
+        xAddLength = prvRandom() % sizeof( ucAdd );
+        xLength = ( iCase < 64 ) ? ( size_t ) iCase : prvRandom() % katGCM_MAX_LENGTH;
+        prvRandomBytes( ucKey, sizeof( ucKey ) );
+        prvRandomBytes( ucIv, xIvLength );
+        prvRandomBytes( ucAdd, xAddLength );
+        prvRandomBytes( ucPlain, xLength );
+
+        mbedtls_gcm_init( &xContext );
+        prvCheck( mbedtls_gcm_setkey( &xContext, MBEDTLS_CIPHER_ID_AES, ucKey, xKeyBits ) == 0, "GCM setkey", iCase );
+
+        /* In one call. */
+        prvCheck( mbedtls_gcm_crypt_and_tag( &xContext, MBEDTLS_GCM_ENCRYPT, xLength, ucIv, xIvLength,
+                                             ucAdd, xAddLength, ucPlain, ucCipher, sizeof( ucTag ), ucTag ) == 0,
+                  "GCM encrypt", iCase );
+        prvRecord( ucCipher, xLength );
+        prvRecord( ucTag, sizeof( ucTag ) );
+
+        /* In pieces of whole blocks, then the rest, in place. */
+        memcpy( ucOther, ucPlain, xLength );
+        ( void ) mbedtls_gcm_starts( &xContext, MBEDTLS_GCM_ENCRYPT, ucIv, xIvLength, ucAdd, xAddLength );
+
+        for( xOffset = 0; xOffset < xLength; xOffset += xPiece )
+        {
+            xPiece = 16 * ( prvRandom() % 8 );
+            xPiece = ( xPiece >= xLength - xOffset ) ? xLength - xOffset : xPiece;
+            prvCheck( mbedtls_gcm_update( &xContext, xPiece, &ucOther[ xOffset ], &ucOther[ xOffset ] ) == 0,
+                      "GCM update", iCase );
+        }
+
+        ( void ) mbedtls_gcm_finish( &xContext, ucOtherTag, sizeof( ucOtherTag ) );
+        prvCheck( ( memcmp( ucOther, ucCipher, xLength ) == 0 ) &&
+                  ( memcmp( ucOtherTag, ucTag, sizeof( ucTag ) ) == 0 ),
+                  "GCM in pieces", iCase );
+
+        /* Decryption, with the right tag and with a corrupted one. */
+        prvCheck( ( mbedtls_gcm_auth_decrypt( &xContext, xLength, ucIv, xIvLength, ucAdd, xAddLength,
+                                              ucTag, sizeof( ucTag ), ucCipher, ucOther ) == 0 ) &&
+                  ( memcmp( ucOther, ucPlain, xLength ) == 0 ),
+                  "GCM decrypt", iCase );
+        ucTag[ prvRandom() % sizeof( ucTag ) ] ^= ( unsigned char ) ( 1U << ( prvRandom() % 8 ) );
+        prvCheck( mbedtls_gcm_auth_decrypt( &xContext, xLength, ucIv, xIvLength, ucAdd, xAddLength,
+                                            ucTag, sizeof( ucTag ), ucCipher, ucOther ) == MBEDTLS_ERR_GCM_AUTH_FAILED,
+                  "GCM corrupted tag", iCase );
+
+        mbedtls_gcm_free( &xContext );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvP256KnownAnswers( void )
+{
+    mbedtls_ecp_group xGroup;
+    mbedtls_ecp_point xPublic;
+    mbedtls_mpi xPrivate;
+    mbedtls_mpi xExpected;
+    mbedtls_mpi xR;
+    mbedtls_mpi xS;
+    unsigned char ucHash[ 32 ];
+
+    mbedtls_ecp_group_init( &xGroup );
+    mbedtls_ecp_point_init( &xPublic );
+    mbedtls_mpi_init( &xPrivate );
+    mbedtls_mpi_init( &xExpected );
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    /* RFC 6979 A.2.5: the public key of x, and the signature of "sample"
+     * with SHA-256. */
+    ( void ) mbedtls_ecp_group_load( &xGroup, MBEDTLS_ECP_DP_SECP256R1 );
+    ( void ) mbedtls_mpi_read_string( &xPrivate, 16, "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721" );
+    prvCheck( mbedtls_ecp_mul( &xGroup, &xPublic, &xPrivate, &xGroup.G, prvRng, NULL ) == 0, "P-256 public key", 0 );
+    ( void ) mbedtls_mpi_read_string( &xExpected, 16, "60FED4BA255A9D31C961EB74C6356D68C049B8923B61FA6CE669622E60F29FB6" );
+    prvCheck( mbedtls_mpi_cmp_mpi( &xPublic.X, &xExpected ) == 0, "P-256 public key X", 0 );
+    ( void ) mbedtls_mpi_read_string( &xExpected, 16, "7903FE1008B8BC99A41AE9E95628BC64F2F1B20C2D7E9F5177A3C294D4462299" );
+    prvCheck( mbedtls_mpi_cmp_mpi( &xPublic.Y, &xExpected ) == 0, "P-256 public key Y", 0 );
+
+    ( void ) mbedtls_sha256_ret( ( const unsigned char * ) "sample", 6, ucHash, 0 );
+    ( void ) mbedtls_mpi_read_string( &xR, 16, "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716" );
+    ( void ) mbedtls_mpi_read_string( &xS, 16, "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8" );
+    prvCheck( mbedtls_ecdsa_verify( &xGroup, ucHash, sizeof( ucHash ), &xPublic, &xR, &xS ) == 0, "P-256 RFC 6979 signature", 0 );
+    ( void ) mbedtls_mpi_add_int( &xS, &xS, 1 );
+    prvCheck( mbedtls_ecdsa_verify( &xGroup, ucHash, sizeof( ucHash ), &xPublic, &xR, &xS ) == MBEDTLS_ERR_ECP_VERIFY_FAILED,
+              "P-256 wrong signature", 0 );
+
+    mbedtls_mpi_free( &xS );
+    mbedtls_mpi_free( &xR );
+    mbedtls_mpi_free( &xExpected );
+    mbedtls_mpi_free( &xPrivate );
+    mbedtls_ecp_point_free( &xPublic );
+    mbedtls_ecp_group_free( &xGroup );
+}
+
+/*-----------------------------------------------------------*/
+
+static void prvP256( void )
+{
+    mbedtls_ecp_group xGroup;
+    mbedtls_ecp_point xA;
+    mbedtls_ecp_point xB;
+    mbedtls_ecp_point xAB;
+    mbedtls_ecp_point xBA;
+    mbedtls_mpi xSecretA;
+    mbedtls_mpi xSecretB;
+    mbedtls_mpi xOne;
+    mbedtls_mpi xMinusOne;
+    mbedtls_mpi xR;
+    mbedtls_mpi xS;
+    unsigned char ucHash[ 32 ];
+    int iCase = 0;
+
+    mbedtls_ecp_group_init( &xGroup );
+    mbedtls_ecp_point_init( &xA );
+    mbedtls_ecp_point_init( &xB );
+    mbedtls_ecp_point_init( &xAB );
+    mbedtls_ecp_point_init( &xBA );
+    mbedtls_mpi_init( &xSecretA );
+    mbedtls_mpi_init( &xSecretB );
+    mbedtls_mpi_init( &xOne );
+    mbedtls_mpi_init( &xMinusOne );
+    mbedtls_mpi_init( &xR );
+    mbedtls_mpi_init( &xS );
+
+    ( void ) mbedtls_ecp_group_load( &xGroup, MBEDTLS_ECP_DP_SECP256R1 );
+
+    for( iCase = 0; iCase < katP256_CASES; iCase++ )
+    {
+        /* ECDH: a(bG) = b(aG). */
+        prvCheck( ( mbedtls_ecp_gen_keypair( &xGroup, &xSecretA, &xA, prvRng, NULL ) == 0 ) &&
+                  ( mbedtls_ecp_gen_keypair( &xGroup, &xSecretB, &xB, prvRng, NULL ) == 0 ),
+                  "P-256 key generation", iCase );
+        prvCheck( ( mbedtls_ecp_check_pubkey( &xGroup, &xA ) == 0 ) &&
+                  ( mbedtls_ecp_check_pubkey( &xGroup, &xB ) == 0 ),
+                  "P-256 public key on the curve", iCase );
+        ( void ) mbedtls_ecp_mul( &xGroup, &xAB, &xSecretA, &xB, prvRng, NULL );
+        ( void ) mbedtls_ecp_mul( &xGroup, &xBA, &xSecretB, &xA, prvRng, NULL );
+        prvCheck( mbedtls_ecp_point_cmp( &xAB, &xBA ) == 0, "P-256 ECDH", iCase );
+        prvRecordMpi( &xA.X );
+        prvRecordMpi( &xA.Y );
+        prvRecordMpi( &xAB.X );
+        prvRecordMpi( &xAB.Y );
+
+        /* ECDSA, with the signature of the reference build checked by this
+         * one through the transcript. */
+        prvRandomBytes( ucHash, sizeof( ucHash ) );
+        prvCheck( mbedtls_ecdsa_sign( &xGroup, &xR, &xS, &xSecretA, ucHash, sizeof( ucHash ), prvRng, NULL ) == 0,
+                  "P-256 ECDSA sign", iCase );
+        prvCheck( mbedtls_ecdsa_verify( &xGroup, ucHash, sizeof( ucHash ), &xA, &xR, &xS ) == 0,
+                  "P-256 ECDSA verify", iCase );
+        prvCheck( mbedtls_ecdsa_verify( &xGroup, ucHash, sizeof( ucHash ), &xB, &xR, &xS ) == MBEDTLS_ERR_ECP_VERIFY_FAILED,
+                  "P-256 ECDSA verify with the wrong key", iCase );
+        prvRecordMpi( &xR );
+        prvRecordMpi( &xS );
+    }
+
+    /* P + P, which doubles, and P + (-P), which is zero. */
+    ( void ) mbedtls_mpi_lset( &xOne, 1 );
+    ( void ) mbedtls_mpi_sub_int( &xMinusOne, &xGroup.N, 1 );
+    ( void ) mbedtls_mpi_lset( &xSecretA, 2 );
+    ( void ) mbedtls_ecp_mul( &xGroup, &xA, &xSecretA, &xGroup.G, prvRng, NULL );
+    prvCheck( ( mbedtls_ecp_muladd( &xGroup, &xAB, &xOne, &xGroup.G, &xOne, &xGroup.G ) == 0 ) &&
+              ( mbedtls_ecp_point_cmp( &xAB, &xA ) == 0 ),
+              "P-256 G + G", 0 );
+    prvCheck( ( mbedtls_ecp_muladd( &xGroup, &xAB, &xOne, &xGroup.G, &xMinusOne, &xGroup.G ) == 0 ) &&
+              ( mbedtls_ecp_is_zero( &xAB ) != 0 ),
+              "P-256 G - G", 0 );
+
+    mbedtls_mpi_free( &xS );
+    mbedtls_mpi_free( &xR );
+    mbedtls_mpi_free( &xMinusOne );
+    mbedtls_mpi_free( &xOne );
+    mbedtls_mpi_free( &xSecretB );
+    mbedtls_mpi_free( &xSecretA );
+    mbedtls_ecp_point_free( &xBA );
+    mbedtls_ecp_point_free( &xAB );
+    mbedtls_ecp_point_free( &xB );
+    mbedtls_ecp_point_free( &xA );
+    mbedtls_ecp_group_free( &xGroup );
+}
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+    prvSelfTests();
+    prvSha256KnownAnswers();
+    prvSha256Pieces();
+    prvGcm();
+    prvP256KnownAnswers();
+    prvP256();
+
+    printf( "transcript %016llx\n", ( unsigned long long ) ullTranscript );
+    printf( "%d failure(s)\n", iFailures );
+
+    return ( iFailures > 0 ) ? 1 : 0;
+}
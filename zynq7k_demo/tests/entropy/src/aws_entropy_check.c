@@ -0,0 +1,531 @@
+/*
+ * Amazon FreeRTOS Entropy Checks V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file
+ * @brief Checks a noise source and the entropy configuration on the host.
+ *
+ * Usage: entropy_check [-c capture.bin]
+ *
+ * -c  Check raw samples captured with ENTROPY_ReadRawSamples(), one byte
+ *     per sample. Without a capture, the checks are run on generated
+ *     streams to test the checks themselves.
+ *
+ * A capture is checked against the configuration of the MicroZed demo:
+ * - the health tests of aws_entropy.c must not fail on it,
+ * - its most common value estimate of min-entropy, NIST SP 800-90B 6.3.1,
+ *   must be at least entropyconfigMIN_ENTROPY_MILLIBITS,
+ * - the cutoffs and the block size must be those derived from
+ *   entropyconfigMIN_ENTROPY_MILLIBITS,
+ * - the conditioned output must pass the frequency, block frequency and
+ *   runs tests of NIST SP 800-22.
+ * The exit status is 1 if any check failed.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aws_entropy.h"
+
+/* Statistical tests of the conditioned output fail below this P-value. */
+#define checkSIGNIFICANCE             ( 0.01 )
+
+/* Block size of the SP 800-22 block frequency test, in bits. */
+#define checkBLOCK_FREQUENCY_BITS     ( 128 )
+
+/* SP 800-90B asks for a million samples to assess a source. */
+#define checkRECOMMENDED_SAMPLES      ( 1000000 )
+
+/* Samples generated for the self-test. */
+#define checkSELF_TEST_SAMPLES        ( 1000000 )
+
+/* False positive rate of the health tests, SP 800-90B 4.4. */
+#define checkHEALTH_ALPHA_LOG2        ( 20 )
+
+/**
+ * @brief Outcome of the checks of one stream.
+ */
+typedef struct CheckResult
+{
+    double xMinEntropy;      /**< Most common value estimate, bits per sample. */
+    uint32_t ulRctFailures;  /**< Repetition count test failures. */
+    uint32_t ulAptFailures;  /**< Adaptive proportion test failures. */
+    size_t xOutputBits;      /**< Bits of conditioned output tested. */
+    double xFrequencyP;      /**< SP 800-22 frequency test P-value. */
+    double xBlockFrequencyP; /**< SP 800-22 block frequency test P-value. */
+    double xRunsP;           /**< SP 800-22 runs test P-value. */
+} CheckResult_t;
+
+static int iFailures = 0;
+
+/*-----------------------------------------------------------*/
+
+static void prvReport( int iPassed,
+                       const char * pcCheck,
+                       const char * pcFormat,
+                       double xValue )
+{
+    printf( "%s  %-32s ", iPassed ? "PASS" : "FAIL", pcCheck );
+    printf( pcFormat, xValue );
+    printf( "\n" );
+
+    if( !iPassed )
+    {
+        iFailures++;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Complemented incomplete gamma function Q( a, x ), as used by
+ * SP 800-22. Series for x < a + 1, continued fraction otherwise.
+ */
+static double prvIgamc( double a,
+                        double x )
+{
+    const double xEpsilon = 1e-15;
+    const double xTiny = 1e-300;
+    double xGln = lgamma( a );
+    double xSum;
+    double xTerm;
+    double b, c, d, h, an;
+    int i;
+
+    if( x <= 0.0 )
+    {
+        return 1.0;
+    }
+
+    if( x < ( a + 1.0 ) )
+    {
+        xTerm = 1.0 / a;
+        xSum = xTerm;
+
+        for( i = 1; i < 10000; i++ )
+        {
+            xTerm *= x / ( a + i );
+            xSum += xTerm;
+
+            if( fabs( xTerm ) < ( fabs( xSum ) * xEpsilon ) )
+            {
+                break;
+            }
+        }
+
+        return 1.0 - ( xSum * exp( -x + ( a * log( x ) ) - xGln ) );
+    }
+
+    /* Modified Lentz's method. */
+    b = x + 1.0 - a;
+    c = 1.0 / xTiny;
+    d = 1.0 / b;
+    h = d;
+
+    for( i = 1; i < 10000; i++ )
+    {
+        an = -i * ( i - a );
+        b += 2.0;
+        d = ( an * d ) + b;
+        d = ( fabs( d ) < xTiny ) ? xTiny : d;
+        c = b + ( an / c );
+        c = ( fabs( c ) < xTiny ) ? xTiny : c;
+        d = 1.0 / d;
+        h *= d * c;
+
+        if( fabs( ( d * c ) - 1.0 ) < xEpsilon )
+        {
+            break;
+        }
+    }
+
+    return exp( -x + ( a * log( x ) ) - xGln ) * h;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Smallest k for which P( X > k ) <= 2^-20, X ~ B( n, p ). This is
+ * CRITBINOM( n, p, 1 - 2^-20 ) of SP 800-90B 4.4.2.
+ */
+static uint32_t prvCritBinom( uint32_t ulTrials,
+                              double xProbability )
+{
+    const double xAlpha = ldexp( 1.0, -checkHEALTH_ALPHA_LOG2 );
+    double xTail = 0.0;
+    double xPmf;
+    uint32_t k = ulTrials;
+
+    while( k > 0 )
+    {
+        xPmf = exp( lgamma( ulTrials + 1.0 ) - lgamma( k + 1.0 ) - lgamma( ulTrials - k + 1.0 ) +
+                    ( k * log( xProbability ) ) + ( ( ulTrials - k ) * log1p( -xProbability ) ) );
+
+        if( ( xTail + xPmf ) > xAlpha )
+        {
+            break;
+        }
+
+        xTail += xPmf;
+        k--;
+    }
+
+    return k;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Most common value estimate of min-entropy per sample,
+ * SP 800-90B 6.3.1.
+ */
+static double prvMostCommonValue( const uint8_t * pucSamples,
+                                  size_t xCount )
+{
+    size_t xCounts[ 256 ] = { 0 };
+    size_t xMax = 0;
+    size_t i;
+    double p, pu;
+
+    for( i = 0; i < xCount; i++ )
+    {
+        xCounts[ pucSamples[ i ] ]++;
+    }
+
+    for( i = 0; i < 256; i++ )
+    {
+        xMax = ( xCounts[ i ] > xMax ) ? xCounts[ i ] : xMax;
+    }
+
+    p = ( double ) xMax / ( double ) xCount;
+    pu = p + ( 2.576 * sqrt( ( p * ( 1.0 - p ) ) / ( double ) ( xCount - 1 ) ) );
+    pu = ( pu > 1.0 ) ? 1.0 : pu;
+
+    return -log2( pu );
+}
+/*-----------------------------------------------------------*/
+
+static int prvBit( const uint8_t * pucBits,
+                   size_t xIndex )
+{
+    return ( pucBits[ xIndex / 8 ] >> ( 7 - ( xIndex % 8 ) ) ) & 1;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief SP 800-22 2.1, frequency (monobit) test.
+ */
+static double prvFrequencyTest( const uint8_t * pucBits,
+                                size_t xBits )
+{
+    long lSum = 0;
+    size_t i;
+
+    for( i = 0; i < xBits; i++ )
+    {
+        lSum += prvBit( pucBits, i ) ? 1 : -1;
+    }
+
+    return erfc( fabs( ( double ) lSum ) / sqrt( 2.0 * ( double ) xBits ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief SP 800-22 2.2, frequency test within a block.
+ */
+static double prvBlockFrequencyTest( const uint8_t * pucBits,
+                                     size_t xBits )
+{
+    size_t xBlocks = xBits / checkBLOCK_FREQUENCY_BITS;
+    double xChiSquared = 0.0;
+    double xPi;
+    size_t xOnes;
+    size_t i, j;
+
+    for( i = 0; i < xBlocks; i++ )
+    {
+        xOnes = 0;
+
+        for( j = 0; j < checkBLOCK_FREQUENCY_BITS; j++ )
+        {
+            xOnes += prvBit( pucBits, ( i * checkBLOCK_FREQUENCY_BITS ) + j );
+        }
+
+        xPi = ( double ) xOnes / checkBLOCK_FREQUENCY_BITS;
+        xChiSquared += ( xPi - 0.5 ) * ( xPi - 0.5 );
+    }
+
+    xChiSquared *= 4.0 * checkBLOCK_FREQUENCY_BITS;
+
+    return prvIgamc( xBlocks / 2.0, xChiSquared / 2.0 );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief SP 800-22 2.3, runs test.
+ */
+static double prvRunsTest( const uint8_t * pucBits,
+                           size_t xBits )
+{
+    size_t xOnes = 0;
+    size_t xRuns = 1;
+    double xPi;
+    size_t i;
+
+    for( i = 0; i < xBits; i++ )
+    {
+        xOnes += prvBit( pucBits, i );
+    }
+
+    xPi = ( double ) xOnes / ( double ) xBits;
+
+    /* The frequency prerequisite of the test. */
+    if( fabs( xPi - 0.5 ) >= ( 2.0 / sqrt( ( double ) xBits ) ) )
+    {
+        return 0.0;
+    }
+
+    for( i = 1; i < xBits; i++ )
+    {
+        xRuns += ( prvBit( pucBits, i ) != prvBit( pucBits, i - 1 ) ) ? 1 : 0;
+    }
+
+    return erfc( fabs( xRuns - ( 2.0 * xBits * xPi * ( 1.0 - xPi ) ) ) /
+                 ( 2.0 * sqrt( 2.0 * xBits ) * xPi * ( 1.0 - xPi ) ) );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run the health tests, the entropy estimate and the conditioning on
+ * a stream of raw samples.
+ */
+static void prvCheckStream( const uint8_t * pucSamples,
+                            size_t xCount,
+                            CheckResult_t * pxResult )
+{
+    EntropyHealth_t xHealth;
+    size_t xBlocks = xCount / entropyconfigSAMPLES_PER_BLOCK;
+    uint8_t * pucOutput = malloc( ( xBlocks + 1 ) * entropyOUTPUT_BYTES );
+    size_t xOutputBytes = 0;
+    size_t i;
+
+    assert( pucOutput != NULL );
+    memset( pxResult, 0, sizeof( *pxResult ) );
+
+    pxResult->xMinEntropy = prvMostCommonValue( pucSamples, xCount );
+
+    /* Blocks which fail the health tests are dropped, as on the board. */
+    ENTROPY_HealthInit( &xHealth );
+
+    for( i = 0; i < xBlocks; i++ )
+    {
+        if( ENTROPY_Condition( &xHealth,
+                               &pucSamples[ i * entropyconfigSAMPLES_PER_BLOCK ],
+                               &pucOutput[ xOutputBytes ] ) == pdPASS )
+        {
+            xOutputBytes += entropyOUTPUT_BYTES;
+        }
+    }
+
+    pxResult->ulRctFailures = xHealth.ulRctFailures;
+    pxResult->ulAptFailures = xHealth.ulAptFailures;
+    pxResult->xOutputBits = xOutputBytes * 8;
+
+    if( pxResult->xOutputBits >= checkBLOCK_FREQUENCY_BITS )
+    {
+        pxResult->xFrequencyP = prvFrequencyTest( pucOutput, pxResult->xOutputBits );
+        pxResult->xBlockFrequencyP = prvBlockFrequencyTest( pucOutput, pxResult->xOutputBits );
+        pxResult->xRunsP = prvRunsTest( pucOutput, pxResult->xOutputBits );
+    }
+
+    free( pucOutput );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the configuration follows from the assessed entropy.
+ */
+static void prvCheckConfiguration( void )
+{
+    double xClaimed = entropyconfigMIN_ENTROPY_MILLIBITS / 1000.0;
+    uint32_t ulRctCutoff = 1U + ( uint32_t ) ceil( checkHEALTH_ALPHA_LOG2 / xClaimed );
+    uint32_t ulAptCutoff = 1U + prvCritBinom( entropyconfigAPT_WINDOW, pow( 2.0, -xClaimed ) );
+
+    printf( "Configuration, %.3f bits per sample\n", xClaimed );
+    prvReport( entropyconfigRCT_CUTOFF == ulRctCutoff,
+               "entropyconfigRCT_CUTOFF", "expected %.0f", ( double ) ulRctCutoff );
+    prvReport( entropyconfigAPT_CUTOFF == ulAptCutoff,
+               "entropyconfigAPT_CUTOFF", "expected %.0f", ( double ) ulAptCutoff );
+    prvReport( ( entropyconfigSAMPLES_PER_BLOCK * xClaimed ) >= ( ( entropyOUTPUT_BYTES * 8 ) + 64 ),
+               "entropyconfigSAMPLES_PER_BLOCK", "%.0f bits per block",
+               entropyconfigSAMPLES_PER_BLOCK * xClaimed );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a capture from the board.
+ */
+static void prvCheckCapture( const char * pcFileName )
+{
+    FILE * pxFile = fopen( pcFileName, "rb" );
+    uint8_t * pucSamples;
+    long lSize;
+    CheckResult_t xResult;
+
+    if( pxFile == NULL )
+    {
+        fprintf( stderr, "Cannot open %s\n", pcFileName );
+        exit( 2 );
+    }
+
+    ( void ) fseek( pxFile, 0, SEEK_END );
+    lSize = ftell( pxFile );
+    ( void ) fseek( pxFile, 0, SEEK_SET );
+
+    if( lSize < ( long ) ( 2 * entropyconfigSAMPLES_PER_BLOCK ) )
+    {
+        fprintf( stderr, "%s holds too few samples\n", pcFileName );
+        exit( 2 );
+    }
+
+    pucSamples = malloc( ( size_t ) lSize );
+    assert( pucSamples != NULL );
+
+    if( fread( pucSamples, 1, ( size_t ) lSize, pxFile ) != ( size_t ) lSize )
+    {
+        fprintf( stderr, "Cannot read %s\n", pcFileName );
+        exit( 2 );
+    }
+
+    fclose( pxFile );
+
+    printf( "Capture %s, %ld samples\n", pcFileName, lSize );
+
+    if( lSize < checkRECOMMENDED_SAMPLES )
+    {
+        printf( "      fewer than the %d samples SP 800-90B asks for\n", checkRECOMMENDED_SAMPLES );
+    }
+
+    prvCheckStream( pucSamples, ( size_t ) lSize, &xResult );
+
+    prvReport( xResult.ulRctFailures == 0, "repetition count test", "%.0f failures", xResult.ulRctFailures );
+    prvReport( xResult.ulAptFailures == 0, "adaptive proportion test", "%.0f failures", xResult.ulAptFailures );
+    prvReport( xResult.xMinEntropy >= ( entropyconfigMIN_ENTROPY_MILLIBITS / 1000.0 ),
+               "most common value estimate", "%.3f bits per sample", xResult.xMinEntropy );
+    prvReport( xResult.xFrequencyP >= checkSIGNIFICANCE, "output frequency test", "P = %.4f", xResult.xFrequencyP );
+    prvReport( xResult.xBlockFrequencyP >= checkSIGNIFICANCE, "output block frequency test", "P = %.4f", xResult.xBlockFrequencyP );
+    prvReport( xResult.xRunsP >= checkSIGNIFICANCE, "output runs test", "P = %.4f", xResult.xRunsP );
+
+    free( pucSamples );
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check the checks, on streams whose outcome is known.
+ */
+static void prvSelfTest( void )
+{
+    uint8_t * pucSamples = malloc( checkSELF_TEST_SAMPLES );
+    uint32_t ulState = 0x2545F491UL;
+    CheckResult_t xResult;
+    size_t i;
+
+    assert( pucSamples != NULL );
+
+    /* Uniform samples, xorshift32. Everything passes. */
+    for( i = 0; i < checkSELF_TEST_SAMPLES; i++ )
+    {
+        ulState ^= ulState << 13;
+        ulState ^= ulState >> 17;
+        ulState ^= ulState << 5;
+        pucSamples[ i ] = ( uint8_t ) ( ulState >> 24 );
+    }
+
+    prvCheckStream( pucSamples, checkSELF_TEST_SAMPLES, &xResult );
+    printf( "Self-test, uniform samples\n" );
+    prvReport( ( xResult.ulRctFailures == 0 ) && ( xResult.ulAptFailures == 0 ),
+               "health tests pass", "%.0f failures", xResult.ulRctFailures + xResult.ulAptFailures );
+    prvReport( xResult.xMinEntropy > 7.8, "estimate near 8 bits", "%.3f bits per sample", xResult.xMinEntropy );
+    prvReport( ( xResult.xFrequencyP >= checkSIGNIFICANCE ) &&
+               ( xResult.xBlockFrequencyP >= checkSIGNIFICANCE ) &&
+               ( xResult.xRunsP >= checkSIGNIFICANCE ),
+               "output tests pass", "min P = %.4f",
+               fmin( xResult.xFrequencyP, fmin( xResult.xBlockFrequencyP, xResult.xRunsP ) ) );
+
+    /* A stuck source. */
+    memset( pucSamples, 0x5A, checkSELF_TEST_SAMPLES );
+    prvCheckStream( pucSamples, checkSELF_TEST_SAMPLES, &xResult );
+    printf( "Self-test, constant samples\n" );
+    prvReport( xResult.ulRctFailures > 0, "repetition count test fails", "%.0f failures", xResult.ulRctFailures );
+    prvReport( xResult.xOutputBits == 0, "no output", "%.0f bits", ( double ) xResult.xOutputBits );
+
+    /* A source which lost most of its entropy, but never repeats for long:
+     * 0x5A nine times out of ten, never more than 9 times in a row. */
+    for( i = 0; i < checkSELF_TEST_SAMPLES; i++ )
+    {
+        pucSamples[ i ] = ( ( i % 10 ) == 9 ) ? ( uint8_t ) i : 0x5A;
+    }
+
+    prvCheckStream( pucSamples, checkSELF_TEST_SAMPLES, &xResult );
+    printf( "Self-test, 90%% one value\n" );
+    prvReport( xResult.ulRctFailures == 0, "repetition count test passes", "%.0f failures", xResult.ulRctFailures );
+    prvReport( xResult.ulAptFailures > 0, "adaptive proportion test fails", "%.0f failures", xResult.ulAptFailures );
+    prvReport( xResult.xMinEntropy < ( entropyconfigMIN_ENTROPY_MILLIBITS / 1000.0 ),
+               "estimate below the claim", "%.3f bits per sample", xResult.xMinEntropy );
+
+    free( pucSamples );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc,
+          char ** argv )
+{
+    const char * pcCapture = NULL;
+
+    if( ( argc == 3 ) && ( strcmp( argv[ 1 ], "-c" ) == 0 ) )
+    {
+        pcCapture = argv[ 2 ];
+    }
+    else if( argc != 1 )
+    {
+        fprintf( stderr, "Usage: %s [-c capture.bin]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    prvCheckConfiguration();
+
+    if( pcCapture != NULL )
+    {
+        prvCheckCapture( pcCapture );
+    }
+    else
+    {
+        prvSelfTest();
+    }
+
+    printf( "%d failed\n", iFailures );
+
+    return ( iFailures == 0 ) ? 0 : 1;
+}
@@ -48,6 +48,7 @@
 #include "aws_logging_task.h"
 #include "aws_clientcredential.h"
 #include "aws_dev_mode_key_provisioning.h"
+#include "aws_platform_fs.h"
 
 /* Logging Task Defines. */
 #define mainLOGGING_MESSAGE_QUEUE_LENGTH    ( 15 )
@@ -192,7 +193,6 @@ static void prvSRand( UBaseType_t ulSeed )
 	ulNextRand = ulSeed;
 }
 
-extern int platform_init_fs();
 static void prvMiscInitialization( void )
 {
 	time_t xTimeNow;
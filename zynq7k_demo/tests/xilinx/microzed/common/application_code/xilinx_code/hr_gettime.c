@@ -19,6 +19,21 @@ void init_timer( int xTimer )
 	( void ) xTimer;
 }
 
+/* The run time stats counter is the global timer divided by 2^8, about 1.3 MHz.
+A shift is used instead of the division in ullGetHighResolutionTime() because
+the counter is read on every context switch.  The 32-bit value wraps after about
+55 minutes, which is fine as only differences between samples are used. */
+#define RUN_TIME_COUNTER_SHIFT	( 8 )
+
+uint32_t ulGetRunTimeCounterValue( void )
+{
+XTime tCur;
+
+	XTime_GetTime( &tCur );
+
+	return ( uint32_t ) ( tCur >> RUN_TIME_COUNTER_SHIFT );
+}
+
 unsigned long long ullGetHighResolutionTime( void )
 {
 XTime tCur;
@@ -62,6 +62,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //#define configPERIPHERAL_CLOCK_HZ  				( 33333000UL )
 #define configMINIMAL_STACK_SIZE                   ( ( unsigned short ) 200 )
 #define configTOTAL_HEAP_SIZE                      ( ( size_t ) ( 4 * 1024 * 1024 ) )
+#define configHEAP_SMALL_OBJECT_SLABS              1 /* heap_tlsf.c only. */
+#define configHEAP_TRACK_CALL_SITES                0 /* heap_tlsf.c only. */
 
 #define configMAX_TASK_NAME_LEN                    ( 15 )
 #define configUSE_TRACE_FACILITY                   1
@@ -93,15 +95,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /* Event group related definitions. */
 #define configUSE_EVENT_GROUPS                     1
 
-/* Run time stats gathering definitions. */
-/* FIX ME: Uncomment if you plan to use Tracealyzer.
-*/
+/* Run time stats gathering definitions, used by the telemetry tests.  The
+counter is derived from the Cortex-A9 global timer, which is already running,
+so it needs no setup. */
 #define configUSE_STATS_FORMATTING_FUNCTIONS	1
-/*
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS			1
+extern uint32_t ulGetRunTimeCounterValue( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
-#define portGET_RUN_TIME_COUNTER_VALUE()
-*/
+#define portGET_RUN_TIME_COUNTER_VALUE()		ulGetRunTimeCounterValue()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                   0
@@ -159,6 +160,14 @@ void vAssertCalled( const char * pcFile,
 
 //#define configTASK_RETURN_ADDRESS	NULL
 
+/* Record the allocations made while the tests run, so the memory leak tests can
+ * replay them to benchmark the heap implementation. */
+extern void vMemoryLeakTraceMalloc( void * pvAddress,
+                                    size_t xSize );
+extern void vMemoryLeakTraceFree( void * pvAddress );
+#define traceMALLOC( pvAddress, uiSize )    vMemoryLeakTraceMalloc( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize )      vMemoryLeakTraceFree( pvAddress )
+
 /* The function that implements FreeRTOS printf style output, and the macro
  * that maps the configPRINTF() macros to that function. */
 extern void vLoggingPrintf( const char * pcFormat, ... );
@@ -0,0 +1,47 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_entropy_config.h
+ * @brief Entropy source config options.
+ */
+
+#ifndef _AWS_ENTROPY_CONFIG_H_
+#define _AWS_ENTROPY_CONFIG_H_
+
+/**
+ * @brief A raw sample is the low 4 bits of an XADC conversion and the low
+ * 4 bits of the global timer count it took to read it, see
+ * aws_pkcs11_pal.c. Only 0.5 bit of min-entropy is credited to each, the
+ * host checks in tests/entropy must estimate more than that on samples
+ * captured from the board.
+ */
+#define entropyconfigMIN_ENTROPY_MILLIBITS    ( 500 )
+#define entropyconfigSAMPLES_PER_BLOCK        ( 640 )
+#define entropyconfigRCT_CUTOFF               ( 41 )
+#define entropyconfigAPT_WINDOW               ( 512 )
+#define entropyconfigAPT_CUTOFF               ( 410 )
+
+#endif /* _AWS_ENTROPY_CONFIG_H_ */
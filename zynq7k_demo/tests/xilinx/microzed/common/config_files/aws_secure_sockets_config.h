@@ -48,4 +48,10 @@
  */
 #define socketsconfigDEFAULT_RECV_TIMEOUT    ( 20000 )
 
+/**
+ * @brief One endpoint, so that the standby connection code is built for
+ * AFQP_SECURE_SOCKETS_StandbyMatch. The tests register no endpoint.
+ */
+#define socketsconfigSTANDBY_MAX_ENDPOINTS   ( 1 )
+
 #endif /* _AWS_SECURE_SOCKETS_CONFIG_H_ */
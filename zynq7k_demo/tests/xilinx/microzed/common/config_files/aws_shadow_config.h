@@ -90,4 +90,32 @@
  */
 #define shadowconfigCLEANUP_TIME_MS              ( 5000UL )
 
+/**
+ * @brief Number of operations that may be in progress at once on each Shadow
+ * Client. Responses are matched to operations by their "clientToken".
+ */
+#define shadowconfigMAX_PENDING_OPERATIONS       ( 4 )
+
+/**
+ * @brief Maximum length of a "clientToken", in bytes.
+ */
+#define shadowconfigMAX_CLIENT_TOKEN_LENGTH      ( 64 )
+
+/**
+ * @brief Maximum number of keys of a Shadow state, see aws_shadow_state.h.
+ */
+#define shadowconfigSTATE_MAX_FIELDS             ( 8 )
+
+/**
+ * @brief Size of the cached desired and reported values of each key of a
+ * Shadow state, in bytes.
+ */
+#define shadowconfigSTATE_MAX_VALUE_LENGTH       ( 32 )
+
+/**
+ * @brief Size of the reported update document built by a Shadow state, in
+ * bytes.
+ */
+#define shadowconfigSTATE_DOCUMENT_LENGTH        ( 256 )
+
 #endif /* _AWS_SHADOW_CONFIG_H_ */
\ No newline at end of file
@@ -50,5 +50,6 @@
 #define testrunnerFULL_MQTT_ENABLED                0
 #define testrunnerFULL_MEMORYLEAK_ENABLED          0
 #define testrunnerFULL_TLS_ENABLED                 0
+#define testrunnerFULL_TELEMETRY_ENABLED           0
 
 #endif /* AWS_TEST_RUNNER_CONFIG_H */
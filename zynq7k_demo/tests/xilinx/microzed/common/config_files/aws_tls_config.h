@@ -0,0 +1,48 @@
+/*
+ * Amazon FreeRTOS V1.4.4
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file aws_tls_config.h
+ * @brief TLS layer config options.
+ */
+
+#ifndef _AWS_TLS_CONFIG_H_
+#define _AWS_TLS_CONFIG_H_
+
+/**
+ * @brief MQTT control packets and small publishes are coalesced into one
+ * record per pass of the MQTT task, see mqttconfigCOALESCE_TLS_WRITES.
+ */
+#define tlsconfigCOALESCE_BUFFER_SIZE    ( 512 )
+#define tlsconfigCOALESCE_DEADLINE_MS    ( 10 )
+
+/**
+ * @brief The max_fragment_length extension is not requested, as not every
+ * endpoint the board connects to is known to accept it. Writes are still
+ * split into records of MBEDTLS_SSL_OUT_CONTENT_LEN in mbedTLS config.h.
+ */
+#define tlsconfigMAX_FRAGMENT_LENGTH     ( 0 )
+
+#endif /* _AWS_TLS_CONFIG_H_ */